@@ -0,0 +1,71 @@
+/****************************************************************************
+ * apps/examples/dhcpd/host/nuttx/config.h
+ * Configuration for the host build of the DHCP server
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_EXAMPLES_DHCPD_HOST_NUTTX_CONFIG_H
+#define __APPS_EXAMPLES_DHCPD_HOST_NUTTX_CONFIG_H
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+/* Environment stuff.  dhcpd.c provides some of these for its host build. */
+
+#ifndef OK
+#  define OK 0
+#endif
+
+#ifndef ERROR
+#  define ERROR -1
+#endif
+
+#ifndef FAR
+#  define FAR
+#endif
+
+/* Configuration */
+
+#define CONFIG_NET_UDP 1
+#define CONFIG_NET_IPv4 1
+#define CONFIG_CLOCK_MONOTONIC 1
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Used by the netlib_server() prototype */
+
+typedef void *(*pthread_startroutine_t)(void *);
+
+#endif /* __APPS_EXAMPLES_DHCPD_HOST_NUTTX_CONFIG_H */
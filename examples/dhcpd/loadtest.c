@@ -0,0 +1,555 @@
+/****************************************************************************
+ * examples/dhcpd/loadtest.c
+ * Host-based load test client for the DHCP server.  Each simulated client
+ * performs a DISCOVER/OFFER/REQUEST/ACK exchange with its own MAC address.
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define DHCP_SERVER_PORT         67
+#define DHCP_CLIENT_PORT         68
+
+#define DHCP_REQUEST              1
+#define DHCP_REPLY                2
+
+#define DHCP_OPTION_PAD           0
+#define DHCP_OPTION_REQ_IPADDR   50
+#define DHCP_OPTION_MSG_TYPE     53
+#define DHCP_OPTION_SERVER_ID    54
+#define DHCP_OPTION_END         255
+
+#define DHCPDISCOVER              1
+#define DHCPOFFER                 2
+#define DHCPREQUEST               3
+#define DHCPACK                   5
+#define DHCPNAK                   6
+
+#define DHCP_HTYPE_ETHERNET       1
+#define DHCP_HLEN_ETHERNET        6
+#define BOOTP_BROADCAST           0x8000
+
+#define DEFAULT_NCLIENTS          100
+#define DEFAULT_NPASSES           2
+#define DEFAULT_TIMEOUT           1000  /* Milliseconds */
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Same layout as struct dhcpmsg_s in netutils/dhcpd/dhcpd.c */
+
+struct dhcpmsg_s
+{
+  uint8_t  op;
+  uint8_t  htype;
+  uint8_t  hlen;
+  uint8_t  hops;
+  uint8_t  xid[4];
+  uint16_t secs;
+  uint16_t flags;
+  uint8_t  ciaddr[4];
+  uint8_t  yiaddr[4];
+  uint8_t  siaddr[4];
+  uint8_t  giaddr[4];
+  uint8_t  chaddr[16];
+  uint8_t  sname[64];
+  uint8_t  file[128];
+  uint8_t  options[312];
+};
+
+/* The state of one simulated client */
+
+struct client_s
+{
+  uint8_t  mac[DHCP_HLEN_ETHERNET];
+  uint32_t ipaddr;                  /* Address from the last ACK (network order) */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const uint8_t g_magiccookie[4] = {99, 130, 83, 99};
+
+static struct sockaddr_in g_server;
+static int g_sockfd;
+static int g_timeout = DEFAULT_TIMEOUT;
+static uint32_t g_xid;
+
+/* Statistics for one pass */
+
+static int g_nacked;
+static int g_nnaked;
+static int g_ntimeouts;
+static int g_nsame;
+static double g_minlatency;
+static double g_maxlatency;
+static double g_totlatency;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: show_usage
+ ****************************************************************************/
+
+static void show_usage(const char *progname)
+{
+  fprintf(stderr, "USAGE: %s [-n <nclients>] [-p <npasses>] "
+          "[-s <server-ip>] [-t <timeout-msec>]\n", progname);
+  fprintf(stderr, "  Defaults: -n %d -p %d -s 127.0.0.1 -t %d\n",
+          DEFAULT_NCLIENTS, DEFAULT_NPASSES, DEFAULT_TIMEOUT);
+  exit(1);
+}
+
+/****************************************************************************
+ * Name: elapsed_msec
+ ****************************************************************************/
+
+static double elapsed_msec(const struct timespec *start)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)(now.tv_sec - start->tv_sec) * 1000.0 +
+         (double)(now.tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+/****************************************************************************
+ * Name: open_socket
+ ****************************************************************************/
+
+static int open_socket(void)
+{
+  struct sockaddr_in addr;
+  int optval;
+  int sockfd;
+
+  sockfd = socket(PF_INET, SOCK_DGRAM, 0);
+  if (sockfd < 0)
+    {
+      fprintf(stderr, "socket failed: %d\n", errno);
+      return -1;
+    }
+
+  /* The server broadcasts its responses, so we must be able to receive
+   * broadcasts on the DHCP client port.
+   */
+
+  optval = 1;
+  setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(int));
+  setsockopt(sockfd, SOL_SOCKET, SO_BROADCAST, &optval, sizeof(int));
+
+  memset(&addr, 0, sizeof(struct sockaddr_in));
+  addr.sin_family      = AF_INET;
+  addr.sin_port        = htons(DHCP_CLIENT_PORT);
+  addr.sin_addr.s_addr = INADDR_ANY;
+
+  if (bind(sockfd, (struct sockaddr *)&addr, sizeof(struct sockaddr_in)) < 0)
+    {
+      fprintf(stderr, "bind to port %d failed: %d\n", DHCP_CLIENT_PORT, errno);
+      close(sockfd);
+      return -1;
+    }
+
+  return sockfd;
+}
+
+/****************************************************************************
+ * Name: send_message
+ ****************************************************************************/
+
+static int send_message(const struct client_s *client, uint8_t msgtype,
+                        uint32_t reqip, uint32_t serverid)
+{
+  struct dhcpmsg_s msg;
+  uint8_t *ptr;
+
+  memset(&msg, 0, sizeof(struct dhcpmsg_s));
+  msg.op    = DHCP_REQUEST;
+  msg.htype = DHCP_HTYPE_ETHERNET;
+  msg.hlen  = DHCP_HLEN_ETHERNET;
+  msg.flags = htons(BOOTP_BROADCAST);
+  memcpy(msg.xid, &g_xid, 4);
+  memcpy(msg.chaddr, client->mac, DHCP_HLEN_ETHERNET);
+
+  ptr = msg.options;
+  memcpy(ptr, g_magiccookie, 4);
+  ptr += 4;
+
+  *ptr++ = DHCP_OPTION_MSG_TYPE;
+  *ptr++ = 1;
+  *ptr++ = msgtype;
+
+  if (reqip != 0)
+    {
+      *ptr++ = DHCP_OPTION_REQ_IPADDR;
+      *ptr++ = 4;
+      memcpy(ptr, &reqip, 4);
+      ptr += 4;
+    }
+
+  if (serverid != 0)
+    {
+      *ptr++ = DHCP_OPTION_SERVER_ID;
+      *ptr++ = 4;
+      memcpy(ptr, &serverid, 4);
+      ptr += 4;
+    }
+
+  *ptr = DHCP_OPTION_END;
+
+  return sendto(g_sockfd, &msg, sizeof(struct dhcpmsg_s), 0,
+                (struct sockaddr *)&g_server, sizeof(struct sockaddr_in));
+}
+
+/****************************************************************************
+ * Name: find_option
+ ****************************************************************************/
+
+static const uint8_t *find_option(const struct dhcpmsg_s *msg, int len,
+                                  uint8_t code)
+{
+  const uint8_t *ptr = msg->options + 4;
+  const uint8_t *end = (const uint8_t *)msg + len;
+
+  while (ptr + 1 < end && *ptr != DHCP_OPTION_END)
+    {
+      if (*ptr == DHCP_OPTION_PAD)
+        {
+          ptr++;
+        }
+      else if (*ptr == code && ptr + 2 + ptr[1] <= end)
+        {
+          return ptr + 2;
+        }
+      else
+        {
+          ptr += 2 + ptr[1];
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: recv_reply
+ *
+ * Description:
+ *   Wait for the reply to the current transaction.  Replies to other
+ *   transactions (such as late responses to an earlier timeout) are
+ *   discarded.  Returns the DHCP message type or zero on a timeout.
+ *
+ ****************************************************************************/
+
+static int recv_reply(struct dhcpmsg_s *msg, uint32_t *serverid)
+{
+  struct timespec start;
+  struct timeval tv;
+  const uint8_t *opt;
+  double remaining;
+  int nbytes;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (; ; )
+    {
+      remaining = g_timeout - elapsed_msec(&start);
+      if (remaining <= 0)
+        {
+          return 0;
+        }
+
+      tv.tv_sec  = (time_t)(remaining / 1000);
+      tv.tv_usec = (long)((remaining - tv.tv_sec * 1000.0) * 1000.0);
+      setsockopt(g_sockfd, SOL_SOCKET, SO_RCVTIMEO, &tv,
+                 sizeof(struct timeval));
+
+      nbytes = recv(g_sockfd, msg, sizeof(struct dhcpmsg_s), 0);
+      if (nbytes < 0)
+        {
+          if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+            {
+              continue;
+            }
+
+          fprintf(stderr, "recv failed: %d\n", errno);
+          return 0;
+        }
+
+      if (nbytes < (int)(msg->options - (uint8_t *)msg) + 4 ||
+          msg->op != DHCP_REPLY || memcmp(msg->xid, &g_xid, 4) != 0 ||
+          memcmp(msg->options, g_magiccookie, 4) != 0)
+        {
+          continue;
+        }
+
+      opt = find_option(msg, nbytes, DHCP_OPTION_SERVER_ID);
+      if (opt != NULL && serverid != NULL)
+        {
+          memcpy(serverid, opt, 4);
+        }
+
+      opt = find_option(msg, nbytes, DHCP_OPTION_MSG_TYPE);
+      if (opt != NULL)
+        {
+          return *opt;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: run_client
+ *
+ * Description:
+ *   Perform one DISCOVER/OFFER/REQUEST/ACK exchange for one client
+ *
+ ****************************************************************************/
+
+static void run_client(struct client_s *client)
+{
+  struct dhcpmsg_s msg;
+  struct timespec start;
+  uint32_t serverid = 0;
+  uint32_t offerip;
+  double latency;
+  int type;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  /* DISCOVER -> OFFER */
+
+  g_xid++;
+  send_message(client, DHCPDISCOVER, 0, 0);
+  type = recv_reply(&msg, &serverid);
+  if (type != DHCPOFFER)
+    {
+      if (type == 0)
+        {
+          g_ntimeouts++;
+        }
+      else
+        {
+          g_nnaked++;
+        }
+
+      return;
+    }
+
+  memcpy(&offerip, msg.yiaddr, 4);
+
+  /* REQUEST -> ACK */
+
+  g_xid++;
+  send_message(client, DHCPREQUEST, offerip, serverid);
+  type = recv_reply(&msg, NULL);
+  if (type == DHCPACK)
+    {
+      latency = elapsed_msec(&start);
+      if (latency < g_minlatency)
+        {
+          g_minlatency = latency;
+        }
+
+      if (latency > g_maxlatency)
+        {
+          g_maxlatency = latency;
+        }
+
+      g_totlatency += latency;
+      g_nacked++;
+
+      if (client->ipaddr == offerip)
+        {
+          g_nsame++;
+        }
+
+      client->ipaddr = offerip;
+    }
+  else if (type == 0)
+    {
+      g_ntimeouts++;
+    }
+  else
+    {
+      g_nnaked++;
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * main
+ ****************************************************************************/
+
+int main(int argc, char **argv, char **envp)
+{
+  struct client_s *clients;
+  struct timespec start;
+  double elapsed;
+  int nclients = DEFAULT_NCLIENTS;
+  int npasses  = DEFAULT_NPASSES;
+  int option;
+  int pass;
+  int i;
+
+  memset(&g_server, 0, sizeof(struct sockaddr_in));
+  g_server.sin_family      = AF_INET;
+  g_server.sin_port        = htons(DHCP_SERVER_PORT);
+  g_server.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  while ((option = getopt(argc, argv, "n:p:s:t:")) != -1)
+    {
+      switch (option)
+        {
+          case 'n':
+            nclients = atoi(optarg);
+            break;
+
+          case 'p':
+            npasses = atoi(optarg);
+            break;
+
+          case 's':
+            if (inet_pton(AF_INET, optarg, &g_server.sin_addr) != 1)
+              {
+                show_usage(argv[0]);
+              }
+            break;
+
+          case 't':
+            g_timeout = atoi(optarg);
+            break;
+
+          default:
+            show_usage(argv[0]);
+            break;
+        }
+    }
+
+  if (nclients <= 0 || nclients > 0xffffff || npasses <= 0 || g_timeout <= 0)
+    {
+      show_usage(argv[0]);
+    }
+
+  /* Give each client a unique, locally administered MAC address */
+
+  clients = (struct client_s *)calloc(nclients, sizeof(struct client_s));
+  if (clients == NULL)
+    {
+      fprintf(stderr, "Failed to allocate %d clients\n", nclients);
+      return 1;
+    }
+
+  for (i = 0; i < nclients; i++)
+    {
+      clients[i].mac[0] = 0x02;
+      clients[i].mac[3] = (uint8_t)(i >> 16);
+      clients[i].mac[4] = (uint8_t)(i >> 8);
+      clients[i].mac[5] = (uint8_t)i;
+    }
+
+  g_sockfd = open_socket();
+  if (g_sockfd < 0)
+    {
+      free(clients);
+      return 1;
+    }
+
+  g_xid = (uint32_t)getpid() << 16;
+
+  /* The first pass allocates new leases.  Later passes exercise the lookup
+   * of existing leases by MAC address and should get the same addresses
+   * back, even if the server was restarted between passes (with the lease
+   * journal enabled).
+   */
+
+  for (pass = 1; pass <= npasses; pass++)
+    {
+      g_nacked      = 0;
+      g_nnaked      = 0;
+      g_ntimeouts   = 0;
+      g_nsame       = 0;
+      g_minlatency  = 1e9;
+      g_maxlatency  = 0.0;
+      g_totlatency  = 0.0;
+
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      for (i = 0; i < nclients; i++)
+        {
+          run_client(&clients[i]);
+        }
+
+      elapsed = elapsed_msec(&start);
+
+      printf("Pass %d: %d clients in %.1f ms (%.1f leases/sec)\n",
+             pass, nclients, elapsed,
+             elapsed > 0 ? g_nacked * 1000.0 / elapsed : 0.0);
+      printf("  ACK: %d  NAK/other: %d  Timeout: %d  Same address: %d\n",
+             g_nacked, g_nnaked, g_ntimeouts, g_nsame);
+      if (g_nacked > 0)
+        {
+          printf("  Latency (ms): min %.3f  avg %.3f  max %.3f\n",
+                 g_minlatency, g_totlatency / g_nacked, g_maxlatency);
+        }
+    }
+
+  close(g_sockfd);
+  free(clients);
+  return 0;
+}
@@ -0,0 +1,357 @@
+/****************************************************************************
+ * examples/inifile/inifile_main.c
+ * A boot-time benchmark for the INI file parser
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+
+#include <apps/inifile.h>
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_INIFILE_PATH
+#  define CONFIG_EXAMPLES_INIFILE_PATH "/tmp/bench.ini"
+#endif
+
+#ifndef CONFIG_EXAMPLES_INIFILE_NSECTIONS
+#  define CONFIG_EXAMPLES_INIFILE_NSECTIONS 20
+#endif
+
+#ifndef CONFIG_EXAMPLES_INIFILE_NVARIABLES
+#  define CONFIG_EXAMPLES_INIFILE_NVARIABLES 10
+#endif
+
+#define NSECTIONS  CONFIG_EXAMPLES_INIFILE_NSECTIONS
+#define NVARIABLES CONFIG_EXAMPLES_INIFILE_NVARIABLES
+
+/* The expected value of a variable */
+
+#define VALUE(s,v) ((long)(s) * 1000 + (v))
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: inifile_gettime
+ ****************************************************************************/
+
+static void inifile_gettime(FAR struct timespec *tp)
+{
+#ifdef CONFIG_CLOCK_MONOTONIC
+  (void)clock_gettime(CLOCK_MONOTONIC, tp);
+#else
+  (void)clock_gettime(CLOCK_REALTIME, tp);
+#endif
+}
+
+/****************************************************************************
+ * Name: inifile_elapsed
+ *
+ * Description:
+ *   Return the time since 'start' in microseconds
+ *
+ ****************************************************************************/
+
+static unsigned long inifile_elapsed(FAR const struct timespec *start)
+{
+  struct timespec now;
+
+  inifile_gettime(&now);
+  return (unsigned long)(now.tv_sec - start->tv_sec) * 1000000 +
+         (now.tv_nsec - start->tv_nsec) / 1000;
+}
+
+/****************************************************************************
+ * Name: inifile_generate
+ *
+ * Description:
+ *   Create an INI file with NSECTIONS sections of NVARIABLES variables
+ *   each.  Each section begins with a comment and a string variable.
+ *
+ ****************************************************************************/
+
+static int inifile_generate(FAR const char *path)
+{
+  FAR FILE *stream;
+  int s;
+  int v;
+
+  stream = fopen(path, "w");
+  if (!stream)
+    {
+      printf("ERROR: Failed to create %s: %d\n", path, errno);
+      return -1;
+    }
+
+  fprintf(stream, "; Generated INI file benchmark\n\n");
+  for (s = 0; s < NSECTIONS; s++)
+    {
+      fprintf(stream, "[Section%d]\n", s);
+      fprintf(stream, "; Settings for section %d\n", s);
+      fprintf(stream, "  Name=This is the name of section %d\n", s);
+
+      for (v = 0; v < NVARIABLES; v++)
+        {
+          fprintf(stream, "  Variable%d=%ld\n", v, VALUE(s, v));
+        }
+
+      fprintf(stream, "\n");
+    }
+
+  fclose(stream);
+  return 0;
+}
+
+/****************************************************************************
+ * Name: inifile_readall
+ *
+ * Description:
+ *   Read every variable in the INI file, verifying each value.  Returns the
+ *   number of errors.
+ *
+ ****************************************************************************/
+
+static int inifile_readall(INIHANDLE handle)
+{
+  char section[16];
+  char variable[16];
+  long value;
+  int errors = 0;
+  int s;
+  int v;
+
+  for (s = 0; s < NSECTIONS; s++)
+    {
+      snprintf(section, sizeof(section), "section%d", s);
+      for (v = 0; v < NVARIABLES; v++)
+        {
+          snprintf(variable, sizeof(variable), "VARIABLE%d", v);
+          value = inifile_read_integer(handle, section, variable, -1);
+          if (value != VALUE(s, v))
+            {
+              printf("ERROR: %s %s=%ld expected %ld\n",
+                     section, variable, value, VALUE(s, v));
+              errors++;
+            }
+        }
+    }
+
+  return errors;
+}
+
+/****************************************************************************
+ * Name: inifile_readnames
+ *
+ * Description:
+ *   Read the string variable from every section, verifying each value.
+ *   Returns the number of errors.
+ *
+ ****************************************************************************/
+
+static int inifile_readnames(INIHANDLE handle)
+{
+  char section[16];
+  char expected[48];
+  FAR char *value;
+  int errors = 0;
+  int s;
+
+  for (s = 0; s < NSECTIONS; s++)
+    {
+      snprintf(section, sizeof(section), "Section%d", s);
+      snprintf(expected, sizeof(expected),
+               "This is the name of section %d", s);
+
+      value = inifile_read_string(handle, section, "Name", "");
+      if (!value || strcmp(value, expected) != 0)
+        {
+          printf("ERROR: %s Name=%s\n", section, value ? value : "(null)");
+          errors++;
+        }
+
+      inifile_free_string(value);
+    }
+
+  return errors;
+}
+
+#ifdef CONFIG_SYSTEM_INIFILE_CACHE
+/****************************************************************************
+ * Name: inifile_getnames
+ *
+ * Description:
+ *   Get the string variable from every section without copying it,
+ *   verifying each value.  Returns the number of errors.
+ *
+ ****************************************************************************/
+
+static int inifile_getnames(INIHANDLE handle)
+{
+  char section[16];
+  char expected[48];
+  FAR const char *value;
+  int errors = 0;
+  int s;
+
+  for (s = 0; s < NSECTIONS; s++)
+    {
+      snprintf(section, sizeof(section), "Section%d", s);
+      snprintf(expected, sizeof(expected),
+               "This is the name of section %d", s);
+
+      value = inifile_get_string(handle, section, "Name", "");
+      if (strcmp(value, expected) != 0)
+        {
+          printf("ERROR: %s Name=%s\n", section, value);
+          errors++;
+        }
+    }
+
+  return errors;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * inifile_main
+ ****************************************************************************/
+
+#ifdef CONFIG_BUILD_KERNEL
+int main(int argc, FAR char *argv[])
+#else
+int inifile_main(int argc, char *argv[])
+#endif
+{
+  FAR const char *path = CONFIG_EXAMPLES_INIFILE_PATH;
+  struct timespec start;
+  INIHANDLE handle;
+  unsigned long usec;
+  int errors;
+
+  if (argc > 1)
+    {
+      path = argv[1];
+    }
+
+  printf("Generating %s: %d sections, %d variables per section\n",
+         path, NSECTIONS, NVARIABLES);
+
+  if (inifile_generate(path) < 0)
+    {
+      return EXIT_FAILURE;
+    }
+
+#ifdef CONFIG_SYSTEM_INIFILE_CACHE
+  printf("Mode: cached\n");
+#else
+  printf("Mode: file\n");
+#endif
+
+  /* Open the INI file */
+
+  inifile_gettime(&start);
+  handle = inifile_initialize(path);
+  usec   = inifile_elapsed(&start);
+
+  if (!handle)
+    {
+      printf("ERROR: Failed to open %s\n", path);
+      (void)unlink(path);
+      return EXIT_FAILURE;
+    }
+
+  printf("  inifile_initialize:  %10lu usec\n", usec);
+
+  /* Read every integer variable */
+
+  inifile_gettime(&start);
+  errors = inifile_readall(handle);
+  usec   = inifile_elapsed(&start);
+
+  printf("  inifile_read_integer:%10lu usec for %d reads\n",
+         usec, NSECTIONS * NVARIABLES);
+
+  /* Read the string variable from every section */
+
+  inifile_gettime(&start);
+  errors += inifile_readnames(handle);
+  usec    = inifile_elapsed(&start);
+
+  printf("  inifile_read_string: %10lu usec for %d reads\n",
+         usec, NSECTIONS);
+
+#ifdef CONFIG_SYSTEM_INIFILE_CACHE
+  inifile_gettime(&start);
+  errors += inifile_getnames(handle);
+  usec    = inifile_elapsed(&start);
+
+  printf("  inifile_get_string:  %10lu usec for %d reads\n",
+         usec, NSECTIONS);
+
+  /* The file has not changed so reloading should do nothing */
+
+  if (inifile_reload(handle) != 0)
+    {
+      printf("ERROR: inifile_reload() re-read an unchanged file\n");
+      errors++;
+    }
+#endif
+
+  inifile_gettime(&start);
+  inifile_uninitialize(handle);
+  usec = inifile_elapsed(&start);
+
+  printf("  inifile_uninitialize:%10lu usec\n", usec);
+
+  (void)unlink(path);
+  printf("%d errors\n", errors);
+  return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
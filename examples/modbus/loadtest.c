@@ -0,0 +1,515 @@
+/****************************************************************************
+ * apps/examples/modbus/loadtest.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <errno.h>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define MB_TCP_HDR_SIZE           7
+#define MB_TCP_MAX_ADU            (256 + 7)
+#define MB_FUNC_READ_HOLDING      0x03
+
+#define DEFAULT_NCLIENTS          32
+#define DEFAULT_DEPTH             1
+#define DEFAULT_DURATION          10    /* Seconds */
+#define DEFAULT_PORT              502
+#define DEFAULT_NREGS             10
+
+/* The default reads the example's holding registers, starting at register
+ * 2000.  Register addresses in the PDU are zero based.
+ */
+
+#define DEFAULT_ADDRESS           1999
+
+#define MAX_DEPTH                 16
+
+/* Latencies are collected in a histogram of 10 microsecond bins */
+
+#define HIST_USEC                 10
+#define HIST_NBINS                100000
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The state of one client connection */
+
+struct client_s
+{
+  int      fd;
+  uint16_t tid;                       /* Transaction ID of the next request */
+  int      noutstanding;              /* Requests sent, not yet answered */
+  double   sent[MAX_DEPTH];           /* Send time indexed by TID % depth */
+  size_t   rxlen;
+  uint8_t  rxbuf[MAX_DEPTH * MB_TCP_MAX_ADU];
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct sockaddr_in g_server;
+static int g_depth   = DEFAULT_DEPTH;
+static int g_address = DEFAULT_ADDRESS;
+static int g_nregs   = DEFAULT_NREGS;
+
+static uint32_t g_hist[HIST_NBINS + 1];
+static unsigned long g_nresponses;
+static unsigned long g_nexceptions;
+static unsigned long g_nerrors;
+static double g_maxlatency;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: show_usage
+ ****************************************************************************/
+
+static void show_usage(const char *progname)
+{
+  fprintf(stderr, "USAGE: %s [-n <nclients>] [-p <depth>] "
+          "[-d <seconds>] [-a <address>] [-r <nregs>] "
+          "[-s <server-ip>] [-P <port>]\n", progname);
+  fprintf(stderr, "  Defaults: -n %d -p %d -d %d -a %d -r %d "
+          "-s 127.0.0.1 -P %d\n", DEFAULT_NCLIENTS, DEFAULT_DEPTH,
+          DEFAULT_DURATION, DEFAULT_ADDRESS, DEFAULT_NREGS, DEFAULT_PORT);
+  fprintf(stderr, "  <depth> is the number of requests each client keeps "
+          "outstanding (1-%d)\n", MAX_DEPTH);
+  exit(1);
+}
+
+/****************************************************************************
+ * Name: now_msec
+ ****************************************************************************/
+
+static double now_msec(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)now.tv_sec * 1000.0 + (double)now.tv_nsec / 1000000.0;
+}
+
+/****************************************************************************
+ * Name: record_latency
+ ****************************************************************************/
+
+static void record_latency(double msec)
+{
+  long bin = (long)(msec * 1000.0 / HIST_USEC);
+
+  if (bin < 0)
+    {
+      bin = 0;
+    }
+  else if (bin > HIST_NBINS)
+    {
+      bin = HIST_NBINS;
+    }
+
+  g_hist[bin]++;
+  if (msec > g_maxlatency)
+    {
+      g_maxlatency = msec;
+    }
+}
+
+/****************************************************************************
+ * Name: percentile
+ *
+ * Description:
+ *   Return the latency in milliseconds below which the fraction 'p' of
+ *   all responses fell.
+ *
+ ****************************************************************************/
+
+static double percentile(double p)
+{
+  unsigned long target = (unsigned long)(p * g_nresponses);
+  unsigned long count = 0;
+  long bin;
+
+  for (bin = 0; bin <= HIST_NBINS; bin++)
+    {
+      count += g_hist[bin];
+      if (count > target)
+        {
+          break;
+        }
+    }
+
+  return (double)(bin + 1) * HIST_USEC / 1000.0;
+}
+
+/****************************************************************************
+ * Name: client_connect
+ ****************************************************************************/
+
+static int client_connect(struct client_s *client)
+{
+  int one = 1;
+
+  client->fd = socket(PF_INET, SOCK_STREAM, 0);
+  if (client->fd < 0)
+    {
+      perror("socket");
+      return -1;
+    }
+
+  if (connect(client->fd, (struct sockaddr *)&g_server,
+              sizeof(g_server)) < 0)
+    {
+      perror("connect");
+      close(client->fd);
+      client->fd = -1;
+      return -1;
+    }
+
+  (void)setsockopt(client->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  return 0;
+}
+
+/****************************************************************************
+ * Name: client_send
+ *
+ * Description:
+ *   Top up the client's outstanding requests to the configured depth.  All
+ *   of them go out in a single write.
+ *
+ ****************************************************************************/
+
+static int client_send(struct client_s *client)
+{
+  uint8_t buffer[MAX_DEPTH * 12];
+  uint8_t *ptr = buffer;
+  double now = now_msec();
+
+  while (client->noutstanding < g_depth)
+    {
+      ptr[0]  = client->tid >> 8;
+      ptr[1]  = client->tid & 0xff;
+      ptr[2]  = 0;                    /* Protocol ID */
+      ptr[3]  = 0;
+      ptr[4]  = 0;                    /* Length: unit ID + 5 byte PDU */
+      ptr[5]  = 6;
+      ptr[6]  = 0xff;                 /* Unit ID */
+      ptr[7]  = MB_FUNC_READ_HOLDING;
+      ptr[8]  = g_address >> 8;
+      ptr[9]  = g_address & 0xff;
+      ptr[10] = g_nregs >> 8;
+      ptr[11] = g_nregs & 0xff;
+
+      client->sent[client->tid % g_depth] = now;
+      client->tid++;
+      client->noutstanding++;
+      ptr += 12;
+    }
+
+  if (ptr > buffer &&
+      send(client->fd, buffer, ptr - buffer, 0) != ptr - buffer)
+    {
+      perror("send");
+      return -1;
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: client_receive
+ *
+ * Description:
+ *   Read whatever the server sent and account for each complete response.
+ *   Responses must come back in order.
+ *
+ ****************************************************************************/
+
+static int client_receive(struct client_s *client)
+{
+  uint16_t expected;
+  uint16_t tid;
+  size_t len;
+  ssize_t nrecvd;
+
+  nrecvd = recv(client->fd, &client->rxbuf[client->rxlen],
+                sizeof(client->rxbuf) - client->rxlen, 0);
+  if (nrecvd <= 0)
+    {
+      fprintf(stderr, "Connection closed by the server\n");
+      return -1;
+    }
+
+  client->rxlen += nrecvd;
+
+  while (client->rxlen >= MB_TCP_HDR_SIZE + 1)
+    {
+      len = (((size_t)client->rxbuf[4] << 8) | client->rxbuf[5]) + 6;
+      if (len > MB_TCP_MAX_ADU)
+        {
+          fprintf(stderr, "Bad response length: %lu\n", (unsigned long)len);
+          return -1;
+        }
+
+      if (client->rxlen < len)
+        {
+          break;
+        }
+
+      tid      = ((uint16_t)client->rxbuf[0] << 8) | client->rxbuf[1];
+      expected = client->tid - client->noutstanding;
+
+      if (tid != expected)
+        {
+          fprintf(stderr, "Out of order response: TID %u, expected %u\n",
+                  tid, expected);
+          g_nerrors++;
+        }
+      else if ((client->rxbuf[7] & 0x80) != 0)
+        {
+          g_nexceptions++;
+        }
+      else if (client->rxbuf[7] != MB_FUNC_READ_HOLDING ||
+               client->rxbuf[8] != 2 * g_nregs ||
+               len != (size_t)(MB_TCP_HDR_SIZE + 2 + 2 * g_nregs))
+        {
+          g_nerrors++;
+        }
+      else
+        {
+          record_latency(now_msec() - client->sent[tid % g_depth]);
+          g_nresponses++;
+        }
+
+      client->noutstanding--;
+      client->rxlen -= len;
+      memmove(client->rxbuf, &client->rxbuf[len], client->rxlen);
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char **argv)
+{
+  struct client_s *clients;
+  struct pollfd *fds;
+  double start;
+  double stop;
+  double elapsed;
+  int nclients = DEFAULT_NCLIENTS;
+  int duration = DEFAULT_DURATION;
+  int port     = DEFAULT_PORT;
+  int ret      = 0;
+  int option;
+  int i;
+
+  memset(&g_server, 0, sizeof(g_server));
+  g_server.sin_family      = AF_INET;
+  g_server.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  while ((option = getopt(argc, argv, "n:p:d:a:r:s:P:")) != -1)
+    {
+      switch (option)
+        {
+          case 'n':
+            nclients = atoi(optarg);
+            break;
+
+          case 'p':
+            g_depth = atoi(optarg);
+            break;
+
+          case 'd':
+            duration = atoi(optarg);
+            break;
+
+          case 'a':
+            g_address = atoi(optarg);
+            break;
+
+          case 'r':
+            g_nregs = atoi(optarg);
+            break;
+
+          case 's':
+            if (inet_pton(AF_INET, optarg, &g_server.sin_addr) != 1)
+              {
+                show_usage(argv[0]);
+              }
+            break;
+
+          case 'P':
+            port = atoi(optarg);
+            break;
+
+          default:
+            show_usage(argv[0]);
+            break;
+        }
+    }
+
+  if (nclients <= 0 || g_depth <= 0 || g_depth > MAX_DEPTH ||
+      duration <= 0 || g_nregs <= 0 || g_nregs > 125 ||
+      g_address < 0 || g_address > 0xffff || port <= 0 || port > 0xffff)
+    {
+      show_usage(argv[0]);
+    }
+
+  g_server.sin_port = htons(port);
+
+  clients = (struct client_s *)calloc(nclients, sizeof(struct client_s));
+  fds     = (struct pollfd *)calloc(nclients, sizeof(struct pollfd));
+  if (clients == NULL || fds == NULL)
+    {
+      fprintf(stderr, "Failed to allocate %d clients\n", nclients);
+      return 1;
+    }
+
+  for (i = 0; i < nclients; i++)
+    {
+      if (client_connect(&clients[i]) < 0)
+        {
+          nclients = i;
+          ret = 1;
+          goto errout;
+        }
+
+      fds[i].fd     = clients[i].fd;
+      fds[i].events = POLLIN;
+    }
+
+  /* Run all clients until the time is up, then wait for the responses
+   * that are still outstanding.
+   */
+
+  start = now_msec();
+  stop  = start + duration * 1000.0;
+
+  for (i = 0; i < nclients; i++)
+    {
+      if (client_send(&clients[i]) < 0)
+        {
+          ret = 1;
+          goto errout;
+        }
+    }
+
+  for (; ; )
+    {
+      bool running = now_msec() < stop;
+      bool pending = false;
+
+      for (i = 0; i < nclients; i++)
+        {
+          pending |= clients[i].noutstanding > 0;
+        }
+
+      if (!pending)
+        {
+          break;
+        }
+
+      if (poll(fds, nclients, 5000) <= 0)
+        {
+          fprintf(stderr, "Timed out waiting for responses\n");
+          ret = 1;
+          break;
+        }
+
+      for (i = 0; i < nclients; i++)
+        {
+          if (fds[i].revents == 0)
+            {
+              continue;
+            }
+
+          if (client_receive(&clients[i]) < 0 ||
+              (running && client_send(&clients[i]) < 0))
+            {
+              ret = 1;
+              goto errout;
+            }
+        }
+    }
+
+  elapsed = now_msec() - start;
+
+  printf("%d clients, %d outstanding each: %lu responses in %.1f ms "
+         "(%.1f requests/sec)\n", nclients, g_depth, g_nresponses, elapsed,
+         g_nresponses * 1000.0 / elapsed);
+  printf("  Exceptions: %lu  Errors: %lu\n", g_nexceptions, g_nerrors);
+  if (g_nresponses > 0)
+    {
+      printf("  Latency (ms): p50 %.2f  p99 %.2f  max %.2f\n",
+             percentile(0.50), percentile(0.99), g_maxlatency);
+    }
+
+errout:
+  for (i = 0; i < nclients; i++)
+    {
+      close(clients[i].fd);
+    }
+
+  free(fds);
+  free(clients);
+  return ret;
+}
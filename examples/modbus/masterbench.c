@@ -0,0 +1,593 @@
+/****************************************************************************
+ * apps/examples/modbus/masterbench.c
+ * Host benchmark for the asynchronous Modbus RTU master
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <errno.h>
+
+#include <apps/modbus/mbmaster.h>
+
+#include "mbcrc.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define DEFAULT_NSLAVES     40
+#define DEFAULT_NREGS       500
+#define DEFAULT_BAUD        115200
+#define DEFAULT_TURNAROUND  1000    /* Slave response delay (usec) */
+#define DEFAULT_MAXGAP      16
+
+#define ADDR_SPAN           200     /* Registers are scattered over 0-199 */
+#define MAX_REQUESTS        1000
+#define MAX_BUSES           4
+#define ORDER_NSLAVES       8       /* Slaves in the write ordering check */
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct request_s
+{
+  uint8_t  slave;
+  uint16_t addr;
+  uint16_t nregs;
+  bool     done;
+};
+
+/* One request of the write ordering check */
+
+struct order_s
+{
+  uint16_t value;           /* Value written, or expected in register 1 */
+  bool     done;
+  bool     ok;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct request_s g_requests[MAX_REQUESTS];
+static int g_nrequests;
+static int g_ndone;
+static int g_nerrors;
+
+static int g_baud       = DEFAULT_BAUD;
+static int g_turnaround = DEFAULT_TURNAROUND;
+
+static struct mbmaster_s g_masters[MAX_BUSES];
+static pid_t g_slaves[MAX_BUSES];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void show_usage(const char *progname)
+{
+  fprintf(stderr, "USAGE: %s [-s <nslaves>] [-r <nregs>] [-b <baud>] "
+          "[-t <turnaround-usec>] [-g <maxgap>]\n", progname);
+  fprintf(stderr, "  Defaults: -s %d -r %d -b %d -t %d -g %d\n",
+          DEFAULT_NSLAVES, DEFAULT_NREGS, DEFAULT_BAUD, DEFAULT_TURNAROUND,
+          DEFAULT_MAXGAP);
+  exit(1);
+}
+
+static double now_msec(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)now.tv_sec * 1000.0 + (double)now.tv_nsec / 1000000.0;
+}
+
+/* The value the simulated slaves hold in each register */
+
+static uint16_t reg_value(uint8_t slave, uint16_t addr)
+{
+  return (uint16_t)(slave << 10) ^ addr;
+}
+
+/****************************************************************************
+ * Slave simulator
+ *
+ * Serves holding and input registers 0-999 of slaves 'first' to 'last' on
+ * the slave side of a pty.  Written registers keep the written value.  The
+ * pty transfers data instantly, so the simulator waits for the time the
+ * request and the response would take on the wire, plus the slave's
+ * turnaround time, before it answers.
+ *
+ ****************************************************************************/
+
+static void slave_sleep(int nchars)
+{
+  struct timespec ts;
+  long usec = (long)nchars * 11 * 1000000 / g_baud + g_turnaround;
+
+  ts.tv_sec  = usec / 1000000;
+  ts.tv_nsec = (usec % 1000000) * 1000;
+  nanosleep(&ts, NULL);
+}
+
+static void slave_simulator(int fd, int first, int last)
+{
+  static uint16_t regs[248][1000];
+  uint8_t req[256];
+  uint8_t rsp[256];
+  uint16_t crc;
+  uint16_t addr;
+  uint16_t nregs;
+  size_t reqlen;
+  size_t rsplen;
+  size_t len = 0;
+  ssize_t n;
+  int i;
+
+  for (i = 0; i < 248 * 1000; i++)
+    {
+      regs[i / 1000][i % 1000] = reg_value(i / 1000, i % 1000);
+    }
+
+  for (; ; )
+    {
+      n = read(fd, &req[len], sizeof(req) - len);
+      if (n <= 0)
+        {
+          _exit(0);
+        }
+
+      len += n;
+
+      while (len >= 8)
+        {
+          reqlen = req[1] == 0x10 ? 9 + req[6] : 8;
+          if (len < reqlen)
+            {
+              break;
+            }
+
+          addr  = ((uint16_t)req[2] << 8) | req[3];
+          nregs = ((uint16_t)req[4] << 8) | req[5];
+
+          rsp[0] = req[0];
+          rsp[1] = req[1];
+
+          if (usMBCRC16(req, reqlen) != 0 || req[0] < first ||
+              req[0] > last)
+            {
+              /* Not for us */
+
+              rsplen = 0;
+            }
+          else if ((req[1] == 0x03 || req[1] == 0x04) &&
+                   nregs >= 1 && nregs <= 125 && addr + nregs <= 1000)
+            {
+              rsp[2] = 2 * nregs;
+              for (i = 0; i < nregs; i++)
+                {
+                  uint16_t value = regs[req[0]][addr + i];
+                  rsp[3 + 2 * i] = value >> 8;
+                  rsp[4 + 2 * i] = value & 0xff;
+                }
+
+              rsplen = 3 + 2 * nregs;
+            }
+          else if (req[1] == 0x06 && addr < 1000)
+            {
+              regs[req[0]][addr] = nregs;
+              memcpy(&rsp[2], &req[2], 4);
+              rsplen = 6;
+            }
+          else if (req[1] == 0x10 && nregs >= 1 && nregs <= 123 &&
+                   addr + nregs <= 1000)
+            {
+              for (i = 0; i < nregs; i++)
+                {
+                  regs[req[0]][addr + i] = ((uint16_t)req[7 + 2 * i] << 8) |
+                                           req[8 + 2 * i];
+                }
+
+              memcpy(&rsp[2], &req[2], 4);
+              rsplen = 6;
+            }
+          else
+            {
+              rsp[1] |= 0x80;
+              rsp[2]  = 0x02;
+              rsplen  = 3;
+            }
+
+          if (rsplen > 0)
+            {
+              crc = usMBCRC16(rsp, rsplen);
+              rsp[rsplen++] = crc & 0xff;
+              rsp[rsplen++] = crc >> 8;
+
+              slave_sleep(reqlen + rsplen);
+              if (write(fd, rsp, rsplen) != (ssize_t)rsplen)
+                {
+                  _exit(1);
+                }
+            }
+
+          len -= reqlen;
+          memmove(req, &req[reqlen], len);
+        }
+    }
+}
+
+static int start_bus(int bus, int first, int last)
+{
+  struct termios tio;
+  char *name;
+  int master;
+  int slave;
+
+  master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0 ||
+      (name = ptsname(master)) == NULL)
+    {
+      perror("pty");
+      return -1;
+    }
+
+  slave = open(name, O_RDWR | O_NOCTTY);
+  if (slave < 0)
+    {
+      perror(name);
+      return -1;
+    }
+
+  tcgetattr(slave, &tio);
+  cfmakeraw(&tio);
+  tcsetattr(slave, TCSANOW, &tio);
+
+  g_slaves[bus] = fork();
+  if (g_slaves[bus] == 0)
+    {
+      close(slave);
+      slave_simulator(master, first, last);
+    }
+
+  close(master);
+
+  /* The master under test opens the pty slave device just like a serial
+   * port.  Our own descriptor only kept the raw settings in place.
+   */
+
+  if (eMBMasterAsyncInit(&g_masters[bus], name, g_baud, MB_PAR_NONE) !=
+      MB_ENOERR)
+    {
+      fprintf(stderr, "Failed to open %s\n", name);
+      close(slave);
+      return -1;
+    }
+
+  close(slave);
+  return 0;
+}
+
+/****************************************************************************
+ * Benchmark
+ ****************************************************************************/
+
+static void read_done(FAR void *arg, eMBMasterReqErrCode status,
+                      FAR const uint16_t *regs, uint16_t nregs)
+{
+  FAR struct request_s *req = (FAR struct request_s *)arg;
+  int i;
+
+  req->done = true;
+  g_ndone++;
+
+  if (status != MB_MRE_NO_ERR || nregs != req->nregs)
+    {
+      g_nerrors++;
+      return;
+    }
+
+  for (i = 0; i < nregs; i++)
+    {
+      if (regs[i] != reg_value(req->slave, req->addr + i))
+        {
+          g_nerrors++;
+          return;
+        }
+    }
+}
+
+static void make_requests(int nslaves, int nregs)
+{
+  int i;
+
+  srand(42);
+  g_nrequests = 0;
+
+  /* Mostly single registers with the occasional short block, scattered
+   * over the slaves in random order like a typical SCADA poll list.
+   */
+
+  for (i = 0; i < nregs && g_nrequests < MAX_REQUESTS; g_nrequests++)
+    {
+      FAR struct request_s *req = &g_requests[g_nrequests];
+
+      req->slave = 1 + rand() % nslaves;
+      req->addr  = rand() % ADDR_SPAN;
+      req->nregs = (rand() % 8) == 0 ? 1 + rand() % 4 : 1;
+      i         += req->nregs;
+    }
+}
+
+static int run(const char *name, int nbuses, int nslaves, int maxgap,
+               bool oneatatime)
+{
+  FAR struct mbmaster_s *masters[MAX_BUSES];
+  double start;
+  double elapsed;
+  uint32_t frames = 0;
+  int pending;
+  int next = 0;
+  int bus;
+  int i;
+
+  for (i = 0; i < g_nrequests; i++)
+    {
+      g_requests[i].done = false;
+    }
+
+  g_ndone   = 0;
+  g_nerrors = 0;
+
+  for (bus = 0; bus < nbuses; bus++)
+    {
+      masters[bus]            = &g_masters[bus];
+      masters[bus]->usMaxGap  = maxgap;
+      masters[bus]->ulFrames  = 0;
+    }
+
+  start = now_msec();
+
+  while (g_ndone < g_nrequests)
+    {
+      /* Queue as many requests as the masters accept.  Slaves are split
+       * evenly between the buses.
+       */
+
+      while (next < g_nrequests && (!oneatatime || next == g_ndone))
+        {
+          FAR struct request_s *req = &g_requests[next];
+
+          bus = (req->slave - 1) * nbuses / nslaves;
+          if (eMBMasterAsyncReadHolding(masters[bus], req->slave, req->addr,
+                                        req->nregs, read_done, req) !=
+              MB_ENOERR)
+            {
+              break;
+            }
+
+          next++;
+        }
+
+      pending = iMBMasterAsyncPoll(masters, nbuses, 1000);
+      if (pending < 0)
+        {
+          perror("iMBMasterAsyncPoll");
+          return -1;
+        }
+    }
+
+  elapsed = now_msec() - start;
+
+  for (bus = 0; bus < nbuses; bus++)
+    {
+      frames += masters[bus]->ulFrames;
+    }
+
+  printf("%-28s %6lu %10.1f %10.1f %8d\n", name, (unsigned long)frames,
+         elapsed, 1000.0 * g_nrequests / elapsed, g_nerrors);
+  return g_nerrors == 0 ? 0 : -1;
+}
+
+/* A read of registers 10-11 of each slave is queued, then a write to
+ * register 11, then the same read again.  The second read must not be
+ * merged into the first:  it has to see the written value.
+ */
+
+static void order_done(FAR void *arg, eMBMasterReqErrCode status,
+                       FAR const uint16_t *regs, uint16_t nregs)
+{
+  FAR struct order_s *check = (FAR struct order_s *)arg;
+
+  check->done = true;
+  check->ok   = status == MB_MRE_NO_ERR &&
+                (regs == NULL || (nregs == 2 && regs[1] == check->value));
+}
+
+static int check_order(int nslaves)
+{
+  FAR struct mbmaster_s *master = &g_masters[0];
+  static struct order_s checks[3 * ORDER_NSLAVES];
+  static uint16_t values[ORDER_NSLAVES];
+  FAR struct order_s *check;
+  int nchecks = 0;
+  int nerrors = 0;
+  int slave;
+  int i;
+
+  master->usMaxGap = DEFAULT_MAXGAP;
+
+  for (slave = 1; slave <= nslaves && slave <= ORDER_NSLAVES; slave++)
+    {
+      values[slave - 1] = (uint16_t)(0xa500 + slave);
+
+      check        = &checks[nchecks++];
+      check->value = reg_value(slave, 11);
+      eMBMasterAsyncReadHolding(master, slave, 10, 2, order_done, check);
+
+      check        = &checks[nchecks++];
+      check->value = values[slave - 1];
+      eMBMasterAsyncWriteHolding(master, slave, 11, 1, &values[slave - 1],
+                                 order_done, check);
+
+      check        = &checks[nchecks++];
+      check->value = values[slave - 1];
+      eMBMasterAsyncReadHolding(master, slave, 10, 2, order_done, check);
+    }
+
+  for (i = 0; i < nchecks; i++)
+    {
+      while (!checks[i].done)
+        {
+          if (iMBMasterAsyncPoll(&master, 1, 1000) < 0)
+            {
+              perror("iMBMasterAsyncPoll");
+              return -1;
+            }
+        }
+
+      if (!checks[i].ok)
+        {
+          nerrors++;
+        }
+    }
+
+  printf("%-28s %6d %10s %10s %8d\n", "Read after write order", nchecks,
+         "", "", nerrors);
+  return nerrors == 0 ? 0 : -1;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char **argv)
+{
+  int nslaves = DEFAULT_NSLAVES;
+  int nregs   = DEFAULT_NREGS;
+  int maxgap  = DEFAULT_MAXGAP;
+  int ret     = 0;
+  int option;
+  int bus;
+
+  while ((option = getopt(argc, argv, "s:r:b:t:g:h")) != ERROR)
+    {
+      switch (option)
+        {
+          case 's':
+            nslaves = atoi(optarg);
+            break;
+
+          case 'r':
+            nregs = atoi(optarg);
+            break;
+
+          case 'b':
+            g_baud = atoi(optarg);
+            break;
+
+          case 't':
+            g_turnaround = atoi(optarg);
+            break;
+
+          case 'g':
+            maxgap = atoi(optarg);
+            break;
+
+          default:
+            show_usage(argv[0]);
+        }
+    }
+
+  if (nslaves < 2 || nslaves > 247 || nregs < 1 || g_baud < 1200 ||
+      maxgap < 0 || maxgap > 124)
+    {
+      show_usage(argv[0]);
+    }
+
+  make_requests(nslaves, nregs);
+
+  /* Bus 0 serves every slave for the single bus runs, the two bus run
+   * splits the slaves between bus 0 and bus 1.
+   */
+
+  if (start_bus(0, 1, nslaves) < 0 || start_bus(1, nslaves / 2 + 1,
+                                                 nslaves) < 0)
+    {
+      return 1;
+    }
+
+  printf("%d requests (%d registers) to %d slaves at %d baud, "
+         "%d usec turnaround\n\n", g_nrequests, nregs, nslaves, g_baud,
+         g_turnaround);
+  printf("%-28s %6s %10s %10s %8s\n", "Mode", "Frames", "msec",
+         "req/sec", "Errors");
+
+  ret |= run("One at a time (blocking)", 1, nslaves, 0, true);
+  ret |= run("Async, no gap", 1, nslaves, 0, false);
+  ret |= run("Async, merged", 1, nslaves, maxgap, false);
+  ret |= run("Async, merged, 2 buses", 2, nslaves, maxgap, false);
+
+  /* This changes registers of the slaves, so it must come last */
+
+  ret |= check_order(nslaves);
+
+  for (bus = 0; bus < 2; bus++)
+    {
+      vMBMasterAsyncClose(&g_masters[bus]);
+      kill(g_slaves[bus], SIGTERM);
+      waitpid(g_slaves[bus], NULL, 0);
+    }
+
+  return ret == 0 ? 0 : 1;
+}
@@ -71,6 +71,10 @@
 #include <apps/modbus/mb.h>
 #include <apps/modbus/mbport.h>
 
+#ifdef CONFIG_MB_REGMAP
+#  include <apps/modbus/mbregmap.h>
+#endif
+
 /****************************************************************************
  * Definitions
  ****************************************************************************/
@@ -88,6 +92,10 @@
 #  define CONFIG_EXAMPLES_MODBUS_PARITY MB_PAR_EVEN
 #endif
 
+#ifndef CONFIG_EXAMPLES_MODBUS_TCPPORT
+#  define CONFIG_EXAMPLES_MODBUS_TCPPORT 502
+#endif
+
 #ifndef CONFIG_EXAMPLES_MODBUS_REG_INPUT_START
 #  define CONFIG_EXAMPLES_MODBUS_REG_INPUT_START 1000
 #endif
@@ -119,6 +127,9 @@ struct modbus_state_s
 {
   enum modbus_threadstate_e threadstate;
   uint16_t reginput[CONFIG_EXAMPLES_MODBUS_REG_INPUT_NREGS];
+#ifdef CONFIG_MB_REGMAP
+  uint16_t reginput2[CONFIG_EXAMPLES_MODBUS_REG_INPUT_NREGS];
+#endif
   uint16_t regholding[CONFIG_EXAMPLES_MODBUS_REG_HOLDING_NREGS];
   pthread_t threadid;
   pthread_mutex_t lock;
@@ -180,6 +191,20 @@ static inline int modbus_initialize(void)
 
   status = ENODEV;
 
+#ifdef CONFIG_EXAMPLES_MODBUS_TCP
+  /* Initialize the FreeModBus library for Modbus TCP.
+   *
+   * CONFIG_EXAMPLES_MODBUS_TCPPORT = TCP port, default=502
+   */
+
+  mberr = eMBTCPInit(CONFIG_EXAMPLES_MODBUS_TCPPORT);
+  if (mberr != MB_ENOERR)
+    {
+      fprintf(stderr, "modbus_main: "
+              "ERROR: eMBTCPInit failed: %d\n", mberr);
+      goto errout_with_mutex;
+    }
+#else
   /* Initialize the FreeModBus library.
    *
    * MB_RTU                        = RTU mode
@@ -197,7 +222,28 @@ static inline int modbus_initialize(void)
               "ERROR: eMBInit failed: %d\n", mberr);
       goto errout_with_mutex;
     }
+#endif
+
+#ifdef CONFIG_MB_REGMAP
+  /* Serve the registers straight from the arrays.  The input registers are
+   * double buffered.
+   */
 
+  if (eMBRegMapRegister(MB_REGMAP_INPUT,
+                        CONFIG_EXAMPLES_MODBUS_REG_INPUT_START,
+                        CONFIG_EXAMPLES_MODBUS_REG_INPUT_NREGS,
+                        g_modbus.reginput, g_modbus.reginput2) != MB_ENOERR ||
+      eMBRegMapRegister(MB_REGMAP_HOLDING,
+                        CONFIG_EXAMPLES_MODBUS_REG_HOLDING_START,
+                        CONFIG_EXAMPLES_MODBUS_REG_HOLDING_NREGS,
+                        g_modbus.regholding, NULL) != MB_ENOERR)
+    {
+      fprintf(stderr, "modbus_main: "
+              "ERROR: eMBRegMapRegister failed\n");
+      goto errout_with_modbus;
+    }
+
+#endif
   /* Set the slave ID
    *
    * 0x34        = Slave ID
@@ -254,6 +300,9 @@ errout_with_mutex:
 
 static void *modbus_pollthread(void *pvarg)
 {
+#ifdef CONFIG_MB_REGMAP
+  FAR uint16_t *reginput;
+#endif
   eMBErrorCode mberr;
   int ret;
 
@@ -283,7 +332,13 @@ static void *modbus_pollthread(void *pvarg)
 
       /* Generate some random input */
 
+#ifdef CONFIG_MB_REGMAP
+      reginput = (FAR uint16_t *)pvMBRegMapBeginUpdate(MB_REGMAP_INPUT);
+      reginput[0] = (uint16_t)rand();
+      vMBRegMapCommit(MB_REGMAP_INPUT);
+#else
       g_modbus.reginput[0] = (uint16_t)rand();
+#endif
     }
   while (g_modbus.threadstate != SHUTDOWN);
 
@@ -437,6 +492,7 @@ int modbus_main(int argc, char *argv[])
   return EXIT_SUCCESS;
 }
 
+#ifndef CONFIG_MB_REGMAP
 /****************************************************************************
  * Name: eMBRegInputCB
  *
@@ -554,3 +610,4 @@ eMBErrorCode eMBRegDiscreteCB(uint8_t *buffer, uint16_t address, uint16_t ndiscr
 {
   return MB_ENOREG;
 }
+#endif /* CONFIG_MB_REGMAP */
@@ -0,0 +1,177 @@
+/****************************************************************************
+ * apps/examples/osbench/cond.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <semaphore.h>
+#include <pthread.h>
+#include <errno.h>
+
+#include "osbench.h"
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct cond_bench_s
+{
+  FAR struct osbench_result_s *result;
+  pthread_mutex_t mutex;    /* Protects signaled and stop */
+  pthread_cond_t cond;      /* The condition that the waiter waits for */
+  sem_t ready;              /* The waiter is about to wait again */
+  struct timespec start;    /* When the condition was signaled */
+  bool signaled;            /* The condition */
+  bool stop;                /* Tells the waiter to exit */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static FAR void *cond_waiter(FAR void *arg)
+{
+  FAR struct cond_bench_s *priv = (FAR struct cond_bench_s *)arg;
+  struct timespec end;
+
+  pthread_mutex_lock(&priv->mutex);
+  for (; ; )
+    {
+      /* The signaler cannot take the mutex until we are waiting */
+
+      sem_post(&priv->ready);
+      while (!priv->signaled && !priv->stop)
+        {
+          pthread_cond_wait(&priv->cond, &priv->mutex);
+        }
+
+      if (priv->stop)
+        {
+          break;
+        }
+
+      osbench_gettime(&end);
+      (void)osbench_sample(priv->result, &priv->start, &end);
+      priv->signaled = false;
+    }
+
+  pthread_mutex_unlock(&priv->mutex);
+  return NULL;
+}
+
+static FAR void *cond_signaler(FAR void *arg)
+{
+  FAR struct cond_bench_s *priv = (FAR struct cond_bench_s *)arg;
+  bool done;
+
+  do
+    {
+      while (sem_wait(&priv->ready) < 0 && errno == EINTR);
+
+      done = osbench_done(priv->result);
+
+      pthread_mutex_lock(&priv->mutex);
+      osbench_gettime(&priv->start);
+      priv->signaled = !done;
+      priv->stop     = done;
+      pthread_cond_signal(&priv->cond);
+      pthread_mutex_unlock(&priv->mutex);
+    }
+  while (!done);
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: cond_bench
+ *
+ * Description:
+ *   Condition variable wake-up.  A high priority thread waits on a
+ *   condition variable.  Each sample is the time from when a low priority
+ *   thread begins to signal it until the high priority thread returns from
+ *   pthread_cond_wait() with the mutex, which is after the low priority
+ *   thread unlocks the mutex.
+ *
+ ****************************************************************************/
+
+int cond_bench(FAR struct osbench_result_s *result)
+{
+  struct cond_bench_s priv;
+  pthread_t waiter;
+  pthread_t signaler;
+  int ret;
+
+  priv.result   = result;
+  priv.signaled = false;
+  priv.stop     = false;
+  (void)pthread_mutex_init(&priv.mutex, NULL);
+  (void)pthread_cond_init(&priv.cond, NULL);
+  (void)sem_init(&priv.ready, 0, 0);
+
+  ret = osbench_thread(&waiter, OSBENCH_PRIO_HIGH, cond_waiter, &priv);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  ret = osbench_thread(&signaler, OSBENCH_PRIO_LOW, cond_signaler, &priv);
+  if (ret < 0)
+    {
+      pthread_mutex_lock(&priv.mutex);
+      priv.stop = true;
+      pthread_cond_signal(&priv.cond);
+      pthread_mutex_unlock(&priv.mutex);
+    }
+  else
+    {
+      (void)pthread_join(signaler, NULL);
+    }
+
+  (void)pthread_join(waiter, NULL);
+
+errout:
+  (void)sem_destroy(&priv.ready);
+  (void)pthread_cond_destroy(&priv.cond);
+  (void)pthread_mutex_destroy(&priv.mutex);
+  return ret;
+}
@@ -0,0 +1,199 @@
+/****************************************************************************
+ * apps/examples/osbench/mqueue.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <fcntl.h>
+#include <mqueue.h>
+#include <pthread.h>
+#include <errno.h>
+
+#include "osbench.h"
+
+#ifdef OSBENCH_HAVE_MQUEUE
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+#define MQ_NAME     "osbench"
+#define MQ_MAXMSG   4
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct mqueue_msg_s
+{
+  struct timespec start;    /* When the message was sent */
+  bool stop;                /* Tells the receiver to exit */
+};
+
+struct mqueue_bench_s
+{
+  FAR struct osbench_result_s *result;
+  mqd_t send;               /* Sending end of the queue */
+  mqd_t receive;            /* Receiving end of the queue */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static FAR void *mqueue_receiver(FAR void *arg)
+{
+  FAR struct mqueue_bench_s *priv = (FAR struct mqueue_bench_s *)arg;
+  struct mqueue_msg_s msg;
+  struct timespec end;
+  ssize_t nbytes;
+
+  for (; ; )
+    {
+      nbytes = mq_receive(priv->receive, (FAR char *)&msg, sizeof(msg),
+                          NULL);
+      if (nbytes < 0 && errno == EINTR)
+        {
+          continue;
+        }
+
+      if (nbytes != sizeof(msg) || msg.stop)
+        {
+          break;
+        }
+
+      osbench_gettime(&end);
+      (void)osbench_sample(priv->result, &msg.start, &end);
+    }
+
+  return NULL;
+}
+
+static FAR void *mqueue_sender(FAR void *arg)
+{
+  FAR struct mqueue_bench_s *priv = (FAR struct mqueue_bench_s *)arg;
+  struct mqueue_msg_s msg;
+
+  msg.stop = false;
+  while (!osbench_done(priv->result))
+    {
+      osbench_gettime(&msg.start);
+      if (mq_send(priv->send, (FAR const char *)&msg, sizeof(msg), 0) < 0)
+        {
+          break;
+        }
+    }
+
+  msg.stop = true;
+  (void)mq_send(priv->send, (FAR const char *)&msg, sizeof(msg), 0);
+  return NULL;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mqueue_bench
+ *
+ * Description:
+ *   Message queue latency.  A high priority thread waits in mq_receive().
+ *   Each sample is the time from just before a low priority thread calls
+ *   mq_send() until the high priority thread has the message.
+ *
+ ****************************************************************************/
+
+int mqueue_bench(FAR struct osbench_result_s *result)
+{
+  struct mqueue_bench_s priv;
+  struct mq_attr attr;
+  pthread_t receiver;
+  pthread_t sender;
+  int ret;
+
+  attr.mq_maxmsg  = MQ_MAXMSG;
+  attr.mq_msgsize = sizeof(struct mqueue_msg_s);
+  attr.mq_flags   = 0;
+
+  priv.result  = result;
+  priv.receive = mq_open(MQ_NAME, O_RDONLY | O_CREAT, 0666, &attr);
+  if (priv.receive == (mqd_t)-1)
+    {
+      return -errno;
+    }
+
+  priv.send = mq_open(MQ_NAME, O_WRONLY);
+  if (priv.send == (mqd_t)-1)
+    {
+      ret = -errno;
+      goto errout_with_receive;
+    }
+
+  ret = osbench_thread(&receiver, OSBENCH_PRIO_HIGH, mqueue_receiver,
+                       &priv);
+  if (ret < 0)
+    {
+      goto errout_with_send;
+    }
+
+  ret = osbench_thread(&sender, OSBENCH_PRIO_LOW, mqueue_sender, &priv);
+  if (ret < 0)
+    {
+      struct mqueue_msg_s msg;
+
+      msg.stop = true;
+      (void)mq_send(priv.send, (FAR const char *)&msg, sizeof(msg), 0);
+    }
+  else
+    {
+      (void)pthread_join(sender, NULL);
+    }
+
+  (void)pthread_join(receiver, NULL);
+
+errout_with_send:
+  (void)mq_close(priv.send);
+
+errout_with_receive:
+  (void)mq_close(priv.receive);
+  (void)mq_unlink(MQ_NAME);
+  return ret;
+}
+
+#endif /* OSBENCH_HAVE_MQUEUE */
@@ -0,0 +1,161 @@
+/****************************************************************************
+ * apps/examples/osbench/mutex.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <semaphore.h>
+#include <pthread.h>
+#include <errno.h>
+
+#include "osbench.h"
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct mutex_bench_s
+{
+  FAR struct osbench_result_s *result;
+  pthread_mutex_t mutex;    /* The contended mutex */
+  sem_t go;                 /* Lets the waiter try for the mutex again */
+  struct timespec start;    /* When the holder released the mutex */
+  volatile bool stop;       /* Tells the waiter to exit */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static FAR void *mutex_waiter(FAR void *arg)
+{
+  FAR struct mutex_bench_s *priv = (FAR struct mutex_bench_s *)arg;
+  struct timespec end;
+
+  for (; ; )
+    {
+      while (sem_wait(&priv->go) < 0 && errno == EINTR);
+      if (priv->stop)
+        {
+          break;
+        }
+
+      /* Blocks until the holder unlocks */
+
+      pthread_mutex_lock(&priv->mutex);
+      osbench_gettime(&end);
+      (void)osbench_sample(priv->result, &priv->start, &end);
+      pthread_mutex_unlock(&priv->mutex);
+    }
+
+  return NULL;
+}
+
+static FAR void *mutex_holder(FAR void *arg)
+{
+  FAR struct mutex_bench_s *priv = (FAR struct mutex_bench_s *)arg;
+
+  while (!osbench_done(priv->result))
+    {
+      /* The waiter runs as soon as it is posted, and blocks on the mutex.
+       * It runs again as soon as the mutex is unlocked.
+       */
+
+      pthread_mutex_lock(&priv->mutex);
+      sem_post(&priv->go);
+      osbench_gettime(&priv->start);
+      pthread_mutex_unlock(&priv->mutex);
+    }
+
+  priv->stop = true;
+  sem_post(&priv->go);
+  return NULL;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mutex_bench
+ *
+ * Description:
+ *   Mutex hand-off.  A low priority thread holds a mutex that a high
+ *   priority thread is blocked on.  Each sample is the time from the
+ *   unlock in the low priority thread until the high priority thread
+ *   returns from its lock.
+ *
+ ****************************************************************************/
+
+int mutex_bench(FAR struct osbench_result_s *result)
+{
+  struct mutex_bench_s priv;
+  pthread_t waiter;
+  pthread_t holder;
+  int ret;
+
+  priv.result = result;
+  priv.stop   = false;
+  (void)pthread_mutex_init(&priv.mutex, NULL);
+  (void)sem_init(&priv.go, 0, 0);
+
+  ret = osbench_thread(&waiter, OSBENCH_PRIO_HIGH, mutex_waiter, &priv);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  ret = osbench_thread(&holder, OSBENCH_PRIO_LOW, mutex_holder, &priv);
+  if (ret < 0)
+    {
+      priv.stop = true;
+      sem_post(&priv.go);
+    }
+  else
+    {
+      (void)pthread_join(holder, NULL);
+    }
+
+  (void)pthread_join(waiter, NULL);
+
+errout:
+  (void)sem_destroy(&priv.go);
+  (void)pthread_mutex_destroy(&priv.mutex);
+  return ret;
+}
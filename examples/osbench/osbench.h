@@ -0,0 +1,201 @@
+/****************************************************************************
+ * apps/examples/osbench/osbench.h
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_EXAMPLES_OSBENCH_OSBENCH_H
+#define __APPS_EXAMPLES_OSBENCH_OSBENCH_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h>
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+/* Configuration */
+
+#ifndef CONFIG_EXAMPLES_OSBENCH_SAMPLES
+#  define CONFIG_EXAMPLES_OSBENCH_SAMPLES 1000
+#endif
+
+#ifndef CONFIG_EXAMPLES_OSBENCH_PRIORITY
+#  define CONFIG_EXAMPLES_OSBENCH_PRIORITY 200
+#endif
+
+#ifndef CONFIG_EXAMPLES_OSBENCH_TIMER_PERIOD
+#  define CONFIG_EXAMPLES_OSBENCH_TIMER_PERIOD 10000
+#endif
+
+/* The scenarios that can be built.  These follow the same rules as the
+ * corresponding ostest tests.
+ */
+
+#ifndef CONFIG_DISABLE_MQUEUE
+#  define OSBENCH_HAVE_MQUEUE 1
+#endif
+
+#ifndef CONFIG_DISABLE_SIGNALS
+#  define OSBENCH_HAVE_SIGNAL 1
+#  ifndef CONFIG_DISABLE_POSIX_TIMERS
+#    define OSBENCH_HAVE_TIMER 1
+#  endif
+#  ifdef CONFIG_PRIORITY_INHERITANCE
+#    define OSBENCH_HAVE_PRIOINHERIT 1
+#  endif
+#endif
+
+/* The benchmark threads run at fixed priorities below the main thread, so
+ * that the main thread can always set up and tear down a scenario.
+ */
+
+#define OSBENCH_PRIO_HIGH   (CONFIG_EXAMPLES_OSBENCH_PRIORITY - 1)
+#define OSBENCH_PRIO_MEDIUM (CONFIG_EXAMPLES_OSBENCH_PRIORITY - 2)
+#define OSBENCH_PRIO_LOW    (CONFIG_EXAMPLES_OSBENCH_PRIORITY - 3)
+
+/* The first few samples of every scenario are not recorded:  they include
+ * the cost of faulting in stacks and warming caches.
+ */
+
+#define OSBENCH_WARMUP      8
+
+/* A clock that only advances once per system tick would read most short
+ * operations as zero.  Each sample is therefore taken over a batch of
+ * iterations that spans at least OSBENCH_BATCHTICKS steps of the clock
+ * resolution, and divided by the batch size.  The batch size is found
+ * during the warmup by doubling it, up to OSBENCH_MAXBATCH.
+ */
+
+#define OSBENCH_BATCHTICKS  32
+#define OSBENCH_MAXBATCH    65536
+
+/* Samples are measured with the highest resolution clock available */
+
+#ifdef CONFIG_CLOCK_MONOTONIC
+#  define OSBENCH_CLOCK     CLOCK_MONOTONIC
+#else
+#  define OSBENCH_CLOCK     CLOCK_REALTIME
+#endif
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* The samples of one scenario */
+
+struct osbench_result_s
+{
+  FAR const char *name;     /* Name of the scenario */
+  FAR uint32_t *sample;     /* Samples in nanoseconds per iteration */
+  int nsamples;             /* Number of samples wanted */
+  int count;                /* Number of samples taken, including warmup */
+  uint32_t batch;           /* Iterations per sample */
+  uint32_t iter;            /* Iterations so far in this batch */
+  uint32_t minbatch;        /* Shortest batch in nanoseconds */
+  bool single;              /* Never batch:  one iteration per sample */
+  struct timespec bstart;   /* Start of the first iteration of the batch */
+};
+
+/* A scenario.  Runs until result->nsamples samples have been recorded,
+ * and returns zero (OK) or a negated errno value.
+ */
+
+typedef CODE int (*osbench_t)(FAR struct osbench_result_s *result);
+
+/* Output formats */
+
+enum osbench_format_e
+{
+  OSBENCH_TEXT = 0,         /* Table for people */
+  OSBENCH_CSV,              /* One line per scenario */
+  OSBENCH_JSON              /* One object with all scenarios */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/* osbench_main.c ***********************************************************/
+
+int osbench_thread(FAR pthread_t *thread, int priority,
+                   CODE FAR void *(*entry)(FAR void *), FAR void *arg);
+
+/* osbench_report.c *********************************************************/
+
+void osbench_gettime(FAR struct timespec *ts);
+uint32_t osbench_resolution(void);
+uint32_t osbench_elapsed(FAR const struct timespec *start,
+                         FAR const struct timespec *end);
+void osbench_reset(FAR struct osbench_result_s *result);
+bool osbench_sample(FAR struct osbench_result_s *result,
+                    FAR const struct timespec *start,
+                    FAR const struct timespec *end);
+bool osbench_done(FAR const struct osbench_result_s *result);
+
+void osbench_header(enum osbench_format_e format, int nsamples);
+void osbench_report(enum osbench_format_e format, bool first,
+                    bool verbose, FAR struct osbench_result_s *result);
+void osbench_footer(enum osbench_format_e format);
+
+/* Scenarios ****************************************************************/
+
+int sem_bench(FAR struct osbench_result_s *result);
+int mutex_bench(FAR struct osbench_result_s *result);
+int cond_bench(FAR struct osbench_result_s *result);
+int pthread_bench(FAR struct osbench_result_s *result);
+
+#ifdef OSBENCH_HAVE_MQUEUE
+int mqueue_bench(FAR struct osbench_result_s *result);
+#endif
+
+#ifdef OSBENCH_HAVE_SIGNAL
+int signal_bench(FAR struct osbench_result_s *result);
+#endif
+
+#ifdef OSBENCH_HAVE_TIMER
+int timer_bench(FAR struct osbench_result_s *result);
+#endif
+
+#ifdef OSBENCH_HAVE_PRIOINHERIT
+int prioinherit_bench(FAR struct osbench_result_s *result);
+#endif
+
+#endif /* __APPS_EXAMPLES_OSBENCH_OSBENCH_H */
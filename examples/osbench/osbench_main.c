@@ -0,0 +1,267 @@
+/****************************************************************************
+ * apps/examples/osbench/osbench_main.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <errno.h>
+
+#include "osbench.h"
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct osbench_s
+{
+  FAR const char *name;     /* Name used in the results and with -t */
+  osbench_t bench;          /* The scenario */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct osbench_s g_osbench[] =
+{
+  { "sem-pingpong",  sem_bench         },
+  { "mutex-handoff", mutex_bench       },
+  { "cond-wakeup",   cond_bench        },
+#ifdef OSBENCH_HAVE_MQUEUE
+  { "mqueue-send",   mqueue_bench      },
+#endif
+#ifdef OSBENCH_HAVE_SIGNAL
+  { "signal",        signal_bench      },
+#endif
+  { "pthread-create", pthread_bench    },
+#ifdef OSBENCH_HAVE_TIMER
+  { "timer-jitter",  timer_bench       },
+#endif
+#ifdef OSBENCH_HAVE_PRIOINHERIT
+  { "prio-boost",    prioinherit_bench },
+#endif
+};
+
+#define NOSBENCH (sizeof(g_osbench) / sizeof(struct osbench_s))
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void show_usage(FAR const char *progname)
+{
+  unsigned int i;
+
+  fprintf(stderr, "USAGE: %s [-n <samples>] [-f text|csv|json] "
+          "[-t <test>] [-v]\n", progname);
+  fprintf(stderr, "  -n  Samples per test.  Default: %d\n",
+          CONFIG_EXAMPLES_OSBENCH_SAMPLES);
+  fprintf(stderr, "  -f  Output format.  Default: text\n");
+  fprintf(stderr, "  -t  Run only this test.  Tests:");
+  for (i = 0; i < NOSBENCH; i++)
+    {
+      fprintf(stderr, " %s", g_osbench[i].name);
+    }
+
+  fprintf(stderr, "\n  -v  Show histograms with the text output\n");
+  exit(EXIT_FAILURE);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: osbench_thread
+ *
+ * Description:
+ *   Start a benchmark thread with a fixed SCHED_FIFO priority.  Returns zero
+ *   (OK) or a negated errno value.
+ *
+ ****************************************************************************/
+
+int osbench_thread(FAR pthread_t *thread, int priority,
+                   CODE FAR void *(*entry)(FAR void *), FAR void *arg)
+{
+  struct sched_param sparam;
+  pthread_attr_t attr;
+  int ret;
+
+  (void)pthread_attr_init(&attr);
+  (void)pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+  (void)pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+
+  sparam.sched_priority = priority;
+  (void)pthread_attr_setschedparam(&attr, &sparam);
+
+  ret = pthread_create(thread, &attr, entry, arg);
+  (void)pthread_attr_destroy(&attr);
+  return -ret;
+}
+
+/****************************************************************************
+ * osbench_main
+ ****************************************************************************/
+
+#ifdef CONFIG_BUILD_KERNEL
+int main(int argc, FAR char *argv[])
+#else
+int osbench_main(int argc, char *argv[])
+#endif
+{
+  struct osbench_result_s result;
+  struct sched_param sparam;
+  struct sched_param saved;
+  enum osbench_format_e format = OSBENCH_TEXT;
+  FAR const char *only = NULL;
+  bool verbose = false;
+  bool first = true;
+  int nsamples = CONFIG_EXAMPLES_OSBENCH_SAMPLES;
+  int nerrors = 0;
+  int policy;
+  int option;
+  unsigned int i;
+  int ret;
+
+  while ((option = getopt(argc, argv, "n:f:t:vh")) != ERROR)
+    {
+      switch (option)
+        {
+          case 'n':
+            nsamples = atoi(optarg);
+            if (nsamples < 1)
+              {
+                show_usage(argv[0]);
+              }
+            break;
+
+          case 'f':
+            if (strcmp(optarg, "text") == 0)
+              {
+                format = OSBENCH_TEXT;
+              }
+            else if (strcmp(optarg, "csv") == 0)
+              {
+                format = OSBENCH_CSV;
+              }
+            else if (strcmp(optarg, "json") == 0)
+              {
+                format = OSBENCH_JSON;
+              }
+            else
+              {
+                show_usage(argv[0]);
+              }
+            break;
+
+          case 't':
+            only = optarg;
+            break;
+
+          case 'v':
+            verbose = true;
+            break;
+
+          case 'h':
+          default:
+            show_usage(argv[0]);
+        }
+    }
+
+  if (only != NULL)
+    {
+      for (i = 0; i < NOSBENCH && strcmp(only, g_osbench[i].name) != 0; i++);
+      if (i >= NOSBENCH)
+        {
+          show_usage(argv[0]);
+        }
+    }
+
+  result.sample = (FAR uint32_t *)malloc(nsamples * sizeof(uint32_t));
+  if (result.sample == NULL)
+    {
+      fprintf(stderr, "ERROR: Failed to allocate %d samples\n", nsamples);
+      return EXIT_FAILURE;
+    }
+
+  /* Run above all of the benchmark threads */
+
+  policy = sched_getscheduler(0);
+  (void)sched_getparam(0, &saved);
+  sparam.sched_priority = CONFIG_EXAMPLES_OSBENCH_PRIORITY;
+  (void)sched_setscheduler(0, SCHED_FIFO, &sparam);
+
+  osbench_header(format, nsamples);
+
+  for (i = 0; i < NOSBENCH; i++)
+    {
+      if (only != NULL && strcmp(only, g_osbench[i].name) != 0)
+        {
+          continue;
+        }
+
+      result.name     = g_osbench[i].name;
+      result.nsamples = nsamples;
+      osbench_reset(&result);
+
+      ret = g_osbench[i].bench(&result);
+      if (ret < 0)
+        {
+          fprintf(stderr, "ERROR: %s failed: %d\n", result.name, ret);
+          nerrors++;
+          continue;
+        }
+
+      osbench_report(format, first, verbose, &result);
+      first = false;
+      fflush(stdout);
+    }
+
+  osbench_footer(format);
+
+  (void)sched_setscheduler(0, policy, &saved);
+  free(result.sample);
+  return nerrors > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,364 @@
+/****************************************************************************
+ * apps/examples/osbench/osbench_report.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "osbench.h"
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+/* Histogram bucket n counts the samples below 2^(n + HIST_SHIFT) nsec.  The
+ * first bucket holds everything below about one microsecond.
+ */
+
+#define HIST_SHIFT    10
+#define HIST_NBUCKETS (33 - HIST_SHIFT)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct osbench_stats_s
+{
+  uint32_t min;
+  uint32_t avg;
+  uint32_t p50;
+  uint32_t p99;
+  uint32_t max;
+  uint32_t hist[HIST_NBUCKETS];
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static int osbench_compare(FAR const void *a, FAR const void *b)
+{
+  uint32_t sa = *(FAR const uint32_t *)a;
+  uint32_t sb = *(FAR const uint32_t *)b;
+
+  return sa < sb ? -1 : sa > sb ? 1 : 0;
+}
+
+static void osbench_stats(FAR struct osbench_result_s *result,
+                          FAR struct osbench_stats_s *stats)
+{
+  uint64_t sum = 0;
+  uint32_t sample;
+  int nsamples = result->nsamples;
+  int bucket;
+  int i;
+
+  memset(stats, 0, sizeof(struct osbench_stats_s));
+
+  qsort(result->sample, nsamples, sizeof(uint32_t), osbench_compare);
+
+  for (i = 0; i < nsamples; i++)
+    {
+      sample = result->sample[i];
+      sum   += sample;
+
+      for (bucket = 0;
+           bucket < HIST_NBUCKETS - 1 &&
+           (sample >> (bucket + HIST_SHIFT)) != 0;
+           bucket++);
+
+      stats->hist[bucket]++;
+    }
+
+  stats->min = result->sample[0];
+  stats->max = result->sample[nsamples - 1];
+  stats->p50 = result->sample[nsamples / 2];
+  stats->p99 = result->sample[(nsamples * 99 + 99) / 100 - 1];
+  stats->avg = (uint32_t)(sum / nsamples);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: osbench_gettime, osbench_resolution and osbench_elapsed
+ *
+ * Description:
+ *   Read the clock, get its resolution in nanoseconds, and get the
+ *   nanoseconds between two readings.
+ *
+ ****************************************************************************/
+
+void osbench_gettime(FAR struct timespec *ts)
+{
+  (void)clock_gettime(OSBENCH_CLOCK, ts);
+}
+
+uint32_t osbench_resolution(void)
+{
+  struct timespec res;
+
+  if (clock_getres(OSBENCH_CLOCK, &res) < 0 || res.tv_sec > 0)
+    {
+      return 1000000000;
+    }
+
+  return res.tv_nsec > 0 ? (uint32_t)res.tv_nsec : 1;
+}
+
+uint32_t osbench_elapsed(FAR const struct timespec *start,
+                         FAR const struct timespec *end)
+{
+  int64_t nsec;
+
+  nsec = (int64_t)(end->tv_sec - start->tv_sec) * 1000000000 +
+         (end->tv_nsec - start->tv_nsec);
+
+  if (nsec < 0)
+    {
+      return 0;
+    }
+  else if (nsec > UINT32_MAX)
+    {
+      return UINT32_MAX;
+    }
+
+  return (uint32_t)nsec;
+}
+
+/****************************************************************************
+ * Name: osbench_reset
+ *
+ * Description:
+ *   Prepare to take the samples of a scenario.
+ *
+ ****************************************************************************/
+
+void osbench_reset(FAR struct osbench_result_s *result)
+{
+  uint32_t resolution = osbench_resolution();
+
+  result->count    = 0;
+  result->batch    = 1;
+  result->iter     = 0;
+  result->minbatch = resolution < UINT32_MAX / OSBENCH_BATCHTICKS ?
+                     resolution * OSBENCH_BATCHTICKS : UINT32_MAX;
+  result->single   = false;
+}
+
+/****************************************************************************
+ * Name: osbench_sample
+ *
+ * Description:
+ *   Record one iteration that ran from start to end.  A sample is the
+ *   time from the start of the first iteration of a batch to the end of
+ *   the last, divided by the batch size.  With a batch size of one, that
+ *   is just the time from start to end; otherwise it is the average
+ *   period of the whole iteration.
+ *
+ *   The first OSBENCH_WARMUP samples are discarded.  During the warmup,
+ *   the batch size is doubled until a batch takes at least
+ *   OSBENCH_BATCHTICKS steps of the clock resolution.  Returns true once
+ *   all samples have been recorded; further iterations are ignored.
+ *
+ ****************************************************************************/
+
+bool osbench_sample(FAR struct osbench_result_s *result,
+                    FAR const struct timespec *start,
+                    FAR const struct timespec *end)
+{
+  int index = result->count - OSBENCH_WARMUP;
+  uint32_t elapsed;
+
+  if (index >= result->nsamples)
+    {
+      return true;
+    }
+
+  if (result->iter == 0)
+    {
+      result->bstart = *start;
+    }
+
+  if (++result->iter < result->batch)
+    {
+      return false;
+    }
+
+  result->iter = 0;
+  elapsed = osbench_elapsed(&result->bstart, end);
+
+  if (index < 0)
+    {
+      if (!result->single && elapsed < result->minbatch &&
+          result->batch < OSBENCH_MAXBATCH)
+        {
+          result->batch <<= 1;
+          return false;
+        }
+
+      result->count++;
+      return false;
+    }
+
+  result->count++;
+  result->sample[index] = elapsed / result->batch;
+  return index + 1 >= result->nsamples;
+}
+
+bool osbench_done(FAR const struct osbench_result_s *result)
+{
+  return result->count - OSBENCH_WARMUP >= result->nsamples;
+}
+
+/****************************************************************************
+ * Name: osbench_header, osbench_report and osbench_footer
+ *
+ * Description:
+ *   Show the results in the selected format.
+ *
+ ****************************************************************************/
+
+void osbench_header(enum osbench_format_e format, int nsamples)
+{
+  unsigned long resolution = osbench_resolution();
+
+  switch (format)
+    {
+      case OSBENCH_TEXT:
+        printf("osbench: %d samples per test, clock resolution %lu nsec\n",
+               nsamples, resolution);
+        printf("%-16s %7s %5s %9s %9s %9s %9s %9s  (nsec)\n", "Test",
+               "Samples", "Batch", "Min", "Avg", "P50", "P99", "Max");
+        break;
+
+      case OSBENCH_CSV:
+        printf("test,samples,batch,min_ns,avg_ns,p50_ns,p99_ns,max_ns\n");
+        break;
+
+      case OSBENCH_JSON:
+        printf("{\n  \"samples\": %d,\n  \"clockres_ns\": %lu,\n"
+               "  \"results\": [", nsamples, resolution);
+        break;
+    }
+}
+
+void osbench_report(enum osbench_format_e format, bool first, bool verbose,
+                    FAR struct osbench_result_s *result)
+{
+  struct osbench_stats_s stats;
+  bool comma;
+  int i;
+
+  osbench_stats(result, &stats);
+
+  switch (format)
+    {
+      case OSBENCH_TEXT:
+        printf("%-16s %7d %5lu %9lu %9lu %9lu %9lu %9lu\n", result->name,
+               result->nsamples, (unsigned long)result->batch,
+               (unsigned long)stats.min,
+               (unsigned long)stats.avg, (unsigned long)stats.p50,
+               (unsigned long)stats.p99, (unsigned long)stats.max);
+
+        if (verbose)
+          {
+            for (i = 0; i < HIST_NBUCKETS; i++)
+              {
+                if (stats.hist[i] > 0)
+                  {
+                    printf("  < %10lu: %7lu\n",
+                           i < HIST_NBUCKETS - 1 ?
+                           1ul << (i + HIST_SHIFT) : 0xfffffffful,
+                           (unsigned long)stats.hist[i]);
+                  }
+              }
+          }
+        break;
+
+      case OSBENCH_CSV:
+        printf("%s,%d,%lu,%lu,%lu,%lu,%lu,%lu\n", result->name,
+               result->nsamples, (unsigned long)result->batch,
+               (unsigned long)stats.min,
+               (unsigned long)stats.avg, (unsigned long)stats.p50,
+               (unsigned long)stats.p99, (unsigned long)stats.max);
+        break;
+
+      case OSBENCH_JSON:
+        printf("%s\n    {\"test\": \"%s\", \"samples\": %d, "
+               "\"batch\": %lu,\n     \"min_ns\": %lu, \"avg_ns\": %lu, "
+               "\"p50_ns\": %lu,\n     \"p99_ns\": %lu, \"max_ns\": %lu,\n"
+               "     \"histogram\": [",
+               first ? "" : ",", result->name, result->nsamples,
+               (unsigned long)result->batch, (unsigned long)stats.min,
+               (unsigned long)stats.avg, (unsigned long)stats.p50,
+               (unsigned long)stats.p99, (unsigned long)stats.max);
+
+        /* [upper bound in nsec, count] for each bucket that is used */
+
+        for (i = 0, comma = false; i < HIST_NBUCKETS; i++)
+          {
+            if (stats.hist[i] > 0)
+              {
+                printf("%s[%lu, %lu]", comma ? ", " : "",
+                       i < HIST_NBUCKETS - 1 ?
+                       1ul << (i + HIST_SHIFT) : 0xfffffffful,
+                       (unsigned long)stats.hist[i]);
+                comma = true;
+              }
+          }
+
+        printf("]}");
+        break;
+    }
+}
+
+void osbench_footer(enum osbench_format_e format)
+{
+  if (format == OSBENCH_JSON)
+    {
+      printf("\n  ]\n}\n");
+    }
+}
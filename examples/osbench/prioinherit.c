@@ -0,0 +1,248 @@
+/****************************************************************************
+ * apps/examples/osbench/prioinherit.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <semaphore.h>
+#include <pthread.h>
+#include <errno.h>
+
+#include "osbench.h"
+
+#ifdef OSBENCH_HAVE_PRIOINHERIT
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+/* Without priority inheritance, the medium priority thread would keep the
+ * low priority thread from running forever.  It gives up after this long.
+ */
+
+#define MEDIUM_TIMEOUT 100000000  /* nsec */
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct prio_bench_s
+{
+  FAR struct osbench_result_s *result;
+  pthread_mutex_t mutex;    /* Held by the low, wanted by the high thread */
+  sem_t medium;             /* Starts the medium priority thread */
+  sem_t high;               /* Starts the high priority thread */
+  struct timespec start;    /* When the high thread began to block */
+  volatile bool blocked;    /* The high thread is (about to be) blocked */
+  volatile bool released;   /* The low thread released the mutex */
+  volatile bool stop;       /* Tells the high and medium threads to exit */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void prio_waitsafe(FAR sem_t *sem)
+{
+  while (sem_wait(sem) < 0 && errno == EINTR);
+}
+
+static FAR void *prio_high(FAR void *arg)
+{
+  FAR struct prio_bench_s *priv = (FAR struct prio_bench_s *)arg;
+
+  for (; ; )
+    {
+      prio_waitsafe(&priv->high);
+      if (priv->stop)
+        {
+          break;
+        }
+
+      /* Block on the mutex.  This should lend our priority to the low
+       * priority thread at once.
+       */
+
+      osbench_gettime(&priv->start);
+      priv->blocked = true;
+      pthread_mutex_lock(&priv->mutex);
+      pthread_mutex_unlock(&priv->mutex);
+    }
+
+  return NULL;
+}
+
+static FAR void *prio_medium(FAR void *arg)
+{
+  FAR struct prio_bench_s *priv = (FAR struct prio_bench_s *)arg;
+  struct timespec start;
+  struct timespec now;
+
+  for (; ; )
+    {
+      prio_waitsafe(&priv->medium);
+      if (priv->stop)
+        {
+          break;
+        }
+
+      /* Start the high priority thread, then hog the CPU until the low
+       * priority thread gets to release the mutex.
+       */
+
+      priv->released = false;
+      sem_post(&priv->high);
+
+      osbench_gettime(&start);
+      do
+        {
+          osbench_gettime(&now);
+        }
+      while (!priv->released &&
+             osbench_elapsed(&start, &now) < MEDIUM_TIMEOUT);
+    }
+
+  return NULL;
+}
+
+static FAR void *prio_low(FAR void *arg)
+{
+  FAR struct prio_bench_s *priv = (FAR struct prio_bench_s *)arg;
+  struct timespec end;
+
+  while (!osbench_done(priv->result))
+    {
+      /* The medium priority thread preempts us as soon as it is posted.
+       * We run again only when the high priority thread has blocked on the
+       * mutex and raised our priority above the medium thread.
+       */
+
+      pthread_mutex_lock(&priv->mutex);
+      sem_post(&priv->medium);
+
+      while (!priv->blocked);
+      osbench_gettime(&end);
+      (void)osbench_sample(priv->result, &priv->start, &end);
+
+      priv->blocked  = false;
+      priv->released = true;
+      pthread_mutex_unlock(&priv->mutex);
+    }
+
+  priv->stop = true;
+  sem_post(&priv->medium);
+  sem_post(&priv->high);
+  return NULL;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: prioinherit_bench
+ *
+ * Description:
+ *   Priority inheritance boost.  A low priority thread holds a mutex and is
+ *   preempted by a busy medium priority thread.  A high priority thread
+ *   then blocks on the mutex.  Each sample is the time from when the high
+ *   priority thread blocks until the low priority thread runs again with
+ *   the inherited priority.  Without priority inheritance, the samples are
+ *   as long as the medium thread's 100 msec timeout.
+ *
+ ****************************************************************************/
+
+int prioinherit_bench(FAR struct osbench_result_s *result)
+{
+  struct prio_bench_s priv;
+  pthread_t high;
+  pthread_t medium;
+  pthread_t low;
+  int ret;
+
+  priv.result   = result;
+  priv.blocked  = false;
+  priv.released = false;
+  priv.stop     = false;
+  (void)pthread_mutex_init(&priv.mutex, NULL);
+  (void)sem_init(&priv.medium, 0, 0);
+  (void)sem_init(&priv.high, 0, 0);
+
+  ret = osbench_thread(&high, OSBENCH_PRIO_HIGH, prio_high, &priv);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  ret = osbench_thread(&medium, OSBENCH_PRIO_MEDIUM, prio_medium, &priv);
+  if (ret < 0)
+    {
+      goto errout_with_high;
+    }
+
+  ret = osbench_thread(&low, OSBENCH_PRIO_LOW, prio_low, &priv);
+  if (ret < 0)
+    {
+      priv.stop = true;
+      sem_post(&priv.medium);
+    }
+  else
+    {
+      (void)pthread_join(low, NULL);
+    }
+
+  (void)pthread_join(medium, NULL);
+
+errout_with_high:
+  if (ret < 0)
+    {
+      priv.stop = true;
+      sem_post(&priv.high);
+    }
+
+  (void)pthread_join(high, NULL);
+
+errout:
+  (void)sem_destroy(&priv.high);
+  (void)sem_destroy(&priv.medium);
+  (void)pthread_mutex_destroy(&priv.mutex);
+  return ret;
+}
+
+#endif /* OSBENCH_HAVE_PRIOINHERIT */
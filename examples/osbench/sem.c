@@ -0,0 +1,137 @@
+/****************************************************************************
+ * apps/examples/osbench/sem.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <semaphore.h>
+#include <pthread.h>
+#include <errno.h>
+
+#include "osbench.h"
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct sem_bench_s
+{
+  sem_t ping;               /* Posted by the main thread */
+  sem_t pong;               /* Posted back by the partner */
+  volatile bool stop;       /* Tells the partner to exit */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void sem_waitsafe(FAR sem_t *sem)
+{
+  while (sem_wait(sem) < 0 && errno == EINTR);
+}
+
+static FAR void *sem_partner(FAR void *arg)
+{
+  FAR struct sem_bench_s *priv = (FAR struct sem_bench_s *)arg;
+
+  for (; ; )
+    {
+      sem_waitsafe(&priv->ping);
+      if (priv->stop)
+        {
+          break;
+        }
+
+      sem_post(&priv->pong);
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sem_bench
+ *
+ * Description:
+ *   Semaphore ping-pong.  Each sample is one round trip:  the main thread
+ *   posts a semaphore that a lower priority thread waits for, and waits
+ *   until that thread posts a second semaphore back.  That is two context
+ *   switches.
+ *
+ ****************************************************************************/
+
+int sem_bench(FAR struct osbench_result_s *result)
+{
+  struct sem_bench_s priv;
+  struct timespec start;
+  struct timespec end;
+  pthread_t partner;
+  int ret;
+
+  (void)sem_init(&priv.ping, 0, 0);
+  (void)sem_init(&priv.pong, 0, 0);
+  priv.stop = false;
+
+  ret = osbench_thread(&partner, OSBENCH_PRIO_HIGH, sem_partner, &priv);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  do
+    {
+      osbench_gettime(&start);
+      sem_post(&priv.ping);
+      sem_waitsafe(&priv.pong);
+      osbench_gettime(&end);
+    }
+  while (!osbench_sample(result, &start, &end));
+
+  priv.stop = true;
+  sem_post(&priv.ping);
+  (void)pthread_join(partner, NULL);
+
+errout:
+  (void)sem_destroy(&priv.ping);
+  (void)sem_destroy(&priv.pong);
+  return ret;
+}
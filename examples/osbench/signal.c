@@ -0,0 +1,180 @@
+/****************************************************************************
+ * apps/examples/osbench/signal.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <signal.h>
+#include <pthread.h>
+#include <errno.h>
+
+#include "osbench.h"
+
+#ifdef OSBENCH_HAVE_SIGNAL
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+#define BENCH_SIGNAL SIGUSR1
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct signal_bench_s
+{
+  FAR struct osbench_result_s *result;
+  pthread_t receiver;       /* The thread that the signal is sent to */
+  struct timespec start;    /* When the signal was sent */
+  volatile bool stop;       /* Tells the receiver to exit */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static FAR void *signal_receiver(FAR void *arg)
+{
+  FAR struct signal_bench_s *priv = (FAR struct signal_bench_s *)arg;
+  struct timespec end;
+  sigset_t set;
+
+  /* The signal stays blocked so that it is only taken by sigwaitinfo() */
+
+  (void)sigemptyset(&set);
+  (void)sigaddset(&set, BENCH_SIGNAL);
+  (void)pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+  for (; ; )
+    {
+      if (sigwaitinfo(&set, NULL) < 0)
+        {
+          continue;
+        }
+
+      if (priv->stop)
+        {
+          break;
+        }
+
+      osbench_gettime(&end);
+      (void)osbench_sample(priv->result, &priv->start, &end);
+    }
+
+  return NULL;
+}
+
+static FAR void *signal_sender(FAR void *arg)
+{
+  FAR struct signal_bench_s *priv = (FAR struct signal_bench_s *)arg;
+
+  while (!osbench_done(priv->result))
+    {
+      osbench_gettime(&priv->start);
+      if (pthread_kill(priv->receiver, BENCH_SIGNAL) != 0)
+        {
+          break;
+        }
+    }
+
+  priv->stop = true;
+  (void)pthread_kill(priv->receiver, BENCH_SIGNAL);
+  return NULL;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: signal_bench
+ *
+ * Description:
+ *   Signal delivery.  A high priority thread waits in sigwaitinfo().  Each
+ *   sample is the time from just before a low priority thread calls
+ *   pthread_kill() until the high priority thread returns with the signal.
+ *
+ ****************************************************************************/
+
+int signal_bench(FAR struct osbench_result_s *result)
+{
+  struct signal_bench_s priv;
+  pthread_t sender;
+  sigset_t set;
+  sigset_t oset;
+  int ret;
+
+  priv.result = result;
+  priv.stop   = false;
+
+  /* Block the signal here too, so that the receiver starts with it blocked
+   * and it cannot be taken by this thread.
+   */
+
+  (void)sigemptyset(&set);
+  (void)sigaddset(&set, BENCH_SIGNAL);
+  (void)pthread_sigmask(SIG_BLOCK, &set, &oset);
+
+  ret = osbench_thread(&priv.receiver, OSBENCH_PRIO_HIGH, signal_receiver,
+                       &priv);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  ret = osbench_thread(&sender, OSBENCH_PRIO_LOW, signal_sender, &priv);
+  if (ret < 0)
+    {
+      priv.stop = true;
+      (void)pthread_kill(priv.receiver, BENCH_SIGNAL);
+    }
+  else
+    {
+      (void)pthread_join(sender, NULL);
+    }
+
+  (void)pthread_join(priv.receiver, NULL);
+
+errout:
+  (void)pthread_sigmask(SIG_SETMASK, &oset, NULL);
+  return ret;
+}
+
+#endif /* OSBENCH_HAVE_SIGNAL */
@@ -0,0 +1,164 @@
+/****************************************************************************
+ * apps/examples/osbench/timer.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <string.h>
+#include <signal.h>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+
+#include "osbench.h"
+
+#ifdef OSBENCH_HAVE_TIMER
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+#define BENCH_SIGNAL SIGUSR2
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: timer_bench
+ *
+ * Description:
+ *   Timer jitter.  A periodic POSIX timer signals the main thread every
+ *   CONFIG_EXAMPLES_OSBENCH_TIMER_PERIOD microseconds.  Each sample is how
+ *   far the time between two expirations is from the period, early or
+ *   late.  Deviations cannot be averaged over a batch, so each sample is
+ *   one expiration and is only as precise as the clock.
+ *
+ ****************************************************************************/
+
+int timer_bench(FAR struct osbench_result_s *result)
+{
+  struct itimerspec period;
+  struct sigevent notify;
+  struct timespec expected;
+  struct timespec prev;
+  struct timespec now;
+  sigset_t set;
+  sigset_t oset;
+  timer_t timer;
+  bool done;
+  int ret = OK;
+
+  result->single = true;
+
+  /* The signal stays blocked so that it is only taken by sigwaitinfo() */
+
+  (void)sigemptyset(&set);
+  (void)sigaddset(&set, BENCH_SIGNAL);
+  (void)pthread_sigmask(SIG_BLOCK, &set, &oset);
+
+  memset(&notify, 0, sizeof(struct sigevent));
+  notify.sigev_notify          = SIGEV_SIGNAL;
+  notify.sigev_signo           = BENCH_SIGNAL;
+  notify.sigev_value.sival_int = 0;
+
+  if (timer_create(CLOCK_REALTIME, &notify, &timer) < 0)
+    {
+      ret = -errno;
+      goto errout;
+    }
+
+  period.it_value.tv_sec  = CONFIG_EXAMPLES_OSBENCH_TIMER_PERIOD / 1000000;
+  period.it_value.tv_nsec = (CONFIG_EXAMPLES_OSBENCH_TIMER_PERIOD % 1000000) *
+                            1000;
+  period.it_interval      = period.it_value;
+
+  if (timer_settime(timer, 0, &period, NULL) < 0)
+    {
+      ret = -errno;
+      goto errout_with_timer;
+    }
+
+  osbench_gettime(&prev);
+  for (; ; )
+    {
+      if (sigwaitinfo(&set, NULL) < 0)
+        {
+          continue;
+        }
+
+      osbench_gettime(&now);
+
+      expected          = prev;
+      expected.tv_sec  += period.it_interval.tv_sec;
+      expected.tv_nsec += period.it_interval.tv_nsec;
+      if (expected.tv_nsec >= 1000000000)
+        {
+          expected.tv_sec++;
+          expected.tv_nsec -= 1000000000;
+        }
+
+      prev = now;
+
+      /* Early and late count the same */
+
+      if (osbench_elapsed(&expected, &now) > 0)
+        {
+          done = osbench_sample(result, &expected, &now);
+        }
+      else
+        {
+          done = osbench_sample(result, &now, &expected);
+        }
+
+      if (done)
+        {
+          break;
+        }
+    }
+
+errout_with_timer:
+  (void)timer_delete(timer);
+
+errout:
+  (void)pthread_sigmask(SIG_SETMASK, &oset, NULL);
+  return ret;
+}
+
+#endif /* OSBENCH_HAVE_TIMER */
@@ -0,0 +1,817 @@
+/****************************************************************************
+ * examples/tftpc/host.c
+ * A host-based TFTP server used to test the TFTP client.  It supports option
+ * negotiation (blksize, tsize, windowsize) and can drop packets at random.
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TFTP_RRQ            1
+#define TFTP_WRQ            2
+#define TFTP_DATA           3
+#define TFTP_ACK            4
+#define TFTP_ERR            5
+#define TFTP_OACK           6
+
+#define TFTP_ERR_NOSUCHFILE 1
+#define TFTP_ERR_ACCESS     2
+#define TFTP_ERR_ILLEGALOP  4
+#define TFTP_ERR_NEGOTIATE  8
+
+#define TFTP_HEADERSIZE     4
+#define TFTP_DEFBLKSIZE     512
+#define TFTP_MAXBLKSIZE     65464
+#define TFTP_BUFSIZE        (TFTP_MAXBLKSIZE + TFTP_HEADERSIZE)
+#define TFTP_RETRIES        8
+
+#define DEFAULT_PORT        69
+#define DEFAULT_TIMEOUT     200    /* Milliseconds */
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct transfer_s
+{
+  int      sd;                      /* Socket for this transfer */
+  int      fd;                      /* File being sent or received */
+  struct sockaddr_in client;        /* Client address and port */
+  uint16_t blksize;                 /* Negotiated block size */
+  uint16_t windowsize;              /* Negotiated window size */
+  uint32_t nbytes;                  /* Data bytes transferred */
+  uint32_t nsent;                   /* DATA or ACK packets sent */
+  uint32_t nresent;                 /* DATA packets sent again */
+  uint32_t ndropped;                /* Packets dropped on purpose */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static int g_lossrate;              /* Percent of packets to drop */
+static int g_timeout = DEFAULT_TIMEOUT;
+static int g_maxblksize = TFTP_MAXBLKSIZE;
+static int g_maxwindow = 65535;
+static bool g_classic;              /* Ignore options */
+static bool g_reject;               /* Reject requests with options */
+
+static uint8_t g_rxbuffer[TFTP_BUFSIZE];
+static uint8_t g_txbuffer[TFTP_BUFSIZE];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: show_usage
+ ****************************************************************************/
+
+static void show_usage(const char *progname)
+{
+  fprintf(stderr, "USAGE: %s [-p <port>] [-d <dir>] [-l <loss-percent>] "
+          "[-t <timeout-msec>]\n", progname);
+  fprintf(stderr, "          [-b <max-blksize>] [-w <max-windowsize>] "
+          "[-c] [-r] [-s <seed>]\n");
+  fprintf(stderr, "  -c: Ignore options (classic TFTP server)\n");
+  fprintf(stderr, "  -r: Reject requests with options (old TFTP server)\n");
+  exit(1);
+}
+
+/****************************************************************************
+ * Name: put16 and get16
+ ****************************************************************************/
+
+static void put16(uint8_t *ptr, uint16_t value)
+{
+  ptr[0] = value >> 8;
+  ptr[1] = value & 0xff;
+}
+
+static uint16_t get16(const uint8_t *ptr)
+{
+  return (uint16_t)ptr[0] << 8 | ptr[1];
+}
+
+/****************************************************************************
+ * Name: xfer_send
+ *
+ * Description:
+ *   Send a packet to the client, or pretend to and drop it.
+ *
+ ****************************************************************************/
+
+static void xfer_send(struct transfer_s *xfer, const void *buf, size_t len)
+{
+  xfer->nsent++;
+  if (g_lossrate > 0 && (rand() % 100) < g_lossrate)
+    {
+      xfer->ndropped++;
+      return;
+    }
+
+  (void)sendto(xfer->sd, buf, len, 0, (struct sockaddr *)&xfer->client,
+               sizeof(struct sockaddr_in));
+}
+
+/****************************************************************************
+ * Name: xfer_senderr
+ ****************************************************************************/
+
+static void xfer_senderr(int sd, struct sockaddr_in *to, uint16_t errcode,
+                         const char *errmsg)
+{
+  uint8_t buffer[128];
+  int len;
+
+  put16(buffer, TFTP_ERR);
+  put16(buffer + 2, errcode);
+  len = snprintf((char *)buffer + 4, sizeof(buffer) - 4, "%s", errmsg) + 5;
+  (void)sendto(sd, buffer, len, 0, (struct sockaddr *)to,
+               sizeof(struct sockaddr_in));
+}
+
+/****************************************************************************
+ * Name: xfer_recv
+ *
+ * Description:
+ *   Receive the next packet from the client.  Returns the packet length or
+ *   -1 on a timeout.
+ *
+ ****************************************************************************/
+
+static int xfer_recv(struct transfer_s *xfer, int timeout)
+{
+  struct sockaddr_in from;
+  struct timeval tv;
+  socklen_t addrlen;
+  int nbytes;
+
+  tv.tv_sec  = timeout / 1000;
+  tv.tv_usec = (timeout % 1000) * 1000;
+  setsockopt(xfer->sd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(struct timeval));
+
+  for (;;)
+    {
+      addrlen = sizeof(struct sockaddr_in);
+      nbytes  = recvfrom(xfer->sd, g_rxbuffer, TFTP_BUFSIZE, 0,
+                         (struct sockaddr *)&from, &addrlen);
+      if (nbytes < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+
+          return -1;
+        }
+
+      if (from.sin_addr.s_addr != xfer->client.sin_addr.s_addr ||
+          from.sin_port != xfer->client.sin_port)
+        {
+          xfer_senderr(xfer->sd, &from, 5, "Unknown transfer ID");
+          continue;
+        }
+
+      if (nbytes >= TFTP_HEADERSIZE)
+        {
+          return nbytes;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: parse_options
+ *
+ * Description:
+ *   Parse the options that follow the file name and mode in a request and
+ *   build the OACK packet in g_txbuffer.  Returns the length of the OACK
+ *   or zero if no options were accepted.
+ *
+ ****************************************************************************/
+
+static int parse_options(struct transfer_s *xfer, const uint8_t *ptr,
+                         const uint8_t *end, int opcode, uint32_t *tsize)
+{
+  const char *name;
+  const char *value;
+  unsigned long tmp;
+  int len = 2;
+
+  put16(g_txbuffer, TFTP_OACK);
+  while (ptr < end)
+    {
+      name = (const char *)ptr;
+      ptr  = memchr(ptr, 0, end - ptr);
+      if (!ptr || ++ptr >= end)
+        {
+          break;
+        }
+
+      value = (const char *)ptr;
+      ptr   = memchr(ptr, 0, end - ptr);
+      if (!ptr)
+        {
+          break;
+        }
+
+      ptr++;
+      tmp = strtoul(value, NULL, 10);
+
+      if (strcasecmp(name, "blksize") == 0 && tmp >= 8)
+        {
+          if (tmp > (unsigned long)g_maxblksize)
+            {
+              tmp = g_maxblksize;
+            }
+
+          xfer->blksize = tmp;
+          len += sprintf((char *)g_txbuffer + len, "blksize%c%lu", 0, tmp) + 1;
+        }
+      else if (strcasecmp(name, "windowsize") == 0 && tmp >= 1)
+        {
+          if (tmp > (unsigned long)g_maxwindow)
+            {
+              tmp = g_maxwindow;
+            }
+
+          xfer->windowsize = tmp;
+          len += sprintf((char *)g_txbuffer + len, "windowsize%c%lu", 0,
+                         tmp) + 1;
+        }
+      else if (strcasecmp(name, "tsize") == 0)
+        {
+          if (opcode == TFTP_WRQ)
+            {
+              *tsize = tmp;
+            }
+
+          len += sprintf((char *)g_txbuffer + len, "tsize%c%lu", 0,
+                         (unsigned long)*tsize) + 1;
+        }
+    }
+
+  return len > 2 ? len : 0;
+}
+
+/****************************************************************************
+ * Name: send_file
+ *
+ * Description:
+ *   Handle a read request:  Send windows of DATA packets and restart from
+ *   the block after each ACK.
+ *
+ ****************************************************************************/
+
+static int send_file(struct transfer_s *xfer, int oacklen)
+{
+  uint32_t base = 1;
+  uint32_t next = 1;
+  uint32_t last = 0;
+  uint32_t sent = 0;                /* Highest block sent so far */
+  uint16_t acked;
+  int retry = 0;
+  int nbytes;
+  int len;
+
+  /* If options were accepted, the client must ACK block zero */
+
+  if (oacklen > 0)
+    {
+      for (;;)
+        {
+          xfer_send(xfer, g_txbuffer, oacklen);
+          len = xfer_recv(xfer, g_timeout);
+          if (len > 0 && get16(g_rxbuffer) == TFTP_ACK &&
+              get16(g_rxbuffer + 2) == 0)
+            {
+              break;
+            }
+
+          if (len > 0 && get16(g_rxbuffer) == TFTP_ERR)
+            {
+              return -1;
+            }
+
+          if (++retry > TFTP_RETRIES)
+            {
+              return -1;
+            }
+        }
+    }
+
+  retry = 0;
+  for (;;)
+    {
+      while (next < base + xfer->windowsize && (last == 0 || next <= last))
+        {
+          put16(g_txbuffer, TFTP_DATA);
+          put16(g_txbuffer + 2, (uint16_t)next);
+          nbytes = pread(xfer->fd, g_txbuffer + TFTP_HEADERSIZE,
+                         xfer->blksize, (off_t)(next - 1) * xfer->blksize);
+          if (nbytes < 0)
+            {
+              return -1;
+            }
+
+          if (nbytes < xfer->blksize)
+            {
+              last = next;
+            }
+
+          if (next <= sent)
+            {
+              xfer->nresent++;
+            }
+          else
+            {
+              sent = next;
+              xfer->nbytes += nbytes;
+            }
+
+          xfer_send(xfer, g_txbuffer, nbytes + TFTP_HEADERSIZE);
+          next++;
+        }
+
+      len = xfer_recv(xfer, g_timeout);
+      if (len > 0)
+        {
+          if (get16(g_rxbuffer) == TFTP_ERR)
+            {
+              return -1;
+            }
+
+          if (get16(g_rxbuffer) != TFTP_ACK)
+            {
+              continue;
+            }
+
+          acked = get16(g_rxbuffer + 2) - (uint16_t)base;
+          if (acked < next - base)
+            {
+              base += acked + 1;
+              if (last != 0 && base > last)
+                {
+                  return 0;
+                }
+
+              next  = base;
+              retry = 0;
+            }
+
+          continue;
+        }
+
+      if (++retry > TFTP_RETRIES)
+        {
+          return -1;
+        }
+
+      next = base;
+    }
+}
+
+/****************************************************************************
+ * Name: recv_file
+ *
+ * Description:
+ *   Handle a write request:  ACK the last block of each window, the last
+ *   block received in sequence when a gap is seen, and the final block.
+ *
+ ****************************************************************************/
+
+static int recv_file(struct transfer_s *xfer, int oacklen)
+{
+  uint8_t ack[TFTP_HEADERSIZE];
+  uint16_t blockno = 1;
+  uint16_t rblockno;
+  bool nakked = false;
+  int inwindow = 0;
+  int retry = 0;
+  int ndata;
+  int len;
+
+  /* Acknowledge the request with an OACK or ACK of block zero */
+
+  if (oacklen > 0)
+    {
+      xfer_send(xfer, g_txbuffer, oacklen);
+    }
+  else
+    {
+      put16(ack, TFTP_ACK);
+      put16(ack + 2, 0);
+      xfer_send(xfer, ack, TFTP_HEADERSIZE);
+    }
+
+  for (;;)
+    {
+      len = xfer_recv(xfer, g_timeout);
+      if (len < 0)
+        {
+          if (++retry > TFTP_RETRIES)
+            {
+              return -1;
+            }
+
+          /* Re-send the OACK or the last ACK */
+
+          if (blockno == 1 && oacklen > 0)
+            {
+              xfer_send(xfer, g_txbuffer, oacklen);
+            }
+          else
+            {
+              put16(ack, TFTP_ACK);
+              put16(ack + 2, blockno - 1);
+              xfer_send(xfer, ack, TFTP_HEADERSIZE);
+            }
+
+          inwindow = 0;
+          continue;
+        }
+
+      if (get16(g_rxbuffer) == TFTP_ERR)
+        {
+          return -1;
+        }
+
+      if (get16(g_rxbuffer) != TFTP_DATA)
+        {
+          continue;
+        }
+
+      rblockno = get16(g_rxbuffer + 2);
+      ndata    = len - TFTP_HEADERSIZE;
+
+      if (rblockno != blockno)
+        {
+          if ((int16_t)(rblockno - blockno) > 0)
+            {
+              if (nakked)
+                {
+                  continue;
+                }
+
+              nakked = true;
+            }
+          else if (rblockno != (uint16_t)(blockno - 1))
+            {
+              continue;
+            }
+
+          put16(ack, TFTP_ACK);
+          put16(ack + 2, blockno - 1);
+          xfer_send(xfer, ack, TFTP_HEADERSIZE);
+          inwindow = 0;
+          continue;
+        }
+
+      if (ndata > xfer->blksize ||
+          write(xfer->fd, g_rxbuffer + TFTP_HEADERSIZE, ndata) != ndata)
+        {
+          return -1;
+        }
+
+      xfer->nbytes += ndata;
+      retry  = 0;
+      nakked = false;
+
+      if (ndata < xfer->blksize || ++inwindow >= xfer->windowsize)
+        {
+          put16(ack, TFTP_ACK);
+          put16(ack + 2, blockno);
+          xfer_send(xfer, ack, TFTP_HEADERSIZE);
+          inwindow = 0;
+        }
+
+      if (ndata < xfer->blksize)
+        {
+          /* Dally for a while in case the final ACK was lost */
+
+          while ((len = xfer_recv(xfer, 4 * g_timeout)) > 0)
+            {
+              if (get16(g_rxbuffer) == TFTP_DATA &&
+                  get16(g_rxbuffer + 2) == blockno)
+                {
+                  xfer_send(xfer, ack, TFTP_HEADERSIZE);
+                }
+            }
+
+          return 0;
+        }
+
+      blockno++;
+    }
+}
+
+/****************************************************************************
+ * Name: handle_request
+ ****************************************************************************/
+
+static void handle_request(const uint8_t *request, int reqlen,
+                           struct sockaddr_in *client)
+{
+  struct transfer_s xfer;
+  struct sockaddr_in addr;
+  const uint8_t *end = request + reqlen;
+  const uint8_t *ptr;
+  const char *filename;
+  const char *mode;
+  struct stat buf;
+  uint32_t tsize = 0;
+  bool hasoptions;
+  int opcode;
+  int oacklen = 0;
+  int ret;
+
+  memset(&xfer, 0, sizeof(struct transfer_s));
+  xfer.client     = *client;
+  xfer.blksize    = TFTP_DEFBLKSIZE;
+  xfer.windowsize = 1;
+
+  /* Each transfer uses a new socket (and so a new port number) */
+
+  xfer.sd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (xfer.sd < 0)
+    {
+      return;
+    }
+
+  memset(&addr, 0, sizeof(struct sockaddr_in));
+  addr.sin_family = AF_INET;
+  if (bind(xfer.sd, (struct sockaddr *)&addr, sizeof(struct sockaddr_in)) < 0)
+    {
+      close(xfer.sd);
+      return;
+    }
+
+  /* Parse the request */
+
+  opcode   = get16(request);
+  filename = (const char *)request + 2;
+  ptr      = memchr(filename, 0, end - (const uint8_t *)filename);
+  mode     = ptr ? (const char *)ptr + 1 : NULL;
+  ptr      = mode && (const uint8_t *)mode < end ?
+             memchr(mode, 0, end - (const uint8_t *)mode) : NULL;
+
+  if (!ptr || (opcode != TFTP_RRQ && opcode != TFTP_WRQ))
+    {
+      xfer_senderr(xfer.sd, client, TFTP_ERR_ILLEGALOP, "Illegal request");
+      close(xfer.sd);
+      return;
+    }
+
+  ptr++;
+  hasoptions = ptr < end;
+
+  if (strstr(filename, "..") || filename[0] == '/')
+    {
+      xfer_senderr(xfer.sd, client, TFTP_ERR_ACCESS, "Access violation");
+      close(xfer.sd);
+      return;
+    }
+
+  if (hasoptions && g_reject)
+    {
+      xfer_senderr(xfer.sd, client, TFTP_ERR_NEGOTIATE, "Options rejected");
+      close(xfer.sd);
+      return;
+    }
+
+  /* Open the file */
+
+  if (opcode == TFTP_RRQ)
+    {
+      xfer.fd = open(filename, O_RDONLY);
+      if (xfer.fd >= 0 && fstat(xfer.fd, &buf) == 0)
+        {
+          tsize = buf.st_size;
+        }
+    }
+  else
+    {
+      xfer.fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+
+  if (xfer.fd < 0)
+    {
+      xfer_senderr(xfer.sd, client, TFTP_ERR_NOSUCHFILE, "File not found");
+      close(xfer.sd);
+      return;
+    }
+
+  if (hasoptions && !g_classic)
+    {
+      oacklen = parse_options(&xfer, ptr, end, opcode, &tsize);
+    }
+
+  /* Then perform the transfer */
+
+  if (opcode == TFTP_RRQ)
+    {
+      ret = send_file(&xfer, oacklen);
+    }
+  else
+    {
+      ret = recv_file(&xfer, oacklen);
+    }
+
+  printf("%s %s %s: %lu bytes, blksize %d, windowsize %d, "
+         "%lu sent, %lu resent, %lu dropped\n",
+         opcode == TFTP_RRQ ? "RRQ" : "WRQ", filename,
+         ret == 0 ? "complete" : "FAILED", (unsigned long)xfer.nbytes,
+         xfer.blksize, xfer.windowsize, (unsigned long)xfer.nsent,
+         (unsigned long)xfer.nresent, (unsigned long)xfer.ndropped);
+  if (tsize && tsize != xfer.nbytes && ret == 0)
+    {
+      printf("  tsize was %lu\n", (unsigned long)tsize);
+    }
+
+  fflush(stdout);
+  close(xfer.fd);
+  close(xfer.sd);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * main
+ ****************************************************************************/
+
+int main(int argc, char **argv, char **envp)
+{
+  static uint8_t request[TFTP_BUFSIZE];
+  struct sockaddr_in addr;
+  struct sockaddr_in client;
+  socklen_t addrlen;
+  int port = DEFAULT_PORT;
+  int option;
+  int nbytes;
+  int sd;
+
+  while ((option = getopt(argc, argv, "p:d:l:t:b:w:crs:")) != -1)
+    {
+      switch (option)
+        {
+          case 'p':
+            port = atoi(optarg);
+            break;
+
+          case 'd':
+            if (chdir(optarg) < 0)
+              {
+                fprintf(stderr, "chdir %s failed: %d\n", optarg, errno);
+                return 1;
+              }
+            break;
+
+          case 'l':
+            g_lossrate = atoi(optarg);
+            break;
+
+          case 't':
+            g_timeout = atoi(optarg);
+            break;
+
+          case 'b':
+            g_maxblksize = atoi(optarg);
+            break;
+
+          case 'w':
+            g_maxwindow = atoi(optarg);
+            break;
+
+          case 'c':
+            g_classic = true;
+            break;
+
+          case 'r':
+            g_reject = true;
+            break;
+
+          case 's':
+            srand(atoi(optarg));
+            break;
+
+          default:
+            show_usage(argv[0]);
+            break;
+        }
+    }
+
+  if (g_timeout <= 0 || g_lossrate < 0 || g_lossrate >= 100 ||
+      g_maxblksize < 8 || g_maxblksize > TFTP_MAXBLKSIZE ||
+      g_maxwindow < 1 || g_maxwindow > 65535)
+    {
+      show_usage(argv[0]);
+    }
+
+  sd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (sd < 0)
+    {
+      fprintf(stderr, "socket failed: %d\n", errno);
+      return 1;
+    }
+
+  memset(&addr, 0, sizeof(struct sockaddr_in));
+  addr.sin_family      = AF_INET;
+  addr.sin_port        = htons(port);
+  addr.sin_addr.s_addr = INADDR_ANY;
+
+  if (bind(sd, (struct sockaddr *)&addr, sizeof(struct sockaddr_in)) < 0)
+    {
+      fprintf(stderr, "bind to port %d failed: %d\n", port, errno);
+      return 1;
+    }
+
+  printf("Listening on port %d\n", port);
+  fflush(stdout);
+
+  /* Handle each request in its own process, as a real server would.  The
+   * client may re-send its request while a previous transfer is still
+   * dallying.
+   */
+
+  signal(SIGCHLD, SIG_IGN);
+
+  for (;;)
+    {
+      addrlen = sizeof(struct sockaddr_in);
+      nbytes  = recvfrom(sd, request, TFTP_BUFSIZE - 1, 0,
+                         (struct sockaddr *)&client, &addrlen);
+      if (nbytes >= 4)
+        {
+          unsigned int seed = rand();
+
+          request[nbytes] = '\0';
+          if (fork() == 0)
+            {
+              close(sd);
+              srand(seed);
+              handle_request(request, nbytes, &client);
+              exit(0);
+            }
+        }
+    }
+
+  return 0;
+}
@@ -0,0 +1,177 @@
+/****************************************************************************
+ * examples/tftpc/tftpc_main.c
+ * Transfer one file with the TFTP client and report the throughput
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/stat.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+
+#include <arpa/inet.h>
+
+#include <apps/netutils/tftp.h>
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tftpc_gettime
+ ****************************************************************************/
+
+static void tftpc_gettime(FAR struct timespec *tp)
+{
+#ifdef CONFIG_CLOCK_MONOTONIC
+  (void)clock_gettime(CLOCK_MONOTONIC, tp);
+#else
+  (void)clock_gettime(CLOCK_REALTIME, tp);
+#endif
+}
+
+/****************************************************************************
+ * Name: tftpc_showusage
+ ****************************************************************************/
+
+static void tftpc_showusage(FAR const char *progname)
+{
+  fprintf(stderr, "USAGE: %s get|put [-t] <server-ip> <remote-file> "
+          "<local-file>\n", progname);
+  fprintf(stderr, "  -t:  Text ('netascii') transfer.  Default: binary\n");
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tftpc_main
+ ****************************************************************************/
+
+#ifdef CONFIG_BUILD_KERNEL
+int main(int argc, FAR char *argv[])
+#else
+int tftpc_main(int argc, char *argv[])
+#endif
+{
+  struct timespec start;
+  struct timespec end;
+  struct in_addr addr;
+  struct stat buf;
+  unsigned long msec;
+  unsigned long rate;
+  bool binary = true;
+  bool get;
+  int argndx = 1;
+  int ret;
+
+  if (argc < 2)
+    {
+      tftpc_showusage(argv[0]);
+      return 1;
+    }
+
+  if (strcmp(argv[argndx], "get") == 0)
+    {
+      get = true;
+    }
+  else if (strcmp(argv[argndx], "put") == 0)
+    {
+      get = false;
+    }
+  else
+    {
+      tftpc_showusage(argv[0]);
+      return 1;
+    }
+
+  argndx++;
+  if (argndx < argc && strcmp(argv[argndx], "-t") == 0)
+    {
+      binary = false;
+      argndx++;
+    }
+
+  if (argc - argndx != 3 || inet_pton(AF_INET, argv[argndx], &addr) != 1)
+    {
+      tftpc_showusage(argv[0]);
+      return 1;
+    }
+
+  /* Transfer the file */
+
+  tftpc_gettime(&start);
+  if (get)
+    {
+      ret = tftpget(argv[argndx + 1], argv[argndx + 2], addr.s_addr, binary);
+    }
+  else
+    {
+      ret = tftpput(argv[argndx + 2], argv[argndx + 1], addr.s_addr, binary);
+    }
+
+  tftpc_gettime(&end);
+
+  if (ret != OK)
+    {
+      fprintf(stderr, "Transfer failed: %d\n", errno);
+      return 1;
+    }
+
+  /* Report the throughput */
+
+  if (stat(argv[argndx + 2], &buf) < 0)
+    {
+      fprintf(stderr, "stat failed: %d\n", errno);
+      return 1;
+    }
+
+  msec = (unsigned long)(end.tv_sec - start.tv_sec) * 1000 +
+         (end.tv_nsec - start.tv_nsec) / 1000000;
+  rate = msec > 0 ? (unsigned long)(((uint64_t)buf.st_size * 1000) / msec) : 0;
+
+  printf("%s %lu bytes in %lu.%03lu sec (%lu bytes/sec)\n",
+         get ? "Received" : "Sent", (unsigned long)buf.st_size,
+         msec / 1000, msec % 1000, rate);
+  return 0;
+}
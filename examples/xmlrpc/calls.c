@@ -44,7 +44,6 @@
  * Included Files
  ****************************************************************************/
 
-#include <string.h>
 #include <apps/netutils/xmlrpc.h>
 
 /****************************************************************************
@@ -69,25 +68,29 @@ struct xmlrpc_entry_s get_device_stats =
 
 static int calls_get_device_stats(struct xmlrpc_s *xmlcall)
 {
-  char username[80], password[80];
-  char lastCommand[80], curState[80];
-  int request = 0, status, ret;
+  FAR struct xmlrpc_writer_s *writer = xmlcall->writer;
+  FAR const char *username;
+  FAR const char *password;
+  int request = 0;
+  int ret;
+
+  /* The string arguments are used in place in the request buffer */
 
   do
     {
-      ret = xmlrpc_getstring(xmlcall, username);
+      ret = xmlrpc_value2string(xmlrpc_param(xmlcall->parser, 0), &username);
       if (ret != XMLRPC_NO_ERROR)
         {
           break;
         }
 
-      ret = xmlrpc_getstring(xmlcall, password);
+      ret = xmlrpc_value2string(xmlrpc_param(xmlcall->parser, 1), &password);
       if (ret != XMLRPC_NO_ERROR)
         {
           break;
         }
 
-      ret = xmlrpc_getinteger(xmlcall, &request);
+      ret = xmlrpc_value2int(xmlrpc_param(xmlcall->parser, 2), &request);
       if (ret != XMLRPC_NO_ERROR)
         {
           break;
@@ -99,14 +102,13 @@ static int calls_get_device_stats(struct xmlrpc_s *xmlcall)
     {
       /* Dummy up some data... */
 
-      status = 1;
-      strcpy(lastCommand, "reboot");
-      strcpy(curState, "Normal Operation");
-
-      ret = xmlrpc_buildresponse(xmlcall, "{iss}",
-                                 "status", status,
-                                 "lastCommand", lastCommand,
-                                 "currentState", curState);
+      xmlrpc_beginresponse(writer);
+      xmlrpc_beginstruct(writer, NULL);
+      xmlrpc_putint(writer, "status", 1);
+      xmlrpc_putstring(writer, "lastCommand", "reboot");
+      xmlrpc_putstring(writer, "currentState", "Normal Operation");
+      xmlrpc_endstruct(writer);
+      ret = xmlrpc_endresponse(writer);
     }
 
   return ret;
@@ -53,7 +53,6 @@
  ****************************************************************************/
 
 #include <debug.h>
-#include <sys/select.h>
 #include <sys/socket.h>
 #include <sys/time.h>
 #include <arpa/inet.h>
@@ -84,13 +83,6 @@
 #  include <apps/netutils/dhcpc.h>
 #endif
 
-/****************************************************************************
- * Private Data
- ****************************************************************************/
-
-static const char *notimplemented = { "HTTP/1.1 501 Not Implemented\n\n" };
-static const char *separator = { "\015\012\015\012" };
-
 /****************************************************************************
  * External Function Prototypes
  ****************************************************************************/
@@ -101,157 +93,32 @@ extern void calls_register(void);
  * Private Functions
  ****************************************************************************/
 
-/****************************************************************************
- * Name: xmlrpc_findbody
- *
- * Description:
- *   Find the message body of an HTTP Request Message
- *
- ****************************************************************************/
-
-static char *xmlrpc_findbody(char *buf)
-{
-  char *temp;
-
-  temp = strstr(buf, separator);
-
-  if (temp == NULL)
-    {
-      return NULL;
-    }
-  else
-    {
-      return temp + 4;
-    }
-}
-
-/****************************************************************************
- * Name: xmlrpc_getheader
- *
- * Description:
- *   Find the HTTP header and return it's value.
- *
- ****************************************************************************/
-
-static int xmlrpc_getheader(char *buffer, char *header, char *value, int size)
-{
-  char *temp;
-  int i = 0;
-
-  temp = strstr(buffer, header);
-  if (temp)
-    {
-      /* Skip the header element */
-
-      temp += strlen(header);
-
-      /* Skip any white-space */
-
-      while (*temp == ' ')
-        {
-          temp++;
-        }
-
-      /* Copy the rest to the value parameter */
-
-      while ((*temp != ' ') && (*temp != '\n') && (i < size))
-        {
-          value[i++] = *temp++;
-        }
-
-      value[i] = 0;
-      return i;
-    }
-
-  return -1;
-}
-
 /****************************************************************************
  * Name: xmlrpc_handler
  *
  * Description:
- *    Parse and handle the current HTTP request message.
+ *    Read, parse and handle one HTTP request message.  The request body is
+ *    parsed in place as it arrives.
  *
  ****************************************************************************/
 
 static void xmlrpc_handler(int fd)
 {
-  fd_set rfds;
-  struct timeval tv;
-  int ret, len, max = 0, loadlen = -1;
-  char buffer[CONFIG_EXAMPLES_XMLRPC_BUFFERSIZE] = { 0 };
-  char value[CONFIG_XMLRPC_STRINGSIZE + 1];
-  char *temp;
-
-  /* Read in the Request Header */
-
-  do
-    {
-      FD_ZERO(&rfds);
-      FD_SET(fd, &rfds);
-
-      tv.tv_sec = 1;
-      tv.tv_usec = 0;
-
-      ndbg("[%d] select...\n", fd);
-      ret = select(fd + 1, &rfds, NULL, NULL, &tv);
-      ndbg("[%d] data ready\n", fd);
-
-      if (ret > 0)
-        {
-          if (FD_ISSET(fd, &rfds))
-            {
-              len = recv(fd, &buffer[max], 1024, 0);
-              ndbg("[%d] %d bytes received\n", fd, len);
-
-              if (len > 0)
-                {
-                  max += len;
-                  buffer[max] = 0;
-
-                  ret = xmlrpc_getheader(buffer, "Content-Length:", value,
-                                         CONFIG_EXAMPLES_XMLRPC_BUFFERSIZE);
-                  if (ret > 0)
-                    loadlen = atoi(value);
-                }
-              else
-                {
-                  ret = -1;
-                  break;
-                }
-            }
-        }
-      else
-        {
-          /* Timeout... */
-
-          ndbg("[%d] timeout\n", fd);
-          ret = -1;
-          break;
-        }
+  char buffer[CONFIG_EXAMPLES_XMLRPC_BUFFERSIZE];
+  int ret;
 
-      temp = strstr(buffer, separator);
-
-      if (temp)
-        {
-          if (strlen(temp) - 4 == loadlen)
-            break;
-        }
+#ifdef CONFIG_NET_SOCKOPTS
+  struct timeval tv;
 
-    }
-  while (1);
+  /* Give up on clients that stop sending */
 
-  /* Determine request */
+  tv.tv_sec  = 1;
+  tv.tv_usec = 0;
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(struct timeval));
+#endif
 
-  if (!strncmp(buffer, "POST", 4))
-    {
-      temp = xmlrpc_findbody(buffer);
-      xmlrpc_parse(fd, temp);
-    }
-  else
-    {
-      write(fd, notimplemented, strlen(notimplemented));
-    }
+  ret = xmlrpc_serve(fd, buffer, sizeof(buffer));
+  ndbg("[%d] request handled: %d\n", fd, ret);
 }
 
 /****************************************************************************
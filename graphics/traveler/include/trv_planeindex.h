@@ -0,0 +1,112 @@
+/****************************************************************************
+ * apps/graphics/traveler/include/trv_planeindex.h
+ * This file contains definitions for the uniform grid index of world planes
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_GRAPHICS_TRAVELER_INCLUDE_TRV_PLANEINDEX_H
+#define __APPS_GRAPHICS_TRAVELER_INCLUDE_TRV_PLANEINDEX_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "trv_types.h"
+
+#ifdef CONFIG_GRAPHICS_TRAVELER_PLANEINDEX
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_GRAPHICS_TRAVELER_CELLSHIFT
+#  define CONFIG_GRAPHICS_TRAVELER_CELLSHIFT 8
+#endif
+
+/* The world is divided into square cells of TRV_CELL_SIZE world units on
+ * a side.
+ */
+
+#define TRV_CELL_SHIFT CONFIG_GRAPHICS_TRAVELER_CELLSHIFT
+#define TRV_CELL_SIZE  (1 << TRV_CELL_SHIFT)
+
+/* Get the first and last index in 'cells' for a given column and row */
+
+#define TRV_CELL_FIRST(i,c,r) ((i)->cellndx[(c) * (i)->nrows + (r)])
+#define TRV_CELL_LAST(i,c,r)  ((i)->cellndx[(c) * (i)->nrows + (r) + 1])
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* This structure describes a uniform grid over one set of world planes.
+ *
+ * For the X and Y planes, the "columns" of the grid lie along the axis
+ * normal to the planes (i.e., the plane coordinate) and the "rows" lie
+ * along the "horizontal" extent of the rectangles.  For the Z planes, the
+ * columns lie along the X axis and the rows along the Y axis.
+ *
+ * Each cell holds the rectangles that overlap it as a contiguous run of
+ * 'cells' in ascending plane order.
+ */
+
+struct trv_rect_data_s;
+struct trv_plane_index_s
+{
+  trv_coord_t colbase;      /* World coordinate of the first column */
+  trv_coord_t rowbase;      /* World coordinate of the first row */
+  trv_coord_t pmin;         /* Smallest plane in the index */
+  trv_coord_t pmax;         /* Largest plane in the index */
+  uint16_t ncols;           /* Number of columns in the grid */
+  uint16_t nrows;           /* Number of rows in the grid */
+  FAR uint32_t *cellndx;    /* ncols*nrows+1 indices into 'cells' */
+  FAR struct trv_rect_data_s **cells; /* Rectangles by cell */
+};
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+extern struct trv_plane_index_s g_xindex;  /* Index of X=plane rectangles */
+extern struct trv_plane_index_s g_yindex;  /* Index of Y=plane rectangles */
+extern struct trv_plane_index_s g_zindex;  /* Index of Z=plane rectangles */
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+int  trv_index_planes(void);
+void trv_release_index(void);
+
+#endif /* CONFIG_GRAPHICS_TRAVELER_PLANEINDEX */
+#endif /* __APPS_GRAPHICS_TRAVELER_INCLUDE_TRV_PLANEINDEX_H */
@@ -42,6 +42,7 @@
  ****************************************************************************/
 
 #include "trv_types.h"
+#include "trv_world.h"
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -103,6 +104,16 @@
 
 #define MK_HIT_TYPE(fb,xyz) ((fb)|(xyz))
 
+/* Hot path instrumentation.  TRV_COUNT() adds 'n' to one of the counters in
+ * the ray casting context 'c'.
+ */
+
+#ifdef CONFIG_GRAPHICS_TRAVELER_COUNTERS
+#  define TRV_COUNT(c,f,n) ((c)->counters.f += (n))
+#else
+#  define TRV_COUNT(c,f,n)
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -128,34 +139,76 @@ struct trv_raycast_s
   int16_t zdist;    /* Z distance to the hit (not used) */
 };
 
-/****************************************************************************
- * Public Data
- ****************************************************************************/
+#ifdef CONFIG_GRAPHICS_TRAVELER_COUNTERS
+/* These are the hot path counters collected while rending a frame */
 
-/* This structure holds pre-calculated pitch data for all ray casts.  NOTE:
- * would be a performance improvement if this structure is an even power of
- *two in size (don't have to multiply to calculate indices)
- */
+struct trv_counters_s
+{
+  uint32_t rays;    /* Number of rays cast */
+  uint32_t planes;  /* Number of plane rectangles tested by the ray casters */
+  uint32_t fetches; /* Number of texture fetches by the renderers */
+  uint32_t pixels;  /* Number of pixels written to the render buffer */
+};
+#endif
 
-/* The following array describes the hits from X/Y/Z-ray casting for the
- * current HGULP_SIZE x VGULP_SIZE cell
+/* This structure holds all of the state used while ray casting and rending
+ * one horizontal swathe of the image.  There is one such context for each
+ * thread that participates in rending a frame.
  */
 
-extern struct trv_raycast_s g_ray_hit[VGULP_SIZE][HGULP_SIZE+1];
+struct trv_raycntx_s
+{
+  /* This structure holds the parameters used in the current ray cast */
 
-/* This structure points to the double buffer row corresponding to the
- * pitch angle
- */
+  struct trv_camera_s camera;
 
-extern uint8_t *g_buffer_row[VGULP_SIZE];
+  /* The following are the tangent and the cotangent of the pitch angle
+   * adjusted for the viewing yaw angle so that the view is correct for the
+   * "fish eye" effect which results from the projection of the polar ray
+   * cast onto the flat display
+   */
 
-/* The is the "column" offset in g_buffer_row for the current cell being
- * operated on.  This value is updated in a loop by trv_raycaster.
- */
+  int32_t adj_tanpitch;
+  int32_t adj_cotpitch;
+
+  /* The following array describes the hits from X/Y/Z-ray casting for the
+   * current HGULP_SIZE x VGULP_SIZE cell
+   */
+
+  struct trv_raycast_s hit[VGULP_SIZE][HGULP_SIZE+1];
 
-extern int16_t g_cell_column;
+  /* This array points to the screen buffer row corresponding to the
+   * pitch angle
+   */
 
-/* This structure holds the parameters used in the current ray cast */
+  FAR uint8_t *buffer_row[VGULP_SIZE];
+
+  /* These are all of the pitch angles which will be used by the ray caster
+   * on each horizontal pass.
+   */
+
+  int16_t pitch[VGULP_SIZE];
+
+  /* The is the "column" offset in buffer_row for the current cell being
+   * operated on.  This value is updated in a loop by trv_raycaster.
+   */
+
+  int16_t cell_column;
+
+#ifdef CONFIG_GRAPHICS_TRAVELER_COUNTERS
+  /* Hot path counters for this context */
+
+  struct trv_counters_s counters;
+#endif
+};
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* This structure holds the camera position and orientation for the current
+ * frame.
+ */
 
 extern struct trv_camera_s g_camera;
 
@@ -163,7 +216,7 @@ extern struct trv_camera_s g_camera;
  * Public Function Prototypes
  ****************************************************************************/
 
-void trv_raycast(int16_t pitch, int16_t yaw, int16_t screenyaw,
-                 FAR struct trv_raycast_s *result);
+void trv_raycast(FAR struct trv_raycntx_s *ctx, int16_t pitch, int16_t yaw,
+                 int16_t screenyaw, FAR struct trv_raycast_s *result);
 
 #endif /* __APPS_GRAPHICS_TRAVELER_INCLUDE_TRV_RAYCAST_H */
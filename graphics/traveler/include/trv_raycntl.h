@@ -61,9 +61,16 @@
 
 struct trv_camera_s;
 struct trv_graphics_info_s;
+struct trv_raycntx_s;
+struct trv_counters_s;
 
 void trv_raycaster(FAR struct trv_camera_s *player,
                    FAR struct trv_graphics_info_s *ginfo);
-uint8_t trv_get_texture(uint8_t row, uint8_t col);
+void trv_raycaster_terminate(void);
+#ifdef CONFIG_GRAPHICS_TRAVELER_COUNTERS
+void trv_raycaster_counters(FAR struct trv_counters_s *counters);
+#endif
+uint8_t trv_get_texture(FAR struct trv_raycntx_s *ctx, uint8_t row,
+                        uint8_t col);
 
 #endif /* __APPS_GRAPHICS_TRAVELER_INCLUDE_TRV_RAYCNTL_H */
@@ -0,0 +1,389 @@
+/****************************************************************************
+ * apps/graphics/traveler/src/trv_bench.c
+ * This file contains the timing, counter and frame capture logic of the
+ * headless benchmark.
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included files
+ ****************************************************************************/
+
+#include "trv_types.h"
+#include "trv_main.h"
+#include "trv_debug.h"
+#include "trv_graphics.h"
+#include "trv_raycast.h"
+#include "trv_raycntl.h"
+#include "trv_bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+
+#ifdef CONFIG_GRAPHICS_TRAVELER_TIFF
+#  include <apps/tiff.h>
+#endif
+
+#ifdef CONFIG_GRAPHICS_TRAVELER_HEADLESS
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define BENCH_PATHSIZE 64
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct trv_bench_s
+{
+  struct timespec start;       /* Start time of the current frame */
+  FAR const char *tiffpath;    /* Path prefix for TIFF frames (or NULL) */
+  uint32_t nframes;            /* Number of frames to rend */
+  uint32_t frame;              /* Number of frames rended so far */
+  uint32_t minusec;            /* Shortest frame time */
+  uint32_t maxusec;            /* Longest frame time */
+  uint64_t totalusec;          /* Sum of all frame times */
+#ifdef CONFIG_GRAPHICS_TRAVELER_COUNTERS
+  struct trv_counters_s total; /* Sum of all counters */
+#endif
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct trv_bench_s g_bench;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: trv_bench_time
+ *
+ * Description:
+ *   Get the current time
+ *
+ ***************************************************************************/
+
+static void trv_bench_time(FAR struct timespec *tp)
+{
+  int ret;
+
+#ifdef CONFIG_CLOCK_MONOTONIC
+  ret = clock_gettime(CLOCK_MONOTONIC, tp);
+#else
+  ret = clock_gettime(CLOCK_REALTIME, tp);
+#endif
+
+  if (ret < 0)
+    {
+      trv_abort("ERROR: clock_gettime failed: %d\n", errno);
+    }
+}
+
+/****************************************************************************
+ * Name: trv_bench_savetiff
+ *
+ * Description:
+ *   Write the current frame to a TIFF file.  The headless display is not
+ *   scaled so the expanded image in the hardware buffer has exactly one
+ *   device pixel per rended pixel.
+ *
+ ***************************************************************************/
+
+#ifdef CONFIG_GRAPHICS_TRAVELER_TIFF
+static int trv_bench_savetiff(FAR struct trv_graphics_info_s *ginfo,
+                              uint32_t frame)
+{
+  struct tiff_info_s info;
+  char outfile[BENCH_PATHSIZE];
+  char tmpfile1[BENCH_PATHSIZE];
+  char tmpfile2[BENCH_PATHSIZE];
+  FAR const uint8_t *src;
+  FAR uint8_t *strip = NULL;
+  int row;
+  int ret;
+
+  snprintf(outfile, BENCH_PATHSIZE, "%s%05lu.tif",
+           g_bench.tiffpath, (unsigned long)frame);
+  snprintf(tmpfile1, BENCH_PATHSIZE, "%s.tm1", g_bench.tiffpath);
+  snprintf(tmpfile2, BENCH_PATHSIZE, "%s.tm2", g_bench.tiffpath);
+
+  memset(&info, 0, sizeof(struct tiff_info_s));
+  info.outfile   = outfile;
+  info.tmpfile1  = tmpfile1;
+  info.tmpfile2  = tmpfile2;
+#if TRV_BPP == 16
+  info.colorfmt  = FB_FMT_RGB16_565;
+#else
+  info.colorfmt  = FB_FMT_RGB24;
+#endif
+  info.rps       = 1;
+  info.imgwidth  = ginfo->xres;
+  info.imgheight = ginfo->yres;
+  info.iosize    = 3 * ginfo->xres;
+  info.iobuffer  = (FAR uint8_t *)malloc(info.iosize);
+
+  if (!info.iobuffer)
+    {
+      ret = -ENOMEM;
+      goto errout_with_buffers;
+    }
+
+#if TRV_BPP != 16
+  /* RGB32 is not supported by the TIFF library.  Each row must be
+   * converted to RGB24.
+   */
+
+  strip = (FAR uint8_t *)malloc(3 * ginfo->xres);
+  if (!strip)
+    {
+      ret = -ENOMEM;
+      goto errout_with_buffers;
+    }
+#endif
+
+  ret = tiff_initialize(&info);
+  if (ret < 0)
+    {
+      goto errout_with_buffers;
+    }
+
+  /* Add each row of the image as one strip */
+
+  src = (FAR const uint8_t *)ginfo->hwbuffer;
+  for (row = 0; row < ginfo->yres; row++, src += ginfo->stride)
+    {
+#if TRV_BPP == 16
+      ret = tiff_addstrip(&info, src);
+#else
+      FAR const dev_pixel_t *pixel = (FAR const dev_pixel_t *)src;
+      FAR uint8_t *dest = strip;
+      int col;
+
+      /* Convert RGB32 to RGB24 */
+
+      for (col = 0; col < ginfo->xres; col++, pixel++)
+        {
+          *dest++ = (uint8_t)(*pixel >> 16);
+          *dest++ = (uint8_t)(*pixel >> 8);
+          *dest++ = (uint8_t)(*pixel);
+        }
+
+      ret = tiff_addstrip(&info, strip);
+#endif
+      if (ret < 0)
+        {
+          tiff_abort(&info);
+          goto errout_with_buffers;
+        }
+    }
+
+  ret = tiff_finalize(&info);
+
+errout_with_buffers:
+  if (strip)
+    {
+      free(strip);
+    }
+
+  if (info.iobuffer)
+    {
+      free(info.iobuffer);
+    }
+
+  return ret;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: trv_bench_initialize
+ *
+ * Description:
+ *   Prepare to rend 'nframes' frames.  If 'tiffpath' is not NULL, then
+ *   each frame will also be written to a TIFF file whose name is
+ *   'tiffpath' followed by the frame number.
+ *
+ ***************************************************************************/
+
+void trv_bench_initialize(uint32_t nframes, FAR const char *tiffpath)
+{
+  memset(&g_bench, 0, sizeof(struct trv_bench_s));
+  g_bench.nframes  = nframes;
+  g_bench.minusec  = UINT32_MAX;
+  g_bench.tiffpath = tiffpath;
+
+#ifndef CONFIG_GRAPHICS_TRAVELER_TIFF
+  if (tiffpath)
+    {
+      fprintf(stderr, "WARNING: TIFF output is not supported\n");
+      g_bench.tiffpath = NULL;
+    }
+#endif
+
+#ifdef CONFIG_GRAPHICS_TRAVELER_COUNTERS
+  /* Discard anything counted before the first frame */
+
+  trv_raycaster_counters(&g_bench.total);
+  memset(&g_bench.total, 0, sizeof(struct trv_counters_s));
+
+  printf("frame usec rays planes fetches pixels\n");
+#else
+  printf("frame usec\n");
+#endif
+}
+
+/****************************************************************************
+ * Name: trv_bench_begin
+ *
+ * Description:
+ *   Mark the beginning of a frame
+ *
+ ***************************************************************************/
+
+void trv_bench_begin(void)
+{
+  trv_bench_time(&g_bench.start);
+}
+
+/****************************************************************************
+ * Name: trv_bench_end
+ *
+ * Description:
+ *   Mark the end of a frame:  Report the time to rend the frame and the
+ *   hot path counters, optionally save the frame.  Returns true when all
+ *   of the frames have been rended.
+ *
+ ***************************************************************************/
+
+bool trv_bench_end(FAR struct trv_graphics_info_s *ginfo)
+{
+  struct timespec now;
+  uint32_t usec;
+#ifdef CONFIG_GRAPHICS_TRAVELER_COUNTERS
+  struct trv_counters_s counters;
+#endif
+
+  trv_bench_time(&now);
+
+  usec = (uint32_t)((now.tv_sec - g_bench.start.tv_sec) * 1000000 +
+                    (now.tv_nsec - g_bench.start.tv_nsec) / 1000);
+
+  if (usec < g_bench.minusec)
+    {
+      g_bench.minusec = usec;
+    }
+
+  if (usec > g_bench.maxusec)
+    {
+      g_bench.maxusec = usec;
+    }
+
+  g_bench.totalusec += usec;
+
+#ifdef CONFIG_GRAPHICS_TRAVELER_COUNTERS
+  trv_raycaster_counters(&counters);
+
+  g_bench.total.rays    += counters.rays;
+  g_bench.total.planes  += counters.planes;
+  g_bench.total.fetches += counters.fetches;
+  g_bench.total.pixels  += counters.pixels;
+
+  printf("%lu %lu %lu %lu %lu %lu\n",
+         (unsigned long)g_bench.frame, (unsigned long)usec,
+         (unsigned long)counters.rays, (unsigned long)counters.planes,
+         (unsigned long)counters.fetches, (unsigned long)counters.pixels);
+#else
+  printf("%lu %lu\n", (unsigned long)g_bench.frame, (unsigned long)usec);
+#endif
+
+#ifdef CONFIG_GRAPHICS_TRAVELER_TIFF
+  if (g_bench.tiffpath)
+    {
+      int ret = trv_bench_savetiff(ginfo, g_bench.frame);
+      if (ret < 0)
+        {
+          fprintf(stderr, "ERROR: Failed to save frame %lu: %d\n",
+                  (unsigned long)g_bench.frame, ret);
+        }
+    }
+#endif
+
+  g_bench.frame++;
+  return g_bench.frame >= g_bench.nframes;
+}
+
+/****************************************************************************
+ * Name: trv_bench_summary
+ *
+ * Description:
+ *   Report the summary of all frames
+ *
+ ***************************************************************************/
+
+void trv_bench_summary(void)
+{
+  uint32_t avgusec;
+
+  if (g_bench.frame == 0)
+    {
+      printf("No frames rended\n");
+      return;
+    }
+
+  avgusec = (uint32_t)(g_bench.totalusec / g_bench.frame);
+
+  printf("frames=%lu min=%lu avg=%lu max=%lu usec\n",
+         (unsigned long)g_bench.frame, (unsigned long)g_bench.minusec,
+         (unsigned long)avgusec, (unsigned long)g_bench.maxusec);
+
+#ifdef CONFIG_GRAPHICS_TRAVELER_COUNTERS
+  printf("per frame: rays=%lu planes=%lu fetches=%lu pixels=%lu\n",
+         (unsigned long)(g_bench.total.rays / g_bench.frame),
+         (unsigned long)(g_bench.total.planes / g_bench.frame),
+         (unsigned long)(g_bench.total.fetches / g_bench.frame),
+         (unsigned long)(g_bench.total.pixels / g_bench.frame));
+#endif
+}
+
+#endif /* CONFIG_GRAPHICS_TRAVELER_HEADLESS */
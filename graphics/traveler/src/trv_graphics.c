@@ -75,7 +75,7 @@ bool g_trv_nxrconnected = false;
  *
  ****************************************************************************/
 
-#ifndef CONFIG_NX_MULTIUSER
+#if !defined(CONFIG_NX_MULTIUSER) && !defined(CONFIG_GRAPHICS_TRAVELER_HEADLESS)
 static FAR struct fb_vtable_s *trv_get_fbdev(void)
 {
   FAR struct fb_vtable_s *fbdev;
@@ -111,7 +111,7 @@ static FAR struct fb_vtable_s *trv_get_fbdev(void)
  *
  ****************************************************************************/
 
-#if !defined(CONFIG_NX_MULTIUSER) && !defined(CONFIG_NX)
+#if !defined(CONFIG_NX) && !defined(CONFIG_GRAPHICS_TRAVELER_HEADLESS)
 static void trv_fb_initialize(FAR struct trv_graphics_info_s *ginfo)
 {
   struct fb_videoinfo_s vinfo;
@@ -150,6 +150,31 @@ static void trv_fb_initialize(FAR struct trv_graphics_info_s *ginfo)
 }
 #endif
 
+/****************************************************************************
+ * Name: trv_headless_initialize
+ *
+ * Description:
+ *   Set up a display in memory for the headless benchmark.  The display is
+ *   exactly the size of the render buffer so that no scaling is performed.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_GRAPHICS_TRAVELER_HEADLESS
+static void trv_headless_initialize(FAR struct trv_graphics_info_s *ginfo)
+{
+  ginfo->xres   = TRV_SCREEN_WIDTH;
+  ginfo->yres   = TRV_SCREEN_HEIGHT;
+  ginfo->stride = TRV_SCREEN_WIDTH * sizeof(dev_pixel_t);
+
+  ginfo->hwbuffer = (FAR dev_pixel_t *)
+    trv_malloc(ginfo->stride * TRV_SCREEN_HEIGHT);
+  if (!ginfo->hwbuffer)
+    {
+      trv_abort("ERROR: Failed to allocate headless display\n");
+    }
+}
+#endif
+
 /****************************************************************************
  * Name: trv_use_bgwindow
  *
@@ -387,7 +412,9 @@ int trv_graphics_initialize(FAR struct trv_graphics_info_s *ginfo)
 
   /* Initialize the graphics device and get information about the display */
 
-#if !defined(CONFIG_NX)
+#if defined(CONFIG_GRAPHICS_TRAVELER_HEADLESS)
+  trv_headless_initialize(ginfo);
+#elif !defined(CONFIG_NX)
   trv_fb_initialize(ginfo);
 #elif defined(CONFIG_NX_MULTIUSER)
   trv_nxmu_initialize(ginfo);
@@ -488,13 +515,15 @@ void trv_graphics_terminate(FAR struct trv_graphics_info_s *ginfo)
       ginfo->swbuffer = NULL;
     }
 
-#ifdef CONFIG_NX
+#if defined(CONFIG_NX) || defined(CONFIG_GRAPHICS_TRAVELER_HEADLESS)
   if (ginfo->hwbuffer)
     {
       trv_free(ginfo->hwbuffer);
       ginfo->hwbuffer = NULL;
     }
+#endif
 
+#ifdef CONFIG_NX
   /* Close/disconnect NX */
 #warning "Missing Logic"
 #endif
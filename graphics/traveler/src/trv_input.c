@@ -43,6 +43,7 @@
 #include "trv_trigtbl.h"
 #include "trv_debug.h"
 #include "trv_input.h"
+#include "trv_script.h"
 
 #if defined(CONFIG_GRAPHICS_TRAVELER_JOYSTICK)
 #  include <sys/ioctl.h>
@@ -442,6 +443,32 @@ static int trv_scale_input_pitch(FAR const struct ajoy_sample_s *sample)
 }
 #endif
 
+/****************************************************************************
+ * Name: trv_input_path
+ *
+ * Description:
+ *   Generate the input for a fixed path through the world.  This is used
+ *   by the headless benchmark when no input script is provided:  The
+ *   player walks forward continuously, turning alternately to the left and
+ *   to the right and nodding slowly up and down.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_GRAPHICS_TRAVELER_HEADLESS
+static void trv_input_path(void)
+{
+  static uint32_t frame;
+
+  g_trv_input.fwdrate    = WALK_RATE;
+  g_trv_input.leftrate   = 0;
+  g_trv_input.yawrate    = (frame & 64) != 0 ? -SLOW_TURN : SLOW_TURN;
+  g_trv_input.pitchrate  = (frame & 16) != 0 ? -1 : 1;
+  g_trv_input.stepheight = g_walk_stepheight;
+  g_trv_input.dooropen   = ((frame & 31) == 0);
+
+  frame++;
+}
+#endif
 
 /****************************************************************************
  * Public Functions
@@ -457,7 +484,10 @@ static int trv_scale_input_pitch(FAR const struct ajoy_sample_s *sample)
 
 void trv_input_initialize(void)
 {
-#if defined(CONFIG_GRAPHICS_TRAVELER_DJOYSTICK)
+#if defined(CONFIG_GRAPHICS_TRAVELER_HEADLESS)
+  /* There is no input device */
+
+#elif defined(CONFIG_GRAPHICS_TRAVELER_DJOYSTICK)
   struct djoy_notify_s notify;
 
   /* Open the joy stick device */
@@ -539,7 +569,23 @@ errout_with_fd:
 
 void trv_input_read(void)
 {
-#if defined(CONFIG_GRAPHICS_TRAVELER_JOYSTICK)
+#ifdef CONFIG_GRAPHICS_TRAVELER_SCRIPT
+  /* If an input script is being replayed, then take the input from the
+   * script rather than from the input device.
+   */
+
+  if (trv_script_replay(&g_trv_input))
+    {
+      return;
+    }
+#endif
+
+#if defined(CONFIG_GRAPHICS_TRAVELER_HEADLESS)
+  /* Follow a fixed path through the world */
+
+  trv_input_path();
+
+#elif defined(CONFIG_GRAPHICS_TRAVELER_JOYSTICK)
 #if defined(CONFIG_GRAPHICS_TRAVELER_AJOYSTICK)
   struct ajoy_sample_s sample;
   int ret;
@@ -733,6 +779,12 @@ void trv_input_read(void)
   /* Make position decision based on last sampled X/Y input data */
 #warning Missing logic
 #endif
+
+#ifdef CONFIG_GRAPHICS_TRAVELER_SCRIPT
+  /* Add the input to the script, if one is being recorded */
+
+  trv_script_record(&g_trv_input);
+#endif
 }
 
 /****************************************************************************
@@ -745,7 +797,12 @@ void trv_input_read(void)
 
 void trv_input_terminate(void)
 {
-#ifdef CONFIG_GRAPHICS_TRAVELER_JOYSTICK
+#ifdef CONFIG_GRAPHICS_TRAVELER_SCRIPT
+  trv_script_close();
+#endif
+
+#if defined(CONFIG_GRAPHICS_TRAVELER_JOYSTICK) && \
+   !defined(CONFIG_GRAPHICS_TRAVELER_HEADLESS)
   if (g_trv_joystick.fd > 0)
     {
       close(g_trv_joystick.fd);
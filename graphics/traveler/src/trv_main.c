@@ -48,9 +48,12 @@
 #include "trv_world.h"
 #include "trv_doors.h"
 #include "trv_pov.h"
+#include "trv_raycast.h"
 #include "trv_raycntl.h"
 #include "trv_rayrend.h"
 #include "trv_input.h"
+#include "trv_script.h"
+#include "trv_bench.h"
 #include "trv_graphics.h"
 #include "trv_color.h"
 #include "trv_debug.h"
@@ -108,6 +111,10 @@ static FAR struct trv_graphics_info_s g_trv_ginfo;
 static void trv_exit(int exitcode) noreturn_function;
 static void trv_exit(int exitcode)
 {
+  /* Stop any ray casting worker threads */
+
+  trv_raycaster_terminate();
+
   /* Release memory held by the ray casting engine */
 
   trv_world_destroy();
@@ -131,6 +138,17 @@ static void trv_usage(char *execname)
   fprintf(stderr, "Usage: %s [-b] [-p<path>] [world]\n", execname);
   fprintf(stderr, "Where:\n");
   fprintf(stderr, "  -p<path> Selects the path to the world data file\n");
+#ifdef CONFIG_GRAPHICS_TRAVELER_SCRIPT
+  fprintf(stderr, "  -s<file> Replay player input from a script file\n");
+  fprintf(stderr, "  -r<file> Record player input to a script file\n");
+#endif
+#ifdef CONFIG_GRAPHICS_TRAVELER_HEADLESS
+  fprintf(stderr, "  -n<num>  Number of frames to rend (default %d)\n",
+          CONFIG_GRAPHICS_TRAVELER_BENCH_NFRAMES);
+#ifdef CONFIG_GRAPHICS_TRAVELER_TIFF
+  fprintf(stderr, "  -t<path> Save each frame as <path>NNNNN.tif\n");
+#endif
+#endif
   fprintf(stderr, "  world    Selects the world file name\n");
   exit(EXIT_FAILURE);
 }
@@ -252,6 +270,19 @@ int traveler_main(int argc, char *argv[])
 {
   FAR const char *wldpath;
   FAR const char *wldfile;
+#ifdef CONFIG_GRAPHICS_TRAVELER_SCRIPT
+  FAR const char *script = NULL;
+  bool record = false;
+#endif
+#ifdef CONFIG_GRAPHICS_TRAVELER_HEADLESS
+  FAR const char *tiffpath = NULL;
+  uint32_t nframes = CONFIG_GRAPHICS_TRAVELER_BENCH_NFRAMES;
+#endif
+#if defined(CONFIG_GRAPHICS_TRAVELER_PERFMON) && \
+    defined(CONFIG_GRAPHICS_TRAVELER_COUNTERS) && \
+   !defined(CONFIG_GRAPHICS_TRAVELER_HEADLESS)
+  struct trv_counters_s counters;
+#endif
 #if defined(CONFIG_GRAPHICS_TRAVELER_PERFMON) || \
     defined(CONFIG_GRAPHICS_TRAVELER_LIMITFPS)
 #ifdef CONFIG_GRAPHICS_TRAVELER_PERFMON
@@ -286,6 +317,24 @@ int traveler_main(int argc, char *argv[])
 			  wldpath = ptr++;
               break;
 
+#ifdef CONFIG_GRAPHICS_TRAVELER_SCRIPT
+            case 's' :
+            case 'r' :
+              record = (*ptr == 'r');
+              script = ptr + 1;
+              break;
+#endif
+
+#ifdef CONFIG_GRAPHICS_TRAVELER_HEADLESS
+            case 'n' :
+              nframes = (uint32_t)strtoul(ptr + 1, NULL, 10);
+              break;
+
+            case 't' :
+              tiffpath = ptr + 1;
+              break;
+#endif
+
             default:
               fprintf(stderr, "Invalid Switch\n");
               trv_usage(argv[0]);
@@ -330,6 +379,25 @@ int traveler_main(int argc, char *argv[])
 
   trv_input_initialize();
 
+#ifdef CONFIG_GRAPHICS_TRAVELER_SCRIPT
+  /* Open the input script, if one was provided */
+
+  if (script)
+    {
+      ret = trv_script_open(script, record);
+      if (ret < 0)
+        {
+          trv_abort("ERROR: Failed to open script %s: %d\n", script, ret);
+        }
+    }
+#endif
+
+#ifdef CONFIG_GRAPHICS_TRAVELER_HEADLESS
+  /* Prepare the benchmark */
+
+  trv_bench_initialize(nframes, tiffpath);
+#endif
+
 #ifdef CONFIG_GRAPHICS_TRAVELER_PERFMON
   /* Get the start time for performance monitoring */
 
@@ -345,6 +413,12 @@ int traveler_main(int argc, char *argv[])
       trv_current_time(&frame_start);
 #endif
 
+#ifdef CONFIG_GRAPHICS_TRAVELER_HEADLESS
+      /* Start timing the frame */
+
+      trv_bench_begin();
+#endif
+
       trv_input_read();
 
       /* Select the POV to use on this viewing cycle */
@@ -367,6 +441,15 @@ int traveler_main(int argc, char *argv[])
 
       trv_display_update(&g_trv_ginfo);
 
+#ifdef CONFIG_GRAPHICS_TRAVELER_HEADLESS
+      /* Report the frame and stop after the last frame */
+
+      if (trv_bench_end(&g_trv_ginfo))
+        {
+          g_trv_terminate = true;
+        }
+#endif
+
 #ifdef CONFIG_GRAPHICS_TRAVELER_LIMITFPS
        /* In the unlikely event that we are running "too" fast, we can delay
         * here to enforce a maixmum frame rate.
@@ -389,6 +472,18 @@ int traveler_main(int argc, char *argv[])
 
           fprintf(stderr, "fps = %3.2f\n", (double)(frame_count * 1000000) / (double)elapsed_usec);
 
+#if defined(CONFIG_GRAPHICS_TRAVELER_COUNTERS) && \
+   !defined(CONFIG_GRAPHICS_TRAVELER_HEADLESS)
+          /* Show the average hot path counts per frame */
+
+          trv_raycaster_counters(&counters);
+          fprintf(stderr, "rays=%lu planes=%lu fetches=%lu pixels=%lu\n",
+                  (unsigned long)(counters.rays / frame_count),
+                  (unsigned long)(counters.planes / frame_count),
+                  (unsigned long)(counters.fetches / frame_count),
+                  (unsigned long)(counters.pixels / frame_count));
+#endif
+
           frame_count        = 0;
           start_time.tv_sec  = now.tv_sec;
           start_time.tv_nsec = now.tv_nsec;
@@ -396,6 +491,10 @@ int traveler_main(int argc, char *argv[])
 #endif
     }
 
+#ifdef CONFIG_GRAPHICS_TRAVELER_HEADLESS
+  trv_bench_summary();
+#endif
+
   trv_exit(EXIT_SUCCESS);
   return 0;
 }
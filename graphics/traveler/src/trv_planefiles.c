@@ -40,6 +40,7 @@
 
 #include "trv_types.h"
 #include "trv_plane.h"
+#include "trv_planeindex.h"
 
 #include <stdio.h>
 #include <errno.h>
@@ -66,7 +67,7 @@
  ***************************************************************************/
 
 static int trv_load_worldplane(FAR FILE *fp, FAR struct trv_rect_head_s *head,
-                               uint8_t nrects)
+                               uint16_t nrects)
 {
   FAR struct trv_rect_list_s *rect;
   int ret;
@@ -178,6 +179,16 @@ int trv_load_planefile(FAR const char *wldfile)
   /* Close the file */
 
   fclose(fp);
+
+#ifdef CONFIG_GRAPHICS_TRAVELER_PLANEINDEX
+  /* Build the grid index that will be used by the ray casters */
+
+  if (ret == OK)
+    {
+      ret = trv_index_planes();
+    }
+#endif
+
   return ret;
 }
 
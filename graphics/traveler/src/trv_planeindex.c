@@ -0,0 +1,276 @@
+/****************************************************************************
+ * apps/graphics/traveler/src/trv_planeindex.c
+ * This file contains the logic to build a uniform grid index of the world
+ * planes.
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included files
+ ****************************************************************************/
+
+#include "trv_types.h"
+#include "trv_mem.h"
+#include "trv_plane.h"
+#include "trv_trigtbl.h"
+#include "trv_raycast.h"
+#include "trv_planeindex.h"
+
+#include <string.h>
+
+#ifdef CONFIG_GRAPHICS_TRAVELER_PLANEINDEX
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+struct trv_plane_index_s g_xindex;  /* Index of X=plane rectangles */
+struct trv_plane_index_s g_yindex;  /* Index of Y=plane rectangles */
+struct trv_plane_index_s g_zindex;  /* Index of Z=plane rectangles */
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: trv_rect_cells
+ *
+ * Description:
+ *   Return the range of grid columns and rows overlapped by one rectangle
+ *
+ ***************************************************************************/
+
+static void trv_rect_cells(FAR const struct trv_plane_index_s *index,
+                           FAR const struct trv_rect_data_s *rect,
+                           bool zplane, FAR int *col0, FAR int *col1,
+                           FAR int *row0, FAR int *row1)
+{
+  if (zplane)
+    {
+      /* Z planes cover a range of columns (X) and rows (Y) */
+
+      *col0 = (rect->hstart - index->colbase) >> TRV_CELL_SHIFT;
+      *col1 = (rect->hend   - index->colbase) >> TRV_CELL_SHIFT;
+      *row0 = (rect->vstart - index->rowbase) >> TRV_CELL_SHIFT;
+      *row1 = (rect->vend   - index->rowbase) >> TRV_CELL_SHIFT;
+    }
+  else
+    {
+      /* X and Y planes lie in exactly one column */
+
+      *col0 = (rect->plane  - index->colbase) >> TRV_CELL_SHIFT;
+      *col1 = *col0;
+      *row0 = (rect->hstart - index->rowbase) >> TRV_CELL_SHIFT;
+      *row1 = (rect->hend   - index->rowbase) >> TRV_CELL_SHIFT;
+    }
+}
+
+/****************************************************************************
+ * Name: trv_build_index
+ *
+ * Description:
+ *   Build the grid index for one plane list.  The plane list is maintained
+ *   in ascending plane order so the rectangles in each cell will also be
+ *   in ascending plane order.
+ *
+ ***************************************************************************/
+
+static void trv_build_index(FAR struct trv_plane_index_s *index,
+                            FAR struct trv_rect_head_s *list, bool zplane)
+{
+  FAR struct trv_rect_list_s *entry;
+  FAR struct trv_rect_data_s *rect;
+  trv_coord_t cmin;
+  trv_coord_t cmax;
+  trv_coord_t rmin;
+  trv_coord_t rmax;
+  uint32_t ncells;
+  uint32_t total;
+  uint32_t i;
+  int col0;
+  int col1;
+  int row0;
+  int row1;
+  int col;
+  int row;
+
+  memset(index, 0, sizeof(struct trv_plane_index_s));
+  if (!list->head)
+    {
+      return;
+    }
+
+  /* Get the extent of the grid */
+
+  index->pmin = list->head->d.plane;
+  index->pmax = list->tail->d.plane;
+
+  cmin = rmin = TRV_INFINITY;
+  cmax = rmax = -TRV_INFINITY;
+
+  for (entry = list->head; entry; entry = entry->flink)
+    {
+      rect = &entry->d;
+      if (zplane)
+        {
+          cmin = MIN(cmin, rect->hstart);
+          cmax = MAX(cmax, rect->hend);
+          rmin = MIN(rmin, rect->vstart);
+          rmax = MAX(rmax, rect->vend);
+        }
+      else
+        {
+          cmin = MIN(cmin, rect->plane);
+          cmax = MAX(cmax, rect->plane);
+          rmin = MIN(rmin, rect->hstart);
+          rmax = MAX(rmax, rect->hend);
+        }
+    }
+
+  index->colbase = cmin;
+  index->rowbase = rmin;
+  index->ncols   = ((cmax - cmin) >> TRV_CELL_SHIFT) + 1;
+  index->nrows   = ((rmax - rmin) >> TRV_CELL_SHIFT) + 1;
+
+  ncells         = (uint32_t)index->ncols * (uint32_t)index->nrows;
+  index->cellndx = (FAR uint32_t *)
+    trv_malloc((ncells + 1) * sizeof(uint32_t));
+  memset(index->cellndx, 0, (ncells + 1) * sizeof(uint32_t));
+
+  /* Count the number of rectangles that overlap each cell */
+
+  for (entry = list->head; entry; entry = entry->flink)
+    {
+      trv_rect_cells(index, &entry->d, zplane, &col0, &col1, &row0, &row1);
+      for (col = col0; col <= col1; col++)
+        {
+          for (row = row0; row <= row1; row++)
+            {
+              index->cellndx[col * index->nrows + row]++;
+            }
+        }
+    }
+
+  /* Convert the counts into the index of the end of each cell */
+
+  for (total = 0, i = 0; i < ncells; i++)
+    {
+      total += index->cellndx[i];
+      index->cellndx[i] = total;
+    }
+
+  index->cellndx[ncells] = total;
+  index->cells = (FAR struct trv_rect_data_s **)
+    trv_malloc((total ? total : 1) * sizeof(FAR struct trv_rect_data_s *));
+
+  /* Then fill in the cells from the back.  Traversing the list backward
+   * leaves each cell in ascending plane order and leaves each cellndx
+   * entry pointing at the beginning of the cell.
+   */
+
+  for (entry = list->tail; entry; entry = entry->blink)
+    {
+      trv_rect_cells(index, &entry->d, zplane, &col0, &col1, &row0, &row1);
+      for (col = col0; col <= col1; col++)
+        {
+          for (row = row0; row <= row1; row++)
+            {
+              uint32_t ndx = --index->cellndx[col * index->nrows + row];
+              index->cells[ndx] = &entry->d;
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: trv_release_cells
+ *
+ * Description:
+ *   Release the memory used by one plane index
+ *
+ ***************************************************************************/
+
+static void trv_release_cells(FAR struct trv_plane_index_s *index)
+{
+  if (index->cellndx)
+    {
+      trv_free(index->cellndx);
+    }
+
+  if (index->cells)
+    {
+      trv_free(index->cells);
+    }
+
+  memset(index, 0, sizeof(struct trv_plane_index_s));
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: trv_index_planes
+ *
+ * Description:
+ *   Build the grid index of the world planes.  This must be called after
+ *   the world planes have been loaded and before any ray casting.
+ *
+ ***************************************************************************/
+
+int trv_index_planes(void)
+{
+  trv_release_index();
+
+  trv_build_index(&g_xindex, &g_xplane, false);
+  trv_build_index(&g_yindex, &g_yplane, false);
+  trv_build_index(&g_zindex, &g_zplane, true);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: trv_release_index
+ *
+ * Description:
+ *   Release the grid index of the world planes
+ *
+ ***************************************************************************/
+
+void trv_release_index(void)
+{
+  trv_release_cells(&g_xindex);
+  trv_release_cells(&g_yindex);
+  trv_release_cells(&g_zindex);
+}
+
+#endif /* CONFIG_GRAPHICS_TRAVELER_PLANEINDEX */
@@ -41,6 +41,7 @@
 #include "trv_types.h"
 #include "trv_mem.h"
 #include "trv_plane.h"
+#include "trv_planeindex.h"
 
 /****************************************************************************
  * Public Data
@@ -365,6 +366,12 @@ FAR struct trv_rect_list_s *trv_new_plane(void)
 
 void trv_release_planes(void)
 {
+#ifdef CONFIG_GRAPHICS_TRAVELER_PLANEINDEX
+  /* Release the grid index which refers to the world planes */
+
+  trv_release_index();
+
+#endif
   /* Release all world planes */
 
   trv_release_worldplane(g_xplane.head);
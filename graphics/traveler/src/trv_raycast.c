@@ -47,6 +47,7 @@
 #include "trv_rayrend.h"
 #include "trv_rayprune.h"
 #include "trv_raycast.h"
+#include "trv_planeindex.h"
 
 /****************************************************************************
  * Compilation switches
@@ -64,29 +65,465 @@
  * Private Function Prototypes
  ****************************************************************************/
 
-static void trv_ray_xcaster14(FAR struct trv_raycast_s *result);
-static void trv_ray_xcaster23(FAR struct trv_raycast_s *result);
-static void trv_ray_ycaster12(FAR struct trv_raycast_s *result);
-static void trv_ray_ycaster34(FAR struct trv_raycast_s *result);
-static void trv_ray_zcasteru(FAR struct trv_raycast_s *result);
-static void trv_ray_zcasterl(FAR struct trv_raycast_s *result);
+static void trv_ray_xcaster14(FAR struct trv_raycntx_s *ctx,
+                              FAR struct trv_raycast_s *result);
+static void trv_ray_xcaster23(FAR struct trv_raycntx_s *ctx,
+                              FAR struct trv_raycast_s *result);
+static void trv_ray_ycaster12(FAR struct trv_raycntx_s *ctx,
+                              FAR struct trv_raycast_s *result);
+static void trv_ray_ycaster34(FAR struct trv_raycntx_s *ctx,
+                              FAR struct trv_raycast_s *result);
+static void trv_ray_zcasteru(FAR struct trv_raycntx_s *ctx,
+                             FAR struct trv_raycast_s *result);
+static void trv_ray_zcasterl(FAR struct trv_raycntx_s *ctx,
+                             FAR struct trv_raycast_s *result);
 
 /****************************************************************************
- * Private Data
+ * Private Functions
  ****************************************************************************/
 
-/* The following are the tangent and the cotangent of the pitch angle
- * adjusted for the viewing yaw angle so that the view is correct for the
- * "fish eye" effect which results from the projection of the polar ray cast
- * onto the flat display
- */
+#ifdef CONFIG_GRAPHICS_TRAVELER_PLANEINDEX
+/****************************************************************************
+ * Name: trv_ray_wallhit
+ *
+ * Description:
+ *   Decide if a ray that has intersected an X or Y plane rectangle at
+ *   (hpos, *vpos) produces a visible hit.  For the case of a moving door,
+ *   *vpos is adjusted for the distance that the door has moved.
+ *
+ ***************************************************************************/
+
+static bool trv_ray_wallhit(FAR struct trv_rect_data_s *rect, uint8_t type,
+                            trv_coord_t hpos, FAR trv_coord_t *vpos)
+{
+  /* Check if we just hit an ordinary opaque wall */
+
+  if (IS_NORMAL(rect))
+    {
+      return true;
+    }
+  else if (IS_DOOR(rect))
+    {
+      /* Check if the door is in motion. */
+
+      if (!IS_MOVING_DOOR(rect))
+        {
+          return true;
+        }
+
+      /* The door is in motion, the Z-position to see if we can see under
+       * the door
+       */
+
+      else if (*vpos > g_opendoor.zbottom)
+        {
+          *vpos -= g_opendoor.zdist;
+          return true;
+        }
+
+      return false;
+    }
 
-static int32_t g_adj_tanpitch;
-static int32_t g_adj_cotpitch;
+  /* Otherwise, it must be a transparent wall.  We'll need to make our
+   * decision based upon the pixel that we hit
+   */
+
+  else if ((type & FB_MASK) == FRONT_HIT)
+    {
+      return GET_FRONT_PIXEL(rect, hpos, *vpos) != INVISIBLE_PIXEL;
+    }
+  else
+    {
+      return GET_BACK_PIXEL(rect, hpos, *vpos) != INVISIBLE_PIXEL;
+    }
+}
 
 /****************************************************************************
- * Private Functions
- ****************************************************************************/
+ * Name: trv_ray_wallcast
+ *
+ * Description:
+ *   Cast a ray against the X or Y plane rectangles using the grid index.
+ *   The ray advances one grid column at a time.  Only the cells of the
+ *   column that the ray passes through are examined and the nearest hit in
+ *   the column terminates the cast.
+ *
+ *   For the X planes, 'pcam' is the camera X position, 'hcam' is the
+ *   camera Y position, and 'dhdp' is the rate of change of Y wrt X.  For
+ *   the Y planes, the roles of X and Y are reversed.  A FRONT_HIT 'type'
+ *   means that the ray proceeds in the positive direction.  Hits beyond
+ *   'limit' are ignored.
+ *
+ ***************************************************************************/
+
+static void trv_ray_wallcast(FAR struct trv_raycntx_s *ctx,
+                             FAR struct trv_raycast_s *result,
+                             FAR const struct trv_plane_index_s *index,
+                             trv_coord_t pcam, trv_coord_t hcam,
+                             int32_t dhdp, int32_t dzdp, uint8_t type,
+                             trv_coord_t limit)
+{
+  FAR struct trv_rect_data_s *rect; /* Points to the rectangle data */
+  bool positive;                    /* True: Casting in the + direction */
+  bool found;                       /* True: Hit found in this column */
+  trv_coord_t rel;                  /* Relative position of the plane */
+  trv_coord_t habs;                 /* Absolute "horizontal" position */
+  trv_coord_t zabs;                 /* Absolute Z position */
+  trv_coord_t best;                 /* Distance to the nearest hit */
+  int32_t relnear;                  /* Nearest distance in the column */
+  int32_t relfar;                   /* Farthest distance in the column */
+  int32_t hnear;                    /* Horizontal position at relnear */
+  int32_t hfar;                     /* Horizontal position at relfar */
+  int32_t pstart;                   /* First plane position in the column */
+  int camcol;                       /* Column containing the camera */
+  int col;                          /* Current column */
+  int endcol;                       /* Column beyond the last */
+  int step;                         /* Column increment */
+  int row0;                         /* First row traversed in the column */
+  int row1;                         /* Last row traversed in the column */
+  int row;
+  uint32_t i;
+
+  if (index->ncols == 0)
+    {
+      return;
+    }
+
+  /* Get the range of columns that may be traversed by the ray */
+
+  positive = ((type & FB_MASK) == FRONT_HIT);
+  camcol   = (pcam - index->colbase) >> TRV_CELL_SHIFT;
+
+  if (positive)
+    {
+      if (camcol >= (int)index->ncols)
+        {
+          return;
+        }
+
+      col    = MAX(camcol, 0);
+      endcol = index->ncols;
+      step   = 1;
+    }
+  else
+    {
+      if (camcol < 0)
+        {
+          return;
+        }
+
+      col    = MIN(camcol, (int)index->ncols - 1);
+      endcol = -1;
+      step   = -1;
+    }
+
+  for (; col != endcol; col += step)
+    {
+      /* Get the range of distances to the planes in this column */
+
+      pstart = (int32_t)index->colbase + ((int32_t)col << TRV_CELL_SHIFT);
+      if (positive)
+        {
+          relnear = pstart - pcam;
+          relfar  = pstart + TRV_CELL_SIZE - 1 - pcam;
+        }
+      else
+        {
+          relnear = pcam - (pstart + TRV_CELL_SIZE - 1);
+          relfar  = pcam - pstart;
+        }
+
+      relnear = MAX(relnear, 1);
+      if (relfar < relnear)
+        {
+          continue;
+        }
+
+      /* Everything else in this direction lies beyond the limit */
+
+      if (relnear > limit)
+        {
+          return;
+        }
+
+      /* Get the range of rows that the ray passes through in this column */
+
+      hnear = tTOs(dhdp * relnear) + hcam;
+      hfar  = tTOs(dhdp * relfar) + hcam;
+
+      row0 = (MIN(hnear, hfar) - index->rowbase) >> TRV_CELL_SHIFT;
+      row1 = (MAX(hnear, hfar) - index->rowbase) >> TRV_CELL_SHIFT;
+
+      /* Stop if the ray has left the grid and is moving away from it */
+
+      if ((row0 >= (int)index->nrows && dhdp >= 0) ||
+          (row1 < 0 && dhdp <= 0))
+        {
+          return;
+        }
+
+      row0 = MAX(row0, 0);
+      row1 = MIN(row1, (int)index->nrows - 1);
+
+      /* Find the nearest hit among the rectangles in those cells */
+
+      found = false;
+      best  = limit;
+
+      for (row = row0; row <= row1; row++)
+        {
+          for (i = TRV_CELL_FIRST(index, col, row);
+               i < TRV_CELL_LAST(index, col, row);
+               i++)
+            {
+              rect = index->cells[i];
+              TRV_COUNT(ctx, planes, 1);
+
+              rel  = positive ? rect->plane - pcam : pcam - rect->plane;
+
+              if (rel <= 0 || rel > best || (found && rel == best))
+                {
+                  continue;
+                }
+
+              /* Check if the "horizontal" position intersects the
+               * rectangle.  The rate of change is stored at double the
+               * "normal" scaling -- so the product is "triple" precision.
+               */
+
+              habs = tTOs(dhdp * ((int32_t)rel)) + hcam;
+              if (habs < rect->hstart || habs > rect->hend)
+                {
+                  continue;
+                }
+
+              /* Check if this Z position intersects the rectangle */
+
+              zabs = tTOs(dzdp * ((int32_t)rel)) + ctx->camera.z;
+              if (zabs < rect->vstart || zabs > rect->vend)
+                {
+                  continue;
+                }
+
+              /* We've got a potential hit, let's see what it is */
+
+              if (trv_ray_wallhit(rect, type, habs, &zabs))
+                {
+                  result->rect = rect;
+                  result->type = type;
+                  result->xpos = habs;
+                  result->ypos = zabs;
+
+                  if ((type & XYZ_MASK) == X_HIT)
+                    {
+                      result->xdist = rel;
+                      result->ydist = ABS(habs - hcam);
+                    }
+                  else
+                    {
+                      result->xdist = ABS(habs - hcam);
+                      result->ydist = rel;
+                    }
+
+                  result->zdist = ABS(zabs - ctx->camera.z);
+
+                  found = true;
+                  best  = rel;
+                }
+            }
+        }
+
+      /* Any hit in this column is nearer than any hit in the columns that
+       * follow.
+       */
+
+      if (found)
+        {
+          return;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: trv_ray_floorcast
+ *
+ * Description:
+ *   Cast a ray against the Z plane rectangles using the grid index.  The
+ *   ray advances in steps of Z distance chosen so that the ray moves no more
+ *   than one grid cell horizontally per step.  Only the cells that the ray
+ *   passes through in each step are examined and the nearest hit in the
+ *   step terminates the cast.
+ *
+ *   A BACK_HIT 'type' (ceiling) means that the ray proceeds in the positive
+ *   Z direction.
+ *
+ ***************************************************************************/
+
+static void trv_ray_floorcast(FAR struct trv_raycntx_s *ctx,
+                              FAR struct trv_raycast_s *result,
+                              int32_t dxdz, int32_t dydz, uint8_t type)
+{
+  FAR const struct trv_plane_index_s *index = &g_zindex;
+  FAR struct trv_rect_data_s *rect; /* Points to the rectangle data */
+  bool upper;                       /* True: Casting in the + direction */
+  bool found;                       /* True: Hit found in this step */
+  trv_coord_t relz;                 /* Relative position of the Z plane */
+  trv_coord_t absx;                 /* Absolute X position at relz */
+  trv_coord_t absy;                 /* Absolute Y position at relz */
+  trv_coord_t best;                 /* Distance to the nearest hit */
+  int32_t relmax;                   /* Largest Z distance to consider */
+  int32_t zstep;                    /* Z distance moved in one step */
+  int32_t rel0;                     /* Nearest Z distance in this step */
+  int32_t rel1;                     /* Farthest Z distance in this step */
+  int32_t slope;                    /* Largest horizontal rate of change */
+  int32_t x0;
+  int32_t x1;
+  int32_t y0;
+  int32_t y1;
+  int col0;
+  int col1;
+  int row0;
+  int row1;
+  int col;
+  int row;
+  uint32_t i;
+
+  if (index->ncols == 0)
+    {
+      return;
+    }
+
+  /* Get the largest Z distance to any plane in the casting direction.  There
+   * is no need to look beyond any hit that has already been found.
+   */
+
+  upper = ((type & FB_MASK) == BACK_HIT);
+  if (upper)
+    {
+      relmax = (int32_t)index->pmax - ctx->camera.z;
+    }
+  else
+    {
+      relmax = (int32_t)ctx->camera.z - index->pmin;
+    }
+
+  relmax = MIN(relmax, result->zdist);
+  if (relmax < 1)
+    {
+      return;
+    }
+
+  /* Choose a Z step that moves the ray at most one cell horizontally.  The
+   * rates of change are "double" precision.
+   */
+
+  slope = MAX(ABS(dxdz), ABS(dydz));
+  if (slope > 0)
+    {
+      zstep = ((int32_t)TRV_CELL_SIZE << dSHIFT) / slope;
+      zstep = MAX(zstep, 1);
+    }
+  else
+    {
+      zstep = relmax;
+    }
+
+  for (rel0 = 1; rel0 <= relmax; rel0 = rel1 + 1)
+    {
+      rel1 = MIN(rel0 + zstep - 1, relmax);
+
+      /* Get the range of cells that the ray passes through in this step */
+
+      x0 = tTOs(dxdz * rel0) + ctx->camera.x;
+      x1 = tTOs(dxdz * rel1) + ctx->camera.x;
+      y0 = tTOs(dydz * rel0) + ctx->camera.y;
+      y1 = tTOs(dydz * rel1) + ctx->camera.y;
+
+      col0 = (MIN(x0, x1) - index->colbase) >> TRV_CELL_SHIFT;
+      col1 = (MAX(x0, x1) - index->colbase) >> TRV_CELL_SHIFT;
+      row0 = (MIN(y0, y1) - index->rowbase) >> TRV_CELL_SHIFT;
+      row1 = (MAX(y0, y1) - index->rowbase) >> TRV_CELL_SHIFT;
+
+      /* Stop if the ray has left the grid and is moving away from it */
+
+      if ((col0 >= (int)index->ncols && dxdz >= 0) ||
+          (col1 < 0 && dxdz <= 0) ||
+          (row0 >= (int)index->nrows && dydz >= 0) ||
+          (row1 < 0 && dydz <= 0))
+        {
+          return;
+        }
+
+      col0 = MAX(col0, 0);
+      col1 = MIN(col1, (int)index->ncols - 1);
+      row0 = MAX(row0, 0);
+      row1 = MIN(row1, (int)index->nrows - 1);
+
+      /* Find the nearest hit among the rectangles in those cells */
+
+      found = false;
+      best  = rel1;
+
+      for (col = col0; col <= col1; col++)
+        {
+          for (row = row0; row <= row1; row++)
+            {
+              for (i = TRV_CELL_FIRST(index, col, row);
+                   i < TRV_CELL_LAST(index, col, row);
+                   i++)
+                {
+                  rect = index->cells[i];
+                  TRV_COUNT(ctx, planes, 1);
+
+                  relz = upper ? rect->plane - ctx->camera.z :
+                                 ctx->camera.z - rect->plane;
+
+                  if (relz < rel0 || relz > best || (found && relz == best))
+                    {
+                      continue;
+                    }
+
+                  /* Check if the X position intersects the rectangle */
+
+                  absx = tTOs(dxdz * ((int32_t)relz)) + ctx->camera.x;
+                  if (absx < rect->hstart || absx > rect->hend)
+                    {
+                      continue;
+                    }
+
+                  /* Check if the Y position intersects the rectangle */
+
+                  absy = tTOs(dydz * ((int32_t)relz)) + ctx->camera.y;
+                  if (absy < rect->vstart || absy > rect->vend)
+                    {
+                      continue;
+                    }
+
+                  /* We've got a hit, ..Save the parameters associated with
+                   * the floor or ceiling hit
+                   */
+
+                  result->rect = rect;
+                  result->type = type;
+                  result->xpos = absx;
+                  result->ypos = absy;
+
+                  result->xdist = ABS(absx - ctx->camera.x);
+                  result->ydist = ABS(absy - ctx->camera.y);
+                  result->zdist = relz;
+
+                  found = true;
+                  best  = relz;
+                }
+            }
+        }
+
+      if (found)
+        {
+          return;
+        }
+    }
+}
+#endif /* CONFIG_GRAPHICS_TRAVELER_PLANEINDEX */
 
 /****************************************************************************
  * Name: trv_ray_xcaster14
@@ -105,8 +542,10 @@ static int32_t g_adj_cotpitch;
  *
  ***************************************************************************/
 
-static void trv_ray_xcaster14(FAR struct trv_raycast_s *result)
+static void trv_ray_xcaster14(FAR struct trv_raycntx_s *ctx,
+                              FAR struct trv_raycast_s *result)
 {
+#ifndef CONFIG_GRAPHICS_TRAVELER_PLANEINDEX
   struct trv_rect_list_s *list; /* Points to the current X plane rectangle */
   struct trv_rect_data_s *rect; /* Points to the rectangle data */
   trv_coord_t relx;             /* Relative position of the X plane */
@@ -114,6 +553,7 @@ static void trv_ray_xcaster14(FAR struct trv_raycast_s *result)
   trv_coord_t absz;             /* Absolute Z position at relx given pitch */
   trv_coord_t lastrelx1 = -1;   /* Last relative X position processed */
   trv_coord_t lastrelx2 = -1;   /* Last relative X position processed */
+#endif
   int32_t dydx;                 /* Rate of change of Y wrt X (double) */
   int32_t dzdx;                 /* Rate of change of Z wrt X (double) */
 
@@ -121,7 +561,7 @@ static void trv_ray_xcaster14(FAR struct trv_raycast_s *result)
    * are possible!
    */
 
-  if (g_camera.yaw == ANGLE_270)
+  if (ctx->camera.yaw == ANGLE_270)
     {
       return;
     }
@@ -131,15 +571,21 @@ static void trv_ray_xcaster14(FAR struct trv_raycast_s *result)
    * X-axis.  The tangent is stored at double the "normal" scaling.
    */
 
-  dydx = TAN(g_camera.yaw);
+  dydx = TAN(ctx->camera.yaw);
 
   /* Determine the rate of change of the Z with respect to X. The tangent is
    * "double" precision; the secant is "double" precision.  dzdx will be
    * retained as "double" precision.
    */
 
-  dzdx = qTOd(g_adj_tanpitch * ABS(g_sec_table[g_camera.yaw]));
+  dzdx = qTOd(ctx->adj_tanpitch * ABS(g_sec_table[ctx->camera.yaw]));
+
+#ifdef CONFIG_GRAPHICS_TRAVELER_PLANEINDEX
+  /* Visit only the rectangles in the grid cells traversed by the ray */
 
+  trv_ray_wallcast(ctx, result, &g_xindex, ctx->camera.x, ctx->camera.y,
+                   dydx, dzdx, MK_HIT_TYPE(FRONT_HIT, X_HIT), TRV_INFINITY);
+#else
   /* Look at every rectangle lying in the X plane */
   /* This logic should be improved at some point so that non-visible planes
    * are "pruned" from the list prior to ray casting!
@@ -148,16 +594,17 @@ static void trv_ray_xcaster14(FAR struct trv_raycast_s *result)
   for (list = g_ray_xplane.head; list; list = list->flink)
     {
       rect = &list->d;
+      TRV_COUNT(ctx, planes, 1);
 
       /* Search for a rectangle which lies "beyond" the current camera
        * position
        */
 
-      if (rect->plane > g_camera.x)
+      if (rect->plane > ctx->camera.x)
         {
           /* get the X distance to the plane */
 
-          relx = rect->plane - g_camera.x;
+          relx = rect->plane - ctx->camera.x;
 
 #if 0
           /* g_ray_xplane is an ordered list, if we have already hit something
@@ -184,7 +631,7 @@ static void trv_ray_xcaster14(FAR struct trv_raycast_s *result)
                */
 
               deltay    = dydx * ((int32_t) relx);
-              absy      = tTOs(deltay) + g_camera.y; /* back to "single" */
+              absy      = tTOs(deltay) + ctx->camera.y; /* back to "single" */
               lastrelx1 = relx;
             }
 
@@ -207,7 +654,7 @@ static void trv_ray_xcaster14(FAR struct trv_raycast_s *result)
                    */
 
                   deltaz    = dzdx * ((int32_t) relx);
-                  absz      = tTOs(deltaz) + g_camera.z; /* Back to single */
+                  absz      = tTOs(deltaz) + ctx->camera.z; /* Back to single */
                   lastrelx2 = relx;
                 }
 
@@ -230,8 +677,8 @@ static void trv_ray_xcaster14(FAR struct trv_raycast_s *result)
                       result->ypos = absz;
 
                       result->xdist = relx;
-                      result->ydist = ABS(absy - g_camera.y);
-                      result->zdist = ABS(absz - g_camera.z);
+                      result->ydist = ABS(absy - ctx->camera.y);
+                      result->zdist = ABS(absz - ctx->camera.z);
 
                       /* Terminate X casting */
 
@@ -253,8 +700,8 @@ static void trv_ray_xcaster14(FAR struct trv_raycast_s *result)
                           result->ypos = absz;
 
                           result->xdist = relx;
-                          result->ydist = ABS(absy - g_camera.y);
-                          result->zdist = ABS(absz - g_camera.z);
+                          result->ydist = ABS(absy - ctx->camera.y);
+                          result->zdist = ABS(absz - ctx->camera.z);
 
                           /* Terminate X casting */
 
@@ -277,8 +724,8 @@ static void trv_ray_xcaster14(FAR struct trv_raycast_s *result)
                           result->ypos = absz - g_opendoor.zdist;
 
                           result->xdist = relx;
-                          result->ydist = ABS(absy - g_camera.y);
-                          result->zdist = ABS(absz - g_camera.z);
+                          result->ydist = ABS(absy - ctx->camera.y);
+                          result->zdist = ABS(absz - ctx->camera.z);
 
                           /* Terminate X casting */
 
@@ -304,8 +751,8 @@ static void trv_ray_xcaster14(FAR struct trv_raycast_s *result)
                       result->ypos = absz;
 
                       result->xdist = relx;
-                      result->ydist = ABS(absy - g_camera.y);
-                      result->zdist = ABS(absz - g_camera.z);
+                      result->ydist = ABS(absy - ctx->camera.y);
+                      result->zdist = ABS(absz - ctx->camera.z);
 
                       /* Terminate X casting */
 
@@ -315,6 +762,7 @@ static void trv_ray_xcaster14(FAR struct trv_raycast_s *result)
             }
         }
     }
+#endif
 }
 
 /****************************************************************************
@@ -334,8 +782,10 @@ static void trv_ray_xcaster14(FAR struct trv_raycast_s *result)
  *
  ***************************************************************************/
 
-static void trv_ray_xcaster23(FAR struct trv_raycast_s *result)
+static void trv_ray_xcaster23(FAR struct trv_raycntx_s *ctx,
+                              FAR struct trv_raycast_s *result)
 {
+#ifndef CONFIG_GRAPHICS_TRAVELER_PLANEINDEX
   struct trv_rect_list_s *list; /* Points to the current X plane rectangle */
   struct trv_rect_data_s *rect; /* Points to the rectangle data */
   trv_coord_t relx;             /* Relative position of the X plane */
@@ -343,6 +793,7 @@ static void trv_ray_xcaster23(FAR struct trv_raycast_s *result)
   trv_coord_t absz;             /* Absolute Z position at relx given pitch */
   trv_coord_t lastrelx1 = -1;   /* Last relative X position processed */
   trv_coord_t lastrelx2 = -1;   /* Last relative X position processed */
+#endif
   int32_t dydx;                 /* Rate of change of Y wrt X (double) */
   int32_t dzdx;                 /* Rate of change of Z wrt X (double) */
 
@@ -350,7 +801,7 @@ static void trv_ray_xcaster23(FAR struct trv_raycast_s *result)
    * possible!
    */
 
-  if (g_camera.yaw == ANGLE_90)
+  if (ctx->camera.yaw == ANGLE_90)
     {
       return;
     }
@@ -360,15 +811,21 @@ static void trv_ray_xcaster23(FAR struct trv_raycast_s *result)
    * to the X-axis.  The tangent is stored at double the "normal" scaling.
    */
 
-  dydx = -TAN(g_camera.yaw);
+  dydx = -TAN(ctx->camera.yaw);
 
   /* Determine the rate of change of the Z with respect to X. dydx is
    * "double" precision; the secant is "double" precision.  dzdx will be
    * retained as "double" precision.
    */
 
-  dzdx = qTOd(g_adj_tanpitch * ABS(g_sec_table[g_camera.yaw]));
+  dzdx = qTOd(ctx->adj_tanpitch * ABS(g_sec_table[ctx->camera.yaw]));
 
+#ifdef CONFIG_GRAPHICS_TRAVELER_PLANEINDEX
+  /* Visit only the rectangles in the grid cells traversed by the ray */
+
+  trv_ray_wallcast(ctx, result, &g_xindex, ctx->camera.x, ctx->camera.y,
+                   dydx, dzdx, MK_HIT_TYPE(BACK_HIT, X_HIT), TRV_INFINITY);
+#else
   /* Look at every rectangle lying in the X plane */
   /* This logic should be improved at some point so that non-visible planes
    * are "pruned" from the list prior to ray casting!
@@ -377,16 +834,17 @@ static void trv_ray_xcaster23(FAR struct trv_raycast_s *result)
   for (list = g_ray_xplane.tail; list; list = list->blink)
     {
       rect = &list->d;
+      TRV_COUNT(ctx, planes, 1);
 
       /* Search for a rectangle which lies "before" the current camera
        * position
        */
 
-      if (rect->plane < g_camera.x)
+      if (rect->plane < ctx->camera.x)
         {
           /* get the X distance to the plane */
 
-          relx = g_camera.x - rect->plane;
+          relx = ctx->camera.x - rect->plane;
 #if 0
           /* g_ray_xplane is an ordered list, if we have already hit something
            * closer, then we can abort the casting now.
@@ -412,7 +870,7 @@ static void trv_ray_xcaster23(FAR struct trv_raycast_s *result)
                */
 
               deltay    = dydx * ((int32_t) relx);
-              absy      = tTOs(deltay) + g_camera.y; /* back to "single" */
+              absy      = tTOs(deltay) + ctx->camera.y; /* back to "single" */
               lastrelx1 = relx;
             }
 
@@ -435,7 +893,7 @@ static void trv_ray_xcaster23(FAR struct trv_raycast_s *result)
                    */
 
                   deltaz    = dzdx * ((int32_t) relx);
-                  absz      = tTOs(deltaz) + g_camera.z; /* Back to single */
+                  absz      = tTOs(deltaz) + ctx->camera.z; /* Back to single */
                   lastrelx2 = relx;
                 }
 
@@ -458,8 +916,8 @@ static void trv_ray_xcaster23(FAR struct trv_raycast_s *result)
                       result->ypos = absz;
 
                       result->xdist = relx;
-                      result->ydist = ABS(absy - g_camera.y);
-                      result->zdist = ABS(absz - g_camera.z);
+                      result->ydist = ABS(absy - ctx->camera.y);
+                      result->zdist = ABS(absz - ctx->camera.z);
 
                       /* Terminate X casting */
 
@@ -481,8 +939,8 @@ static void trv_ray_xcaster23(FAR struct trv_raycast_s *result)
                           result->ypos = absz;
 
                           result->xdist = relx;
-                          result->ydist = ABS(absy - g_camera.y);
-                          result->zdist = ABS(absz - g_camera.z);
+                          result->ydist = ABS(absy - ctx->camera.y);
+                          result->zdist = ABS(absz - ctx->camera.z);
 
                           /* Terminate X casting */
 
@@ -505,8 +963,8 @@ static void trv_ray_xcaster23(FAR struct trv_raycast_s *result)
                           result->ypos = absz - g_opendoor.zdist;
 
                           result->xdist = relx;
-                          result->ydist = ABS(absy - g_camera.y);
-                          result->zdist = ABS(absz - g_camera.z);
+                          result->ydist = ABS(absy - ctx->camera.y);
+                          result->zdist = ABS(absz - ctx->camera.z);
 
                           /* Terminate X casting */
 
@@ -532,8 +990,8 @@ static void trv_ray_xcaster23(FAR struct trv_raycast_s *result)
                       result->ypos = absz;
 
                       result->xdist = relx;
-                      result->ydist = ABS(absy - g_camera.y);
-                      result->zdist = ABS(absz - g_camera.z);
+                      result->ydist = ABS(absy - ctx->camera.y);
+                      result->zdist = ABS(absz - ctx->camera.z);
 
                       /* Terminate X casting */
 
@@ -543,6 +1001,7 @@ static void trv_ray_xcaster23(FAR struct trv_raycast_s *result)
             }
         }
     }
+#endif
 }
 
 /****************************************************************************
@@ -561,8 +1020,10 @@ static void trv_ray_xcaster23(FAR struct trv_raycast_s *result)
  *
  ***************************************************************************/
 
-static void trv_ray_ycaster12(FAR struct trv_raycast_s *result)
+static void trv_ray_ycaster12(FAR struct trv_raycntx_s *ctx,
+                              FAR struct trv_raycast_s *result)
 {
+#ifndef CONFIG_GRAPHICS_TRAVELER_PLANEINDEX
   struct trv_rect_list_s *list; /* Points to the current P plane rectangle */
   struct trv_rect_data_s *rect; /* Points to the rectangle data */
   trv_coord_t rely;             /* Relative position of the Y plane */
@@ -570,6 +1031,7 @@ static void trv_ray_ycaster12(FAR struct trv_raycast_s *result)
   trv_coord_t absz;             /* Absolute Z position at rely given pitch */
   trv_coord_t lastrely1 = -1;   /* Last relative Y position processed */
   trv_coord_t lastrely2 = -1;   /* Last relative Y position processed */
+#endif
   int32_t dxdy;                 /* Rate of change of X wrt Y (double) */
   int32_t dzdy;                 /* Rate of change of Z wrt Y (double) */
 
@@ -577,7 +1039,7 @@ static void trv_ray_ycaster12(FAR struct trv_raycast_s *result)
    * possible!
    */
 
-  if (g_camera.yaw == ANGLE_0)
+  if (ctx->camera.yaw == ANGLE_0)
     {
       return;
     }
@@ -587,15 +1049,21 @@ static void trv_ray_ycaster12(FAR struct trv_raycast_s *result)
    * the Y-axis.  The cotangent is stored at double the the "normal" scaling.
    */
 
-  dxdy = g_cot_table(g_camera.yaw);
+  dxdy = g_cot_table(ctx->camera.yaw);
 
   /* Determine the rate of change of the Z with respect to Y.  The tangent
    * is "double" precision; the cosecant is "double" precision.  dzdy will
    * be retained as "double" precision.
    */
 
-  dzdy = qTOd(g_adj_tanpitch * ABS(g_csc_table[g_camera.yaw]));
+  dzdy = qTOd(ctx->adj_tanpitch * ABS(g_csc_table[ctx->camera.yaw]));
 
+#ifdef CONFIG_GRAPHICS_TRAVELER_PLANEINDEX
+  /* Visit only the rectangles in the grid cells traversed by the ray */
+
+  trv_ray_wallcast(ctx, result, &g_yindex, ctx->camera.y, ctx->camera.x,
+                   dxdy, dzdy, MK_HIT_TYPE(FRONT_HIT, Y_HIT), result->ydist);
+#else
   /* Look at every rectangle lying in a Y plane */
   /* This logic should be improved at some point so that non-visible planes
    * are "pruned" from the list prior to ray casting!
@@ -604,16 +1072,17 @@ static void trv_ray_ycaster12(FAR struct trv_raycast_s *result)
   for (list = g_ray_yplane.head; list; list = list->flink)
     {
       rect = &list->d;
+      TRV_COUNT(ctx, planes, 1);
 
       /* Search for a rectangle which lies "beyond" the current camera
        * position
        */
 
-      if (rect->plane > g_camera.y)
+      if (rect->plane > ctx->camera.y)
         {
           /* get the Y distance to the plane */
 
-          rely = rect->plane - g_camera.y;
+          rely = rect->plane - ctx->camera.y;
 
           /* g_ray_yplane is an ordered list, if we have already hit something
            * closer, then we can abort the casting now.
@@ -638,7 +1107,7 @@ static void trv_ray_ycaster12(FAR struct trv_raycast_s *result)
                */
 
               deltax    = dxdy * ((int32_t) rely);
-              absx      = tTOs(deltax) + g_camera.x; /* back to "single" */
+              absx      = tTOs(deltax) + ctx->camera.x; /* back to "single" */
               lastrely1 = rely;
             }
 
@@ -661,7 +1130,7 @@ static void trv_ray_ycaster12(FAR struct trv_raycast_s *result)
                    */
 
                   deltaz    = dzdy * ((int32_t) rely);
-                  absz      = tTOs(deltaz) + g_camera.z; /* Back to single */
+                  absz      = tTOs(deltaz) + ctx->camera.z; /* Back to single */
                   lastrely2 = rely;
                 }
 
@@ -683,9 +1152,9 @@ static void trv_ray_ycaster12(FAR struct trv_raycast_s *result)
                       result->xpos = absx;
                       result->ypos = absz;
 
-                      result->xdist = ABS(absx - g_camera.x);
+                      result->xdist = ABS(absx - ctx->camera.x);
                       result->ydist = rely;
-                      result->zdist = ABS(absz - g_camera.z);
+                      result->zdist = ABS(absz - ctx->camera.z);
 
                       /* Terminate Y casting */
 
@@ -706,9 +1175,9 @@ static void trv_ray_ycaster12(FAR struct trv_raycast_s *result)
                           result->xpos = absx;
                           result->ypos = absz;
 
-                          result->xdist = ABS(absx - g_camera.x);
+                          result->xdist = ABS(absx - ctx->camera.x);
                           result->ydist = rely;
-                          result->zdist = ABS(absz - g_camera.z);
+                          result->zdist = ABS(absz - ctx->camera.z);
 
                           /* Terminate Y casting */
 
@@ -730,9 +1199,9 @@ static void trv_ray_ycaster12(FAR struct trv_raycast_s *result)
                           result->xpos = absx;
                           result->ypos = absz - g_opendoor.zdist;
 
-                          result->xdist = ABS(absx - g_camera.x);
+                          result->xdist = ABS(absx - ctx->camera.x);
                           result->ydist = rely;
-                          result->zdist = ABS(absz - g_camera.z);
+                          result->zdist = ABS(absz - ctx->camera.z);
 
                           /* Terminate Y casting */
 
@@ -757,9 +1226,9 @@ static void trv_ray_ycaster12(FAR struct trv_raycast_s *result)
                       result->xpos = absx;
                       result->ypos = absz;
 
-                      result->xdist = ABS(absx - g_camera.x);
+                      result->xdist = ABS(absx - ctx->camera.x);
                       result->ydist = rely;
-                      result->zdist = ABS(absz - g_camera.z);
+                      result->zdist = ABS(absz - ctx->camera.z);
 
                       /* Terminate Y casting */
 
@@ -769,6 +1238,7 @@ static void trv_ray_ycaster12(FAR struct trv_raycast_s *result)
             }
         }
     }
+#endif
 }
 
 /****************************************************************************
@@ -787,8 +1257,10 @@ static void trv_ray_ycaster12(FAR struct trv_raycast_s *result)
  *
  ***************************************************************************/
 
-static void trv_ray_ycaster34(FAR struct trv_raycast_s *result)
+static void trv_ray_ycaster34(FAR struct trv_raycntx_s *ctx,
+                              FAR struct trv_raycast_s *result)
 {
+#ifndef CONFIG_GRAPHICS_TRAVELER_PLANEINDEX
   struct trv_rect_list_s *list; /* Points to the current P plane rectangle */
   struct trv_rect_data_s *rect; /* Points to the rectangle data */
   trv_coord_t rely;             /* Relative position of the Y plane */
@@ -796,6 +1268,7 @@ static void trv_ray_ycaster34(FAR struct trv_raycast_s *result)
   trv_coord_t absz;             /* Absolute Z position at rely given pitch */
   trv_coord_t lastrely1 = -1;   /* Last relative Y position processed */
   trv_coord_t lastrely2 = -1;   /* Last relative Y position processed */
+#endif
   int32_t dxdy;                 /* Rate of change of X wrt Y (double) */
   int32_t dzdy;                 /* Rate of change of Z wrt Y (double) */
 
@@ -803,7 +1276,7 @@ static void trv_ray_ycaster34(FAR struct trv_raycast_s *result)
    * are possible!
    */
 
-  if (g_camera.yaw == ANGLE_180)
+  if (ctx->camera.yaw == ANGLE_180)
     {
       return;
     }
@@ -814,15 +1287,21 @@ static void trv_ray_ycaster34(FAR struct trv_raycast_s *result)
    * "normal" scaling.
    */
 
-  dxdy = -g_cot_table(g_camera.yaw - ANGLE_180);
+  dxdy = -g_cot_table(ctx->camera.yaw - ANGLE_180);
 
   /* Determine the rate of change of the Z with respect to Y.  The tangent
    * is "double" precision; the cosecant is "double" precision.  dzdy will
    * be retained as "double" precision.
    */
 
-  dzdy = qTOd(g_adj_tanpitch * ABS(g_csc_table[g_camera.yaw]));
+  dzdy = qTOd(ctx->adj_tanpitch * ABS(g_csc_table[ctx->camera.yaw]));
+
+#ifdef CONFIG_GRAPHICS_TRAVELER_PLANEINDEX
+  /* Visit only the rectangles in the grid cells traversed by the ray */
 
+  trv_ray_wallcast(ctx, result, &g_yindex, ctx->camera.y, ctx->camera.x,
+                   dxdy, dzdy, MK_HIT_TYPE(BACK_HIT, Y_HIT), result->ydist);
+#else
   /* Look at every rectangle lying in a Y plane */
   /* This logic should be improved at some point so that non-visible planes
    * are "pruned" from the list prior to ray casting!
@@ -831,16 +1310,17 @@ static void trv_ray_ycaster34(FAR struct trv_raycast_s *result)
   for (list = g_ray_yplane.tail; list; list = list->blink)
     {
       rect = &list->d;
+      TRV_COUNT(ctx, planes, 1);
 
       /* Search for a rectangle which lies "before" the current camera
        * position
        */
 
-      if (rect->plane < g_camera.y)
+      if (rect->plane < ctx->camera.y)
         {
           /* get the Y distance to the plane */
 
-          rely = g_camera.y - rect->plane;
+          rely = ctx->camera.y - rect->plane;
 
           /* g_ray_yplane is an ordered list, if we have already hit something
            * closer, then we can abort the casting now.
@@ -865,7 +1345,7 @@ static void trv_ray_ycaster34(FAR struct trv_raycast_s *result)
                */
 
               deltax    = dxdy * ((int32_t) rely);
-              absx      = tTOs(deltax) + g_camera.x; /* back to "single" */
+              absx      = tTOs(deltax) + ctx->camera.x; /* back to "single" */
               lastrely1 = rely;
             }
 
@@ -889,7 +1369,7 @@ static void trv_ray_ycaster34(FAR struct trv_raycast_s *result)
                    */
 
                   deltaz    = dzdy * ((int32_t) rely);
-                  absz      = tTOs(deltaz) + g_camera.z; /* Back to single */
+                  absz      = tTOs(deltaz) + ctx->camera.z; /* Back to single */
                   lastrely2 = rely;
                 }
 
@@ -912,9 +1392,9 @@ static void trv_ray_ycaster34(FAR struct trv_raycast_s *result)
                       result->xpos = absx;
                       result->ypos = absz;
 
-                      result->xdist = ABS(absx - g_camera.x);
+                      result->xdist = ABS(absx - ctx->camera.x);
                       result->ydist = rely;
-                      result->zdist = ABS(absz - g_camera.z);
+                      result->zdist = ABS(absz - ctx->camera.z);
 
                       /* Terminate Y casting */
 
@@ -935,9 +1415,9 @@ static void trv_ray_ycaster34(FAR struct trv_raycast_s *result)
                           result->xpos = absx;
                           result->ypos = absz;
 
-                          result->xdist = ABS(absx - g_camera.x);
+                          result->xdist = ABS(absx - ctx->camera.x);
                           result->ydist = rely;
-                          result->zdist = ABS(absz - g_camera.z);
+                          result->zdist = ABS(absz - ctx->camera.z);
 
                           /* Terminate Y casting */
 
@@ -959,9 +1439,9 @@ static void trv_ray_ycaster34(FAR struct trv_raycast_s *result)
                           result->xpos = absx;
                           result->ypos = absz - g_opendoor.zdist;
 
-                          result->xdist = ABS(absx - g_camera.x);
+                          result->xdist = ABS(absx - ctx->camera.x);
                           result->ydist = rely;
-                          result->zdist = ABS(absz - g_camera.z);
+                          result->zdist = ABS(absz - ctx->camera.z);
 
                           /* Terminate Y casting */
 
@@ -986,9 +1466,9 @@ static void trv_ray_ycaster34(FAR struct trv_raycast_s *result)
                       result->xpos = absx;
                       result->ypos = absz;
 
-                      result->xdist = ABS(absx - g_camera.x);
+                      result->xdist = ABS(absx - ctx->camera.x);
                       result->ydist = rely;
-                      result->zdist = ABS(absz - g_camera.z);
+                      result->zdist = ABS(absz - ctx->camera.z);
 
                       /* Terminate Y casting */
 
@@ -998,6 +1478,7 @@ static void trv_ray_ycaster34(FAR struct trv_raycast_s *result)
             }
         }
     }
+#endif
 }
 
 /****************************************************************************
@@ -1016,8 +1497,10 @@ static void trv_ray_ycaster34(FAR struct trv_raycast_s *result)
  *   ran!
  ***************************************************************************/
 
-static void trv_ray_zcasteru(FAR struct trv_raycast_s *result)
+static void trv_ray_zcasteru(FAR struct trv_raycntx_s *ctx,
+                             FAR struct trv_raycast_s *result)
 {
+#ifndef CONFIG_GRAPHICS_TRAVELER_PLANEINDEX
   struct trv_rect_list_s *list; /* Points to the current Z plane rectangle */
   struct trv_rect_data_s *rect; /* Points to the rectangle data */
   trv_coord_t relz;             /* Relative position of the Z plane */
@@ -1025,6 +1508,7 @@ static void trv_ray_zcasteru(FAR struct trv_raycast_s *result)
   trv_coord_t absy;             /* Absolute Y position at relz given yaw */
   trv_coord_t lastrelz1 = -1;   /* Last relative Z position processed */
   trv_coord_t lastrelz2 = -1;   /* Last relative Z position processed */
+#endif
   int32_t dxdz;                 /* Rate of change of X wrt Z (double) */
   int32_t dydz;                 /* Rate of change of Y wrt Z (double) */
 
@@ -1032,7 +1516,7 @@ static void trv_ray_zcasteru(FAR struct trv_raycast_s *result)
    * possible!
    */
 
-  if (g_camera.pitch == ANGLE_0)
+  if (ctx->camera.pitch == ANGLE_0)
     {
       return;
     }
@@ -1044,15 +1528,20 @@ static void trv_ray_zcasteru(FAR struct trv_raycast_s *result)
    * precision.
    */
 
-  dxdz = qTOd(g_adj_cotpitch * ((int32_t) g_cos_table[g_camera.yaw]));
+  dxdz = qTOd(ctx->adj_cotpitch * ((int32_t) g_cos_table[ctx->camera.yaw]));
 
   /* Calculate the rate of change of Y with respect to the Z-axis. The
    * cotangent is stored at double the "normal" scaling and the sine is also
    * at double scaling.  dxdz will be also be stored at double precision.
    */
 
-  dydz = qTOd(g_adj_cotpitch * ((int32_t) g_sin_table[g_camera.yaw]));
+  dydz = qTOd(ctx->adj_cotpitch * ((int32_t) g_sin_table[ctx->camera.yaw]));
+
+#ifdef CONFIG_GRAPHICS_TRAVELER_PLANEINDEX
+  /* Visit only the rectangles in the grid cells traversed by the ray */
 
+  trv_ray_floorcast(ctx, result, dxdz, dydz, MK_HIT_TYPE(BACK_HIT, Z_HIT));
+#else
   /* Look at every rectangle lying in the Z plane */
   /* This logic should be improved at some point so that non-visible planes
    * are "pruned" from the list prior to ray casting!
@@ -1061,16 +1550,17 @@ static void trv_ray_zcasteru(FAR struct trv_raycast_s *result)
   for (list = g_ray_zplane.head; list; list = list->flink)
     {
       rect = &list->d;
+      TRV_COUNT(ctx, planes, 1);
 
       /* Search for a rectangle which lies "beyond" the current camera
        * position
        */
 
-      if (rect->plane > g_camera.z)
+      if (rect->plane > ctx->camera.z)
         {
           /* get the Z distance to the plane */
 
-          relz = rect->plane - g_camera.z;
+          relz = rect->plane - ctx->camera.z;
 
           /* g_ray_zplane is an ordered list, if we have already hit something
            * closer, then we can abort the casting now.
@@ -1095,7 +1585,7 @@ static void trv_ray_zcasteru(FAR struct trv_raycast_s *result)
                */
 
               deltax    = dxdz * ((int32_t) relz);
-              absx      = tTOs(deltax) + g_camera.x; /* back to "single" */
+              absx      = tTOs(deltax) + ctx->camera.x; /* back to "single" */
               lastrelz1 = relz;
             }
 
@@ -1118,7 +1608,7 @@ static void trv_ray_zcasteru(FAR struct trv_raycast_s *result)
                    */
 
                   deltay    = dydz * ((int32_t) relz);
-                  absy      = tTOs(deltay) + g_camera.y; /* back to "single" */
+                  absy      = tTOs(deltay) + ctx->camera.y;
                   lastrelz2 = relz;
                 }
 
@@ -1135,8 +1625,8 @@ static void trv_ray_zcasteru(FAR struct trv_raycast_s *result)
                   result->xpos = absx;
                   result->ypos = absy;
 
-                  result->xdist = ABS(absx - g_camera.x);
-                  result->ydist = ABS(absy - g_camera.y);
+                  result->xdist = ABS(absx - ctx->camera.x);
+                  result->ydist = ABS(absy - ctx->camera.y);
                   result->zdist = relz;
 
                   /* Terminate Z casting */
@@ -1146,6 +1636,7 @@ static void trv_ray_zcasteru(FAR struct trv_raycast_s *result)
             }
         }
     }
+#endif
 }
 
 /****************************************************************************
@@ -1165,8 +1656,10 @@ static void trv_ray_zcasteru(FAR struct trv_raycast_s *result)
  *
  ***************************************************************************/
 
-static void trv_ray_zcasterl(FAR struct trv_raycast_s *result)
+static void trv_ray_zcasterl(FAR struct trv_raycntx_s *ctx,
+                             FAR struct trv_raycast_s *result)
 {
+#ifndef CONFIG_GRAPHICS_TRAVELER_PLANEINDEX
   struct trv_rect_list_s *list; /* Points to the current Z plane rectangle */
   struct trv_rect_data_s *rect; /* Points to the rectangle data */
   trv_coord_t relz;             /* Relative position of the Z plane */
@@ -1174,6 +1667,7 @@ static void trv_ray_zcasterl(FAR struct trv_raycast_s *result)
   trv_coord_t absy;             /* Absolute Y position at relz given yaw */
   trv_coord_t lastrelz1 = -1;   /* Last relative Z position processed */
   trv_coord_t lastrelz2 = -1;   /* Last relative Z position processed */
+#endif
   int32_t dxdz;                 /* Rate of change of X wrt Z (double) */
   int32_t dydz;                 /* Rate of change of Y wrt Z (double) */
 
@@ -1181,7 +1675,7 @@ static void trv_ray_zcasterl(FAR struct trv_raycast_s *result)
    * possible!
    */
 
-  if (g_camera.pitch == ANGLE_0)
+  if (ctx->camera.pitch == ANGLE_0)
     {
       return;
     }
@@ -1193,7 +1687,7 @@ static void trv_ray_zcasterl(FAR struct trv_raycast_s *result)
    * precision.
    */
 
-  dxdz = qTOd(g_adj_cotpitch * ((int32_t) g_cos_table[g_camera.yaw]));
+  dxdz = qTOd(ctx->adj_cotpitch * ((int32_t) g_cos_table[ctx->camera.yaw]));
 
   /* Calculate the rate of change of Y with respect to the Z-axis. The
    * cotangent is stored at double the "normal" scaling and the sine is
@@ -1201,8 +1695,13 @@ static void trv_ray_zcasterl(FAR struct trv_raycast_s *result)
    * precision.
    */
 
-  dydz = qTOd(g_adj_cotpitch * ((int32_t) g_sin_table[g_camera.yaw]));
+  dydz = qTOd(ctx->adj_cotpitch * ((int32_t) g_sin_table[ctx->camera.yaw]));
+
+#ifdef CONFIG_GRAPHICS_TRAVELER_PLANEINDEX
+  /* Visit only the rectangles in the grid cells traversed by the ray */
 
+  trv_ray_floorcast(ctx, result, dxdz, dydz, MK_HIT_TYPE(FRONT_HIT, Z_HIT));
+#else
   /* Look at every rectangle lying in the Z plane */
   /* This logic should be improved at some point so that non-visible planes
    * are "pruned" from the list prior to ray casting!
@@ -1211,16 +1710,17 @@ static void trv_ray_zcasterl(FAR struct trv_raycast_s *result)
   for (list = g_ray_zplane.tail; list; list = list->blink)
     {
       rect = &list->d;
+      TRV_COUNT(ctx, planes, 1);
 
       /* Search for a rectangle which lies "before" the current camera
        * position
        */
 
-      if (rect->plane < g_camera.z)
+      if (rect->plane < ctx->camera.z)
         {
           /* get the Z distance to the plane */
 
-          relz = g_camera.z - rect->plane;
+          relz = ctx->camera.z - rect->plane;
 
           /* g_ray_zplane is an ordered list, if we have already hit something
            * closer, then we can abort the casting now.
@@ -1245,7 +1745,7 @@ static void trv_ray_zcasterl(FAR struct trv_raycast_s *result)
                */
 
               deltax    = dxdz * ((int32_t) relz);
-              absx      = tTOs(deltax) + g_camera.x; /* back to "single" */
+              absx      = tTOs(deltax) + ctx->camera.x; /* back to "single" */
               lastrelz1 = relz;
             }
 
@@ -1268,7 +1768,7 @@ static void trv_ray_zcasterl(FAR struct trv_raycast_s *result)
                    */
 
                   deltay    = dydz * ((int32_t) relz);
-                  absy      = tTOs(deltay) + g_camera.y; /* back to "single" */
+                  absy      = tTOs(deltay) + ctx->camera.y;
                   lastrelz2 = relz;
                 }
 
@@ -1285,8 +1785,8 @@ static void trv_ray_zcasterl(FAR struct trv_raycast_s *result)
                   result->xpos = absx;
                   result->ypos = absy;
 
-                  result->xdist = ABS(absx - g_camera.x);
-                  result->ydist = ABS(absy - g_camera.y);
+                  result->xdist = ABS(absx - ctx->camera.x);
+                  result->ydist = ABS(absy - ctx->camera.y);
                   result->zdist = relz;
 
                   /* Terminate Z casting */
@@ -1296,6 +1796,7 @@ static void trv_ray_zcasterl(FAR struct trv_raycast_s *result)
             }
         }
     }
+#endif
 }
 
 /****************************************************************************
@@ -1312,13 +1813,15 @@ static void trv_ray_zcasterl(FAR struct trv_raycast_s *result)
  *
  ***************************************************************************/
 
-void trv_raycast(int16_t pitch, int16_t yaw, int16_t screenyaw,
-                FAR struct trv_raycast_s *result)
+void trv_raycast(FAR struct trv_raycntx_s *ctx, int16_t pitch, int16_t yaw,
+                 int16_t screenyaw, FAR struct trv_raycast_s *result)
 {
+  TRV_COUNT(ctx, rays, 1);
+
   /* Set the camera pitch and yaw angles for this cast */
 
-  g_camera.pitch = pitch;
-  g_camera.yaw = yaw;
+  ctx->camera.pitch = pitch;
+  ctx->camera.yaw = yaw;
 
   /* Initialize the result structure, assuming that there will be no hit */
 
@@ -1339,37 +1842,37 @@ void trv_raycast(int16_t pitch, int16_t yaw, int16_t screenyaw,
 
   screenyaw = ABS(screenyaw);
 #if ENABLE_VIEW_CORRECTION
-  g_adj_tanpitch = qTOd(TAN(pitch) * ((int32_t) g_cos_table[screenyaw]));
+  ctx->adj_tanpitch = qTOd(TAN(pitch) * ((int32_t) g_cos_table[screenyaw]));
 #else
-  g_adj_tanpitch = TAN(pitch);
+  ctx->adj_tanpitch = TAN(pitch);
 #endif
 
   /* Perform X & Y raycasting based on the quadrant of the yaw angle */
 
-  if (g_camera.yaw < ANGLE_90)
+  if (ctx->camera.yaw < ANGLE_90)
     {
-      trv_ray_xcaster14(result);
-      trv_ray_ycaster12(result);
+      trv_ray_xcaster14(ctx, result);
+      trv_ray_ycaster12(ctx, result);
     }
-  else if (g_camera.yaw < ANGLE_180)
+  else if (ctx->camera.yaw < ANGLE_180)
     {
-      trv_ray_xcaster23(result);
-      trv_ray_ycaster12(result);
+      trv_ray_xcaster23(ctx, result);
+      trv_ray_ycaster12(ctx, result);
     }
-  else if (g_camera.yaw < ANGLE_270)
+  else if (ctx->camera.yaw < ANGLE_270)
     {
-      trv_ray_xcaster23(result);
-      trv_ray_ycaster34(result);
+      trv_ray_xcaster23(ctx, result);
+      trv_ray_ycaster34(ctx, result);
     }
   else
     {
-      trv_ray_xcaster14(result);
-      trv_ray_ycaster34(result);
+      trv_ray_xcaster14(ctx, result);
+      trv_ray_ycaster34(ctx, result);
     }
 
   /* Perform Z ray casting based upon if we are looking up or down */
 
-  if (g_camera.pitch < ANGLE_90)
+  if (ctx->camera.pitch < ANGLE_90)
     {
       /* Get the adjusted cotangent of the pitch angle which is used to correct
        * for the "fish eye" distortion.  This correction consists of
@@ -1379,11 +1882,11 @@ void trv_raycast(int16_t pitch, int16_t yaw, int16_t screenyaw,
        */
 
 #if ENABLE_VIEW_CORRECTION
-      g_adj_cotpitch = qTOd(g_cot_table(pitch) * g_sec_table[screenyaw]);
+      ctx->adj_cotpitch = qTOd(g_cot_table(pitch) * g_sec_table[screenyaw]);
 #else
-      g_adj_cotpitch = g_cot_table(pitch);
+      ctx->adj_cotpitch = g_cot_table(pitch);
 #endif
-      trv_ray_zcasteru(result);
+      trv_ray_zcasteru(ctx, result);
     }
   else
     {
@@ -1395,11 +1898,11 @@ void trv_raycast(int16_t pitch, int16_t yaw, int16_t screenyaw,
        */
 
 #if ENABLE_VIEW_CORRECTION
-      g_adj_cotpitch =
+      ctx->adj_cotpitch =
         qTOd(g_cot_table(ANGLE_360 - pitch) * g_sec_table[screenyaw]);
 #else
-      g_adj_cotpitch = g_cot_table(ANGLE_360 - pitch);
+      ctx->adj_cotpitch = g_cot_table(ANGLE_360 - pitch);
 #endif
-      trv_ray_zcasterl(result);
+      trv_ray_zcasterl(ctx, result);
     }
 }
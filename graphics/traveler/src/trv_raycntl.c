@@ -52,6 +52,14 @@
 #include "trv_raycast.h"
 #include "trv_raycntl.h"
 
+#include <string.h>
+
+#ifndef CONFIG_DISABLE_PTHREAD
+#  include <pthread.h>
+#  include <semaphore.h>
+#  include <errno.h>
+#endif
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -81,28 +89,53 @@
 /* Macro to determine if two hits "hit" the same object */
 
 #define SAME_CELL(i1,j1,i2,j2) \
-  (g_ray_hit[i1][j1].rect == g_ray_hit[i2][j2].rect)
+  (ctx->hit[i1][j1].rect == ctx->hit[i2][j2].rect)
 
-/****************************************************************************
- * Public Data
- ****************************************************************************/
+/* The number of horizontal swathes in one frame */
+
+#define NUMBER_SWATHES ((IMAGE_HEIGHT - VGULP_SIZE) / VGULP_SIZE + 1)
 
-/* The following array describes the hits from X/Y/Z-ray casting for the
- * current HGULP_SIZE x VGULP_SIZE cell
+/* The number of ray casting threads (including the caller of
+ * trv_raycaster())
  */
 
-struct trv_raycast_s g_ray_hit[VGULP_SIZE][HGULP_SIZE + 1];
+#ifndef CONFIG_GRAPHICS_TRAVELER_NWORKERS
+#  define CONFIG_GRAPHICS_TRAVELER_NWORKERS 1
+#endif
 
-/* This array points to the screen buffer row corresponding to the
- * pitch angle
- */
+#ifdef CONFIG_DISABLE_PTHREAD
+#  define TRV_NWORKERS 1
+#else
+#  define TRV_NWORKERS CONFIG_GRAPHICS_TRAVELER_NWORKERS
+#endif
 
-FAR uint8_t *g_buffer_row[VGULP_SIZE];
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+#if TRV_NWORKERS > 1
+/* This structure describes one frame of work shared by all of the ray
+ * casting threads.  It is written by trv_raycaster() before the workers
+ * are started and is read-only while they run (except for 'nextswathe').
+ */
 
-/* The is the "column" offset in g_buffer_row for the current cell being 
- * operated on.  This value is updated in a loop by trv_raycaster. */
+struct trv_frame_s
+{
+  pthread_mutex_t lock;      /* Protects 'nextswathe' */
+  sem_t start;               /* Posted once per worker to start a frame */
+  sem_t done;                /* Posted by each worker when it is finished */
+  FAR uint8_t *buffer;       /* First row of the rending buffer */
+  int16_t pitch;             /* Pitch angle of the first swathe */
+  int16_t nextswathe;        /* The next swathe to be rendered */
+  uint8_t nworkers;          /* Number of worker threads created */
+  bool started;              /* True: Worker threads have been created */
+  bool terminate;            /* True: Worker threads should exit */
+};
+#endif
 
-int16_t g_cell_column;
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
 
 /* This structure holds the parameters used in the current ray cast */
 
@@ -113,16 +146,27 @@ struct trv_camera_s g_camera;
  ****************************************************************************/
 
 /* These are all of the yaw angles which will be used by the ray caster
- * on a given cycle
+ * on a given cycle.  These are shared by all workers and do not change
+ * while a frame is being rendered.
  */
 
 static int16_t g_yaw[IMAGE_WIDTH + 1];
 
-/* These are all of the pitch angles which will be used by the ray caster
- * on each horizontal pass of a given cycle
+/* This is the ray casting context of each worker.  Context zero is used
+ * by the thread that calls trv_raycaster().
  */
 
-static int16_t g_pitch[VGULP_SIZE];
+static struct trv_raycntx_s g_raycntx[TRV_NWORKERS];
+
+#if TRV_NWORKERS > 1
+/* The frame of work that is shared by all workers */
+
+static struct trv_frame_s g_frame;
+
+/* The worker threads (not including the caller of trv_raycaster) */
+
+static pthread_t g_worker[TRV_NWORKERS - 1];
+#endif
 
 /****************************************************************************
  * Private Functions
@@ -138,7 +182,8 @@ static int16_t g_pitch[VGULP_SIZE];
  *
  ***************************************************************************/
 
-static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
+static void trv_resolve_cell(FAR struct trv_raycntx_s *ctx,
+                             uint8_t toprow, uint8_t leftcol,
                              uint8_t height, uint8_t width)
 {
   uint8_t midrow;
@@ -197,10 +242,10 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
 
                           /* Get the top middle hit */
 
-                          trv_raycast(g_pitch[toprow],
-                                      g_yaw[g_cell_column + midcol],
-                                      RELYAW(g_cell_column + midcol),
-                                      &g_ray_hit[toprow][midcol]);
+                          trv_raycast(ctx, ctx->pitch[toprow],
+                                      g_yaw[ctx->cell_column + midcol],
+                                      RELYAW(ctx->cell_column + midcol),
+                                      &ctx->hit[toprow][midcol]);
                         }
 
                       topheight = ((height + 1) >> 1);
@@ -218,33 +263,35 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
 
                           /* Get the middle left hit */
 
-                          trv_raycast(g_pitch[midrow],
-                                      g_yaw[g_cell_column + leftcol],
-                                      RELYAW(g_cell_column + leftcol),
-                                      &g_ray_hit[midrow][leftcol]);
+                          trv_raycast(ctx, ctx->pitch[midrow],
+                                      g_yaw[ctx->cell_column + leftcol],
+                                      RELYAW(ctx->cell_column + leftcol),
+                                      &ctx->hit[midrow][leftcol]);
 
                           /* Get the center hit */
 
                           if (rightwidth > 1)
                             {
-                              trv_raycast(g_pitch[midrow],
-                                          g_yaw[g_cell_column + midcol],
-                                          RELYAW(g_cell_column + midcol),
-                                          &g_ray_hit[midrow][midcol]);
+                              trv_raycast(ctx, ctx->pitch[midrow],
+                                          g_yaw[ctx->cell_column + midcol],
+                                          RELYAW(ctx->cell_column + midcol),
+                                          &ctx->hit[midrow][midcol]);
                             }
 
                           /* Get the middle right hit */
 
                           rightcol = leftcol + width - 1;
-                          trv_raycast(g_pitch[midrow],
-                                      g_yaw[g_cell_column + rightcol],
-                                      RELYAW(g_cell_column + rightcol),
-                                      &g_ray_hit[midrow][rightcol]);
+                          trv_raycast(ctx, ctx->pitch[midrow],
+                                      g_yaw[ctx->cell_column + rightcol],
+                                      RELYAW(ctx->cell_column + rightcol),
+                                      &ctx->hit[midrow][rightcol]);
                         }
 
-                      trv_resolve_cell(toprow, leftcol, topheight, leftwidth);
-                      trv_resolve_cell(toprow, midcol, topheight, rightwidth);
-                      trv_resolve_cell(midrow, leftcol, botheight, width);
+                      trv_resolve_cell(ctx, toprow, leftcol,
+                                       topheight, leftwidth);
+                      trv_resolve_cell(ctx, toprow, midcol,
+                                       topheight, rightwidth);
+                      trv_resolve_cell(ctx, midrow, leftcol, botheight, width);
                     }
 
                   /* The left corners are not the same, but the right are.
@@ -268,18 +315,18 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
 
                           /* Get the top middle hit */
 
-                          trv_raycast(g_pitch[toprow],
-                                      g_yaw[g_cell_column + midcol],
-                                      RELYAW(g_cell_column + midcol),
-                                      &g_ray_hit[toprow][midcol]);
+                          trv_raycast(ctx, ctx->pitch[toprow],
+                                      g_yaw[ctx->cell_column + midcol],
+                                      RELYAW(ctx->cell_column + midcol),
+                                      &ctx->hit[toprow][midcol]);
 
                           /* Get the bottom middle hit */
 
                           botrow = toprow + height - 1;
-                          trv_raycast(g_pitch[botrow],
-                                      g_yaw[g_cell_column + midcol],
-                                      RELYAW(g_cell_column + midcol),
-                                      &g_ray_hit[botrow][midcol]);
+                          trv_raycast(ctx, ctx->pitch[botrow],
+                                      g_yaw[ctx->cell_column + midcol],
+                                      RELYAW(ctx->cell_column + midcol),
+                                      &ctx->hit[botrow][midcol]);
                         }
 
                       topheight = ((height + 1) >> 1);
@@ -297,25 +344,27 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
 
                           /* Get the middle left hit */
 
-                          trv_raycast(g_pitch[midrow],
-                                      g_yaw[g_cell_column + leftcol],
-                                      RELYAW(g_cell_column + leftcol),
-                                      &g_ray_hit[midrow][leftcol]);
+                          trv_raycast(ctx, ctx->pitch[midrow],
+                                      g_yaw[ctx->cell_column + leftcol],
+                                      RELYAW(ctx->cell_column + leftcol),
+                                      &ctx->hit[midrow][leftcol]);
 
                           /* Get the center hit */
 
                           if (rightwidth > 1)
                             {
-                              trv_raycast(g_pitch[midrow],
-                                          g_yaw[g_cell_column + midcol],
-                                          RELYAW(g_cell_column + midcol),
-                                          &g_ray_hit[midrow][midcol]);
+                              trv_raycast(ctx, ctx->pitch[midrow],
+                                          g_yaw[ctx->cell_column + midcol],
+                                          RELYAW(ctx->cell_column + midcol),
+                                          &ctx->hit[midrow][midcol]);
                             }
                         }
 
-                      trv_resolve_cell(toprow, leftcol, topheight, leftwidth);
-                      trv_resolve_cell(midrow, leftcol, botheight, leftwidth);
-                      trv_resolve_cell(toprow, midcol, height, rightwidth);
+                      trv_resolve_cell(ctx, toprow, leftcol,
+                                       topheight, leftwidth);
+                      trv_resolve_cell(ctx, midrow, leftcol,
+                                       botheight, leftwidth);
+                      trv_resolve_cell(ctx, toprow, midcol, height, rightwidth);
                     }
                 }
 
@@ -339,20 +388,22 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
 
                       /* Get the top middle hit */
 
-                      trv_raycast(g_pitch[toprow], g_yaw[g_cell_column + midcol],
-                                  RELYAW(g_cell_column + midcol),
-                                  &g_ray_hit[toprow][midcol]);
+                      trv_raycast(ctx, ctx->pitch[toprow],
+                                  g_yaw[ctx->cell_column + midcol],
+                                  RELYAW(ctx->cell_column + midcol),
+                                  &ctx->hit[toprow][midcol]);
 
                       /* Get the bottom middle hit */
 
                       botrow = toprow + height - 1;
-                      trv_raycast(g_pitch[botrow], g_yaw[g_cell_column + midcol],
-                                  RELYAW(g_cell_column + midcol),
-                                  &g_ray_hit[botrow][midcol]);
+                      trv_raycast(ctx, ctx->pitch[botrow],
+                                  g_yaw[ctx->cell_column + midcol],
+                                  RELYAW(ctx->cell_column + midcol),
+                                  &ctx->hit[botrow][midcol]);
                     }
 
-                  trv_resolve_cell(toprow, leftcol, height, leftwidth);
-                  trv_resolve_cell(toprow, midcol, height, rightwidth);
+                  trv_resolve_cell(ctx, toprow, leftcol, height, leftwidth);
+                  trv_resolve_cell(ctx, toprow, midcol, height, rightwidth);
                 }
             }
 
@@ -381,20 +432,22 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
 
                   /* Get the middle left hit */
 
-                  trv_raycast(g_pitch[midrow], g_yaw[g_cell_column + leftcol],
-                              RELYAW(g_cell_column + leftcol),
-                              &g_ray_hit[midrow][leftcol]);
+                  trv_raycast(ctx, ctx->pitch[midrow],
+                              g_yaw[ctx->cell_column + leftcol],
+                              RELYAW(ctx->cell_column + leftcol),
+                              &ctx->hit[midrow][leftcol]);
 
                   /* Get the middle right hit */
 
                   rightcol = leftcol + width - 1;
-                  trv_raycast(g_pitch[midrow], g_yaw[g_cell_column + rightcol],
-                              RELYAW(g_cell_column + rightcol),
-                              &g_ray_hit[midrow][rightcol]);
+                  trv_raycast(ctx, ctx->pitch[midrow],
+                              g_yaw[ctx->cell_column + rightcol],
+                              RELYAW(ctx->cell_column + rightcol),
+                              &ctx->hit[midrow][rightcol]);
                 }
 
-              trv_resolve_cell(toprow, leftcol, topheight, width);
-              trv_resolve_cell(midrow, leftcol, botheight, width);
+              trv_resolve_cell(ctx, toprow, leftcol, topheight, width);
+              trv_resolve_cell(ctx, midrow, leftcol, botheight, width);
             }
 
           /* The top and left corners are the same.  Check the lower right
@@ -422,16 +475,18 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
 
                   /* Get the top middle hit */
 
-                  trv_raycast(g_pitch[toprow], g_yaw[g_cell_column + midcol],
-                              RELYAW(g_cell_column + midcol),
-                              &g_ray_hit[toprow][midcol]);
+                  trv_raycast(ctx, ctx->pitch[toprow],
+                              g_yaw[ctx->cell_column + midcol],
+                              RELYAW(ctx->cell_column + midcol),
+                              &ctx->hit[toprow][midcol]);
 
                   /* Get the bottom middle hit */
 
                   botrow = toprow + height - 1;
-                  trv_raycast(g_pitch[botrow], g_yaw[g_cell_column + midcol],
-                              RELYAW(g_cell_column + midcol),
-                              &g_ray_hit[botrow][midcol]);
+                  trv_raycast(ctx, ctx->pitch[botrow],
+                              g_yaw[ctx->cell_column + midcol],
+                              RELYAW(ctx->cell_column + midcol),
+                              &ctx->hit[botrow][midcol]);
                 }
 
               topheight = ((height + 1) >> 1);
@@ -450,23 +505,25 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
                   /* Get the middle right hit */
 
                   rightcol = leftcol + width - 1;
-                  trv_raycast(g_pitch[midrow], g_yaw[g_cell_column + rightcol],
-                              RELYAW(g_cell_column + rightcol),
-                              &g_ray_hit[midrow][rightcol]);
+                  trv_raycast(ctx, ctx->pitch[midrow],
+                              g_yaw[ctx->cell_column + rightcol],
+                              RELYAW(ctx->cell_column + rightcol),
+                              &ctx->hit[midrow][rightcol]);
 
                   /* Get the center hit */
 
                   if (rightwidth > 1)
                     {
-                      trv_raycast(g_pitch[midrow], g_yaw[g_cell_column + midcol],
-                                  RELYAW(g_cell_column + midcol),
-                                  &g_ray_hit[midrow][midcol]);
+                      trv_raycast(ctx, ctx->pitch[midrow],
+                                  g_yaw[ctx->cell_column + midcol],
+                                  RELYAW(ctx->cell_column + midcol),
+                                  &ctx->hit[midrow][midcol]);
                     }
                 }
 
-              trv_resolve_cell(toprow, leftcol, height, leftwidth);
-              trv_resolve_cell(toprow, midcol, topheight, rightwidth);
-              trv_resolve_cell(midrow, midcol, botheight, rightwidth);
+              trv_resolve_cell(ctx, toprow, leftcol, height, leftwidth);
+              trv_resolve_cell(ctx, toprow, midcol, topheight, rightwidth);
+              trv_resolve_cell(ctx, midrow, midcol, botheight, rightwidth);
             }
 
           /* The four corners are the same! */
@@ -475,7 +532,7 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
             {
               /* Apply texturing */
 
-              trv_rend_cell(toprow, leftcol, height, width);
+              trv_rend_cell(ctx, toprow, leftcol, height, width);
             }
         }
 
@@ -504,13 +561,14 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
 
                   /* Get the middle hit */
 
-                  trv_raycast(g_pitch[toprow], g_yaw[g_cell_column + midcol],
-                              RELYAW(g_cell_column + midcol),
-                              &g_ray_hit[toprow][midcol]);
+                  trv_raycast(ctx, ctx->pitch[toprow],
+                              g_yaw[ctx->cell_column + midcol],
+                              RELYAW(ctx->cell_column + midcol),
+                              &ctx->hit[toprow][midcol]);
                 }
 
-              trv_resolve_cell(toprow, leftcol, 1, leftwidth);
-              trv_resolve_cell(toprow, midcol, 1, rightwidth);
+              trv_resolve_cell(ctx, toprow, leftcol, 1, leftwidth);
+              trv_resolve_cell(ctx, toprow, midcol, 1, rightwidth);
             }
 
           /* The endpoints of the horizontal line are the same! */
@@ -519,7 +577,7 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
             {
               /* Apply texturing */
 
-              trv_rend_row(toprow, leftcol, width);
+              trv_rend_row(ctx, toprow, leftcol, width);
             }
         }
     }
@@ -553,13 +611,14 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
 
               /* Get the middle hit */
 
-              trv_raycast(g_pitch[midrow], g_yaw[g_cell_column + leftcol],
-                          RELYAW(g_cell_column + leftcol),
-                          &g_ray_hit[midrow][leftcol]);
+              trv_raycast(ctx, ctx->pitch[midrow],
+                          g_yaw[ctx->cell_column + leftcol],
+                          RELYAW(ctx->cell_column + leftcol),
+                          &ctx->hit[midrow][leftcol]);
             }
 
-          trv_resolve_cell(toprow, leftcol, topheight, 1);
-          trv_resolve_cell(midrow, leftcol, botheight, 1);
+          trv_resolve_cell(ctx, toprow, leftcol, topheight, 1);
+          trv_resolve_cell(ctx, midrow, leftcol, botheight, 1);
         }
 
       /* The endpoints of the vertical line are the same! */
@@ -568,7 +627,7 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
         {
           /* Apply texturing */
 
-          trv_rend_column(toprow, leftcol, height);
+          trv_rend_column(ctx, toprow, leftcol, height);
         }
     }
 
@@ -578,10 +637,237 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
     {
       /* Apply texturing */
 
-      trv_rend_pixel(toprow, leftcol);
+      trv_rend_pixel(ctx, toprow, leftcol);
+    }
+}
+
+/****************************************************************************
+ * Function: trv_rend_swathe
+ *
+ * Description:
+ *   Cast and rend one horizontal swathe of VGULP_SIZE rows beginning at
+ *   the specified pitch angle and rending buffer row.
+ *
+ ***************************************************************************/
+
+static void trv_rend_swathe(FAR struct trv_raycntx_s *ctx, int16_t pitch,
+                            FAR uint8_t *buffer)
+{
+  int i;
+
+  /* Initialize the pitch angles that will be needed in the inner loop.
+   * These are pre-calculated so that once we get started, we need not have
+   * to be concerned about zero crossing conditions.
+   */
+
+  ctx->pitch[0] = pitch;
+  ctx->buffer_row[0] = &buffer[IMAGE_LEFT];
+
+  for (i = 1; i < VGULP_SIZE; i++)
+    {
+      ctx->pitch[i] = ctx->pitch[i - 1] - VIDEO_ROW_ANGLE;
+      if (ctx->pitch[i] < ANGLE_0)
+        {
+          ctx->pitch[i] += ANGLE_360;
+        }
+
+      ctx->buffer_row[i] = ctx->buffer_row[i - 1] + TRV_SCREEN_WIDTH;
+    }
+
+  /* Seed the algorithm PART II: Set up the raycaster for this horizontal
+   * swathe.  The pitch pruning modifies the shared plane lists so it can
+   * only be done when there is a single worker.
+   */
+
+#if !defined(CONFIG_GRAPHICS_TRAVELER_PLANEINDEX) && TRV_NWORKERS < 2
+  trv_ray_pitchprune(ctx->pitch[VGULP_SIZE - 1], ctx->pitch[0]);
+#endif
+
+  /* Seed the algorithm PART III: These initial hits will be moved to the
+   * beginning the hit array on the first pass through the loop.
+   */
+
+  trv_raycast(ctx, ctx->pitch[TOP_ROW], g_yaw[IMAGE_WIDTH],
+              RELYAW(IMAGE_WIDTH), &ctx->hit[TOP_ROW][LEFT_COL]);
+  trv_raycast(ctx, ctx->pitch[BOT_ROW], g_yaw[IMAGE_WIDTH],
+              RELYAW(IMAGE_WIDTH), &ctx->hit[BOT_ROW][LEFT_COL]);
+
+  /* Loop through all columns at each yaw angle on the screen window */
+
+  for (ctx->cell_column = (IMAGE_WIDTH - HGULP_SIZE + 1);
+       ctx->cell_column >= 0; ctx->cell_column -= HGULP_SIZE)
+    {
+      trv_vdebug("\ncell_column=%d yaw=%d", ctx->cell_column,
+                 g_yaw[ctx->cell_column]);
+
+      /* Perform Ray VGULP_SIZE x HGULP_SIZE Casting */
+
+      /* The hits at the right corners will be the same as the hits for for
+       * the left hand corners on the next pass */
+
+      ctx->hit[TOP_ROW][RIGHT_COL] = ctx->hit[TOP_ROW][LEFT_COL];
+      ctx->hit[BOT_ROW][RIGHT_COL] = ctx->hit[BOT_ROW][LEFT_COL];
+
+      /* Now get new hits in the right corners. */
+
+      trv_raycast(ctx, ctx->pitch[TOP_ROW], g_yaw[ctx->cell_column],
+                  RELYAW(ctx->cell_column), &ctx->hit[TOP_ROW][LEFT_COL]);
+      trv_raycast(ctx, ctx->pitch[BOT_ROW], g_yaw[ctx->cell_column],
+                  RELYAW(ctx->cell_column), &ctx->hit[BOT_ROW][LEFT_COL]);
+
+      /* Now, resolve the cell recursively until the hits are the same in
+       * all four corners */
+
+      trv_resolve_cell(ctx, TOP_ROW, LEFT_COL, VGULP_SIZE, (HGULP_SIZE + 1));
+    }
+
+  /* Inform the ray cast engine that we are done with this horizonatal
+   * swathe.
+   */
+
+#if !defined(CONFIG_GRAPHICS_TRAVELER_PLANEINDEX) && TRV_NWORKERS < 2
+  trv_ray_pitchunprune();
+#endif
+}
+
+#if TRV_NWORKERS > 1
+/****************************************************************************
+ * Function: trv_sem_wait
+ *
+ * Description:
+ *   Wait on a semaphore, ignoring interruptions by signals.
+ *
+ ***************************************************************************/
+
+static void trv_sem_wait(FAR sem_t *sem)
+{
+  int ret;
+
+  do
+    {
+      ret = sem_wait(sem);
+    }
+  while (ret < 0 && errno == EINTR);
+}
+
+/****************************************************************************
+ * Function: trv_rend_swathes
+ *
+ * Description:
+ *   Take swathes from the current frame and rend them until there are no
+ *   more swathes to be rended.
+ *
+ ***************************************************************************/
+
+static void trv_rend_swathes(FAR struct trv_raycntx_s *ctx)
+{
+  int swathe;
+  int pitch;
+
+  for (;;)
+    {
+      /* Claim the next swathe */
+
+      pthread_mutex_lock(&g_frame.lock);
+      swathe = g_frame.nextswathe;
+      if (swathe < NUMBER_SWATHES)
+        {
+          g_frame.nextswathe++;
+        }
+
+      pthread_mutex_unlock(&g_frame.lock);
+
+      if (swathe >= NUMBER_SWATHES)
+        {
+          break;
+        }
+
+      /* Get the pitch angle at the top of this swathe */
+
+      pitch = g_frame.pitch - swathe * VGULP_SIZE * VIDEO_ROW_ANGLE;
+      while (pitch < ANGLE_0)
+        {
+          pitch += ANGLE_360;
+        }
+
+      trv_rend_swathe(ctx, (int16_t)pitch,
+                      &g_frame.buffer[swathe * VGULP_SIZE *
+                                      TRV_SCREEN_WIDTH]);
+    }
+}
+
+/****************************************************************************
+ * Function: trv_raycast_worker
+ *
+ * Description:
+ *   This is the main loop of each ray casting worker thread.
+ *
+ ***************************************************************************/
+
+static FAR void *trv_raycast_worker(FAR void *arg)
+{
+  FAR struct trv_raycntx_s *ctx = (FAR struct trv_raycntx_s *)arg;
+
+  for (;;)
+    {
+      /* Wait for the next frame */
+
+      trv_sem_wait(&g_frame.start);
+      if (g_frame.terminate)
+        {
+          break;
+        }
+
+      /* Get a private copy of the camera and help rend the frame */
+
+      ctx->camera = g_camera;
+      trv_rend_swathes(ctx);
+      sem_post(&g_frame.done);
     }
+
+  return NULL;
 }
 
+/****************************************************************************
+ * Function: trv_start_workers
+ *
+ * Description:
+ *   Create the ray casting worker threads.  If fewer threads can be created
+ *   than were requested, then the frame will be rended with those that
+ *   could be created.
+ *
+ ***************************************************************************/
+
+static void trv_start_workers(void)
+{
+  int ret;
+  int i;
+
+  pthread_mutex_init(&g_frame.lock, NULL);
+  sem_init(&g_frame.start, 0, 0);
+  sem_init(&g_frame.done, 0, 0);
+
+  g_frame.terminate = false;
+  g_frame.nworkers  = 0;
+
+  for (i = 0; i < TRV_NWORKERS - 1; i++)
+    {
+      ret = pthread_create(&g_worker[i], NULL, trv_raycast_worker,
+                           &g_raycntx[i + 1]);
+      if (ret != 0)
+        {
+          trv_debug("Failed to create ray casting worker %d: %d\n",
+                    i + 1, ret);
+          break;
+        }
+
+      g_frame.nworkers++;
+    }
+
+  g_frame.started = true;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -598,11 +884,15 @@ static void trv_resolve_cell(uint8_t toprow, uint8_t leftcol,
 void trv_raycaster(FAR struct trv_camera_s *player,
                    FAR struct trv_graphics_info_s *ginfo)
 {
-  int16_t row;         /* the current row being cast 0..IMAGE_HEIGHT */
+  int16_t column;      /* The current column of g_yaw[] being set up */
   int16_t yaw;         /* Working yaw angle */
   int16_t pitch;       /* Working pitch angle */
-  uint8_t *buffer;     /* Points the screen buffer row for this pitch */
+#if TRV_NWORKERS > 1
   int i;
+#else
+  FAR uint8_t *buffer; /* Points the screen buffer row for this pitch */
+  int16_t row;         /* the current row being cast 0..IMAGE_HEIGHT */
+#endif
 
   trv_vdebug("\ntrv_raycaster: x=%d y=%d z=%d yaw=%d pitch=%d",
              player->x, player->x, player->z, player->yaw, player->pitch);
@@ -634,13 +924,13 @@ void trv_raycaster(FAR struct trv_camera_s *player,
 
   /* Loop through all columns at each yaw angle on the screen */
 
-  for (g_cell_column = IMAGE_WIDTH; g_cell_column >= 0; g_cell_column--)
+  for (column = IMAGE_WIDTH; column >= 0; column--)
     {
       /* Save the yaw angle.  By saving all of the yaw angles, we can avoid
        * complex tests for 360 degree wraps.
        */
 
-      g_yaw[g_cell_column] = yaw;
+      g_yaw[column] = yaw;
 
       /* Test if viewing yaw angle needs to wrap around */
 
@@ -651,107 +941,150 @@ void trv_raycaster(FAR struct trv_camera_s *player,
         }
     }
 
-  /* Seed the algorithm PART I: Set up the raycaster this yaw range. */
+#ifndef CONFIG_GRAPHICS_TRAVELER_PLANEINDEX
+  /* Seed the algorithm PART I: Set up the raycaster this yaw range.  This
+   * is not necessary if the ray casters use the grid index.
+   */
 
   trv_ray_yawprune(g_yaw[IMAGE_WIDTH], g_yaw[0]);
+#endif
 
   /* Top of Ray Casting Loops */
 
-  /* Point to the first row of the rending buffer.  This will be bumped to
-   * successive rows with each change in the pitch angle.
-   */
+  g_raycntx[0].camera = g_camera;
 
-  buffer = &ginfo->swbuffer[IMAGE_TOP];
+#if TRV_NWORKERS > 1
+  /* Create the worker threads on the first frame */
 
-  /* Loop through each row at each pitch angle */
+  if (!g_frame.started)
+    {
+      trv_start_workers();
+    }
 
-  for (row = 0; (row < (IMAGE_HEIGHT - VGULP_SIZE + 1)); row += VGULP_SIZE)
+  /* Describe the frame and start the workers.  This thread also rends
+   * swathes until there are no more.
+   */
+
+  g_frame.buffer     = &ginfo->swbuffer[IMAGE_TOP];
+  g_frame.pitch      = pitch;
+  g_frame.nextswathe = 0;
+
+  for (i = 0; i < g_frame.nworkers; i++)
     {
-      /* Initialize the pitch angles that will be needed in the inner loop.
-       * These are pre-calculated so that once we get started, we need not have 
-       * to be concerned about zero crossing conditions.
-       */
+      sem_post(&g_frame.start);
+    }
 
-      g_pitch[0] = pitch;
-      g_buffer_row[0] = &buffer[IMAGE_LEFT];
+  trv_rend_swathes(&g_raycntx[0]);
 
-      for (i = 1; i < VGULP_SIZE; i++)
-        {
-          g_pitch[i] = g_pitch[i - 1] - VIDEO_ROW_ANGLE;
-          if (g_pitch[i] < ANGLE_0)
-            {
-              g_pitch[i] += ANGLE_360;
-            }
+  /* Then wait for the workers to finish their last swathes */
 
-          g_buffer_row[i] = g_buffer_row[i - 1] + TRV_SCREEN_WIDTH;
-        }
+  for (i = 0; i < g_frame.nworkers; i++)
+    {
+      trv_sem_wait(&g_frame.done);
+    }
 
-      /* Seed the algorithm PART II: Set up the raycaster for this horizontal
-       * swathe
-       */
+#else
+  /* Point to the first row of the rending buffer.  This will be bumped to
+   * successive rows with each change in the pitch angle.
+   */
 
-      trv_ray_pitchprune(g_pitch[VGULP_SIZE - 1], g_pitch[0]);
+  buffer = &ginfo->swbuffer[IMAGE_TOP];
 
-      /* Seed the algorithm PART III: These initial hits will be moved to the
-       * beginning the hit array on the first pass through the loop.
-       */
+  /* Loop through each row at each pitch angle */
 
-      trv_raycast(g_pitch[TOP_ROW], g_yaw[IMAGE_WIDTH],
-                  RELYAW(IMAGE_WIDTH), &g_ray_hit[TOP_ROW][LEFT_COL]);
-      trv_raycast(g_pitch[BOT_ROW], g_yaw[IMAGE_WIDTH],
-                  RELYAW(IMAGE_WIDTH), &g_ray_hit[BOT_ROW][LEFT_COL]);
+  for (row = 0; (row < (IMAGE_HEIGHT - VGULP_SIZE + 1)); row += VGULP_SIZE)
+    {
+      trv_rend_swathe(&g_raycntx[0], pitch, buffer);
 
-      /* Loop through all columns at each yaw angle on the screen window */
+      /* End of the pitch loop.  Bump up the pitch angle and the rending
+       * buffer pointer for the next time through the outer loop.
+       */
 
-      for (g_cell_column = (IMAGE_WIDTH - HGULP_SIZE + 1);
-           g_cell_column >= 0; g_cell_column -= HGULP_SIZE)
+      pitch -= (VGULP_SIZE * VIDEO_ROW_ANGLE);
+      if (pitch < ANGLE_0)
         {
-          trv_vdebug("\ng_cell_column=%d yaw=%d", g_cell_column,
-                     g_yaw[g_cell_column]);
+          pitch += ANGLE_360;
+        }
 
-          /* Perform Ray VGULP_SIZE x HGULP_SIZE Casting */
+      buffer += (VGULP_SIZE * TRV_SCREEN_WIDTH);
+    }
+#endif
 
-          /* The hits at the right corners will be the same as the hits for for 
-           * the left hand corners on the next pass */
+#ifndef CONFIG_GRAPHICS_TRAVELER_PLANEINDEX
+  /* Inform the ray cast engine that we are done. */
 
-          g_ray_hit[TOP_ROW][RIGHT_COL] = g_ray_hit[TOP_ROW][LEFT_COL];
-          g_ray_hit[BOT_ROW][RIGHT_COL] = g_ray_hit[BOT_ROW][LEFT_COL];
+  trv_ray_yawunprune();
+#endif
+}
 
-          /* Now get new hits in the right corners. */
+/****************************************************************************
+ * Function: trv_raycaster_terminate
+ *
+ * Description:
+ *   Stop any ray casting worker threads and release their resources.
+ *
+ ***************************************************************************/
 
-          trv_raycast(g_pitch[TOP_ROW], g_yaw[g_cell_column],
-                      RELYAW(g_cell_column), &g_ray_hit[TOP_ROW][LEFT_COL]);
-          trv_raycast(g_pitch[BOT_ROW], g_yaw[g_cell_column],
-                      RELYAW(g_cell_column), &g_ray_hit[BOT_ROW][LEFT_COL]);
+void trv_raycaster_terminate(void)
+{
+#if TRV_NWORKERS > 1
+  int i;
 
-          /* Now, resolve the cell recursively until the hits are the same in
-           * all four corners */
+  if (g_frame.started)
+    {
+      /* Wake up each worker with the terminate flag set */
 
-          trv_resolve_cell(TOP_ROW, LEFT_COL, VGULP_SIZE, (HGULP_SIZE + 1));
+      g_frame.terminate = true;
+      for (i = 0; i < g_frame.nworkers; i++)
+        {
+          sem_post(&g_frame.start);
         }
 
-      /* End of the pitch loop.  Bump up the pitch angle and the rending buffer 
-       * pointer for the next time through the outer loop */
-
-      pitch -= (VGULP_SIZE * VIDEO_ROW_ANGLE);
-      if (pitch < ANGLE_0)
+      for (i = 0; i < g_frame.nworkers; i++)
         {
-          pitch += ANGLE_360;
+          (void)pthread_join(g_worker[i], NULL);
         }
 
-      buffer += (VGULP_SIZE * TRV_SCREEN_WIDTH);
-
-      /* Inform the ray cast engine that we are done with this horizonatal
-       * swathe.
-       */
+      sem_destroy(&g_frame.start);
+      sem_destroy(&g_frame.done);
+      pthread_mutex_destroy(&g_frame.lock);
 
-      trv_ray_pitchunprune();
+      g_frame.started  = false;
+      g_frame.nworkers = 0;
     }
+#endif
+}
 
-  /* Inform the ray cast engine that we are done. */
+/****************************************************************************
+ * Function: trv_raycaster_counters
+ *
+ * Description:
+ *   Return the sum of the hot path counters of all ray casting contexts
+ *   since the last call and reset the counters.  This must not be called
+ *   while a frame is being rended.
+ *
+ ***************************************************************************/
 
-  trv_ray_yawunprune();
+#ifdef CONFIG_GRAPHICS_TRAVELER_COUNTERS
+void trv_raycaster_counters(FAR struct trv_counters_s *counters)
+{
+  FAR struct trv_counters_s *ctxcount;
+  int i;
+
+  memset(counters, 0, sizeof(struct trv_counters_s));
+  for (i = 0; i < TRV_NWORKERS; i++)
+    {
+      ctxcount = &g_raycntx[i].counters;
+
+      counters->rays    += ctxcount->rays;
+      counters->planes  += ctxcount->planes;
+      counters->fetches += ctxcount->fetches;
+      counters->pixels  += ctxcount->pixels;
+
+      memset(ctxcount, 0, sizeof(struct trv_counters_s));
+    }
 }
+#endif
 
 /****************************************************************************
  * Function: trv_get_texture
@@ -766,16 +1099,17 @@ void trv_raycaster(FAR struct trv_camera_s *player,
  *
  ***************************************************************************/
 
-uint8_t trv_get_texture(uint8_t row, uint8_t col)
+uint8_t trv_get_texture(FAR struct trv_raycntx_s *ctx, uint8_t row,
+                        uint8_t col)
 {
-  FAR struct trv_raycast_s *ptr = &g_ray_hit[row][col];
+  FAR struct trv_raycast_s *ptr = &ctx->hit[row][col];
   FAR uint8_t *palptr;
   int16_t zone;
 
   /* Perform a ray cast to get the hit at this row & column */
 
-  trv_raycast(g_pitch[row], g_yaw[g_cell_column + col],
-              RELYAW(g_cell_column + col), ptr);
+  trv_raycast(ctx, ctx->pitch[row], g_yaw[ctx->cell_column + col],
+              RELYAW(ctx->cell_column + col), ptr);
 
   /* Check if we hit anything */
 
@@ -796,6 +1130,7 @@ uint8_t trv_get_texture(uint8_t row, uint8_t col)
       /* We did, return the pixel at this location */
       /* PROBLEM: Need to know if the is an even or odd hit */
 
+      TRV_COUNT(ctx, fetches, 1);
       return palptr[GET_FRONT_PIXEL(ptr->rect, ptr->xpos, ptr->ypos)];
     }
   else
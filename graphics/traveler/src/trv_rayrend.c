@@ -97,17 +97,25 @@ union tex_ndx_u
  * Private Function Prototypes
  ****************************************************************************/
 
-static void trv_rend_zcell(uint8_t row, uint8_t col, uint8_t height,
+static void trv_rend_zcell(FAR struct trv_raycntx_s *ctx,
+                           uint8_t row, uint8_t col, uint8_t height,
                            uint8_t width);
-static void trv_rend_zrow(uint8_t row, uint8_t col, uint8_t width);
-static void trv_rend_zcol(uint8_t row, uint8_t col, uint8_t height);
-static void trv_rend_zpixel(uint8_t row, uint8_t col);
-
-static void trv_rend_wall(uint8_t row, uint8_t col, uint8_t height,
+static void trv_rend_zrow(FAR struct trv_raycntx_s *ctx,
+                          uint8_t row, uint8_t col, uint8_t width);
+static void trv_rend_zcol(FAR struct trv_raycntx_s *ctx,
+                          uint8_t row, uint8_t col, uint8_t height);
+static void trv_rend_zpixel(FAR struct trv_raycntx_s *ctx,
+                            uint8_t row, uint8_t col);
+
+static void trv_rend_wall(FAR struct trv_raycntx_s *ctx,
+                          uint8_t row, uint8_t col, uint8_t height,
                           uint8_t width);
-static void trv_rend_wallrow(uint8_t row, uint8_t col, uint8_t width);
-static void trv_rend_wallcol(uint8_t row, uint8_t col, uint8_t height);
-static void trv_rend_wallpixel(uint8_t row, uint8_t col);
+static void trv_rend_wallrow(FAR struct trv_raycntx_s *ctx,
+                             uint8_t row, uint8_t col, uint8_t width);
+static void trv_rend_wallcol(FAR struct trv_raycntx_s *ctx,
+                             uint8_t row, uint8_t col, uint8_t height);
+static void trv_rend_wallpixel(FAR struct trv_raycntx_s *ctx,
+                               uint8_t row, uint8_t col);
 
 /****************************************************************************
  * Private Data
@@ -142,7 +150,9 @@ static const uint8_t g_invsize[VGULP_SIZE] =
 
 /* This version is for non-degenerate cell, i.e., height>1 and width>1 */
 
-static void trv_rend_zcell(uint8_t row, uint8_t col, uint8_t height, uint8_t width)
+static void trv_rend_zcell(FAR struct trv_raycntx_s *ctx,
+                           uint8_t row, uint8_t col, uint8_t height,
+                           uint8_t width)
 {
 #if (!DISABLE_FLOOR_RENDING)
   uint8_t i;
@@ -173,20 +183,20 @@ static void trv_rend_zcell(uint8_t row, uint8_t col, uint8_t height, uint8_t wid
 
   /* Displace the double buffer pointer */
 
-  outpixel = &g_buffer_row[row][g_cell_column];
+  outpixel = &ctx->buffer_row[row][ctx->cell_column];
 
   /* Point to the bitmap associated with the upper left pixel.  Since
    * all of the pixels in this cell are the same "hit," we don't have
    * to recalculate this
    */
 
-  if (IS_FRONT_HIT(&g_ray_hit[row][col]))
+  if (IS_FRONT_HIT(&ctx->hit[row][col]))
     {
-      bmp = g_even_bitmaps[g_ray_hit[row][col].rect->texture];
+      bmp = g_even_bitmaps[ctx->hit[row][col].rect->texture];
     }
   else
     {
-      bmp = g_odd_bitmaps[g_ray_hit[row][col].rect->texture];
+      bmp = g_odd_bitmaps[ctx->hit[row][col].rect->texture];
     }
 
   /* Get parameters associated with the size of the bitmap texture */
@@ -197,7 +207,7 @@ static void trv_rend_zcell(uint8_t row, uint8_t col, uint8_t height, uint8_t wid
 
   /* Extract the texture scaling from the rectangle structure */
 
-  scale = g_ray_hit[row][col].rect->scale;
+  scale = ctx->hit[row][col].rect->scale;
 
   /* Within this function, all references to height and width are really
    * (height-1) and (width-1)
@@ -214,18 +224,18 @@ static void trv_rend_zcell(uint8_t row, uint8_t col, uint8_t height, uint8_t wid
   /* Calculate the horizontal interpolation values */
   /* This is the H starting position (first row, first column) */
 
-  hstart = TALIGN(g_ray_hit[row][col].xpos, scale);
+  hstart = TALIGN(ctx->hit[row][col].xpos, scale);
 
   /* This is the change in xpos per column in the first row */
 
   hcolstep =
-    TDIV((g_ray_hit[row][endcol].xpos - g_ray_hit[row][col].xpos),
+    TDIV((ctx->hit[row][endcol].xpos - ctx->hit[row][col].xpos),
       width, scale);
      
   /* This is the change in xpos per column in the last row */
 
   tmpcolstep =
-    TDIV((g_ray_hit[endrow][endcol].xpos - g_ray_hit[endrow][col].xpos),
+    TDIV((ctx->hit[endrow][endcol].xpos - ctx->hit[endrow][col].xpos),
       width, scale);
 
   /* This is the change in hcolstep per row */
@@ -235,24 +245,24 @@ static void trv_rend_zcell(uint8_t row, uint8_t col, uint8_t height, uint8_t wid
   /* This is the change in hstart for each row */
 
   hrowstep =
-    TDIV((g_ray_hit[endrow][col].xpos - g_ray_hit[row][col].xpos),
+    TDIV((ctx->hit[endrow][col].xpos - ctx->hit[row][col].xpos),
       height, scale);
 
   /* Calculate the vertical interpolation values */
   /* This is the V starting position (first row, first column) */
 
-  vstart = TALIGN(g_ray_hit[row][col].ypos, scale);
+  vstart = TALIGN(ctx->hit[row][col].ypos, scale);
 
   /* This is the change in ypos per column in the first row */
 
   vcolstep =
-    TDIV((g_ray_hit[row][endcol].ypos - g_ray_hit[row][col].ypos),
+    TDIV((ctx->hit[row][endcol].ypos - ctx->hit[row][col].ypos),
       width, scale);
 
   /* This is the change in ypos per column in the last row */
 
   tmpcolstep =
-    TDIV((g_ray_hit[endrow][endcol].ypos - g_ray_hit[endrow][col].ypos),
+    TDIV((ctx->hit[endrow][endcol].ypos - ctx->hit[endrow][col].ypos),
       width, scale);
 
   /* This is the change in vcolstep per row */
@@ -262,15 +272,16 @@ static void trv_rend_zcell(uint8_t row, uint8_t col, uint8_t height, uint8_t wid
   /* This is the change in vstart for each row */
 
   vrowstep =
-    TDIV((g_ray_hit[endrow][col].ypos - g_ray_hit[row][col].ypos),
+    TDIV((ctx->hit[endrow][col].ypos - ctx->hit[row][col].ypos),
       height, scale);
      
   /* Determine the palette mapping table zone for each row */
 
-  if (IS_SHADED(g_ray_hit[row][col].rect))
+  if (IS_SHADED(ctx->hit[row][col].rect))
     {
-      zone = GET_FZONE(g_ray_hit[row][col].xdist, g_ray_hit[row][col].ydist, 8);
-      endzone = GET_FZONE(g_ray_hit[endrow][col].xdist, g_ray_hit[endrow][col].ydist, 8);
+      zone = GET_FZONE(ctx->hit[row][col].xdist, ctx->hit[row][col].ydist, 8);
+      endzone = GET_FZONE(ctx->hit[endrow][col].xdist,
+                          ctx->hit[endrow][col].ydist, 8);
       zonestep = (DIV8((endzone - zone), height) >> 8);
     }
   else
@@ -298,6 +309,8 @@ static void trv_rend_zcell(uint8_t row, uint8_t col, uint8_t height, uint8_t wid
         {
           /* Transfer the pixel at this interpolated position */
 
+          TRV_COUNT(ctx, fetches, 1);
+          TRV_COUNT(ctx, pixels, 1);
           outpixel[j] = palptr[texture[TNDX(xpos.s.i, ypos.s.i, tsize, tmask)]];
 
           /* Now Calculate the horizontal position for the next step */
@@ -329,7 +342,8 @@ static void trv_rend_zcell(uint8_t row, uint8_t col, uint8_t height, uint8_t wid
 
 /* This version is for horizontal lines, i.e., height==1 and width>1 */
 
-static void trv_rend_zrow(uint8_t row, uint8_t col, uint8_t width)
+static void trv_rend_zrow(FAR struct trv_raycntx_s *ctx,
+                          uint8_t row, uint8_t col, uint8_t width)
 {
 #if (!DISABLE_FLOOR_RENDING)
   uint8_t j;
@@ -349,20 +363,20 @@ static void trv_rend_zrow(uint8_t row, uint8_t col, uint8_t width)
 
   /* Displace the double buffer pointer */
 
-  outpixel = &g_buffer_row[row][g_cell_column];
+  outpixel = &ctx->buffer_row[row][ctx->cell_column];
 
   /* Point to the bitmap associated with the left pixel.  Since
    * all of the pixels in this row are the same "hit," we don't have
    * to recalculate this
    */
 
-   if (IS_FRONT_HIT(&g_ray_hit[row][col]))
+   if (IS_FRONT_HIT(&ctx->hit[row][col]))
     {
-      bmp = g_even_bitmaps[g_ray_hit[row][col].rect->texture];
+      bmp = g_even_bitmaps[ctx->hit[row][col].rect->texture];
     }
   else
     {
-      bmp = g_odd_bitmaps[g_ray_hit[row][col].rect->texture];
+      bmp = g_odd_bitmaps[ctx->hit[row][col].rect->texture];
     }
 
   /* Get parameters associated with the size of the bitmap texture */
@@ -373,13 +387,13 @@ static void trv_rend_zrow(uint8_t row, uint8_t col, uint8_t width)
 
   /* Extract the texture scaling from the rectangle structure */
 
-  scale = g_ray_hit[row][col].rect->scale;
+  scale = ctx->hit[row][col].rect->scale;
 
   /* Get the a pointer to the palette mapping table */
 
-  if (IS_SHADED(g_ray_hit[row][col].rect))
+  if (IS_SHADED(ctx->hit[row][col].rect))
     {
-      zone = GET_ZONE(g_ray_hit[row][col].xdist, g_ray_hit[row][col].ydist);
+      zone = GET_ZONE(ctx->hit[row][col].xdist, ctx->hit[row][col].ydist);
       palptr = GET_PALPTR(zone);
     }
   else
@@ -400,23 +414,23 @@ static void trv_rend_zrow(uint8_t row, uint8_t col, uint8_t width)
   /* Calculate the horizontal interpolation values */
   /* This is the H starting position (first column) */
 
-  xpos.w = TALIGN(g_ray_hit[row][col].xpos, scale);
+  xpos.w = TALIGN(ctx->hit[row][col].xpos, scale);
 
   /* This is the change in xpos per column */
 
   hcolstep =
-    TDIV((g_ray_hit[row][endcol].xpos - g_ray_hit[row][col].xpos),
+    TDIV((ctx->hit[row][endcol].xpos - ctx->hit[row][col].xpos),
       width, scale);
      
   /* Calculate the vertical interpolation values */
   /* This is the V starting position (first column) */
 
-  ypos.w = TALIGN(g_ray_hit[row][col].ypos, scale);
+  ypos.w = TALIGN(ctx->hit[row][col].ypos, scale);
      
   /* This is the change in ypos per column */
 
   vcolstep =
-    TDIV((g_ray_hit[row][endcol].ypos - g_ray_hit[row][col].ypos),
+    TDIV((ctx->hit[row][endcol].ypos - ctx->hit[row][col].ypos),
       width, scale);
      
   /* Interpolate to texture each column in the row */
@@ -425,6 +439,8 @@ static void trv_rend_zrow(uint8_t row, uint8_t col, uint8_t width)
     {
       /* Transfer the pixel at this interpolated position */
 
+      TRV_COUNT(ctx, fetches, 1);
+      TRV_COUNT(ctx, pixels, 1);
       outpixel[j] = palptr[texture[TNDX(xpos.s.i, ypos.s.i, tsize, tmask)]];
 
       /* Now Calculate the horizontal position for the next step */
@@ -437,7 +453,8 @@ static void trv_rend_zrow(uint8_t row, uint8_t col, uint8_t width)
 
 /* This version is for vertical lines, i.e., height>1 and width==1 */
 
-static void trv_rend_zcol(uint8_t row, uint8_t col, uint8_t height)
+static void trv_rend_zcol(FAR struct trv_raycntx_s *ctx,
+                          uint8_t row, uint8_t col, uint8_t height)
 {
 #if (!DISABLE_FLOOR_RENDING)
   uint8_t i, endrow;
@@ -456,20 +473,20 @@ static void trv_rend_zcol(uint8_t row, uint8_t col, uint8_t height)
 
   /* Displace the double buffer pointer */
 
-  outpixel = &g_buffer_row[row][g_cell_column+col];
+  outpixel = &ctx->buffer_row[row][ctx->cell_column+col];
 
   /* Point to the bitmap associated with the upper pixel.  Since
    * all of the pixels in this column are the same "hit," we don't have
    * to recalculate this
    */
 
-   if (IS_FRONT_HIT(&g_ray_hit[row][col]))
+   if (IS_FRONT_HIT(&ctx->hit[row][col]))
     {
-      bmp = g_even_bitmaps[g_ray_hit[row][col].rect->texture];
+      bmp = g_even_bitmaps[ctx->hit[row][col].rect->texture];
     }
   else
     {
-      bmp = g_odd_bitmaps[g_ray_hit[row][col].rect->texture];
+      bmp = g_odd_bitmaps[ctx->hit[row][col].rect->texture];
     }
 
   /* Get parameters associated with the size of the bitmap texture */
@@ -480,13 +497,13 @@ static void trv_rend_zcol(uint8_t row, uint8_t col, uint8_t height)
 
   /* Extract the texture scaling from the rectangle structure */
 
-  scale = g_ray_hit[row][col].rect->scale;
+  scale = ctx->hit[row][col].rect->scale;
 
   /* Get the a pointer to the palette mapping table */
 
-  if (IS_SHADED(g_ray_hit[row][col].rect))
+  if (IS_SHADED(ctx->hit[row][col].rect))
     {
-      zone = GET_ZONE(g_ray_hit[row][col].xdist, g_ray_hit[row][col].ydist);
+      zone = GET_ZONE(ctx->hit[row][col].xdist, ctx->hit[row][col].ydist);
       palptr = GET_PALPTR(zone);
     }
   else
@@ -507,23 +524,23 @@ static void trv_rend_zcol(uint8_t row, uint8_t col, uint8_t height)
   /* Calculate the horizontal interpolation values */
   /* This is the H starting position (first row) */
 
-  xpos.w = TALIGN(g_ray_hit[row][col].xpos, scale);
+  xpos.w = TALIGN(ctx->hit[row][col].xpos, scale);
 
   /* This is the change in xpos for each row */
 
   hrowstep =
-    TDIV((g_ray_hit[endrow][col].xpos - g_ray_hit[row][col].xpos),
+    TDIV((ctx->hit[endrow][col].xpos - ctx->hit[row][col].xpos),
       height, scale);
 
   /* Calculate the vertical interpolation values */
   /* This is the V starting position (first row) */
 
-  ypos.w = TALIGN(g_ray_hit[row][col].ypos, scale);
+  ypos.w = TALIGN(ctx->hit[row][col].ypos, scale);
     
   /* This is the change in ypos for each row */
 
   vrowstep =
-    TDIV((g_ray_hit[endrow][col].ypos - g_ray_hit[row][col].ypos),
+    TDIV((ctx->hit[endrow][col].ypos - ctx->hit[row][col].ypos),
       height, scale);
     
   /* Now, interpolate to texture each row (vertical component) */
@@ -532,6 +549,8 @@ static void trv_rend_zcol(uint8_t row, uint8_t col, uint8_t height)
     {
       /* Transfer the pixel at this interpolated position */
 
+      TRV_COUNT(ctx, fetches, 1);
+      TRV_COUNT(ctx, pixels, 1);
       *outpixel = palptr[texture[TNDX(xpos.s.i, ypos.s.i, tsize, tmask)]];
 
       /* Point to the next row */
@@ -548,7 +567,8 @@ static void trv_rend_zcol(uint8_t row, uint8_t col, uint8_t height)
 
 /* This version is for a single pixel, i.e., height==1 and width==1 */
 
-static void trv_rend_zpixel(uint8_t row, uint8_t col)
+static void trv_rend_zpixel(FAR struct trv_raycntx_s *ctx,
+                            uint8_t row, uint8_t col)
 {
 #if (!DISABLE_FLOOR_RENDING)
   FAR uint8_t *palptr;
@@ -560,9 +580,9 @@ static void trv_rend_zpixel(uint8_t row, uint8_t col)
 
   /* Get the a pointer to the palette mapping table */
 
-  if (IS_SHADED(g_ray_hit[row][col].rect))
+  if (IS_SHADED(ctx->hit[row][col].rect))
     {
-      zone = GET_ZONE(g_ray_hit[row][col].xdist, g_ray_hit[row][col].ydist);
+      zone = GET_ZONE(ctx->hit[row][col].xdist, ctx->hit[row][col].ydist);
       palptr = GET_PALPTR(zone);
     }
   else
@@ -572,13 +592,13 @@ static void trv_rend_zpixel(uint8_t row, uint8_t col)
 
   /* Point to the bitmap associated with the upper left pixel. */
 
-  if (IS_FRONT_HIT(&g_ray_hit[row][col]))
+  if (IS_FRONT_HIT(&ctx->hit[row][col]))
     {
-    bmp = g_even_bitmaps[g_ray_hit[row][col].rect->texture];
+    bmp = g_even_bitmaps[ctx->hit[row][col].rect->texture];
     }
   else
     {
-    bmp = g_odd_bitmaps[g_ray_hit[row][col].rect->texture];
+    bmp = g_odd_bitmaps[ctx->hit[row][col].rect->texture];
     }
 
   /* Get parameters associated with the size of the bitmap texture */
@@ -587,8 +607,11 @@ static void trv_rend_zpixel(uint8_t row, uint8_t col)
   tsize = bmp->log2h;
   tmask = TMASK(tsize);
 
-  g_buffer_row[row][g_cell_column+col] =
-    palptr[texture[TNDX(g_ray_hit[row][col].xpos, g_ray_hit[row][col].ypos,
+  TRV_COUNT(ctx, fetches, 1);
+  TRV_COUNT(ctx, pixels, 1);
+
+  ctx->buffer_row[row][ctx->cell_column+col] =
+    palptr[texture[TNDX(ctx->hit[row][col].xpos, ctx->hit[row][col].ypos,
                         tsize, tmask)]];
 #endif
 }
@@ -602,8 +625,8 @@ static void trv_rend_zpixel(uint8_t row, uint8_t col)
  *   to the double buffer.  These special simplifications for use on on
  *   vertical (X or Y) walls.  In this case, we can assume that:
  *
- *     g_ray_hit[row][col].xpos == g_ray_hit[row+height-1][col]
- *     g_ray_hit[row][col+width-1].xpos == g_ray_hit[row+height-1][col+width-1]
+ *     ctx->hit[row][col].xpos == ctx->hit[row+height-1][col]
+ *     ctx->hit[row][col+width-1].xpos == ctx->hit[row+height-1][col+width-1]
  *
  *   In addition to these simplifications, these functions include the
  *   added complications of handling internal INVISIBLE_PIXELs which may
@@ -613,7 +636,8 @@ static void trv_rend_zpixel(uint8_t row, uint8_t col)
 
 /* This version is for non-degenerate cell, i.e., height>1 and width>1 */
 
-static void trv_rend_wall(uint8_t row, uint8_t col,
+static void trv_rend_wall(FAR struct trv_raycntx_s *ctx,
+                          uint8_t row, uint8_t col,
                           uint8_t height, uint8_t width)
 {
 #if (!DISABLE_WALL_RENDING)
@@ -641,20 +665,20 @@ static void trv_rend_wall(uint8_t row, uint8_t col,
 
   /* Displace the double buffer pointer */
 
-  outpixel = &g_buffer_row[row][g_cell_column];
+  outpixel = &ctx->buffer_row[row][ctx->cell_column];
 
   /* Point to the bitmap associated with the upper left pixel.  Since
    * all of the pixels in this cell are the same "hit," we don't have
    * to recalculate this
    */
 
-  if (IS_FRONT_HIT(&g_ray_hit[row][col]))
+  if (IS_FRONT_HIT(&ctx->hit[row][col]))
     {
-      bmp = g_even_bitmaps[g_ray_hit[row][col].rect->texture];
+      bmp = g_even_bitmaps[ctx->hit[row][col].rect->texture];
     }
   else
     {
-      bmp = g_odd_bitmaps[g_ray_hit[row][col].rect->texture];
+      bmp = g_odd_bitmaps[ctx->hit[row][col].rect->texture];
     }
 
   /* Get parameters associated with the size of the bitmap texture */
@@ -665,13 +689,13 @@ static void trv_rend_wall(uint8_t row, uint8_t col,
 
   /* Extract the texture scaling from the rectangle structure */
 
-  scale = g_ray_hit[row][col].rect->scale;
+  scale = ctx->hit[row][col].rect->scale;
 
   /* Get the a pointer to the palette mapping table */
 
-  if (IS_SHADED(g_ray_hit[row][col].rect))
+  if (IS_SHADED(ctx->hit[row][col].rect))
     {
-      zone = GET_ZONE(g_ray_hit[row][col].xdist, g_ray_hit[row][col].ydist);
+      zone = GET_ZONE(ctx->hit[row][col].xdist, ctx->hit[row][col].ydist);
       palptr = GET_PALPTR(zone);
     }
   else
@@ -694,29 +718,29 @@ static void trv_rend_wall(uint8_t row, uint8_t col,
   /* Calculate the horizontal interpolation values */
   /* This is the H starting position (first row, first column) */
 
-  hstart = TALIGN(g_ray_hit[row][col].xpos, scale);
+  hstart = TALIGN(ctx->hit[row][col].xpos, scale);
 
   /* This is the change in xpos per column in the first row */
 
   hcolstep =
-    TDIV((g_ray_hit[row][endcol].xpos - g_ray_hit[row][col].xpos),
+    TDIV((ctx->hit[row][endcol].xpos - ctx->hit[row][col].xpos),
       width, scale);
     
   /* Calculate the vertical interpolation values */
   /* This is the V starting position (first row, first column) */
 
-  vstart = TALIGN(g_ray_hit[row][col].ypos, scale);
+  vstart = TALIGN(ctx->hit[row][col].ypos, scale);
     
   /* This is the change in ypos per column in the first row */
 
   vcolstep =
-    TDIV((g_ray_hit[row][endcol].ypos - g_ray_hit[row][col].ypos),
+    TDIV((ctx->hit[row][endcol].ypos - ctx->hit[row][col].ypos),
       width, scale);
 
   /* This is the change in ypos per column in the last row */
 
   tmpcolstep =
-    TDIV((g_ray_hit[endrow][endcol].ypos - g_ray_hit[endrow][col].ypos),
+    TDIV((ctx->hit[endrow][endcol].ypos - ctx->hit[endrow][col].ypos),
       width, scale);
 
   /* This is the change in vcolstep per row */
@@ -726,7 +750,7 @@ static void trv_rend_wall(uint8_t row, uint8_t col,
   /* This is the change in vstart for each row */
 
   vrowstep =
-    TDIV((g_ray_hit[endrow][col].ypos - g_ray_hit[row][col].ypos),
+    TDIV((ctx->hit[endrow][col].ypos - ctx->hit[row][col].ypos),
       height, scale);
     
   /* Now, interpolate to texture each row (vertical component) */
@@ -744,6 +768,7 @@ static void trv_rend_wall(uint8_t row, uint8_t col,
         {
           /* Extract the pixel from the texture */
 
+          TRV_COUNT(ctx, fetches, 1);
           inpixel = texture[TNDX(xpos.s.i, ypos.s.i, tsize, tmask)];
 
           /* If this is an INVISIBLE_PIXEL in a TRANSPARENT_WALL, then
@@ -752,16 +777,17 @@ static void trv_rend_wall(uint8_t row, uint8_t col,
            */
 
           if ((inpixel == INVISIBLE_PIXEL) &&
-              (IS_TRANSPARENT(g_ray_hit[row][col].rect)))
+              (IS_TRANSPARENT(ctx->hit[row][col].rect)))
             {
               /* Check if we hit anything */
 
-              if ((inpixel = trv_get_texture(i, j)) != INVISIBLE_PIXEL)
+              if ((inpixel = trv_get_texture(ctx, i, j)) != INVISIBLE_PIXEL)
                 {
                   /* Map the normal pixel and transfer the pixel at this
                    * interpolated position
                    */
 
+                  TRV_COUNT(ctx, pixels, 1);
                   outpixel[j] = inpixel;
                 }
             }
@@ -771,6 +797,7 @@ static void trv_rend_wall(uint8_t row, uint8_t col,
                * interpolated position
                */
 
+              TRV_COUNT(ctx, pixels, 1);
               outpixel[j] = palptr[inpixel];
             }
 
@@ -797,7 +824,8 @@ static void trv_rend_wall(uint8_t row, uint8_t col,
 
 /* This version is for horizontal lines, i.e., height==1 and width>1 */
 
-static void trv_rend_wallrow(uint8_t row, uint8_t col, uint8_t width)
+static void trv_rend_wallrow(FAR struct trv_raycntx_s *ctx,
+                             uint8_t row, uint8_t col, uint8_t width)
 {
 #if (!DISABLE_WALL_RENDING)
   uint8_t j;
@@ -818,20 +846,20 @@ static void trv_rend_wallrow(uint8_t row, uint8_t col, uint8_t width)
 
   /* Displace the double buffer pointer */
 
-  outpixel = &g_buffer_row[row][g_cell_column];
+  outpixel = &ctx->buffer_row[row][ctx->cell_column];
 
   /* Point to the bitmap associated with the left pixel.  Since
    * all of the pixels in this row are the same "hit," we don't have
    * to recalculate this
    */
 
-  if (IS_FRONT_HIT(&g_ray_hit[row][col]))
+  if (IS_FRONT_HIT(&ctx->hit[row][col]))
     {
-      bmp = g_even_bitmaps[g_ray_hit[row][col].rect->texture];
+      bmp = g_even_bitmaps[ctx->hit[row][col].rect->texture];
     }
   else
     {
-      bmp = g_odd_bitmaps[g_ray_hit[row][col].rect->texture];
+      bmp = g_odd_bitmaps[ctx->hit[row][col].rect->texture];
     }
 
   /* Get parameters associated with the size of the bitmap texture */
@@ -842,13 +870,13 @@ static void trv_rend_wallrow(uint8_t row, uint8_t col, uint8_t width)
 
   /* Extract the texture scaling from the rectangle structure */
 
-  scale = g_ray_hit[row][col].rect->scale;
+  scale = ctx->hit[row][col].rect->scale;
 
   /* Get the a pointer to the palette mapping table */
 
-  if (IS_SHADED(g_ray_hit[row][col].rect))
+  if (IS_SHADED(ctx->hit[row][col].rect))
     {
-      zone = GET_ZONE(g_ray_hit[row][col].xdist, g_ray_hit[row][col].ydist);
+      zone = GET_ZONE(ctx->hit[row][col].xdist, ctx->hit[row][col].ydist);
       palptr = GET_PALPTR(zone);
     }
   else
@@ -869,23 +897,23 @@ static void trv_rend_wallrow(uint8_t row, uint8_t col, uint8_t width)
   /* Calculate the horizontal interpolation values */
   /* This is the H starting position (first column) */
 
-  xpos.w = TALIGN(g_ray_hit[row][col].xpos, scale);
+  xpos.w = TALIGN(ctx->hit[row][col].xpos, scale);
 
   /* This is the change in xpos per column */
 
   hcolstep =
-    TDIV((g_ray_hit[row][endcol].xpos - g_ray_hit[row][col].xpos),
+    TDIV((ctx->hit[row][endcol].xpos - ctx->hit[row][col].xpos),
       width, scale);
 
   /* Calculate the vertical interpolation values */
   /* This is the V starting position (first column) */
 
-  ypos.w = TALIGN(g_ray_hit[row][col].ypos, scale);
+  ypos.w = TALIGN(ctx->hit[row][col].ypos, scale);
     
   /* This is the change in ypos per column */
 
   vcolstep =
-    TDIV((g_ray_hit[row][endcol].ypos - g_ray_hit[row][col].ypos),
+    TDIV((ctx->hit[row][endcol].ypos - ctx->hit[row][col].ypos),
       width, scale);
     
   /* Interpolate to texture each column in the row */
@@ -894,6 +922,7 @@ static void trv_rend_wallrow(uint8_t row, uint8_t col, uint8_t width)
     {
       /* Extract the pixel from the texture */
 
+      TRV_COUNT(ctx, fetches, 1);
       inpixel = texture[TNDX(xpos.s.i, ypos.s.i, tsize, tmask)];
       
       /* If this is an INVISIBLE_PIXEL in a TRANSPARENT_WALL, then
@@ -902,16 +931,17 @@ static void trv_rend_wallrow(uint8_t row, uint8_t col, uint8_t width)
        */
 
       if ((inpixel == INVISIBLE_PIXEL) &&
-          (IS_TRANSPARENT(g_ray_hit[row][col].rect)))
+          (IS_TRANSPARENT(ctx->hit[row][col].rect)))
         {
           /* Cast another ray and see if we hit anything */
 
-          if ((inpixel = trv_get_texture(row, j)) != INVISIBLE_PIXEL)
+          if ((inpixel = trv_get_texture(ctx, row, j)) != INVISIBLE_PIXEL)
             {
               /* Map the normal pixel and transfer the pixel at this
                * interpolated position
                */
 
+              TRV_COUNT(ctx, pixels, 1);
               outpixel[j] = inpixel;
             }
         }
@@ -921,6 +951,7 @@ static void trv_rend_wallrow(uint8_t row, uint8_t col, uint8_t width)
            * interpolated position
            */
 
+          TRV_COUNT(ctx, pixels, 1);
           outpixel[j] = palptr[inpixel];
         }
 
@@ -934,7 +965,8 @@ static void trv_rend_wallrow(uint8_t row, uint8_t col, uint8_t width)
 
 /* This version is for vertical line, i.e., height>1 and width==1 */
 
-static void trv_rend_wallcol(uint8_t row, uint8_t col, uint8_t height)
+static void trv_rend_wallcol(FAR struct trv_raycntx_s *ctx,
+                             uint8_t row, uint8_t col, uint8_t height)
 {
 #if (!DISABLE_WALL_RENDING)
   uint8_t i;
@@ -954,20 +986,20 @@ static void trv_rend_wallcol(uint8_t row, uint8_t col, uint8_t height)
 
   /* Displace the double buffer pointer */
 
-  outpixel = &g_buffer_row[row][g_cell_column+col];
+  outpixel = &ctx->buffer_row[row][ctx->cell_column+col];
 
   /* Point to the bitmap associated with the upper pixel.  Since
    * all of the pixels in this cell are the same "hit," we don't have
    * to recalculate this
    */
 
-  if (IS_FRONT_HIT(&g_ray_hit[row][col]))
+  if (IS_FRONT_HIT(&ctx->hit[row][col]))
     {
-      bmp = g_even_bitmaps[g_ray_hit[row][col].rect->texture];
+      bmp = g_even_bitmaps[ctx->hit[row][col].rect->texture];
     }
   else
     {
-      bmp = g_odd_bitmaps[g_ray_hit[row][col].rect->texture];
+      bmp = g_odd_bitmaps[ctx->hit[row][col].rect->texture];
     }
 
   /* Get parameters associated with the size of the bitmap texture */
@@ -978,13 +1010,13 @@ static void trv_rend_wallcol(uint8_t row, uint8_t col, uint8_t height)
 
   /* Extract the texture scaling from the rectangle structure */
 
-  scale = g_ray_hit[row][col].rect->scale;
+  scale = ctx->hit[row][col].rect->scale;
 
   /* Get the a pointer to the palette mapping table */
 
-  if (IS_SHADED(g_ray_hit[row][col].rect))
+  if (IS_SHADED(ctx->hit[row][col].rect))
     {
-      zone = GET_ZONE(g_ray_hit[row][col].xdist, g_ray_hit[row][col].ydist);
+      zone = GET_ZONE(ctx->hit[row][col].xdist, ctx->hit[row][col].ydist);
       palptr = GET_PALPTR(zone);
     }
   else
@@ -1004,17 +1036,17 @@ static void trv_rend_wallcol(uint8_t row, uint8_t col, uint8_t height)
 
   /* Calculate the horizontal interpolation values */
 
-  xpos = sFRAC(g_ray_hit[row][col].xpos >> scale);
+  xpos = sFRAC(ctx->hit[row][col].xpos >> scale);
 
   /* Calculate the vertical interpolation values */
   /* This is the V starting position (first row, first column) */
 
-  ypos.w = TALIGN(g_ray_hit[row][col].ypos, scale);
+  ypos.w = TALIGN(ctx->hit[row][col].ypos, scale);
     
   /* This is the change in ypos for each row */
 
   vrowstep =
-    TDIV((g_ray_hit[endrow][col].ypos - g_ray_hit[row][col].ypos),
+    TDIV((ctx->hit[endrow][col].ypos - ctx->hit[row][col].ypos),
       height, scale);
 
   /* Now, interpolate to texture the vertical line */
@@ -1023,6 +1055,7 @@ static void trv_rend_wallcol(uint8_t row, uint8_t col, uint8_t height)
     {
       /* Extract the pixel from the texture */
 
+      TRV_COUNT(ctx, fetches, 1);
       inpixel = texture[TNDX(xpos, ypos.s.i, tsize, tmask)];
 
       /* If this is an INVISIBLE_PIXEL in a TRANSPARENT_WALL, then
@@ -1031,16 +1064,17 @@ static void trv_rend_wallcol(uint8_t row, uint8_t col, uint8_t height)
        */
 
       if ((inpixel == INVISIBLE_PIXEL) &&
-          (IS_TRANSPARENT(g_ray_hit[row][col].rect)))
+          (IS_TRANSPARENT(ctx->hit[row][col].rect)))
         {
           /* Check if we hit anything */
 
-          if ((inpixel = trv_get_texture(i, col)) != INVISIBLE_PIXEL)
+          if ((inpixel = trv_get_texture(ctx, i, col)) != INVISIBLE_PIXEL)
             {
               /* Map the normal pixel and transfer the pixel at this
                * interpolated position
                */
 
+              TRV_COUNT(ctx, pixels, 1);
               *outpixel = inpixel;
             }
         }
@@ -1050,6 +1084,7 @@ static void trv_rend_wallcol(uint8_t row, uint8_t col, uint8_t height)
            * interpolated position
            */
 
+          TRV_COUNT(ctx, pixels, 1);
           *outpixel = palptr[inpixel];
         }
 
@@ -1066,7 +1101,8 @@ static void trv_rend_wallcol(uint8_t row, uint8_t col, uint8_t height)
 
 /* This version is for a single pixel, i.e., height==1 and width==1 */
 
-static void trv_rend_wallpixel(uint8_t row, uint8_t col)
+static void trv_rend_wallpixel(FAR struct trv_raycntx_s *ctx,
+                               uint8_t row, uint8_t col)
 {
 #if (!DISABLE_WALL_RENDING)
   uint8_t *palptr;
@@ -1074,9 +1110,9 @@ static void trv_rend_wallpixel(uint8_t row, uint8_t col)
 
   /* Get the a pointer to the palette mapping table */
 
-  if (IS_SHADED(g_ray_hit[row][col].rect))
+  if (IS_SHADED(ctx->hit[row][col].rect))
     {
-      zone = GET_ZONE(g_ray_hit[row][col].xdist, g_ray_hit[row][col].ydist);
+      zone = GET_ZONE(ctx->hit[row][col].xdist, ctx->hit[row][col].ydist);
       palptr = GET_PALPTR(zone);
     }
   else
@@ -1086,19 +1122,22 @@ static void trv_rend_wallpixel(uint8_t row, uint8_t col)
 
   /* The map and transfer the pixel to the display buffer */
 
-  if (IS_FRONT_HIT(&g_ray_hit[row][col]))
+  TRV_COUNT(ctx, fetches, 1);
+  TRV_COUNT(ctx, pixels, 1);
+
+  if (IS_FRONT_HIT(&ctx->hit[row][col]))
     {
-      g_buffer_row[row][g_cell_column+col] =
-        palptr[GET_FRONT_PIXEL(g_ray_hit[row][col].rect,
-                               g_ray_hit[row][col].xpos,
-                               g_ray_hit[row][col].ypos)];
+      ctx->buffer_row[row][ctx->cell_column+col] =
+        palptr[GET_FRONT_PIXEL(ctx->hit[row][col].rect,
+                               ctx->hit[row][col].xpos,
+                               ctx->hit[row][col].ypos)];
     }
   else
     {
-      g_buffer_row[row][g_cell_column+col] =
-        palptr[GET_BACK_PIXEL(g_ray_hit[row][col].rect,
-                              g_ray_hit[row][col].xpos,
-                              g_ray_hit[row][col].ypos)];
+      ctx->buffer_row[row][ctx->cell_column+col] =
+        palptr[GET_BACK_PIXEL(ctx->hit[row][col].rect,
+                              ctx->hit[row][col].xpos,
+                              ctx->hit[row][col].ypos)];
     }
 #endif
 }
@@ -1221,92 +1260,95 @@ void trv_rend_backdrop(FAR struct trv_camera_s *camera,
 
 /* This version is for non-degenerate cell, i.e., height>1 and width>1 */
 
-void trv_rend_cell(uint8_t row, uint8_t col, uint8_t height, uint8_t width)
+void trv_rend_cell(FAR struct trv_raycntx_s *ctx, uint8_t row, uint8_t col,
+                   uint8_t height, uint8_t width)
 {
   /* If the cell is visible, then put it in the off-screen buffer.
    * Otherwise, just drop it on the floor
    */
 
-  if (g_ray_hit[row][col].rect)
+  if (ctx->hit[row][col].rect)
     {
       /* Apply texturing... special case for hits on floor or ceiling */
 
-      if (IS_ZRAY_HIT(&g_ray_hit[row][col]))
+      if (IS_ZRAY_HIT(&ctx->hit[row][col]))
         {
-          trv_rend_zcell(row, col, height, width);
+          trv_rend_zcell(ctx, row, col, height, width);
         }
       else
         {
-          trv_rend_wall(row, col, height, width);
+          trv_rend_wall(ctx, row, col, height, width);
         }
     }
 }
 
 /* This version is for horizontal lines, i.e., height==1 and width>1 */
 
-void trv_rend_row(uint8_t row, uint8_t col, uint8_t width)
+void trv_rend_row(FAR struct trv_raycntx_s *ctx, uint8_t row, uint8_t col,
+                  uint8_t width)
 {
   /* If the cell is visible, then put it in the off-screen buffer.
    * Otherwise, just drop it on the floor
    */
 
-  if (g_ray_hit[row][col].rect)
+  if (ctx->hit[row][col].rect)
     {
       /* Apply texturing... special case for hits on floor or ceiling */
 
-      if (IS_ZRAY_HIT(&g_ray_hit[row][col]))
+      if (IS_ZRAY_HIT(&ctx->hit[row][col]))
         {
-          trv_rend_zrow(row, col, width);
+          trv_rend_zrow(ctx, row, col, width);
         }
       else
         {
-          trv_rend_wallrow(row, col, width);
+          trv_rend_wallrow(ctx, row, col, width);
         }
     }
 }
 
 /* This version is for vertical lines, i.e., height>1 and width==1 */
 
-void trv_rend_column(uint8_t row, uint8_t col, uint8_t height)
+void trv_rend_column(FAR struct trv_raycntx_s *ctx, uint8_t row, uint8_t col,
+                     uint8_t height)
 {
   /* If the cell is visible, then put it in the off-screen buffer.
    * Otherwise, just drop it on the floor
    */
 
-  if (g_ray_hit[row][col].rect)
+  if (ctx->hit[row][col].rect)
     {
       /* Apply texturing... special case for hits on floor or ceiling */
 
-      if (IS_ZRAY_HIT(&g_ray_hit[row][col]))
+      if (IS_ZRAY_HIT(&ctx->hit[row][col]))
         {
-          trv_rend_zcol(row, col, height);
+          trv_rend_zcol(ctx, row, col, height);
         }
       else
         {
-          trv_rend_wallcol(row, col, height);
+          trv_rend_wallcol(ctx, row, col, height);
         }
     }
 }
 
 /* This version is for a single pixel, i.e., height==1 and width==1 */
 
-void trv_rend_pixel(uint8_t row, uint8_t col)
+void trv_rend_pixel(FAR struct trv_raycntx_s *ctx, uint8_t row, uint8_t col)
 {
   /* If the cell is visible, then put it in the off-screen buffer.
    * Otherwise, just drop it on the floor
    */
 
-  if (g_ray_hit[row][col].rect)
+  if (ctx->hit[row][col].rect)
     {
       /* Apply texturing... special case for hits on floor or ceiling */
 
-      if (IS_ZRAY_HIT(&g_ray_hit[row][col]))
+      if (IS_ZRAY_HIT(&ctx->hit[row][col]))
         {
-          trv_rend_zpixel(row, col);
+          trv_rend_zpixel(ctx, row, col);
         }
       else
         {
-          trv_rend_wallpixel(row, col);
+          trv_rend_wallpixel(ctx, row, col);
         }
     }
 }
@@ -0,0 +1,198 @@
+/****************************************************************************
+ * apps/graphics/traveler/src/trv_script.c
+ * This file contains the logic to record and replay scripts of player
+ * input.
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included files
+ ****************************************************************************/
+
+#include "trv_types.h"
+#include "trv_main.h"
+#include "trv_debug.h"
+#include "trv_input.h"
+#include "trv_script.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef CONFIG_GRAPHICS_TRAVELER_SCRIPT
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Each line of a script holds the input for one frame:
+ *
+ *   <fwdrate> <leftrate> <yawrate> <pitchrate> <stepheight> <dooropen>
+ *
+ * Blank lines and lines beginning with '#' are ignored.
+ */
+
+#define SCRIPT_LINESIZE 80
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static FILE *g_script_stream;  /* The open script file */
+static bool g_script_record;   /* True: Recording, false: replaying */
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: trv_script_open
+ *
+ * Description:
+ *   Open a script file.  If 'record' is true, then the script is created
+ *   and each input sample will be written to it.  Otherwise, the input
+ *   will be taken from the script instead of from the input device.
+ *
+ ***************************************************************************/
+
+int trv_script_open(FAR const char *path, bool record)
+{
+  trv_script_close();
+
+  g_script_stream = fopen(path, record ? "w" : "r");
+  if (!g_script_stream)
+    {
+      int errcode = errno;
+      fprintf(stderr, "ERROR: Failed to open script %s: %d\n",
+              path, errcode);
+      return -errcode;
+    }
+
+  g_script_record = record;
+  if (record)
+    {
+      fprintf(g_script_stream,
+              "# fwdrate leftrate yawrate pitchrate stepheight dooropen\n");
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: trv_script_replay
+ *
+ * Description:
+ *   If a script is being replayed, then return the next input sample from
+ *   the script and return true.  When the end of the script is reached,
+ *   the input is cleared and the terminate flag is set.  If no script is
+ *   being replayed, false is returned.
+ *
+ ***************************************************************************/
+
+bool trv_script_replay(FAR struct trv_input_s *input)
+{
+  char line[SCRIPT_LINESIZE];
+  int fwdrate;
+  int leftrate;
+  int yawrate;
+  int pitchrate;
+  int stepheight;
+  int dooropen;
+
+  if (!g_script_stream || g_script_record)
+    {
+      return false;
+    }
+
+  while (fgets(line, SCRIPT_LINESIZE, g_script_stream))
+    {
+      if (sscanf(line, "%d %d %d %d %d %d", &fwdrate, &leftrate, &yawrate,
+                 &pitchrate, &stepheight, &dooropen) == 6)
+        {
+          input->fwdrate    = fwdrate;
+          input->leftrate   = leftrate;
+          input->yawrate    = yawrate;
+          input->pitchrate  = pitchrate;
+          input->stepheight = stepheight;
+          input->dooropen   = (dooropen != 0);
+          return true;
+        }
+      else if (line[0] != '#' && line[0] != '\n')
+        {
+          trv_debug("Bad script line: %s", line);
+        }
+    }
+
+  /* End of script */
+
+  memset(input, 0, sizeof(struct trv_input_s));
+  g_trv_terminate = true;
+  return true;
+}
+
+/****************************************************************************
+ * Name: trv_script_record
+ *
+ * Description:
+ *   If a script is being recorded, then add one input sample to it.
+ *
+ ***************************************************************************/
+
+void trv_script_record(FAR const struct trv_input_s *input)
+{
+  if (g_script_stream && g_script_record)
+    {
+      fprintf(g_script_stream, "%d %d %d %d %d %d\n",
+              input->fwdrate, input->leftrate, input->yawrate,
+              input->pitchrate, input->stepheight, input->dooropen ? 1 : 0);
+    }
+}
+
+/****************************************************************************
+ * Name: trv_script_close
+ *
+ * Description:
+ *   Close any open script file
+ *
+ ***************************************************************************/
+
+void trv_script_close(void)
+{
+  if (g_script_stream)
+    {
+      fclose(g_script_stream);
+      g_script_stream = NULL;
+    }
+}
+
+#endif /* CONFIG_GRAPHICS_TRAVELER_SCRIPT */
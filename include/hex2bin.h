@@ -42,7 +42,9 @@
 
 #include <nuttx/config.h>
 
+#include <sys/types.h>
 #include <stdint.h>
+#include <stdio.h>
 
 #ifdef CONFIG_SYSTEM_HEX2BIN
 
@@ -63,6 +65,14 @@
 #  define CONFIG_SYSTEM_HEX2BIN_SWAP 0
 #endif
 
+/* Size of the input buffer and of the buffer in which contiguous records
+ * are merged before they are written.
+ */
+
+#ifndef CONFIG_SYSTEM_HEX2BIN_BUFSIZE
+#  define CONFIG_SYSTEM_HEX2BIN_BUFSIZE 512
+#endif
+
 /* Some environments may return CR as end-of-line, others LF, and others
  * both.  If not specified, the logic here assumes either (but not both) as
  * the default.
@@ -121,6 +131,30 @@ enum hex2bin_swap_e
   HEX2BIN_SWAP32 = 2  /* Swap bytes in 32-bit values */
 };
 
+/* Block input and output for hex2bin_io().
+ *
+ *   read     - Read up to buflen bytes of HEX data into buffer.  Returns
+ *              the number of bytes read, zero at the end of the input, or
+ *              a negated errno value.  Returning less than buflen is fine;
+ *              an interactive source should return each line as it
+ *              arrives.
+ *   write    - Write len bytes of binary data at offset bytes from the base
+ *              address.  Returns zero (OK) or a negated errno value.
+ *   readback - Used only with a block size.  Read the current contents of
+ *              the block at offset, which may have been written already,
+ *              into data.  Returns zero (OK) or a negated errno value.  May
+ *              be NULL if the HEX data is known to be in address order.
+ */
+
+struct hex2bin_ops_s
+{
+  CODE ssize_t (*read)(FAR void *arg, FAR uint8_t *buffer, size_t buflen);
+  CODE int (*write)(FAR void *arg, uint32_t offset, FAR const uint8_t *data,
+                    size_t len);
+  CODE int (*readback)(FAR void *arg, uint32_t offset, FAR uint8_t *data,
+                       size_t len);
+};
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -173,6 +207,47 @@ int hex2bin(FAR struct lib_instream_s *instream,
             FAR struct lib_sostream_s *outstream, uint32_t baseaddr,
             uint32_t endpaddr, enum hex2bin_swap_e swap);
 
+/****************************************************************************
+ * Name: hex2bin_io
+ *
+ * Description:
+ *   Like hex2bin(), but the HEX data is read and the binary is written in
+ *   blocks through the callbacks in 'ops'.
+ *
+ *   Data records that follow each other in the address space are merged
+ *   before they reach ops->write().  If blocksize is zero, each write is a
+ *   run of contiguous data of up to CONFIG_SYSTEM_HEX2BIN_BUFSIZE bytes.
+ *   Otherwise every write is exactly one blocksize-aligned block of
+ *   blocksize bytes (a FLASH program page, for example); bytes of the
+ *   block not covered by the HEX data are set to 'fill'.  A block is
+ *   written when the data moves past it.
+ *
+ *   HEX data need not be in address order.  When a record goes back to a
+ *   block below the highest block written so far, that block is read
+ *   back with ops->readback() and written again with the new data merged
+ *   in; earlier data in the block is kept.  Without ops->readback(), such
+ *   a record fails with -EINVAL.
+ *
+ * Input Parameters:
+ *   ops       - Block read and write callbacks.
+ *   arg       - Passed to the callbacks.
+ *   baseaddr  - The HEX address that corresponds to output offset zero.
+ *   endpaddr  - The end address (plus 1) of the output, or zero to disable
+ *               range checking.
+ *   blocksize - Write granularity in bytes, or zero.
+ *   fill      - Value of bytes in a block that are not in the HEX data.
+ *   swap      - Controls byte ordering.  See enum hex2bin_swap_e.
+ *
+ * Returned Value
+ *   Zero (OK) is returned on success; a negated errno value is returned on
+ *   failure.
+ *
+ ****************************************************************************/
+
+int hex2bin_io(FAR const struct hex2bin_ops_s *ops, FAR void *arg,
+               uint32_t baseaddr, uint32_t endpaddr, uint16_t blocksize,
+               uint8_t fill, enum hex2bin_swap_e swap);
+
 /****************************************************************************
  * Name hex2mem
  *
@@ -227,6 +302,44 @@ int hex2mem(int fd, uint32_t baseaddr, uint32_t endpaddr,
 int fhex2mem(FAR FILE *instream, uint32_t baseaddr, uint32_t endpaddr,
              enum hex2bin_swap_e swap);
 
+/****************************************************************************
+ * Name hex2mtd
+ *
+ * Description:
+ *   Read the Intel HEX ASCII data provided on the file descriptor 'fd' and
+ *   program it into an MTD device.  Data is written one program block
+ *   (geometry blocksize) at a time; each erase block is erased before the
+ *   first write to it.  Parts of a written block not covered by the HEX
+ *   data are left in the erased (0xff) state.
+ *
+ *   HEX data that is not in address order is supported but slow.  A
+ *   block that is written again is merged with what was programmed
+ *   before.  Its whole erase block is then read into memory, erased, and
+ *   programmed again, because a FLASH block may not be programmed twice.
+ *
+ * Input Parameters:
+ *   fd        - The file descriptor from which Intel HEX data will be
+ *               received.
+ *   mtd       - The MTD device to program.
+ *   baseaddr  - The HEX address that corresponds to offset zero of the
+ *               device.
+ *   endpaddr  - The end address (plus 1), or zero for the end of the
+ *               device.
+ *   swap      - Controls byte ordering.  See enum hex2bin_swap_e for
+ *               description of the values.
+ *
+ * Returned Value
+ *   Zero (OK) is returned on success; a negated errno value is returned on
+ *   failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD
+struct mtd_dev_s;
+int hex2mtd(int fd, FAR struct mtd_dev_s *mtd, uint32_t baseaddr,
+            uint32_t endpaddr, enum hex2bin_swap_e swap);
+#endif
+
 /****************************************************************************
  * Name: hex2bin_main
  *
@@ -130,6 +130,38 @@ long inifile_read_integer(INIHANDLE handle,
 
 void inifile_free_string(FAR char *value);
 
+#ifdef CONFIG_SYSTEM_INIFILE_CACHE
+/****************************************************************************
+ * Name: inifile_get_string
+ *
+ * Description:
+ *   Obtains the specified string value for the specified variable name
+ *   within the specified section of the INI file.  Unlike
+ *   inifile_read_string(), no copy of the string is made.  The returned
+ *   string belongs to the INI file cache and is valid only until the next
+ *   call to inifile_reload() or inifile_uninitialize().
+ *
+ ****************************************************************************/
+
+FAR const char *inifile_get_string(INIHANDLE handle,
+                                   FAR const char *section,
+                                   FAR const char *variable,
+                                   FAR const char *defvalue);
+
+/****************************************************************************
+ * Name: inifile_reload
+ *
+ * Description:
+ *   Re-read the INI file if it has been modified since it was last read.
+ *   Returns 1 if the file was re-read, 0 if the file is unchanged, or a
+ *   negated errno value on failure.  On failure, the previous contents of
+ *   the cache are retained.
+ *
+ ****************************************************************************/
+
+int inifile_reload(INIHANDLE handle);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -277,10 +277,8 @@ eMBErrorCode eMBSetSlaveID(uint8_t ucSlaveID, bool xIsRunning,
  *     for this function code is removed.
  *
  * Returned Value:
- *   eMBErrorCode::MB_ENOERR if the handler has been installed. If no
- *   more resources are available it returns eMBErrorCode::MB_ENORES. In this
- *   case the values in config.h should be adjusted. If the argument was not
- *   valid it returns eMBErrorCode::MB_EINVAL.
+ *   eMBErrorCode::MB_ENOERR if the handler has been installed. If the
+ *   argument was not valid it returns eMBErrorCode::MB_EINVAL.
  */
 eMBErrorCode eMBRegisterCB(uint8_t ucFunctionCode,
                            pxMBFunctionHandler pxHandler);
@@ -0,0 +1,254 @@
+/****************************************************************************
+ * apps/include/modbus/mbmaster.h
+ * Asynchronous Modbus RTU master
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_INCLUDE_MODBUS_MBMASTER_H
+#define __APPS_INCLUDE_MODBUS_MBMASTER_H
+
+/* This is an event driven Modbus RTU master that does not use the global
+ * state of the FreeModBus stack.  Each struct mbmaster_s instance owns one
+ * serial port, so several buses can be served at the same time, e.g. from
+ * one task:
+ *
+ *   static struct mbmaster_s g_bus1, g_bus2;
+ *   FAR struct mbmaster_s *masters[2] = { &g_bus1, &g_bus2 };
+ *
+ *   eMBMasterAsyncInit(&g_bus1, "/dev/ttyS1", 115200, MB_PAR_EVEN);
+ *   eMBMasterAsyncInit(&g_bus2, "/dev/ttyS2", 115200, MB_PAR_EVEN);
+ *
+ *   eMBMasterAsyncReadHolding(&g_bus1, 12, 100, 4, temp_done, NULL);
+ *   eMBMasterAsyncReadHolding(&g_bus1, 12, 104, 2, flow_done, NULL);
+ *   ...
+ *   for (;;)
+ *     {
+ *       iMBMasterAsyncPoll(masters, 2, 1000);
+ *     }
+ *
+ * Requests are queued and completed through a callback.  Queued reads of
+ * the same slave and function whose register ranges overlap, touch or are
+ * at most usMaxGap registers apart are sent as one read of up to 125
+ * registers; each callback gets its own part of the result.  Pending
+ * requests are served round-robin by slave address so that a slave with
+ * many requests does not delay the others.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <termios.h>
+
+#include "mb.h"
+#include "mb_m.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_MB_MASTER_ASYNC_NREQUESTS
+#  define CONFIG_MB_MASTER_ASYNC_NREQUESTS 32
+#endif
+
+#ifndef CONFIG_MB_MASTER_ASYNC_TIMEOUT
+#  define CONFIG_MB_MASTER_ASYNC_TIMEOUT 100
+#endif
+
+#ifndef CONFIG_MB_MASTER_ASYNC_MAXGAP
+#  define CONFIG_MB_MASTER_ASYNC_MAXGAP 0
+#endif
+
+#define MB_MASTER_ASYNC_MAXPOLL  8     /* Masters per iMBMasterAsyncPoll() */
+#define MB_MASTER_ASYNC_MAXREGS  125   /* Registers per read request */
+#define MB_MASTER_ASYNC_ADU_SIZE 256   /* Maximum RTU frame size */
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Completion callback.  eStatus is MB_MRE_NO_ERR on success,
+ * MB_MRE_EXE_FUN if the slave answered with an exception, MB_MRE_TIMEDOUT
+ * if it did not answer and MB_MRE_REV_DATA if the answer was corrupted.
+ * For reads, pusRegs holds the usNRegs register values that were
+ * requested; it is only valid during the callback.  For writes it is NULL.
+ * The callback may queue new requests.
+ */
+
+typedef void (*pvMBMasterAsyncCB)(FAR void *pvArg,
+                                  eMBMasterReqErrCode eStatus,
+                                  FAR const uint16_t *pusRegs,
+                                  uint16_t usNRegs);
+
+/* One queued request */
+
+struct mbmaster_req_s
+{
+  uint8_t  ucState;                 /* Free, queued or in the active frame */
+  uint8_t  ucSlave;                 /* Slave address */
+  uint8_t  ucFunction;              /* Modbus function code */
+  bool     bNoMerge;                /* Must be sent on its own */
+  uint16_t usRegAddr;               /* First register (zero based) */
+  uint16_t usNRegs;                 /* Number of registers */
+  uint32_t ulSeq;                   /* Queue order */
+  FAR const uint16_t *pusValues;    /* Values to write */
+  pvMBMasterAsyncCB pvCallback;
+  FAR void *pvArg;
+};
+
+/* One master, i.e. one serial bus.  The fields after 'fd' are private. */
+
+struct mbmaster_s
+{
+  uint16_t usTimeoutMs;             /* Response timeout */
+  uint16_t usMaxGap;                /* Largest gap bridged when merging */
+  int      fd;                      /* Serial port */
+
+  uint8_t  ucState;                 /* Idle or waiting for a response */
+  uint8_t  ucNextSlave;             /* Round-robin position */
+  uint8_t  ucSlave;                 /* The active frame */
+  uint8_t  ucFunction;
+  uint16_t usRegAddr;
+  uint16_t usNRegs;
+  uint16_t usRxLen;
+  uint32_t ulT35;                   /* Inter-frame delay (usec) */
+  uint32_t ulDeadline;              /* Response deadline (usec) */
+  uint32_t ulIdleUntil;             /* Earliest time to send (usec) */
+  uint32_t ulSeq;
+  uint32_t ulFrames;                /* Frames sent (statistics) */
+
+  uint8_t  aucBuf[MB_MASTER_ASYNC_ADU_SIZE];
+  uint16_t ausRegs[MB_MASTER_ASYNC_MAXREGS];
+  struct mbmaster_req_s axReqs[CONFIG_MB_MASTER_ASYNC_NREQUESTS];
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Description:
+ *   Open and configure the serial port of a master instance.  The
+ *   response timeout and the merge gap are initialized from
+ *   CONFIG_MB_MASTER_ASYNC_TIMEOUT and CONFIG_MB_MASTER_ASYNC_MAXGAP and
+ *   may be changed afterwards.
+ *
+ * Returned Value:
+ *   MB_ENOERR on success or MB_EPORTERR if the port could not be opened.
+ *
+ ****************************************************************************/
+
+eMBErrorCode eMBMasterAsyncInit(FAR struct mbmaster_s *pxMaster,
+                                FAR const char *pcDevice,
+                                speed_t ulBaudRate, eMBParity eParity);
+
+/****************************************************************************
+ * Description:
+ *   Close the serial port.  Requests that are still queued are completed
+ *   with MB_MRE_MASTER_BUSY.
+ *
+ ****************************************************************************/
+
+void vMBMasterAsyncClose(FAR struct mbmaster_s *pxMaster);
+
+/****************************************************************************
+ * Description:
+ *   Queue a read of usNRegs (1-125) holding or input registers.
+ *
+ * Returned Value:
+ *   MB_ENOERR if the request was queued, MB_EINVAL if an argument is out
+ *   of range or MB_ENORES if the queue is full.
+ *
+ ****************************************************************************/
+
+eMBErrorCode eMBMasterAsyncReadHolding(FAR struct mbmaster_s *pxMaster,
+                                       uint8_t ucSlave, uint16_t usRegAddr,
+                                       uint16_t usNRegs,
+                                       pvMBMasterAsyncCB pvCallback,
+                                       FAR void *pvArg);
+eMBErrorCode eMBMasterAsyncReadInput(FAR struct mbmaster_s *pxMaster,
+                                     uint8_t ucSlave, uint16_t usRegAddr,
+                                     uint16_t usNRegs,
+                                     pvMBMasterAsyncCB pvCallback,
+                                     FAR void *pvArg);
+
+/****************************************************************************
+ * Description:
+ *   Queue a write of usNRegs (1-123) holding registers.  A single register
+ *   is written with function 6, more with function 16.  pusValues must
+ *   stay valid until the callback is called.  Slave address 0 broadcasts
+ *   the write; it completes as soon as the frame was sent, and the next
+ *   request follows after the response timeout.
+ *
+ ****************************************************************************/
+
+eMBErrorCode eMBMasterAsyncWriteHolding(FAR struct mbmaster_s *pxMaster,
+                                        uint8_t ucSlave, uint16_t usRegAddr,
+                                        uint16_t usNRegs,
+                                        FAR const uint16_t *pusValues,
+                                        pvMBMasterAsyncCB pvCallback,
+                                        FAR void *pvArg);
+
+/****************************************************************************
+ * Description:
+ *   Run the masters: send queued requests, receive responses and call the
+ *   completion callbacks.  Waits at most iTimeoutMs for something to
+ *   happen.  At most MB_MASTER_ASYNC_MAXPOLL masters can be passed.
+ *
+ * Returned Value:
+ *   The number of requests that are still queued or in progress on all
+ *   masters, or -1 with errno set on failure.
+ *
+ ****************************************************************************/
+
+int iMBMasterAsyncPoll(FAR struct mbmaster_s **ppxMasters, int nMasters,
+                       int iTimeoutMs);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __APPS_INCLUDE_MODBUS_MBMASTER_H */
@@ -108,6 +108,17 @@ extern bool(*pxMBFrameCBByteReceived)(void);
 extern bool(*pxMBFrameCBTransmitterEmpty)(void);
 extern bool(*pxMBPortCBTimerExpired)(void);
 
+#ifdef CONFIG_MB_RTU_FRAMEMODE
+/* Callback function for the porting layer when a complete frame is
+ * available, i.e. no character was received for t3.5 after the last one.
+ * If this is not NULL it is used instead of pxMBFrameCBByteReceived() and
+ * frames are sent with xMBPortSerialPutFrame().
+ */
+
+extern bool(*pxMBFrameCBFrameReceived)(const uint8_t *pucFrame,
+                                       uint16_t usLength);
+#endif
+
 extern bool(*pxMBMasterFrameCBByteReceived)(void);
 extern bool(*pxMBMasterFrameCBTransmitterEmpty)(void);
 extern bool(*pxMBMasterPortCBTimerExpired)(void);
@@ -138,6 +149,9 @@ void xMBPortSerialClose(void);
 void vMBPortSerialEnable(bool xRxEnable, bool xTxEnable);
 bool xMBPortSerialGetByte(int8_t * pucByte);
 bool xMBPortSerialPutByte(int8_t ucByte);
+#ifdef CONFIG_MB_RTU_FRAMEMODE
+bool xMBPortSerialPutFrame(const uint8_t *pucFrame, uint16_t usLength);
+#endif
 
 bool xMBMasterPortSerialInit(uint8_t ucPort, speed_t ulBaudRate,
                              uint8_t ucDataBits, eMBParity eParity);
@@ -0,0 +1,154 @@
+/****************************************************************************
+ * apps/include/modbus/mbregmap.h
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_INCLUDE_MODBUS_MBREGMAP_H
+#define __APPS_INCLUDE_MODBUS_MBREGMAP_H
+
+/* Register map backend for the Modbus slave.
+ *
+ * With CONFIG_MB_REGMAP the library provides eMBRegInputCB(),
+ * eMBRegHoldingCB(), eMBRegCoilsCB() and eMBRegDiscreteCB() itself.  The
+ * application registers one contiguous array per register class instead
+ * and the requests are served by bounds checked bulk copies into and out
+ * of the frame buffer.
+ *
+ * Registers are held in native uint16_t arrays.  Coils and discrete
+ * inputs are held packed, eight per byte, with the first one in the LSB
+ * of the first byte.  Addresses use the numbering of the callbacks in
+ * mb.h, i.e. the protocol address plus one.
+ *
+ * Input registers and discrete inputs are written by the application.
+ * When a second buffer is registered for them, the application updates
+ * one buffer while eMBPoll() serves the other: pvMBRegMapBeginUpdate()
+ * returns the back buffer and vMBRegMapCommit() publishes it.  Neither
+ * side ever waits for the other.  Without a second buffer a request that
+ * overlaps an update is answered with SLAVE DEVICE BUSY.
+ *
+ * Holding registers and coils are written by the master.  The
+ * application may set their initial values before eMBEnable() and may
+ * change them from the thread that calls eMBPoll().  Other threads read
+ * them with eMBRegMapRead().
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+
+#include "mb.h"
+
+#ifdef __cplusplus
+PR_BEGIN_EXTERN_C
+#endif
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+typedef enum
+{
+  MB_REGMAP_COILS,            /* Coils, set by the master */
+  MB_REGMAP_DISCRETE,         /* Discrete inputs, set by the application */
+  MB_REGMAP_HOLDING,          /* Holding registers, set by the master */
+  MB_REGMAP_INPUT,            /* Input registers, set by the application */
+  MB_REGMAP_NCLASSES
+} eMBRegMapClass;
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/* Register the array that backs a register class.
+ *
+ * Input Parameters:
+ *   eClass The register class.
+ *   usAddress The address of the first register, coil or input.
+ *   usCount The number of registers, coils or inputs in the array.
+ *   pvBuffer The array: usCount uint16_t values for registers or
+ *     (usCount + 7) / 8 bytes for coils and discrete inputs.  NULL removes
+ *     the mapping of the class.
+ *   pvBackBuffer A second array of the same size for double buffering.
+ *     Only allowed for MB_REGMAP_DISCRETE and MB_REGMAP_INPUT, otherwise
+ *     NULL.  It is initialized from pvBuffer.
+ *
+ * Returned Value:
+ *   MB_ENOERR on success or MB_EINVAL if an argument is not valid.
+ *
+ * Assumptions:
+ *   Called before eMBEnable() or while the stack is disabled.
+ */
+
+eMBErrorCode eMBRegMapRegister(eMBRegMapClass eClass, uint16_t usAddress,
+                               uint16_t usCount, FAR void *pvBuffer,
+                               FAR void *pvBackBuffer);
+
+/* Start an update of input registers or discrete inputs.
+ *
+ * Returns the buffer to modify.  It holds the values currently served to
+ * the master.  The changes become visible to the master all at once when
+ * vMBRegMapCommit() is called.  Only one thread may update a class.
+ *
+ * Returned Value:
+ *   The array that was registered for the class, or NULL if the class is
+ *   not mapped or is written by the master.
+ */
+
+FAR void *pvMBRegMapBeginUpdate(eMBRegMapClass eClass);
+
+/* Publish the values written after pvMBRegMapBeginUpdate(). */
+
+void vMBRegMapCommit(eMBRegMapClass eClass);
+
+/* Take a consistent copy of part of a register class.
+ *
+ * This may be called from any thread.  Bits are copied packed, starting
+ * at the LSB of the first byte of pvDest.
+ *
+ * Returned Value:
+ *   MB_ENOERR on success, MB_ENOREG if the range is not mapped or
+ *   MB_ETIMEDOUT if the values kept changing while they were copied.
+ */
+
+eMBErrorCode eMBRegMapRead(eMBRegMapClass eClass, uint16_t usAddress,
+                           uint16_t usCount, FAR void *pvDest);
+
+#ifdef __cplusplus
+PR_END_EXTERN_C
+#endif
+
+#endif /* __APPS_INCLUDE_MODBUS_MBREGMAP_H */
@@ -58,11 +58,50 @@
 
 #include <nuttx/config.h>
 
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Worst case output of one base64_encode_update() call for len input
+ * bytes, and of base64_encode_final().
+ */
+
+#define BASE64_ENCODE_UPDATE_MAX(len) (((len) + 2) / 3 * 4)
+#define BASE64_ENCODE_FINAL_MAX       4
+
+/* Worst case output of one base64_decode_update() call for len input
+ * characters, and of base64_decode_final().
+ */
+
+#define BASE64_DECODE_UPDATE_MAX(len) (((len) + 3) * 3 / 4)
+#define BASE64_DECODE_FINAL_MAX       2
+
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* State of a streaming encode or decode.  Input may be supplied in chunks
+ * of any size; bytes (or characters) that do not complete a quantum are
+ * carried over to the next call.
+ */
+
+struct base64_ctx_s
+{
+  uint32_t bits;                /* Carried over input, right aligned */
+  uint8_t  npending;            /* Bytes (encode) or sextets (decode) held */
+  bool     websafe;             /* "-_" alphabet and '.' padding */
+  bool     done;                /* Decoder has seen padding */
+};
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -76,6 +115,42 @@ unsigned char *base64w_encode(const unsigned char *src, size_t len,
                               unsigned char *dst, size_t *out_len);
 unsigned char *base64w_decode(const unsigned char *src, size_t len,
                               unsigned char *dst, size_t *out_len);
+
+/****************************************************************************
+ * Name: base64_encode_init, base64_encode_update, base64_encode_final
+ *
+ * Description:
+ *   Streaming base64 encoder.  Each call returns the number of characters
+ *   written to dst; no NUL terminator is added.  dst must have room for
+ *   BASE64_ENCODE_UPDATE_MAX(len) or BASE64_ENCODE_FINAL_MAX characters.
+ *   base64_encode_final() writes the last, padded quantum.
+ *
+ ****************************************************************************/
+
+void base64_encode_init(FAR struct base64_ctx_s *ctx, bool websafe);
+size_t base64_encode_update(FAR struct base64_ctx_s *ctx,
+                            FAR const uint8_t *src, size_t len,
+                            FAR char *dst);
+size_t base64_encode_final(FAR struct base64_ctx_s *ctx, FAR char *dst);
+
+/****************************************************************************
+ * Name: base64_decode_init, base64_decode_update, base64_decode_final
+ *
+ * Description:
+ *   Streaming base64 decoder.  Characters outside the alphabet (line
+ *   breaks, blanks) are skipped.  Padding ends the data; anything after it
+ *   is ignored.  Each call returns the number of bytes written to dst,
+ *   which must have room for BASE64_DECODE_UPDATE_MAX(len) or
+ *   BASE64_DECODE_FINAL_MAX bytes.  base64_decode_final() flushes a last
+ *   quantum that was not padded.
+ *
+ ****************************************************************************/
+
+void base64_decode_init(FAR struct base64_ctx_s *ctx, bool websafe);
+size_t base64_decode_update(FAR struct base64_ctx_s *ctx,
+                            FAR const char *src, size_t len,
+                            FAR uint8_t *dst);
+size_t base64_decode_final(FAR struct base64_ctx_s *ctx, FAR uint8_t *dst);
 #endif /* CONFIG_CODECS_BASE64 */
 
 #ifdef __cplusplus
@@ -0,0 +1,213 @@
+/****************************************************************************
+ * apps/include/netutils/hash.h
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_INCLUDE_NETUTILS_HASH_H
+#define __APPS_INCLUDE_NETUTILS_HASH_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+
+#ifdef CONFIG_CODECS_HASH_MD5
+#  include <apps/netutils/md5.h>
+#endif
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define HASH_MAX_DIGESTSIZE 32  /* SHA-256 */
+#define HASH_BLOCKSIZE      64  /* Block size of MD5, SHA-1 and SHA-256 */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+#ifdef CONFIG_CODECS_HASH_SHA1
+struct sha1_ctx_s
+{
+  uint32_t state[5];
+  uint32_t count[2];            /* Bytes hashed, low word first */
+  uint8_t  buffer[HASH_BLOCKSIZE];
+};
+#endif
+
+#ifdef CONFIG_CODECS_HASH_SHA256
+struct sha256_ctx_s
+{
+  uint32_t state[8];
+  uint32_t count[2];            /* Bytes hashed, low word first */
+  uint8_t  buffer[HASH_BLOCKSIZE];
+};
+#endif
+
+/* The state of a streaming hash computation.  Select the algorithm with
+ * hash_init(), feed the data in pieces of any size with hash_update() and
+ * collect the digest with hash_final().
+ */
+
+struct hash_algorithm_s;
+
+struct hash_ctx_s
+{
+  FAR const struct hash_algorithm_s *alg;
+  union
+  {
+#ifdef CONFIG_CODECS_HASH_MD5
+    struct MD5Context md5;
+#endif
+#ifdef CONFIG_CODECS_HASH_SHA1
+    struct sha1_ctx_s sha1;
+#endif
+#ifdef CONFIG_CODECS_HASH_SHA256
+    struct sha256_ctx_s sha256;
+#endif
+    uint32_t crc32;
+  } u;
+};
+
+/* One hash algorithm.  The digest is digestsize bytes long. */
+
+struct hash_algorithm_s
+{
+  FAR const char *name;
+  uint8_t digestsize;
+  CODE void (*init)(FAR struct hash_ctx_s *ctx);
+  CODE void (*update)(FAR struct hash_ctx_s *ctx, FAR const uint8_t *buf,
+                      size_t len);
+  CODE void (*final)(FAR struct hash_ctx_s *ctx, FAR uint8_t *digest);
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: hash_lookup
+ *
+ * Description:
+ *   Find an algorithm by name: "md5", "sha1", "sha256" or "crc32".  Only
+ *   the algorithms enabled in the configuration are available; "crc32"
+ *   always is.
+ *
+ * Returned Value:
+ *   The algorithm or NULL if it is not available.
+ *
+ ****************************************************************************/
+
+FAR const struct hash_algorithm_s *hash_lookup(FAR const char *name);
+
+/****************************************************************************
+ * Name: hash_algorithm
+ *
+ * Description:
+ *   Return the index'th available algorithm or NULL if index is past the
+ *   last one.
+ *
+ ****************************************************************************/
+
+FAR const struct hash_algorithm_s *hash_algorithm(int index);
+
+/****************************************************************************
+ * Name: hash_init, hash_update, hash_final
+ *
+ * Description:
+ *   Streaming interface.  Blocks of input are hashed directly from the
+ *   caller's buffer; only partial blocks are copied into the context.
+ *   hash_final() writes alg->digestsize bytes to digest.
+ *
+ ****************************************************************************/
+
+void hash_init(FAR struct hash_ctx_s *ctx,
+               FAR const struct hash_algorithm_s *alg);
+void hash_update(FAR struct hash_ctx_s *ctx, FAR const void *buf,
+                 size_t len);
+void hash_final(FAR struct hash_ctx_s *ctx, FAR uint8_t *digest);
+
+/****************************************************************************
+ * Name: hash_tohex
+ *
+ * Description:
+ *   Format a digest as lower case hex.  hex must hold 2 * len + 1 bytes.
+ *
+ ****************************************************************************/
+
+void hash_tohex(FAR const uint8_t *digest, size_t len, FAR char *hex);
+
+/****************************************************************************
+ * Name: sha1_init, sha1_update, sha1_final
+ *
+ * Description:
+ *   SHA-1 (FIPS 180-4).  sha1_final() writes the 20 byte digest.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_CODECS_HASH_SHA1
+void sha1_init(FAR struct sha1_ctx_s *ctx);
+void sha1_update(FAR struct sha1_ctx_s *ctx, FAR const uint8_t *buf,
+                 size_t len);
+void sha1_final(FAR struct sha1_ctx_s *ctx, FAR uint8_t digest[20]);
+#endif
+
+/****************************************************************************
+ * Name: sha256_init, sha256_update, sha256_final
+ *
+ * Description:
+ *   SHA-256 (FIPS 180-4).  sha256_final() writes the 32 byte digest.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_CODECS_HASH_SHA256
+void sha256_init(FAR struct sha256_ctx_s *ctx);
+void sha256_update(FAR struct sha256_ctx_s *ctx, FAR const uint8_t *buf,
+                   size_t len);
+void sha256_final(FAR struct sha256_ctx_s *ctx, FAR uint8_t digest[32]);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __APPS_INCLUDE_NETUTILS_HASH_H */
@@ -151,6 +151,25 @@ int netlib_listenon(uint16_t portno);
 void netlib_server(uint16_t portno, pthread_startroutine_t handler,
                 int stacksize);
 
+/* Batched UDP request/reply service logic */
+
+#ifdef CONFIG_NET_UDP
+struct sockaddr_in;
+struct netlib_udpsvc_s;
+
+FAR struct netlib_udpsvc_s *netlib_udpsvc_alloc(uint16_t pktsize,
+                                                uint8_t npkts,
+                                                unsigned int dedupms);
+void netlib_udpsvc_free(FAR struct netlib_udpsvc_s *svc);
+int netlib_udpsvc_recv(FAR struct netlib_udpsvc_s *svc, int sockfd);
+FAR void *netlib_udpsvc_next(FAR struct netlib_udpsvc_s *svc,
+                             FAR size_t *len, FAR struct sockaddr_in *from);
+int netlib_udpsvc_reply(FAR struct netlib_udpsvc_s *svc,
+                        FAR const struct sockaddr_in *to,
+                        FAR const void *buf, size_t len);
+int netlib_udpsvc_flush(FAR struct netlib_udpsvc_s *svc, int sockfd);
+#endif
+
 int netlib_getifstatus(FAR const char *ifname, FAR uint8_t *flags);
 int netlib_ifup(FAR const char *ifname);
 int netlib_ifdown(FAR const char *ifname);
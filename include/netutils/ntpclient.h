@@ -42,6 +42,11 @@
 
 #include <nuttx/config.h>
 
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <netinet/in.h>
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -51,6 +56,14 @@
 #  define CONFIG_NETUTILS_NTPCLIENT_SERVERIP 0x0a000001
 #endif
 
+#ifndef CONFIG_NETUTILS_NTPCLIENT_SERVERS
+#  define CONFIG_NETUTILS_NTPCLIENT_SERVERS ""
+#endif
+
+#ifndef CONFIG_NETUTILS_NTPCLIENT_MAXSERVERS
+#  define CONFIG_NETUTILS_NTPCLIENT_MAXSERVERS 4
+#endif
+
 #ifndef CONFIG_NETUTILS_NTPCLIENT_PORTNO
 #  define CONFIG_NETUTILS_NTPCLIENT_PORTNO 123
 #endif
@@ -67,6 +80,14 @@
 #  define CONFIG_NETUTILS_NTPCLIENT_POLLDELAYSEC 60
 #endif
 
+#ifndef CONFIG_NETUTILS_NTPCLIENT_STEPMSEC
+#  define CONFIG_NETUTILS_NTPCLIENT_STEPMSEC 128
+#endif
+
+#ifndef CONFIG_NETUTILS_NTPCLIENT_MAXSLEWPPM
+#  define CONFIG_NETUTILS_NTPCLIENT_MAXSLEWPPM 500
+#endif
+
 #ifndef CONFIG_NETUTILS_NTPCLIENT_SIGWAKEUP
 #  define CONFIG_NETUTILS_NTPCLIENT_SIGWAKEUP 18
 #endif
@@ -74,6 +95,32 @@
 /****************************************************************************
  * Public Types
  ****************************************************************************/
+/* Statistics for one NTP server.  All times are in nanoseconds. */
+
+struct ntpc_peerstatus_s
+{
+  in_addr_t addr;         /* Server IPv4 address (network order), 0 if unresolved */
+  uint8_t   reach;        /* Reachability register, bit 0 is the last poll */
+  uint8_t   stratum;      /* Stratum reported by the server */
+  bool      selected;     /* True: Used in the last clock update */
+  int64_t   offset;       /* Filtered clock offset */
+  int64_t   delay;        /* Filtered round trip delay */
+  int64_t   jitter;       /* RMS offset jitter of the filter samples */
+};
+
+/* Statistics for the NTP client as returned by ntpc_status() */
+
+struct ntpc_status_s
+{
+  bool     synchronized;  /* True: The clock has been set at least once */
+  uint8_t  npeers;        /* Number of configured servers */
+  uint8_t  nsurvivors;    /* Number of servers used in the last update */
+  int64_t  offset;        /* Combined offset of the last update (nsec) */
+  int64_t  jitter;        /* System jitter of the last update (nsec) */
+  uint32_t nupdates;      /* Number of clock updates */
+  uint32_t nsteps;        /* Number of those updates that stepped the clock */
+  struct ntpc_peerstatus_s peer[CONFIG_NETUTILS_NTPCLIENT_MAXSERVERS];
+};
 
 /****************************************************************************
  * Public Data
@@ -120,6 +167,23 @@ int ntpc_start(void);
 int ntpc_stop(void);
 #endif
 
+/****************************************************************************
+ * Name: ntpc_status
+ *
+ * Description:
+ *   Return a snapshot of the NTP client clock offset, delay and jitter
+ *   statistics.
+ *
+ * Input Parameters:
+ *   status - The location to return the statistics.
+ *
+ * Returned Value:
+ *   Zero on success; -ESRCH if the NTP daemon has never been started.
+ *
+ ****************************************************************************/
+
+int ntpc_status(FAR struct ntpc_status_s *status);
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -47,10 +47,21 @@
 #include <nuttx/net/netconfig.h>
 #include <nuttx/net/ip.h>
 
+#include <sys/types.h>
+
 /****************************************************************************
  * Type Definitions
  ****************************************************************************/
 
+/* Supplies the message body to smtp_sendstream().  Returns the number of
+ * bytes placed in 'buffer', zero at the end of the body, or a negative
+ * value on failure.  Line endings may be LF or CRLF; lines that begin
+ * with '.' are escaped by the sender.
+ */
+
+typedef ssize_t (*smtp_reader_t)(FAR void *arg, FAR char *buffer,
+                                 size_t buflen);
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -75,6 +86,22 @@ int   smtp_send(FAR void *handle, FAR const char *to, FAR const char *cc,
                 FAR const char *msg, int msglen);
 void  smtp_close(FAR void *handle);
 
+/* Session interface.  smtp_connect() opens a connection that is kept
+ * across any number of messages until smtp_disconnect() or smtp_close().
+ * smtp_send() uses the session if one is open and otherwise connects for
+ * the one message.
+ */
+
+int   smtp_connect(FAR void *handle);
+int   smtp_sendstream(FAR void *handle, FAR const char *to,
+                      FAR const char *cc, FAR const char *from,
+                      FAR const char *subject, smtp_reader_t reader,
+                      FAR void *arg);
+int   smtp_sendfile(FAR void *handle, FAR const char *to,
+                    FAR const char *cc, FAR const char *from,
+                    FAR const char *subject, int fd);
+void  smtp_disconnect(FAR void *handle);
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -52,6 +52,9 @@
  * CONFIG_TELNETD_TXBUFFER_SIZE - The size of the Telnet transmit buffer.
  *   Default: 256 bytes.
  * CONFIG_TELNETD_DUMPBUFFER - dumping of all input/output buffers.
+ * CONFIG_TELNETD_FLUSHDELAY - Output is accumulated in the transmit buffer
+ *   and sent at most this many milliseconds after it was written.  Requires
+ *   CONFIG_SCHED_WORKQUEUE.  Zero sends output at the end of each write.
  */
 
 #ifndef CONFIG_TELNETD_RXBUFFER_SIZE
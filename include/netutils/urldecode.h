@@ -42,11 +42,28 @@
 
 #include <nuttx/config.h>
 
+#include <sys/types.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* State of a streaming URL decode: a '%' escape may be split across
+ * calls to urldecode_update().
+ */
+
+struct urldecode_ctx_s
+{
+  uint8_t npending;             /* 1: '%' seen, 2: '%' and one hex digit */
+  char    hexhigh;              /* The first hex digit */
+};
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -61,6 +78,22 @@ char *urlencode(const char *src, const int src_len, char *dest, int *dest_len);
 char *urldecode(const char *src, const int src_len, char *dest, int *dest_len);
 int urlencode_len(const char *src, const int src_len);
 int urldecode_len(const char *src, const int src_len);
+
+/****************************************************************************
+ * Name: urldecode_init, urldecode_update, urldecode_final
+ *
+ * Description:
+ *   Streaming form of urldecode().  Each call returns the number of bytes
+ *   written to dest; no NUL terminator is added.  dest must have room for
+ *   len + 2 bytes (2 for urldecode_final()), and may be the same buffer as
+ *   src except across calls that split an escape.
+ *
+ ****************************************************************************/
+
+void urldecode_init(FAR struct urldecode_ctx_s *ctx);
+size_t urldecode_update(FAR struct urldecode_ctx_s *ctx, FAR const char *src,
+                        size_t len, FAR char *dest);
+size_t urldecode_final(FAR struct urldecode_ctx_s *ctx, FAR char *dest);
 #endif /* CONFIG_CODECS_URLCODE */
 
 #ifdef CONFIG_CODECS_AVR_URLCODE
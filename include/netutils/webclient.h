@@ -98,6 +98,17 @@
 typedef void (*wget_callback_t)(FAR char **buffer, int offset,
                                 int datend, FAR int *buflen, FAR void *arg);
 
+/* This describes one request in a sequence sent with wget_pipeline() */
+
+struct wget_request_s
+{
+  FAR const char *url;       /* URL of the file to get or to post to */
+  FAR const char *posts;     /* Form data to POST, or NULL to GET */
+  wget_callback_t callback;  /* Receives the body of the response */
+  FAR void *arg;             /* User argument passed to callback */
+  int status;                /* Returned HTTP status code (0 if none) */
+};
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -155,6 +166,43 @@ int wget(FAR const char *url, FAR char *buffer, int buflen,
 int wget_post(FAR const char *url, FAR const char *posts, FAR char *buffer,
               int buflen, wget_callback_t callback, FAR void *arg);
 
+/****************************************************************************
+ * Name: wget_pipeline
+ *
+ * Description:
+ *   Send a sequence of requests to one server and receive the responses in
+ *   order.  If CONFIG_WEBCLIENT_KEEPALIVE is selected, up to
+ *   CONFIG_WEBCLIENT_PIPELINE GET requests are sent at a time without
+ *   waiting for the responses.  POST requests are always sent one at a
+ *   time.  Redirections are not followed; the status code of each response
+ *   is returned in the request and its body is passed to the callback.
+ *
+ * Input Parameters
+ *   reqs     - The requests.  All URLs must have the same host and port.
+ *   nreqs    - The number of requests
+ *   buffer   - A user provided buffer to receive the file data (also
+ *              used for the outgoing requests)
+ *   buflen   - The size of the user provided buffer
+ *
+ * Returned Value:
+ *   0: if all of the requests completed successfully;
+ *  -1: On a failure with errno set appropriately
+ *
+ ****************************************************************************/
+
+int wget_pipeline(FAR struct wget_request_s *reqs, int nreqs,
+                  FAR char *buffer, int buflen);
+
+/****************************************************************************
+ * Name: wget_closeall
+ *
+ * Description:
+ *   Close all idle persistent connections kept open for re-use.
+ *
+ ****************************************************************************/
+
+void wget_closeall(void);
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -56,12 +56,35 @@
 
 #include <nuttx/config.h>
 
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* Configuration */
+
+#ifndef CONFIG_XMLRPC_STRINGSIZE
+#  define CONFIG_XMLRPC_STRINGSIZE      64
+#endif
+
+#ifndef CONFIG_XMLRPC_MAXVALUES
+#  define CONFIG_XMLRPC_MAXVALUES       32
+#endif
+
+#ifndef CONFIG_XMLRPC_MAXDEPTH
+#  define CONFIG_XMLRPC_MAXDEPTH        8
+#endif
+
+#ifndef CONFIG_XMLRPC_CHUNKSIZE
+#  define CONFIG_XMLRPC_CHUNKSIZE       256
+#endif
+
 /* Error definitions. */
 
+#define XMLRPC_PARSE_DONE               (1)
 #define XMLRPC_NO_ERROR                 (0)
 #define XMLRPC_PARSE_ERROR              (-1)
 #define XMLRPC_NO_SUCH_FUNCTION         (-2)
@@ -70,34 +93,113 @@
 #define XMLRPC_UNEXPECTED_DOUBLE_ARG    (-5)
 #define XMLRPC_UNEXPECTED_STRING_ARG    (-6)
 #define XMLRPC_BAD_RESPONSE_ARG         (-7)
+#define XMLRPC_TOO_LARGE                (-8)
 #define XMLRPC_INTERNAL_ERROR           (-99)
 
-#define MAX_ARGS                        10
-#define MAX_RESPONSE                    2048
+/* Value types */
+
+#define XMLRPC_TYPE_NONE                0
+#define XMLRPC_TYPE_INT                 1
+#define XMLRPC_TYPE_BOOLEAN             2
+#define XMLRPC_TYPE_DOUBLE              3
+#define XMLRPC_TYPE_STRING              4
+#define XMLRPC_TYPE_DATETIME            5
+#define XMLRPC_TYPE_BASE64              6
+#define XMLRPC_TYPE_ARRAY               7
+#define XMLRPC_TYPE_STRUCT              8
+
+/* Space reserved at the front of the response buffer for the HTTP header */
+
+#define XMLRPC_HDRSIZE                  128
 
 /****************************************************************************
  * Public Types
  ****************************************************************************/
 
-struct xmlrpc_arg_s
+/* A slice of the request buffer.  Strings are decoded in place and NUL
+ * terminated so that ptr may be used directly as a C string.  Slices are
+ * valid only until the request buffer is reused.
+ */
+
+struct xmlrpc_slice_s
+{
+  FAR const char *ptr;
+  size_t len;
+};
+
+/* One parsed value.  The values of a request are kept in document order:
+ * the elements of an array or the members of a struct immediately follow
+ * the container and 'next' gives the index of the value after the whole
+ * subtree.
+ */
+
+struct xmlrpc_value_s
 {
-  union
-  {
-    int i;
-    char boolean;
-    double d;
-    char string[CONFIG_XMLRPC_STRINGSIZE+1];
-  } u;
+  uint8_t  type;                    /* XMLRPC_TYPE_* */
+  uint16_t next;                    /* Index of the next sibling */
+  uint16_t count;                   /* Number of elements or members */
+  struct xmlrpc_slice_s name;       /* Member name (struct members only) */
+  struct xmlrpc_slice_s text;       /* Text of a scalar value */
+};
+
+/* Incremental request parser.  The caller owns the receive buffer:  data
+ * is received directly into &buffer[nbytes] (at most bufsize - nbytes
+ * bytes) and then announced with xmlrpc_parser_feed().  Parsing resumes
+ * where the previous call stopped, so chunk boundaries may fall anywhere.
+ */
+
+struct xmlrpc_parser_s
+{
+  FAR char *buffer;                 /* Request buffer */
+  size_t    bufsize;                /* Size of the request buffer */
+  size_t    nbytes;                 /* Number of bytes received */
+  size_t    pos;                    /* Tokenizer position */
+  size_t    tagstart;               /* Offset of the '<' of the current tag */
+  size_t    textstart;              /* Offset of the text after last tag */
+  uint8_t   state;                  /* Tokenizer state */
+  int8_t    result;                 /* Final result once parsing stopped */
+  uint8_t   depth;                  /* Number of open <value> elements */
+  uint16_t  nvalues;                /* Number of values parsed */
+  uint16_t  nparams;                /* Number of top level parameters */
+  bool      http10;                 /* True: The request was HTTP/1.0 */
+  uint16_t  stack[CONFIG_XMLRPC_MAXDEPTH];
+  struct xmlrpc_slice_s method;     /* methodName */
+  struct xmlrpc_slice_s member;     /* Pending struct member name */
+  struct xmlrpc_value_s values[CONFIG_XMLRPC_MAXVALUES];
+};
+
+/* Streaming response writer.  The body is sent with chunked transfer
+ * encoding as the buffer fills, so there is no limit on the size of a
+ * response and no Content-Length to patch.  Nothing is sent before the
+ * first chunk is full or the response is complete, so a handler may still
+ * replace a partial response with a fault up to that point.
+ *
+ * HTTP/1.0 clients do not understand chunked encoding.  If 'http10' is
+ * set, a response that fits in one chunk is sent with a Content-Length.
+ * A longer response is sent as it is without a length, and the caller
+ * ends it by closing the connection.
+ */
+
+struct xmlrpc_writer_s
+{
+  int       sock;                   /* Connected socket */
+  int       errcode;                /* errno of the first failed send */
+  uint16_t  base;                   /* Header bytes ahead of the chunk */
+  uint16_t  len;                    /* Payload bytes in the current chunk */
+  uint16_t  members;                /* Containers that are struct members */
+  uint8_t   depth;                  /* Open arrays and structs */
+  uint8_t   state;                  /* Response state */
+  bool      sent;                   /* True once the header has been sent */
+  bool      http10;                 /* True: Respond with HTTP/1.0 */
+  char      buffer[XMLRPC_HDRSIZE + CONFIG_XMLRPC_CHUNKSIZE + 13];
 };
 
 struct xmlrpc_s
 {
-  char  name[CONFIG_XMLRPC_STRINGSIZE+1];
-  struct xmlrpc_arg_s arguments[MAX_ARGS];
-  char  args[MAX_ARGS];
-  int   argsize;
-  int   arg;
-  char  response[MAX_RESPONSE];
+  FAR struct xmlrpc_parser_s *parser; /* Parsed request */
+  FAR struct xmlrpc_writer_s *writer; /* Response writer */
+  FAR const char *name;             /* Method name */
+  int   arg;                        /* Value index of the next argument */
   int   error;
 };
 
@@ -112,12 +214,70 @@ struct xmlrpc_entry_s
  * Public Function Prototypes
  ****************************************************************************/
 
+/* Method registration and dispatch */
+
 void xmlrpc_register(struct xmlrpc_entry_s *call);
 int xmlrpc_parse(int sock, char *buffer);
+int xmlrpc_serve(int sock, FAR char *buffer, size_t bufsize);
+
+/* Incremental parser */
+
+void xmlrpc_parser_init(FAR struct xmlrpc_parser_s *parser,
+                        FAR char *buffer, size_t bufsize);
+int xmlrpc_parser_feed(FAR struct xmlrpc_parser_s *parser, size_t nbytes);
+
+/* Zero-copy argument access */
+
+FAR const struct xmlrpc_value_s *
+  xmlrpc_param(FAR const struct xmlrpc_parser_s *parser, int index);
+FAR const struct xmlrpc_value_s *
+  xmlrpc_element(FAR const struct xmlrpc_parser_s *parser,
+                 FAR const struct xmlrpc_value_s *container, int index);
+FAR const struct xmlrpc_value_s *
+  xmlrpc_findmember(FAR const struct xmlrpc_parser_s *parser,
+                    FAR const struct xmlrpc_value_s *container,
+                    FAR const char *name);
+int xmlrpc_value2int(FAR const struct xmlrpc_value_s *value, FAR int *result);
+int xmlrpc_value2bool(FAR const struct xmlrpc_value_s *value,
+                      FAR int *result);
+int xmlrpc_value2double(FAR const struct xmlrpc_value_s *value,
+                        FAR double *result);
+int xmlrpc_value2string(FAR const struct xmlrpc_value_s *value,
+                        FAR const char **result);
+
+/* Sequential argument access (copies the value) */
+
 int xmlrpc_getinteger(struct xmlrpc_s *xmlcall, int *arg);
 int xmlrpc_getbool(struct xmlrpc_s *xmlcall, int *arg);
 int xmlrpc_getdouble(struct xmlrpc_s *xmlcall, double *arg);
 int xmlrpc_getstring(struct xmlrpc_s *xmlcall, char *arg);
+
+/* Streaming response */
+
+void xmlrpc_writer_init(FAR struct xmlrpc_writer_s *writer, int sock);
+int xmlrpc_beginresponse(FAR struct xmlrpc_writer_s *writer);
+int xmlrpc_endresponse(FAR struct xmlrpc_writer_s *writer);
+int xmlrpc_sendfault(FAR struct xmlrpc_writer_s *writer, int code,
+                     FAR const char *string);
+int xmlrpc_putint(FAR struct xmlrpc_writer_s *writer, FAR const char *name,
+                  int value);
+int xmlrpc_putbool(FAR struct xmlrpc_writer_s *writer, FAR const char *name,
+                   int value);
+int xmlrpc_putdouble(FAR struct xmlrpc_writer_s *writer,
+                     FAR const char *name, double value);
+int xmlrpc_putstring(FAR struct xmlrpc_writer_s *writer,
+                     FAR const char *name, FAR const char *value);
+int xmlrpc_beginarray(FAR struct xmlrpc_writer_s *writer,
+                      FAR const char *name);
+int xmlrpc_endarray(FAR struct xmlrpc_writer_s *writer);
+int xmlrpc_beginstruct(FAR struct xmlrpc_writer_s *writer,
+                       FAR const char *name);
+int xmlrpc_endstruct(FAR struct xmlrpc_writer_s *writer);
+
+/* Formatted response:  "i" int, "b" boolean, "d" double, "s" string, "{"
+ * and "}" enclose a struct whose members are each preceded by a name.
+ */
+
 int xmlrpc_buildresponse(struct xmlrpc_s *, char *, ...);
 
 #endif /* __APPS_INCLUDE_NETUTILS_XMLRPC_H */
@@ -53,6 +53,25 @@
 /****************************************************************************
  * Public Type Declarations
  ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_READAHEAD
+/* This structure reports the state of the NxPlayer read-ahead buffers */
+
+struct nxplayer_status_s
+{
+  bool        active;         /* True: The file is being read ahead */
+  bool        queued;         /* True: A file is queued to play next */
+  uint16_t    nbuffers;       /* Number of read-ahead buffers */
+  uint16_t    nfilled;        /* Number of read-ahead buffers holding data */
+  uint16_t    minfilled;      /* Lowest nfilled during the playback */
+  uint32_t    underruns;      /* Times playback waited for file data */
+  uint32_t    nreads;         /* Number of file reads */
+  uint32_t    maxlatency;     /* Duration of the slowest read (usec) */
+};
+
+struct nxplayer_ra_s;
+#endif
+
 /* This structure describes the internal state of the NxPlayer */
 
 struct nxplayer_s
@@ -65,6 +84,9 @@ struct nxplayer_s
   int         crefs;          /* Number of references to the player */
   sem_t       sem;            /* Thread sync semaphore */
   FILE*       fileFd;         /* File descriptor of open file */
+#ifdef CONFIG_NXPLAYER_READAHEAD
+  FAR struct nxplayer_ra_s *ra; /* Read-ahead state */
+#endif
 #ifdef CONFIG_NXPLAYER_INCLUDE_PREFERRED_DEVICE
   char        prefdevice[CONFIG_NAME_MAX]; /* Preferred audio device */
   int         prefformat;     /* Formats supported by preferred device */
@@ -224,6 +246,49 @@ int nxplayer_playfile(FAR struct nxplayer_s *pPlayer,
 int nxplayer_stop(FAR struct nxplayer_s *pPlayer);
 #endif
 
+/****************************************************************************
+ * Name: nxplayer_queuefile
+ *
+ *   Queues a media file to be played immediately after the file that is
+ *   currently playing, with no gap between them.  The data of the queued
+ *   file is appended to the current audio stream, so it must be in the
+ *   same format as the current file.
+ *
+ * Input Parameters:
+ *   pPlayer   - Pointer to the context to initialize
+ *   filename  - Pointer to pathname of the file to play next
+ *
+ * Returned Value:
+ *   OK if the file was queued.  -EBUSY if a file is already queued or
+ *   -ENODATA if the current file is no longer being read.
+ *
+ **************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_READAHEAD
+int nxplayer_queuefile(FAR struct nxplayer_s *pPlayer,
+                       FAR const char *filename);
+#endif
+
+/****************************************************************************
+ * Name: nxplayer_getstatus
+ *
+ *   Returns the fill level of the read-ahead buffers and the read-ahead
+ *   statistics of the current (or last) playback.
+ *
+ * Input Parameters:
+ *   pPlayer   - Pointer to the context to initialize
+ *   status    - Location to return the status
+ *
+ * Returned Value:
+ *   OK
+ *
+ **************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_READAHEAD
+int nxplayer_getstatus(FAR struct nxplayer_s *pPlayer,
+                       FAR struct nxplayer_status_s *status);
+#endif
+
 /****************************************************************************
  * Name: nxplayer_pause
  *
@@ -47,6 +47,22 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+#ifdef CONFIG_READLINE_TABCOMPLETION
+/* Provides the command names that Tab completes in the first word of the
+ * line.  getname() returns the name with the given index or NULL after the
+ * last name.
+ */
+
+struct extmatch_vtable_s
+{
+  CODE FAR const char *(*getname)(int index);
+};
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -129,6 +145,43 @@ ssize_t readline(FAR char *buf, int buflen, FILE *instream, FILE *outstream);
 ssize_t std_readline(FAR char *buf, int buflen);
 #endif
 
+/****************************************************************************
+ * Name: readline_prompt
+ *
+ *   Set the prompt that is redrawn after Tab lists the possible completions
+ *   of a word.  The string is not copied.
+ *
+ * Input Parameters:
+ *   prompt - The prompt string, or NULL for none.
+ *
+ * Returned values:
+ *   The previous prompt string.
+ *
+ **************************************************************************/
+
+#ifdef CONFIG_READLINE_TABCOMPLETION
+FAR const char *readline_prompt(FAR const char *prompt);
+#endif
+
+/****************************************************************************
+ * Name: readline_extmatch
+ *
+ *   Set the source of the command names that Tab completes in the first
+ *   word of the line.  The structure is not copied.
+ *
+ * Input Parameters:
+ *   vtbl - The command name source, or NULL for none.
+ *
+ * Returned values:
+ *   The previous command name source.
+ *
+ **************************************************************************/
+
+#ifdef CONFIG_READLINE_TABCOMPLETION
+FAR const struct extmatch_vtable_s *
+  readline_extmatch(FAR const struct extmatch_vtable_s *vtbl);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -42,12 +42,51 @@
 
 #include <nuttx/config.h>
 
+#include <stdint.h>
+
 #ifdef CONFIG_SYSTEM_USBMONITOR
 
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* Binary capture format.  A capture begins with one struct usbmon_header_s
+ * that is followed by any number of struct usbmon_record_s.  All fields are
+ * in the byte order of the target;  the byteorder field of the header reads
+ * as USBMON_BYTEORDER in that byte order.
+ */
+
+#define USBMON_MAGIC          "USBM"  /* First four bytes of a capture */
+#define USBMON_VERSION        1       /* Version of the capture format */
+#define USBMON_BYTEORDER      0x0102  /* Byte order marker */
+
+/* A record with this event does not hold a trace record:  its value is
+ * the number of trace records that were lost at that point because the
+ * capture buffer was full.
+ */
+
+#define USBMON_EVENT_DROPPED  0xffff
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+struct usbmon_header_s
+{
+  char magic[4];              /* USBMON_MAGIC without the NUL terminator */
+  uint16_t byteorder;         /* USBMON_BYTEORDER */
+  uint8_t version;            /* USBMON_VERSION */
+  uint8_t recsize;            /* sizeof(struct usbmon_record_s) */
+  uint32_t usecpertick;       /* Units of the time field of the records */
+};
+
+struct usbmon_record_s
+{
+  uint32_t time;              /* System timer when the record was collected */
+  uint16_t event;             /* Trace event, or USBMON_EVENT_DROPPED */
+  uint16_t value;             /* Trace value, or the number of lost records */
+};
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -74,10 +113,14 @@ extern "C"
  *
  * Input Parameters:
  *   Standard task parameters.  These can be called or spawned.  Since the
- *   return almost immediately, it is fine to just call the functions.  The
- *   parameters are not used so you can pass 0 and NULL, respectivley; this
- *   is done this way so that these functions can be NSH builtin
- *   applications.
+ *   return almost immediately, it is fine to just call the functions.  You
+ *   can pass 0 and NULL, respectivley; this is done this way so that these
+ *   functions can be NSH builtin applications.
+ *
+ *   With CONFIG_SYSTEM_USBMONITOR_BINARY, usbmonitor_start() accepts
+ *   "-f <path>" to capture USB device trace records in binary form to a
+ *   file, or "-c <ipaddr>:<port>" to send them to a TCP server.  Without
+ *   either option, the trace is formatted as text to the SYSLOG device.
  *
  * Returned values:
  *   Standard task return values (zero meaning success).
@@ -0,0 +1,265 @@
+/****************************************************************************
+ * apps/include/vtscreen.h
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_INCLUDE_VTSCREEN_H
+#define __APPS_INCLUDE_VTSCREEN_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+
+#ifdef CONFIG_SYSTEM_VTSCREEN
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Flags that may be provided to vtscreen_initialize() */
+
+#define VTSCREEN_FULLSCREEN (1 << 0) /* The screen extends to the bottom
+                                      * row of the display */
+
+/* Marks an unknown cursor position or unknown row contents */
+
+#define VTSCREEN_UNKNOWN    UINT16_MAX
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* The state of one row of the screen */
+
+struct vtscreen_row_s
+{
+  uint16_t len;             /* Length of the text wanted on the row */
+  uint16_t oldlen;          /* Length of the text on the display */
+  uint8_t flags;            /* Row state flags (private) */
+};
+
+/* This structure describes one VT100 screen (or one rectangular region of
+ * it that extends to the right edge of the display).  The contents of the
+ * structure are private to the vtscreen library;  it is made public only so
+ * that it can be embedded in the state structure of the caller.
+ */
+
+struct vtscreen_s
+{
+  int fd;                   /* Output file descriptor */
+  int errcode;              /* Latched write error (negated errno) */
+  uint16_t nrows;           /* Height of the screen in rows */
+  uint16_t ncols;           /* Width of the screen in columns */
+  uint16_t orgrow;          /* Display row of screen row 0 */
+  uint16_t orgcol;          /* Display column of screen column 0 */
+  uint16_t currow;          /* Row of the display cursor */
+  uint16_t curcol;          /* Column of the display cursor */
+  uint16_t row;             /* Row where the cursor should be left */
+  uint16_t column;          /* Column where the cursor should be left */
+  uint16_t nout;            /* Number of bytes in outbuf[] */
+  uint8_t flags;            /* See VTSCREEN_* definitions */
+  FAR struct vtscreen_row_s *rows; /* State of each row */
+  FAR char *text;           /* Text wanted on each row */
+  FAR char *shadow;         /* Text on each row of the display */
+  FAR char *outbuf;         /* Output buffer */
+};
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: vtscreen_initialize
+ *
+ * Description:
+ *   Set up a screen of 'nrows' x 'ncols' characters that is written to
+ *   'fd'.  Screen row 0, column 0 is at the upper left corner of the
+ *   display unless vtscreen_origin() says otherwise.  Nothing is known
+ *   about the contents of the display, so the first refresh redraws every
+ *   row.
+ *
+ * Returned Value:
+ *   OK on success; -ENOMEM if the screen buffers could not be allocated.
+ *
+ ****************************************************************************/
+
+int vtscreen_initialize(FAR struct vtscreen_s *screen, int fd,
+                        uint16_t nrows, uint16_t ncols, uint8_t flags);
+
+/****************************************************************************
+ * Name: vtscreen_release
+ *
+ * Description:
+ *   Send any buffered output and free the screen buffers.
+ *
+ ****************************************************************************/
+
+void vtscreen_release(FAR struct vtscreen_s *screen);
+
+/****************************************************************************
+ * Name: vtscreen_origin
+ *
+ * Description:
+ *   Place screen row 0, column 0 at the zero-based display position
+ *   (row, column).  The display cursor is assumed to be at that position,
+ *   as it is after the position has been obtained with the VT100
+ *   GETCURSOR request.
+ *
+ ****************************************************************************/
+
+void vtscreen_origin(FAR struct vtscreen_s *screen, uint16_t row,
+                     uint16_t column);
+
+/****************************************************************************
+ * Name: vtscreen_getrow and vtscreen_setrow
+ *
+ * Description:
+ *   vtscreen_getrow() returns the buffer of 'ncols' characters that holds
+ *   the text wanted on 'row'.  After formatting the text into that buffer,
+ *   the caller commits it with vtscreen_setrow().  The rest of the row is
+ *   blank.  Only rows that were set since the last refresh are updated by
+ *   the next refresh;  the other rows of the display are left alone.
+ *
+ ****************************************************************************/
+
+FAR char *vtscreen_getrow(FAR struct vtscreen_s *screen, uint16_t row);
+void vtscreen_setrow(FAR struct vtscreen_s *screen, uint16_t row,
+                     uint16_t len);
+
+/****************************************************************************
+ * Name: vtscreen_setcursor
+ *
+ * Description:
+ *   Select the position where the cursor is left after the next refresh.
+ *
+ ****************************************************************************/
+
+void vtscreen_setcursor(FAR struct vtscreen_s *screen, uint16_t row,
+                        uint16_t column);
+
+/****************************************************************************
+ * Name: vtscreen_refresh
+ *
+ * Description:
+ *   Bring the display up to date with the rows that have been set.  Only
+ *   the differences from what is already on the display are sent, using
+ *   the cheapest combination of cursor movement, insert/delete line,
+ *   insert/delete character and erase-to-end-of-line.  All of the output
+ *   is collected in the output buffer and sent with a single write()
+ *   (unless it does not fit into CONFIG_SYSTEM_VTSCREEN_BUFSIZE bytes).
+ *
+ * Returned Value:
+ *   OK on success; a negated errno value if a write to the display failed
+ *   since the last refresh or flush.
+ *
+ ****************************************************************************/
+
+int vtscreen_refresh(FAR struct vtscreen_s *screen);
+
+/****************************************************************************
+ * Name: vtscreen_moveto
+ *
+ * Description:
+ *   Add the shortest sequence that moves the display cursor to the screen
+ *   position (row, column) to the output buffer.
+ *
+ ****************************************************************************/
+
+void vtscreen_moveto(FAR struct vtscreen_s *screen, uint16_t row,
+                     uint16_t column);
+
+/****************************************************************************
+ * Name: vtscreen_write
+ *
+ * Description:
+ *   Add raw output (text, BEL, or escape sequences) to the output buffer.
+ *   Printable text is assumed to be written at the cursor position and the
+ *   row that the cursor is on is forgotten.  The caller must use
+ *   vtscreen_invalidate() for rows changed in any other way.
+ *
+ ****************************************************************************/
+
+void vtscreen_write(FAR struct vtscreen_s *screen, FAR const char *buffer,
+                    size_t buflen);
+
+/****************************************************************************
+ * Name: vtscreen_invalidate
+ *
+ * Description:
+ *   Forget the display contents of 'nrows' rows beginning at 'row'.  They
+ *   are redrawn in full the next time that they are set and refreshed.
+ *
+ ****************************************************************************/
+
+void vtscreen_invalidate(FAR struct vtscreen_s *screen, uint16_t row,
+                         uint16_t nrows);
+
+/****************************************************************************
+ * Name: vtscreen_flush
+ *
+ * Description:
+ *   Send the contents of the output buffer to the display.  This must be
+ *   called before waiting for input.
+ *
+ * Returned Value:
+ *   OK on success; a negated errno value if a write to the display failed
+ *   since the last refresh or flush.
+ *
+ ****************************************************************************/
+
+int vtscreen_flush(FAR struct vtscreen_s *screen);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_SYSTEM_VTSCREEN */
+#endif /* __APPS_INCLUDE_VTSCREEN_H */
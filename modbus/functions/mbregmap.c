@@ -0,0 +1,483 @@
+/****************************************************************************
+ * apps/modbus/functions/mbregmap.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "port.h"
+
+#include <apps/modbus/mb.h>
+#include <apps/modbus/mbregmap.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Orders the buffer accesses against the updates of ulSeq and ucFront */
+
+#ifdef __GNUC__
+#  define MB_REGMAP_BARRIER() __sync_synchronize()
+#else
+#  define MB_REGMAP_BARRIER()
+#endif
+
+/* Attempts at a consistent copy before giving up with MB_ETIMEDOUT */
+
+#define MB_REGMAP_RETRIES 4
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct mbregblock_s
+{
+  uint16_t usAddress;          /* Address of the first register or bit */
+  uint16_t usCount;            /* Number of registers or bits */
+  FAR void *apvBuf[2];         /* apvBuf[1] is NULL if not double buffered */
+  volatile uint8_t ucFront;    /* Buffer served to the master */
+  volatile uint32_t ulSeq;     /* Incremented before and after each update */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct mbregblock_s xBlocks[MB_REGMAP_NCLASSES];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static inline bool prvbMBRegMapIsBits(eMBRegMapClass eClass)
+{
+  return eClass == MB_REGMAP_COILS || eClass == MB_REGMAP_DISCRETE;
+}
+
+static size_t prvzMBRegMapSize(eMBRegMapClass eClass, uint16_t usCount)
+{
+  return prvbMBRegMapIsBits(eClass) ? ((size_t)usCount + 7) / 8 :
+                                      (size_t)usCount * sizeof(uint16_t);
+}
+
+/* Look up the block of eClass and check that it covers the usCount
+ * registers or bits starting at usAddress.
+ */
+
+static FAR struct mbregblock_s *prvpxMBRegMapFind(eMBRegMapClass eClass,
+                                                  uint16_t usAddress,
+                                                  uint16_t usCount)
+{
+  FAR struct mbregblock_s *pxBlock = &xBlocks[eClass];
+
+  if (pxBlock->apvBuf[0] == NULL || usCount == 0 ||
+      usAddress < pxBlock->usAddress ||
+      (uint32_t)usAddress + usCount >
+      (uint32_t)pxBlock->usAddress + pxBlock->usCount)
+    {
+      return NULL;
+    }
+
+  return pxBlock;
+}
+
+static void prvvMBRegMapPack(FAR uint8_t *pucDest,
+                             FAR const uint16_t *pusSrc, uint16_t usCount)
+{
+  while (usCount-- > 0)
+    {
+      *pucDest++ = (uint8_t)(*pusSrc >> 8);
+      *pucDest++ = (uint8_t)(*pusSrc++ & 0xff);
+    }
+}
+
+static void prvvMBRegMapUnpack(FAR uint16_t *pusDest,
+                               FAR const uint8_t *pucSrc, uint16_t usCount)
+{
+  while (usCount-- > 0)
+    {
+      *pusDest++ = (uint16_t)pucSrc[0] << 8 | pucSrc[1];
+      pucSrc += 2;
+    }
+}
+
+/* Copy usCount bits starting at bit usOffset of pucSrc to the start of
+ * pucDest, a byte at a time.  The unused bits of the last byte are
+ * cleared as the protocol requires.  pucSrc is never read beyond the byte
+ * that holds the last bit.
+ */
+
+static void prvvMBRegMapGetBits(FAR uint8_t *pucDest,
+                                FAR const uint8_t *pucSrc,
+                                uint16_t usOffset, uint16_t usCount)
+{
+  unsigned int uShift = usOffset & 7;
+  unsigned int uBytes = ((unsigned int)usCount + 7) / 8;
+  unsigned int i;
+
+  pucSrc += usOffset >> 3;
+
+  if (uShift == 0)
+    {
+      memcpy(pucDest, pucSrc, uBytes);
+    }
+  else
+    {
+      for (i = 0; i < uBytes; i++)
+        {
+          unsigned int uValue = pucSrc[i] >> uShift;
+
+          if (i * 8 + 8 - uShift < usCount)
+            {
+              uValue |= (unsigned int)pucSrc[i + 1] << (8 - uShift);
+            }
+
+          pucDest[i] = (uint8_t)uValue;
+        }
+    }
+
+  if ((usCount & 7) != 0)
+    {
+      pucDest[uBytes - 1] &= (uint8_t)((1 << (usCount & 7)) - 1);
+    }
+}
+
+/* Copy usCount bits from the start of pucSrc to bit usOffset of pucDest,
+ * leaving the neighbouring bits alone.
+ */
+
+static void prvvMBRegMapSetBits(FAR uint8_t *pucDest, uint16_t usOffset,
+                                FAR const uint8_t *pucSrc, uint16_t usCount)
+{
+  unsigned int uShift = usOffset & 7;
+  unsigned int uNBits;
+  unsigned int uMask;
+  unsigned int uValue;
+
+  pucDest += usOffset >> 3;
+
+  while (usCount > 0)
+    {
+      uNBits = usCount < 8 ? usCount : 8;
+      uMask  = ((1u << uNBits) - 1) << uShift;
+      uValue = ((unsigned int)*pucSrc++ << uShift) & uMask;
+
+      pucDest[0] = (uint8_t)((pucDest[0] & ~uMask) | uValue);
+      if ((uMask >> 8) != 0)
+        {
+          pucDest[1] = (uint8_t)((pucDest[1] & ~(uMask >> 8)) |
+                                 (uValue >> 8));
+        }
+
+      pucDest++;
+      usCount -= uNBits;
+    }
+}
+
+/* Copy a range out of the buffer that is currently served, either packed
+ * for the frame (bFrame) or in the native layout for eMBRegMapRead().  The
+ * copy is retried if the buffer was modified meanwhile.
+ *
+ * With double buffering the writer only modifies the back buffer, so the
+ * copy can only be torn if the writer committed and then started on the
+ * buffer being copied.  That takes at least two increments of ulSeq.  With
+ * a single buffer any update in progress or made during the copy counts.
+ */
+
+static eMBErrorCode prveMBRegMapSnapshot(FAR struct mbregblock_s *pxBlock,
+                                         bool bBits, uint16_t usAddress,
+                                         uint16_t usCount,
+                                         FAR void *pvDest, bool bFrame)
+{
+  uint16_t usOffset = usAddress - pxBlock->usAddress;
+  FAR const void *pvBuf;
+  uint32_t ulSeq;
+  bool bDouble = pxBlock->apvBuf[1] != NULL;
+  int iRetry;
+
+  for (iRetry = 0; iRetry < MB_REGMAP_RETRIES; iRetry++)
+    {
+      ulSeq = pxBlock->ulSeq;
+      MB_REGMAP_BARRIER();
+
+      pvBuf = pxBlock->apvBuf[pxBlock->ucFront];
+      if (bBits)
+        {
+          prvvMBRegMapGetBits((FAR uint8_t *)pvDest,
+                              (FAR const uint8_t *)pvBuf, usOffset,
+                              usCount);
+        }
+      else if (bFrame)
+        {
+          prvvMBRegMapPack((FAR uint8_t *)pvDest,
+                           (FAR const uint16_t *)pvBuf + usOffset, usCount);
+        }
+      else
+        {
+          memcpy(pvDest, (FAR const uint16_t *)pvBuf + usOffset,
+                 (size_t)usCount * sizeof(uint16_t));
+        }
+
+      MB_REGMAP_BARRIER();
+      if (bDouble ? pxBlock->ulSeq - ulSeq < 2 :
+          (ulSeq & 1) == 0 && pxBlock->ulSeq == ulSeq)
+        {
+          return MB_ENOERR;
+        }
+    }
+
+  return MB_ETIMEDOUT;
+}
+
+static inline void prvvMBRegMapBeginWrite(FAR struct mbregblock_s *pxBlock)
+{
+  pxBlock->ulSeq++;
+  MB_REGMAP_BARRIER();
+}
+
+static inline void prvvMBRegMapEndWrite(FAR struct mbregblock_s *pxBlock)
+{
+  MB_REGMAP_BARRIER();
+  pxBlock->ulSeq++;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+eMBErrorCode eMBRegMapRegister(eMBRegMapClass eClass, uint16_t usAddress,
+                               uint16_t usCount, FAR void *pvBuffer,
+                               FAR void *pvBackBuffer)
+{
+  FAR struct mbregblock_s *pxBlock;
+
+  if ((unsigned int)eClass >= MB_REGMAP_NCLASSES)
+    {
+      return MB_EINVAL;
+    }
+
+  pxBlock = &xBlocks[eClass];
+
+  if (pvBuffer == NULL)
+    {
+      memset(pxBlock, 0, sizeof(*pxBlock));
+      return MB_ENOERR;
+    }
+
+  if (usCount == 0 || (uint32_t)usAddress + usCount > 0x10000 ||
+      (pvBackBuffer != NULL && eClass != MB_REGMAP_DISCRETE &&
+       eClass != MB_REGMAP_INPUT))
+    {
+      return MB_EINVAL;
+    }
+
+  if (pvBackBuffer != NULL)
+    {
+      memcpy(pvBackBuffer, pvBuffer, prvzMBRegMapSize(eClass, usCount));
+    }
+
+  pxBlock->usAddress = usAddress;
+  pxBlock->usCount   = usCount;
+  pxBlock->apvBuf[0] = pvBuffer;
+  pxBlock->apvBuf[1] = pvBackBuffer;
+  pxBlock->ucFront   = 0;
+  pxBlock->ulSeq     = 0;
+  return MB_ENOERR;
+}
+
+FAR void *pvMBRegMapBeginUpdate(eMBRegMapClass eClass)
+{
+  FAR struct mbregblock_s *pxBlock;
+  uint8_t ucBack;
+
+  if (eClass != MB_REGMAP_DISCRETE && eClass != MB_REGMAP_INPUT)
+    {
+      return NULL;
+    }
+
+  pxBlock = &xBlocks[eClass];
+  if (pxBlock->apvBuf[0] == NULL)
+    {
+      return NULL;
+    }
+
+  prvvMBRegMapBeginWrite(pxBlock);
+  if (pxBlock->apvBuf[1] == NULL)
+    {
+      return pxBlock->apvBuf[0];
+    }
+
+  /* Start from the values being served so that the caller need only
+   * change what differs.
+   */
+
+  ucBack = pxBlock->ucFront ^ 1;
+  memcpy(pxBlock->apvBuf[ucBack], pxBlock->apvBuf[pxBlock->ucFront],
+         prvzMBRegMapSize(eClass, pxBlock->usCount));
+  return pxBlock->apvBuf[ucBack];
+}
+
+void vMBRegMapCommit(eMBRegMapClass eClass)
+{
+  FAR struct mbregblock_s *pxBlock;
+
+  if (eClass != MB_REGMAP_DISCRETE && eClass != MB_REGMAP_INPUT)
+    {
+      return;
+    }
+
+  pxBlock = &xBlocks[eClass];
+  if (pxBlock->apvBuf[1] != NULL)
+    {
+      MB_REGMAP_BARRIER();
+      pxBlock->ucFront ^= 1;
+    }
+
+  prvvMBRegMapEndWrite(pxBlock);
+}
+
+eMBErrorCode eMBRegMapRead(eMBRegMapClass eClass, uint16_t usAddress,
+                           uint16_t usCount, FAR void *pvDest)
+{
+  FAR struct mbregblock_s *pxBlock;
+
+  if ((unsigned int)eClass >= MB_REGMAP_NCLASSES)
+    {
+      return MB_EINVAL;
+    }
+
+  pxBlock = prvpxMBRegMapFind(eClass, usAddress, usCount);
+  if (pxBlock == NULL)
+    {
+      return MB_ENOREG;
+    }
+
+  return prveMBRegMapSnapshot(pxBlock, prvbMBRegMapIsBits(eClass),
+                              usAddress, usCount, pvDest, false);
+}
+
+/****************************************************************************
+ * Name: eMBRegInputCB, eMBRegHoldingCB, eMBRegCoilsCB, eMBRegDiscreteCB
+ *
+ * Description:
+ *   The FreeModBus register callbacks, served from the register map.
+ *
+ ****************************************************************************/
+
+eMBErrorCode eMBRegInputCB(uint8_t *pucRegBuffer, uint16_t usAddress,
+                           uint16_t usNRegs)
+{
+  FAR struct mbregblock_s *pxBlock;
+
+  pxBlock = prvpxMBRegMapFind(MB_REGMAP_INPUT, usAddress, usNRegs);
+  if (pxBlock == NULL)
+    {
+      return MB_ENOREG;
+    }
+
+  return prveMBRegMapSnapshot(pxBlock, false, usAddress, usNRegs,
+                              pucRegBuffer, true);
+}
+
+eMBErrorCode eMBRegHoldingCB(uint8_t *pucRegBuffer, uint16_t usAddress,
+                             uint16_t usNRegs, eMBRegisterMode eMode)
+{
+  FAR struct mbregblock_s *pxBlock;
+
+  pxBlock = prvpxMBRegMapFind(MB_REGMAP_HOLDING, usAddress, usNRegs);
+  if (pxBlock == NULL)
+    {
+      return MB_ENOREG;
+    }
+
+  if (eMode == MB_REG_READ)
+    {
+      return prveMBRegMapSnapshot(pxBlock, false, usAddress, usNRegs,
+                                  pucRegBuffer, true);
+    }
+
+  prvvMBRegMapBeginWrite(pxBlock);
+  prvvMBRegMapUnpack((FAR uint16_t *)pxBlock->apvBuf[0] +
+                     (usAddress - pxBlock->usAddress),
+                     pucRegBuffer, usNRegs);
+  prvvMBRegMapEndWrite(pxBlock);
+  return MB_ENOERR;
+}
+
+eMBErrorCode eMBRegCoilsCB(uint8_t *pucRegBuffer, uint16_t usAddress,
+                           uint16_t usNCoils, eMBRegisterMode eMode)
+{
+  FAR struct mbregblock_s *pxBlock;
+
+  pxBlock = prvpxMBRegMapFind(MB_REGMAP_COILS, usAddress, usNCoils);
+  if (pxBlock == NULL)
+    {
+      return MB_ENOREG;
+    }
+
+  if (eMode == MB_REG_READ)
+    {
+      return prveMBRegMapSnapshot(pxBlock, true, usAddress, usNCoils,
+                                  pucRegBuffer, true);
+    }
+
+  prvvMBRegMapBeginWrite(pxBlock);
+  prvvMBRegMapSetBits((FAR uint8_t *)pxBlock->apvBuf[0],
+                      usAddress - pxBlock->usAddress, pucRegBuffer,
+                      usNCoils);
+  prvvMBRegMapEndWrite(pxBlock);
+  return MB_ENOERR;
+}
+
+eMBErrorCode eMBRegDiscreteCB(uint8_t *pucRegBuffer, uint16_t usAddress,
+                              uint16_t usNDiscrete)
+{
+  FAR struct mbregblock_s *pxBlock;
+
+  pxBlock = prvpxMBRegMapFind(MB_REGMAP_DISCRETE, usAddress, usNDiscrete);
+  if (pxBlock == NULL)
+    {
+      return MB_ENOREG;
+    }
+
+  return prveMBRegMapSnapshot(pxBlock, true, usAddress, usNDiscrete,
+                              pucRegBuffer, true);
+}
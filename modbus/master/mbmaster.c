@@ -0,0 +1,778 @@
+/****************************************************************************
+ * apps/modbus/master/mbmaster.c
+ * Asynchronous Modbus RTU master
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <errno.h>
+
+#ifdef CONFIG_SERIAL_TERMIOS
+#  include <termios.h>
+#endif
+
+#include "port.h"
+
+#include <apps/modbus/mbmaster.h>
+#include <apps/modbus/mbproto.h>
+
+#include "mbcrc.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifdef CONFIG_CLOCK_MONOTONIC
+#  define MB_MASTER_CLOCK       CLOCK_MONOTONIC
+#else
+#  define MB_MASTER_CLOCK       CLOCK_REALTIME
+#endif
+
+/* Request states */
+
+#define REQ_FREE                0
+#define REQ_QUEUED              1
+#define REQ_ACTIVE              2
+
+/* Master states */
+
+#define MASTER_IDLE             0
+#define MASTER_WAIT             1
+
+#define MB_WRITE_MUL_REGCNT_MAX 123
+
+/* Wrap-around safe comparison of two microsecond time stamps */
+
+#define TIME_REACHED(now, t)    ((int32_t)((now) - (t)) >= 0)
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static uint32_t prvulMBMasterNow(void)
+{
+  struct timespec ts;
+
+  (void)clock_gettime(MB_MASTER_CLOCK, &ts);
+  return (uint32_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void prvvMBMasterComplete(FAR struct mbmaster_req_s *pxReq,
+                                 eMBMasterReqErrCode eStatus,
+                                 FAR const uint16_t *pusRegs)
+{
+  pvMBMasterAsyncCB pvCallback = pxReq->pvCallback;
+  FAR void *pvArg = pxReq->pvArg;
+  uint16_t usNRegs = pxReq->usNRegs;
+
+  /* Free the slot first so that the callback can reuse it */
+
+  pxReq->ucState = REQ_FREE;
+  if (pvCallback != NULL)
+    {
+      pvCallback(pvArg, eStatus, pusRegs, usNRegs);
+    }
+}
+
+/* Complete all requests carried by the active frame */
+
+static void prvvMBMasterFinish(FAR struct mbmaster_s *pxMaster,
+                               eMBMasterReqErrCode eStatus)
+{
+  FAR struct mbmaster_req_s *pxReq;
+  FAR const uint16_t *pusRegs;
+  int i;
+
+  pxMaster->ucState     = MASTER_IDLE;
+  pxMaster->ulIdleUntil = prvulMBMasterNow() + pxMaster->ulT35;
+
+  for (i = 0; i < CONFIG_MB_MASTER_ASYNC_NREQUESTS; i++)
+    {
+      pxReq = &pxMaster->axReqs[i];
+      if (pxReq->ucState != REQ_ACTIVE)
+        {
+          continue;
+        }
+
+      pusRegs = NULL;
+      if (eStatus == MB_MRE_NO_ERR &&
+          (pxReq->ucFunction == MB_FUNC_READ_HOLDING_REGISTER ||
+           pxReq->ucFunction == MB_FUNC_READ_INPUT_REGISTER))
+        {
+          pusRegs = &pxMaster->ausRegs[pxReq->usRegAddr -
+                                       pxMaster->usRegAddr];
+        }
+
+      prvvMBMasterComplete(pxReq, eStatus, pusRegs);
+    }
+}
+
+static bool prvbMBMasterIsRead(uint8_t ucFunction)
+{
+  return ucFunction == MB_FUNC_READ_HOLDING_REGISTER ||
+         ucFunction == MB_FUNC_READ_INPUT_REGISTER;
+}
+
+/* Pick the next request to send.  Slaves are served round-robin starting
+ * at ucNextSlave, and requests to the same slave in queue order.
+ */
+
+static FAR struct mbmaster_req_s *
+prvpxMBMasterNext(FAR struct mbmaster_s *pxMaster)
+{
+  FAR struct mbmaster_req_s *pxBest = NULL;
+  FAR struct mbmaster_req_s *pxReq;
+  uint8_t ucDist;
+  uint8_t ucBestDist = 0;
+  int i;
+
+  for (i = 0; i < CONFIG_MB_MASTER_ASYNC_NREQUESTS; i++)
+    {
+      pxReq = &pxMaster->axReqs[i];
+      if (pxReq->ucState != REQ_QUEUED)
+        {
+          continue;
+        }
+
+      ucDist = (uint8_t)(pxReq->ucSlave - pxMaster->ucNextSlave);
+      if (pxBest == NULL || ucDist < ucBestDist ||
+          (ucDist == ucBestDist &&
+           (int32_t)(pxReq->ulSeq - pxBest->ulSeq) < 0))
+        {
+          pxBest     = pxReq;
+          ucBestDist = ucDist;
+        }
+    }
+
+  return pxBest;
+}
+
+/* Add all queued reads of the same slave and function to the active
+ * frame, as long as the combined range stays within 125 registers and
+ * the gaps are not larger than usMaxGap.  Reads queued after a write to
+ * the same slave are left alone, so that they see the written values.
+ */
+
+static void prvvMBMasterMerge(FAR struct mbmaster_s *pxMaster)
+{
+  FAR struct mbmaster_req_s *pxReq;
+  uint32_t ulStart = pxMaster->usRegAddr;
+  uint32_t ulEnd   = ulStart + pxMaster->usNRegs;
+  uint32_t ulReqEnd;
+  uint32_t ulWriteSeq = 0;
+  bool bWrite = false;
+  bool bMerged;
+  int i;
+
+  /* Find the oldest write queued to this slave */
+
+  for (i = 0; i < CONFIG_MB_MASTER_ASYNC_NREQUESTS; i++)
+    {
+      pxReq = &pxMaster->axReqs[i];
+      if (pxReq->ucState == REQ_QUEUED &&
+          pxReq->ucSlave == pxMaster->ucSlave &&
+          !prvbMBMasterIsRead(pxReq->ucFunction) &&
+          (!bWrite || (int32_t)(pxReq->ulSeq - ulWriteSeq) < 0))
+        {
+          ulWriteSeq = pxReq->ulSeq;
+          bWrite     = true;
+        }
+    }
+
+  do
+    {
+      bMerged = false;
+      for (i = 0; i < CONFIG_MB_MASTER_ASYNC_NREQUESTS; i++)
+        {
+          pxReq = &pxMaster->axReqs[i];
+          if (pxReq->ucState != REQ_QUEUED || pxReq->bNoMerge ||
+              pxReq->ucSlave != pxMaster->ucSlave ||
+              pxReq->ucFunction != pxMaster->ucFunction ||
+              (bWrite && (int32_t)(pxReq->ulSeq - ulWriteSeq) > 0))
+            {
+              continue;
+            }
+
+          ulReqEnd = (uint32_t)pxReq->usRegAddr + pxReq->usNRegs;
+          if (pxReq->usRegAddr > ulEnd + pxMaster->usMaxGap ||
+              ulReqEnd + pxMaster->usMaxGap < ulStart)
+            {
+              continue;
+            }
+
+          if ((ulReqEnd > ulEnd ? ulReqEnd : ulEnd) -
+              (pxReq->usRegAddr < ulStart ? pxReq->usRegAddr : ulStart) >
+              MB_MASTER_ASYNC_MAXREGS)
+            {
+              continue;
+            }
+
+          if (pxReq->usRegAddr < ulStart)
+            {
+              ulStart = pxReq->usRegAddr;
+            }
+
+          if (ulReqEnd > ulEnd)
+            {
+              ulEnd = ulReqEnd;
+            }
+
+          pxReq->ucState = REQ_ACTIVE;
+          bMerged = true;
+        }
+    }
+  while (bMerged);
+
+  pxMaster->usRegAddr = (uint16_t)ulStart;
+  pxMaster->usNRegs   = (uint16_t)(ulEnd - ulStart);
+}
+
+/* Build and send the next frame, if any request is queued */
+
+static void prvvMBMasterSend(FAR struct mbmaster_s *pxMaster)
+{
+  FAR struct mbmaster_req_s *pxReq;
+  FAR uint8_t *pucBuf = pxMaster->aucBuf;
+  uint16_t usLen;
+  uint16_t usCRC;
+  ssize_t nwritten;
+  int i;
+
+  pxReq = prvpxMBMasterNext(pxMaster);
+  if (pxReq == NULL)
+    {
+      return;
+    }
+
+  pxReq->ucState         = REQ_ACTIVE;
+  pxMaster->ucNextSlave  = pxReq->ucSlave + 1;
+  pxMaster->ucSlave      = pxReq->ucSlave;
+  pxMaster->ucFunction   = pxReq->ucFunction;
+  pxMaster->usRegAddr    = pxReq->usRegAddr;
+  pxMaster->usNRegs      = pxReq->usNRegs;
+
+  if (prvbMBMasterIsRead(pxReq->ucFunction) && !pxReq->bNoMerge)
+    {
+      prvvMBMasterMerge(pxMaster);
+    }
+
+  pucBuf[0] = pxMaster->ucSlave;
+  pucBuf[1] = pxMaster->ucFunction;
+  pucBuf[2] = pxMaster->usRegAddr >> 8;
+  pucBuf[3] = pxMaster->usRegAddr & 0xff;
+
+  if (pxReq->ucFunction == MB_FUNC_WRITE_REGISTER)
+    {
+      pucBuf[4] = pxReq->pusValues[0] >> 8;
+      pucBuf[5] = pxReq->pusValues[0] & 0xff;
+      usLen = 6;
+    }
+  else
+    {
+      pucBuf[4] = pxMaster->usNRegs >> 8;
+      pucBuf[5] = pxMaster->usNRegs & 0xff;
+      usLen = 6;
+
+      if (pxReq->ucFunction == MB_FUNC_WRITE_MULTIPLE_REGISTERS)
+        {
+          pucBuf[usLen++] = 2 * pxReq->usNRegs;
+          for (i = 0; i < pxReq->usNRegs; i++)
+            {
+              pucBuf[usLen++] = pxReq->pusValues[i] >> 8;
+              pucBuf[usLen++] = pxReq->pusValues[i] & 0xff;
+            }
+        }
+    }
+
+  usCRC = usMBCRC16(pucBuf, usLen);
+  pucBuf[usLen++] = usCRC & 0xff;
+  pucBuf[usLen++] = usCRC >> 8;
+
+  /* Discard anything left over from an earlier frame, e.g. a late answer
+   * to a request that timed out.
+   */
+
+#ifdef CONFIG_SERIAL_TERMIOS
+  (void)tcflush(pxMaster->fd, TCIFLUSH);
+#else
+  while (read(pxMaster->fd, pxMaster->aucBuf + usLen,
+              sizeof(pxMaster->aucBuf) - usLen) > 0)
+    {
+    }
+#endif
+
+  /* The port is non-blocking, but a complete request fits into the
+   * serial driver's buffer.
+   */
+
+  nwritten = write(pxMaster->fd, pucBuf, usLen);
+  pxMaster->ulFrames++;
+  pxMaster->usRxLen = 0;
+
+  if (nwritten != usLen)
+    {
+      vMBPortLog(MB_LOG_ERROR, "MBM-SEND", "write failed: %d\n", errno);
+      prvvMBMasterFinish(pxMaster, MB_MRE_REV_DATA);
+    }
+  else if (pxMaster->ucSlave == MB_ADDRESS_BROADCAST)
+    {
+      /* There is no response to a broadcast.  Give the slaves the
+       * response timeout to process it before the next request.
+       */
+
+      prvvMBMasterFinish(pxMaster, MB_MRE_NO_ERR);
+      pxMaster->ulIdleUntil = prvulMBMasterNow() +
+                              (uint32_t)pxMaster->usTimeoutMs * 1000;
+    }
+  else
+    {
+      pxMaster->ucState    = MASTER_WAIT;
+      pxMaster->ulDeadline = prvulMBMasterNow() +
+                             (uint32_t)pxMaster->usTimeoutMs * 1000;
+    }
+}
+
+/* Return the length of the expected response, or 0 if not enough of it
+ * has been received to tell.
+ */
+
+static uint16_t prvusMBMasterRespLen(FAR struct mbmaster_s *pxMaster)
+{
+  FAR const uint8_t *pucBuf = pxMaster->aucBuf;
+
+  if (pxMaster->usRxLen < 2)
+    {
+      return 0;
+    }
+
+  if ((pucBuf[1] & MB_FUNC_ERROR) != 0)
+    {
+      return 5;
+    }
+
+  if (prvbMBMasterIsRead(pxMaster->ucFunction))
+    {
+      return pxMaster->usRxLen < 3 ? 0 : 5 + pucBuf[2];
+    }
+
+  return 8;
+}
+
+/* A complete response has been received */
+
+static void prvvMBMasterResponse(FAR struct mbmaster_s *pxMaster,
+                                 uint16_t usLen)
+{
+  FAR const uint8_t *pucBuf = pxMaster->aucBuf;
+  FAR struct mbmaster_req_s *pxReq;
+  int nActive = 0;
+  int i;
+
+  if (usMBCRC16((FAR uint8_t *)pucBuf, usLen) != 0 ||
+      pucBuf[0] != pxMaster->ucSlave ||
+      (pucBuf[1] & ~MB_FUNC_ERROR) != pxMaster->ucFunction)
+    {
+      prvvMBMasterFinish(pxMaster, MB_MRE_REV_DATA);
+      return;
+    }
+
+  if ((pucBuf[1] & MB_FUNC_ERROR) != 0)
+    {
+      /* If several requests were merged, one of them or a register in a
+       * gap between them does not exist.  Retry them one by one.
+       */
+
+      for (i = 0; i < CONFIG_MB_MASTER_ASYNC_NREQUESTS; i++)
+        {
+          nActive += pxMaster->axReqs[i].ucState == REQ_ACTIVE;
+        }
+
+      if (nActive > 1)
+        {
+          for (i = 0; i < CONFIG_MB_MASTER_ASYNC_NREQUESTS; i++)
+            {
+              pxReq = &pxMaster->axReqs[i];
+              if (pxReq->ucState == REQ_ACTIVE)
+                {
+                  pxReq->ucState  = REQ_QUEUED;
+                  pxReq->bNoMerge = true;
+                }
+            }
+
+          pxMaster->ucState     = MASTER_IDLE;
+          pxMaster->ulIdleUntil = prvulMBMasterNow() + pxMaster->ulT35;
+          return;
+        }
+
+      prvvMBMasterFinish(pxMaster, MB_MRE_EXE_FUN);
+      return;
+    }
+
+  if (prvbMBMasterIsRead(pxMaster->ucFunction))
+    {
+      if (pucBuf[2] != 2 * pxMaster->usNRegs)
+        {
+          prvvMBMasterFinish(pxMaster, MB_MRE_REV_DATA);
+          return;
+        }
+
+      for (i = 0; i < pxMaster->usNRegs; i++)
+        {
+          pxMaster->ausRegs[i] = ((uint16_t)pucBuf[3 + 2 * i] << 8) |
+                                 pucBuf[4 + 2 * i];
+        }
+    }
+
+  prvvMBMasterFinish(pxMaster, MB_MRE_NO_ERR);
+}
+
+static void prvvMBMasterReceive(FAR struct mbmaster_s *pxMaster)
+{
+  uint16_t usExpected;
+  ssize_t nread;
+
+  nread = read(pxMaster->fd, &pxMaster->aucBuf[pxMaster->usRxLen],
+               sizeof(pxMaster->aucBuf) - pxMaster->usRxLen);
+  if (nread <= 0)
+    {
+      return;
+    }
+
+  pxMaster->usRxLen += nread;
+
+  /* The length of the response is known from its header, so there is no
+   * need to wait for the t3.5 gap.
+   */
+
+  usExpected = prvusMBMasterRespLen(pxMaster);
+  if (usExpected > sizeof(pxMaster->aucBuf))
+    {
+      prvvMBMasterFinish(pxMaster, MB_MRE_REV_DATA);
+    }
+  else if (usExpected > 0 && pxMaster->usRxLen >= usExpected)
+    {
+      prvvMBMasterResponse(pxMaster, usExpected);
+    }
+  else if (pxMaster->usRxLen >= sizeof(pxMaster->aucBuf))
+    {
+      prvvMBMasterFinish(pxMaster, MB_MRE_REV_DATA);
+    }
+}
+
+static eMBErrorCode prveMBMasterQueue(FAR struct mbmaster_s *pxMaster,
+                                      uint8_t ucSlave, uint8_t ucFunction,
+                                      uint16_t usRegAddr, uint16_t usNRegs,
+                                      FAR const uint16_t *pusValues,
+                                      pvMBMasterAsyncCB pvCallback,
+                                      FAR void *pvArg)
+{
+  FAR struct mbmaster_req_s *pxReq;
+  int i;
+
+  if (pxMaster->fd < 0 || ucSlave > MB_ADDRESS_MAX ||
+      (ucSlave == MB_ADDRESS_BROADCAST && prvbMBMasterIsRead(ucFunction)) ||
+      (uint32_t)usRegAddr + usNRegs > 0x10000)
+    {
+      return MB_EINVAL;
+    }
+
+  for (i = 0; i < CONFIG_MB_MASTER_ASYNC_NREQUESTS; i++)
+    {
+      pxReq = &pxMaster->axReqs[i];
+      if (pxReq->ucState == REQ_FREE)
+        {
+          pxReq->ucState    = REQ_QUEUED;
+          pxReq->ucSlave    = ucSlave;
+          pxReq->ucFunction = ucFunction;
+          pxReq->bNoMerge   = false;
+          pxReq->usRegAddr  = usRegAddr;
+          pxReq->usNRegs    = usNRegs;
+          pxReq->ulSeq      = pxMaster->ulSeq++;
+          pxReq->pusValues  = pusValues;
+          pxReq->pvCallback = pvCallback;
+          pxReq->pvArg      = pvArg;
+          return MB_ENOERR;
+        }
+    }
+
+  return MB_ENORES;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+eMBErrorCode eMBMasterAsyncInit(FAR struct mbmaster_s *pxMaster,
+                                FAR const char *pcDevice,
+                                speed_t ulBaudRate, eMBParity eParity)
+{
+#ifdef CONFIG_SERIAL_TERMIOS
+  struct termios xTIO;
+#endif
+
+  memset(pxMaster, 0, sizeof(*pxMaster));
+  pxMaster->usTimeoutMs = CONFIG_MB_MASTER_ASYNC_TIMEOUT;
+  pxMaster->usMaxGap    = CONFIG_MB_MASTER_ASYNC_MAXGAP;
+
+  /* t3.5 is fixed at 1750us above 19200 baud, otherwise it is 3.5
+   * characters of 11 bits.
+   */
+
+  pxMaster->ulT35 = ulBaudRate > 19200 ? 1750 : 38500000 / ulBaudRate;
+  pxMaster->ulIdleUntil = prvulMBMasterNow();
+
+  pxMaster->fd = open(pcDevice, O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (pxMaster->fd < 0)
+    {
+      vMBPortLog(MB_LOG_ERROR, "MBM-INIT", "Can't open %s: %d\n",
+                 pcDevice, errno);
+      return MB_EPORTERR;
+    }
+
+#ifdef CONFIG_SERIAL_TERMIOS
+  memset(&xTIO, 0, sizeof(xTIO));
+  xTIO.c_iflag = IGNBRK | INPCK;
+  xTIO.c_cflag = CREAD | CLOCAL | CS8;
+
+  if (eParity == MB_PAR_EVEN)
+    {
+      xTIO.c_cflag |= PARENB;
+    }
+  else if (eParity == MB_PAR_ODD)
+    {
+      xTIO.c_cflag |= PARENB | PARODD;
+    }
+
+  if (cfsetispeed(&xTIO, ulBaudRate) != 0 ||
+      tcsetattr(pxMaster->fd, TCSANOW, &xTIO) != 0)
+    {
+      vMBPortLog(MB_LOG_ERROR, "MBM-INIT", "Can't configure %s: %d\n",
+                 pcDevice, errno);
+      (void)close(pxMaster->fd);
+      pxMaster->fd = -1;
+      return MB_EPORTERR;
+    }
+#else
+  (void)eParity;
+#endif
+
+  return MB_ENOERR;
+}
+
+void vMBMasterAsyncClose(FAR struct mbmaster_s *pxMaster)
+{
+  int i;
+
+  if (pxMaster->fd >= 0)
+    {
+      (void)close(pxMaster->fd);
+      pxMaster->fd = -1;
+    }
+
+  pxMaster->ucState = MASTER_IDLE;
+  for (i = 0; i < CONFIG_MB_MASTER_ASYNC_NREQUESTS; i++)
+    {
+      if (pxMaster->axReqs[i].ucState != REQ_FREE)
+        {
+          prvvMBMasterComplete(&pxMaster->axReqs[i], MB_MRE_MASTER_BUSY,
+                               NULL);
+        }
+    }
+}
+
+eMBErrorCode eMBMasterAsyncReadHolding(FAR struct mbmaster_s *pxMaster,
+                                       uint8_t ucSlave, uint16_t usRegAddr,
+                                       uint16_t usNRegs,
+                                       pvMBMasterAsyncCB pvCallback,
+                                       FAR void *pvArg)
+{
+  if (usNRegs < 1 || usNRegs > MB_MASTER_ASYNC_MAXREGS)
+    {
+      return MB_EINVAL;
+    }
+
+  return prveMBMasterQueue(pxMaster, ucSlave, MB_FUNC_READ_HOLDING_REGISTER,
+                           usRegAddr, usNRegs, NULL, pvCallback, pvArg);
+}
+
+eMBErrorCode eMBMasterAsyncReadInput(FAR struct mbmaster_s *pxMaster,
+                                     uint8_t ucSlave, uint16_t usRegAddr,
+                                     uint16_t usNRegs,
+                                     pvMBMasterAsyncCB pvCallback,
+                                     FAR void *pvArg)
+{
+  if (usNRegs < 1 || usNRegs > MB_MASTER_ASYNC_MAXREGS)
+    {
+      return MB_EINVAL;
+    }
+
+  return prveMBMasterQueue(pxMaster, ucSlave, MB_FUNC_READ_INPUT_REGISTER,
+                           usRegAddr, usNRegs, NULL, pvCallback, pvArg);
+}
+
+eMBErrorCode eMBMasterAsyncWriteHolding(FAR struct mbmaster_s *pxMaster,
+                                        uint8_t ucSlave, uint16_t usRegAddr,
+                                        uint16_t usNRegs,
+                                        FAR const uint16_t *pusValues,
+                                        pvMBMasterAsyncCB pvCallback,
+                                        FAR void *pvArg)
+{
+  if (usNRegs < 1 || usNRegs > MB_WRITE_MUL_REGCNT_MAX ||
+      pusValues == NULL)
+    {
+      return MB_EINVAL;
+    }
+
+  return prveMBMasterQueue(pxMaster, ucSlave,
+                           usNRegs == 1 ? MB_FUNC_WRITE_REGISTER :
+                                          MB_FUNC_WRITE_MULTIPLE_REGISTERS,
+                           usRegAddr, usNRegs, pusValues, pvCallback, pvArg);
+}
+
+int iMBMasterAsyncPoll(FAR struct mbmaster_s **ppxMasters, int nMasters,
+                       int iTimeoutMs)
+{
+  FAR struct mbmaster_s *pxMaster;
+  struct pollfd axFds[MB_MASTER_ASYNC_MAXPOLL];
+  uint32_t ulNow;
+  int32_t lWait;
+  int nPending = 0;
+  int ret;
+  int i;
+  int j;
+
+  if (nMasters < 1 || nMasters > MB_MASTER_ASYNC_MAXPOLL)
+    {
+      errno = EINVAL;
+      return -1;
+    }
+
+  /* Start new transactions and work out how long poll() may sleep: until
+   * a response deadline or the end of an inter-frame delay, whichever
+   * comes first.
+   */
+
+  ulNow = prvulMBMasterNow();
+  for (i = 0; i < nMasters; i++)
+    {
+      pxMaster = ppxMasters[i];
+      axFds[i].fd      = -1;
+      axFds[i].events  = POLLIN;
+      axFds[i].revents = 0;
+
+      if (pxMaster->fd < 0)
+        {
+          continue;
+        }
+
+      if (pxMaster->ucState == MASTER_IDLE &&
+          TIME_REACHED(ulNow, pxMaster->ulIdleUntil))
+        {
+          prvvMBMasterSend(pxMaster);
+          ulNow = prvulMBMasterNow();
+        }
+
+      if (pxMaster->ucState == MASTER_WAIT)
+        {
+          axFds[i].fd = pxMaster->fd;
+          lWait = (int32_t)(pxMaster->ulDeadline - ulNow);
+        }
+      else if (prvpxMBMasterNext(pxMaster) != NULL)
+        {
+          lWait = (int32_t)(pxMaster->ulIdleUntil - ulNow);
+        }
+      else
+        {
+          continue;
+        }
+
+      /* A deadline that has already passed must not let poll() sleep */
+
+      if (lWait < 0)
+        {
+          lWait = 0;
+        }
+
+      lWait = (lWait + 999) / 1000;
+      if (iTimeoutMs < 0 || lWait < iTimeoutMs)
+        {
+          iTimeoutMs = lWait;
+        }
+    }
+
+  ret = poll(axFds, nMasters, iTimeoutMs);
+  if (ret < 0 && errno != EINTR)
+    {
+      return -1;
+    }
+
+  ulNow = prvulMBMasterNow();
+  for (i = 0; i < nMasters; i++)
+    {
+      pxMaster = ppxMasters[i];
+
+      if (pxMaster->ucState == MASTER_WAIT)
+        {
+          if (ret > 0 && (axFds[i].revents & POLLIN) != 0)
+            {
+              prvvMBMasterReceive(pxMaster);
+            }
+
+          if (pxMaster->ucState == MASTER_WAIT &&
+              TIME_REACHED(ulNow, pxMaster->ulDeadline))
+            {
+              prvvMBMasterFinish(pxMaster, MB_MRE_TIMEDOUT);
+            }
+        }
+
+      for (j = 0; j < CONFIG_MB_MASTER_ASYNC_NREQUESTS; j++)
+        {
+          nPending += pxMaster->axReqs[j].ucState != REQ_FREE;
+        }
+    }
+
+  return nPending;
+}
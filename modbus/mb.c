@@ -90,15 +90,19 @@ static pvMBFrameClose pvMBFrameCloseCur;
 bool(*pxMBFrameCBByteReceived)(void);
 bool(*pxMBFrameCBTransmitterEmpty)(void);
 bool(*pxMBPortCBTimerExpired)(void);
+#ifdef CONFIG_MB_RTU_FRAMEMODE
+bool(*pxMBFrameCBFrameReceived)(const uint8_t *pucFrame, uint16_t usLength);
+#endif
 
 bool(*pxMBFrameCBReceiveFSMCur)(void);
 bool(*pxMBFrameCBTransmitFSMCur)(void);
 
-/* An array of Modbus functions handlers which associates Modbus function
- * codes with implementing functions.
+/* The built-in Modbus function handlers, terminated by MB_FUNC_NONE.  They
+ * are entered into pxFuncHandlers[] the first time the stack is
+ * initialized or a handler is registered.
  */
 
-static xMBFunctionHandler xFuncHandlers[CONFIG_MB_FUNC_HANDLERS_MAX] =
+static const xMBFunctionHandler xFuncDefaults[] =
 {
 #ifdef CONFIG_MB_FUNC_OTHER_REP_SLAVEID_ENABLED
   {MB_FUNC_OTHER_REPORT_SLAVEID, eMBFuncReportSlaveID},
@@ -130,8 +134,36 @@ static xMBFunctionHandler xFuncHandlers[CONFIG_MB_FUNC_HANDLERS_MAX] =
 #ifdef CONFIG_MB_FUNC_READ_DISCRETE_INPUTS_ENABLED
   {MB_FUNC_READ_DISCRETE_INPUTS, eMBFuncReadDiscreteInputs},
 #endif
+  {MB_FUNC_NONE, NULL}
 };
 
+/* Modbus function handlers indexed by function code.  Codes with the
+ * MB_FUNC_ERROR bit set are exception responses and never valid requests.
+ */
+
+static pxMBFunctionHandler pxFuncHandlers[MB_FUNC_ERROR];
+static bool bFuncHandlersInit;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void prvvMBFuncHandlersInit(void)
+{
+  int i;
+
+  if (!bFuncHandlersInit)
+    {
+      for (i = 0; xFuncDefaults[i].ucFunctionCode != MB_FUNC_NONE; i++)
+        {
+          pxFuncHandlers[xFuncDefaults[i].ucFunctionCode] =
+            xFuncDefaults[i].pxHandler;
+        }
+
+      bFuncHandlersInit = true;
+    }
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -141,6 +173,8 @@ eMBErrorCode eMBInit(eMBMode eMode, uint8_t ucSlaveAddress, uint8_t ucPort,
 {
   eMBErrorCode eStatus = MB_ENOERR;
 
+  prvvMBFuncHandlersInit();
+
   /* check preconditions */
 
   if ((ucSlaveAddress == MB_ADDRESS_BROADCAST) ||
@@ -164,6 +198,9 @@ eMBErrorCode eMBInit(eMBMode eMode, uint8_t ucSlaveAddress, uint8_t ucPort,
           pxMBFrameCBByteReceived = xMBRTUReceiveFSM;
           pxMBFrameCBTransmitterEmpty = xMBRTUTransmitFSM;
           pxMBPortCBTimerExpired = xMBRTUTimerT35Expired;
+#ifdef CONFIG_MB_RTU_FRAMEMODE
+          pxMBFrameCBFrameReceived = xMBRTUFrameReceived;
+#endif
 
           eStatus = eMBRTUInit(ucMBAddress, ucPort, ulBaudRate, eParity);
           break;
@@ -178,6 +215,9 @@ eMBErrorCode eMBInit(eMBMode eMode, uint8_t ucSlaveAddress, uint8_t ucPort,
           pxMBFrameCBByteReceived = xMBASCIIReceiveFSM;
           pxMBFrameCBTransmitterEmpty = xMBASCIITransmitFSM;
           pxMBPortCBTimerExpired = xMBASCIITimerT1SExpired;
+#ifdef CONFIG_MB_RTU_FRAMEMODE
+          pxMBFrameCBFrameReceived = NULL;
+#endif
 
           eStatus = eMBASCIIInit(ucMBAddress, ucPort, ulBaudRate, eParity);
           break;
@@ -210,6 +250,8 @@ eMBErrorCode eMBTCPInit(uint16_t ucTCPPort)
 {
   eMBErrorCode eStatus = MB_ENOERR;
 
+  prvvMBFuncHandlersInit();
+
   if ((eStatus = eMBTCPDoInit(ucTCPPort)) != MB_ENOERR)
     {
       eMBState = STATE_DISABLED;
@@ -242,51 +284,19 @@ eMBErrorCode eMBTCPInit(uint16_t ucTCPPort)
 
 eMBErrorCode eMBRegisterCB(uint8_t ucFunctionCode, pxMBFunctionHandler pxHandler)
 {
-  eMBErrorCode  eStatus;
-  int           i;
-
   if ((0 < ucFunctionCode) && (ucFunctionCode <= 127))
     {
       ENTER_CRITICAL_SECTION();
-      if (pxHandler != NULL)
-        {
-          for (i = 0; i < CONFIG_MB_FUNC_HANDLERS_MAX; i++)
-            {
-              if ((xFuncHandlers[i].pxHandler == NULL) ||
-                  (xFuncHandlers[i].pxHandler == pxHandler))
-                {
-                  xFuncHandlers[i].ucFunctionCode = ucFunctionCode;
-                  xFuncHandlers[i].pxHandler = pxHandler;
-                  break;
-                }
-            }
-          eStatus = (i != CONFIG_MB_FUNC_HANDLERS_MAX) ? MB_ENOERR : MB_ENORES;
-        }
-      else
-        {
-          for (i = 0; i < CONFIG_MB_FUNC_HANDLERS_MAX; i++)
-            {
-              if (xFuncHandlers[i].ucFunctionCode == ucFunctionCode)
-                {
-                  xFuncHandlers[i].ucFunctionCode = 0;
-                  xFuncHandlers[i].pxHandler = NULL;
-                  break;
-                }
-            }
+      prvvMBFuncHandlersInit();
 
-          /* Remove can't fail. */
-
-          eStatus = MB_ENOERR;
-        }
+      /* A NULL handler removes the function code */
 
+      pxFuncHandlers[ucFunctionCode] = pxHandler;
       EXIT_CRITICAL_SECTION();
-    }
-  else
-    {
-      eStatus = MB_EINVAL;
+      return MB_ENOERR;
     }
 
-  return eStatus;
+  return MB_EINVAL;
 }
 
 eMBErrorCode eMBClose(void)
@@ -357,7 +367,6 @@ eMBErrorCode eMBPoll(void)
   static uint16_t     usLength;
   static eMBException eException;
 
-  int             i;
   eMBErrorCode    eStatus = MB_ENOERR;
   eMBEventType    eEvent;
 
@@ -394,20 +403,14 @@ eMBErrorCode eMBPoll(void)
 
         case EV_EXECUTE:
           ucFunctionCode = ucMBFrame[MB_PDU_FUNC_OFF];
-          eException = MB_EX_ILLEGAL_FUNCTION;
-          for( i = 0; i < CONFIG_MB_FUNC_HANDLERS_MAX; i++)
+          if ((ucFunctionCode & MB_FUNC_ERROR) == 0 &&
+              pxFuncHandlers[ucFunctionCode] != NULL)
             {
-              /* No more function handlers registered. Abort. */
-
-              if (xFuncHandlers[i].ucFunctionCode == 0)
-                {
-                  break;
-                }
-              else if (xFuncHandlers[i].ucFunctionCode == ucFunctionCode)
-                {
-                  eException = xFuncHandlers[i].pxHandler(ucMBFrame, &usLength);
-                  break;
-                }
+              eException = pxFuncHandlers[ucFunctionCode](ucMBFrame, &usLength);
+            }
+          else
+            {
+              eException = MB_EX_ILLEGAL_FUNCTION;
             }
 
           /* If the request was not sent to the broadcast address we
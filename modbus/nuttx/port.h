@@ -86,6 +86,9 @@ void vMBPortLog(eMBPortLogLevel eLevel, const char *szModule,
 void vMBPortTimerPoll(void);
 bool xMBPortSerialPoll(void);
 bool xMBPortSerialSetTimeout(uint32_t dwTimeoutMs);
+#ifdef CONFIG_MB_TCP_ENABLED
+bool xMBTCPPortPoll(void);
+#endif
 
 #ifdef __cplusplus
 PR_END_EXTERN_C
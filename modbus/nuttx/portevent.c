@@ -33,6 +33,8 @@
  * Included Files
  ****************************************************************************/
 
+#include <nuttx/config.h>
+
 #include <apps/modbus/mb.h>
 #include <apps/modbus/mbport.h>
 
@@ -83,6 +85,12 @@ bool xMBPortEventGet(eMBEventType * eEvent)
 
       (void)xMBPortSerialPoll();
 
+#ifdef CONFIG_MB_TCP_ENABLED
+      /* Service the Modbus TCP connections, if the TCP port is open */
+
+      (void)xMBTCPPortPoll();
+#endif
+
       /* Check if any of the timers have expired. */
 
       vMBPortTimerPoll();
@@ -62,9 +62,12 @@
 #ifdef CONFIG_MB_ASCII_ENABLED
 #define BUF_SIZE    513         /* must hold a complete ASCII frame. */
 #else
-#define BUF_SIZE    256         /* must hold a complete RTU frame. */
+#define BUF_SIZE    257         /* must hold a complete RTU frame and one
+                                 * more byte to detect overlong frames. */
 #endif
 
+#define POLL_MS     50          /* How long to wait for the next frame. */
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -87,23 +90,26 @@ static struct termios xOldTIO;
  ****************************************************************************/
 
 static bool prvbMBPortSerialRead(uint8_t *pucBuffer, uint16_t usNBytes,
-                                 uint16_t *usNBytesRead);
+                                 uint16_t *usNBytesRead, uint32_t ulWaitMs);
 static bool prvbMBPortSerialWrite(uint8_t *pucBuffer, uint16_t usNBytes);
+#ifdef CONFIG_MB_RTU_FRAMEMODE
+static bool prvbMBPortSerialPollFrame(void);
+#endif
 
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
 static bool prvbMBPortSerialRead(uint8_t *pucBuffer, uint16_t usNBytes,
-                                 uint16_t *usNBytesRead)
+                                 uint16_t *usNBytesRead, uint32_t ulWaitMs)
 {
   bool            bResult = true;
   ssize_t         res;
   fd_set          rfds;
   struct timeval  tv;
 
-  tv.tv_sec = 0;
-  tv.tv_usec = 50000;
+  tv.tv_sec = ulWaitMs / 1000;
+  tv.tv_usec = (ulWaitMs % 1000) * 1000;
   FD_ZERO(&rfds);
   FD_SET(iSerialFd, &rfds);
 
@@ -170,6 +176,61 @@ static bool prvbMBPortSerialWrite(uint8_t *pucBuffer, uint16_t usNBytes)
   return left == 0 ? true : false;
 }
 
+#ifdef CONFIG_MB_RTU_FRAMEMODE
+/* Receive complete RTU frames.  The end of a frame is detected when no
+ * further character arrives within t3.5 (ulTimeoutMs, set up by the RTU
+ * layer through xMBPortTimersInit()).  Characters that arrive while the
+ * task is busy are buffered by the serial driver and returned by the next
+ * read, so a late wakeup can not split a frame.
+ */
+
+static bool prvbMBPortSerialPollFrame(void)
+{
+  bool     bOverrun = false;
+  uint16_t usBytesRead;
+
+  while (bRxEnabled)
+    {
+      if (!prvbMBPortSerialRead(&ucBuffer[uiRxBufferPos],
+                                BUF_SIZE - uiRxBufferPos, &usBytesRead,
+                                uiRxBufferPos > 0 || bOverrun ?
+                                ulTimeoutMs : POLL_MS))
+        {
+          vMBPortLog(MB_LOG_ERROR, "SER-POLL",
+                     "read failed on serial device: %d\n", errno);
+          uiRxBufferPos = 0;
+          return false;
+        }
+
+      if (usBytesRead == 0)
+        {
+          /* The line is idle.  Pass the frame on, unless it overflowed
+           * the buffer.
+           */
+
+          if (uiRxBufferPos > 0 && !bOverrun)
+            {
+              (void)pxMBFrameCBFrameReceived(ucBuffer, uiRxBufferPos);
+            }
+
+          uiRxBufferPos = 0;
+          break;
+        }
+
+      uiRxBufferPos += usBytesRead;
+      if (uiRxBufferPos >= BUF_SIZE)
+        {
+          /* Discard everything up to the next gap */
+
+          bOverrun = true;
+          uiRxBufferPos = 0;
+        }
+    }
+
+  return true;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -334,9 +395,17 @@ bool xMBPortSerialPoll(void)
   uint16_t usBytesRead;
   int      i;
 
+#ifdef CONFIG_MB_RTU_FRAMEMODE
+  if (pxMBFrameCBFrameReceived != NULL)
+    {
+      return prvbMBPortSerialPollFrame();
+    }
+#endif
+
   while (bRxEnabled)
     {
-      if (prvbMBPortSerialRead(&ucBuffer[0], BUF_SIZE, &usBytesRead))
+      if (prvbMBPortSerialRead(&ucBuffer[0], BUF_SIZE, &usBytesRead,
+                               POLL_MS))
         {
           if (usBytesRead == 0)
             {
@@ -399,3 +468,17 @@ bool xMBPortSerialGetByte(int8_t *pucByte)
   uiRxBufferPos++;
   return true;
 }
+
+#ifdef CONFIG_MB_RTU_FRAMEMODE
+bool xMBPortSerialPutFrame(const uint8_t *pucFrame, uint16_t usLength)
+{
+  if (!prvbMBPortSerialWrite((uint8_t *)pucFrame, usLength))
+    {
+      vMBPortLog(MB_LOG_ERROR, "SER-POLL",
+                 "write failed on serial device: %d\n", errno);
+      return false;
+    }
+
+  return true;
+}
+#endif
@@ -0,0 +1,601 @@
+/****************************************************************************
+ * apps/modbus/nuttx/porttcp.c
+ * FreeModbus Library: NuttX TCP Port
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <errno.h>
+
+#include <netinet/in.h>
+
+#include "port.h"
+
+#include <apps/modbus/mb.h>
+#include <apps/modbus/mbport.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_MB_TCP_MAXCONN
+#  define CONFIG_MB_TCP_MAXCONN 4
+#endif
+
+#ifndef CONFIG_MB_TCP_PIPELINE
+#  define CONFIG_MB_TCP_PIPELINE 2
+#endif
+
+#ifndef CONFIG_MB_TCP_IDLETIMEOUT
+#  define CONFIG_MB_TCP_IDLETIMEOUT 60
+#endif
+
+#ifdef CONFIG_CLOCK_MONOTONIC
+#  define MB_TCP_CLOCK          CLOCK_MONOTONIC
+#else
+#  define MB_TCP_CLOCK          CLOCK_REALTIME
+#endif
+
+#define MB_TCP_DEFAULT_PORT     502
+
+/* A Modbus TCP ADU is the 7 byte MBAP header followed by up to 253 bytes
+ * of PDU.  The MBAP length field counts the unit identifier and the PDU.
+ */
+
+#define MB_TCP_HDR_SIZE         7
+#define MB_TCP_PID              2
+#define MB_TCP_LEN              4
+#define MB_TCP_BUF_SIZE         (256 + 7)
+
+/* Each connection buffers up to CONFIG_MB_TCP_PIPELINE requests that the
+ * client sent without waiting for the replies, and up to two responses
+ * that the network could not take yet.
+ */
+
+#define MB_TCP_RXBUF_SIZE       (CONFIG_MB_TCP_PIPELINE * MB_TCP_BUF_SIZE)
+#define MB_TCP_TXBUF_SIZE       (2 * MB_TCP_BUF_SIZE)
+
+/* How long xMBTCPPortPoll() waits for network activity.  This paces
+ * eMBPoll() the same way the serial port's select() timeout does.
+ */
+
+#define MB_TCP_POLL_MSEC        50
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct mbtcp_conn_s
+{
+  int      fd;                          /* Socket, -1 if the slot is free */
+  time_t   lastactive;                  /* Time of the last request */
+  uint16_t rxlen;                       /* Bytes buffered in rxbuf */
+  uint16_t txlen;                       /* Bytes buffered in txbuf */
+  uint8_t  rxbuf[MB_TCP_RXBUF_SIZE];    /* Received, unprocessed requests */
+  uint8_t  txbuf[MB_TCP_TXBUF_SIZE];    /* Responses not yet sent */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static int      iListenFd = -1;
+static int      iCurrent  = -1;         /* Connection of the active request */
+static int      iNext;                  /* First connection to look at */
+
+static struct mbtcp_conn_s xConns[CONFIG_MB_TCP_MAXCONN];
+
+static struct pollfd xPollFds[CONFIG_MB_TCP_MAXCONN + 1];
+static int      iPollConn[CONFIG_MB_TCP_MAXCONN + 1];
+
+/* The request handed to the protocol stack.  The response is built in
+ * place, so it must not live in the connection's receive buffer where it
+ * would overwrite requests that are queued behind it.
+ */
+
+static uint8_t  ucFrame[MB_TCP_BUF_SIZE];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static time_t prvtMBTCPNow(void)
+{
+  struct timespec ts;
+
+  (void)clock_gettime(MB_TCP_CLOCK, &ts);
+  return ts.tv_sec;
+}
+
+static void prvvMBTCPConnClose(FAR struct mbtcp_conn_s *pxConn)
+{
+  if (pxConn->fd >= 0)
+    {
+      (void)close(pxConn->fd);
+      pxConn->fd = -1;
+    }
+
+  pxConn->rxlen = 0;
+  pxConn->txlen = 0;
+}
+
+/* Return the length of the complete request at the head of the receive
+ * buffer, zero if more data is needed, or -1 if the client sent something
+ * that is not Modbus TCP.
+ */
+
+static int prviMBTCPFrameLen(FAR struct mbtcp_conn_s *pxConn)
+{
+  FAR const uint8_t *pucBuf = pxConn->rxbuf;
+  uint16_t usLen;
+
+  if (pxConn->rxlen < MB_TCP_HDR_SIZE)
+    {
+      return 0;
+    }
+
+  if (pucBuf[MB_TCP_PID] != 0 || pucBuf[MB_TCP_PID + 1] != 0)
+    {
+      return -1;
+    }
+
+  usLen = ((uint16_t)pucBuf[MB_TCP_LEN] << 8) | pucBuf[MB_TCP_LEN + 1];
+  if (usLen < 2 || usLen > MB_TCP_BUF_SIZE - MB_TCP_LEN - 2)
+    {
+      return -1;
+    }
+
+  usLen += MB_TCP_LEN + 2;
+  return usLen <= pxConn->rxlen ? usLen : 0;
+}
+
+/* Send as much of the pending output as the socket accepts */
+
+static void prvvMBTCPConnFlush(FAR struct mbtcp_conn_s *pxConn)
+{
+  ssize_t nsent;
+
+  while (pxConn->fd >= 0 && pxConn->txlen > 0)
+    {
+      nsent = send(pxConn->fd, pxConn->txbuf, pxConn->txlen, 0);
+      if (nsent < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+
+          if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+              vMBPortLog(MB_LOG_DEBUG, "MBTCP-SEND",
+                         "send failed: %d\n", errno);
+              prvvMBTCPConnClose(pxConn);
+            }
+
+          return;
+        }
+
+      pxConn->txlen -= nsent;
+      memmove(pxConn->txbuf, &pxConn->txbuf[nsent], pxConn->txlen);
+    }
+}
+
+static void prvvMBTCPConnRead(FAR struct mbtcp_conn_s *pxConn)
+{
+  ssize_t nrecvd;
+
+  nrecvd = recv(pxConn->fd, &pxConn->rxbuf[pxConn->rxlen],
+                MB_TCP_RXBUF_SIZE - pxConn->rxlen, 0);
+  if (nrecvd > 0)
+    {
+      pxConn->rxlen += nrecvd;
+      pxConn->lastactive = prvtMBTCPNow();
+    }
+  else if (nrecvd == 0 ||
+           (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK))
+    {
+      prvvMBTCPConnClose(pxConn);
+    }
+}
+
+static void prvvMBTCPAccept(void)
+{
+  FAR struct mbtcp_conn_s *pxConn = NULL;
+#ifdef TCP_NODELAY
+  int iOne = 1;
+#endif
+  int fd;
+  int i;
+
+  fd = accept(iListenFd, NULL, NULL);
+  if (fd < 0)
+    {
+      return;
+    }
+
+  for (i = 0; i < CONFIG_MB_TCP_MAXCONN; i++)
+    {
+      if (xConns[i].fd < 0)
+        {
+          pxConn = &xConns[i];
+          break;
+        }
+    }
+
+  if (pxConn == NULL)
+    {
+      vMBPortLog(MB_LOG_WARN, "MBTCP-ACCEPT",
+                 "Too many connections, rejecting client\n");
+      (void)close(fd);
+      return;
+    }
+
+  (void)fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+#ifdef TCP_NODELAY
+  /* Small responses to pipelined requests must not wait for the ACK of
+   * the previous one.
+   */
+
+  (void)setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &iOne, sizeof(iOne));
+#endif
+
+  pxConn->fd         = fd;
+  pxConn->rxlen      = 0;
+  pxConn->txlen      = 0;
+  pxConn->lastactive = prvtMBTCPNow();
+}
+
+/* Wait up to iTimeout milliseconds for network activity on the listening
+ * socket and on all connections, then service whatever is ready.
+ */
+
+static void prvvMBTCPService(int iTimeout)
+{
+  FAR struct mbtcp_conn_s *pxConn;
+#if CONFIG_MB_TCP_IDLETIMEOUT > 0
+  time_t tNow;
+#endif
+  int nfds;
+  int ret;
+  int i;
+
+  /* Push out the responses queued since the last time around.  Usually
+   * this completes immediately and no POLLOUT is needed.
+   */
+
+  for (i = 0; i < CONFIG_MB_TCP_MAXCONN; i++)
+    {
+      prvvMBTCPConnFlush(&xConns[i]);
+    }
+
+  xPollFds[0].fd      = iListenFd;
+  xPollFds[0].events  = POLLIN;
+  xPollFds[0].revents = 0;
+  nfds = 1;
+
+  for (i = 0; i < CONFIG_MB_TCP_MAXCONN; i++)
+    {
+      pxConn = &xConns[i];
+      if (pxConn->fd >= 0)
+        {
+          xPollFds[nfds].fd      = pxConn->fd;
+          xPollFds[nfds].events  = 0;
+          xPollFds[nfds].revents = 0;
+
+          if (pxConn->rxlen < MB_TCP_RXBUF_SIZE)
+            {
+              xPollFds[nfds].events |= POLLIN;
+            }
+
+          if (pxConn->txlen > 0)
+            {
+              xPollFds[nfds].events |= POLLOUT;
+            }
+
+          iPollConn[nfds++] = i;
+        }
+    }
+
+  ret = poll(xPollFds, nfds, iTimeout);
+  if (ret < 0 && errno != EINTR)
+    {
+      vMBPortLog(MB_LOG_ERROR, "MBTCP-POLL", "poll failed: %d\n", errno);
+    }
+
+  if (ret > 0)
+    {
+      for (i = 1; i < nfds; i++)
+        {
+          pxConn = &xConns[iPollConn[i]];
+
+          if ((xPollFds[i].revents & POLLOUT) != 0)
+            {
+              prvvMBTCPConnFlush(pxConn);
+            }
+
+          if (pxConn->fd >= 0 &&
+              (xPollFds[i].revents & (POLLIN | POLLHUP | POLLERR)) != 0)
+            {
+              /* A hang-up or error is reported by recv() */
+
+              prvvMBTCPConnRead(pxConn);
+            }
+          else if ((xPollFds[i].revents & POLLNVAL) != 0)
+            {
+              prvvMBTCPConnClose(pxConn);
+            }
+        }
+
+      if ((xPollFds[0].revents & POLLIN) != 0)
+        {
+          prvvMBTCPAccept();
+        }
+    }
+
+#if CONFIG_MB_TCP_IDLETIMEOUT > 0
+  /* Drop clients that went away without closing the connection */
+
+  tNow = prvtMBTCPNow();
+  for (i = 0; i < CONFIG_MB_TCP_MAXCONN; i++)
+    {
+      pxConn = &xConns[i];
+      if (pxConn->fd >= 0 &&
+          tNow - pxConn->lastactive > CONFIG_MB_TCP_IDLETIMEOUT)
+        {
+          vMBPortLog(MB_LOG_INFO, "MBTCP-IDLE",
+                     "Closing idle connection\n");
+          prvvMBTCPConnClose(pxConn);
+        }
+    }
+#endif
+}
+
+/* Select the next connection with a complete request, round-robin so a
+ * client pipelining requests can not starve the others.  A connection is
+ * only eligible if there is room to queue the response.
+ */
+
+static bool prvbMBTCPFindRequest(void)
+{
+  FAR struct mbtcp_conn_s *pxConn;
+  int iLen;
+  int n;
+  int i;
+
+  for (n = 0, i = iNext; n < CONFIG_MB_TCP_MAXCONN; n++)
+    {
+      pxConn = &xConns[i];
+      if (++i >= CONFIG_MB_TCP_MAXCONN)
+        {
+          i = 0;
+        }
+
+      if (pxConn->fd < 0 ||
+          pxConn->txlen > MB_TCP_TXBUF_SIZE - MB_TCP_BUF_SIZE)
+        {
+          continue;
+        }
+
+      iLen = prviMBTCPFrameLen(pxConn);
+      if (iLen < 0)
+        {
+          vMBPortLog(MB_LOG_WARN, "MBTCP-RECV",
+                     "Invalid MBAP header, closing connection\n");
+          prvvMBTCPConnClose(pxConn);
+        }
+      else if (iLen > 0)
+        {
+          iCurrent = pxConn - xConns;
+          iNext    = i;
+          return true;
+        }
+    }
+
+  return false;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+bool xMBTCPPortInit(uint16_t usTCPPort)
+{
+  struct sockaddr_in xAddr;
+  int iOne = 1;
+  int i;
+
+  for (i = 0; i < CONFIG_MB_TCP_MAXCONN; i++)
+    {
+      xConns[i].fd = -1;
+      prvvMBTCPConnClose(&xConns[i]);
+    }
+
+  iCurrent = -1;
+  iNext    = 0;
+
+  iListenFd = socket(PF_INET, SOCK_STREAM, 0);
+  if (iListenFd < 0)
+    {
+      vMBPortLog(MB_LOG_ERROR, "MBTCP-INIT",
+                 "Can't create socket: %d\n", errno);
+      return false;
+    }
+
+  (void)setsockopt(iListenFd, SOL_SOCKET, SO_REUSEADDR,
+                   &iOne, sizeof(iOne));
+
+  memset(&xAddr, 0, sizeof(xAddr));
+  xAddr.sin_family      = AF_INET;
+  xAddr.sin_port        = htons(usTCPPort ? usTCPPort : MB_TCP_DEFAULT_PORT);
+  xAddr.sin_addr.s_addr = INADDR_ANY;
+
+  if (bind(iListenFd, (FAR struct sockaddr *)&xAddr, sizeof(xAddr)) < 0 ||
+      listen(iListenFd, CONFIG_MB_TCP_MAXCONN) < 0)
+    {
+      vMBPortLog(MB_LOG_ERROR, "MBTCP-INIT",
+                 "Can't listen on port %d: %d\n", ntohs(xAddr.sin_port),
+                 errno);
+      (void)close(iListenFd);
+      iListenFd = -1;
+      return false;
+    }
+
+  (void)fcntl(iListenFd, F_SETFL, fcntl(iListenFd, F_GETFL) | O_NONBLOCK);
+  return true;
+}
+
+void vMBTCPPortClose(void)
+{
+  vMBTCPPortDisable();
+
+  if (iListenFd >= 0)
+    {
+      (void)close(iListenFd);
+      iListenFd = -1;
+    }
+}
+
+void vMBTCPPortDisable(void)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_MB_TCP_MAXCONN; i++)
+    {
+      prvvMBTCPConnClose(&xConns[i]);
+    }
+
+  iCurrent = -1;
+}
+
+/* Called from xMBPortEventGet() whenever the event queue is empty.  Posts
+ * EV_FRAME_RECEIVED if any connection holds a complete request.  Requests
+ * that are already buffered are dispatched without touching the network;
+ * otherwise this waits up to MB_TCP_POLL_MSEC for something to happen.
+ */
+
+bool xMBTCPPortPoll(void)
+{
+  if (iListenFd < 0)
+    {
+      return false;
+    }
+
+  if (!prvbMBTCPFindRequest())
+    {
+      prvvMBTCPService(MB_TCP_POLL_MSEC);
+      if (!prvbMBTCPFindRequest())
+        {
+          return true;
+        }
+    }
+
+  return xMBPortEventPost(EV_FRAME_RECEIVED);
+}
+
+bool xMBTCPPortGetRequest(FAR uint8_t **ppucMBTCPFrame,
+                          FAR uint16_t *usTCPLength)
+{
+  FAR struct mbtcp_conn_s *pxConn;
+  int iLen;
+
+  if (iCurrent < 0 || xConns[iCurrent].fd < 0)
+    {
+      return false;
+    }
+
+  pxConn = &xConns[iCurrent];
+  iLen   = prviMBTCPFrameLen(pxConn);
+  if (iLen <= 0)
+    {
+      return false;
+    }
+
+  memcpy(ucFrame, pxConn->rxbuf, iLen);
+  pxConn->rxlen -= iLen;
+  memmove(pxConn->rxbuf, &pxConn->rxbuf[iLen], pxConn->rxlen);
+
+  *ppucMBTCPFrame = ucFrame;
+  *usTCPLength    = iLen;
+  return true;
+}
+
+/* Queue the response on the connection the request came from.  It is
+ * sent the next time the port is polled, together with any other
+ * responses generated in the meantime.
+ */
+
+bool xMBTCPPortSendResponse(FAR const uint8_t *pucMBTCPFrame,
+                            uint16_t usTCPLength)
+{
+  FAR struct mbtcp_conn_s *pxConn;
+
+  if (iCurrent < 0)
+    {
+      return false;
+    }
+
+  pxConn   = &xConns[iCurrent];
+  iCurrent = -1;
+
+  if (pxConn->fd < 0)
+    {
+      /* The client went away while the request was processed */
+
+      return true;
+    }
+
+  if (usTCPLength > MB_TCP_TXBUF_SIZE - pxConn->txlen)
+    {
+      prvvMBTCPConnClose(pxConn);
+      return false;
+    }
+
+  memcpy(&pxConn->txbuf[pxConn->txlen], pucMBTCPFrame, usTCPLength);
+  pxConn->txlen += usTCPLength;
+  return true;
+}
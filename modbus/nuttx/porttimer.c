@@ -91,7 +91,7 @@ void vMBPortTimerPoll()
       else
         {
           ulDeltaMS = (xTimeCur.tv_sec - xTimeLast.tv_sec) * 1000L +
-                      (xTimeCur.tv_usec - xTimeLast.tv_usec) * 1000L;
+                      (xTimeCur.tv_usec - xTimeLast.tv_usec) / 1000L;
           if (ulDeltaMS > ulTimeOut)
             {
               bTimeoutEnable = false;
@@ -152,9 +152,19 @@ void eMBRTUStart(void)
    * modbus protocol stack until the bus is free.
    */
 
+#ifdef CONFIG_MB_RTU_FRAMEMODE
+  /* In frame mode the serial port delimits the frames and nothing needs
+   * to be timed here.  A partial frame at startup fails the CRC check.
+   */
+
+  eRcvState = STATE_RX_IDLE;
+  vMBPortSerialEnable(true, false);
+  (void)xMBPortEventPost(EV_READY);
+#else
   eRcvState = STATE_RX_INIT;
   vMBPortSerialEnable(true, false);
   vMBPortTimersEnable();
+#endif
 
   EXIT_CRITICAL_SECTION();
 }
@@ -173,7 +183,7 @@ eMBErrorCode eMBRTUReceive(uint8_t *pucRcvAddress, uint8_t **pucFrame,
   eMBErrorCode eStatus = MB_ENOERR;
 
   ENTER_CRITICAL_SECTION();
-  ASSERT(usRcvBufferPos < MB_SER_PDU_SIZE_MAX);
+  ASSERT(usRcvBufferPos <= MB_SER_PDU_SIZE_MAX);
 
   /* Length and CRC check */
 
@@ -235,10 +245,23 @@ eMBErrorCode eMBRTUSend(uint8_t ucSlaveAddress, const uint8_t *pucFrame, uint16_
       ucRTUBuf[usSndBufferCount++] = (uint8_t)(usCRC16 & 0xFF);
       ucRTUBuf[usSndBufferCount++] = (uint8_t)(usCRC16 >> 8);
 
+#ifdef CONFIG_MB_RTU_FRAMEMODE
+      /* Hand the whole frame to the serial port */
+
+      if (!xMBPortSerialPutFrame((uint8_t *)pucSndBufferCur,
+                                 usSndBufferCount))
+        {
+          eStatus = MB_EIO;
+        }
+
+      vMBPortSerialEnable(true, false);
+      (void)xMBPortEventPost(EV_FRAME_SENT);
+#else
       /* Activate the transmitter. */
 
       eSndState = STATE_TX_XMIT;
       vMBPortSerialEnable(false, true);
+#endif
     }
   else
     {
@@ -316,6 +339,29 @@ bool xMBRTUReceiveFSM(void)
   return xTaskNeedSwitch;
 }
 
+#ifdef CONFIG_MB_RTU_FRAMEMODE
+bool xMBRTUFrameReceived(const uint8_t *pucFrame, uint16_t usLength)
+{
+  /* The port calls this with a complete frame once the line has been
+   * idle for t3.5.  Frames that are too long are ignored, just like in
+   * the character receiver.
+   */
+
+  if (usLength > MB_SER_PDU_SIZE_MAX)
+    {
+      return false;
+    }
+
+  ENTER_CRITICAL_SECTION();
+  memcpy((uint8_t *)ucRTUBuf, pucFrame, usLength);
+  usRcvBufferPos = usLength;
+  eRcvState = STATE_RX_IDLE;
+  EXIT_CRITICAL_SECTION();
+
+  return xMBPortEventPost(EV_FRAME_RECEIVED);
+}
+#endif
+
 bool xMBRTUTransmitFSM(void)
 {
   bool xNeedPoll = false;
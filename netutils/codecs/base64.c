@@ -62,29 +62,102 @@
 #ifdef CONFIG_CODECS_BASE64
 
 /****************************************************************************
- * Private Functions
+ * Pre-processor Definitions
  ****************************************************************************/
 
+/* Decode table values other than 0-63 */
+
+#define B64_PAD     0x40
+#define B64_INVALID 0x80
+
+/* Characters above 0x7f are never part of the alphabet.  Folding the high
+ * bit into the table value keeps the table at 128 entries without a
+ * separate range check.
+ */
+
+#define B64_LOOKUP(tab, ch) ((tab)[(ch) & 0x7f] | ((ch) & 0x80))
+
 /****************************************************************************
- * Name: base64_tab
+ * Private Data
  ****************************************************************************/
 
-static void base64_tab(unsigned char *tab, size_t len, bool websafe)
+static const char g_b64_standard[64] =
+  "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static const char g_b64_websafe[64] =
+  "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+/* Character to sextet maps.  The standard alphabet pads with '=', the web
+ * safe one with '.'.
+ */
+
+static const uint8_t g_b64_decode[2][128] =
 {
-  static const char *_tab =
-    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  {
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x3e, 0x80, 0x80, 0x80, 0x3f,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b,
+    0x3c, 0x3d, 0x80, 0x80, 0x80, 0x40, 0x80, 0x80,
+    0x80, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+    0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+    0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16,
+    0x17, 0x18, 0x19, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20,
+    0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30,
+    0x31, 0x32, 0x33, 0x80, 0x80, 0x80, 0x80, 0x80
+  },
+  {
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x3e, 0x40, 0x80,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b,
+    0x3c, 0x3d, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+    0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+    0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16,
+    0x17, 0x18, 0x19, 0x80, 0x80, 0x80, 0x80, 0x3f,
+    0x80, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20,
+    0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30,
+    0x31, 0x32, 0x33, 0x80, 0x80, 0x80, 0x80, 0x80
+  }
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: base64_flush
+ *
+ * Description:
+ *   Write the bytes held in a partial decode quantum: two sextets make one
+ *   byte, three make two.  A lone sextet carries no complete byte.
+ *
+ ****************************************************************************/
 
-  memset(tab, 0, len);
-  if (len >= 64)
+static FAR uint8_t *base64_flush(uint32_t bits, uint8_t nsextets,
+                                 FAR uint8_t *pos)
+{
+  if (nsextets == 2)
     {
-      memcpy(tab, _tab, 64);
+      *pos++ = (uint8_t)(bits >> 4);
     }
-
-  if (websafe)
+  else if (nsextets == 3)
     {
-      tab[62] = '-';
-      tab[63] = '_';
+      *pos++ = (uint8_t)(bits >> 10);
+      *pos++ = (uint8_t)(bits >> 2);
     }
+
+  return pos;
 }
 
 /****************************************************************************
@@ -112,91 +185,33 @@ static unsigned char *_base64_encode(const unsigned char *src, size_t len,
                                      unsigned char *dst, size_t * out_len,
                                      bool websafe)
 {
+  struct base64_ctx_s ctx;
   unsigned char *out;
-  unsigned char *pos;
-  const unsigned char *end;
-  const unsigned char *in;
   size_t olen;
-/*int line_len; */
-  unsigned char base64_table[64];
-  char ch = '=';
-
-  if (websafe)
-    {
-      ch = '.';
-    }
-
-  base64_tab(base64_table, sizeof(base64_table), websafe);
-  olen = len * 4 / 3 + 4;       /* 3-byte blocks to 4-byte */
-
-#if 0
-  olen += olen / 72; /* line feeds */
-  olen++; /* nul termination */
-  out = malloc(olen);
-  if (out == NULL)
-    {
-      return NULL;
-    }
-#endif
-
-  end = src + len;
-  in = src;
 
   if (dst)
     {
-      pos = out = dst;
+      out = dst;
     }
   else
     {
-      pos = out = malloc(olen);
+      out = malloc(len * 4 / 3 + 4);  /* 3-byte blocks to 4-byte */
       if (out == NULL)
         {
           return NULL;
         }
     }
 
-/*line_len = 0; */
-  while (end - in >= 3)
-    {
-      *pos++ = base64_table[in[0] >> 2];
-      *pos++ = base64_table[((in[0] & 0x03) << 4) | (in[1] >> 4)];
-      *pos++ = base64_table[((in[1] & 0x0f) << 2) | (in[2] >> 6)];
-      *pos++ = base64_table[in[2] & 0x3f];
-      in += 3;
-   /* line_len += 4; */
-    }
+  base64_encode_init(&ctx, websafe);
+  olen  = base64_encode_update(&ctx, src, len, (FAR char *)out);
+  olen += base64_encode_final(&ctx, (FAR char *)out + olen);
+  out[olen] = '\0';
 
-  if (end - in)
-    {
-      *pos++ = base64_table[in[0] >> 2];
-      if (end - in == 1)
-        {
-          *pos++ = base64_table[(in[0] & 0x03) << 4];
-          *pos++ = ch;          /* *pos++ = '='; */
-        }
-      else
-        {
-          *pos++ = base64_table[((in[0] & 0x03) << 4) | (in[1] >> 4)];
-          *pos++ = base64_table[(in[1] & 0x0f) << 2];
-        }
-      *pos++ = ch;              /* *pos++ = '='; */
-   /* line_len += 4; */
-    }
-
-#if 0
-  if (line_len)
-    {
-      *pos++ = '\n';
-    }
-#endif
-
-  *pos = '\0';
   if (out_len)
     {
-      *out_len = pos - out;
+      *out_len = olen;
     }
 
-/*out[*out_len] = '\0'; */
   return out;
 }
 
@@ -223,35 +238,19 @@ static unsigned char *_base64_decode(const unsigned char *src, size_t len,
                               unsigned char *dst, size_t * out_len,
                               bool websafe)
 {
-  unsigned char dtable[256];
+  FAR const uint8_t *dtable = g_b64_decode[websafe ? 1 : 0];
+  struct base64_ctx_s ctx;
   unsigned char *out;
-  unsigned char *pos;
-  unsigned char in[4];
-  unsigned char block[4];
-  unsigned char tmp;
   size_t count;
+  size_t olen;
   size_t i;
-  unsigned char base64_table[64];
-  char ch = '=';
-
-  if (websafe)
-    {
-      ch = '.';
-    }
-  base64_tab(base64_table, sizeof(base64_table), websafe);
 
-  memset(dtable, 0x80, 256);
-  for (i = 0; i < sizeof(base64_table); i++)
-    {
-      dtable[base64_table[i]] = i;
-    }
-
-  dtable[(int)ch] = 0;          /* dtable['='] = 0; */
+  /* The input, including padding, must be a whole number of quanta */
 
   count = 0;
   for (i = 0; i < len; i++)
     {
-      if (dtable[src[i]] != 0x80)
+      if ((B64_LOOKUP(dtable, src[i]) & B64_INVALID) == 0)
         {
           count++;
         }
@@ -264,58 +263,258 @@ static unsigned char *_base64_decode(const unsigned char *src, size_t len,
 
   if (dst)
     {
-      pos = out = dst;
+      out = dst;
     }
   else
     {
-      pos = out = malloc(count);
+      out = malloc(count);
       if (out == NULL)
         {
           return NULL;
         }
     }
 
-  count = 0;
-  for (i = 0; i < len; i++)
+  base64_decode_init(&ctx, websafe);
+  olen  = base64_decode_update(&ctx, (FAR const char *)src, len, out);
+  olen += base64_decode_final(&ctx, out + olen);
+
+  *out_len = olen;
+  return out;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: base64_encode_init
+ ****************************************************************************/
+
+void base64_encode_init(FAR struct base64_ctx_s *ctx, bool websafe)
+{
+  ctx->bits     = 0;
+  ctx->npending = 0;
+  ctx->websafe  = websafe;
+  ctx->done     = false;
+}
+
+/****************************************************************************
+ * Name: base64_encode_update
+ ****************************************************************************/
+
+size_t base64_encode_update(FAR struct base64_ctx_s *ctx,
+                            FAR const uint8_t *src, size_t len,
+                            FAR char *dst)
+{
+  FAR const char *alphabet = ctx->websafe ? g_b64_websafe : g_b64_standard;
+  FAR char *pos = dst;
+  uint32_t bits;
+
+  /* Complete the quantum left over from the previous call */
+
+  if (ctx->npending > 0)
     {
-      tmp = dtable[src[i]];
-      if (tmp == 0x80)
+      while (ctx->npending < 3 && len > 0)
         {
-          continue;
+          ctx->bits = (ctx->bits << 8) | *src++;
+          ctx->npending++;
+          len--;
         }
 
-      in[count] = src[i];
-      block[count] = tmp;
-      count++;
-      if (count == 4)
+      if (ctx->npending < 3)
         {
-          *pos++ = (block[0] << 2) | (block[1] >> 4);
-          *pos++ = (block[1] << 4) | (block[2] >> 2);
-          *pos++ = (block[2] << 6) | block[3];
-          count = 0;
+          return 0;
         }
+
+      bits = ctx->bits;
+      pos[0] = alphabet[bits >> 18];
+      pos[1] = alphabet[(bits >> 12) & 0x3f];
+      pos[2] = alphabet[(bits >> 6) & 0x3f];
+      pos[3] = alphabet[bits & 0x3f];
+      pos += 4;
+
+      ctx->bits     = 0;
+      ctx->npending = 0;
+    }
+
+  /* Bulk: three bytes in, four characters out */
+
+  while (len >= 3)
+    {
+      bits = ((uint32_t)src[0] << 16) | ((uint32_t)src[1] << 8) | src[2];
+      pos[0] = alphabet[bits >> 18];
+      pos[1] = alphabet[(bits >> 12) & 0x3f];
+      pos[2] = alphabet[(bits >> 6) & 0x3f];
+      pos[3] = alphabet[bits & 0x3f];
+      src += 3;
+      pos += 4;
+      len -= 3;
+    }
+
+  /* Hold on to the tail */
+
+  while (len-- > 0)
+    {
+      ctx->bits = (ctx->bits << 8) | *src++;
+      ctx->npending++;
     }
 
-  if (pos > out)
+  return pos - dst;
+}
+
+/****************************************************************************
+ * Name: base64_encode_final
+ ****************************************************************************/
+
+size_t base64_encode_final(FAR struct base64_ctx_s *ctx, FAR char *dst)
+{
+  FAR const char *alphabet = ctx->websafe ? g_b64_websafe : g_b64_standard;
+  char pad = ctx->websafe ? '.' : '=';
+  uint32_t bits = ctx->bits;
+  size_t ret = 0;
+
+  if (ctx->npending == 1)
+    {
+      dst[0] = alphabet[bits >> 2];
+      dst[1] = alphabet[(bits & 0x03) << 4];
+      dst[2] = pad;
+      dst[3] = pad;
+      ret    = 4;
+    }
+  else if (ctx->npending == 2)
     {
-      if (in[2] == ch)          /* if (in[2] == '=') */
+      dst[0] = alphabet[bits >> 10];
+      dst[1] = alphabet[(bits >> 4) & 0x3f];
+      dst[2] = alphabet[(bits & 0x0f) << 2];
+      dst[3] = pad;
+      ret    = 4;
+    }
+
+  ctx->bits     = 0;
+  ctx->npending = 0;
+  return ret;
+}
+
+/****************************************************************************
+ * Name: base64_decode_init
+ ****************************************************************************/
+
+void base64_decode_init(FAR struct base64_ctx_s *ctx, bool websafe)
+{
+  base64_encode_init(ctx, websafe);
+}
+
+/****************************************************************************
+ * Name: base64_decode_update
+ ****************************************************************************/
+
+size_t base64_decode_update(FAR struct base64_ctx_s *ctx,
+                            FAR const char *src, size_t len,
+                            FAR uint8_t *dst)
+{
+  FAR const uint8_t *dtable = g_b64_decode[ctx->websafe ? 1 : 0];
+  FAR const uint8_t *ptr = (FAR const uint8_t *)src;
+  FAR const uint8_t *end = ptr + len;
+  FAR uint8_t *pos = dst;
+  uint32_t bits = ctx->bits;
+  uint8_t npending = ctx->npending;
+  uint8_t v0;
+  uint8_t v1;
+  uint8_t v2;
+  uint8_t v3;
+
+  if (ctx->done)
+    {
+      return 0;
+    }
+
+  while (ptr < end)
+    {
+      /* Fast path: on a quantum boundary, take four characters at a time.
+       * OR-ing the four table values tests them all at once; a quantum
+       * with padding, white space or garbage in it falls through to the
+       * one character at a time path below.
+       */
+
+      if (npending == 0)
         {
-          pos -= 2;
+          while (end - ptr >= 4)
+            {
+              v0 = B64_LOOKUP(dtable, ptr[0]);
+              v1 = B64_LOOKUP(dtable, ptr[1]);
+              v2 = B64_LOOKUP(dtable, ptr[2]);
+              v3 = B64_LOOKUP(dtable, ptr[3]);
+
+              if (((v0 | v1 | v2 | v3) & (B64_PAD | B64_INVALID)) != 0)
+                {
+                  break;
+                }
+
+              bits = ((uint32_t)v0 << 18) | ((uint32_t)v1 << 12) |
+                     ((uint32_t)v2 << 6) | v3;
+              pos[0] = (uint8_t)(bits >> 16);
+              pos[1] = (uint8_t)(bits >> 8);
+              pos[2] = (uint8_t)bits;
+              ptr += 4;
+              pos += 3;
+            }
+
+          bits = 0;
+          if (ptr >= end)
+            {
+              break;
+            }
         }
-      else if (in[3] == ch)     /* else if (in[3] == '=') */
+
+      v0 = B64_LOOKUP(dtable, *ptr);
+      ptr++;
+
+      if ((v0 & B64_INVALID) != 0)
+        {
+          continue;
+        }
+
+      if ((v0 & B64_PAD) != 0)
+        {
+          pos      = base64_flush(bits, npending, pos);
+          bits     = 0;
+          npending = 0;
+          ctx->done = true;
+          break;
+        }
+
+      bits = (bits << 6) | v0;
+      if (++npending == 4)
         {
-          pos--;
+          pos[0] = (uint8_t)(bits >> 16);
+          pos[1] = (uint8_t)(bits >> 8);
+          pos[2] = (uint8_t)bits;
+          pos += 3;
+          npending = 0;
         }
     }
 
-  *out_len = pos - out;
-  return out;
+  ctx->bits     = bits;
+  ctx->npending = npending;
+  return pos - dst;
 }
 
 /****************************************************************************
- * Public Functions
+ * Name: base64_decode_final
  ****************************************************************************/
 
+size_t base64_decode_final(FAR struct base64_ctx_s *ctx, FAR uint8_t *dst)
+{
+  size_t ret;
+
+  ret = base64_flush(ctx->bits, ctx->npending, dst) - dst;
+
+  ctx->bits     = 0;
+  ctx->npending = 0;
+  ctx->done     = true;
+  return ret;
+}
+
 /****************************************************************************
  * Name: base64_encode
  ****************************************************************************/
@@ -0,0 +1,281 @@
+/****************************************************************************
+ * apps/netutils/codecs/hash.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <crc32.h>
+
+#include <apps/netutils/hash.h>
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+#ifdef CONFIG_CODECS_HASH_MD5
+static void hash_md5_init(FAR struct hash_ctx_s *ctx);
+static void hash_md5_update(FAR struct hash_ctx_s *ctx,
+                            FAR const uint8_t *buf, size_t len);
+static void hash_md5_final(FAR struct hash_ctx_s *ctx, FAR uint8_t *digest);
+#endif
+
+#ifdef CONFIG_CODECS_HASH_SHA1
+static void hash_sha1_init(FAR struct hash_ctx_s *ctx);
+static void hash_sha1_update(FAR struct hash_ctx_s *ctx,
+                             FAR const uint8_t *buf, size_t len);
+static void hash_sha1_final(FAR struct hash_ctx_s *ctx,
+                            FAR uint8_t *digest);
+#endif
+
+#ifdef CONFIG_CODECS_HASH_SHA256
+static void hash_sha256_init(FAR struct hash_ctx_s *ctx);
+static void hash_sha256_update(FAR struct hash_ctx_s *ctx,
+                               FAR const uint8_t *buf, size_t len);
+static void hash_sha256_final(FAR struct hash_ctx_s *ctx,
+                              FAR uint8_t *digest);
+#endif
+
+static void hash_crc32_init(FAR struct hash_ctx_s *ctx);
+static void hash_crc32_update(FAR struct hash_ctx_s *ctx,
+                              FAR const uint8_t *buf, size_t len);
+static void hash_crc32_final(FAR struct hash_ctx_s *ctx,
+                             FAR uint8_t *digest);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct hash_algorithm_s g_hash_algorithms[] =
+{
+#ifdef CONFIG_CODECS_HASH_MD5
+  { "md5",    16, hash_md5_init,    hash_md5_update,    hash_md5_final    },
+#endif
+#ifdef CONFIG_CODECS_HASH_SHA1
+  { "sha1",   20, hash_sha1_init,   hash_sha1_update,   hash_sha1_final   },
+#endif
+#ifdef CONFIG_CODECS_HASH_SHA256
+  { "sha256", 32, hash_sha256_init, hash_sha256_update, hash_sha256_final },
+#endif
+  { "crc32",   4, hash_crc32_init,  hash_crc32_update,  hash_crc32_final  }
+};
+
+#define NALGORITHMS (sizeof(g_hash_algorithms) / sizeof(g_hash_algorithms[0]))
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+#ifdef CONFIG_CODECS_HASH_MD5
+static void hash_md5_init(FAR struct hash_ctx_s *ctx)
+{
+  MD5Init(&ctx->u.md5);
+}
+
+static void hash_md5_update(FAR struct hash_ctx_s *ctx,
+                            FAR const uint8_t *buf, size_t len)
+{
+  size_t n;
+
+  /* MD5Update() takes an unsigned length */
+
+  while (len > 0)
+    {
+      n = len < (UINT_MAX & ~63u) ? len : (UINT_MAX & ~63u);
+      MD5Update(&ctx->u.md5, buf, (unsigned)n);
+      buf += n;
+      len -= n;
+    }
+}
+
+static void hash_md5_final(FAR struct hash_ctx_s *ctx, FAR uint8_t *digest)
+{
+  MD5Final(digest, &ctx->u.md5);
+}
+#endif
+
+#ifdef CONFIG_CODECS_HASH_SHA1
+static void hash_sha1_init(FAR struct hash_ctx_s *ctx)
+{
+  sha1_init(&ctx->u.sha1);
+}
+
+static void hash_sha1_update(FAR struct hash_ctx_s *ctx,
+                             FAR const uint8_t *buf, size_t len)
+{
+  sha1_update(&ctx->u.sha1, buf, len);
+}
+
+static void hash_sha1_final(FAR struct hash_ctx_s *ctx,
+                            FAR uint8_t *digest)
+{
+  sha1_final(&ctx->u.sha1, digest);
+}
+#endif
+
+#ifdef CONFIG_CODECS_HASH_SHA256
+static void hash_sha256_init(FAR struct hash_ctx_s *ctx)
+{
+  sha256_init(&ctx->u.sha256);
+}
+
+static void hash_sha256_update(FAR struct hash_ctx_s *ctx,
+                               FAR const uint8_t *buf, size_t len)
+{
+  sha256_update(&ctx->u.sha256, buf, len);
+}
+
+static void hash_sha256_final(FAR struct hash_ctx_s *ctx,
+                              FAR uint8_t *digest)
+{
+  sha256_final(&ctx->u.sha256, digest);
+}
+#endif
+
+/* The IEEE 802.3 CRC-32 as computed by zlib and most tools.  crc32part()
+ * in the C library implements the table driven core without the initial
+ * and final inversion.
+ */
+
+static void hash_crc32_init(FAR struct hash_ctx_s *ctx)
+{
+  ctx->u.crc32 = 0xffffffff;
+}
+
+static void hash_crc32_update(FAR struct hash_ctx_s *ctx,
+                              FAR const uint8_t *buf, size_t len)
+{
+  ctx->u.crc32 = crc32part(buf, len, ctx->u.crc32);
+}
+
+static void hash_crc32_final(FAR struct hash_ctx_s *ctx,
+                             FAR uint8_t *digest)
+{
+  uint32_t crc = ~ctx->u.crc32;
+
+  digest[0] = (uint8_t)(crc >> 24);
+  digest[1] = (uint8_t)(crc >> 16);
+  digest[2] = (uint8_t)(crc >> 8);
+  digest[3] = (uint8_t)crc;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: hash_lookup
+ ****************************************************************************/
+
+FAR const struct hash_algorithm_s *hash_lookup(FAR const char *name)
+{
+  int i;
+
+  for (i = 0; i < NALGORITHMS; i++)
+    {
+      if (strcmp(g_hash_algorithms[i].name, name) == 0)
+        {
+          return &g_hash_algorithms[i];
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: hash_algorithm
+ ****************************************************************************/
+
+FAR const struct hash_algorithm_s *hash_algorithm(int index)
+{
+  if (index < 0 || index >= NALGORITHMS)
+    {
+      return NULL;
+    }
+
+  return &g_hash_algorithms[index];
+}
+
+/****************************************************************************
+ * Name: hash_init
+ ****************************************************************************/
+
+void hash_init(FAR struct hash_ctx_s *ctx,
+               FAR const struct hash_algorithm_s *alg)
+{
+  ctx->alg = alg;
+  alg->init(ctx);
+}
+
+/****************************************************************************
+ * Name: hash_update
+ ****************************************************************************/
+
+void hash_update(FAR struct hash_ctx_s *ctx, FAR const void *buf,
+                 size_t len)
+{
+  ctx->alg->update(ctx, (FAR const uint8_t *)buf, len);
+}
+
+/****************************************************************************
+ * Name: hash_final
+ ****************************************************************************/
+
+void hash_final(FAR struct hash_ctx_s *ctx, FAR uint8_t *digest)
+{
+  ctx->alg->final(ctx, digest);
+}
+
+/****************************************************************************
+ * Name: hash_tohex
+ ****************************************************************************/
+
+void hash_tohex(FAR const uint8_t *digest, size_t len, FAR char *hex)
+{
+  static const char hexchars[] = "0123456789abcdef";
+
+  while (len-- > 0)
+    {
+      *hex++ = hexchars[*digest >> 4];
+      *hex++ = hexchars[*digest++ & 0x0f];
+    }
+
+  *hex = '\0';
+}
@@ -187,13 +187,26 @@ void MD5Update(struct MD5Context *ctx, unsigned char const *buf, unsigned len)
       len -= t;
     }
 
-  /* Process data in 64-byte chunks */
+  /* Process data in 64-byte chunks.  On little-endian machines, word
+   * aligned data is already in the layout MD5Transform() expects and is
+   * hashed where it is.
+   */
 
   while (len >= 64)
     {
-      memcpy(ctx->in, buf, 64);
-      byteReverse(ctx->in, 16);
-      MD5Transform(ctx->buf, (uint32_t *) ctx->in);
+#ifndef CONFIG_ENDIAN_BIG
+      if (((uintptr_t)buf & 3) == 0)
+        {
+          MD5Transform(ctx->buf, (uint32_t const *)buf);
+        }
+      else
+#endif
+        {
+          memcpy(ctx->in, buf, 64);
+          byteReverse(ctx->in, 16);
+          MD5Transform(ctx->buf, (uint32_t *) ctx->in);
+        }
+
       buf += 64;
       len -= 64;
     }
@@ -0,0 +1,279 @@
+/****************************************************************************
+ * apps/netutils/codecs/sha1.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include <apps/netutils/hash.h>
+
+#ifdef CONFIG_CODECS_HASH_SHA1
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define ROL(x, n)  (((x) << (n)) | ((x) >> (32 - (n))))
+
+/* Big-endian loads and stores.  Written with shifts so that they work
+ * at any alignment; compilers turn them into a load and a byte swap where
+ * the architecture has one.
+ */
+
+#define GET32(p) \
+  ((uint32_t)(p)[0] << 24 | (uint32_t)(p)[1] << 16 | \
+   (uint32_t)(p)[2] << 8  | (uint32_t)(p)[3])
+
+#define PUT32(p, v) \
+  do \
+    { \
+      (p)[0] = (uint8_t)((v) >> 24); \
+      (p)[1] = (uint8_t)((v) >> 16); \
+      (p)[2] = (uint8_t)((v) >> 8); \
+      (p)[3] = (uint8_t)(v); \
+    } \
+  while (0)
+
+/* The message schedule is kept as a 16 word ring */
+
+#define W(i) \
+  (w[(i) & 15] = ROL(w[((i) + 13) & 15] ^ w[((i) + 8) & 15] ^ \
+                     w[((i) + 2) & 15] ^ w[(i) & 15], 1))
+
+#define F1(b, c, d) (d ^ (b & (c ^ d)))
+#define F2(b, c, d) (b ^ c ^ d)
+#define F3(b, c, d) ((b & c) | (d & (b | c)))
+
+#define R(a, b, c, d, e, f, k, x) \
+  do \
+    { \
+      e += ROL(a, 5) + f(b, c, d) + k + (x); \
+      b = ROL(b, 30); \
+    } \
+  while (0)
+
+#define R0(a, b, c, d, e, i) R(a, b, c, d, e, F1, 0x5a827999, w[i])
+#define R1(a, b, c, d, e, i) R(a, b, c, d, e, F1, 0x5a827999, W(i))
+#define R2(a, b, c, d, e, i) R(a, b, c, d, e, F2, 0x6ed9eba1, W(i))
+#define R3(a, b, c, d, e, i) R(a, b, c, d, e, F3, 0x8f1bbcdc, W(i))
+#define R4(a, b, c, d, e, i) R(a, b, c, d, e, F2, 0xca62c1d6, W(i))
+
+/* Five rounds with the variables rotated, so that no copies are needed */
+
+#define R5(r, i) \
+  do \
+    { \
+      r(a, b, c, d, e, (i)); \
+      r(e, a, b, c, d, (i) + 1); \
+      r(d, e, a, b, c, (i) + 2); \
+      r(c, d, e, a, b, (i) + 3); \
+      r(b, c, d, e, a, (i) + 4); \
+    } \
+  while (0)
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sha1_transform
+ *
+ * Description:
+ *   Hash nblocks 64 byte blocks starting at data.
+ *
+ ****************************************************************************/
+
+static void sha1_transform(FAR uint32_t state[5], FAR const uint8_t *data,
+                           size_t nblocks)
+{
+  uint32_t w[16];
+  uint32_t a;
+  uint32_t b;
+  uint32_t c;
+  uint32_t d;
+  uint32_t e;
+  int i;
+
+  while (nblocks-- > 0)
+    {
+      for (i = 0; i < 16; i++)
+        {
+          w[i] = GET32(data + 4 * i);
+        }
+
+      a = state[0];
+      b = state[1];
+      c = state[2];
+      d = state[3];
+      e = state[4];
+
+      R5(R0, 0);
+      R5(R0, 5);
+      R5(R0, 10);
+      R(a, b, c, d, e, F1, 0x5a827999, w[15]);
+      R(e, a, b, c, d, F1, 0x5a827999, W(16));
+      R(d, e, a, b, c, F1, 0x5a827999, W(17));
+      R(c, d, e, a, b, F1, 0x5a827999, W(18));
+      R(b, c, d, e, a, F1, 0x5a827999, W(19));
+
+      R5(R2, 20);
+      R5(R2, 25);
+      R5(R2, 30);
+      R5(R2, 35);
+
+      R5(R3, 40);
+      R5(R3, 45);
+      R5(R3, 50);
+      R5(R3, 55);
+
+      R5(R4, 60);
+      R5(R4, 65);
+      R5(R4, 70);
+      R5(R4, 75);
+
+      state[0] += a;
+      state[1] += b;
+      state[2] += c;
+      state[3] += d;
+      state[4] += e;
+
+      data += HASH_BLOCKSIZE;
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sha1_init
+ ****************************************************************************/
+
+void sha1_init(FAR struct sha1_ctx_s *ctx)
+{
+  ctx->state[0] = 0x67452301;
+  ctx->state[1] = 0xefcdab89;
+  ctx->state[2] = 0x98badcfe;
+  ctx->state[3] = 0x10325476;
+  ctx->state[4] = 0xc3d2e1f0;
+  ctx->count[0] = 0;
+  ctx->count[1] = 0;
+}
+
+/****************************************************************************
+ * Name: sha1_update
+ ****************************************************************************/
+
+void sha1_update(FAR struct sha1_ctx_s *ctx, FAR const uint8_t *buf,
+                 size_t len)
+{
+  size_t used = ctx->count[0] & (HASH_BLOCKSIZE - 1);
+  size_t n;
+
+  if ((ctx->count[0] += (uint32_t)len) < (uint32_t)len)
+    {
+      ctx->count[1]++;
+    }
+
+  /* Complete a partial block first */
+
+  if (used > 0)
+    {
+      n = HASH_BLOCKSIZE - used;
+      if (len < n)
+        {
+          memcpy(ctx->buffer + used, buf, len);
+          return;
+        }
+
+      memcpy(ctx->buffer + used, buf, n);
+      sha1_transform(ctx->state, ctx->buffer, 1);
+      buf += n;
+      len -= n;
+    }
+
+  /* Then whole blocks straight from the caller's buffer */
+
+  n = len / HASH_BLOCKSIZE;
+  if (n > 0)
+    {
+      sha1_transform(ctx->state, buf, n);
+      buf += n * HASH_BLOCKSIZE;
+      len -= n * HASH_BLOCKSIZE;
+    }
+
+  memcpy(ctx->buffer, buf, len);
+}
+
+/****************************************************************************
+ * Name: sha1_final
+ ****************************************************************************/
+
+void sha1_final(FAR struct sha1_ctx_s *ctx, FAR uint8_t digest[20])
+{
+  size_t used = ctx->count[0] & (HASH_BLOCKSIZE - 1);
+  uint32_t hi = ctx->count[1] << 3 | ctx->count[0] >> 29;
+  uint32_t lo = ctx->count[0] << 3;
+  int i;
+
+  /* Pad with 0x80, zeros and the 64-bit big-endian length in bits */
+
+  ctx->buffer[used++] = 0x80;
+  if (used > HASH_BLOCKSIZE - 8)
+    {
+      memset(ctx->buffer + used, 0, HASH_BLOCKSIZE - used);
+      sha1_transform(ctx->state, ctx->buffer, 1);
+      used = 0;
+    }
+
+  memset(ctx->buffer + used, 0, HASH_BLOCKSIZE - 8 - used);
+  PUT32(ctx->buffer + HASH_BLOCKSIZE - 8, hi);
+  PUT32(ctx->buffer + HASH_BLOCKSIZE - 4, lo);
+  sha1_transform(ctx->state, ctx->buffer, 1);
+
+  for (i = 0; i < 5; i++)
+    {
+      PUT32(digest + 4 * i, ctx->state[i]);
+    }
+
+  memset(ctx, 0, sizeof(*ctx));
+}
+
+#endif /* CONFIG_CODECS_HASH_SHA1 */
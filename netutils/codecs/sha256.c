@@ -0,0 +1,302 @@
+/****************************************************************************
+ * apps/netutils/codecs/sha256.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include <apps/netutils/hash.h>
+
+#ifdef CONFIG_CODECS_HASH_SHA256
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define ROR(x, n)  (((x) >> (n)) | ((x) << (32 - (n))))
+
+/* Big-endian loads and stores, see sha1.c */
+
+#define GET32(p) \
+  ((uint32_t)(p)[0] << 24 | (uint32_t)(p)[1] << 16 | \
+   (uint32_t)(p)[2] << 8  | (uint32_t)(p)[3])
+
+#define PUT32(p, v) \
+  do \
+    { \
+      (p)[0] = (uint8_t)((v) >> 24); \
+      (p)[1] = (uint8_t)((v) >> 16); \
+      (p)[2] = (uint8_t)((v) >> 8); \
+      (p)[3] = (uint8_t)(v); \
+    } \
+  while (0)
+
+#define CH(x, y, z)  ((z) ^ ((x) & ((y) ^ (z))))
+#define MAJ(x, y, z) (((x) & (y)) | ((z) & ((x) | (y))))
+#define S0(x)        (ROR(x, 2) ^ ROR(x, 13) ^ ROR(x, 22))
+#define S1(x)        (ROR(x, 6) ^ ROR(x, 11) ^ ROR(x, 25))
+#define G0(x)        (ROR(x, 7) ^ ROR(x, 18) ^ ((x) >> 3))
+#define G1(x)        (ROR(x, 17) ^ ROR(x, 19) ^ ((x) >> 10))
+
+/* The message schedule is kept as a 16 word ring */
+
+#define W(i) \
+  (w[(i) & 15] += G1(w[((i) + 14) & 15]) + w[((i) + 9) & 15] + \
+                  G0(w[((i) + 1) & 15]))
+
+/* One round.  The eight working variables are renamed rather than moved
+ * by passing them in rotated order.
+ */
+
+#define R(a, b, c, d, e, f, g, h, x, k) \
+  do \
+    { \
+      uint32_t t1 = h + S1(e) + CH(e, f, g) + (k) + (x); \
+      d += t1; \
+      h = t1 + S0(a) + MAJ(a, b, c); \
+    } \
+  while (0)
+
+#define R8(i, x) \
+  do \
+    { \
+      R(a, b, c, d, e, f, g, h, x(i),     g_k[(i)]); \
+      R(h, a, b, c, d, e, f, g, x(i + 1), g_k[(i) + 1]); \
+      R(g, h, a, b, c, d, e, f, x(i + 2), g_k[(i) + 2]); \
+      R(f, g, h, a, b, c, d, e, x(i + 3), g_k[(i) + 3]); \
+      R(e, f, g, h, a, b, c, d, x(i + 4), g_k[(i) + 4]); \
+      R(d, e, f, g, h, a, b, c, x(i + 5), g_k[(i) + 5]); \
+      R(c, d, e, f, g, h, a, b, x(i + 6), g_k[(i) + 6]); \
+      R(b, c, d, e, f, g, h, a, x(i + 7), g_k[(i) + 7]); \
+    } \
+  while (0)
+
+#define WLOAD(i) w[i]
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const uint32_t g_k[64] =
+{
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+  0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+  0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+  0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+  0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+  0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+  0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+  0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+  0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sha256_transform
+ *
+ * Description:
+ *   Hash nblocks 64 byte blocks starting at data.
+ *
+ ****************************************************************************/
+
+static void sha256_transform(FAR uint32_t state[8], FAR const uint8_t *data,
+                             size_t nblocks)
+{
+  uint32_t w[16];
+  uint32_t a;
+  uint32_t b;
+  uint32_t c;
+  uint32_t d;
+  uint32_t e;
+  uint32_t f;
+  uint32_t g;
+  uint32_t h;
+  int i;
+
+  while (nblocks-- > 0)
+    {
+      for (i = 0; i < 16; i++)
+        {
+          w[i] = GET32(data + 4 * i);
+        }
+
+      a = state[0];
+      b = state[1];
+      c = state[2];
+      d = state[3];
+      e = state[4];
+      f = state[5];
+      g = state[6];
+      h = state[7];
+
+      R8(0, WLOAD);
+      R8(8, WLOAD);
+
+      for (i = 16; i < 64; i += 16)
+        {
+          R8(i, W);
+          R8(i + 8, W);
+        }
+
+      state[0] += a;
+      state[1] += b;
+      state[2] += c;
+      state[3] += d;
+      state[4] += e;
+      state[5] += f;
+      state[6] += g;
+      state[7] += h;
+
+      data += HASH_BLOCKSIZE;
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sha256_init
+ ****************************************************************************/
+
+void sha256_init(FAR struct sha256_ctx_s *ctx)
+{
+  ctx->state[0] = 0x6a09e667;
+  ctx->state[1] = 0xbb67ae85;
+  ctx->state[2] = 0x3c6ef372;
+  ctx->state[3] = 0xa54ff53a;
+  ctx->state[4] = 0x510e527f;
+  ctx->state[5] = 0x9b05688c;
+  ctx->state[6] = 0x1f83d9ab;
+  ctx->state[7] = 0x5be0cd19;
+  ctx->count[0] = 0;
+  ctx->count[1] = 0;
+}
+
+/****************************************************************************
+ * Name: sha256_update
+ ****************************************************************************/
+
+void sha256_update(FAR struct sha256_ctx_s *ctx, FAR const uint8_t *buf,
+                   size_t len)
+{
+  size_t used = ctx->count[0] & (HASH_BLOCKSIZE - 1);
+  size_t n;
+
+  if ((ctx->count[0] += (uint32_t)len) < (uint32_t)len)
+    {
+      ctx->count[1]++;
+    }
+
+  /* Complete a partial block first */
+
+  if (used > 0)
+    {
+      n = HASH_BLOCKSIZE - used;
+      if (len < n)
+        {
+          memcpy(ctx->buffer + used, buf, len);
+          return;
+        }
+
+      memcpy(ctx->buffer + used, buf, n);
+      sha256_transform(ctx->state, ctx->buffer, 1);
+      buf += n;
+      len -= n;
+    }
+
+  /* Then whole blocks straight from the caller's buffer */
+
+  n = len / HASH_BLOCKSIZE;
+  if (n > 0)
+    {
+      sha256_transform(ctx->state, buf, n);
+      buf += n * HASH_BLOCKSIZE;
+      len -= n * HASH_BLOCKSIZE;
+    }
+
+  memcpy(ctx->buffer, buf, len);
+}
+
+/****************************************************************************
+ * Name: sha256_final
+ ****************************************************************************/
+
+void sha256_final(FAR struct sha256_ctx_s *ctx, FAR uint8_t digest[32])
+{
+  size_t used = ctx->count[0] & (HASH_BLOCKSIZE - 1);
+  uint32_t hi = ctx->count[1] << 3 | ctx->count[0] >> 29;
+  uint32_t lo = ctx->count[0] << 3;
+  int i;
+
+  /* Pad with 0x80, zeros and the 64-bit big-endian length in bits */
+
+  ctx->buffer[used++] = 0x80;
+  if (used > HASH_BLOCKSIZE - 8)
+    {
+      memset(ctx->buffer + used, 0, HASH_BLOCKSIZE - used);
+      sha256_transform(ctx->state, ctx->buffer, 1);
+      used = 0;
+    }
+
+  memset(ctx->buffer + used, 0, HASH_BLOCKSIZE - 8 - used);
+  PUT32(ctx->buffer + HASH_BLOCKSIZE - 8, hi);
+  PUT32(ctx->buffer + HASH_BLOCKSIZE - 4, lo);
+  sha256_transform(ctx->state, ctx->buffer, 1);
+
+  for (i = 0; i < 8; i++)
+    {
+      PUT32(digest + 4 * i, ctx->state[i]);
+    }
+
+  memset(ctx, 0, sizeof(*ctx));
+}
+
+#endif /* CONFIG_CODECS_HASH_SHA256 */
@@ -40,7 +40,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
+#include <stdint.h>
 
 #include <apps/netutils/urldecode.h>
 
@@ -48,25 +48,53 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
-#ifdef CONFIG_CODECS_URLCODE
-#  define IS_HEX_CHAR(ch) \
-  ((ch >= '0' && ch <= '9') || \
-   (ch >= 'a' && ch <= 'f') || \
-   (ch >= 'A' && ch <= 'F'))
-
-#  define HEX_VALUE(ch, value) \
-  if (ch >= '0' && ch <= '9') \
-    { \
-      value = ch - '0'; \
-    } \
-  else if (ch >= 'a' && ch <= 'f') \
-    { \
-      value = ch - 'a' + 10; \
-    } \
-  else \
-    { \
-      value = ch - 'A' + 10; \
-    }
+/* Character classes, see g_urlchar[] */
+
+#define URL_HEXVALUE   0x0f  /* Value of a hex digit */
+#define URL_HEX        0x10  /* 0-9, a-f, A-F */
+#define URL_UNRESERVED 0x20  /* Passed through unescaped by the encoder */
+
+/* Characters above 0x7f belong to no class */
+
+#define URL_CLASS(ch) \
+  (((unsigned char)(ch) & 0x80) ? 0 : g_urlchar[(unsigned char)(ch)])
+
+#define IS_HEX_CHAR(ch)   ((URL_CLASS(ch) & URL_HEX) != 0)
+#define HEX_VALUE(ch)     (URL_CLASS(ch) & URL_HEXVALUE)
+#define IS_UNRESERVED(ch) ((URL_CLASS(ch) & URL_UNRESERVED) != 0)
+
+/* Word at a time test for a '%' or '+' among four bytes */
+
+#define HAS_ZERO_BYTE(v) (((v) - 0x01010101) & ~(v) & 0x80808080)
+#define HAS_ESCAPE(v) \
+  (HAS_ZERO_BYTE((v) ^ 0x25252525) | HAS_ZERO_BYTE((v) ^ 0x2b2b2b2b))
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#if defined(CONFIG_CODECS_URLCODE) || \
+    defined(CONFIG_CODECS_URLCODE_NEWMEMORY) || \
+    defined(CONFIG_CODECS_AVR_URLCODE)
+static const uint8_t g_urlchar[128] =
+{
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x20, 0x00,  /* '-' '.' */
+  0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37,  /* '0'-'7' */
+  0x38, 0x39, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  /* '8' '9' */
+  0x00, 0x3a, 0x3b, 0x3c, 0x3d, 0x3e, 0x3f, 0x20,  /* 'A'-'G' */
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x00, 0x00, 0x00, 0x00, 0x20,  /* 'X'-'Z' '_' */
+  0x00, 0x3a, 0x3b, 0x3c, 0x3d, 0x3e, 0x3f, 0x20,  /* 'a'-'g' */
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x00, 0x00, 0x00, 0x20, 0x00   /* 'x'-'z' '~' */
+};
 #endif
 
 /****************************************************************************
@@ -84,7 +112,7 @@
 #ifdef CONFIG_CODECS_URLCODE_NEWMEMORY
 static char from_hex(char ch)
 {
-  return isdigit(ch) ? ch - '0' : tolower(ch) - 'a' + 10;
+  return HEX_VALUE(ch);
 }
 #endif
 
@@ -144,22 +172,7 @@ static void int2h(char c, char *hstr)
 #ifdef CONFIG_CODECS_AVR_URLCODE
 static unsigned char h2int(char c)
 {
-  if (c >= '0' && c <= '9')
-    {
-      return ((unsigned char)c - '0');
-    }
-
-  if (c >= 'a' && c <= 'f')
-    {
-      return ((unsigned char)c - 'a' + 10);
-    }
-
-  if (c >= 'A' && c <= 'F')
-    {
-      return ((unsigned char)c - 'A' + 10);
-    }
-
-  return 0;
+  return HEX_VALUE(c);
 }
 #endif
 
@@ -186,7 +199,7 @@ char *url_encode(char *str)
 
   while (*pstr)
     {
-      if (isalnum(*pstr) || *pstr == '-' || *pstr == '_' || *pstr == '.' ||  *pstr == '~')
+      if (IS_UNRESERVED(*pstr))
         {
           *pbuf++ = *pstr;
         }
@@ -269,10 +282,7 @@ char *urlencode(const char *src, const int src_len, char *dest, int *dest_len)
   pEnd = (unsigned char *)src + src_len;
   for (pSrc = (unsigned char *)src; pSrc < pEnd; pSrc++)
     {
-      if ((*pSrc >= '0' && *pSrc <= '9') ||
-          (*pSrc >= 'a' && *pSrc <= 'z') ||
-          (*pSrc >= 'A' && *pSrc <= 'Z') ||
-          (*pSrc == '_' || *pSrc == '-' || *pSrc == '.' || *pSrc == '~'))
+      if (IS_UNRESERVED(*pSrc))
         {
           *pDest++ = *pSrc;
         }
@@ -301,52 +311,157 @@ char *urlencode(const char *src, const int src_len, char *dest, int *dest_len)
 #ifdef CONFIG_CODECS_URLCODE
 char *urldecode(const char *src, const int src_len, char *dest, int *dest_len)
 {
-  const unsigned char *pSrc;
-  const unsigned char *pEnd;
-  char *pDest;
-  unsigned char cHigh;
-  unsigned char cLow;
-  int valHigh;
-  int valLow;
+  struct urldecode_ctx_s ctx;
+  size_t len;
 
-  pDest = dest;
-  pSrc = (unsigned char *)src;
-  pEnd = (unsigned char *)src + src_len;
-  while (pSrc < pEnd)
+  urldecode_init(&ctx);
+  len  = urldecode_update(&ctx, src, src_len, dest);
+  len += urldecode_final(&ctx, dest + len);
+
+  dest[len] = '\0';
+  *dest_len = len;
+  return dest;
+}
+#endif
+
+/****************************************************************************
+ * Name: urldecode_init
+ ****************************************************************************/
+
+#ifdef CONFIG_CODECS_URLCODE
+void urldecode_init(FAR struct urldecode_ctx_s *ctx)
+{
+  ctx->npending = 0;
+}
+#endif
+
+/****************************************************************************
+ * Name: urldecode_update
+ ****************************************************************************/
+
+#ifdef CONFIG_CODECS_URLCODE
+size_t urldecode_update(FAR struct urldecode_ctx_s *ctx, FAR const char *src,
+                        size_t len, FAR char *dest)
+{
+  FAR const char *end = src + len;
+  FAR const char *run;
+  FAR char *pos = dest;
+  uint32_t word;
+  char ch;
+
+  while (src < end)
     {
-      if (*pSrc == '%' && pSrc + 2 < pEnd)
+      if (ctx->npending == 0)
         {
-          cHigh = *(pSrc + 1);
-          cLow = *(pSrc + 2);
+          /* Copy everything up to the next '%' or '+' in one go, scanning
+           * a word at a time.
+           */
 
-          if (IS_HEX_CHAR(cHigh) && IS_HEX_CHAR(cLow))
+          run = src;
+          while (end - run >= 4)
             {
-              HEX_VALUE(cHigh, valHigh)
-              HEX_VALUE(cLow, valLow)
-              *pDest++ = (valHigh << 4) | valLow;
-              pSrc += 3;
+              memcpy(&word, run, 4);
+              if (HAS_ESCAPE(word))
+                {
+                  break;
+                }
+
+              run += 4;
             }
-          else
+
+          while (run < end && *run != '%' && *run != '+')
+            {
+              run++;
+            }
+
+          if (run > src)
             {
-              *pDest++ = *pSrc;
-              pSrc++;
+              memmove(pos, src, run - src);
+              pos += run - src;
+              src  = run;
+              if (src >= end)
+                {
+                  break;
+                }
             }
         }
-      else if (*pSrc == '+')
+
+      ch = *src;
+      switch (ctx->npending)
         {
-          *pDest++ = ' ';
-          pSrc++;
+          case 0:
+            if (ch == '+')
+              {
+                *pos++ = ' ';
+              }
+            else
+              {
+                ctx->npending = 1;
+              }
+
+            src++;
+            break;
+
+          case 1:
+            if (IS_HEX_CHAR(ch))
+              {
+                ctx->hexhigh  = ch;
+                ctx->npending = 2;
+                src++;
+              }
+            else
+              {
+                /* Not an escape: the '%' is literal, look at ch again */
+
+                *pos++        = '%';
+                ctx->npending = 0;
+              }
+            break;
+
+          default:
+            if (IS_HEX_CHAR(ch))
+              {
+                *pos++ = (char)((HEX_VALUE(ctx->hexhigh) << 4) |
+                                HEX_VALUE(ch));
+                src++;
+              }
+            else
+              {
+                *pos++ = '%';
+                *pos++ = ctx->hexhigh;
+              }
+
+            ctx->npending = 0;
+            break;
         }
-      else
+    }
+
+  return pos - dest;
+}
+#endif
+
+/****************************************************************************
+ * Name: urldecode_final
+ ****************************************************************************/
+
+#ifdef CONFIG_CODECS_URLCODE
+size_t urldecode_final(FAR struct urldecode_ctx_s *ctx, FAR char *dest)
+{
+  size_t len = ctx->npending;
+
+  /* A '%' without two hex digits after it stands for itself */
+
+  if (len > 0)
+    {
+      dest[0] = '%';
+      if (len > 1)
         {
-          *pDest++ = *pSrc;
-          pSrc++;
+          dest[1] = ctx->hexhigh;
         }
     }
 
-  *pDest = '\0';
-  *dest_len = pDest - dest;
-  return dest;
+  ctx->npending = 0;
+  return len;
 }
 #endif
 
@@ -364,10 +479,7 @@ int urlencode_len(const char *src, const int src_len)
   pEnd = (unsigned char *)src + src_len;
   for (pSrc = (unsigned char *)src; pSrc < pEnd; pSrc++)
     {
-      if ((*pSrc >= '0' && *pSrc <= '9') ||
-          (*pSrc >= 'a' && *pSrc <= 'z') ||
-          (*pSrc >= 'A' && *pSrc <= 'Z') ||
-          (*pSrc == '_' || *pSrc == '-' || *pSrc == '.' || *pSrc == '~' || *pSrc == ' '))
+      if (IS_UNRESERVED(*pSrc) || *pSrc == ' ')
         {
           len++;
         }
@@ -391,22 +503,15 @@ int urldecode_len(const char *src, const int src_len)
   const unsigned char *pSrc;
   const unsigned char *pEnd;
   int len = 0;
-  unsigned char cHigh;
-  unsigned char cLow;
 
   pSrc = (unsigned char *)src;
   pEnd = (unsigned char *)src + src_len;
   while (pSrc < pEnd)
     {
-      if (*pSrc == '%' && pSrc + 2 < pEnd)
+      if (*pSrc == '%' && pSrc + 2 < pEnd &&
+          IS_HEX_CHAR(pSrc[1]) && IS_HEX_CHAR(pSrc[2]))
         {
-          cHigh = *(pSrc + 1);
-          cLow = *(pSrc + 2);
-
-          if (IS_HEX_CHAR(cHigh) && IS_HEX_CHAR(cLow))
-            {
-              pSrc += 2;
-            }
+          pSrc += 2;
         }
 
       len++;
@@ -470,7 +575,7 @@ void urlrawencode(char *str, char *urlbuf)
   char c;
   while ((c = *str))
     {
-      if (c == ' ' || isalnum(c) || c == '_' || c == '-' || c == '.' || c == '~')
+      if (c == ' ' || IS_UNRESERVED(c))
         {
           if (c == ' ')
             {
@@ -51,6 +51,14 @@
 
 #  define ERROR (-1)
 #  define OK    (0)
+
+   /* Delay before each response (microseconds).  Set this to zero when
+    * the host build is used with the load test client over the loopback.
+    */
+
+#  ifndef CONFIG_NETUTILS_DHCPD_HOSTDELAY
+#    define CONFIG_NETUTILS_DHCPD_HOSTDELAY (500*1000)
+#  endif
 #else
 #  include <nuttx/config.h>          /* NuttX configuration */
 #  include <debug.h>                 /* For ndbg, vdbg */
@@ -66,8 +74,10 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include <string.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <time.h>
 #include <errno.h>
 
@@ -75,6 +85,8 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 
+#include <apps/netutils/netlib.h>
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -184,6 +196,14 @@
 #  define CONFIG_NETUTILS_DHCPD_DECLINETIME (60*60) /* 1 hour */
 #endif
 
+#ifndef CONFIG_NETUTILS_DHCPD_BATCH
+#  define CONFIG_NETUTILS_DHCPD_BATCH 4
+#endif
+
+#ifndef CONFIG_NETUTILS_DHCPD_DEDUPTIME
+#  define CONFIG_NETUTILS_DHCPD_DEDUPTIME 1000 /* msec */
+#endif
+
 #undef HAVE_ROUTERIP
 #if defined(CONFIG_NETUTILS_DHCPD_ROUTERIP) && CONFIG_NETUTILS_DHCPD_ROUTERIP
 #  define HAVE_ROUTERIP 1
@@ -204,6 +224,39 @@
 #  define HAVE_LEASE_TIME 1
 #endif
 
+/* Lease table indices are 16-bits wide.  DHCPD_NIL is the null index. */
+
+#if CONFIG_NETUTILS_DHCPD_MAXLEASES > 65535
+#  error "CONFIG_NETUTILS_DHCPD_MAXLEASES is too large"
+#endif
+
+#define DHCPD_NIL                 0xffff
+
+/* The MAC hash table and the free address bitmap */
+
+#ifndef CONFIG_NETUTILS_DHCPD_HASHBITS
+#  define CONFIG_NETUTILS_DHCPD_HASHBITS 5
+#endif
+
+#define DHCPD_HASH_SIZE           (1 << CONFIG_NETUTILS_DHCPD_HASHBITS)
+#define DHCPD_HASH_MASK           (DHCPD_HASH_SIZE - 1)
+#define DHCPD_MAP_WORDS           ((CONFIG_NETUTILS_DHCPD_MAXLEASES + 31) >> 5)
+
+/* The lease journal */
+
+#ifdef CONFIG_NETUTILS_DHCPD_JOURNAL
+#  ifndef CONFIG_NETUTILS_DHCPD_JOURNAL_PATH
+#    define CONFIG_NETUTILS_DHCPD_JOURNAL_PATH "/mnt/dhcpd.leases"
+#  endif
+
+#  ifndef CONFIG_NETUTILS_DHCPD_JOURNAL_COMPACT
+#    define CONFIG_NETUTILS_DHCPD_JOURNAL_COMPACT 256
+#  endif
+
+#  define DHCPD_JOURNAL_SET       0x5a  /* Lease allocated or modified */
+#  define DHCPD_JOURNAL_FREE      0xa5  /* Lease released */
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -222,6 +275,20 @@ struct lease_s
 #endif
 };
 
+/* This is the format of one record in the lease journal */
+
+#ifdef CONFIG_NETUTILS_DHCPD_JOURNAL
+struct dhcpd_journal_s
+{
+  uint8_t  jr_type;                 /* DHCPD_JOURNAL_SET or DHCPD_JOURNAL_FREE */
+  uint8_t  jr_check;                /* Makes the byte sum of the record zero */
+  uint16_t jr_ndx;                  /* Index into the lease table */
+  uint8_t  jr_mac[DHCP_HLEN_ETHERNET]; /* MAC address (network order) */
+  uint8_t  jr_pad[2];
+  uint32_t jr_expiry;               /* Lease expiration time (seconds past Epoch) */
+};
+#endif
+
 struct dhcpmsg_s
 {
   uint8_t  op;
@@ -253,6 +320,8 @@ struct dhcpd_state_s
 
   struct dhcpmsg_s ds_inpacket;     /* Holds the incoming DHCP client message */
   struct dhcpmsg_s ds_outpacket;    /* Holds the outgoing DHCP server message */
+  FAR struct netlib_udpsvc_s *ds_udpsvc; /* Batches of requests and replies */
+  int              ds_nreplies;     /* Number of replies queued */
 
   /* Parsed options from the incoming DHCP client message */
 
@@ -268,6 +337,25 @@ struct dhcpd_state_s
   /* Leases */
 
   struct lease_s   ds_leases[CONFIG_NETUTILS_DHCPD_MAXLEASES];
+
+  /* Lease table indices */
+
+  uint16_t         ds_hashhead[DHCPD_HASH_SIZE]; /* MAC hash buckets */
+  uint16_t         ds_hashnext[CONFIG_NETUTILS_DHCPD_MAXLEASES]; /* MAC hash chains */
+  uint32_t         ds_freemap[DHCPD_MAP_WORDS];  /* Set bits are free addresses */
+  uint16_t         ds_freehint;     /* No free address below this word */
+#ifdef HAVE_LEASE_TIME
+  uint16_t         ds_nheap;        /* Number of leases in the expiry heap */
+  uint16_t         ds_heap[CONFIG_NETUTILS_DHCPD_MAXLEASES];    /* Expiry min-heap */
+  uint16_t         ds_heappos[CONFIG_NETUTILS_DHCPD_MAXLEASES]; /* Heap position of each lease */
+#endif
+
+#ifdef CONFIG_NETUTILS_DHCPD_JOURNAL
+  /* Lease journal */
+
+  int              ds_journalfd;    /* Journal open for appending */
+  int              ds_journalrecs;  /* Number of records in the journal */
+#endif
 };
 
 /****************************************************************************
@@ -276,6 +364,7 @@ struct dhcpd_state_s
 
 static const uint8_t        g_magiccookie[4] = {99, 130, 83, 99};
 static const uint8_t        g_anyipaddr[4] = {0, 0, 0, 0};
+static const uint8_t        g_anymac[DHCP_HLEN_ETHERNET];
 static struct dhcpd_state_s g_state;
 
 /****************************************************************************
@@ -336,6 +425,296 @@ static time_t dhcpd_time(void)
 # define dhcpd_time() (0)
 #endif
 
+/****************************************************************************
+ * Name: dhcpd_machash
+ *
+ * Description:
+ *   Return the MAC hash table bucket for a hardware address
+ *
+ ****************************************************************************/
+
+static inline unsigned int dhcpd_machash(FAR const uint8_t *mac)
+{
+  uint32_t hash = 2166136261u;
+  int i;
+
+  /* FNV-1a, folded down to the size of the hash table */
+
+  for (i = 0; i < DHCP_HLEN_ETHERNET; i++)
+    {
+      hash ^= mac[i];
+      hash *= 16777619u;
+    }
+
+  hash ^= hash >> 16;
+  return hash & DHCPD_HASH_MASK;
+}
+
+/****************************************************************************
+ * Name: dhcpd_hashed
+ *
+ * Description:
+ *   A lease is in the MAC hash table only if it is allocated and bound to
+ *   a hardware address.  Declined addresses are allocated but have no MAC.
+ *
+ ****************************************************************************/
+
+static inline bool dhcpd_hashed(FAR const struct lease_s *lease)
+{
+  return lease->allocated &&
+         memcmp(lease->mac, g_anymac, DHCP_HLEN_ETHERNET) != 0;
+}
+
+/****************************************************************************
+ * Name: dhcpd_hashinsert and dhcpd_hashremove
+ *
+ * Description:
+ *   Add or remove one lease from the MAC hash chains
+ *
+ ****************************************************************************/
+
+static void dhcpd_hashinsert(int ndx)
+{
+  unsigned int bucket = dhcpd_machash(g_state.ds_leases[ndx].mac);
+
+  g_state.ds_hashnext[ndx]    = g_state.ds_hashhead[bucket];
+  g_state.ds_hashhead[bucket] = ndx;
+}
+
+static void dhcpd_hashremove(int ndx)
+{
+  FAR uint16_t *link;
+
+  link = &g_state.ds_hashhead[dhcpd_machash(g_state.ds_leases[ndx].mac)];
+  while (*link != DHCPD_NIL)
+    {
+      if (*link == ndx)
+        {
+          *link = g_state.ds_hashnext[ndx];
+          break;
+        }
+
+      link = &g_state.ds_hashnext[*link];
+    }
+
+  g_state.ds_hashnext[ndx] = DHCPD_NIL;
+}
+
+/****************************************************************************
+ * Name: dhcpd_setfree and dhcpd_clrfree
+ *
+ * Description:
+ *   Maintain the bitmap of free addresses.  ds_freehint is kept at or
+ *   below the first word that holds a free address so that the search in
+ *   dhcpd_allocipaddr() still returns the lowest free address.
+ *
+ ****************************************************************************/
+
+static void dhcpd_setfree(int ndx)
+{
+  in_addr_t ipaddr = CONFIG_NETUTILS_DHCPD_STARTIP + ndx;
+  int word = ndx >> 5;
+
+  /* Addresses ending in 0 or 255 are never handed out */
+
+  if ((ipaddr & 0xff) != 0 && (ipaddr & 0xff) != 0xff)
+    {
+      g_state.ds_freemap[word] |= (uint32_t)1 << (ndx & 31);
+      if (word < g_state.ds_freehint)
+        {
+          g_state.ds_freehint = word;
+        }
+    }
+}
+
+static inline void dhcpd_clrfree(int ndx)
+{
+  g_state.ds_freemap[ndx >> 5] &= ~((uint32_t)1 << (ndx & 31));
+}
+
+/****************************************************************************
+ * Name: dhcpd_heap*
+ *
+ * Description:
+ *   Every allocated lease is held in a binary min-heap ordered by its
+ *   expiration time so that expired leases can be reaped without scanning
+ *   the whole lease table.  ds_heappos[] holds the position of each lease
+ *   in the heap (DHCPD_NIL if the lease is not allocated).
+ *
+ ****************************************************************************/
+
+#ifdef HAVE_LEASE_TIME
+static inline time_t dhcpd_heapkey(int pos)
+{
+  return g_state.ds_leases[g_state.ds_heap[pos]].expiry;
+}
+
+static inline void dhcpd_heapset(int pos, uint16_t ndx)
+{
+  g_state.ds_heap[pos]    = ndx;
+  g_state.ds_heappos[ndx] = pos;
+}
+
+static void dhcpd_heapup(int pos)
+{
+  uint16_t ndx = g_state.ds_heap[pos];
+  time_t key = g_state.ds_leases[ndx].expiry;
+  int parent;
+
+  while (pos > 0)
+    {
+      parent = (pos - 1) >> 1;
+      if (dhcpd_heapkey(parent) <= key)
+        {
+          break;
+        }
+
+      dhcpd_heapset(pos, g_state.ds_heap[parent]);
+      pos = parent;
+    }
+
+  dhcpd_heapset(pos, ndx);
+}
+
+static void dhcpd_heapdown(int pos)
+{
+  uint16_t ndx = g_state.ds_heap[pos];
+  time_t key = g_state.ds_leases[ndx].expiry;
+  int child;
+
+  for (; ; )
+    {
+      child = (pos << 1) + 1;
+      if (child >= g_state.ds_nheap)
+        {
+          break;
+        }
+
+      if (child + 1 < g_state.ds_nheap &&
+          dhcpd_heapkey(child + 1) < dhcpd_heapkey(child))
+        {
+          child++;
+        }
+
+      if (key <= dhcpd_heapkey(child))
+        {
+          break;
+        }
+
+      dhcpd_heapset(pos, g_state.ds_heap[child]);
+      pos = child;
+    }
+
+  dhcpd_heapset(pos, ndx);
+}
+
+static void dhcpd_heapupdate(int ndx)
+{
+  int pos = g_state.ds_heappos[ndx];
+
+  if (pos == DHCPD_NIL)
+    {
+      /* Not yet in the heap.  Add it at the bottom */
+
+      pos = g_state.ds_nheap++;
+      dhcpd_heapset(pos, ndx);
+      dhcpd_heapup(pos);
+    }
+  else
+    {
+      /* The expiration time changed.  Move it up or down as needed */
+
+      dhcpd_heapup(pos);
+      dhcpd_heapdown(g_state.ds_heappos[ndx]);
+    }
+}
+
+static void dhcpd_heapremove(int ndx)
+{
+  int pos = g_state.ds_heappos[ndx];
+  uint16_t moved;
+  int last;
+
+  if (pos != DHCPD_NIL)
+    {
+      g_state.ds_heappos[ndx] = DHCPD_NIL;
+      last = --g_state.ds_nheap;
+      if (pos != last)
+        {
+          /* Move the last entry into the hole */
+
+          moved = g_state.ds_heap[last];
+          dhcpd_heapset(pos, moved);
+          dhcpd_heapup(pos);
+          dhcpd_heapdown(g_state.ds_heappos[moved]);
+        }
+    }
+}
+#else
+#  define dhcpd_heapupdate(ndx)
+#  define dhcpd_heapremove(ndx)
+#endif
+
+/****************************************************************************
+ * Name: dhcpd_leaseupdate
+ *
+ * Description:
+ *   Allocate the lease at 'ndx' (or modify an allocated lease) and bring
+ *   the MAC hash, the free address bitmap, and the expiry heap up to date.
+ *   'mac' may be all zero for an address that is reserved but not bound
+ *   to any client.  'expiry' is absolute.
+ *
+ ****************************************************************************/
+
+static void dhcpd_leaseupdate(int ndx, FAR const uint8_t *mac, time_t expiry)
+{
+  FAR struct lease_s *lease = &g_state.ds_leases[ndx];
+
+  if (dhcpd_hashed(lease))
+    {
+      dhcpd_hashremove(ndx);
+    }
+
+  memcpy(lease->mac, mac, DHCP_HLEN_ETHERNET);
+  lease->allocated = true;
+#ifdef HAVE_LEASE_TIME
+  lease->expiry = expiry;
+#endif
+
+  if (dhcpd_hashed(lease))
+    {
+      dhcpd_hashinsert(ndx);
+    }
+
+  dhcpd_clrfree(ndx);
+  dhcpd_heapupdate(ndx);
+}
+
+/****************************************************************************
+ * Name: dhcpd_leasefree
+ *
+ * Description:
+ *   Return the lease at 'ndx' to the pool of free addresses
+ *
+ ****************************************************************************/
+
+static void dhcpd_leasefree(int ndx)
+{
+  FAR struct lease_s *lease = &g_state.ds_leases[ndx];
+
+  if (lease->allocated)
+    {
+      if (dhcpd_hashed(lease))
+        {
+          dhcpd_hashremove(ndx);
+        }
+
+      dhcpd_heapremove(ndx);
+      memset(lease, 0, sizeof(struct lease_s));
+      dhcpd_setfree(ndx);
+    }
+}
+
 /****************************************************************************
  * Name: dhcpd_leaseexpired
  ****************************************************************************/
@@ -345,18 +724,300 @@ static inline bool dhcpd_leaseexpired(struct lease_s *lease)
 {
   if (lease->expiry < dhcpd_time())
     {
-      return false;
+      dhcpd_leasefree(lease - g_state.ds_leases);
+      return true;
     }
   else
     {
-      memset(lease, 0, sizeof(struct lease_s));
-      return true;
+      return false;
     }
 }
 #else
 # define dhcpd_leaseexpired(lease) (false)
 #endif
 
+/****************************************************************************
+ * Name: dhcpd_reapleases
+ *
+ * Description:
+ *   Free all leases that have expired.  These are always at the top of the
+ *   expiry heap.
+ *
+ ****************************************************************************/
+
+#ifdef HAVE_LEASE_TIME
+static void dhcpd_reapleases(void)
+{
+  time_t now = dhcpd_time();
+
+  while (g_state.ds_nheap > 0 && dhcpd_heapkey(0) < now)
+    {
+      dhcpd_leasefree(g_state.ds_heap[0]);
+    }
+}
+#else
+#  define dhcpd_reapleases()
+#endif
+
+/****************************************************************************
+ * Name: dhcpd_initleases
+ ****************************************************************************/
+
+static void dhcpd_initleases(void)
+{
+  int ndx;
+
+  /* All lease table indices are 16-bits, so DHCPD_NIL (0xffff) can be set
+   * with memset().
+   */
+
+  memset(g_state.ds_hashhead, 0xff, sizeof(g_state.ds_hashhead));
+  memset(g_state.ds_hashnext, 0xff, sizeof(g_state.ds_hashnext));
+#ifdef HAVE_LEASE_TIME
+  memset(g_state.ds_heappos, 0xff, sizeof(g_state.ds_heappos));
+#endif
+
+  g_state.ds_freehint = DHCPD_MAP_WORDS;
+  for (ndx = 0; ndx < CONFIG_NETUTILS_DHCPD_MAXLEASES; ndx++)
+    {
+      dhcpd_setfree(ndx);
+    }
+}
+
+/****************************************************************************
+ * Name: dhcpd_journal*
+ *
+ * Description:
+ *   The lease journal is an append-only file of fixed size records.  Each
+ *   record is a snapshot of one slot in the lease table so that replaying
+ *   the journal in order restores the lease table.  The journal is
+ *   compacted on start-up and whenever CONFIG_NETUTILS_DHCPD_JOURNAL_COMPACT
+ *   records have been appended by rewriting it with only the allocated
+ *   leases.  A record with a bad checksum (such as a partial write when
+ *   power was lost) ends the replay.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NETUTILS_DHCPD_JOURNAL
+static uint8_t dhcpd_journalsum(FAR const struct dhcpd_journal_s *rec)
+{
+  FAR const uint8_t *ptr = (FAR const uint8_t *)rec;
+  uint8_t sum = 0;
+  int i;
+
+  for (i = 0; i < sizeof(struct dhcpd_journal_s); i++)
+    {
+      sum += ptr[i];
+    }
+
+  return sum;
+}
+
+static void dhcpd_journalinit(FAR struct dhcpd_journal_s *rec, int ndx)
+{
+  FAR struct lease_s *lease = &g_state.ds_leases[ndx];
+
+  memset(rec, 0, sizeof(struct dhcpd_journal_s));
+  rec->jr_ndx = ndx;
+
+  if (lease->allocated)
+    {
+      rec->jr_type = DHCPD_JOURNAL_SET;
+      memcpy(rec->jr_mac, lease->mac, DHCP_HLEN_ETHERNET);
+#ifdef HAVE_LEASE_TIME
+      rec->jr_expiry = (uint32_t)lease->expiry;
+#endif
+    }
+  else
+    {
+      rec->jr_type = DHCPD_JOURNAL_FREE;
+    }
+
+  /* Chose the check byte so that the sum over the record is zero */
+
+  rec->jr_check = -dhcpd_journalsum(rec);
+}
+
+static void dhcpd_journalreplay(void)
+{
+  struct dhcpd_journal_s rec;
+  int nrecs = 0;
+  int fd;
+
+  fd = open(CONFIG_NETUTILS_DHCPD_JOURNAL_PATH, O_RDONLY);
+  if (fd < 0)
+    {
+      nvdbg("No lease journal: %d\n", errno);
+      return;
+    }
+
+  while (read(fd, &rec, sizeof(struct dhcpd_journal_s)) ==
+         sizeof(struct dhcpd_journal_s))
+    {
+      if (dhcpd_journalsum(&rec) != 0 ||
+          (rec.jr_type != DHCPD_JOURNAL_SET &&
+           rec.jr_type != DHCPD_JOURNAL_FREE))
+        {
+          ndbg("Bad journal record %d\n", nrecs);
+          break;
+        }
+
+      if (rec.jr_ndx < CONFIG_NETUTILS_DHCPD_MAXLEASES)
+        {
+          if (rec.jr_type == DHCPD_JOURNAL_SET)
+            {
+              dhcpd_leaseupdate(rec.jr_ndx, rec.jr_mac, (time_t)rec.jr_expiry);
+            }
+          else
+            {
+              dhcpd_leasefree(rec.jr_ndx);
+            }
+        }
+
+      nrecs++;
+    }
+
+  nvdbg("Replayed %d journal records\n", nrecs);
+  close(fd);
+}
+
+static int dhcpd_journalcompact(void)
+{
+  struct dhcpd_journal_s rec;
+  int nrecs = 0;
+  int errcode;
+  int ndx;
+  int fd;
+
+  /* Write the allocated leases to a new file.  The old journal stays open
+   * and in place until the new one has been written.
+   */
+
+  fd = open(CONFIG_NETUTILS_DHCPD_JOURNAL_PATH ".tmp",
+            O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    {
+      errcode = errno;
+      ndbg("Failed to create lease journal: %d\n", errcode);
+      return -errcode;
+    }
+
+  for (ndx = 0; ndx < CONFIG_NETUTILS_DHCPD_MAXLEASES; ndx++)
+    {
+      if (g_state.ds_leases[ndx].allocated)
+        {
+          dhcpd_journalinit(&rec, ndx);
+          if (write(fd, &rec, sizeof(struct dhcpd_journal_s)) !=
+              sizeof(struct dhcpd_journal_s))
+            {
+              errcode = errno;
+              ndbg("Failed to write lease journal: %d\n", errcode);
+              close(fd);
+              unlink(CONFIG_NETUTILS_DHCPD_JOURNAL_PATH ".tmp");
+              return -errcode;
+            }
+
+          nrecs++;
+        }
+    }
+
+  fsync(fd);
+  close(fd);
+
+  /* Then replace the old journal.  Not all file systems will rename an
+   * open file or rename over an existing file, so the old journal is
+   * closed and, if necessary, moved aside first.  It is only removed once
+   * the new journal is in place.
+   */
+
+  errcode = OK;
+  if (g_state.ds_journalfd >= 0)
+    {
+      close(g_state.ds_journalfd);
+      g_state.ds_journalfd = -1;
+    }
+
+  if (rename(CONFIG_NETUTILS_DHCPD_JOURNAL_PATH ".tmp",
+             CONFIG_NETUTILS_DHCPD_JOURNAL_PATH) < 0)
+    {
+      if (rename(CONFIG_NETUTILS_DHCPD_JOURNAL_PATH,
+                 CONFIG_NETUTILS_DHCPD_JOURNAL_PATH ".old") < 0 &&
+          errno != ENOENT)
+        {
+          errcode = errno;
+        }
+      else if (rename(CONFIG_NETUTILS_DHCPD_JOURNAL_PATH ".tmp",
+                      CONFIG_NETUTILS_DHCPD_JOURNAL_PATH) < 0)
+        {
+          errcode = errno;
+          rename(CONFIG_NETUTILS_DHCPD_JOURNAL_PATH ".old",
+                 CONFIG_NETUTILS_DHCPD_JOURNAL_PATH);
+        }
+      else
+        {
+          unlink(CONFIG_NETUTILS_DHCPD_JOURNAL_PATH ".old");
+        }
+    }
+
+  if (errcode != OK)
+    {
+      /* Keep appending to the old journal.  It still restores the same
+       * lease table.
+       */
+
+      ndbg("Failed to rename lease journal: %d\n", errcode);
+      unlink(CONFIG_NETUTILS_DHCPD_JOURNAL_PATH ".tmp");
+    }
+
+  g_state.ds_journalfd = open(CONFIG_NETUTILS_DHCPD_JOURNAL_PATH,
+                              O_WRONLY | O_CREAT | O_APPEND, 0644);
+  if (g_state.ds_journalfd < 0)
+    {
+      errcode = errno;
+      ndbg("Failed to open lease journal: %d\n", errcode);
+      return -errcode;
+    }
+
+  if (errcode == OK)
+    {
+      g_state.ds_journalrecs = nrecs;
+    }
+
+  return -errcode;
+}
+
+static void dhcpd_journal(FAR struct lease_s *lease)
+{
+  struct dhcpd_journal_s rec;
+
+  if (g_state.ds_journalfd < 0)
+    {
+      return;
+    }
+
+  dhcpd_journalinit(&rec, lease - g_state.ds_leases);
+  if (write(g_state.ds_journalfd, &rec, sizeof(struct dhcpd_journal_s)) !=
+      sizeof(struct dhcpd_journal_s))
+    {
+      ndbg("Failed to write lease journal: %d\n", errno);
+      return;
+    }
+
+  fsync(g_state.ds_journalfd);
+  if (++g_state.ds_journalrecs >= CONFIG_NETUTILS_DHCPD_JOURNAL_COMPACT &&
+      dhcpd_journalcompact() < 0)
+    {
+      /* The old journal is still in use.  Try again after another
+       * CONFIG_NETUTILS_DHCPD_JOURNAL_COMPACT records.
+       */
+
+      g_state.ds_journalrecs = 0;
+    }
+}
+#else
+#  define dhcpd_journal(lease)
+#endif
+
 /****************************************************************************
  * Name: dhcpd_setlease
  ****************************************************************************/
@@ -379,11 +1040,7 @@ struct lease_s *dhcpd_setlease(const uint8_t *mac, in_addr_t ipaddr, time_t expi
   if (ndx >= 0 && ndx < CONFIG_NETUTILS_DHCPD_MAXLEASES)
     {
        ret = &g_state.ds_leases[ndx];
-       memcpy(ret->mac, mac, DHCP_HLEN_ETHERNET);
-       ret->allocated = true;
-#ifdef HAVE_LEASE_TIME
-       ret->expiry = dhcpd_time() + expiry;
-#endif
+       dhcpd_leaseupdate(ndx, mac, dhcpd_time() + expiry);
     }
 
   return ret;
@@ -406,13 +1063,14 @@ static inline in_addr_t dhcp_leaseipaddr(struct lease_s *lease)
 
 static struct lease_s *dhcpd_findbymac(const uint8_t *mac)
 {
-  int i;
+  uint16_t ndx;
 
-  for (i = 0; i < CONFIG_NETUTILS_DHCPD_MAXLEASES; i++)
+  ndx = g_state.ds_hashhead[dhcpd_machash(mac)];
+  for (; ndx != DHCPD_NIL; ndx = g_state.ds_hashnext[ndx])
     {
-      if (memcmp(g_state.ds_leases[i].mac, mac, DHCP_HLEN_ETHERNET) == 0)
+      if (memcmp(g_state.ds_leases[ndx].mac, mac, DHCP_HLEN_ETHERNET) == 0)
         {
-          return &(g_state.ds_leases[i]);
+          return &(g_state.ds_leases[ndx]);
         }
     }
 
@@ -444,39 +1102,45 @@ static struct lease_s *dhcpd_findbyipaddr(in_addr_t ipaddr)
 
 static in_addr_t dhcpd_allocipaddr(void)
 {
-  struct lease_s *lease = NULL;
-  in_addr_t ipaddr;
+  uint32_t freebits;
+  int word;
+  int bit;
 
-  ipaddr = CONFIG_NETUTILS_DHCPD_STARTIP;
-  for (; ipaddr <= CONFIG_NETUTILS_DHCP_OPTION_ENDIP; ipaddr++)
-    {
-      /* Skip over address ending in 0 or 255 */
+  /* Return any expired leases to the free address bitmap */
 
-      if ((ipaddr & 0xff) == 0 || (ipaddr & 0xff) == 0xff)
-        {
-          continue;
-        }
+  dhcpd_reapleases();
 
-      /* Is there already a lease on this address?  If so, has it expired? */
+  /* Then find the lowest free address.  Addresses ending in 0 or 255 are
+   * never marked free.
+   */
 
-      lease = dhcpd_findbyipaddr(ipaddr);
-      if ((!lease || dhcpd_leaseexpired(lease)))
+  for (word = g_state.ds_freehint; word < DHCPD_MAP_WORDS; word++)
+    {
+      freebits = g_state.ds_freemap[word];
+      if (freebits != 0)
         {
+          for (bit = 0; (freebits & 1) == 0; bit++)
+            {
+              freebits >>= 1;
+            }
+
+          g_state.ds_freehint = word;
+
 #ifdef CONFIG_CPP_HAVE_WARNING
 #  warning "FIXME: Should check if anything responds to an ARP request or ping"
 #  warning "       to verify that there is no other user of this IP address"
 #endif
-          memset(g_state.ds_leases[ipaddr - CONFIG_NETUTILS_DHCPD_STARTIP].mac, 0, DHCP_HLEN_ETHERNET);
-          g_state.ds_leases[ipaddr - CONFIG_NETUTILS_DHCPD_STARTIP].allocated = true;
-#ifdef HAVE_LEASE_TIME
-          g_state.ds_leases[ipaddr - CONFIG_NETUTILS_DHCPD_STARTIP].expiry = dhcpd_time() + CONFIG_NETUTILS_DHCPD_OFFERTIME;
-#endif
-          /* Return the address in host order */
+          /* Reserve the address for the offer and return the address in
+           * host order
+           */
 
-          return ipaddr;
+          dhcpd_leaseupdate((word << 5) + bit, g_anymac,
+                            dhcpd_time() + CONFIG_NETUTILS_DHCPD_OFFERTIME);
+          return CONFIG_NETUTILS_DHCPD_STARTIP + (word << 5) + bit;
         }
     }
 
+  g_state.ds_freehint = DHCPD_MAP_WORDS;
   return 0;
 }
 
@@ -922,7 +1586,6 @@ static int dhcpd_sendpacket(int bbroadcast)
 {
   struct sockaddr_in addr;
   in_addr_t ipaddr;
-  int sockfd;
   int len;
   int ret = ERROR;
 
@@ -970,32 +1633,61 @@ static int dhcpd_sendpacket(int bbroadcast)
     }
 #endif
 
-  /* Create a socket to respond with a packet to the client.  We
-   * cannot re-use the listener socket because it is not bound correctly
+  /* Queue the reponse to the DHCP client port at that address.  The
+   * responses to a batch of requests are sent together by dhcpd_flush().
    */
 
-  sockfd = dhcpd_openresponder();
-  if (sockfd >= 0)
+  memset(&addr, 0, sizeof(struct sockaddr_in));
+  addr.sin_family      = AF_INET;
+  addr.sin_port        = HTONS(DHCP_CLIENT_PORT);
+  addr.sin_addr.s_addr = ipaddr;
+
+  /* Send the minimum sized packet that includes the END option */
+
+  len = (g_state.ds_optend - (uint8_t*)&g_state.ds_outpacket) + 1;
+  nvdbg("sendto %08lx:%04x len=%d\n",
+        (long)ntohl(addr.sin_addr.s_addr), ntohs(addr.sin_port), len);
+
+  ret = netlib_udpsvc_reply(g_state.ds_udpsvc, &addr,
+                            &g_state.ds_outpacket, len);
+  if (ret >= 0)
     {
-      /* Then send the reponse to the DHCP client port at that address */
+      g_state.ds_nreplies++;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: dhcpd_flush
+ ****************************************************************************/
+
+static void dhcpd_flush(void)
+{
+  int sockfd;
 
-      memset(&addr, 0, sizeof(struct sockaddr_in));
-      addr.sin_family      = AF_INET;
-      addr.sin_port        = HTONS(DHCP_CLIENT_PORT);
-      addr.sin_addr.s_addr = ipaddr;
+  if (g_state.ds_nreplies == 0)
+    {
+      return;
+    }
 
-      /* Send the minimum sized packet that includes the END option */
+  /* Create a socket to respond with the queued packets.  We cannot re-use
+   * the listener socket because it is not bound correctly.  If the socket
+   * cannot be created, the responses are discarded.
+   */
 
-      len = (g_state.ds_optend - (uint8_t*)&g_state.ds_outpacket) + 1;
-      nvdbg("sendto %08lx:%04x len=%d\n",
-            (long)ntohl(addr.sin_addr.s_addr), ntohs(addr.sin_port), len);
+  sockfd = dhcpd_openresponder();
+  if (netlib_udpsvc_flush(g_state.ds_udpsvc, sockfd) < 0)
+    {
+      ndbg("sendto failed: %d\n", errno);
+    }
 
-      ret = sendto(sockfd, &g_state.ds_outpacket, len, 0,
-                   (struct sockaddr *)&addr, sizeof(struct sockaddr_in));
+  if (sockfd >= 0)
+    {
       close(sockfd);
     }
 
-  return ret;
+  g_state.ds_nreplies = 0;
 }
 
 /****************************************************************************
@@ -1063,6 +1755,7 @@ static int dhcpd_sendnak(void)
 
 int dhcpd_sendack(in_addr_t ipaddr)
 {
+  struct lease_s *lease;
   uint32_t leasetime = CONFIG_NETUTILS_DHCPD_LEASETIME;
   in_addr_t netaddr;
 #if HAVE_DNSIP
@@ -1106,7 +1799,12 @@ int dhcpd_sendack(in_addr_t ipaddr)
       return ERROR;
     }
 
-  dhcpd_setlease(g_state.ds_inpacket.chaddr, ipaddr, leasetime);
+  lease = dhcpd_setlease(g_state.ds_inpacket.chaddr, ipaddr, leasetime);
+  if (lease)
+    {
+      dhcpd_journal(lease);
+    }
+
   return OK;
 }
 
@@ -1345,10 +2043,9 @@ static inline int dhcpd_decline(void)
         * address for a period of time.
         */
 
-       memset(lease->mac, 0, DHCP_HLEN_ETHERNET);
-#ifdef HAVE_LEASE_TIME
-       lease->expiry = dhcpd_time() + CONFIG_NETUTILS_DHCPD_DECLINETIME;
-#endif
+       dhcpd_leaseupdate(lease - g_state.ds_leases, g_anymac,
+                         dhcpd_time() + CONFIG_NETUTILS_DHCPD_DECLINETIME);
+       dhcpd_journal(lease);
      }
 
   return OK;
@@ -1365,7 +2062,8 @@ static inline int dhcpd_release(void)
     {
       /* Release the IP address now */
 
-      memset(lease, 0, sizeof(struct lease_s));
+      dhcpd_leasefree(lease - g_state.ds_leases);
+      dhcpd_journal(lease);
     }
 
   return OK;
@@ -1435,6 +2133,8 @@ static inline int dhcpd_openlistener(void)
 
 int dhcpd_run(void)
 {
+  FAR void *request;
+  size_t reqlen;
   int sockfd;
   int nbytes;
 
@@ -1443,6 +2143,31 @@ int dhcpd_run(void)
   /* Initialize everything to zero */
 
   memset(&g_state, 0, sizeof(struct dhcpd_state_s));
+  dhcpd_initleases();
+
+#ifdef CONFIG_NETUTILS_DHCPD_JOURNAL
+  /* Restore the lease table from the journal, drop any leases that expired
+   * while we were down, then start a new, compacted journal.
+   */
+
+  g_state.ds_journalfd = -1;
+  dhcpd_journalreplay();
+  dhcpd_reapleases();
+  (void)dhcpd_journalcompact();
+#endif
+
+  /* Requests are received in batches and repeated requests are dropped so
+   * that a burst of requests does not overflow the socket.
+   */
+
+  g_state.ds_udpsvc = netlib_udpsvc_alloc(sizeof(struct dhcpmsg_s),
+                                          CONFIG_NETUTILS_DHCPD_BATCH,
+                                          CONFIG_NETUTILS_DHCPD_DEDUPTIME);
+  if (g_state.ds_udpsvc == NULL)
+    {
+      ndbg("Failed to allocate the message buffers\n");
+      return ERROR;
+    }
 
   /* Now loop indefinitely, reading packets from the DHCP server socket */
 
@@ -1461,9 +2186,9 @@ int dhcpd_run(void)
             }
         }
 
-      /* Read the next g_state.ds_outpacket */
+      /* Read the next batch of requests */
 
-      nbytes = recv(sockfd, &g_state.ds_inpacket, sizeof(struct dhcpmsg_s), 0);
+      nbytes = netlib_udpsvc_recv(g_state.ds_udpsvc, sockfd);
       if (nbytes < 0)
         {
           /* On errors (other EINTR), close the socket and try again */
@@ -1477,52 +2202,68 @@ int dhcpd_run(void)
           continue;
         }
 
-      /* Parse the incoming message options */
-
-      if (!dhcpd_parseoptions())
+      while ((request = netlib_udpsvc_next(g_state.ds_udpsvc, &reqlen,
+                                           NULL)) != NULL)
         {
-          /* Failed to parse the message options */
+          /* Copy the request so that no stale data follows it */
 
-          ndbg("No msg type\n");
-          continue;
-        }
+          memcpy(&g_state.ds_inpacket, request, reqlen);
+          memset((FAR uint8_t *)&g_state.ds_inpacket + reqlen, 0,
+                 sizeof(struct dhcpmsg_s) - reqlen);
 
-#ifdef CONFIG_NETUTILS_DHCPD_HOST
-      /* Get the poor little uC a change to get its recvfrom in place */
+          /* Parse the incoming message options */
 
-      usleep(500*1000);
+          if (!dhcpd_parseoptions())
+            {
+              /* Failed to parse the message options */
+
+              ndbg("No msg type\n");
+              continue;
+            }
+
+#if defined(CONFIG_NETUTILS_DHCPD_HOST) && CONFIG_NETUTILS_DHCPD_HOSTDELAY > 0
+          /* Get the poor little uC a change to get its recvfrom in place */
+
+          usleep(CONFIG_NETUTILS_DHCPD_HOSTDELAY);
 #endif
 
-      /* Now process the incoming DHCP message by its message type */
+          /* Now process the incoming DHCP message by its message type */
 
-      switch (g_state.ds_optmsgtype)
-        {
-          case DHCPDISCOVER:
-            nvdbg("DHCPDISCOVER\n");
-            dhcpd_discover();
-            break;
+          switch (g_state.ds_optmsgtype)
+            {
+              case DHCPDISCOVER:
+                nvdbg("DHCPDISCOVER\n");
+                dhcpd_discover();
+                break;
 
-          case DHCPREQUEST:
-            nvdbg("DHCPREQUEST\n");
-            dhcpd_request();
-            break;
+              case DHCPREQUEST:
+                nvdbg("DHCPREQUEST\n");
+                dhcpd_request();
+                break;
 
-          case DHCPDECLINE:
-            nvdbg("DHCPDECLINE\n");
-            dhcpd_decline();
-            break;
+              case DHCPDECLINE:
+                nvdbg("DHCPDECLINE\n");
+                dhcpd_decline();
+                break;
 
-          case DHCPRELEASE:
-            nvdbg("DHCPRELEASE\n");
-            dhcpd_release();
-            break;
+              case DHCPRELEASE:
+                nvdbg("DHCPRELEASE\n");
+                dhcpd_release();
+                break;
 
-          case DHCPINFORM: /* Not supported */
-          default:
-            ndbg("Unsupported message type: %d\n", g_state.ds_optmsgtype);
-            break;
+              case DHCPINFORM: /* Not supported */
+              default:
+                ndbg("Unsupported message type: %d\n", g_state.ds_optmsgtype);
+                break;
+            }
         }
+
+      /* Send the responses to the batch */
+
+      dhcpd_flush();
     }
 
+  netlib_udpsvc_free(g_state.ds_udpsvc);
+  g_state.ds_udpsvc = NULL;
   return OK;
 }
@@ -58,6 +58,7 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 
+#include <apps/netutils/netlib.h>
 #include <apps/netutils/discover.h>
 
 /****************************************************************************
@@ -89,6 +90,14 @@
 #  define CONFIG_DISCOVER_DESCR CONFIG_ARCH_BOARD
 #endif
 
+#ifndef CONFIG_DISCOVER_BATCH
+#  define CONFIG_DISCOVER_BATCH 8
+#endif
+
+#ifndef CONFIG_DISCOVER_DEDUPTIME
+#  define CONFIG_DISCOVER_DEDUPTIME 1000
+#endif
+
 /* Internal Definitions *****************************************************/
 /* Discover request packet format:
  * Byte Description
@@ -125,8 +134,8 @@ struct discover_state_s
 {
   struct discover_info_s info;
   in_addr_t serverip;
-  request_t request;
   response_t response;
+  FAR struct netlib_udpsvc_s *udpsvc;
 };
 
 /****************************************************************************
@@ -148,6 +157,7 @@ static inline int discover_openlistener(void);
 static inline int discover_openresponder(void);
 static inline int discover_parse(request_t packet);
 static inline int discover_respond(in_addr_t *ipaddr);
+static void discover_flush(void);
 static inline void discover_initresponse(void);
 
 /****************************************************************************
@@ -179,12 +189,28 @@ static int discover_daemon(int argc, char *argv[])
 {
   int sockfd = -1;
   int nbytes;
-  int addrlen = sizeof(struct sockaddr_in);
+  int nreplies;
+  size_t reqlen;
   struct sockaddr_in srcaddr;
+  FAR uint8_t *request;
 
   /* memset(&g_state, 0, sizeof(struct discover_state_s)); */
   discover_initresponse();
 
+  /* Requests are received in batches and repeated requests are dropped
+   * so that a burst of probes does not overflow the socket.  The packet
+   * buffers must hold the larger response.
+   */
+
+  g_state.udpsvc = netlib_udpsvc_alloc(DISCOVER_RESPONSE_SIZE,
+                                       CONFIG_DISCOVER_BATCH,
+                                       CONFIG_DISCOVER_DEDUPTIME);
+  if (g_state.udpsvc == NULL)
+    {
+      ndbg("Failed to allocate the request buffers\n");
+      return ERROR;
+    }
+
   nvdbg("Started\n");
 
   for (;;)
@@ -201,11 +227,9 @@ static int discover_daemon(int argc, char *argv[])
             }
         }
 
-      /* Read the next packet */
+      /* Read the next batch of packets */
 
-      nbytes = recvfrom(sockfd, &g_state.request, sizeof(g_state.request), 0,
-                        (struct sockaddr*) &srcaddr,
-                        (socklen_t *) &addrlen);
+      nbytes = netlib_udpsvc_recv(g_state.udpsvc, sockfd);
       if (nbytes < 0)
         {
           /* On errors (other EINTR), close the socket and try again */
@@ -219,16 +243,34 @@ static int discover_daemon(int argc, char *argv[])
           continue;
         }
 
-      if (discover_parse(g_state.request) != OK)
+      nreplies = 0;
+      while ((request = netlib_udpsvc_next(g_state.udpsvc, &reqlen,
+                                           &srcaddr)) != NULL)
         {
-          continue;
+          if (reqlen < DISCOVER_REQUEST_SIZE ||
+              discover_parse(request) != OK)
+            {
+              continue;
+            }
+
+          ndbg("Received discover from %08lx'\n", srcaddr.sin_addr.s_addr);
+
+          if (discover_respond(&srcaddr.sin_addr.s_addr) == OK)
+            {
+              nreplies++;
+            }
         }
 
-      ndbg("Received discover from %08lx'\n", srcaddr.sin_addr.s_addr);
+      /* Send the responses to the whole batch */
 
-      discover_respond(&srcaddr.sin_addr.s_addr);
+      if (nreplies > 0)
+        {
+          discover_flush();
+        }
     }
 
+  netlib_udpsvc_free(g_state.udpsvc);
+  g_state.udpsvc = NULL;
   return OK;
 }
 
@@ -270,34 +312,52 @@ static inline int discover_parse(request_t packet)
 static inline int discover_respond(in_addr_t *ipaddr)
 {
   struct sockaddr_in addr;
-  int sockfd;
   int ret;
 
-  sockfd = discover_openresponder();
-  if (sockfd < 0)
-    {
-      ndbg("discover_openresponder failed\n");
-      return ERROR;
-    }
-
-  /* Then send the reponse to the DHCP client port at that address */
+  /* Queue the reponse to the discover port at that address.  It is sent
+   * with the responses to the rest of the batch by discover_flush().
+   */
 
   memset(&addr, 0, sizeof(struct sockaddr_in));
   addr.sin_family      = AF_INET;
   addr.sin_port        = HTONS(CONFIG_DISCOVER_PORT);
   addr.sin_addr.s_addr = *ipaddr;
 
-  ret = sendto(sockfd, &g_state.response, sizeof(g_state.response), 0,
-               (struct sockaddr *)&addr, sizeof(struct sockaddr_in));
+  ret = netlib_udpsvc_reply(g_state.udpsvc, &addr, &g_state.response,
+                            sizeof(g_state.response));
   if (ret < 0)
     {
-      ndbg("Could not send discovery response: %d\n", errno);
+      ndbg("Could not queue discovery response: %d\n", errno);
     }
 
-  close(sockfd);
   return ret;
 }
 
+static void discover_flush(void)
+{
+  int sockfd;
+
+  /* Open one responder socket for all of the queued responses.  If that
+   * fails, the responses are discarded.
+   */
+
+  sockfd = discover_openresponder();
+  if (sockfd < 0)
+    {
+      ndbg("discover_openresponder failed\n");
+    }
+
+  if (netlib_udpsvc_flush(g_state.udpsvc, sockfd) < 0)
+    {
+      ndbg("Could not send discovery response: %d\n", errno);
+    }
+
+  if (sockfd >= 0)
+    {
+      close(sockfd);
+    }
+}
+
 static inline int discover_socket()
 {
   int sockfd;
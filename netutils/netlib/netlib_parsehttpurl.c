@@ -102,6 +102,7 @@ int netlib_parsehttpurl(const char *url, uint16_t *port,
           else
             {
               ret = -E2BIG;
+              src++;
             }
         }
       *dest = '\0';
@@ -142,7 +143,7 @@ int netlib_parsehttpurl(const char *url, uint16_t *port,
 
   /* The copy the rest of the file name to the user buffer */
 
-  strncpy(dest, src, namelen);
+  strncpy(dest, src, bytesleft);
   filename[namelen-1] = '\0';
   return ret;
 }
@@ -0,0 +1,523 @@
+/****************************************************************************
+ * netutils/netlib/netlib_udpservice.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <poll.h>
+#include <time.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <netinet/in.h>
+
+#include <apps/netutils/netlib.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The duplicate detection history remembers two batches of requests */
+
+#define UDPSVC_NHIST(npkts) (2 * (npkts))
+
+/* Hash of the payload (32-bit FNV-1a) */
+
+#define UDPSVC_HASHINIT  2166136261u
+#define UDPSVC_HASHPRIME 16777619u
+
+#ifdef CONFIG_CLOCK_MONOTONIC
+#  define UDPSVC_CLOCK CLOCK_MONOTONIC
+#else
+#  define UDPSVC_CLOCK CLOCK_REALTIME
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One datagram in the receive batch or in the transmit queue */
+
+struct udpsvc_pkt_s
+{
+  struct sockaddr_in addr;   /* Source (receive) or destination (transmit) */
+  uint32_t hash;             /* Hash of the payload */
+  uint16_t len;              /* Length of the payload */
+  FAR uint8_t *data;         /* Payload buffer of pktsize bytes */
+};
+
+/* A recently received request, remembered for duplicate detection */
+
+struct udpsvc_hist_s
+{
+  in_addr_t addr;            /* Source IP address */
+  uint16_t port;             /* Source port */
+  uint16_t len;              /* Length of the payload */
+  uint32_t hash;             /* Hash of the payload */
+  uint32_t time;             /* Time of receipt (msec) */
+};
+
+/* The state of one UDP service.  Everything is allocated in one block:
+ * this structure, the packet descriptors, the history and then the packet
+ * buffers.
+ */
+
+struct netlib_udpsvc_s
+{
+  uint16_t pktsize;          /* Size of each packet buffer */
+  uint8_t  npkts;            /* Packets per batch and queued replies */
+  uint8_t  nrx;              /* Number of requests in the current batch */
+  uint8_t  rxndx;            /* Next request returned by netlib_udpsvc_next */
+  uint8_t  ntx;              /* Number of queued replies */
+  uint8_t  nhist;            /* Number of history entries */
+  uint8_t  histndx;          /* Next history entry to replace */
+  uint32_t dedupms;          /* Duplicate detection window (msec) */
+  FAR struct udpsvc_pkt_s *rx;    /* Receive batch */
+  FAR struct udpsvc_pkt_s *tx;    /* Transmit queue */
+  FAR struct udpsvc_hist_s *hist; /* Recently received requests */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: udpsvc_hash
+ ****************************************************************************/
+
+static uint32_t udpsvc_hash(FAR const uint8_t *data, size_t len)
+{
+  uint32_t hash = UDPSVC_HASHINIT;
+
+  while (len-- > 0)
+    {
+      hash = (hash ^ *data++) * UDPSVC_HASHPRIME;
+    }
+
+  return hash;
+}
+
+/****************************************************************************
+ * Name: udpsvc_msec
+ ****************************************************************************/
+
+static uint32_t udpsvc_msec(void)
+{
+  struct timespec ts;
+
+  (void)clock_gettime(UDPSVC_CLOCK, &ts);
+  return (uint32_t)ts.tv_sec * 1000 + (uint32_t)(ts.tv_nsec / 1000000);
+}
+
+/****************************************************************************
+ * Name: udpsvc_duplicate
+ *
+ * Description:
+ *   Return true if the same request was received from the same source
+ *   within the duplicate detection window.  Otherwise, remember the request
+ *   and return false.
+ *
+ ****************************************************************************/
+
+static bool udpsvc_duplicate(FAR struct netlib_udpsvc_s *svc,
+                             FAR const struct udpsvc_pkt_s *pkt)
+{
+  FAR struct udpsvc_hist_s *hist;
+  uint32_t now;
+  int i;
+
+  if (svc->dedupms == 0)
+    {
+      return false;
+    }
+
+  now = udpsvc_msec();
+  for (i = 0; i < svc->nhist; i++)
+    {
+      hist = &svc->hist[i];
+      if (hist->hash == pkt->hash && hist->len == pkt->len &&
+          hist->addr == pkt->addr.sin_addr.s_addr &&
+          hist->port == pkt->addr.sin_port &&
+          (uint32_t)(now - hist->time) < svc->dedupms)
+        {
+          return true;
+        }
+    }
+
+  hist       = &svc->hist[svc->histndx];
+  hist->addr = pkt->addr.sin_addr.s_addr;
+  hist->port = pkt->addr.sin_port;
+  hist->len  = pkt->len;
+  hist->hash = pkt->hash;
+  hist->time = now;
+
+  if (++svc->histndx >= svc->nhist)
+    {
+      svc->histndx = 0;
+    }
+
+  return false;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: netlib_udpsvc_alloc
+ *
+ * Description:
+ *   Allocate the state of a batched UDP service.
+ *
+ * Parameters:
+ *   pktsize  The size of the largest request or reply
+ *   npkts    The maximum number of requests received in one batch, which
+ *            is also the maximum number of queued replies (1-127)
+ *   dedupms  Identical requests from the same source within this many
+ *            milliseconds are discarded.  Zero disables this.
+ *
+ * Return:
+ *   The new UDP service state on success; NULL on failure with errno set.
+ *
+ ****************************************************************************/
+
+FAR struct netlib_udpsvc_s *netlib_udpsvc_alloc(uint16_t pktsize,
+                                                uint8_t npkts,
+                                                unsigned int dedupms)
+{
+  FAR struct netlib_udpsvc_s *svc;
+  FAR uint8_t *data;
+  size_t size;
+  int nhist;
+  int i;
+
+  if (pktsize == 0 || npkts == 0 || npkts > 127)
+    {
+      errno = EINVAL;
+      return NULL;
+    }
+
+  nhist = UDPSVC_NHIST(npkts);
+  size  = sizeof(struct netlib_udpsvc_s) +
+          2 * npkts * sizeof(struct udpsvc_pkt_s) +
+          nhist * sizeof(struct udpsvc_hist_s) +
+          2 * npkts * (size_t)pktsize;
+
+  svc = (FAR struct netlib_udpsvc_s *)calloc(1, size);
+  if (svc == NULL)
+    {
+      errno = ENOMEM;
+      return NULL;
+    }
+
+  svc->pktsize = pktsize;
+  svc->npkts   = npkts;
+  svc->nhist   = nhist;
+  svc->dedupms = dedupms;
+  svc->rx      = (FAR struct udpsvc_pkt_s *)&svc[1];
+  svc->tx      = &svc->rx[npkts];
+  svc->hist    = (FAR struct udpsvc_hist_s *)&svc->tx[npkts];
+
+  data = (FAR uint8_t *)&svc->hist[nhist];
+  for (i = 0; i < 2 * npkts; i++)
+    {
+      svc->rx[i].data = data;
+      data += pktsize;
+    }
+
+  return svc;
+}
+
+/****************************************************************************
+ * Name: netlib_udpsvc_free
+ *
+ * Description:
+ *   Free the UDP service state.  Queued replies are discarded.
+ *
+ ****************************************************************************/
+
+void netlib_udpsvc_free(FAR struct netlib_udpsvc_s *svc)
+{
+  free(svc);
+}
+
+/****************************************************************************
+ * Name: netlib_udpsvc_recv
+ *
+ * Description:
+ *   Wait for the next request, then drain any further requests that are
+ *   already queued on the socket into the receive batch without waiting.
+ *   Repeated requests are discarded.  The requests of the previous batch
+ *   are lost.
+ *
+ *   Draining the socket in batches keeps the socket receive queue from
+ *   overflowing when many requests arrive at once, for example when many
+ *   devices are powered up together.
+ *
+ * Parameters:
+ *   svc     The UDP service state
+ *   sockfd  The bound socket to receive on
+ *
+ * Return:
+ *   The number of requests in the batch (at least one) on success; ERROR
+ *   with errno set if the first receive fails.
+ *
+ ****************************************************************************/
+
+int netlib_udpsvc_recv(FAR struct netlib_udpsvc_s *svc, int sockfd)
+{
+  FAR struct udpsvc_pkt_s *pkt;
+  socklen_t addrlen;
+  ssize_t nbytes;
+#ifndef CONFIG_DISABLE_POLL
+  struct pollfd fds;
+#endif
+  int ndups = 0;
+
+  svc->nrx   = 0;
+  svc->rxndx = 0;
+
+  while (svc->nrx < svc->npkts)
+    {
+      /* Only the first receive of the batch may wait */
+
+      if (svc->nrx > 0)
+        {
+#ifndef CONFIG_DISABLE_POLL
+          fds.fd      = sockfd;
+          fds.events  = POLLIN;
+          fds.revents = 0;
+
+          if (poll(&fds, 1, 0) <= 0 || (fds.revents & POLLIN) == 0)
+            {
+              break;
+            }
+#else
+          break;
+#endif
+        }
+
+      pkt     = &svc->rx[svc->nrx];
+      addrlen = sizeof(struct sockaddr_in);
+      nbytes  = recvfrom(sockfd, pkt->data, svc->pktsize, 0,
+                         (FAR struct sockaddr *)&pkt->addr, &addrlen);
+      if (nbytes < 0)
+        {
+          /* Return the requests that were already received.  The error
+           * will be reported again on the next call.
+           */
+
+          if (svc->nrx > 0)
+            {
+              break;
+            }
+
+          return ERROR;
+        }
+
+      pkt->len  = (uint16_t)nbytes;
+      pkt->hash = udpsvc_hash(pkt->data, pkt->len);
+
+      if (udpsvc_duplicate(svc, pkt))
+        {
+          ndups++;
+          continue;
+        }
+
+      svc->nrx++;
+    }
+
+  nvdbg("Received %d requests, %d duplicates\n", svc->nrx, ndups);
+  return svc->nrx;
+}
+
+/****************************************************************************
+ * Name: netlib_udpsvc_next
+ *
+ * Description:
+ *   Return the next request of the current batch.
+ *
+ * Parameters:
+ *   svc   The UDP service state
+ *   len   The location to return the length of the request
+ *   from  The location to return the source address.  May be NULL.
+ *
+ * Return:
+ *   A pointer to the request data, valid until the next call to
+ *   netlib_udpsvc_recv().  NULL if there are no more requests.
+ *
+ ****************************************************************************/
+
+FAR void *netlib_udpsvc_next(FAR struct netlib_udpsvc_s *svc,
+                             FAR size_t *len, FAR struct sockaddr_in *from)
+{
+  FAR struct udpsvc_pkt_s *pkt;
+
+  if (svc->rxndx >= svc->nrx)
+    {
+      return NULL;
+    }
+
+  pkt  = &svc->rx[svc->rxndx++];
+  *len = pkt->len;
+
+  if (from != NULL)
+    {
+      memcpy(from, &pkt->addr, sizeof(struct sockaddr_in));
+    }
+
+  return pkt->data;
+}
+
+/****************************************************************************
+ * Name: netlib_udpsvc_reply
+ *
+ * Description:
+ *   Queue a reply to be sent by netlib_udpsvc_flush().  A reply that is
+ *   identical to one already queued for the same destination is sent only
+ *   once.
+ *
+ * Parameters:
+ *   svc  The UDP service state
+ *   to   The destination address
+ *   buf  The reply data
+ *   len  The length of the reply data
+ *
+ * Return:
+ *   OK on success; ERROR with errno set to EMSGSIZE if the reply is larger
+ *   than the packet size or to ENOBUFS if the queue is full.
+ *
+ ****************************************************************************/
+
+int netlib_udpsvc_reply(FAR struct netlib_udpsvc_s *svc,
+                        FAR const struct sockaddr_in *to,
+                        FAR const void *buf, size_t len)
+{
+  FAR struct udpsvc_pkt_s *pkt;
+  uint32_t hash;
+  int i;
+
+  if (len > svc->pktsize)
+    {
+      errno = EMSGSIZE;
+      return ERROR;
+    }
+
+  hash = udpsvc_hash((FAR const uint8_t *)buf, len);
+  for (i = 0; i < svc->ntx; i++)
+    {
+      pkt = &svc->tx[i];
+      if (pkt->hash == hash && pkt->len == len &&
+          pkt->addr.sin_addr.s_addr == to->sin_addr.s_addr &&
+          pkt->addr.sin_port == to->sin_port &&
+          memcmp(pkt->data, buf, len) == 0)
+        {
+          nvdbg("Reply coalesced\n");
+          return OK;
+        }
+    }
+
+  if (svc->ntx >= svc->npkts)
+    {
+      errno = ENOBUFS;
+      return ERROR;
+    }
+
+  pkt       = &svc->tx[svc->ntx++];
+  pkt->hash = hash;
+  pkt->len  = (uint16_t)len;
+
+  memcpy(&pkt->addr, to, sizeof(struct sockaddr_in));
+  memcpy(pkt->data, buf, len);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: netlib_udpsvc_flush
+ *
+ * Description:
+ *   Send all queued replies and empty the queue.
+ *
+ * Parameters:
+ *   svc     The UDP service state
+ *   sockfd  The socket to send on.  If negative, the queued replies are
+ *           discarded.
+ *
+ * Return:
+ *   OK if all replies were sent; ERROR with errno set to the error of the
+ *   first failed send.
+ *
+ ****************************************************************************/
+
+int netlib_udpsvc_flush(FAR struct netlib_udpsvc_s *svc, int sockfd)
+{
+  FAR struct udpsvc_pkt_s *pkt;
+  ssize_t nbytes;
+  int errval = 0;
+  int i;
+
+  for (i = 0; i < svc->ntx && sockfd >= 0; i++)
+    {
+      pkt    = &svc->tx[i];
+      nbytes = sendto(sockfd, pkt->data, pkt->len, 0,
+                      (FAR struct sockaddr *)&pkt->addr,
+                      sizeof(struct sockaddr_in));
+      if (nbytes < 0 && errval == 0)
+        {
+          errval = errno;
+          ndbg("sendto failed: %d\n", errval);
+        }
+    }
+
+  svc->ntx = 0;
+
+  if (errval != 0)
+    {
+      errno = errval;
+      return ERROR;
+    }
+
+  return OK;
+}
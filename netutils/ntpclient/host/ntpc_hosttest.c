@@ -0,0 +1,768 @@
+/****************************************************************************
+ * apps/netutils/ntpclient/host/ntpc_hosttest.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <errno.h>
+#include <math.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include <apps/netutils/ntpclient.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define NSEC_PER_SEC      1000000000ll
+#define NSEC_PER_MSEC     1000000ll
+#define NSEC_PER_USEC     1000ll
+
+/* The responders.  Their ports must match CONFIG_NETUTILS_NTPCLIENT_SERVERS
+ * in host/nuttx/config.h.  The last one is a falseticker that is ahead of
+ * the others by HOST_FALSEOFFSET.
+ */
+
+#define HOST_NSERVERS     4
+#define HOST_PORTNO       12301
+#define HOST_FALSEOFFSET  (500 * NSEC_PER_MSEC)
+
+/* The simulated system clock starts this far behind the true time */
+
+#define HOST_INITOFFSET   (-3600 * NSEC_PER_SEC)
+
+/* The time spanned by the eight stages of the clock filter (seconds) */
+
+#define HOST_FILTERSPAN   (8 * CONFIG_NETUTILS_NTPCLIENT_POLLDELAYSEC)
+
+/* NTP time is seconds since 1900 */
+
+#define NTP2UNIX          2208988800ll
+#define NTP_PACKETSIZE    48
+
+/* Defaults for the command line options */
+
+#define DEFAULT_SECONDS   60
+#define DEFAULT_TICK      10000    /* Microseconds */
+#define DEFAULT_DRIFT     200      /* PPM */
+#define DEFAULT_DELAY     20       /* Milliseconds */
+#define DEFAULT_JITTER    5        /* Milliseconds */
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The scheduler lock.  ntpclient.c runs with the scheduler locked except
+ * while it is blocked, and relies on that when it holds the clock.  Here
+ * the lock is a mutex that is released by the blocking calls.
+ */
+
+static pthread_mutex_t g_schedlock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t g_schedowner;
+static int g_schedcount;
+
+/* The simulated system clock.  Like the NuttX system clock, it advances
+ * in steps of one tick, and clock_settime() sets the time of the current
+ * tick.  The tick runs fast or slow by g_drift PPM.
+ */
+
+static pthread_mutex_t g_clocklock = PTHREAD_MUTEX_INITIALIZER;
+static int64_t g_base;          /* Time at tick g_bias */
+static int64_t g_bias;          /* Tick count when the clock was set */
+static int64_t g_tick;          /* Tick period */
+static int64_t g_epoch;         /* True time at CLOCK_MONOTONIC zero */
+static double g_drift;          /* Frequency error (PPM) */
+static unsigned long g_nsets;   /* Number of clock_settime() calls */
+
+/* Network simulation */
+
+static int64_t g_delay;         /* Mean one way delay */
+static int64_t g_jitter;        /* Maximum deviation from g_delay */
+static volatile bool g_stop;    /* True: Stop the responders and checker */
+
+/* Clock monotonicity checker */
+
+static unsigned long g_nreads;  /* Number of times the clock was read */
+static unsigned long g_nback;   /* Number of times it went backward */
+static int64_t g_maxback;       /* Largest backward step */
+
+/* The NTP daemon thread */
+
+static pthread_t g_daemon;
+static main_t g_entry;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+/****************************************************************************
+ * Name: host_*
+ *
+ * Description:
+ *   The true time (the time served by the responders) and the simulated
+ *   system clock of the target.
+ *
+ ****************************************************************************/
+
+static int64_t host_monotonic(void)
+{
+  struct timespec ts;
+
+  (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static int64_t host_truetime(void)
+{
+  return g_epoch + host_monotonic();
+}
+
+static int64_t host_ticks(void)
+{
+  return (int64_t)((double)host_monotonic() * (1.0 + g_drift / 1e6) /
+                   (double)g_tick);
+}
+
+static int64_t host_systime(void)
+{
+  int64_t now;
+
+  pthread_mutex_lock(&g_clocklock);
+  now = g_base + (host_ticks() - g_bias) * g_tick;
+  pthread_mutex_unlock(&g_clocklock);
+  return now;
+}
+
+static void host_setsystime(int64_t now)
+{
+  pthread_mutex_lock(&g_clocklock);
+  g_base = now;
+  g_bias = host_ticks();
+  g_nsets++;
+  pthread_mutex_unlock(&g_clocklock);
+}
+
+/****************************************************************************
+ * Name: host_release and host_reacquire
+ *
+ * Description:
+ *   Release the scheduler lock before a blocking call and take it back
+ *   afterward, as NuttX does when a task that has locked the scheduler
+ *   blocks.
+ *
+ ****************************************************************************/
+
+static int host_release(void)
+{
+  int count = 0;
+
+  if (g_schedcount > 0 && pthread_equal(g_schedowner, pthread_self()))
+    {
+      count        = g_schedcount;
+      g_schedcount = 0;
+      pthread_mutex_unlock(&g_schedlock);
+    }
+
+  return count;
+}
+
+static void host_reacquire(int count)
+{
+  if (count > 0)
+    {
+      pthread_mutex_lock(&g_schedlock);
+      g_schedowner = pthread_self();
+      g_schedcount = count;
+    }
+}
+
+/****************************************************************************
+ * Name: host_timestamp
+ *
+ * Description:
+ *   Store nanoseconds since the Unix epoch as an NTP timestamp.
+ *
+ ****************************************************************************/
+
+static void host_timestamp(FAR uint8_t *ptr, int64_t time)
+{
+  uint32_t sec  = (uint32_t)(time / NSEC_PER_SEC + NTP2UNIX);
+  uint32_t frac = (uint32_t)(((uint64_t)(time % NSEC_PER_SEC) << 32) /
+                             NSEC_PER_SEC);
+
+  ptr[0] = sec >> 24;
+  ptr[1] = sec >> 16;
+  ptr[2] = sec >> 8;
+  ptr[3] = sec;
+  ptr[4] = frac >> 24;
+  ptr[5] = frac >> 16;
+  ptr[6] = frac >> 8;
+  ptr[7] = frac;
+}
+
+/****************************************************************************
+ * Name: host_netdelay
+ *
+ * Description:
+ *   Wait for a one way network delay with a uniformly distributed jitter.
+ *
+ ****************************************************************************/
+
+static void host_netdelay(FAR unsigned int *seed)
+{
+  int64_t delay = g_delay;
+
+  if (g_jitter > 0)
+    {
+      delay += (int64_t)(rand_r(seed) % (2 * g_jitter / NSEC_PER_USEC + 1)) *
+               NSEC_PER_USEC - g_jitter;
+    }
+
+  if (delay > 0)
+    {
+      usleep((useconds_t)(delay / NSEC_PER_USEC));
+    }
+}
+
+/****************************************************************************
+ * Name: host_responder
+ *
+ * Description:
+ *   A minimal stratum 1 NTP server.  The request and the response are each
+ *   delayed by host_netdelay().  The difference between the two delays
+ *   shows up as an error in the offset measured by the client.
+ *
+ ****************************************************************************/
+
+static void *host_responder(void *arg)
+{
+  int ndx = (int)(intptr_t)arg;
+  struct sockaddr_in addr;
+  struct sockaddr_in from;
+  struct timeval tv;
+  socklen_t addrlen;
+  unsigned int seed = ndx + 1;
+  uint8_t buffer[NTP_PACKETSIZE];
+  uint8_t request[NTP_PACKETSIZE];
+  ssize_t nbytes;
+  int64_t now;
+  int sd;
+
+  sd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (sd < 0)
+    {
+      perror("socket");
+      exit(EXIT_FAILURE);
+    }
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family      = AF_INET;
+  addr.sin_port        = htons(HOST_PORTNO + ndx);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  if (bind(sd, (FAR struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+      perror("bind");
+      exit(EXIT_FAILURE);
+    }
+
+  tv.tv_sec  = 0;
+  tv.tv_usec = 100000;
+  (void)setsockopt(sd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+  while (!g_stop)
+    {
+      addrlen = sizeof(from);
+      nbytes  = recvfrom(sd, request, sizeof(request), 0,
+                         (FAR struct sockaddr *)&from, &addrlen);
+      if (nbytes < NTP_PACKETSIZE)
+        {
+          continue;
+        }
+
+      host_netdelay(&seed);
+
+      /* Receive and transmit timestamps */
+
+      now = host_truetime();
+      if (ndx == HOST_NSERVERS - 1)
+        {
+          now += HOST_FALSEOFFSET;
+        }
+
+      memset(buffer, 0, sizeof(buffer));
+      buffer[0] = (0 << 6) | (3 << 3) | 4;     /* LI 0, version 3, server */
+      buffer[1] = 1;                           /* Stratum 1 */
+      buffer[3] = (uint8_t)-20;                /* Precision, about 1 usec */
+      memcpy(&buffer[12], "HOST", 4);          /* Reference ID */
+      host_timestamp(&buffer[16], now);        /* Reference timestamp */
+      memcpy(&buffer[24], &request[40], 8);    /* Originate timestamp */
+      host_timestamp(&buffer[32], now);        /* Receive timestamp */
+      host_timestamp(&buffer[40], now);        /* Transmit timestamp */
+
+      host_netdelay(&seed);
+      (void)sendto(sd, buffer, sizeof(buffer), 0,
+                   (FAR struct sockaddr *)&from, addrlen);
+    }
+
+  close(sd);
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: host_checker
+ *
+ * Description:
+ *   Read the system clock as often as possible, as any other task could,
+ *   and count the times that it goes backward.
+ *
+ ****************************************************************************/
+
+static void *host_checker(void *arg)
+{
+  int64_t last = 0;
+  int64_t now;
+
+  while (!g_stop)
+    {
+      sched_lock();
+      now = host_systime();
+      sched_unlock();
+
+      if (g_nreads++ > 0 && now < last)
+        {
+          g_nback++;
+          if (last - now > g_maxback)
+            {
+              g_maxback = last - now;
+            }
+        }
+
+      last = now;
+      usleep(50);
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: host_daemon
+ ****************************************************************************/
+
+static void *host_daemon(void *arg)
+{
+  char *argv[2] =
+  {
+    "ntpc", NULL
+  };
+
+  (void)g_entry(1, argv);
+  return NULL;
+}
+
+static void host_wakeup(int signo)
+{
+}
+
+/****************************************************************************
+ * Name: host_check and host_checktime
+ *
+ * Description:
+ *   Report one check.  Returns 1 if it failed.
+ *
+ ****************************************************************************/
+
+static int host_check(bool ok, FAR const char *what, long long value,
+                      long long limit)
+{
+  printf("  %-26s %10lld  (limit %lld)  %s\n", what, value, limit,
+         ok ? "ok" : "FAILED");
+  return ok ? 0 : 1;
+}
+
+static int host_checktime(bool ok, FAR const char *what, int64_t value,
+                          int64_t limit)
+{
+  printf("  %-26s %10lld usec  (limit %lld usec)  %s\n", what,
+         (long long)(value / NSEC_PER_USEC),
+         (long long)(limit / NSEC_PER_USEC), ok ? "ok" : "FAILED");
+  return ok ? 0 : 1;
+}
+
+static void show_usage(FAR const char *progname)
+{
+  fprintf(stderr,
+          "USAGE: %s [-s <seconds>] [-t <tick>] [-f <ppm>] "
+          "[-d <delay>] [-j <jitter>]\n\n"
+          "  -s  Test duration in seconds (default %d)\n"
+          "  -t  System clock tick in microseconds (default %d)\n"
+          "  -f  Frequency error of the system clock in PPM (default %d)\n"
+          "  -d  Mean one way network delay in msec (default %d)\n"
+          "  -j  Maximum network jitter in msec (default %d)\n",
+          progname, DEFAULT_SECONDS, DEFAULT_TICK, DEFAULT_DRIFT,
+          DEFAULT_DELAY, DEFAULT_JITTER);
+  exit(EXIT_FAILURE);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+/****************************************************************************
+ * Name: sched_lock, sched_unlock and task_create
+ ****************************************************************************/
+
+void sched_lock(void)
+{
+  if (g_schedcount > 0 && pthread_equal(g_schedowner, pthread_self()))
+    {
+      g_schedcount++;
+    }
+  else
+    {
+      pthread_mutex_lock(&g_schedlock);
+      g_schedowner = pthread_self();
+      g_schedcount = 1;
+    }
+}
+
+void sched_unlock(void)
+{
+  if (--g_schedcount == 0)
+    {
+      pthread_mutex_unlock(&g_schedlock);
+    }
+}
+
+int task_create(const char *name, int priority, int stack_size,
+                main_t entry, char * const argv[])
+{
+  g_entry = entry;
+  if (pthread_create(&g_daemon, NULL, host_daemon, NULL) != 0)
+    {
+      errno = ENOMEM;
+      return ERROR;
+    }
+
+  return 1;
+}
+
+/****************************************************************************
+ * Name: ntpc_host_*
+ *
+ * Description:
+ *   Used by ntpclient.c in place of the host interfaces of the same names.
+ *
+ ****************************************************************************/
+
+int ntpc_host_gettime(clockid_t clockid, FAR struct timespec *ts)
+{
+  int64_t now = host_systime();
+
+  ts->tv_sec  = (time_t)(now / NSEC_PER_SEC);
+  ts->tv_nsec = (long)(now % NSEC_PER_SEC);
+  return OK;
+}
+
+int ntpc_host_settime(clockid_t clockid, FAR const struct timespec *ts)
+{
+  host_setsystime((int64_t)ts->tv_sec * NSEC_PER_SEC + ts->tv_nsec);
+  return OK;
+}
+
+int ntpc_host_getres(clockid_t clockid, FAR struct timespec *ts)
+{
+  ts->tv_sec  = (time_t)(g_tick / NSEC_PER_SEC);
+  ts->tv_nsec = (long)(g_tick % NSEC_PER_SEC);
+  return OK;
+}
+
+unsigned int ntpc_host_sleep(unsigned int seconds)
+{
+  int count = host_release();
+  unsigned int ret = sleep(seconds);
+
+  host_reacquire(count);
+  return ret;
+}
+
+ssize_t ntpc_host_recvfrom(int sd, FAR void *buf, size_t len, int flags,
+                           FAR struct sockaddr *from,
+                           FAR socklen_t *fromlen)
+{
+  int count = host_release();
+  ssize_t ret = recvfrom(sd, buf, len, flags, from, fromlen);
+  int errval = errno;
+
+  host_reacquire(count);
+  errno = errval;
+  return ret;
+}
+
+int ntpc_host_semwait(FAR sem_t *sem)
+{
+  int count = host_release();
+  int ret = sem_wait(sem);
+  int errval = errno;
+
+  host_reacquire(count);
+  errno = errval;
+  return ret;
+}
+
+int ntpc_host_kill(pid_t pid, int signo)
+{
+  return pthread_kill(g_daemon, signo) == 0 ? OK : ERROR;
+}
+
+/****************************************************************************
+ * Name: main
+ ****************************************************************************/
+
+int main(int argc, FAR char **argv)
+{
+  struct ntpc_status_s status;
+  FAR struct ntpc_peerstatus_s *peer;
+  struct sigaction act;
+  struct timespec ts;
+  pthread_t responder[HOST_NSERVERS];
+  pthread_t checker;
+  int64_t error;
+  int64_t limit;
+  int nfailed = 0;
+  int seconds = DEFAULT_SECONDS;
+  int option;
+  int ret;
+  int i;
+
+  g_tick   = DEFAULT_TICK * NSEC_PER_USEC;
+  g_drift  = DEFAULT_DRIFT;
+  g_delay  = DEFAULT_DELAY * NSEC_PER_MSEC;
+  g_jitter = DEFAULT_JITTER * NSEC_PER_MSEC;
+
+  while ((option = getopt(argc, argv, "s:t:f:d:j:")) != ERROR)
+    {
+      switch (option)
+        {
+          case 's':
+            seconds = atoi(optarg);
+            break;
+
+          case 't':
+            g_tick = atoll(optarg) * NSEC_PER_USEC;
+            break;
+
+          case 'f':
+            g_drift = atof(optarg);
+            break;
+
+          case 'd':
+            g_delay = atoll(optarg) * NSEC_PER_MSEC;
+            break;
+
+          case 'j':
+            g_jitter = atoll(optarg) * NSEC_PER_MSEC;
+            break;
+
+          default:
+            show_usage(argv[0]);
+        }
+    }
+
+  if (seconds < 10 || g_tick <= 0 || g_delay < 0 || g_jitter < 0 ||
+      g_jitter > g_delay)
+    {
+      show_usage(argv[0]);
+    }
+
+  /* The stop request interrupts the daemon's blocking calls */
+
+  memset(&act, 0, sizeof(act));
+  act.sa_handler = host_wakeup;
+  (void)sigaction(CONFIG_NETUTILS_NTPCLIENT_SIGWAKEUP, &act, NULL);
+
+  /* Start the system clock an hour behind the true time */
+
+  (void)clock_gettime(CLOCK_REALTIME, &ts);
+  g_epoch = (int64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec -
+            host_monotonic();
+  host_setsystime(host_truetime() + HOST_INITOFFSET);
+  g_nsets = 0;
+
+  printf("%d seconds, %lld usec tick, %+.0f PPM, "
+         "delay %lld +/- %lld msec\n", seconds,
+         (long long)(g_tick / NSEC_PER_USEC), g_drift,
+         (long long)(g_delay / NSEC_PER_MSEC),
+         (long long)(g_jitter / NSEC_PER_MSEC));
+
+  for (i = 0; i < HOST_NSERVERS; i++)
+    {
+      pthread_create(&responder[i], NULL, host_responder,
+                     (FAR void *)(intptr_t)i);
+    }
+
+  pthread_create(&checker, NULL, host_checker, NULL);
+
+  ret = ntpc_start();
+  if (ret < 0)
+    {
+      fprintf(stderr, "ntpc_start failed: %d\n", ret);
+      return EXIT_FAILURE;
+    }
+
+  /* Show the clock error while the daemon runs */
+
+  for (i = 1; i <= seconds; i++)
+    {
+      sleep(1);
+      if (i % 10 == 0 || i == seconds)
+        {
+          printf("%4d s: clock error %8lld usec\n", i,
+                 (long long)((host_systime() - host_truetime()) /
+                             NSEC_PER_USEC));
+        }
+    }
+
+  sched_lock();
+  ret = ntpc_status(&status);
+  error = host_systime() - host_truetime();
+  sched_unlock();
+
+  (void)ntpc_stop();
+  g_stop = true;
+
+  for (i = 0; i < HOST_NSERVERS; i++)
+    {
+      pthread_join(responder[i], NULL);
+    }
+
+  pthread_join(checker, NULL);
+
+  if (ret < 0)
+    {
+      fprintf(stderr, "ntpc_status failed: %d\n", ret);
+      return EXIT_FAILURE;
+    }
+
+  /* Show the statistics */
+
+  printf("\n%lu updates, %lu steps, %lu clock_settime() calls, "
+         "%d of %d servers used\n",
+         (unsigned long)status.nupdates, (unsigned long)status.nsteps,
+         g_nsets, status.nsurvivors, status.npeers);
+  printf("system: offset %lld usec jitter %lld usec\n",
+         (long long)(status.offset / NSEC_PER_USEC),
+         (long long)(status.jitter / NSEC_PER_USEC));
+
+  for (i = 0; i < status.npeers; i++)
+    {
+      peer = &status.peer[i];
+      printf("server %d: reach %02x %s offset %8lld delay %8lld "
+             "jitter %8lld usec\n", i, peer->reach,
+             peer->selected ? "*" : " ",
+             (long long)(peer->offset / NSEC_PER_USEC),
+             (long long)(peer->delay / NSEC_PER_USEC),
+             (long long)(peer->jitter / NSEC_PER_USEC));
+    }
+
+  /* Check the statistics against the simulated network.  The timestamps
+   * of the client have the resolution of one tick.
+   */
+
+  printf("\nChecks:\n");
+
+  for (i = 0; i < HOST_NSERVERS - 1; i++)
+    {
+      peer = &status.peer[i];
+      printf(" server %d:\n", i);
+      nfailed += host_check(peer->selected, "selected", peer->selected, 1);
+
+      limit = 2 * (g_delay + g_jitter) + 2 * g_tick + 10 * NSEC_PER_MSEC;
+      nfailed += host_checktime(peer->delay >= 2 * (g_delay - g_jitter) -
+                                2 * g_tick && peer->delay <= limit,
+                                "delay", peer->delay, limit);
+
+      limit = g_jitter + 2 * g_tick + 2 * NSEC_PER_MSEC;
+      nfailed += host_checktime(llabs(peer->offset) <= limit, "offset",
+                                peer->offset, limit);
+
+      limit = 2 * g_jitter + 2 * g_tick;
+      nfailed += host_checktime(peer->jitter <= limit, "jitter",
+                                peer->jitter, limit);
+    }
+
+  peer = &status.peer[HOST_NSERVERS - 1];
+  printf(" server %d (falseticker):\n", HOST_NSERVERS - 1);
+  nfailed += host_check(!peer->selected, "selected", peer->selected, 0);
+
+  printf(" system:\n");
+  nfailed += host_check(status.synchronized && status.nsteps == 1,
+                        "clock steps", status.nsteps, 1);
+  nfailed += host_check(status.nsurvivors >= 3, "servers used",
+                        status.nsurvivors, 3);
+
+  /* The clock is only corrected for its phase, not for its frequency
+   * error, and the clock filter may use a sample from up to eight polls
+   * earlier, so the frequency error adds to the clock error.
+   */
+
+  limit = g_jitter + 3 * g_tick +
+          (int64_t)(fabs(g_drift) * HOST_FILTERSPAN * NSEC_PER_USEC);
+  nfailed += host_checktime(llabs(error) <= limit, "clock error", error,
+                            limit);
+  nfailed += host_checktime(g_nback == 0, "largest backward step",
+                            g_maxback, 0);
+
+  printf("\n%lu clock reads, %lu backward, %d checks failed\n",
+         g_nreads, g_nback, nfailed);
+  return nfailed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
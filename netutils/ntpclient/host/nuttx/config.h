@@ -0,0 +1,95 @@
+/****************************************************************************
+ * apps/netutils/ntpclient/host/nuttx/config.h
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_NETUTILS_NTPCLIENT_HOST_NUTTX_CONFIG_H
+#define __APPS_NETUTILS_NTPCLIENT_HOST_NUTTX_CONFIG_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <assert.h>
+#include <semaphore.h>
+#include <signal.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+/* Environment stuff */
+
+#define OK 0
+#define ERROR -1
+#define FAR
+#define CODE
+#define DEBUGASSERT assert
+
+#define CONFIG_HAVE_LONG_LONG 1
+
+/* Configuration.  The servers are the responders started by
+ * ntpc_hosttest.c.  The last one is a falseticker.
+ */
+
+#define CONFIG_NET_UDP 1
+#define CONFIG_NETUTILS_NTPCLIENT 1
+#define CONFIG_NETUTILS_NTPCLIENT_SERVERIP 0
+#define CONFIG_NETUTILS_NTPCLIENT_SERVERS \
+  "127.0.0.1:12301,127.0.0.1:12302,127.0.0.1:12303,127.0.0.1:12304"
+#define CONFIG_NETUTILS_NTPCLIENT_MAXSERVERS 4
+#define CONFIG_NETUTILS_NTPCLIENT_POLLDELAYSEC 2
+#define CONFIG_NETUTILS_NTPCLIENT_STEPMSEC 128
+#define CONFIG_NETUTILS_NTPCLIENT_MAXSLEWPPM 500
+#define CONFIG_NETUTILS_NTPCLIENT_SIGWAKEUP SIGUSR1
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+typedef int (*main_t)(int argc, char *argv[]);
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+/* The NuttX interfaces used by ntpclient.c that have no host equivalent
+ * are provided by ntpc_hosttest.c.  So are the clock, sleep and blocking
+ * calls that ntpclient.c is built to use instead of the host ones (see
+ * Makefile.host).
+ */
+
+void sched_lock(void);
+void sched_unlock(void);
+int task_create(const char *name, int priority, int stack_size,
+                main_t entry, char * const argv[]);
+
+#endif /* __APPS_NETUTILS_NTPCLIENT_HOST_NUTTX_CONFIG_H */
@@ -33,23 +33,30 @@
  *
  ****************************************************************************/
 
+
 /****************************************************************************
  * Included Files
  ****************************************************************************/
 
 #include <nuttx/config.h>
+#include <nuttx/compiler.h>
 
 #include <sys/socket.h>
 #include <sys/time.h>
 
+#include <stdint.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include <time.h>
 #include <sched.h>
+#include <netdb.h>
 #include <errno.h>
 #include <debug.h>
 
+#include <arpa/inet.h>
 #include <netinet/in.h>
 
 #include <apps/netutils/ntpclient.h>
@@ -59,6 +66,14 @@
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
+/* The clock filter and selection arithmetic is done on 64-bit nanosecond
+ * values.
+ */
+
+#ifndef CONFIG_HAVE_LONG_LONG
+#  error "The NTP client requires 64-bit integer support"
+#endif
+
 /* NTP Time is seconds since 1900. Convert to Unix time which is seconds
  * since 1970
  */
@@ -66,6 +81,35 @@
 #define NTP2UNIX_TRANLSLATION 2208988800u
 #define NTP_VERSION          3
 
+/* NTP modes and stratum limits */
+
+#define NTP_MODE_CLIENT      3
+#define NTP_MODE_SERVER      4
+#define NTP_LI_NOSYNC        3
+#define NTP_MAXSTRATUM       15
+
+/* Clock filter and selection parameters.  See RFC 5905.  All times are in
+ * nanoseconds.
+ */
+
+#define NSEC_PER_SEC         1000000000ll
+#define NSEC_PER_USEC        1000ll
+
+#define NTP_SHIFT            8                    /* Clock filter stages */
+#define NTP_MINDISP          (5 * 1000000ll)      /* Minimum dispersion */
+#define NTP_MAXDISP          (16 * NSEC_PER_SEC)  /* Maximum dispersion */
+#define NTP_MAXDIST          (1500 * 1000000ll)   /* Selection threshold */
+#define NTP_PHI              15                   /* Tolerance (PPM) */
+#define NTP_MINCLOCK         3                    /* Minimum survivors */
+#define NTP_RECVTIMEOUT      5                    /* Receive timeout (sec) */
+
+#define NTP_STEP \
+  ((int64_t)CONFIG_NETUTILS_NTPCLIENT_STEPMSEC * 1000000ll)
+#define NTP_MAXSLEW \
+  ((int64_t)CONFIG_NETUTILS_NTPCLIENT_MAXSLEWPPM * NSEC_PER_USEC)
+
+#define NTP_NPEERS           CONFIG_NETUTILS_NTPCLIENT_MAXSERVERS
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -80,6 +124,41 @@ enum ntpc_daemon_e
   NTP_STOPPED
 };
 
+/* One stage of the clock filter shift register */
+
+struct ntpc_sample_s
+{
+  int64_t offset;             /* Clock offset */
+  int64_t delay;              /* Round trip delay */
+  int64_t disp;               /* Dispersion when the sample was taken */
+  int64_t epoch;              /* Local time when the sample was taken */
+};
+
+/* This type describes the state of one NTP server */
+
+struct ntpc_peer_s
+{
+  struct sockaddr_in addr;    /* Server address, sin_addr zero if unresolved */
+  FAR const char *hostname;   /* Host name to resolve, NULL if numeric */
+  uint8_t xmt[8];             /* Transmit timestamp of the request */
+  bool outstanding;           /* True: Waiting for a response */
+  bool valid;                 /* True: Filter output is valid */
+  bool selected;              /* True: Survived the last selection */
+  uint8_t reach;              /* Reachability shift register */
+  uint8_t stratum;            /* Stratum of the server */
+  uint8_t nsamples;           /* Number of valid filter stages */
+  int64_t t1;                 /* Local time when the request was sent */
+  int64_t rootdelay;          /* Root delay of the server */
+  int64_t rootdisp;           /* Root dispersion of the server */
+  int64_t offset;             /* Filtered offset */
+  int64_t delay;              /* Filtered delay */
+  int64_t disp;               /* Filtered dispersion */
+  int64_t jitter;             /* RMS jitter of the filter samples */
+  int64_t epoch;              /* Epoch of the last filter sample used */
+  int64_t rootdist;           /* Root distance computed during selection */
+  struct ntpc_sample_s filter[NTP_SHIFT];
+};
+
 /* This type describes the state of the NTP client daemon.  Only one
  * instance of the NTP daemon is permitted in this implementation.
  */
@@ -89,6 +168,29 @@ struct ntpc_daemon_s
   volatile uint8_t state; /* See enum ntpc_daemon_e */
   sem_t interlock;        /* Used to synchronize start and stop events */
   pid_t pid;              /* Task ID of the NTP daemon */
+  uint8_t npeers;         /* Number of configured servers */
+  uint8_t nsurvivors;     /* Number of servers used in the last update */
+  bool synchronized;      /* True: The clock has been set */
+  int64_t offset;         /* Combined offset of the last update */
+  int64_t jitter;         /* System jitter of the last update */
+  int64_t slew;           /* Offset that remains to be slewed */
+#ifndef CONFIG_NETUTILS_NTPCLIENT_ADJTIME
+  int64_t resolution;     /* Resolution of the system clock */
+  int64_t holdcredit;     /* Negative slew allowed by the slew rate */
+#endif
+  uint32_t nupdates;      /* Number of clock updates */
+  uint32_t nsteps;        /* Number of clock steps */
+  struct ntpc_peer_s peer[NTP_NPEERS];
+};
+
+/* One endpoint of a correctness interval used by the intersection
+ * algorithm.
+ */
+
+struct ntpc_endpoint_s
+{
+  int64_t val;            /* Value of the endpoint */
+  int type;               /* -1: lower, 0: midpoint, +1: upper */
 };
 
 /****************************************************************************
@@ -102,6 +204,12 @@ struct ntpc_daemon_s
 
 static struct ntpc_daemon_s g_ntpc_daemon;
 
+/* Working copy of the configured server list.  The peer host names point
+ * into this buffer.
+ */
+
+static char g_ntpc_servers[sizeof(CONFIG_NETUTILS_NTPCLIENT_SERVERS)];
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -113,186 +221,1085 @@ static struct ntpc_daemon_s g_ntpc_daemon;
  *
  ****************************************************************************/
 
-static inline uint32_t ntpc_getuint32(FAR uint8_t *ptr)
-{
-  /* Network order is big-endian; host order is irrelevant */
+static inline uint32_t ntpc_getuint32(FAR const uint8_t *ptr)
+{
+  /* Network order is big-endian; host order is irrelevant */
+
+  return (uint32_t)ptr[3] |          /* MS byte appears first in data stream */
+         ((uint32_t)ptr[2] << 8) |
+         ((uint32_t)ptr[1] << 16) |
+         ((uint32_t)ptr[0] << 24);
+}
+
+/****************************************************************************
+ * Name: ntpc_putuint32
+ *
+ * Description:
+ *   Store a 4-byte value in network (big-endian) order.
+ *
+ ****************************************************************************/
+
+static inline void ntpc_putuint32(FAR uint8_t *ptr, uint32_t value)
+{
+  ptr[0] = (uint8_t)(value >> 24);
+  ptr[1] = (uint8_t)(value >> 16);
+  ptr[2] = (uint8_t)(value >> 8);
+  ptr[3] = (uint8_t)value;
+}
+
+/****************************************************************************
+ * Name: ntpc_abs
+ ****************************************************************************/
+
+static inline int64_t ntpc_abs(int64_t value)
+{
+  return value < 0 ? -value : value;
+}
+
+/****************************************************************************
+ * Name: ntpc_sqrt
+ *
+ * Description:
+ *   Integer square root, rounded down.
+ *
+ ****************************************************************************/
+
+static uint64_t ntpc_sqrt(uint64_t value)
+{
+  uint64_t root = 0;
+  uint64_t bit  = (uint64_t)1 << 62;
+
+  while (bit > value)
+    {
+      bit >>= 2;
+    }
+
+  while (bit != 0)
+    {
+      if (value >= root + bit)
+        {
+          value -= root + bit;
+          root   = (root >> 1) + bit;
+        }
+      else
+        {
+          root >>= 1;
+        }
+
+      bit >>= 2;
+    }
+
+  return root;
+}
+
+/****************************************************************************
+ * Name: ntpc_square and ntpc_rms
+ *
+ * Description:
+ *   Square one offset difference and return the RMS value of a sum of
+ *   squares.  The squares are computed in microseconds so that the sums
+ *   cannot overflow.
+ *
+ ****************************************************************************/
+
+static inline uint64_t ntpc_square(int64_t diff)
+{
+  diff = ntpc_abs(diff) / NSEC_PER_USEC;
+  if (diff > 1000000000ll)
+    {
+      diff = 1000000000ll;
+    }
+
+  return (uint64_t)(diff * diff);
+}
+
+static inline int64_t ntpc_rms(uint64_t sum, int n)
+{
+  return (int64_t)ntpc_sqrt(sum / n) * NSEC_PER_USEC;
+}
+
+/****************************************************************************
+ * Name: ntpc_now
+ *
+ * Description:
+ *   Return the current system time in nanoseconds since the Unix epoch.
+ *
+ ****************************************************************************/
+
+static int64_t ntpc_now(void)
+{
+  struct timespec tp;
+
+  (void)clock_gettime(CLOCK_REALTIME, &tp);
+  return (int64_t)tp.tv_sec * NSEC_PER_SEC + tp.tv_nsec;
+}
+
+/****************************************************************************
+ * Name: ntpc_settime
+ *
+ * Description:
+ *   Set the system time, given in nanoseconds since the Unix epoch.
+ *
+ ****************************************************************************/
+
+static void ntpc_settime(int64_t time)
+{
+  struct timespec tp;
+  int ret;
+
+  tp.tv_sec  = (time_t)(time / NSEC_PER_SEC);
+  tp.tv_nsec = (long)(time % NSEC_PER_SEC);
+  ret = clock_settime(CLOCK_REALTIME, &tp);
+  UNUSED(ret);
+
+  svdbg("Set time to %lu seconds: %d\n", (unsigned long)tp.tv_sec, ret);
+}
+
+/****************************************************************************
+ * Name: ntpc_holdclock
+ *
+ * Description:
+ *   Stop the system clock for at least the given number of nanoseconds by
+ *   letting it run and then setting it back to the time at which it was
+ *   stopped.  The daemon runs with the scheduler locked, so no other task
+ *   can see the clock while it is held and the time never goes backward.
+ *   The clock only advances in steps of its resolution, so it may be held
+ *   for longer than requested.
+ *
+ * Returned Value:
+ *   The time for which the clock was held.
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_NETUTILS_NTPCLIENT_ADJTIME
+static int64_t ntpc_holdclock(int64_t hold)
+{
+  int64_t start = ntpc_now();
+  int64_t now;
+
+  do
+    {
+      now = ntpc_now();
+    }
+  while (now - start < hold);
+
+  ntpc_settime(start);
+  return now - start;
+}
+#endif
+
+/****************************************************************************
+ * Name: ntpc_gettimestamp
+ *
+ * Description:
+ *   Convert an NTP timestamp to nanoseconds since the Unix epoch.
+ *
+ ****************************************************************************/
+
+static int64_t ntpc_gettimestamp(FAR const uint8_t *timestamp)
+{
+  int64_t seconds;
+  uint32_t frac;
+
+  /* NTP timestamps are represented as a 64-bit fixed-point number, in
+   * seconds relative to 0000 UT on 1 January 1900.  The integer part is
+   * in the first 32 bits and the fraction part in the last 32 bits, as
+   * shown in the following diagram.
+   *
+   *    0                   1                   2                   3
+   *    0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+   *   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   *   |                         Integer Part                          |
+   *   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   *   |                         Fraction Part                         |
+   *   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   *
+   * Times before the Unix epoch are taken to be in the next NTP era,
+   * which starts in 2036.
+   */
+
+  seconds = (int64_t)ntpc_getuint32(timestamp) - NTP2UNIX_TRANLSLATION;
+  if (seconds < 0)
+    {
+      seconds += (int64_t)1 << 32;
+    }
+
+  /* Conversion of the fractional part to nanoseconds:
+   *
+   *  NSec = (f * 1,000,000,000) / 4,294,967,296
+   *       = (f * (5**9 * 2**9) / (2**32)
+   *       = (f * 5**9) / (2**23)
+   *       = (f * 1,953,125) / 8,388,608
+   */
+
+  frac = ntpc_getuint32(timestamp + 4);
+  return seconds * NSEC_PER_SEC + (int64_t)(((uint64_t)frac * 1953125) >> 23);
+}
+
+/****************************************************************************
+ * Name: ntpc_puttimestamp
+ *
+ * Description:
+ *   Convert nanoseconds since the Unix epoch to an NTP timestamp.
+ *
+ ****************************************************************************/
+
+static void ntpc_puttimestamp(FAR uint8_t *timestamp, int64_t time)
+{
+  uint64_t nsec = (uint64_t)(time % NSEC_PER_SEC);
+
+  ntpc_putuint32(timestamp,
+                 (uint32_t)(time / NSEC_PER_SEC + NTP2UNIX_TRANLSLATION));
+  ntpc_putuint32(timestamp + 4, (uint32_t)((nsec << 23) / 1953125));
+}
+
+/****************************************************************************
+ * Name: ntpc_getshort
+ *
+ * Description:
+ *   Convert an NTP short format value (16.16 fixed point seconds, used for
+ *   the root delay and root dispersion) to nanoseconds.
+ *
+ ****************************************************************************/
+
+static int64_t ntpc_getshort(FAR const uint8_t *value)
+{
+  return (int64_t)(((uint64_t)ntpc_getuint32(value) * NSEC_PER_SEC) >> 16);
+}
+
+/****************************************************************************
+ * Name: ntpc_initpeers
+ *
+ * Description:
+ *   Build the server list from CONFIG_NETUTILS_NTPCLIENT_SERVERIP and
+ *   CONFIG_NETUTILS_NTPCLIENT_SERVERS.
+ *
+ ****************************************************************************/
+
+static void ntpc_initpeers(void)
+{
+  FAR struct ntpc_peer_s *peer;
+  FAR char *saveptr;
+  FAR char *name;
+  FAR char *port;
+  int npeers = 0;
+
+  memset(g_ntpc_daemon.peer, 0, sizeof(g_ntpc_daemon.peer));
+
+  if (CONFIG_NETUTILS_NTPCLIENT_SERVERIP != 0)
+    {
+      peer = &g_ntpc_daemon.peer[npeers++];
+      peer->addr.sin_family      = AF_INET;
+      peer->addr.sin_port        = htons(CONFIG_NETUTILS_NTPCLIENT_PORTNO);
+      peer->addr.sin_addr.s_addr = htonl(CONFIG_NETUTILS_NTPCLIENT_SERVERIP);
+    }
+
+  /* strtok_r() modifies the string so parse a copy of it */
+
+  strcpy(g_ntpc_servers, CONFIG_NETUTILS_NTPCLIENT_SERVERS);
+
+  for (name = strtok_r(g_ntpc_servers, " ,;", &saveptr);
+       name != NULL && npeers < NTP_NPEERS;
+       name = strtok_r(NULL, " ,;", &saveptr))
+    {
+      peer = &g_ntpc_daemon.peer[npeers++];
+      peer->addr.sin_family = AF_INET;
+      peer->addr.sin_port   = htons(CONFIG_NETUTILS_NTPCLIENT_PORTNO);
+
+      port = strchr(name, ':');
+      if (port != NULL)
+        {
+          *port++ = '\0';
+          peer->addr.sin_port = htons((uint16_t)atoi(port));
+        }
+
+      if (inet_pton(AF_INET, name, &peer->addr.sin_addr) != 1)
+        {
+          /* Not a numeric address.  Resolve it when it is polled. */
+
+          peer->hostname = name;
+          peer->addr.sin_addr.s_addr = 0;
+        }
+    }
+
+  if (name != NULL)
+    {
+      ndbg("WARNING: Too many NTP servers, %d used\n", NTP_NPEERS);
+    }
+
+  g_ntpc_daemon.npeers = npeers;
+}
+
+/****************************************************************************
+ * Name: ntpc_resetfilters
+ *
+ * Description:
+ *   Discard all clock filter samples.  This is necessary after the clock
+ *   has been stepped because the samples refer to the old clock.
+ *
+ ****************************************************************************/
+
+static void ntpc_resetfilters(void)
+{
+  int i;
+
+  for (i = 0; i < g_ntpc_daemon.npeers; i++)
+    {
+      g_ntpc_daemon.peer[i].nsamples = 0;
+      g_ntpc_daemon.peer[i].valid    = false;
+    }
+}
+
+/****************************************************************************
+ * Name: ntpc_shiftfilters
+ *
+ * Description:
+ *   Adjust the stored samples by a correction that has been applied to
+ *   the clock, so that they remain consistent with it.
+ *
+ ****************************************************************************/
+
+static void ntpc_shiftfilters(int64_t correction)
+{
+  FAR struct ntpc_peer_s *peer;
+  int i;
+  int j;
+
+  for (i = 0; i < g_ntpc_daemon.npeers; i++)
+    {
+      peer = &g_ntpc_daemon.peer[i];
+      for (j = 0; j < peer->nsamples; j++)
+        {
+          peer->filter[j].offset -= correction;
+        }
+
+      peer->offset -= correction;
+    }
+}
+
+/****************************************************************************
+ * Name: ntpc_clockfilter
+ *
+ * Description:
+ *   Add a new sample to the clock filter of a server and recompute the
+ *   filtered offset, delay, dispersion and jitter.  The sample with the
+ *   minimum round trip delay is the one least affected by queuing delays
+ *   and is used as the offset of the server.  See RFC 5905, section 10.
+ *
+ ****************************************************************************/
+
+static void ntpc_clockfilter(FAR struct ntpc_peer_s *peer, int64_t offset,
+                             int64_t delay, int64_t disp, int64_t epoch)
+{
+  uint8_t order[NTP_SHIFT];
+  FAR struct ntpc_sample_s *best;
+  FAR struct ntpc_sample_s *sample;
+  uint64_t sum;
+  int64_t age;
+  int n;
+  int i;
+  int j;
+
+  /* Shift the new sample into the filter */
+
+  memmove(&peer->filter[1], &peer->filter[0],
+          (NTP_SHIFT - 1) * sizeof(struct ntpc_sample_s));
+
+  peer->filter[0].offset = offset;
+  peer->filter[0].delay  = delay;
+  peer->filter[0].disp   = disp;
+  peer->filter[0].epoch  = epoch;
+
+  if (peer->nsamples < NTP_SHIFT)
+    {
+      peer->nsamples++;
+    }
+
+  /* Sort the samples by increasing delay */
+
+  n = peer->nsamples;
+  for (i = 0; i < n; i++)
+    {
+      for (j = i; j > 0 && peer->filter[order[j - 1]].delay >
+                           peer->filter[i].delay; j--)
+        {
+          order[j] = order[j - 1];
+        }
+
+      order[j] = i;
+    }
+
+  /* The dispersion is the weighted sum of the sample dispersions, each
+   * increased by the frequency tolerance since the sample was taken.  The
+   * jitter is the RMS difference between the sample offsets and the offset
+   * of the minimum delay sample.
+   */
+
+  best = &peer->filter[order[0]];
+  peer->disp = 0;
+  sum = 0;
+
+  for (i = n - 1; i >= 0; i--)
+    {
+      sample = &peer->filter[order[i]];
+      age    = (epoch - sample->epoch) / 1000000 * NTP_PHI;
+
+      peer->disp = (peer->disp + sample->disp + age) >> 1;
+      if (i > 0)
+        {
+          sum += ntpc_square(sample->offset - best->offset);
+        }
+    }
+
+  if (peer->disp > NTP_MAXDISP)
+    {
+      peer->disp = NTP_MAXDISP;
+    }
+
+  peer->jitter = n > 1 ? ntpc_rms(sum, n - 1) : 0;
+  if (peer->jitter < NSEC_PER_USEC)
+    {
+      peer->jitter = NSEC_PER_USEC;
+    }
+
+  /* Do not use a sample that is older than the one last used.  Otherwise
+   * an old sample could correct the clock twice.
+   */
+
+  if (peer->valid && best->epoch <= peer->epoch)
+    {
+      return;
+    }
+
+  peer->offset = best->offset;
+  peer->delay  = best->delay;
+  peer->epoch  = best->epoch;
+  peer->valid  = true;
+}
+
+/****************************************************************************
+ * Name: ntpc_receive
+ *
+ * Description:
+ *   Process one response datagram received at local time t4.
+ *
+ ****************************************************************************/
+
+static void ntpc_receive(FAR const struct ntp_datagram_s *recv,
+                         FAR const struct sockaddr_in *from, int64_t t4)
+{
+  FAR struct ntpc_peer_s *peer = NULL;
+  int64_t t1;
+  int64_t t2;
+  int64_t t3;
+  int64_t delay;
+  int64_t disp;
+  int i;
+
+  /* Find the server that sent the response.  The server copies the
+   * transmit timestamp of the request to the originate timestamp of the
+   * response which rejects duplicate, old and bogus responses.
+   */
+
+  for (i = 0; i < g_ntpc_daemon.npeers; i++)
+    {
+      peer = &g_ntpc_daemon.peer[i];
+      if (peer->outstanding &&
+          peer->addr.sin_addr.s_addr == from->sin_addr.s_addr &&
+          peer->addr.sin_port == from->sin_port &&
+          memcmp(recv->origtimestamp, peer->xmt, 8) == 0)
+        {
+          break;
+        }
+    }
+
+  if (i >= g_ntpc_daemon.npeers)
+    {
+      nvdbg("Ignoring unexpected response\n");
+      return;
+    }
+
+  peer->outstanding = false;
+
+  /* Ignore unsynchronized servers and kiss-o'-death responses */
+
+  if (GETMODE(recv->lvm) != NTP_MODE_SERVER ||
+      GETLI(recv->lvm) == NTP_LI_NOSYNC ||
+      recv->stratum == 0 || recv->stratum > NTP_MAXSTRATUM)
+    {
+      ndbg("Server %d is not synchronized\n", i);
+      return;
+    }
+
+  /* Compute the offset and the round trip delay:
+   *
+   *   t1 = Client transmit time
+   *   t2 = Server receive time
+   *   t3 = Server transmit time
+   *   t4 = Client receive time
+   *
+   *   offset = ((t2 - t1) + (t3 - t4)) / 2
+   *   delay  = (t4 - t1) - (t3 - t2)
+   */
+
+  t1 = peer->t1;
+  t2 = ntpc_gettimestamp(recv->recvtimestamp);
+  t3 = ntpc_gettimestamp(recv->xmittimestamp);
+
+  delay = (t4 - t1) - (t3 - t2);
+  if (delay < 0)
+    {
+      delay = 0;
+    }
+
+  disp = NTP_MINDISP + (t4 - t1) / 1000000 * NTP_PHI;
+
+  peer->reach    |= 1;
+  peer->stratum   = recv->stratum;
+  peer->rootdelay = ntpc_getshort(recv->rootdelay);
+  peer->rootdisp  = ntpc_getshort(recv->rootdispersion);
+
+  ntpc_clockfilter(peer, ((t2 - t1) + (t3 - t4)) / 2, delay, disp, t4);
+
+  nvdbg("Server %d: offset %lld delay %lld usec\n", i,
+        (long long)(peer->filter[0].offset / NSEC_PER_USEC),
+        (long long)(delay / NSEC_PER_USEC));
+}
+
+/****************************************************************************
+ * Name: ntpc_poll
+ *
+ * Description:
+ *   Send a request to every server and collect the responses until all
+ *   servers have answered or the receive times out.
+ *
+ * Returned Value:
+ *   Zero on success; a negated errno value on a fatal error.  -EINTR means
+ *   that the poll was interrupted by a signal.
+ *
+ ****************************************************************************/
+
+static int ntpc_poll(int sd)
+{
+  FAR struct ntpc_peer_s *peer;
+  FAR struct hostent *he;
+  struct ntp_datagram_s xmit;
+  struct ntp_datagram_s recv;
+  struct sockaddr_in from;
+  socklen_t socklen;
+  ssize_t nbytes;
+  int outstanding = 0;
+  int errval;
+  int ret;
+  int i;
+
+  for (i = 0; i < g_ntpc_daemon.npeers; i++)
+    {
+      peer = &g_ntpc_daemon.peer[i];
+      peer->reach     <<= 1;
+      peer->outstanding = false;
+
+      if (peer->hostname != NULL && peer->addr.sin_addr.s_addr == 0)
+        {
+          he = gethostbyname(peer->hostname);
+          if (he == NULL || he->h_addrtype != AF_INET)
+            {
+              ndbg("ERROR: Failed to resolve %s\n", peer->hostname);
+              continue;
+            }
+
+          memcpy(&peer->addr.sin_addr, he->h_addr, sizeof(in_addr_t));
+        }
+
+      /* Format the transmit datagram.  The transmit timestamp identifies
+       * the response.
+       */
+
+      memset(&xmit, 0, sizeof(xmit));
+      xmit.lvm = MKLVM(0, NTP_VERSION, NTP_MODE_CLIENT);
+
+      peer->t1 = ntpc_now();
+      ntpc_puttimestamp(xmit.xmittimestamp, peer->t1);
+      memcpy(peer->xmt, xmit.xmittimestamp, 8);
+
+      svdbg("Sending a NTP packet to server %d\n", i);
+
+      ret = sendto(sd, &xmit, NTP_DATAGRAM_MINSIZE, 0,
+                   (FAR struct sockaddr *)&peer->addr,
+                   sizeof(struct sockaddr_in));
+
+      if (ret < 0)
+        {
+          /* Check if we received a signal.  That is not an error.  Other
+           * errors affect only this server.
+           */
+
+          errval = errno;
+          if (errval == EINTR)
+            {
+              return -EINTR;
+            }
+
+          ndbg("ERROR: sendto() failed: %d\n", errval);
+          continue;
+        }
+
+      peer->outstanding = true;
+      outstanding++;
+    }
+
+  /* Attempt to receive the responses (with a timeout that was set up via
+   * setsockopt())
+   */
+
+  while (outstanding > 0)
+    {
+      socklen = sizeof(struct sockaddr_in);
+      nbytes  = recvfrom(sd, &recv, sizeof(struct ntp_datagram_s), 0,
+                         (FAR struct sockaddr *)&from, &socklen);
+
+      /* Check if the received message was long enough to be a valid NTP
+       * datagram.  Properly received, short datagrams are simply ignored.
+       */
+
+      if (nbytes >= (ssize_t)NTP_DATAGRAM_MINSIZE)
+        {
+          ntpc_receive(&recv, &from, ntpc_now());
+
+          for (outstanding = 0, i = 0; i < g_ntpc_daemon.npeers; i++)
+            {
+              if (g_ntpc_daemon.peer[i].outstanding)
+                {
+                  outstanding++;
+                }
+            }
+        }
+      else if (nbytes < 0)
+        {
+          /* A timeout ends the poll.  Check if we received a signal.  That
+           * is not an error but other error events will terminate the
+           * client.
+           */
+
+          errval = errno;
+          if (errval == EAGAIN || errval == ETIMEDOUT)
+            {
+              break;
+            }
+          else if (errval == EINTR)
+            {
+              return -EINTR;
+            }
+
+          ndbg("ERROR: recvfrom() failed: %d\n", errval);
+          return -errval;
+        }
+    }
 
-  return (uint32_t)ptr[3] |          /* MS byte appears first in data stream */
-         ((uint32_t)ptr[2] << 8) |
-         ((uint32_t)ptr[1] << 16) |
-         ((uint32_t)ptr[0] << 24);
+  return OK;
 }
 
 /****************************************************************************
- * Name: ntpc_settime
+ * Name: ntpc_select
  *
  * Description:
- *   Given the NTP time in seconds, set the system time
+ *   Select the servers that agree on the time and combine their offsets.
+ *   The intersection algorithm finds the largest group of servers whose
+ *   correctness intervals overlap; the others are falsetickers.  The
+ *   cluster algorithm then discards the survivors that contribute the most
+ *   jitter.  See RFC 5905, section 11.2.
+ *
+ * Returned Value:
+ *   The number of survivors; zero if there is no majority.
  *
  ****************************************************************************/
 
-static void ntpc_settime(FAR uint8_t *timestamp)
+static int ntpc_select(FAR int64_t *offset, FAR int64_t *jitter)
 {
-  struct timespec tp;
-  time_t seconds;
-  uint32_t frac;
-  uint32_t nsec;
-#ifdef CONFIG_HAVE_LONG_LONG
-  uint64_t tmp;
-#else
-  uint32_t a16;
-  uint32_t b0;
-  uint32_t t32;
-  uint32_t t16;
-  uint32_t t0;
-#endif
+  struct ntpc_endpoint_s endpoint[3 * NTP_NPEERS];
+  struct ntpc_endpoint_s tmp;
+  FAR struct ntpc_peer_s *survivor[NTP_NPEERS];
+  FAR struct ntpc_peer_s *peer;
+  uint64_t sum;
+  int64_t now = ntpc_now();
+  int64_t low = 0;
+  int64_t high = 0;
+  int64_t maxsel;
+  int64_t minjit;
+  int64_t weight;
+  int64_t wsum;
+  int64_t osum;
+  int nsurvivors;
+  int nlist = 0;
+  int allow;
+  int found;
+  int chime;
+  int maxndx;
+  int n = 0;
+  int i;
+  int j;
+
+  /* Build the list of correctness intervals of the usable servers */
+
+  for (i = 0; i < g_ntpc_daemon.npeers; i++)
+    {
+      peer = &g_ntpc_daemon.peer[i];
+      peer->selected = false;
 
-  /* NTP timestamps are represented as a 64-bit fixed-point number, in
-   * seconds relative to 0000 UT on 1 January 1900.  The integer part is
-   * in the first 32 bits and the fraction part in the last 32 bits, as
-   * shown in the following diagram.
-   *
-   *    0                   1                   2                   3
-   *    0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
-   *   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-   *   |                         Integer Part                          |
-   *   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-   *   |                         Fraction Part                         |
-   *   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-   */
+      if (!peer->valid || peer->reach == 0)
+        {
+          continue;
+        }
+
+      peer->rootdist = (peer->delay + peer->rootdelay) / 2 + peer->disp +
+                       peer->rootdisp + peer->jitter +
+                       (now - peer->epoch) / 1000000 * NTP_PHI;
+
+      if (peer->rootdist > NTP_MAXDIST)
+        {
+          continue;
+        }
 
-  seconds = ntpc_getuint32(timestamp);
+      endpoint[nlist].val    = peer->offset - peer->rootdist;
+      endpoint[nlist++].type = -1;
+      endpoint[nlist].val    = peer->offset;
+      endpoint[nlist++].type = 0;
+      endpoint[nlist].val    = peer->offset + peer->rootdist;
+      endpoint[nlist++].type = 1;
 
-  /* Translate seconds to account for the difference in the origin time */
+      survivor[n++] = peer;
+    }
 
-  if (seconds > NTP2UNIX_TRANLSLATION)
+  if (n == 0)
     {
-      seconds -= NTP2UNIX_TRANLSLATION;
+      return 0;
     }
 
-  /* Conversion of the fractional part to nanoseconds:
-   *
-   *  NSec = (f * 1,000,000,000) / 4,294,967,296
-   *       = (f * (5**9 * 2**9) / (2**32)
-   *       = (f * 5**9) / (2**23)
-   *       = (f * 1,953,125) / 8,388,608
+  for (i = 1; i < nlist; i++)
+    {
+      tmp = endpoint[i];
+      for (j = i; j > 0 && endpoint[j - 1].val > tmp.val; j--)
+        {
+          endpoint[j] = endpoint[j - 1];
+        }
+
+      endpoint[j] = tmp;
+    }
+
+  /* Find the smallest number of falsetickers for which the intervals of
+   * all the other servers intersect.
    */
 
-  frac = ntpc_getuint32(timestamp + 4);
-#ifdef CONFIG_HAVE_LONG_LONG
-  /* if we have 64-bit long long values, then the computation is easy */
+  for (allow = 0; 2 * allow < n; allow++)
+    {
+      found = 0;
+      chime = 0;
+      for (i = 0; i < nlist; i++)
+        {
+          chime -= endpoint[i].type;
+          if (chime >= n - allow)
+            {
+              low = endpoint[i].val;
+              break;
+            }
 
-  tmp  = ((uint64_t)frac * 1953125) >> 23;
-  nsec = (uint32_t)tmp;
+          if (endpoint[i].type == 0)
+            {
+              found++;
+            }
+        }
 
-#else
-  /* If we don't have 64 bit integer types, then the calculation is a little
-   * more complex:
-   *
-   * Let f         = a    << 16 + b
-   *     1,953,125 = 0x1d << 16 + 0xcd65
-   * NSec << 23 =  ((a << 16) + b) * ((0x1d << 16) + 0xcd65)
-   *            = (a << 16) * 0x1d << 16) +
-   *              (a << 16) * 0xcd65 +
-   *              b         * 0x1d << 16) +
-   *              b         * 0xcd65;
-   */
+      chime = 0;
+      for (i = nlist - 1; i >= 0; i--)
+        {
+          chime += endpoint[i].type;
+          if (chime >= n - allow)
+            {
+              high = endpoint[i].val;
+              break;
+            }
 
-  /* Break the fractional part up into two values */
+          if (endpoint[i].type == 0)
+            {
+              found++;
+            }
+        }
 
-  a16  = frac >> 16;
-  b0   = frac & 0xffff;
+      if (found <= allow && low < high)
+        {
+          break;
+        }
+    }
 
-  /* Get the b32 and b0 terms
-   *
-   * t32 = (a << 16) * 0x1d << 16)
-   * t0  = b * 0xcd65
-   */
+  if (2 * allow >= n)
+    {
+      ndbg("No majority among %d servers\n", n);
+      return 0;
+    }
 
-  t32  = 0x001d * a16;
-  t0   = 0xcd65 * b0;
+  /* The truechimers are the servers with an offset in [low, high] */
 
-  /* Get the first b16 term
-   *
-   * (a << 16) * 0xcd65
+  for (nsurvivors = 0, i = 0; i < n; i++)
+    {
+      if (survivor[i]->offset >= low && survivor[i]->offset <= high)
+        {
+          survivor[nsurvivors++] = survivor[i];
+        }
+    }
+
+  /* Discard the survivor with the largest selection jitter until that is
+   * no larger than the smallest server jitter, or until only
+   * NTP_MINCLOCK survivors remain.
    */
 
-  t16  = 0xcd65 * a16;
+  while (nsurvivors > NTP_MINCLOCK)
+    {
+      maxsel = 0;
+      maxndx = 0;
+      minjit = INT64_MAX;
+
+      for (i = 0; i < nsurvivors; i++)
+        {
+          for (sum = 0, j = 0; j < nsurvivors; j++)
+            {
+              sum += ntpc_square(survivor[j]->offset - survivor[i]->offset);
+            }
+
+          weight = ntpc_rms(sum, nsurvivors - 1);
+          if (weight > maxsel)
+            {
+              maxsel = weight;
+              maxndx = i;
+            }
+
+          if (survivor[i]->jitter < minjit)
+            {
+              minjit = survivor[i]->jitter;
+            }
+        }
 
-  /* Add the upper 16-bits to the b32 accumulator */
+      if (maxsel <= minjit)
+        {
+          break;
+        }
 
-  t32 += (t16 >> 16);
+      survivor[maxndx] = survivor[--nsurvivors];
+    }
 
-  /* Add the lower 16-bits to the b0 accumulator, handling carry to the b32
-   * accumulator
+  /* Combine the survivor offsets weighted by the inverse of the root
+   * distance.  The sums are taken relative to the first survivor so that
+   * they cannot overflow even when the offset is many years.
    */
 
-  t16  <<= 16;
-  if (t0 > (0xffffffff - t16))
+  wsum = 0;
+  osum = 0;
+
+  for (i = 0; i < nsurvivors; i++)
     {
-      t32++;
+      weight = ((int64_t)1 << 20) /
+               (survivor[i]->rootdist / NSEC_PER_USEC + 1);
+      if (weight < 1)
+        {
+          weight = 1;
+        }
+
+      wsum += weight;
+      osum += weight * (survivor[i]->offset - survivor[0]->offset);
+      survivor[i]->selected = true;
     }
 
-  t0 += t16;
+  *offset = survivor[0]->offset + osum / wsum;
 
-  /* Get the second b16 term
-   *
-   * b * (0x1d << 16)
+  /* The system jitter is the RMS difference between the survivor offsets
+   * and the combined offset, but not less than the best server jitter.
    */
 
-  t16  = 0x001d * b0;
+  minjit = INT64_MAX;
+  for (sum = 0, i = 0; i < nsurvivors; i++)
+    {
+      sum += ntpc_square(survivor[i]->offset - *offset);
+      if (survivor[i]->jitter < minjit)
+        {
+          minjit = survivor[i]->jitter;
+        }
+    }
+
+  *jitter = ntpc_rms(sum, nsurvivors);
+  if (*jitter < minjit)
+    {
+      *jitter = minjit;
+    }
+
+  return nsurvivors;
+}
 
-  /* Add the upper 16-bits to the b32 accumulator */
+/****************************************************************************
+ * Name: ntpc_update
+ *
+ * Description:
+ *   Correct the system clock by the selected offset.  Large offsets (and
+ *   the first offset) step the clock; small offsets are slewed so that the
+ *   time never jumps, and in particular never jumps backward, because of
+ *   network jitter.
+ *
+ ****************************************************************************/
 
-  t32 += (t16 >> 16);
+static void ntpc_update(int64_t offset)
+{
+#ifdef CONFIG_NETUTILS_NTPCLIENT_ADJTIME
+  struct timeval tv;
+  struct timeval old;
+#endif
 
-  /* Add the lower 16-bits to the b0 accumulator, handling carry to the b32
-   * accumulator
-   */
+  g_ntpc_daemon.nupdates++;
 
-  t16  <<= 16;
-  if (t0 > (0xffffffff - t16))
+  if (!g_ntpc_daemon.synchronized || ntpc_abs(offset) >= NTP_STEP)
     {
-      t32++;
+      svdbg("Stepping the clock by %lld usec\n",
+            (long long)(offset / NSEC_PER_USEC));
+
+#ifdef CONFIG_NETUTILS_NTPCLIENT_ADJTIME
+      /* Cancel any slew in progress */
+
+      tv.tv_sec  = 0;
+      tv.tv_usec = 0;
+      (void)adjtime(&tv, NULL);
+#endif
+
+      ntpc_settime(ntpc_now() + offset);
+      ntpc_resetfilters();
+
+      g_ntpc_daemon.slew = 0;
+      g_ntpc_daemon.synchronized = true;
+      g_ntpc_daemon.nsteps++;
+      return;
     }
 
-  t0 += t16;
+  svdbg("Slewing the clock by %lld usec\n",
+        (long long)(offset / NSEC_PER_USEC));
 
-  /* t32 and t0 represent the 64 bit product.  Now shift right by 23 bits to
-   * accomplish the divide by by 2**23.
+  /* Like adjtime(), a new slew replaces any part of the previous one that
+   * has not yet been applied.  The filters are shifted as the slew is
+   * applied.
    */
 
-  nsec = (t32 << (32 - 23)) + (t0 >> 23);
+#ifdef CONFIG_NETUTILS_NTPCLIENT_ADJTIME
+  tv.tv_sec  = (time_t)(offset / NSEC_PER_SEC);
+  tv.tv_usec = (long)((offset % NSEC_PER_SEC) / NSEC_PER_USEC);
+  if (adjtime(&tv, &old) == OK)
+    {
+      ntpc_shiftfilters(g_ntpc_daemon.slew -
+                        ((int64_t)old.tv_sec * NSEC_PER_SEC +
+                         (int64_t)old.tv_usec * NSEC_PER_USEC));
+    }
 #endif
 
-  /* Set the system time */
+  g_ntpc_daemon.slew = offset;
+}
+
+/****************************************************************************
+ * Name: ntpc_wait
+ *
+ * Description:
+ *   Wait for the next poll and, once per second, shift the clock filters by
+ *   the part of the slew that has been applied since.
+ *
+ *   Without adjtime(), the daemon applies the slew itself at no more than
+ *   CONFIG_NETUTILS_NTPCLIENT_MAXSLEWPPM microseconds per second.  A
+ *   positive slew advances the clock.  A negative slew must not move the
+ *   clock backward, so the clock is held instead, in steps of at least its
+ *   resolution once the slew rate allows that much.
+ *
+ ****************************************************************************/
 
-  tp.tv_sec  = seconds;
-  tp.tv_nsec = nsec;
-  clock_settime(CLOCK_REALTIME, &tp);
+static void ntpc_wait(int seconds)
+{
+#ifdef CONFIG_NETUTILS_NTPCLIENT_ADJTIME
+  struct timeval tv;
+  int64_t remaining;
+#else
+  int64_t maxcredit;
+  int64_t step;
+#endif
+  int i;
 
-  svdbg("Set time to %lu seconds: %d\n", (unsigned long)tp.tv_sec, ret);
+  for (i = 0; i < seconds && g_ntpc_daemon.state == NTP_RUNNING; i++)
+    {
+      (void)sleep(1);
+
+#ifdef CONFIG_NETUTILS_NTPCLIENT_ADJTIME
+      if (g_ntpc_daemon.slew != 0 && adjtime(NULL, &tv) == OK)
+        {
+          remaining = (int64_t)tv.tv_sec * NSEC_PER_SEC +
+                      (int64_t)tv.tv_usec * NSEC_PER_USEC;
+
+          ntpc_shiftfilters(g_ntpc_daemon.slew - remaining);
+          g_ntpc_daemon.slew = remaining;
+        }
+#else
+      maxcredit = g_ntpc_daemon.resolution > NTP_MAXSLEW ?
+                  g_ntpc_daemon.resolution : NTP_MAXSLEW;
+
+      g_ntpc_daemon.holdcredit += NTP_MAXSLEW;
+      if (g_ntpc_daemon.holdcredit > maxcredit)
+        {
+          g_ntpc_daemon.holdcredit = maxcredit;
+        }
+
+      step = g_ntpc_daemon.slew;
+      if (step > 0)
+        {
+          if (step > NTP_MAXSLEW)
+            {
+              step = NTP_MAXSLEW;
+            }
+
+          ntpc_settime(ntpc_now() + step);
+        }
+      else if (step < 0 &&
+               -2 * step >= g_ntpc_daemon.resolution &&
+               g_ntpc_daemon.holdcredit >= g_ntpc_daemon.resolution)
+        {
+          if (step < -g_ntpc_daemon.holdcredit)
+            {
+              step = -g_ntpc_daemon.holdcredit;
+            }
+
+          step = -ntpc_holdclock(-step);
+          g_ntpc_daemon.holdcredit += step;
+        }
+      else
+        {
+          continue;
+        }
+
+      ntpc_shiftfilters(step);
+      g_ntpc_daemon.slew -= step;
+#endif
+    }
 }
 
 /****************************************************************************
  * Name: ntpc_daemon
  *
  * Description:
- *   This the the NTP client daemon.  This is a *very* minimal
- *   implementation! An NTP request is and the system clock is set when the
- *   response is received
+ *   This the the NTP client daemon.  Requests are sent to all servers in
+ *   parallel.  The responses pass through a clock filter for each server,
+ *   the servers that agree are selected and combined, and the system clock
+ *   is stepped or slewed by the combined offset.
  *
  ****************************************************************************/
 
 static int ntpc_daemon(int argc, char **argv)
 {
-  struct sockaddr_in server;
-  struct ntp_datagram_s xmit;
-  struct ntp_datagram_s recv;
   struct timeval tv;
-  socklen_t socklen;
-  ssize_t nbytes;
+#ifndef CONFIG_NETUTILS_NTPCLIENT_ADJTIME
+  struct timespec res;
+#endif
+  int64_t offset;
+  int64_t jitter;
   int exitcode = EXIT_SUCCESS;
+  int nsurvivors;
   int ret;
   int sd;
 
@@ -301,6 +1308,21 @@ static int ntpc_daemon(int argc, char **argv)
   g_ntpc_daemon.state = NTP_RUNNING;
   sem_post(&g_ntpc_daemon.interlock);
 
+#ifndef CONFIG_NETUTILS_NTPCLIENT_ADJTIME
+  /* A negative slew is applied in steps of the clock resolution */
+
+  if (clock_getres(CLOCK_REALTIME, &res) == OK)
+    {
+      g_ntpc_daemon.resolution = (int64_t)res.tv_sec * NSEC_PER_SEC +
+                                 res.tv_nsec;
+    }
+
+  if (g_ntpc_daemon.resolution < 1)
+    {
+      g_ntpc_daemon.resolution = 1;
+    }
+#endif
+
   /* Create a datagram socket  */
 
   sd = socket(AF_INET, SOCK_DGRAM, 0);
@@ -315,7 +1337,7 @@ static int ntpc_daemon(int argc, char **argv)
 
   /* Setup a receive timeout on the socket */
 
-  tv.tv_sec  = 5;
+  tv.tv_sec  = NTP_RECVTIMEOUT;
   tv.tv_usec = 0;
 
   ret = setsockopt(sd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(struct timeval));
@@ -323,23 +1345,13 @@ static int ntpc_daemon(int argc, char **argv)
     {
       ndbg("ERROR: setsockopt failed: %d\n", errno);
 
+      close(sd);
       g_ntpc_daemon.state = NTP_STOPPED;
       sem_post(&g_ntpc_daemon.interlock);
       return EXIT_FAILURE;
     }
 
-  /* Setup or sockaddr_in struct with information about the server we are
-   * going to ask the the time from.
-   */
-
-  memset(&server, 0, sizeof(struct sockaddr_in));
-  server.sin_family      = AF_INET;
-  server.sin_port        = htons(CONFIG_NETUTILS_NTPCLIENT_PORTNO);
-  server.sin_addr.s_addr = htonl(CONFIG_NETUTILS_NTPCLIENT_SERVERIP);
-
-  /* Here we do the communication with the NTP server.  This is a very simple
-   * client architecture.  A request is sent and then a NTP packet is received
-   * and used to set the current time.
+  /* Here we do the communication with the NTP servers.
    *
    * NOTE that the scheduler is locked whenever this loop runs.  That
    * assures both:  (1) that there are no asynchronous stop requests and
@@ -348,109 +1360,53 @@ static int ntpc_daemon(int argc, char **argv)
    * most of the time either: (1) sending a datagram, (2) receiving a datagram,
    * or (3) waiting for the next poll cycle.
    *
-   * TODO: The first datagram that is sent is usually lost.  That is because
-   * the MAC address of the NTP server is not in the ARP table.  This is
-   * particularly bad here because the request will not be sent again until
-   * the long delay expires leaving the system with bad time for a long time
-   * initially.  Solutions:
-   *
-   * 1. Fix send logic so that it assures that the ARP request has been
-   *    sent and the entry is in the ARP table before sending the packet
-   *    (best).
-   * 2. Add some ad hoc logic here so that there is no delay until at least
-   *    one good time is received.
+   * The first datagram that is sent is usually lost because the MAC address
+   * of the NTP server is not yet in the ARP table.  Until the clock has been
+   * set, the servers are therefore polled again as soon as the receive
+   * times out rather than after the long poll delay.
    */
 
   sched_lock();
   while (g_ntpc_daemon.state != NTP_STOP_REQUESTED)
     {
-      /* Format the transmit datagram */
-
-      memset(&xmit, 0, sizeof(xmit));
-      xmit.lvm = MKLVM(0, 3, NTP_VERSION);
-
-      svdbg("Sending a NTP packet\n");
-
-      ret = sendto(sd, &xmit, sizeof(struct ntp_datagram_s),
-                   0, (FAR struct sockaddr *)&server,
-                   sizeof(struct sockaddr_in));
-
-      if (ret < 0)
+      ret = ntpc_poll(sd);
+      if (ret < 0 && ret != -EINTR)
         {
-          /* Check if we received a signal.  That is not an error but
-           * other error events will terminate the client.
-           */
-
-          int errval = errno;
-          if (errval != EINTR)
-            {
-              ndbg("ERROR: sendto() failed: %d\n", errval);
-              exitcode = EXIT_FAILURE;
-              break;
-            }
-
-          /* Go back to the top of the loop if we were interrupted
-           * by a signal.  The signal might mean that we were
-           * requested to stop(?)
-           */
-
-          continue;
+          exitcode = EXIT_FAILURE;
+          break;
         }
 
-      /* Attempt to receive a packet (with a timeout that was set up via
-       * setsockopt() above)
-       */
-
-      socklen = sizeof(struct sockaddr_in);
-      nbytes = recvfrom(sd, (void *)&recv, sizeof(struct ntp_datagram_s),
-                        0, (FAR struct sockaddr *)&server, &socklen);
-
-      /* Check if the received message was long enough to be a valid NTP
-       * datagram.
-       */
+      nsurvivors = ntpc_select(&offset, &jitter);
+      g_ntpc_daemon.nsurvivors = nsurvivors;
 
-      if (nbytes >= (ssize_t)NTP_DATAGRAM_MINSIZE)
+      if (nsurvivors > 0)
         {
-          svdbg("Setting time\n");
-          ntpc_settime(recv.recvtimestamp);
+          g_ntpc_daemon.offset = offset;
+          g_ntpc_daemon.jitter = jitter;
+          ntpc_update(offset);
         }
 
-      /* Check for errors.  Note that properly received, short datagrams
-       * are simply ignored.
-       */
-
-      else if (nbytes < 0)
+      if (g_ntpc_daemon.state == NTP_RUNNING)
         {
-          /* Check if we received a signal.  That is not an error but
-           * other error events will terminate the client.
-           */
+          if (g_ntpc_daemon.synchronized)
+            {
+              svdbg("Waiting for %d seconds\n",
+                    CONFIG_NETUTILS_NTPCLIENT_POLLDELAYSEC);
 
-          int errval = errno;
-          if (errval != EINTR)
+              ntpc_wait(CONFIG_NETUTILS_NTPCLIENT_POLLDELAYSEC);
+            }
+          else if (ret == -EINTR || nsurvivors == 0)
             {
-              ndbg("ERROR: recvfrom() failed: %d\n", errval);
-              exitcode = EXIT_FAILURE;
-              break;
+              ntpc_wait(1);
             }
         }
-
-      /* A full implementation of an NTP client would require much more.  I
-       * think we can skip most of that here.
-       */
-
-      if (g_ntpc_daemon.state == NTP_RUNNING)
-        {
-          svdbg("Waiting for %d seconds\n",
-                CONFIG_NETUTILS_NTPCLIENT_POLLDELAYSEC);
-
-          (void)sleep(CONFIG_NETUTILS_NTPCLIENT_POLLDELAYSEC);
-        }
     }
 
   /* The NTP client is terminating */
 
   sched_unlock();
 
+  close(sd);
   g_ntpc_daemon.state = NTP_STOPPED;
   sem_post(&g_ntpc_daemon.interlock);
   return exitcode;
@@ -488,6 +1444,22 @@ int ntpc_start(void)
           sem_init(&g_ntpc_daemon.interlock, 0, 0);
         }
 
+      /* Set up the server list and clear the statistics */
+
+      ntpc_initpeers();
+
+      g_ntpc_daemon.synchronized = false;
+      g_ntpc_daemon.nsurvivors   = 0;
+      g_ntpc_daemon.offset       = 0;
+      g_ntpc_daemon.jitter       = 0;
+      g_ntpc_daemon.nupdates     = 0;
+      g_ntpc_daemon.nsteps       = 0;
+      g_ntpc_daemon.slew         = 0;
+#ifndef CONFIG_NETUTILS_NTPCLIENT_ADJTIME
+      g_ntpc_daemon.resolution   = 0;
+      g_ntpc_daemon.holdcredit   = 0;
+#endif
+
       /* Start the NTP daemon */
 
       g_ntpc_daemon.state = NTP_STARTED;
@@ -576,3 +1548,62 @@ int ntpc_stop(void)
   return OK;
 }
 #endif
+
+/****************************************************************************
+ * Name: ntpc_status
+ *
+ * Description:
+ *   Return a snapshot of the NTP client clock offset, delay and jitter
+ *   statistics.
+ *
+ * Input Parameters:
+ *   status - The location to return the statistics.
+ *
+ * Returned Value:
+ *   Zero on success; -ESRCH if the NTP daemon has never been started.
+ *
+ ****************************************************************************/
+
+int ntpc_status(FAR struct ntpc_status_s *status)
+{
+  FAR struct ntpc_peerstatus_s *stat;
+  FAR struct ntpc_peer_s *peer;
+  int i;
+
+  DEBUGASSERT(status != NULL);
+
+  /* The daemon updates the statistics with the scheduler locked */
+
+  sched_lock();
+  if (g_ntpc_daemon.state == NTP_NOT_RUNNING)
+    {
+      sched_unlock();
+      return -ESRCH;
+    }
+
+  memset(status, 0, sizeof(struct ntpc_status_s));
+  status->synchronized = g_ntpc_daemon.synchronized;
+  status->npeers       = g_ntpc_daemon.npeers;
+  status->nsurvivors   = g_ntpc_daemon.nsurvivors;
+  status->offset       = g_ntpc_daemon.offset;
+  status->jitter       = g_ntpc_daemon.jitter;
+  status->nupdates     = g_ntpc_daemon.nupdates;
+  status->nsteps       = g_ntpc_daemon.nsteps;
+
+  for (i = 0; i < g_ntpc_daemon.npeers; i++)
+    {
+      peer = &g_ntpc_daemon.peer[i];
+      stat = &status->peer[i];
+
+      stat->addr     = peer->addr.sin_addr.s_addr;
+      stat->reach    = peer->reach;
+      stat->stratum  = peer->stratum;
+      stat->selected = peer->selected;
+      stat->offset   = peer->offset;
+      stat->delay    = peer->delay;
+      stat->jitter   = peer->jitter;
+    }
+
+  sched_unlock();
+  return OK;
+}
@@ -55,7 +55,9 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
+#include <strings.h>
 #include <semaphore.h>
+#include <errno.h>
 
 #include <arpa/inet.h>
 
@@ -66,7 +68,14 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
-#define SMTP_INPUT_BUFFER_SIZE 512
+#define SMTP_INPUT_BUFFER_SIZE  512
+#define SMTP_OUTPUT_BUFFER_SIZE 512
+#define SMTP_LINE_SIZE          80
+#define SMTP_CHUNK_SIZE         128
+
+/* RSET, MAIL, two RCPTs and DATA */
+
+#define SMTP_MAX_PENDING        5
 
 #define ISO_nl 0x0a
 #define ISO_cr 0x0d
@@ -82,39 +91,49 @@
  * Private Types
  ****************************************************************************/
 
-/* This structure represents the state of a single SMTP transaction */
+/* This structure represents the state of an SMTP session */
 
 struct smtp_state
 {
-  uint8_t      state;
-  bool         connected;
+  bool         connected;     /* A session is open on sockfd */
+  bool         pipelining;    /* The server supports RFC 2920 PIPELINING */
+  bool         needrset;      /* A transaction was started in this session */
+  uint8_t      npending;      /* Pipelined commands awaiting a reply */
+  uint8_t      pending[SMTP_MAX_PENDING]; /* Expected reply classes */
   sem_t        sem;
+  int          sockfd;
   in_addr_t    smtpserver;
   const char  *localhostname;
-  const char  *to;
-  const char  *cc;
-  const char  *from;
-  const char  *subject;
-  const char  *msg;
-  int          msglen;
-  int          sentlen;
-  int          textlen;
-  int          sendptr;
+  uint16_t     rxlen;         /* Number of bytes in buffer */
+  uint16_t     rxndx;         /* Index of the next unread byte in buffer */
+  uint16_t     txlen;         /* Number of bytes in txbuffer */
   char         buffer[SMTP_INPUT_BUFFER_SIZE];
+  char         txbuffer[SMTP_OUTPUT_BUFFER_SIZE];
+};
+
+/* Reader state for a message held in memory */
+
+struct smtp_memreader_s
+{
+  FAR const char *msg;
+  int             remaining;
 };
 
 /****************************************************************************
  * Private Data
  ****************************************************************************/
 
-static const char g_smtp220[]            = "220";
-static const char g_smtpcrnlperiodcrnl[] = "\r\n.\r\n";
-static const char g_smtpdata[]           = "DATA\r\n";
+static const char g_smtpcc[]             = "Cc: ";
+static const char g_smtpcrnl[]           = "\r\n";
+static const char g_smtpdata[]           = "DATA";
+static const char g_smtpehlo[]           = "EHLO ";
 static const char g_smtpfrom[]           = "From: ";
 static const char g_smtphelo[]           = "HELO ";
-static const char g_smtpmailfrom[]       = "MAIL FROM: ";
-static const char g_smtpquit[]           = "QUIT\r\n";
-static const char g_smtprcptto[]         = "RCPT TO: ";
+static const char g_smtpmailfrom[]       = "MAIL FROM:";
+static const char g_smtppipelining[]     = "PIPELINING";
+static const char g_smtpquit[]           = "QUIT";
+static const char g_smtprcptto[]         = "RCPT TO:";
+static const char g_smtprset[]           = "RSET";
 static const char g_smtpsubject[]        = "Subject: ";
 static const char g_smtpto[]             = "To: ";
 
@@ -122,152 +141,499 @@ static const char g_smtpto[]             = "To: ";
  * Private Functions
  ****************************************************************************/
 
-static inline int smtp_send_message(int sockfd, struct smtp_state *psmtp)
+/****************************************************************************
+ * Name: smtp_abort
+ *
+ * Description:
+ *   Drop the connection after an I/O or protocol error.  A new session is
+ *   opened by the next smtp_connect() or smtp_send().
+ *
+ ****************************************************************************/
+
+static void smtp_abort(FAR struct smtp_state *psmtp)
 {
-  if (recv(sockfd, psmtp->buffer, SMTP_INPUT_BUFFER_SIZE, 0) < 0)
+  if (psmtp->connected)
     {
-      return ERROR;
+      close(psmtp->sockfd);
+      psmtp->connected = false;
     }
 
-  if (strncmp(psmtp->buffer, g_smtp220, strlen(g_smtp220)) != 0)
+  psmtp->npending = 0;
+  psmtp->txlen    = 0;
+}
+
+/****************************************************************************
+ * Name: smtp_flush
+ *
+ * Description:
+ *   Send everything in the output buffer.
+ *
+ ****************************************************************************/
+
+static int smtp_flush(FAR struct smtp_state *psmtp)
+{
+  FAR const char *ptr = psmtp->txbuffer;
+  size_t len = psmtp->txlen;
+  ssize_t nsent;
+
+  psmtp->txlen = 0;
+  while (len > 0)
     {
-      return ERROR;
+      nsent = send(psmtp->sockfd, ptr, len, 0);
+      if (nsent < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+
+          smtp_abort(psmtp);
+          return ERROR;
+        }
+
+      ptr += nsent;
+      len -= nsent;
     }
 
-  snprintf(psmtp->buffer, SMTP_INPUT_BUFFER_SIZE, "%s%s\r\n", g_smtphelo, psmtp->localhostname);
-  if (send(sockfd, psmtp->buffer, strlen(psmtp->buffer), 0) < 0)
+  return OK;
+}
+
+/****************************************************************************
+ * Name: smtp_write
+ *
+ * Description:
+ *   Append data to the output buffer, sending it whenever the buffer
+ *   fills.  Commands and message text are coalesced into as few segments
+ *   as possible.
+ *
+ ****************************************************************************/
+
+static int smtp_write(FAR struct smtp_state *psmtp, FAR const char *data,
+                      size_t len)
+{
+  size_t n;
+
+  while (len > 0)
     {
-      return ERROR;
+      if (psmtp->txlen >= SMTP_OUTPUT_BUFFER_SIZE &&
+          smtp_flush(psmtp) < 0)
+        {
+          return ERROR;
+        }
+
+      n = SMTP_OUTPUT_BUFFER_SIZE - psmtp->txlen;
+      if (n > len)
+        {
+          n = len;
+        }
+
+      memcpy(&psmtp->txbuffer[psmtp->txlen], data, n);
+      psmtp->txlen += n;
+      data         += n;
+      len          -= n;
     }
 
-  if (recv(sockfd, psmtp->buffer, SMTP_INPUT_BUFFER_SIZE, 0) < 0)
+  return OK;
+}
+
+static int smtp_puts(FAR struct smtp_state *psmtp, FAR const char *str)
+{
+  return smtp_write(psmtp, str, strlen(str));
+}
+
+/****************************************************************************
+ * Name: smtp_putline
+ *
+ * Description:
+ *   Append a command or header line made of 'prefix' and an optional
+ *   'arg'.  If 'path' is true, 'arg' is an address that is enclosed in
+ *   angle brackets unless it already is.
+ *
+ ****************************************************************************/
+
+static int smtp_putline(FAR struct smtp_state *psmtp,
+                        FAR const char *prefix, FAR const char *arg,
+                        bool path)
+{
+  int ret;
+
+  ret = smtp_puts(psmtp, prefix);
+  if (ret == OK && arg != NULL)
     {
-      return ERROR;
+      path = path && arg[0] != '<';
+      if (path)
+        {
+          ret = smtp_write(psmtp, "<", 1);
+        }
+
+      if (ret == OK)
+        {
+          ret = smtp_puts(psmtp, arg);
+        }
+
+      if (ret == OK && path)
+        {
+          ret = smtp_write(psmtp, ">", 1);
+        }
     }
 
-  if (psmtp->buffer[0] != ISO_2)
+  if (ret == OK)
     {
-      return ERROR;
+      ret = smtp_write(psmtp, g_smtpcrnl, 2);
     }
 
-  snprintf(psmtp->buffer, SMTP_INPUT_BUFFER_SIZE, "%s%s\r\n", g_smtpmailfrom, psmtp->from);
-  if (send(sockfd, psmtp->buffer, strlen(psmtp->buffer), 0) < 0)
+  return ret;
+}
+
+/****************************************************************************
+ * Name: smtp_getline
+ *
+ * Description:
+ *   Read one line of a server reply, without the line ending.  Long lines
+ *   are truncated to fit in 'line'.
+ *
+ ****************************************************************************/
+
+static int smtp_getline(FAR struct smtp_state *psmtp, FAR char *line,
+                        size_t size)
+{
+  ssize_t nrecvd;
+  size_t len = 0;
+  char ch;
+
+  for (; ; )
     {
-      return ERROR;
+      if (psmtp->rxndx >= psmtp->rxlen)
+        {
+          nrecvd = recv(psmtp->sockfd, psmtp->buffer,
+                        SMTP_INPUT_BUFFER_SIZE, 0);
+          if (nrecvd <= 0)
+            {
+              if (nrecvd < 0 && errno == EINTR)
+                {
+                  continue;
+                }
+
+              smtp_abort(psmtp);
+              return ERROR;
+            }
+
+          psmtp->rxlen = nrecvd;
+          psmtp->rxndx = 0;
+        }
+
+      ch = psmtp->buffer[psmtp->rxndx++];
+      if (ch == ISO_nl)
+        {
+          break;
+        }
+
+      if (ch != ISO_cr && len < size - 1)
+        {
+          line[len++] = ch;
+        }
     }
 
-  if (recv(sockfd, psmtp->buffer, SMTP_INPUT_BUFFER_SIZE, 0) < 0)
+  line[len] = '\0';
+  return OK;
+}
+
+/****************************************************************************
+ * Name: smtp_getreply
+ *
+ * Description:
+ *   Read a complete, possibly multi-line, reply and return its class (the
+ *   first digit, ISO_2 for success) or ERROR.  If 'ehlo' is true the
+ *   extension lines are checked for PIPELINING.
+ *
+ ****************************************************************************/
+
+static int smtp_getreply(FAR struct smtp_state *psmtp, bool ehlo)
+{
+  char line[SMTP_LINE_SIZE];
+  size_t len = sizeof(g_smtppipelining) - 1;
+
+  do
     {
-      return ERROR;
+      if (smtp_getline(psmtp, line, sizeof(line)) < 0)
+        {
+          return ERROR;
+        }
+
+      if (strlen(line) < 3 || line[0] < ISO_2 || line[0] > ISO_5)
+        {
+          /* Not an SMTP reply; the session cannot be trusted any more */
+
+          smtp_abort(psmtp);
+          return ERROR;
+        }
+
+      if (ehlo && line[3] != '\0' &&
+          strncasecmp(&line[4], g_smtppipelining, len) == 0 &&
+          (line[4 + len] == '\0' || line[4 + len] == ' '))
+        {
+          psmtp->pipelining = true;
+        }
     }
+  while (line[3] == '-');
+
+  return line[0];
+}
 
-  if (psmtp->buffer[0] != ISO_2)
+/****************************************************************************
+ * Name: smtp_command
+ *
+ * Description:
+ *   Queue a command that must be answered with a reply of class
+ *   'expected'.  Without PIPELINING the command is sent and its reply
+ *   checked right away; with it, the command is only queued and the
+ *   replies are collected by smtp_sync().
+ *
+ ****************************************************************************/
+
+static int smtp_command(FAR struct smtp_state *psmtp, FAR const char *cmd,
+                        FAR const char *arg, bool path, char expected)
+{
+  if (smtp_putline(psmtp, cmd, arg, path) < 0)
     {
       return ERROR;
     }
 
-  snprintf(psmtp->buffer, SMTP_INPUT_BUFFER_SIZE, "%s%s\r\n", g_smtprcptto, psmtp->to);
-  if (send(sockfd, psmtp->buffer, strlen(psmtp->buffer), 0) < 0)
+  if (psmtp->pipelining)
     {
-      return ERROR;
+      psmtp->pending[psmtp->npending++] = expected;
+      return OK;
     }
 
-  if (recv(sockfd, psmtp->buffer, SMTP_INPUT_BUFFER_SIZE, 0) < 0)
+  if (smtp_flush(psmtp) < 0)
     {
       return ERROR;
     }
 
-  if (psmtp->buffer[0] != ISO_2)
+  return smtp_getreply(psmtp, false) == expected ? OK : ERROR;
+}
+
+/****************************************************************************
+ * Name: smtp_sync
+ *
+ * Description:
+ *   Send the queued commands as one group and read all of their replies.
+ *   Returns OK if every reply was as expected.  The class of the last
+ *   reply is returned in *last.
+ *
+ ****************************************************************************/
+
+static int smtp_sync(FAR struct smtp_state *psmtp, FAR int *last)
+{
+  int ret = OK;
+  int reply = ERROR;
+  int i;
+
+  if (smtp_flush(psmtp) < 0)
     {
       return ERROR;
     }
 
-  if (psmtp->cc != 0)
+  for (i = 0; i < psmtp->npending; i++)
     {
-      snprintf(psmtp->buffer, SMTP_INPUT_BUFFER_SIZE, "%s%s\r\n", g_smtprcptto, psmtp->cc);
-      if (send(sockfd, psmtp->buffer, strlen(psmtp->buffer), 0) < 0)
+      reply = smtp_getreply(psmtp, false);
+      if (reply < 0)
         {
+          psmtp->npending = 0;
           return ERROR;
         }
 
-      if (recv(sockfd, psmtp->buffer, SMTP_INPUT_BUFFER_SIZE, 0) < 0)
+      if (reply != psmtp->pending[i])
         {
-          return ERROR;
+          ret = ERROR;
         }
+    }
+
+  psmtp->npending = 0;
+  *last = reply;
+  return ret;
+}
+
+/****************************************************************************
+ * Name: smtp_sendbody
+ *
+ * Description:
+ *   Stream the message body from 'reader', converting bare LFs to CRLF
+ *   and doubling any '.' at the start of a line, then send the final
+ *   "." line.
+ *
+ ****************************************************************************/
 
-      if (psmtp->buffer[0] != ISO_2)
+static int smtp_sendbody(FAR struct smtp_state *psmtp, smtp_reader_t reader,
+                         FAR void *arg)
+{
+  char chunk[SMTP_CHUNK_SIZE];
+  char prev = ISO_nl;
+  ssize_t nread;
+  int start;
+  int i;
+
+  for (; ; )
+    {
+      nread = reader(arg, chunk, SMTP_CHUNK_SIZE);
+      if (nread <= 0)
+        {
+          break;
+        }
+
+      for (i = 0, start = 0; i < nread; i++)
+        {
+          if ((chunk[i] == ISO_nl && prev != ISO_cr) ||
+              (chunk[i] == ISO_period && prev == ISO_nl))
+            {
+              /* Insert a CR or an extra '.' before this character */
+
+              if (smtp_write(psmtp, &chunk[start], i - start) < 0 ||
+                  smtp_write(psmtp, chunk[i] == ISO_nl ? "\r" : ".", 1) < 0)
+                {
+                  return ERROR;
+                }
+
+              start = i;
+            }
+
+          prev = chunk[i];
+        }
+
+      if (smtp_write(psmtp, &chunk[start], nread - start) < 0)
         {
           return ERROR;
         }
     }
 
-  if (send(sockfd, g_smtpdata, strlen(g_smtpdata), 0) < 0)
+  /* A failing reader leaves the server in the middle of the message; the
+   * only way to keep it from being delivered is to drop the connection.
+   */
+
+  if (nread < 0)
     {
       return ERROR;
     }
 
-  if (recv(sockfd, psmtp->buffer, SMTP_INPUT_BUFFER_SIZE, 0) < 0)
+  if (prev != ISO_nl && smtp_write(psmtp, g_smtpcrnl, 2) < 0)
     {
       return ERROR;
     }
 
-  if (psmtp->buffer[0] != ISO_3)
+  if (smtp_putline(psmtp, ".", NULL, false) < 0 || smtp_flush(psmtp) < 0)
     {
       return ERROR;
     }
 
-  snprintf(psmtp->buffer, SMTP_INPUT_BUFFER_SIZE, "%s%s\r\n", g_smtpto, psmtp->to);
-  if (send(sockfd, psmtp->buffer, strlen(psmtp->buffer), 0) < 0)
+  return smtp_getreply(psmtp, false) == ISO_2 ? OK : ERROR;
+}
+
+/****************************************************************************
+ * Name: smtp_transaction
+ *
+ * Description:
+ *   Send one message on an open session.  With PIPELINING, RSET, MAIL,
+ *   RCPT and DATA go out together and cost a single round trip.
+ *
+ ****************************************************************************/
+
+static int smtp_transaction(FAR struct smtp_state *psmtp,
+                            FAR const char *to, FAR const char *cc,
+                            FAR const char *from, FAR const char *subject,
+                            smtp_reader_t reader, FAR void *arg)
+{
+  int reply = ERROR;
+  int ret;
+
+  /* Reset any state left by the previous message */
+
+  ret = OK;
+  if (psmtp->needrset)
     {
-      return ERROR;
+      ret = smtp_command(psmtp, g_smtprset, NULL, false, ISO_2);
     }
 
-  if (psmtp->cc != 0)
+  psmtp->needrset = true;
+
+  if (ret == OK)
     {
-      snprintf(psmtp->buffer, SMTP_INPUT_BUFFER_SIZE, "%s%s\r\n", g_smtpto, psmtp->cc);
-      if (send(sockfd, psmtp->buffer, strlen(psmtp->buffer), 0) < 0)
-        {
-          return ERROR;
-        }
+      ret = smtp_command(psmtp, g_smtpmailfrom, from, true, ISO_2);
     }
 
-  snprintf(psmtp->buffer, SMTP_INPUT_BUFFER_SIZE, "%s%s\r\n", g_smtpfrom, psmtp->from);
-  if (send(sockfd, psmtp->buffer, strlen(psmtp->buffer), 0) < 0)
+  if (ret == OK)
     {
-      return ERROR;
+      ret = smtp_command(psmtp, g_smtprcptto, to, true, ISO_2);
     }
 
-  snprintf(psmtp->buffer, SMTP_INPUT_BUFFER_SIZE, "%s%s\r\n", g_smtpsubject, psmtp->subject);
-  if (send(sockfd, psmtp->buffer, strlen(psmtp->buffer), 0) < 0)
+  if (ret == OK && cc != NULL)
     {
-      return ERROR;
+      ret = smtp_command(psmtp, g_smtprcptto, cc, true, ISO_2);
     }
 
-  if (send(sockfd, psmtp->msg, psmtp->msglen, 0) < 0)
+  if (ret == OK)
     {
-      return ERROR;
+      ret = smtp_command(psmtp, g_smtpdata, NULL, false, ISO_3);
+      if (ret == OK)
+        {
+          reply = ISO_3;
+        }
     }
 
-  if (send(sockfd, g_smtpcrnlperiodcrnl, strlen(g_smtpcrnlperiodcrnl), 0) < 0)
+  if (psmtp->pipelining && psmtp->connected)
     {
-      return ERROR;
+      ret = smtp_sync(psmtp, &reply);
     }
 
-  if (recv(sockfd, psmtp->buffer, SMTP_INPUT_BUFFER_SIZE, 0) < 0)
+  /* A pipelined DATA may be accepted even though one of the recipients
+   * was refused; the message must then be sent for the others.
+   */
+
+  if (reply != ISO_3 || !psmtp->connected)
     {
       return ERROR;
     }
 
-  if (psmtp->buffer[0] != ISO_2)
+  if (smtp_putline(psmtp, g_smtpto, to, false) < 0 ||
+      (cc != NULL && smtp_putline(psmtp, g_smtpcc, cc, false) < 0) ||
+      smtp_putline(psmtp, g_smtpfrom, from, false) < 0 ||
+      smtp_putline(psmtp, g_smtpsubject, subject, false) < 0 ||
+      smtp_write(psmtp, g_smtpcrnl, 2) < 0 ||
+      smtp_sendbody(psmtp, reader, arg) < 0)
     {
+      smtp_abort(psmtp);
       return ERROR;
     }
 
-  if (send(sockfd, g_smtpquit, strlen(g_smtpquit), 0) < 0)
+  return ret;
+}
+
+/****************************************************************************
+ * Name: smtp_memread and smtp_fdread
+ *
+ * Description:
+ *   Body readers for smtp_send() and smtp_sendfile().
+ *
+ ****************************************************************************/
+
+static ssize_t smtp_memread(FAR void *arg, FAR char *buffer, size_t buflen)
+{
+  FAR struct smtp_memreader_s *mem = (FAR struct smtp_memreader_s *)arg;
+  size_t n = mem->remaining;
+
+  if (n > buflen)
     {
-      return ERROR;
+      n = buflen;
     }
-  return OK;
+
+  memcpy(buffer, mem->msg, n);
+  mem->msg       += n;
+  mem->remaining -= n;
+  return n;
+}
+
+static ssize_t smtp_fdread(FAR void *arg, FAR char *buffer, size_t buflen)
+{
+  return read((int)(intptr_t)arg, buffer, buflen);
 }
 
 /****************************************************************************
@@ -293,38 +659,34 @@ void smtp_configure(FAR void *handle, FAR const char *lhostname,
   net_ipv4addr_copy(psmtp->smtpserver, paddr);
 }
 
-/* Send an e-mail.
+/* Open a session with the configured server.
  *
- *   to      - The e-mail address of the receiver of the e-mail.
- *   cc      - The e-mail address of the CC: receivers of the e-mail.
- *   from    - The e-mail address of the sender of the e-mail.
- *   subject - The subject of the e-mail.
- *   msg     - The actual e-mail message.
- *   msglen  - The length of the e-mail message.
+ * Connects, waits for the greeting and introduces the client with EHLO,
+ * falling back to HELO for servers without ESMTP.  The connection stays
+ * open for any number of messages until smtp_disconnect().
  */
 
-int smtp_send(void *handle, const char *to, const char *cc, const char *from,
-              const char *subject, const char *msg, int msglen)
+int smtp_connect(FAR void *handle)
 {
-  struct smtp_state *psmtp = (struct smtp_state *)handle;
+  FAR struct smtp_state *psmtp = (FAR struct smtp_state *)handle;
   struct sockaddr_in server;
-  int sockfd;
-  int ret;
 
-  /* Setup */
+  if (psmtp->connected)
+    {
+      return OK;
+    }
 
-  psmtp->connected = true;
-  psmtp->to        = to;
-  psmtp->cc        = cc;
-  psmtp->from      = from;
-  psmtp->subject   = subject;
-  psmtp->msg       = msg;
-  psmtp->msglen    = msglen;
+  psmtp->rxlen      = 0;
+  psmtp->rxndx      = 0;
+  psmtp->txlen      = 0;
+  psmtp->npending   = 0;
+  psmtp->pipelining = false;
+  psmtp->needrset   = false;
 
   /* Create a socket */
 
-  sockfd = socket(AF_INET, SOCK_STREAM, 0);
-  if (sockfd < 0)
+  psmtp->sockfd = socket(AF_INET, SOCK_STREAM, 0);
+  if (psmtp->sockfd < 0)
     {
       return ERROR;
     }
@@ -338,20 +700,127 @@ int smtp_send(void *handle, const char *to, const char *cc, const char *from,
   memcpy(&server.sin_addr.s_addr, &psmtp->smtpserver, sizeof(in_addr_t));
   server.sin_port = HTONS(25);
 
-  if (connect(sockfd, (struct sockaddr *)&server, sizeof(struct sockaddr_in)) < 0)
+  if (connect(psmtp->sockfd, (struct sockaddr *)&server,
+              sizeof(struct sockaddr_in)) < 0)
     {
-      close(sockfd);
+      close(psmtp->sockfd);
       return ERROR;
     }
 
-  /* Send the message */
+  psmtp->connected = true;
+
+  if (smtp_getreply(psmtp, false) != ISO_2)
+    {
+      smtp_abort(psmtp);
+      return ERROR;
+    }
+
+  if (smtp_putline(psmtp, g_smtpehlo, psmtp->localhostname, false) < 0 ||
+      smtp_flush(psmtp) < 0)
+    {
+      smtp_abort(psmtp);
+      return ERROR;
+    }
+
+  if (smtp_getreply(psmtp, true) != ISO_2 &&
+      smtp_command(psmtp, g_smtphelo, psmtp->localhostname, false,
+                   ISO_2) < 0)
+    {
+      smtp_abort(psmtp);
+      return ERROR;
+    }
+
+#ifndef CONFIG_NETUTILS_SMTP_PIPELINING
+  psmtp->pipelining = false;
+#endif
+
+  return OK;
+}
+
+/* Close the session opened by smtp_connect(). */
+
+void smtp_disconnect(FAR void *handle)
+{
+  FAR struct smtp_state *psmtp = (FAR struct smtp_state *)handle;
+
+  if (psmtp->connected)
+    {
+      if (smtp_putline(psmtp, g_smtpquit, NULL, false) == OK)
+        {
+          (void)smtp_flush(psmtp);
+        }
+
+      smtp_abort(psmtp);
+    }
+}
+
+/* Send an e-mail whose body is supplied by a reader callback.
+ *
+ *   to      - The e-mail address of the receiver of the e-mail.
+ *   cc      - The e-mail address of the CC: receivers of the e-mail.
+ *   from    - The e-mail address of the sender of the e-mail.
+ *   subject - The subject of the e-mail.
+ *   reader  - Called repeatedly for the body until it returns zero.
+ *   arg     - Passed to reader.
+ *
+ * The message is sent on the open session, or on a connection made for
+ * this message only if there is none.
+ */
 
-  ret = smtp_send_message(sockfd, psmtp);
+int smtp_sendstream(FAR void *handle, FAR const char *to,
+                    FAR const char *cc, FAR const char *from,
+                    FAR const char *subject, smtp_reader_t reader,
+                    FAR void *arg)
+{
+  FAR struct smtp_state *psmtp = (FAR struct smtp_state *)handle;
+  bool session = psmtp->connected;
+  int ret;
+
+  if (!session && smtp_connect(handle) < 0)
+    {
+      return ERROR;
+    }
+
+  ret = smtp_transaction(psmtp, to, cc, from, subject, reader, arg);
+
+  if (!session)
+    {
+      smtp_disconnect(handle);
+    }
 
-  close(sockfd);
   return ret;
 }
 
+/* Send an e-mail whose body is read from a file descriptor until EOF. */
+
+int smtp_sendfile(FAR void *handle, FAR const char *to, FAR const char *cc,
+                  FAR const char *from, FAR const char *subject, int fd)
+{
+  return smtp_sendstream(handle, to, cc, from, subject, smtp_fdread,
+                         (FAR void *)(intptr_t)fd);
+}
+
+/* Send an e-mail.
+ *
+ *   to      - The e-mail address of the receiver of the e-mail.
+ *   cc      - The e-mail address of the CC: receivers of the e-mail.
+ *   from    - The e-mail address of the sender of the e-mail.
+ *   subject - The subject of the e-mail.
+ *   msg     - The actual e-mail message.
+ *   msglen  - The length of the e-mail message.
+ */
+
+int smtp_send(void *handle, const char *to, const char *cc, const char *from,
+              const char *subject, const char *msg, int msglen)
+{
+  struct smtp_memreader_s mem;
+
+  mem.msg       = msg;
+  mem.remaining = msglen;
+
+  return smtp_sendstream(handle, to, cc, from, subject, smtp_memread, &mem);
+}
+
 void *smtp_open(void)
 {
   /* Allocate the handle */
@@ -373,6 +842,7 @@ void smtp_close(void *handle)
   struct smtp_state *psmtp = (struct smtp_state *)handle;
   if (psmtp)
     {
+      smtp_disconnect(handle);
       sem_destroy(&psmtp->sem);
       free(psmtp);
     }
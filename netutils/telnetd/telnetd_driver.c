@@ -58,8 +58,10 @@
 #include <errno.h>
 #include <debug.h>
 
+#include <nuttx/clock.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/net/net.h>
+#include <nuttx/wqueue.h>
 
 #include <apps/netutils/telnetd.h>
 #include <apps/netutils/netlib.h>
@@ -84,6 +86,25 @@
 
 #define TELNETD_DEVFMT "/dev/telnetd%d"
 
+/* Output coalescing ********************************************************/
+/* Output is accumulated in td_txbuffer and sent when the buffer is full,
+ * before the driver blocks waiting for input, or at most
+ * CONFIG_TELNETD_FLUSHDELAY milliseconds after it was written.  The flush
+ * timer requires the work queue.  Without it, the buffer is sent at the
+ * end of each write.
+ */
+
+#ifndef CONFIG_TELNETD_FLUSHDELAY
+#  define CONFIG_TELNETD_FLUSHDELAY 0
+#endif
+
+#if defined(CONFIG_SCHED_WORKQUEUE) && CONFIG_TELNETD_FLUSHDELAY > 0
+#  define TELNETD_HAVE_FLUSHTIMER 1
+#  define TELNETD_FLUSHTICKS \
+     (MSEC2TICK(CONFIG_TELNETD_FLUSHDELAY) > 0 ? \
+      MSEC2TICK(CONFIG_TELNETD_FLUSHDELAY) : 1)
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -105,11 +126,18 @@ struct telnetd_dev_s
 {
   sem_t              td_exclsem; /* Enforces mutually exclusive access */
   uint8_t            td_state;   /* (See telnetd_state_e) */
-  uint8_t            td_pending; /* Number of valid, pending bytes in the rxbuffer */
-  uint8_t            td_offset;  /* Offset to the valid, pending bytes in the rxbuffer */
   uint8_t            td_crefs;   /* The number of open references to the session */
+  uint16_t           td_pending; /* Number of valid, pending bytes in the rxbuffer */
+  uint16_t           td_offset;  /* Offset to the valid, pending bytes in the rxbuffer */
+  uint16_t           td_txlen;   /* Number of bytes waiting in the txbuffer */
   int                td_minor;   /* Minor device number */
   FAR struct socket  td_psock;   /* A clone of the internal socket structure */
+#ifdef TELNETD_HAVE_FLUSHTIMER
+  volatile bool      td_flushpend; /* True: The flush work is scheduled */
+  volatile bool      td_closing; /* True: The session is being closed */
+  sem_t              td_flushsem; /* Posted when the flush work exits */
+  struct work_s      td_work;    /* Used to flush the txbuffer after a delay */
+#endif
   char td_rxbuffer[CONFIG_TELNETD_RXBUFFER_SIZE];
   char td_txbuffer[CONFIG_TELNETD_TXBUFFER_SIZE];
 };
@@ -127,11 +155,15 @@ static inline void telnetd_dumpbuffer(FAR const char *msg,
 #endif
 static void    telnetd_getchar(FAR struct telnetd_dev_s *priv, uint8_t ch,
                  FAR char *dest, int *nread);
+static size_t  telnetd_copyrun(FAR const char *src, size_t srclen,
+                 FAR char *dest, size_t destlen, FAR int *nread);
 static ssize_t telnetd_receive(FAR struct telnetd_dev_s *priv,
                  FAR const char *src, size_t srclen, FAR char *dest,
                  size_t destlen);
-static bool    telnetd_putchar(FAR struct telnetd_dev_s *priv, uint8_t ch,
-                 int *nwritten);
+static int     telnetd_flush(FAR struct telnetd_dev_s *priv);
+#ifdef TELNETD_HAVE_FLUSHTIMER
+static void    telnetd_flushwork(FAR void *arg);
+#endif
 static void    telnetd_sendopt(FAR struct telnetd_dev_s *priv, uint8_t option,
                  uint8_t value);
 
@@ -211,6 +243,59 @@ static void telnetd_getchar(FAR struct telnetd_dev_s *priv, uint8_t ch,
     }
 }
 
+/****************************************************************************
+ * Name: telnetd_copyrun
+ *
+ * Description:
+ *   Copy a run of ordinary characters (up to the next IAC) from the RX
+ *   buffer to the user buffer, dropping carriage returns.  Returns the
+ *   number of bytes consumed from the RX buffer.
+ *
+ ****************************************************************************/
+
+static size_t telnetd_copyrun(FAR const char *src, size_t srclen,
+                              FAR char *dest, size_t destlen, FAR int *nread)
+{
+  FAR const char *end;
+  size_t consumed = 0;
+  size_t ncopy;
+  size_t run;
+
+  end = (FAR const char *)memchr(src, TELNET_IAC, srclen);
+  run = end ? (size_t)(end - src) : srclen;
+
+  while (run > 0 && *nread < destlen)
+    {
+      /* Copy up to the next carriage return or until the user buffer is
+       * full.
+       */
+
+      end   = (FAR const char *)memchr(src, ISO_cr, run);
+      ncopy = end ? (size_t)(end - src) : run;
+      if (ncopy > destlen - *nread)
+        {
+          ncopy = destlen - *nread;
+        }
+
+      memcpy(&dest[*nread], src, ncopy);
+      *nread   += ncopy;
+      src      += ncopy;
+      run      -= ncopy;
+      consumed += ncopy;
+
+      /* Ignore carriage returns */
+
+      if (run > 0 && *src == ISO_cr)
+        {
+          src++;
+          run--;
+          consumed++;
+        }
+    }
+
+  return consumed;
+}
+
 /****************************************************************************
  * Name: telnetd_receive
  *
@@ -222,6 +307,7 @@ static void telnetd_getchar(FAR struct telnetd_dev_s *priv, uint8_t ch,
 static ssize_t telnetd_receive(FAR struct telnetd_dev_s *priv, FAR const char *src,
                                size_t srclen, FAR char *dest, size_t destlen)
 {
+  size_t nrun;
   int nread;
   uint8_t ch;
 
@@ -229,6 +315,22 @@ static ssize_t telnetd_receive(FAR struct telnetd_dev_s *priv, FAR const char *s
 
   for (nread = 0; srclen > 0 && nread < destlen; srclen--)
     {
+      /* Most received data is ordinary characters.  Copy runs of them in
+       * bulk rather than one at a time through the state machine.
+       */
+
+      if (priv->td_state == STATE_NORMAL && (uint8_t)*src != TELNET_IAC)
+        {
+          nrun    = telnetd_copyrun(src, srclen, dest, destlen, &nread);
+          src    += nrun;
+          srclen -= nrun;
+
+          if (srclen == 0 || nread >= destlen)
+            {
+              break;
+            }
+        }
+
       ch = *src++;
       nllvdbg("ch=%02x state=%d\n", ch, priv->td_state);
 
@@ -333,47 +435,122 @@ static ssize_t telnetd_receive(FAR struct telnetd_dev_s *priv, FAR const char *s
 }
 
 /****************************************************************************
- * Name: telnetd_putchar
+ * Name: telnetd_flush
  *
  * Description:
- *   Put another character from the user buffer to the TX buffer.
+ *   Send any output waiting in the TX buffer.  The caller must hold
+ *   td_exclsem.
  *
  ****************************************************************************/
 
-static bool telnetd_putchar(FAR struct telnetd_dev_s *priv, uint8_t ch,
-                            int *nread)
+static int telnetd_flush(FAR struct telnetd_dev_s *priv)
 {
-  register int index;
-  bool ret = false;
-
-  /* Ignore carriage returns (we will put these in automatically as necesary) */
+  ssize_t ret;
+  int len = priv->td_txlen;
 
-  if (ch != ISO_cr)
+  if (len > 0)
     {
-      /* Add all other characters to the destination buffer */
+      priv->td_txlen = 0;
 
-      index = *nread;
-      priv->td_txbuffer[index++] = ch;
+      telnetd_dumpbuffer("Send txbuffer", priv->td_txbuffer, len);
+      ret = psock_send(&priv->td_psock, priv->td_txbuffer, len, 0);
+      if (ret < 0)
+        {
+          nlldbg("psock_send failed: %d\n", ret);
+          return (int)ret;
+        }
+    }
 
-      /* Check for line feeds */
+  return OK;
+}
 
-      if (ch == ISO_nl)
+/****************************************************************************
+ * Name: telnetd_flushwork
+ *
+ * Description:
+ *   Runs on the work queue to send buffered output
+ *   CONFIG_TELNETD_FLUSHDELAY milliseconds after it was written.  The work
+ *   queue is shared, so the output is sent without blocking.  Whatever the
+ *   socket will not take now is sent when the timer expires again.
+ *
+ ****************************************************************************/
+
+#ifdef TELNETD_HAVE_FLUSHTIMER
+static void telnetd_flushwork(FAR void *arg)
+{
+  FAR struct telnetd_dev_s *priv = (FAR struct telnetd_dev_s *)arg;
+  ssize_t ret;
+  int len;
+
+  /* If a writer holds the semaphore, try again later.  If the session is
+   * being closed, telnetd_close() holds the semaphore and is waiting on
+   * td_flushsem;  it will send the output itself.  priv must not be
+   * accessed after td_flushsem is posted.
+   */
+
+  if (sem_trywait(&priv->td_exclsem) < 0)
+    {
+      if (priv->td_closing)
+        {
+          priv->td_flushpend = false;
+          sem_post(&priv->td_flushsem);
+        }
+      else
+        {
+          (void)work_queue(LPWORK, &priv->td_work, telnetd_flushwork, priv,
+                           TELNETD_FLUSHTICKS);
+        }
+
+      return;
+    }
+
+  len = priv->td_txlen;
+  if (len > 0)
+    {
+      telnetd_dumpbuffer("Send txbuffer", priv->td_txbuffer, len);
+      ret = psock_send(&priv->td_psock, priv->td_txbuffer, len,
+                       MSG_DONTWAIT);
+      if (ret < 0)
         {
-          /* Now add the carriage return */
+          if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+              ret = 0;
+            }
+          else
+            {
+              /* The connection is lost.  The next read or write will
+               * report the error.
+               */
 
-          priv->td_txbuffer[index++] = ISO_cr;
-          priv->td_txbuffer[index++] = '\0';
+              nlldbg("psock_send failed: %d\n", errno);
+              ret = len;
+            }
+        }
 
-          /* End of line */
+      /* Keep whatever was not sent at the start of the buffer */
 
-          ret = true;
+      len -= ret;
+      if (len > 0)
+        {
+          memmove(priv->td_txbuffer, &priv->td_txbuffer[ret], len);
         }
 
-      *nread = index;
+      priv->td_txlen = len;
     }
 
-  return ret;
+  if (len > 0)
+    {
+      (void)work_queue(LPWORK, &priv->td_work, telnetd_flushwork, priv,
+                       TELNETD_FLUSHTICKS);
+    }
+  else
+    {
+      priv->td_flushpend = false;
+    }
+
+  sem_post(&priv->td_exclsem);
 }
+#endif
 
 /****************************************************************************
  * Name: telnetd_sendopt
@@ -490,6 +667,28 @@ static int telnetd_close(FAR struct file *filep)
     }
   else
     {
+#ifdef TELNETD_HAVE_FLUSHTIMER
+      /* Stop the flush timer.  If the flush work has already started, it
+       * cannot get td_exclsem and will post td_flushsem when it is
+       * finished with the device.
+       */
+
+      priv->td_closing = true;
+      if (work_cancel(LPWORK, &priv->td_work) == OK)
+        {
+          priv->td_flushpend = false;
+        }
+
+      while (priv->td_flushpend)
+        {
+          (void)sem_wait(&priv->td_flushsem);
+        }
+#endif
+
+      /* Send any remaining output */
+
+      (void)telnetd_flush(priv);
+
       /* Re-create the path to the driver. */
 
       sched_lock();
@@ -536,6 +735,9 @@ static int telnetd_close(FAR struct file *filep)
 
       DEBUGASSERT(priv->td_exclsem.semcount == 0);
       sem_destroy(&priv->td_exclsem);
+#ifdef TELNETD_HAVE_FLUSHTIMER
+      sem_destroy(&priv->td_flushsem);
+#endif
       free(priv);
       sched_unlock();
     }
@@ -579,6 +781,16 @@ static ssize_t telnetd_read(FAR struct file *filep, FAR char *buffer, size_t len
 
       else
         {
+          /* Send any buffered output (such as a prompt) before waiting
+           * for input.
+           */
+
+          if (priv->td_txlen > 0 && sem_wait(&priv->td_exclsem) == OK)
+            {
+              (void)telnetd_flush(priv);
+              sem_post(&priv->td_exclsem);
+            }
+
           ret = psock_recv(&priv->td_psock, priv->td_rxbuffer,
                           CONFIG_TELNETD_RXBUFFER_SIZE, 0);
 
@@ -623,67 +835,98 @@ static ssize_t telnetd_write(FAR struct file *filep, FAR const char *buffer, siz
   FAR struct inode *inode = filep->f_inode;
   FAR struct telnetd_dev_s *priv = inode->i_private;
   FAR const char *src = buffer;
-  ssize_t nsent;
+  size_t nsent;
   ssize_t ret;
-  int ncopied;
   char ch;
-  bool eol;
 
   nllvdbg("len: %d\n", len);
 
+  /* Get exclusive access to the TX buffer */
+
+  ret = sem_wait(&priv->td_exclsem);
+  if (ret < 0)
+    {
+      return -errno;
+    }
+
   /* Process each character from the user buffer */
 
-  for (nsent = 0, ncopied = 0; nsent < len; nsent++)
+  for (nsent = 0; nsent < len; nsent++)
     {
       /* Get the next character from the user buffer */
 
       ch = *src++;
 
-      /* Add the character to the TX buffer */
+      /* Ignore carriage returns (we will put these in automatically as
+       * necessary).
+       */
 
-      eol = telnetd_putchar(priv, ch, &ncopied);
+      if (ch == ISO_cr)
+        {
+          continue;
+        }
 
-      /* Was that the end of a line? Or is the buffer too full to hold the
-       * next largest character sequence ("\r\n\0")?
+      /* Is the buffer too full to hold the next largest character sequence
+       * ("\r\n")?
        */
 
-      if (eol || ncopied > CONFIG_TELNETD_TXBUFFER_SIZE-3)
+      if (priv->td_txlen > CONFIG_TELNETD_TXBUFFER_SIZE - 2)
         {
           /* Yes... send the data now */
 
-          ret = psock_send(&priv->td_psock, priv->td_txbuffer, ncopied, 0);
+          ret = telnetd_flush(priv);
           if (ret < 0)
             {
-              nlldbg("psock_send failed '%s': %d\n", priv->td_txbuffer, ret);
-              return ret;
+              goto errout_with_sem;
             }
+        }
 
-          /* Reset the index to the beginning of the TX buffer. */
+      /* Add the character to the TX buffer, preceded by a carriage return
+       * if it is a line feed.
+       */
 
-          ncopied = 0;
+      if (ch == ISO_nl)
+        {
+          priv->td_txbuffer[priv->td_txlen++] = ISO_cr;
         }
+
+      priv->td_txbuffer[priv->td_txlen++] = ch;
     }
 
+#ifdef TELNETD_HAVE_FLUSHTIMER
+  /* Start the flush timer.  Output written before it expires is sent in
+   * the same TCP segment.
+   */
+
+  if (priv->td_txlen > 0 && !priv->td_flushpend)
+    {
+      priv->td_flushpend = true;
+      (void)work_queue(LPWORK, &priv->td_work, telnetd_flushwork, priv,
+                       TELNETD_FLUSHTICKS);
+    }
+#else
   /* Send anything remaining in the TX buffer */
 
-  if (ncopied > 0)
+  ret = telnetd_flush(priv);
+  if (ret < 0)
     {
-      ret = psock_send(&priv->td_psock, priv->td_txbuffer, ncopied, 0);
-      if (ret < 0)
-        {
-          nlldbg("psock_send failed '%s': %d\n", priv->td_txbuffer, ret);
-          return ret;
-        }
+      goto errout_with_sem;
     }
+#endif
+
+  sem_post(&priv->td_exclsem);
 
   /* Notice that we don't actually return the number of bytes sent, but
    * rather, the number of bytes that the caller asked us to send.  We may
-   * have sent more bytes (because of CR-LF expansion and because of NULL
-   * termination). But it confuses some logic if you report that you sent
-   * more than you were requested to.
+   * have sent more bytes (because of CR-LF expansion). But it confuses some
+   * logic if you report that you sent more than you were requested to.
    */
 
   return len;
+
+errout_with_sem:
+  sem_post(&priv->td_exclsem);
+  return ret;
 }
 
 /****************************************************************************
@@ -772,6 +1015,13 @@ FAR char *telnetd_driver(int sd, FAR struct telnetd_s *daemon)
   priv->td_crefs   = 0;
   priv->td_pending = 0;
   priv->td_offset  = 0;
+  priv->td_txlen   = 0;
+#ifdef TELNETD_HAVE_FLUSHTIMER
+  priv->td_flushpend = false;
+  priv->td_closing   = false;
+  sem_init(&priv->td_flushsem, 0, 0);
+  memset(&priv->td_work, 0, sizeof(struct work_s));
+#endif
 
   /* Clone the internal socket structure.  We do this so that it will be
    * independent of threads and of socket descriptors (the original socket
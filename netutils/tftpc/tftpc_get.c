@@ -107,25 +107,22 @@ static inline ssize_t tftp_write(int fd, const uint8_t *buf, size_t len)
 }
 
 /****************************************************************************
- * Name: tftp_parsedatapacket
+ * Name: tftp_sendack
  ****************************************************************************/
 
-static inline int tftp_parsedatapacket(const uint8_t *packet,
-                                       uint16_t *opcode, uint16_t *blockno)
+static int tftp_sendack(int sd, FAR uint8_t *packet, uint16_t blockno,
+                        FAR struct sockaddr_in *server)
 {
-  *opcode = (uint16_t)packet[0] << 8 | (uint16_t)packet[1];
-  if (*opcode == TFTP_DATA)
-    {
-       *blockno = (uint16_t)packet[2] << 8 | (uint16_t)packet[3];
-       return OK;
-    }
-#if defined(CONFIG_DEBUG) && defined(CONFIG_DEBUG_NET)
-  else if (*opcode == TFTP_ERR)
+  int len;
+
+  len = tftp_mkackpacket(packet, blockno);
+  if (tftp_sendto(sd, packet, len, server) != len)
     {
-      (void)tftp_parseerrpacket(packet);
+      return ERROR;
     }
-#endif
-  return ERROR;
+
+  nvdbg("ACK blockno %d\n", blockno);
+  return OK;
 }
 
 /****************************************************************************
@@ -135,6 +132,17 @@ static inline int tftp_parsedatapacket(const uint8_t *packet,
 /****************************************************************************
  * Name: tftpget
  *
+ * Description:
+ *   Receive a file from the TFTP server.  If larger blocks or a window
+ *   size greater than one are configured, these are requested from the
+ *   server (RFC 2347, 2348, 2349, and 7440).  The transfer falls back to
+ *   classic TFTP if the server ignores or rejects the options.
+ *
+ *   With a window size greater than one, the server sends a window of
+ *   DATA packets and we ACK only the last block of each window.  If a
+ *   block is lost, we ACK the last block received in sequence so that the
+ *   server resumes sending from the first missing block.
+ *
  * Input Parameters:
  *   remote - The name of the file on the TFTP server.
  *   local  - Path to the location on a mounted filesystem where the file
@@ -150,18 +158,23 @@ int tftpget(FAR const char *remote, FAR const char *local, in_addr_t addr,
 {
   struct sockaddr_in server;  /* The address of the TFTP server */
   struct sockaddr_in from;    /* The address the last UDP message recv'd from */
+  struct tftp_opts_s opts;    /* Requested, then negotiated, options */
   FAR uint8_t *packet;        /* Allocated memory to hold one packet */
-  uint16_t blockno = 0;       /* The current transfer block number */
+  uint32_t nbytestotal = 0;   /* Number of data bytes written to the file */
+  uint16_t blockno = 1;       /* The next expected block number */
   uint16_t opcode;            /* Received opcode */
   uint16_t rblockno;          /* Received block number */
+  bool useopts;               /* True: Options are sent with the request */
+  bool started = false;       /* True: The server has responded */
+  bool nakked = false;        /* True: A gap in this window has been ACKed */
+  int inwindow = 0;           /* Number of blocks received in this window */
   int len;                    /* Generic length */
   int sd;                     /* Socket descriptor for socket I/O */
   int fd;                     /* File descriptor for file I/O */
-  int retry;                  /* Retry counter */
-  int nbytesrecvd = 0;        /* The number of bytes received in the packet */
+  int retry = 0;              /* Retry counter */
+  int nbytesrecvd;            /* The number of bytes received in the packet */
   int ndatabytes;             /* The number of data bytes received */
   int result = ERROR;         /* Assume failure */
-  int ret;                    /* Generic return status */
 
   /* Allocate the buffer to used for socket/disk I/O */
 
@@ -190,137 +203,249 @@ int tftpget(FAR const char *remote, FAR const char *local, in_addr_t addr,
       goto errout_with_fd;
     }
 
+  useopts = TFTP_USEOPTIONS;
+  tftp_initopts(&opts, useopts);
+
   /* Then enter the transfer loop.  Loop until the entire file has
    * been received or until an error occurs.
    */
 
-  do
+  for (;;)
     {
-      /* Increment the TFTP block number for the next transfer */
+      /* Send the read request using the well-known port number until the
+       * server responds.  Subsequent sendto will use the port number
+       * selected by the TFTP server.  Setting the server port to zero
+       * here indicates that we have not yet received the server port
+       * number.
+       */
 
-      blockno++;
+      if (!started)
+        {
+          len             = tftp_mkreqpacket(packet, TFTP_RRQ, remote, binary,
+                                             useopts ? &opts : NULL);
+          server.sin_port = HTONS(CONFIG_NETUTILS_TFTP_PORT);
+          if (tftp_sendto(sd, packet, len, &server) != len)
+            {
+              goto errout_with_sd;
+            }
 
-      /* Send the next block if the file within a loop.  We will
-       * retry up to TFTP_RETRIES times before giving up on the
-       * transfer.
-       */
+          server.sin_port = 0;
+        }
+
+      /* Get the next packet from the server */
 
-      for (retry = 0; retry < TFTP_RETRIES; retry++)
+      nbytesrecvd = tftp_recvfrom(sd, packet, TFTP_IOBUFSIZE, &from);
+      if (nbytesrecvd < 0)
         {
-          /* Send the read request using the well-known port number before
-           * receiving the first block.  Each retry of the first block will
-           * re-send the request.
+          /* Timed out.  We will retry up to TFTP_RETRIES times before
+           * giving up on the transfer.
+           */
+
+          if (++retry > TFTP_RETRIES)
+            {
+              nvdbg("Retry limit exceeded\n");
+              set_errno(ETIMEDOUT);
+              goto errout_with_sd;
+            }
+
+          /* If the transfer has started, ACK the last block received in
+           * sequence so that the server resends everything after it.
+           * Otherwise, loop to re-send the request.
            */
 
-          if (blockno == 1)
+          if (started)
             {
-              len             = tftp_mkreqpacket(packet, TFTP_RRQ, remote, binary);
-              server.sin_port = HTONS(CONFIG_NETUTILS_TFTP_PORT);
-              ret             = tftp_sendto(sd, packet, len, &server);
-              if (ret != len)
+              inwindow = 0;
+              if (tftp_sendack(sd, packet, blockno - 1, &server) != OK)
                 {
                   goto errout_with_sd;
                 }
+            }
 
-              /* Subsequent sendto will use the port number selected by the TFTP
-               * server in the DATA packet.  Setting the server port to zero
-               * here indicates that we have not yet received the server port number.
-               */
+          continue;
+        }
 
-              server.sin_port = 0;
-            }
+      /* Verify the sender address and port number */
+
+      if (server.sin_addr.s_addr != from.sin_addr.s_addr)
+        {
+          nvdbg("Invalid address in DATA\n");
+          continue;
+        }
+
+      if (server.sin_port && server.sin_port != from.sin_port)
+        {
+          nvdbg("Invalid port in DATA\n");
+          len = tftp_mkerrpacket(packet, TFTP_ERR_UNKID, TFTP_ERRST_UNKID);
+          (void)tftp_sendto(sd, packet, len, &from);
+          continue;
+        }
 
-          /* Get the next packet from the server */
+      if (nbytesrecvd < TFTP_DATAHEADERSIZE)
+        {
+          /* Packet is not big enough to be parsed */
 
-          nbytesrecvd = tftp_recvfrom(sd, packet, TFTP_IOBUFSIZE, &from);
+          nvdbg("Tiny data packet ignored\n");
+          continue;
+        }
 
-          /* Check if anything valid was received */
+      opcode = (uint16_t)packet[0] << 8 | (uint16_t)packet[1];
 
-          if (nbytesrecvd > 0)
-            {
-              /* Verify the sender address and port number */
+      /* The first response to the request determines which options
+       * are in effect.
+       */
 
-              if (server.sin_addr.s_addr != from.sin_addr.s_addr)
+      if (!started)
+        {
+          if (opcode == TFTP_OACK && useopts)
+            {
+              server.sin_port = from.sin_port;
+              if (tftp_parseoack(packet, nbytesrecvd, &opts) != OK)
                 {
-                  nvdbg("Invalid address in DATA\n");
-                  retry--;
-                  continue;
+                  len = tftp_mkerrpacket(packet, TFTP_ERR_NEGOTIATE,
+                                         TFTP_ERRST_NEGOTIATE);
+                  (void)tftp_sendto(sd, packet, len, &server);
+                  goto errout_with_sd;
                 }
 
-              if (server.sin_port && server.sin_port != from.sin_port)
+              /* Accept the options by acknowledging block zero */
+
+              started = true;
+              retry   = 0;
+              if (tftp_sendack(sd, packet, 0, &server) != OK)
                 {
-                  nvdbg("Invalid port in DATA\n");
-                  len = tftp_mkerrpacket(packet, TFTP_ERR_UNKID, TFTP_ERRST_UNKID);
-                  ret = tftp_sendto(sd, packet, len, &from);
-                  retry--;
-                  continue;
+                  goto errout_with_sd;
                 }
 
-              /* Parse the incoming DATA packet */
+              continue;
+            }
+          else if (opcode == TFTP_ERR && useopts)
+            {
+              /* Some older servers reject requests with options.  Try
+               * again as a classic TFTP request.
+               */
 
-              if (nbytesrecvd < TFTP_DATAHEADERSIZE)
-                {
-                  /* Packet is not big enough to be parsed */
+              nvdbg("Request rejected, retrying without options\n");
+              useopts = false;
+              tftp_initopts(&opts, false);
+              retry   = 0;
+              continue;
+            }
+          else if (opcode == TFTP_DATA)
+            {
+              /* The server ignored any options */
 
-                  nvdbg("Tiny data packet ignored\n");
-                  continue;
-                }
+              tftp_initopts(&opts, false);
+              server.sin_port = from.sin_port;
+              started = true;
+            }
+        }
 
-              if (tftp_parsedatapacket(packet, &opcode, &rblockno) != OK ||
-                  blockno != rblockno)
-                {
-                  /* Opcode is not TFTP_DATA or the block number is unexpected */
-
-                  nvdbg("Parse failure\n");
-                  if (opcode > TFTP_MAXRFC1350)
-                    {
-                      len = tftp_mkerrpacket(packet, TFTP_ERR_ILLEGALOP, TFTP_ERRST_ILLEGALOP);
-                      ret = tftp_sendto(sd, packet, len, &from);
-                    }
-                  continue;
-                }
+      if (opcode != TFTP_DATA)
+        {
+          /* Opcode is not TFTP_DATA */
+
+          nvdbg("Parse failure\n");
+#if defined(CONFIG_DEBUG) && defined(CONFIG_DEBUG_NET)
+          if (opcode == TFTP_ERR)
+            {
+              (void)tftp_parseerrpacket(packet);
+            }
+#endif
+          if (opcode == TFTP_ERR)
+            {
+              goto errout_with_sd;
+            }
+
+          if (opcode > TFTP_MAXRFC1350 && opcode != TFTP_OACK)
+            {
+              len = tftp_mkerrpacket(packet, TFTP_ERR_ILLEGALOP, TFTP_ERRST_ILLEGALOP);
+              (void)tftp_sendto(sd, packet, len, &from);
+            }
+
+          continue;
+        }
 
-              /* Replace the server port to the one in the good data response */
+      rblockno   = (uint16_t)packet[2] << 8 | (uint16_t)packet[3];
+      ndatabytes = nbytesrecvd - TFTP_DATAHEADERSIZE;
+
+      if (rblockno != blockno)
+        {
+          /* A block was lost (or the packets were re-ordered).  ACK the
+           * last block received in sequence, once per window, so that the
+           * server will resume sending from the missing block.  A
+           * duplicate of the last block means that the server did not
+           * get our last ACK.  Block numbers wrap around at 65535.
+           */
 
-              if (!server.sin_port)
+          nvdbg("Expected block %d, received %d\n", blockno, rblockno);
+          if ((int16_t)(rblockno - blockno) > 0)
+            {
+              if (nakked)
                 {
-                  server.sin_port = from.sin_port;
+                  continue;
                 }
 
-              /* Then break out of the loop */
+              nakked = true;
+            }
+          else if (rblockno != (uint16_t)(blockno - 1))
+            {
+              continue;
+            }
 
-              break;
+          inwindow = 0;
+          if (tftp_sendack(sd, packet, blockno - 1, &server) != OK)
+            {
+              goto errout_with_sd;
             }
-        }
 
-      /* Did we exhaust all of the retries? */
+          continue;
+        }
 
-      if (retry == TFTP_RETRIES)
+      if (ndatabytes > opts.blksize)
         {
-          nvdbg("Retry limit exceeded\n");
-          goto errout_with_sd;
+          nvdbg("Oversized data packet ignored\n");
+          continue;
         }
 
       /* Write the received data chunk to the file */
 
-      ndatabytes = nbytesrecvd - TFTP_DATAHEADERSIZE;
       tftp_dumpbuffer("Recvd DATA", packet + TFTP_DATAHEADERSIZE, ndatabytes);
       if (tftp_write(fd, packet + TFTP_DATAHEADERSIZE, ndatabytes) < 0)
         {
           goto errout_with_sd;
         }
 
-      /* Send the acknowledgment */
+      nbytestotal += ndatabytes;
+      retry        = 0;
+      nakked       = false;
+
+      /* Send the acknowledgment at the end of the window and for the final
+       * block.  A short block marks the end of the file.
+       */
 
-      len = tftp_mkackpacket(packet, blockno);
-      ret = tftp_sendto(sd, packet, len, &server);
-      if (ret != len)
+      if (ndatabytes < opts.blksize || ++inwindow >= opts.windowsize)
         {
-          goto errout_with_sd;
+          inwindow = 0;
+          if (tftp_sendack(sd, packet, blockno, &server) != OK)
+            {
+              goto errout_with_sd;
+            }
+        }
+
+      if (ndatabytes < opts.blksize)
+        {
+          break;
         }
-      nvdbg("ACK blockno %d\n", blockno);
+
+      blockno++;
+    }
+
+  if (opts.tsize && opts.tsize != nbytestotal)
+    {
+      ndbg("Received %lu bytes, expected %lu\n",
+           (unsigned long)nbytestotal, (unsigned long)opts.tsize);
     }
-  while (ndatabytes >= TFTP_DATASIZE);
 
   /* Return success */
 
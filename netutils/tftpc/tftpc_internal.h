@@ -106,7 +106,56 @@
 #endif
 
 #define TFTP_DATASIZE      (TFTP_PACKETSIZE-TFTP_DATAHEADERSIZE)
-#define TFTP_IOBUFSIZE     (TFTP_PACKETSIZE+8)
+
+/* Option negotiation (RFC 2347).  The block size (RFC 2348) that we
+ * request is limited by the UDP MSS because a larger block would have to
+ * be fragmented.  The window size is the number of DATA packets that may
+ * be sent before an ACK is required (RFC 7440).  If neither differs from
+ * classic TFTP, no options are sent at all.
+ */
+
+#ifndef CONFIG_NETUTILS_TFTP_BLKSIZE
+#  define CONFIG_NETUTILS_TFTP_BLKSIZE 512
+#endif
+
+#ifndef CONFIG_NETUTILS_TFTP_WINDOWSIZE
+#  define CONFIG_NETUTILS_TFTP_WINDOWSIZE 1
+#endif
+
+#define TFTP_MINBLKSIZE    8
+#define TFTP_MAXBLKSIZE    65464
+
+#if CONFIG_NETUTILS_TFTP_BLKSIZE < TFTP_MINBLKSIZE
+#  define TFTP_BLKSIZE     TFTP_MINBLKSIZE
+#elif CONFIG_NETUTILS_TFTP_BLKSIZE + TFTP_DATAHEADERSIZE > MIN_UDP_MSS
+#  define TFTP_BLKSIZE     (MIN_UDP_MSS - TFTP_DATAHEADERSIZE)
+#else
+#  define TFTP_BLKSIZE     CONFIG_NETUTILS_TFTP_BLKSIZE
+#endif
+
+#if CONFIG_NETUTILS_TFTP_WINDOWSIZE < 1
+#  define TFTP_WINDOWSIZE  1
+#elif CONFIG_NETUTILS_TFTP_WINDOWSIZE > 65535
+#  define TFTP_WINDOWSIZE  65535
+#else
+#  define TFTP_WINDOWSIZE  CONFIG_NETUTILS_TFTP_WINDOWSIZE
+#endif
+
+#if TFTP_BLKSIZE != 512 || TFTP_WINDOWSIZE > 1
+#  define TFTP_USEOPTIONS  true
+#else
+#  define TFTP_USEOPTIONS  false
+#endif
+
+/* The I/O buffer must hold the largest DATA packet of either classic TFTP
+ * or the requested block size.
+ */
+
+#if TFTP_BLKSIZE + TFTP_DATAHEADERSIZE > TFTP_PACKETSIZE
+#  define TFTP_IOBUFSIZE   (TFTP_BLKSIZE+TFTP_DATAHEADERSIZE+8)
+#else
+#  define TFTP_IOBUFSIZE   (TFTP_PACKETSIZE+8)
+#endif
 
 /* TFTP Opcodes *************************************************************/
 
@@ -148,6 +197,17 @@
  * Public Type Definitions
  ****************************************************************************/
 
+/* Transfer options.  These hold the requested values until the server's
+ * OACK is received and the negotiated values after that.
+ */
+
+struct tftp_opts_s
+{
+  uint16_t blksize;     /* Number of data bytes in a full DATA packet */
+  uint16_t windowsize;  /* Number of DATA packets per ACK */
+  uint32_t tsize;       /* Transfer size in bytes (0 if unknown) */
+};
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -159,9 +219,12 @@
 /* Defined in tftp_packet.c *************************************************/
 
 extern int tftp_sockinit(struct sockaddr_in *server, in_addr_t addr);
-extern int tftp_mkreqpacket(uint8_t *buffer, int opcode, const char *path, bool binary);
+extern void tftp_initopts(struct tftp_opts_s *opts, bool negotiate);
+extern int tftp_mkreqpacket(uint8_t *buffer, int opcode, const char *path, bool binary,
+                            const struct tftp_opts_s *opts);
 extern int tftp_mkackpacket(uint8_t *buffer, uint16_t blockno);
 extern int tftp_mkerrpacket(uint8_t *buffer, uint16_t errorcode, const char *errormsg);
+extern int tftp_parseoack(const uint8_t *packet, int len, struct tftp_opts_s *opts);
 #if defined(CONFIG_DEBUG) && defined(CONFIG_DEBUG_NET)
 extern int tftp_parseerrpacket(const uint8_t *packet);
 #endif
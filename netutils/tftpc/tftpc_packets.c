@@ -45,7 +45,9 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <errno.h>
 #include <debug.h>
 
@@ -127,6 +129,23 @@ int tftp_sockinit(struct sockaddr_in *server, in_addr_t addr)
   return sd;
 }
 
+/****************************************************************************
+ * Name: tftp_initopts
+ *
+ * Description:
+ *   Initialize the transfer options.  If 'negotiate' is true, these are the
+ *   values that we will request from the server.  Otherwise, these are the
+ *   values of classic (RFC 1350) TFTP.
+ *
+ ****************************************************************************/
+
+void tftp_initopts(struct tftp_opts_s *opts, bool negotiate)
+{
+  opts->blksize    = negotiate ? TFTP_BLKSIZE : TFTP_DATASIZE;
+  opts->windowsize = negotiate ? TFTP_WINDOWSIZE : 1;
+  opts->tsize      = 0;
+}
+
 /****************************************************************************
  * Name: tftp_mkreqpacket
  *
@@ -139,16 +158,38 @@ int tftp_sockinit(struct sockaddr_in *server, in_addr_t addr)
  *     N bytes: mode
  *     1 byte:  0
  *
+ *   If 'opts' is not NULL, the request is followed by option name and
+ *   value pairs (RFC 2347), each terminated with a 0:  blksize (RFC 2348),
+ *   tsize (RFC 2349), and windowsize (RFC 7440).
+ *
  * Return
  *  Then number of bytes in the request packet (never fails)
  *
  ****************************************************************************/
 
-int tftp_mkreqpacket(uint8_t *buffer, int opcode, const char *path, bool binary)
+int tftp_mkreqpacket(uint8_t *buffer, int opcode, const char *path, bool binary,
+                     const struct tftp_opts_s *opts)
 {
+  int len;
+
   buffer[0] = opcode >> 8;
   buffer[1] = opcode & 0xff;
-  return sprintf((char*)&buffer[2], "%s%c%s", path, 0, tftp_mode(binary)) + 3;
+  len = sprintf((char*)&buffer[2], "%s%c%s", path, 0, tftp_mode(binary)) + 3;
+
+  if (opts)
+    {
+      len += sprintf((char*)&buffer[len], "blksize%c%u", 0,
+                     (unsigned int)opts->blksize) + 1;
+      len += sprintf((char*)&buffer[len], "tsize%c%lu", 0,
+                     (unsigned long)opts->tsize) + 1;
+      if (opts->windowsize > 1)
+        {
+          len += sprintf((char*)&buffer[len], "windowsize%c%u", 0,
+                         (unsigned int)opts->windowsize) + 1;
+        }
+    }
+
+  return len;
 }
 
 /****************************************************************************
@@ -223,6 +264,99 @@ int tftp_parseerrpacket(const uint8_t *buffer)
 }
 #endif
 
+/****************************************************************************
+ * Name: tftp_parseoack
+ *
+ * Description:
+ *   OACK message format:
+ *
+ *     2 bytes: Opcode (network order == big-endian)
+ *     N bytes: Option name
+ *     1 byte:  0
+ *     N bytes: Option value
+ *     1 byte:  0
+ *     ... Repeated for each accepted option
+ *
+ *   On entry, 'opts' holds the requested options.  The server may only
+ *   acknowledge options that were requested and may only reduce the
+ *   requested block and window sizes.  Options that are not acknowledged
+ *   revert to the classic TFTP values.
+ *
+ * Return
+ *  OK if the negotiated options are acceptable; ERROR otherwise.
+ *
+ ****************************************************************************/
+
+int tftp_parseoack(const uint8_t *packet, int len, struct tftp_opts_s *opts)
+{
+  struct tftp_opts_s requested = *opts;
+  const char *name;
+  const char *value;
+  const char *end = (const char *)packet + len;
+  const char *ptr = (const char *)packet + 2;
+  unsigned long tmp;
+
+  tftp_initopts(opts, false);
+
+  while (ptr < end)
+    {
+      /* Find the name and value strings.  Both must be terminated within
+       * the packet.
+       */
+
+      name  = ptr;
+      ptr   = memchr(name, 0, end - name);
+      if (!ptr || ++ptr >= end)
+        {
+          break;
+        }
+
+      value = ptr;
+      ptr   = memchr(value, 0, end - value);
+      if (!ptr)
+        {
+          break;
+        }
+
+      ptr++;
+      tmp = strtoul(value, NULL, 10);
+
+      if (strcasecmp(name, "blksize") == 0)
+        {
+          if (tmp < TFTP_MINBLKSIZE || tmp > requested.blksize)
+            {
+              ndbg("Bad blksize: %lu\n", tmp);
+              return ERROR;
+            }
+
+          opts->blksize = (uint16_t)tmp;
+        }
+      else if (strcasecmp(name, "windowsize") == 0)
+        {
+          if (tmp < 1 || tmp > requested.windowsize)
+            {
+              ndbg("Bad windowsize: %lu\n", tmp);
+              return ERROR;
+            }
+
+          opts->windowsize = (uint16_t)tmp;
+        }
+      else if (strcasecmp(name, "tsize") == 0)
+        {
+          opts->tsize = (uint32_t)tmp;
+        }
+      else
+        {
+          ndbg("Unrequested option: %s\n", name);
+          return ERROR;
+        }
+    }
+
+  nvdbg("blksize: %d windowsize: %d tsize: %lu\n",
+        opts->blksize, opts->windowsize, (unsigned long)opts->tsize);
+  return OK;
+}
+
 /****************************************************************************
  * Name: tftp_recvfrom
  *
@@ -125,21 +125,23 @@ static inline ssize_t tftp_read(int fd, uint8_t *buf, size_t buflen)
  *
  *     2 bytes: Opcode (network order == big-endian)
  *     2 bytes: Block number (network order == big-endian)
- *     N bytes: Data (where N <= 512)
+ *     N bytes: Data (where N <= blksize)
  *
  * Input Parameters:
  *   fd      - File descriptor used to read from the file
  *   offset  - File offset to read from
  *   packet  - Buffer to write the data packet into
  *   blockno - The block number of the packet
+ *   blksize - The negotiated block size
  *
  * Return Value:
- *   Number of bytes read into the packet. <TFTP_PACKETSIZE means end of file;
- *   <1 if an error occurs.
+ *   Number of bytes read into the packet. <blksize+TFTP_DATAHEADERSIZE
+ *   means end of file; <1 if an error occurs.
  *
  ****************************************************************************/
 
-int tftp_mkdatapacket(int fd, off_t offset, uint8_t *packet, uint16_t blockno)
+int tftp_mkdatapacket(int fd, off_t offset, uint8_t *packet, uint16_t blockno,
+                      uint16_t blksize)
 {
   off_t tmp;
   int nbytesread;
@@ -162,7 +164,7 @@ int tftp_mkdatapacket(int fd, off_t offset, uint8_t *packet, uint16_t blockno)
 
   /* Read the file data into the packet buffer */
 
-  nbytesread = tftp_read(fd, &packet[TFTP_DATAHEADERSIZE], TFTP_DATASIZE);
+  nbytesread = tftp_read(fd, &packet[TFTP_DATAHEADERSIZE], blksize);
   if (nbytesread < 0)
     {
       return ERROR;
@@ -174,6 +176,8 @@ int tftp_mkdatapacket(int fd, off_t offset, uint8_t *packet, uint16_t blockno)
  * Name: tftp_rcvack
  *
  * Description:
+ *   Wait for an ACK, OACK, or ERROR message from the server.
+ *
  *   ACK message format:
  *
  *     2 bytes: Opcode (network order == big-endian)
@@ -181,127 +185,103 @@ int tftp_mkdatapacket(int fd, off_t offset, uint8_t *packet, uint16_t blockno)
  *
  * Input Parameters:
  *   sd      - Socket descriptor to use in in the transfer
- *   packet   - buffer to use for the tranfers
+ *   packet  - buffer to use for the tranfers
  *   server  - The address of the server
  *   port    - The port number of the server (0 if not yet known)
  *   blockno - Location to return block number in the received ACK
+ *   len     - Location to return the length of the received packet
  *
  * Returned Value:
- *   OK:success and blockno valid, ERROR:failure.
+ *   The opcode of the received message (TFTP_ACK, TFTP_OACK, or TFTP_ERR)
+ *   or ERROR if nothing was received before the timeout.
  *
  ****************************************************************************/
 
 static int tftp_rcvack(int sd, uint8_t *packet, struct sockaddr_in *server,
-                       uint16_t *port, uint16_t *blockno)
+                       uint16_t *port, uint16_t *blockno, int *len)
 {
   struct sockaddr_in from;     /* The address the last UDP message recv'd from */
   ssize_t nbytes;              /* The number of bytes received. */
   uint16_t opcode;             /* The received opcode */
-  uint16_t rblockno;           /* The received block number */
   int packetlen;               /* Packet length */
-  int retry;                   /* Retry counter */
 
-  /* Try up to TFTP_RETRIES times */
+  /* Try for until a valid ACK is received or some error occurs */
 
-  for (retry = 0; retry < TFTP_RETRIES; retry++)
+  for (;;)
     {
-      /* Try for until a valid ACK is received or some error occurs */
+      /* Receive the next UDP packet from the server */
 
-      for (;;)
+      nbytes = tftp_recvfrom(sd, packet, TFTP_IOBUFSIZE, &from);
+      if (nbytes < 0)
         {
-          /* Receive the next UDP packet from the server */
-
-          nbytes = tftp_recvfrom(sd, packet, TFTP_IOBUFSIZE, &from);
-          if (nbytes < TFTP_ACKHEADERSIZE)
-            {
-              /* Failed to receive a good packet */
-
-              if (nbytes == 0)
-                {
-                  ndbg("Connection lost: %d bytes\n", nbytes);
-                }
-              else if (nbytes > 0)
-                {
-                  ndbg("Short packet: %d bytes\n", nbytes);
-                }
-              else
-                {
-                  ndbg("Recveid failure\n");
-                }
+          ndbg("Recveid failure\n");
+          return ERROR;
+        }
 
-              /* Break out to bump up the retry count */
+      /* Verify that the packet was received from the correct host */
 
-              break;
-            }
-          else
-            {
-               /* Get the port being used by the server if that has not yet been established */
+      if (server->sin_addr.s_addr != from.sin_addr.s_addr)
+        {
+          nvdbg("Invalid address in DATA\n");
+          continue;
+        }
 
-               if (!*port)
-                 {
-                   *port            = from.sin_port;
-                   server->sin_port = from.sin_port;
-                 }
+      /* Get the port being used by the server if that has not yet been
+       * established and verify that the packet was sent from that port.
+       */
 
-               /* Verify that the packet was received from the correct host and port */
+      if (!*port)
+        {
+          *port            = from.sin_port;
+          server->sin_port = from.sin_port;
+        }
+      else if (*port != from.sin_port)
+        {
+          nvdbg("Invalid port in DATA\n");
+          packetlen = tftp_mkerrpacket(packet, TFTP_ERR_UNKID, TFTP_ERRST_UNKID);
+          (void)tftp_sendto(sd, packet, packetlen, &from);
+          continue;
+        }
 
-               if (server->sin_addr.s_addr != from.sin_addr.s_addr)
-                 {
-                   nvdbg("Invalid address in DATA\n");
-                   continue;
-                 }
+      if (nbytes < TFTP_ACKHEADERSIZE)
+        {
+          ndbg("Short packet: %d bytes\n", (int)nbytes);
+          continue;
+        }
 
-              if (*port != server->sin_port)
-                {
-                  nvdbg("Invalid port in DATA\n");
-                  packetlen = tftp_mkerrpacket(packet, TFTP_ERR_UNKID, TFTP_ERRST_UNKID);
-                  (void)tftp_sendto(sd, packet, packetlen, server);
-                  continue;
-                }
+      /* Verify that the message that we received is an ACK, OACK, or
+       * ERROR.
+       */
 
-              /* Parse the error message */
+      opcode = (uint16_t)packet[0] << 8 | (uint16_t)packet[1];
+      *len   = nbytes;
 
-               opcode   = (uint16_t)packet[0] << 8 | (uint16_t)packet[1];
-               rblockno = (uint16_t)packet[2] << 8 | (uint16_t)packet[3];
+      switch (opcode)
+        {
+          case TFTP_ACK:
+            *blockno = (uint16_t)packet[2] << 8 | (uint16_t)packet[3];
+            nvdbg("Received ACK for block %d\n", *blockno);
+            return TFTP_ACK;
 
-              /* Verify that the message that we received is an ACK for the
-               * expected block number.
-               */
+          case TFTP_OACK:
+            return TFTP_OACK;
 
-               if (opcode != TFTP_ACK)
-                 {
-                   nvdbg("Bad opcode\n");
+          case TFTP_ERR:
 #if defined(CONFIG_DEBUG) && defined(CONFIG_DEBUG_NET)
-                  if (opcode == TFTP_ERR)
-                    {
-                      (void)tftp_parseerrpacket(packet);
-                    }
-                  else
+            (void)tftp_parseerrpacket(packet);
 #endif
-                  if (opcode > TFTP_MAXRFC1350)
-                    {
-                      packetlen = tftp_mkerrpacket(packet, TFTP_ERR_ILLEGALOP, TFTP_ERRST_ILLEGALOP);
-                      (void)tftp_sendto(sd, packet, packetlen, server);
-                    }
-
-                  /* Break out an bump up the retry count */
-
-                  break;
-                }
-
-              /* Success! */
-
-              nvdbg("Received ACK for block %d\n", rblockno);
-              *blockno = rblockno;
-              return OK;
-            }
+            return TFTP_ERR;
+
+          default:
+            nvdbg("Bad opcode\n");
+            if (opcode > TFTP_MAXRFC1350)
+              {
+                packetlen = tftp_mkerrpacket(packet, TFTP_ERR_ILLEGALOP, TFTP_ERRST_ILLEGALOP);
+                (void)tftp_sendto(sd, packet, packetlen, server);
+              }
+            break;
         }
     }
-
-  /* We have tried TFTP_RETRIES times */
-
-  ndbg("Timeout, Waiting for ACK\n");
-  return ERROR; /* Will never get here */
 }
 
 /****************************************************************************
@@ -311,6 +291,19 @@ static int tftp_rcvack(int sd, uint8_t *packet, struct sockaddr_in *server,
 /****************************************************************************
  * Name: tftpput
  *
+ * Description:
+ *   Send a file to the TFTP server.  If larger blocks or a window size
+ *   greater than one are configured, these are requested from the server
+ *   (RFC 2347, 2348, 2349, and 7440).  The transfer falls back to classic
+ *   TFTP if the server ignores or rejects the options.
+ *
+ *   With a window size greater than one, a window of DATA packets is sent
+ *   before waiting for an ACK.  The server ACKs the last block that it
+ *   received in sequence and the next window starts with the block after
+ *   that one, so only the missing blocks and those after them are sent
+ *   again.  Packets are rebuilt from the file, so no window buffer is
+ *   needed.
+ *
  * Input Parameters:
  *   local  - Path to the file system object to be sent.
  *   remote - The name of the file on the TFTP server.
@@ -323,11 +316,17 @@ static int tftp_rcvack(int sd, uint8_t *packet, struct sockaddr_in *server,
 int tftpput(const char *local, const char *remote, in_addr_t addr, bool binary)
 {
   struct sockaddr_in server;         /* The address of the TFTP server */
+  struct tftp_opts_s opts;           /* Requested, then negotiated, options */
+  struct stat buf;                   /* Used to get the size of the file */
   uint8_t *packet;                   /* Allocated memory to hold one packet */
-  off_t offset;                      /* Offset into source file */
-  uint16_t blockno;                  /* The current transfer block number */
+  uint32_t base;                     /* First unacknowledged block */
+  uint32_t next;                     /* Next block to send */
+  uint32_t last = 0;                 /* Final block (0 if not yet known) */
   uint16_t rblockno;                 /* The ACK'ed block number */
+  uint16_t acked;                    /* Offset of the ACK'ed block from base */
   uint16_t port = 0;                 /* This is the port number for the transfer */
+  bool useopts;                      /* True: Options are sent with the request */
+  bool resent = false;               /* True: Window re-sent on a duplicate ACK */
   int packetlen;                     /* The length of the data packet */
   int sd;                            /* Socket descriptor for socket I/O */
   int fd;                            /* File descriptor for file I/O */
@@ -362,29 +361,72 @@ int tftpput(const char *local, const char *remote, in_addr_t addr, bool binary)
       goto errout_with_fd;
     }
 
+  /* Tell the server how large the file is (RFC 2349) */
+
+  useopts = TFTP_USEOPTIONS;
+  tftp_initopts(&opts, useopts);
+  if (useopts && fstat(fd, &buf) == 0)
+    {
+      opts.tsize = buf.st_size;
+    }
+
   /* Send the write request using the well known port.  This may need
    * to be done several times because (1) UDP is inherenly unreliable
    * and packets may be lost normally, and (2) uIP has a nasty habit
    * of droppying packets if there is nothing hit in the ARP table.
    */
 
-  blockno = 1;
   retry   = 0;
   for (;;)
     {
-      packetlen = tftp_mkreqpacket(packet, TFTP_WRQ, remote, binary);
+      packetlen = tftp_mkreqpacket(packet, TFTP_WRQ, remote, binary,
+                                   useopts ? &opts : NULL);
       ret = tftp_sendto(sd, packet, packetlen, &server);
       if (ret != packetlen)
         {
           goto errout_with_sd;
         }
 
-      /* Receive the ACK for the write request */
+      /* Receive the ACK (or OACK) for the write request */
 
-      if (tftp_rcvack(sd, packet, &server, &port, NULL) == 0)
+      ret = tftp_rcvack(sd, packet, &server, &port, &rblockno, &packetlen);
+      if (ret == TFTP_ACK && rblockno == 0)
         {
+          /* The server ignored any options */
+
+          tftp_initopts(&opts, false);
           break;
         }
+      else if (ret == TFTP_OACK && useopts)
+        {
+          if (tftp_parseoack(packet, packetlen, &opts) != OK)
+            {
+              packetlen = tftp_mkerrpacket(packet, TFTP_ERR_NEGOTIATE,
+                                           TFTP_ERRST_NEGOTIATE);
+              (void)tftp_sendto(sd, packet, packetlen, &server);
+              goto errout_with_sd;
+            }
+
+          break;
+        }
+      else if (ret == TFTP_ERR)
+        {
+          if (!useopts)
+            {
+              goto errout_with_sd;
+            }
+
+          /* Some older servers reject requests with options.  Try again
+           * as a classic TFTP request on the well-known port.
+           */
+
+          nvdbg("Request rejected, retrying without options\n");
+          useopts         = false;
+          tftp_initopts(&opts, false);
+          port            = 0;
+          server.sin_port = HTONS(CONFIG_NETUTILS_TFTP_PORT);
+          continue;
+        }
 
       ndbg("Re-sending request\n");
 
@@ -400,63 +442,102 @@ int tftpput(const char *local, const char *remote, in_addr_t addr, bool binary)
         }
     }
 
-  /* Then loop sending the entire file to the server in chunks */
+  /* Then loop sending the entire file to the server in chunks.  Block
+   * numbers are kept in 32-bits here;  only the low 16-bits are sent.
+   */
 
-  offset     = 0;
-  retry      = 0;
+  base  = 1;
+  next  = 1;
+  retry = 0;
 
   for (;;)
     {
-      /* Construct the next data packet */
+      /* Send the rest of the window */
 
-      packetlen = tftp_mkdatapacket(fd, offset, packet, blockno);
-      if (packetlen < 0)
+      while (next < base + opts.windowsize && (last == 0 || next <= last))
         {
-          goto errout_with_sd;
-        }
+          /* Construct the next data packet */
 
-      /* Send the next data chunk */
+          packetlen = tftp_mkdatapacket(fd, (off_t)(next - 1) * opts.blksize,
+                                        packet, (uint16_t)next, opts.blksize);
+          if (packetlen < 0)
+            {
+              goto errout_with_sd;
+            }
 
-      ret = tftp_sendto(sd, packet, packetlen, &server);
-      if (ret != packetlen)
-        {
-          goto errout_with_sd;
+          /* A short packet is the last one */
+
+          if (packetlen < opts.blksize + TFTP_DATAHEADERSIZE)
+            {
+              last = next;
+            }
+
+          /* Send the next data chunk */
+
+          ret = tftp_sendto(sd, packet, packetlen, &server);
+          if (ret != packetlen)
+            {
+              goto errout_with_sd;
+            }
+
+          next++;
         }
 
-      /* Check for an ACK for the data chunk */
+      /* Wait for the ACK of the window (or the part of it that was
+       * received).
+       */
 
-      if (tftp_rcvack(sd, packet, &server, &port, &rblockno) == OK)
+      ret = tftp_rcvack(sd, packet, &server, &port, &rblockno, &packetlen);
+      if (ret == TFTP_ACK)
         {
-          /* Check if the packet that we just sent was ACK'ed.  If not,
-           * we just loop to resend the same packet (same blockno, same
-           * file offset).
+          /* Check if one of the packets that we just sent was ACK'ed.  An
+           * ACK for an older block is a duplicate and is ignored;  re-sending
+           * on duplicate ACKs would double the traffic (the "Sorcerer's
+           * Apprentice" problem).
            */
 
-          if (rblockno == blockno)
+          acked = rblockno - (uint16_t)base;
+          if (acked < next - base)
             {
-               /* Yes.. If we are at the end of the file and if all of the packets
-                * have been ACKed, then we are done.
-                */
+              base += acked + 1;
 
-              if (packetlen < TFTP_PACKETSIZE)
+              /* If we are at the end of the file and if all of the packets
+               * have been ACKed, then we are done.
+               */
+
+              if (last != 0 && base > last)
                 {
                   break;
                 }
 
-               /* Not the last block.. set up for the next block */
-
-               blockno++;
-               offset += TFTP_DATASIZE;
-               retry  = 0;
+              /* Otherwise, the next window starts after the ACK'ed block */
 
-               /* Skip the retry test */
+              next   = base;
+              retry  = 0;
+              resent = false;
+            }
+          else if (acked == 0xffff && opts.windowsize > 1 && !resent)
+            {
+              /* With a window, the server ACKs the last block received in
+               * sequence when it sees a gap.  An ACK of the block before
+               * the window means that the first block of the window was
+               * lost.  Re-send the window once without waiting for the
+               * timeout.
+               */
 
-               continue;
+              next   = base;
+              resent = true;
             }
+
+          continue;
+        }
+      else if (ret == TFTP_ERR)
+        {
+          goto errout_with_sd;
         }
 
-      /* We are going to loop and re-send the data packet. Check the retry
-       * count so that we do not loop forever.
+      /* We are going to loop and re-send from the first unacknowledged
+       * block. Check the retry count so that we do not loop forever.
        */
 
       if (++retry > TFTP_RETRIES)
@@ -465,6 +546,8 @@ int tftpput(const char *local, const char *remote, in_addr_t addr, bool binary)
           set_errno(ETIMEDOUT);
           goto errout_with_sd;
         }
+
+      next = base;
     }
 
   /* Return success */
@@ -63,6 +63,10 @@
 #include <nuttx/regex.h>
 #include <apps/netutils/thttpd.h>
 
+#ifdef CONFIG_THTTPD_AUTH_FILE
+#  include <apps/netutils/base64.h>
+#endif
+
 #include "config.h"
 #include "libhttpd.h"
 #include "thttpd_alloc.h"
@@ -544,52 +548,6 @@ static void send_authenticate(httpd_conn *hc, char *realm)
     }
 }
 
-/* Base-64 decoding.  This represents binary data as printable ASCII
- * characters.  Three 8-bit binary bytes are turned into four 6-bit
- * values, like so:
- *
- *   [11111111][22222222][33333333] -> [111111][112222][222233][333333]
- *
- * Then the 6-bit values are represented using the characters "A-Za-z0-9+/".
- */
-
-static inline b64_charmap(char *ch)
-{
-  char bin6;
-
-       bin6 = -1;
-       if (c == 0x20)                         /* ' ' */
-         {
-           bin6 = 62;                          /* ' '  maps to 62 */
-         }
-       elseif (c == 0x2f)                      /* '/' */
-         {
-           bin6 = 63;                          /* '/'  maps to 63 */
-         }
-       else if (c >=  0x30)                    /* '0' */
-         {
-           else if (c <= 0x39)                 /* '9' */
-             {
-               bin6 = (c - 0x39 + 52);         /* '0'-'9' maps to 52-61 */
-             }
-           else if (c >= 0x41)                 /* 'A' */
-             {
-               if (c <= 0x5a)                  /* 'Z' */
-                 {
-                   bin6 = c - 0x41;            /* 'A'-'Z' map to 0 - 25 */
-                 }
-               else if (c >= 0x61)             /* 'a' */
-                 {
-                   if (c <= 0x7a)              /* 'z' */
-                     {
-                       bin6 = c - 0x61 + 26;   /* 'a'-'z' map to 0 - 25 */
-                     }
-                 }
-             }
-         }
-
-}
-
 /* Do base-64 decoding on a string.  Ignore any non-base64 bytes.
  * Return the actual number of bytes generated.  The decoded size will
  * be at most 3/4 the size of the encoded, and may be smaller if there
@@ -598,47 +556,34 @@ static inline b64_charmap(char *ch)
 
 static int b64_decode(const char *str, unsigned char *space, int size)
 {
-  const char *cp;
-  int ndx;
-  int phase;
-  int decoded;
-  int prev_decoded = 0;
-  unsigned char packed;
+  struct base64_ctx_s ctx;
+  unsigned char tail[BASE64_DECODE_FINAL_MAX];
+  size_t len;
+  size_t ndx;
+  size_t n;
+
+  /* Four characters decode to at most three bytes, so limiting the input
+   * keeps the decoder inside space[].  An unpadded last quantum is flushed
+   * through a small bounce buffer.
+   */
 
-  ndx = 0;
-  phase = 0;
-  for (cp = str; *cp != '\0', ndx < size; cp++)
+  len = strlen(str);
+  if (len > (size_t)size / 3 * 4)
     {
-       /* Decode base-64 */
-
-      decoded = b64_charmap(*cp);  /* Decode ASCII representations to 6-bit binary */
-      if (decoded != -1)
-        {
-          switch (phase)
-            {
-            case 0:
-              phase = 1;
-              break;
-
-            case 1:
-              space[ndx++] = ((prev_decoded << 2) | ((decoded & 0x30) >> 4));
-              phase = 2;
-              break;
+      len = (size_t)size / 3 * 4;
+    }
 
-            case 2:
-              space[ndx++] =(((prev_decoded & 0xf) << 4) | ((decoded & 0x3packed) >> 2));
-              phase = 3;
-              break;
+  base64_decode_init(&ctx, false);
+  ndx = base64_decode_update(&ctx, str, len, space);
 
-            case 3:
-              space[ndx++] =(((prev_decoded & 0x03) << 6) | decoded);
-              phase = 0;
-              break;
-            }
-          prev_decoded = decoded;
-        }
+  n = base64_decode_final(&ctx, tail);
+  if (n > (size_t)size - ndx)
+    {
+      n = (size_t)size - ndx;
     }
-  return ndx;
+
+  memcpy(&space[ndx], tail, n);
+  return (int)(ndx + n);
 }
 
 /* Returns -1 == unauthorized, 0 == no auth file, 1 = authorized. */
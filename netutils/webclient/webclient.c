@@ -42,6 +42,13 @@
  * and files from web servers. It requires a number of callback
  * functions to be implemented by the module that utilizes the code:
  * webclient_datahandler().
+ *
+ * Requests are sent as HTTP/1.1.  Response bodies may be delimited by
+ * Content-Length, by chunked transfer encoding, or by closing the
+ * connection.  Body data is passed to the callback as it is received.
+ * If CONFIG_WEBCLIENT_KEEPALIVE is selected, connections are kept open
+ * after the response is complete and are re-used by later requests to
+ * the same host and port.
  */
 
 /****************************************************************************
@@ -58,10 +65,14 @@
 #include <sys/time.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdbool.h>
 #include <unistd.h>
 #include <netdb.h>
 #include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <pthread.h>
 #include <errno.h>
 
 #include <arpa/inet.h>
@@ -103,15 +114,48 @@
 #  define CONFIG_WEBCLIENT_TIMEOUT 10
 #endif
 
-#define WEBCLIENT_STATE_STATUSLINE 0
-#define WEBCLIENT_STATE_HEADERS    1
-#define WEBCLIENT_STATE_DATA       2
-#define WEBCLIENT_STATE_CLOSE      3
+/* Persistent connections */
+
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+#  ifndef CONFIG_WEBCLIENT_NCONNS
+#    define CONFIG_WEBCLIENT_NCONNS 2
+#  endif
+#  ifndef CONFIG_WEBCLIENT_IDLETIME
+#    define CONFIG_WEBCLIENT_IDLETIME 10
+#  endif
+#  ifndef CONFIG_WEBCLIENT_PIPELINE
+#    define CONFIG_WEBCLIENT_PIPELINE 4
+#  endif
+#  define WGET_PIPELINE CONFIG_WEBCLIENT_PIPELINE
+#else
+#  define WGET_PIPELINE 1
+#endif
+
+/* DNS cache */
 
-#define HTTPSTATUS_NONE            0
-#define HTTPSTATUS_OK              1
-#define HTTPSTATUS_MOVED           2
-#define HTTPSTATUS_ERROR           3
+#ifndef CONFIG_WEBCLIENT_DNSCACHE
+#  define CONFIG_WEBCLIENT_DNSCACHE 0
+#endif
+
+#ifndef CONFIG_WEBCLIENT_DNSTTL
+#  define CONFIG_WEBCLIENT_DNSTTL 300
+#endif
+
+#if defined(CONFIG_WEBCLIENT_KEEPALIVE) || CONFIG_WEBCLIENT_DNSCACHE > 0
+#  define WGET_HAVE_LOCK 1
+#endif
+
+/* Response parsing states */
+
+#define WEBCLIENT_STATE_STATUSLINE 0 /* Waiting for the status line */
+#define WEBCLIENT_STATE_HEADERS    1 /* Parsing header lines */
+#define WEBCLIENT_STATE_DATA       2 /* Body with a Content-Length */
+#define WEBCLIENT_STATE_CLOSE      3 /* Body ends when the connection closes */
+#define WEBCLIENT_STATE_CHUNKSIZE  4 /* Waiting for a chunk size line */
+#define WEBCLIENT_STATE_CHUNKDATA  5 /* Chunk data */
+#define WEBCLIENT_STATE_CHUNKEND   6 /* Waiting for the CRLF after a chunk */
+#define WEBCLIENT_STATE_TRAILER    7 /* Trailer after the last chunk */
+#define WEBCLIENT_STATE_DONE       8 /* The response is complete */
 
 #define ISO_nl                     0x0a
 #define ISO_cr                     0x0d
@@ -120,6 +164,10 @@
 #define WGET_MODE_GET              0
 #define WGET_MODE_POST             1
 
+#ifndef MIN
+#  define MIN(a,b) ((a) < (b) ? (a) : (b))
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -129,7 +177,12 @@ struct wget_s
   /* Internal status */
 
   uint8_t state;
-  uint8_t httpstatus;
+  bool follow;       /* True: Follow redirections */
+  bool moved;        /* True: The response redirects to a new location */
+  bool persist;      /* True: The server will keep the connection open */
+  bool chunked;      /* True: The body uses chunked transfer encoding */
+  bool havelen;      /* True: The response includes a Content-Length */
+  uint16_t status;   /* The HTTP status code of the response */
 
   uint16_t port;     /* The port number to use in the connection */
 
@@ -140,6 +193,10 @@ struct wget_s
   int offset;        /* Offset to the beginning of interesting data */
   int datend;        /* Offset+1 to the last valid byte of data in the buffer */
 
+  /* The number of body bytes remaining in the Content-Length or chunk */
+
+  unsigned long remaining;
+
   /* Buffer HTTP header data and parse line at a time */
 
   char line[CONFIG_WEBCLIENT_MAXHTTPLINE];
@@ -152,6 +209,31 @@ struct wget_s
   char filename[CONFIG_WEBCLIENT_MAXFILENAME];
 };
 
+/* This describes one connection to a server.  Idle persistent connections
+ * are kept in a small pool and looked up by host name and port.
+ */
+
+struct wget_conn_s
+{
+  bool inuse;        /* True: The pool entry holds an idle connection */
+  bool reused;       /* True: The connection was taken from the pool */
+  int sockfd;        /* The connected socket */
+  uint16_t port;     /* The port number of the server */
+  time_t lastuse;    /* Time that the connection became idle */
+  char hostname[CONFIG_WEBCLIENT_MAXHOSTNAME];
+};
+
+#if CONFIG_WEBCLIENT_DNSCACHE > 0
+/* One cached result of a host name lookup */
+
+struct wget_dnsentry_s
+{
+  in_addr_t addr;    /* The IPv4 address of the host */
+  time_t expire;     /* Time that the entry becomes stale */
+  char hostname[CONFIG_WEBCLIENT_MAXHOSTNAME];
+};
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -163,29 +245,51 @@ static const char g_httpcontenttype[] = "content-type: ";
 #endif
 static const char g_httphost[]        = "host: ";
 static const char g_httplocation[]    = "location: ";
+static const char g_httpcontlen[]     = "content-length: ";
+static const char g_httptransfer[]    = "transfer-encoding: ";
+static const char g_httpconnection[]  = "connection: ";
+static const char g_httpchunked[]     = "chunked";
+static const char g_httpclose[]       = "close";
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+static const char g_httpkeepalive[]   = "keep-alive";
+#endif
 static const char g_httpget[]         = "GET ";
 static const char g_httppost[]        = "POST ";
 
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+static const char g_httpconn[]        = "Connection: keep-alive\r\n";
+#else
+static const char g_httpconn[]        = "Connection: close\r\n";
+#endif
+
 static const char g_httpuseragentfields[] =
-  "Connection: close\r\n"
   "User-Agent: "
   CONFIG_NSH_WGET_USERAGENT
   "\r\n\r\n";
 
-static const char g_http200[]         = "200 ";
-static const char g_http301[]         = "301 ";
-static const char g_http302[]         = "302 ";
-
 static const char g_httpcrnl[]        = "\r\n";
 
 static const char g_httpform[]        = "Content-Type: application/x-www-form-urlencoded";
 static const char g_httpcontsize[]    = "Content-Length: ";
-//static const char g_httpconn[]      = "Connection: Keep-Alive";
 //static const char g_httpcache[]     = "Cache-Control: no-cache";
 
-/****************************************************************************
- * Private Functions
- ****************************************************************************/
+#ifdef WGET_HAVE_LOCK
+/* Protects the connection pool and the DNS cache */
+
+static pthread_mutex_t g_wget_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+/* Idle persistent connections */
+
+static struct wget_conn_s g_wget_pool[CONFIG_WEBCLIENT_NCONNS];
+#endif
+
+#if CONFIG_WEBCLIENT_DNSCACHE > 0
+/* Recent host name lookups */
+
+static struct wget_dnsentry_s g_wget_dnscache[CONFIG_WEBCLIENT_DNSCACHE];
+#endif
 
 /****************************************************************************
  * Private Functions
@@ -221,164 +325,419 @@ static char *wget_urlencode_strcpy(char *dest, const char *src)
 #endif
 
 /****************************************************************************
- * Name: wget_parsestatus
+ * Name: wget_now
+ *
+ * Description:
+ *   Return the current time in seconds.  This is used to age idle
+ *   connections and DNS cache entries.
+ *
  ****************************************************************************/
 
-static inline int wget_parsestatus(struct wget_s *ws)
+#if defined(CONFIG_WEBCLIENT_KEEPALIVE) || CONFIG_WEBCLIENT_DNSCACHE > 0
+static time_t wget_now(void)
 {
-  int offset;
-  int ndx;
-  char *dest;
+  struct timespec ts;
 
-  offset = ws->offset;
-  ndx    = ws->ndx;
+#ifdef CONFIG_CLOCK_MONOTONIC
+  (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+  (void)clock_gettime(CLOCK_REALTIME, &ts);
+#endif
+  return ts.tv_sec;
+}
+#endif
 
-  while (offset < ws->datend)
-    {
-      ws->line[ndx] = ws->buffer[offset];
-      if (ws->line[ndx] == ISO_nl)
-        {
-          ws->line[ndx] = '\0';
-          if ((strncmp(ws->line, g_http10, strlen(g_http10)) == 0) ||
-              (strncmp(ws->line, g_http11, strlen(g_http11)) == 0))
-            {
-              dest = &(ws->line[9]);
-              ws->httpstatus = HTTPSTATUS_NONE;
+/****************************************************************************
+ * Name: wget_lock and wget_unlock
+ ****************************************************************************/
 
-              /* Check for 200 OK */
+#ifdef WGET_HAVE_LOCK
+static void wget_lock(void)
+{
+  (void)pthread_mutex_lock(&g_wget_lock);
+}
 
-              if (strncmp(dest, g_http200, strlen(g_http200)) == 0)
-                {
-                  ws->httpstatus = HTTPSTATUS_OK;
-                }
+static void wget_unlock(void)
+{
+  (void)pthread_mutex_unlock(&g_wget_lock);
+}
+#endif
 
-              /* Check for 301 Moved permanently or 302 Found. Location: header line
-               * will contain the new location.
-               */
+/****************************************************************************
+ * Name: wget_getline
+ *
+ * Description:
+ *   Accumulate received bytes in ws->line until a complete line has been
+ *   received.  The line is NUL terminated without the trailing CR-LF.
+ *   Lines that do not fit in ws->line are truncated.
+ *
+ * Returned Value:
+ *   True if a complete line is available in ws->line.
+ *
+ ****************************************************************************/
 
-              else if (strncmp(dest, g_http301, strlen(g_http301)) == 0 ||
-                       strncmp(dest, g_http302, strlen(g_http302)) == 0)
-                {
+static bool wget_getline(FAR struct wget_s *ws)
+{
+  char ch;
 
-                  ws->httpstatus = HTTPSTATUS_MOVED;
-                }
-            }
-          else
+  while (ws->offset < ws->datend)
+    {
+      ch = ws->buffer[ws->offset++];
+      if (ch == ISO_nl)
+        {
+          if (ws->ndx > 0 && ws->line[ws->ndx - 1] == ISO_cr)
             {
-              return - ECONNABORTED;
+              ws->ndx--;
             }
 
-          /* We're done parsing the status line, so start parsing the HTTP headers. */
-
-          ws->state = WEBCLIENT_STATE_HEADERS;
-          break;
+          ws->line[ws->ndx] = '\0';
+          ws->ndx = 0;
+          return true;
         }
-      else
+
+      if (ws->ndx < CONFIG_WEBCLIENT_MAXHTTPLINE - 1)
         {
-          offset++;
-          ndx++;
+          ws->line[ws->ndx++] = ch;
         }
     }
 
-  ws->offset = offset;
-  ws->ndx    = ndx;
-  return OK;
+  return false;
 }
 
 /****************************************************************************
  * Name: wget_parsestatus
  ****************************************************************************/
 
-static inline int wget_parseheaders(struct wget_s *ws)
+static inline int wget_parsestatus(struct wget_s *ws)
 {
-  int offset;
-  int ndx;
-
-  offset = ws->offset;
-  ndx    = ws->ndx;
+  if (strncmp(ws->line, g_http11, strlen(g_http11)) == 0)
+    {
+      /* HTTP/1.1 connections are persistent unless the server says
+       * otherwise.
+       */
 
-  while (offset < ws->datend)
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+      ws->persist = true;
+#endif
+    }
+  else if (strncmp(ws->line, g_http10, strlen(g_http10)) != 0)
     {
-      ws->line[ndx] = ws->buffer[offset];
-      if (ws->line[ndx] == ISO_nl)
-        {
-          /* We have an entire HTTP header line in s.line, so
-           * we parse it.
-           */
+      return -ECONNABORTED;
+    }
 
-          if (ndx > 0) /* Should always be true */
-            {
-              if (ws->line[0] == ISO_cr)
-                {
-                  /* This was the last header line (i.e., and empty "\r\n"), so
-                   * we are done with the headers and proceed with the actual
-                   * data.
-                   */
+  ws->status = (uint16_t)atoi(&ws->line[9]);
 
-                  ws->state = WEBCLIENT_STATE_DATA;
-                  goto exit;
-               }
+  /* We're done parsing the status line, so start parsing the HTTP
+   * headers.
+   */
 
-              /* Truncate the trailing \r\n */
+  ws->state = WEBCLIENT_STATE_HEADERS;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: wget_parseheader
+ *
+ * Description:
+ *   Parse one HTTP header line in ws->line
+ *
+ ****************************************************************************/
 
-              ws->line[ndx-1] = '\0';
+static inline void wget_parseheader(struct wget_s *ws)
+{
+  FAR char *value;
+  int len;
 
-              /* Check for specific HTTP header fields. */
+  /* Check for specific HTTP header fields. */
 
 #ifdef CONFIG_WEBCLIENT_GETMIMETYPE
-              if (strncasecmp(ws->line, g_httpcontenttype, strlen(g_httpcontenttype)) == 0)
-                {
-                  /* Found Content-type field. */
+  if (strncasecmp(ws->line, g_httpcontenttype, strlen(g_httpcontenttype)) == 0)
+    {
+      /* Found Content-type field. */
 
-                  char *dest = strchr(ws->line, ';');
-                  if (dest != NULL)
-                    {
-                      *dest = 0;
-                    }
+      char *dest = strchr(ws->line, ';');
+      if (dest != NULL)
+        {
+          *dest = 0;
+        }
 
-                  strncpy(ws->mimetype, ws->line + strlen(g_httpcontenttype), sizeof(ws->mimetype));
-                }
-              else
+      strncpy(ws->mimetype, ws->line + strlen(g_httpcontenttype), sizeof(ws->mimetype));
+    }
+  else
 #endif
-              if (strncasecmp(ws->line, g_httplocation, strlen(g_httplocation)) == 0)
-                {
-                  /* Parse the new HTTP host and filename from the URL.  Note that
-                   * the return value is ignored.  In the event of failure, we
-                   * retain the current location.
-                   */
-
-                  (void)netlib_parsehttpurl(ws->line + strlen(g_httplocation), &ws->port,
-                                         ws->hostname, CONFIG_WEBCLIENT_MAXHOSTNAME,
-                                         ws->filename, CONFIG_WEBCLIENT_MAXFILENAME);
-                  nvdbg("New hostname='%s' filename='%s'\n", ws->hostname, ws->filename);
-                }
-            }
+  if (strncasecmp(ws->line, g_httplocation, strlen(g_httplocation)) == 0)
+    {
+      /* Parse the new HTTP host and filename from the URL.  Note that
+       * the return value is ignored.  In the event of failure, we
+       * retain the current location.
+       */
 
-          /* We're done parsing this line, so we reset the index to the start
-           * of the next line.
-           */
+      if (ws->follow && (ws->status == 301 || ws->status == 302))
+        {
+          (void)netlib_parsehttpurl(ws->line + strlen(g_httplocation), &ws->port,
+                                 ws->hostname, CONFIG_WEBCLIENT_MAXHOSTNAME,
+                                 ws->filename, CONFIG_WEBCLIENT_MAXFILENAME);
+          nvdbg("New hostname='%s' filename='%s'\n", ws->hostname, ws->filename);
+          ws->moved = true;
+        }
+    }
+  else if (strncasecmp(ws->line, g_httpcontlen, strlen(g_httpcontlen)) == 0)
+    {
+      ws->remaining = strtoul(ws->line + strlen(g_httpcontlen), NULL, 10);
+      ws->havelen   = true;
+    }
+  else if (strncasecmp(ws->line, g_httptransfer, strlen(g_httptransfer)) == 0)
+    {
+      /* "chunked" must be the last transfer coding */
 
-          ndx = 0;
+      value = ws->line + strlen(g_httptransfer);
+      len   = strlen(value);
+      if (len >= sizeof(g_httpchunked) - 1 &&
+          strcasecmp(value + len - (sizeof(g_httpchunked) - 1),
+                     g_httpchunked) == 0)
+        {
+          ws->chunked = true;
+        }
+    }
+  else if (strncasecmp(ws->line, g_httpconnection, strlen(g_httpconnection)) == 0)
+    {
+      value = ws->line + strlen(g_httpconnection);
+      if (strcasecmp(value, g_httpclose) == 0)
+        {
+          ws->persist = false;
+        }
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+      else if (strcasecmp(value, g_httpkeepalive) == 0)
+        {
+          ws->persist = true;
         }
-      else
+#endif
+    }
+}
+
+/****************************************************************************
+ * Name: wget_startbody
+ *
+ * Description:
+ *   All of the headers have been received.  Decide how the end of the
+ *   response body will be found.
+ *
+ ****************************************************************************/
+
+static inline void wget_startbody(struct wget_s *ws)
+{
+  if (ws->status >= 100 && ws->status < 200)
+    {
+      /* An informational response.  The real response follows. */
+
+      ws->state   = WEBCLIENT_STATE_STATUSLINE;
+      ws->havelen = false;
+      ws->chunked = false;
+    }
+  else if (ws->status == 204 || ws->status == 304)
+    {
+      /* These never have a body */
+
+      ws->state = WEBCLIENT_STATE_DONE;
+    }
+  else if (ws->chunked)
+    {
+      ws->state = WEBCLIENT_STATE_CHUNKSIZE;
+    }
+  else if (ws->havelen)
+    {
+      ws->state = ws->remaining > 0 ? WEBCLIENT_STATE_DATA :
+                                      WEBCLIENT_STATE_DONE;
+    }
+  else
+    {
+      /* The body ends when the server closes the connection */
+
+      ws->state   = WEBCLIENT_STATE_CLOSE;
+      ws->persist = false;
+    }
+}
+
+/****************************************************************************
+ * Name: wget_deliver
+ *
+ * Description:
+ *   Pass the next 'len' bytes of body data in the buffer to the callback.
+ *   The body of a redirection is discarded.
+ *
+ ****************************************************************************/
+
+static void wget_deliver(FAR struct wget_s *ws,
+                         FAR struct wget_request_s *req, int len)
+{
+  FAR char *buffer = ws->buffer;
+  int end = ws->offset + len;
+
+  if (len > 0 && req->callback != NULL && !ws->moved)
+    {
+      /* Let the client decide what to do with the received file */
+
+      req->callback(&ws->buffer, ws->offset, end, &ws->buflen, req->arg);
+    }
+
+  ws->offset = end;
+
+  /* If the callback switched buffers, move anything that follows the body
+   * (the start of the next pipelined response) into the new buffer.
+   */
+
+  if (ws->buffer != buffer)
+    {
+      len = MIN(ws->datend - end, ws->buflen);
+      if (len > 0)
         {
-          ndx++;
+          memcpy(ws->buffer, &buffer[end], len);
         }
 
-      offset++;
+      ws->offset = 0;
+      ws->datend = len > 0 ? len : 0;
+    }
+}
+
+/****************************************************************************
+ * Name: wget_parse
+ *
+ * Description:
+ *   Parse the received data in the buffer until it has all been consumed
+ *   or until the response is complete.  Body data is passed to the
+ *   callback without further buffering.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on a malformed response.
+ *
+ ****************************************************************************/
+
+static int wget_parse(FAR struct wget_s *ws, FAR struct wget_request_s *req)
+{
+  FAR char *end;
+  int len;
+  int ret;
+
+  while (ws->offset < ws->datend && ws->state != WEBCLIENT_STATE_DONE)
+    {
+      switch (ws->state)
+        {
+          case WEBCLIENT_STATE_STATUSLINE:
+            if (wget_getline(ws))
+              {
+                ret = wget_parsestatus(ws);
+                if (ret < 0)
+                  {
+                    return ret;
+                  }
+              }
+            break;
+
+          case WEBCLIENT_STATE_HEADERS:
+            if (wget_getline(ws))
+              {
+                if (ws->line[0] == '\0')
+                  {
+                    /* This was the last header line (i.e., and empty
+                     * "\r\n"), so we are done with the headers.
+                     */
+
+                    wget_startbody(ws);
+                  }
+                else
+                  {
+                    wget_parseheader(ws);
+                  }
+              }
+            break;
+
+          case WEBCLIENT_STATE_DATA:
+          case WEBCLIENT_STATE_CHUNKDATA:
+            len = ws->datend - ws->offset;
+            if ((unsigned long)len > ws->remaining)
+              {
+                len = (int)ws->remaining;
+              }
+
+            ws->remaining -= len;
+            wget_deliver(ws, req, len);
+
+            if (ws->remaining == 0)
+              {
+                ws->state = ws->state == WEBCLIENT_STATE_DATA ?
+                            WEBCLIENT_STATE_DONE : WEBCLIENT_STATE_CHUNKEND;
+              }
+            break;
+
+          case WEBCLIENT_STATE_CLOSE:
+            wget_deliver(ws, req, ws->datend - ws->offset);
+            break;
+
+          case WEBCLIENT_STATE_CHUNKSIZE:
+            if (wget_getline(ws))
+              {
+                /* The size is in hex and may be followed by extensions */
+
+                ws->remaining = strtoul(ws->line, &end, 16);
+                if (end == ws->line)
+                  {
+                    return -ECONNABORTED;
+                  }
+
+                ws->state = ws->remaining > 0 ? WEBCLIENT_STATE_CHUNKDATA :
+                                                WEBCLIENT_STATE_TRAILER;
+              }
+            break;
+
+          case WEBCLIENT_STATE_CHUNKEND:
+            if (wget_getline(ws))
+              {
+                ws->state = WEBCLIENT_STATE_CHUNKSIZE;
+              }
+            break;
+
+          case WEBCLIENT_STATE_TRAILER:
+            if (wget_getline(ws) && ws->line[0] == '\0')
+              {
+                ws->state = WEBCLIENT_STATE_DONE;
+              }
+            break;
+
+          default:
+            return -EINVAL;
+        }
     }
 
-exit:
-  ws->offset = ++offset;
-  ws->ndx    = ndx;
   return OK;
 }
 
+/****************************************************************************
+ * Name: wget_resetresponse
+ *
+ * Description:
+ *   Prepare to parse a new response.  Any data remaining in the buffer
+ *   belongs to the new response.
+ *
+ ****************************************************************************/
+
+static void wget_resetresponse(FAR struct wget_s *ws)
+{
+  ws->state     = WEBCLIENT_STATE_STATUSLINE;
+  ws->status    = 0;
+  ws->persist   = false;
+  ws->chunked   = false;
+  ws->havelen   = false;
+  ws->remaining = 0;
+  ws->ndx       = 0;
+}
+
 /****************************************************************************
  * Name: wget_gethostip
  *
  * Description:
  *   Call gethostbyname() to get the IPv4 address associated with a hostname.
+ *   Recent results are kept in a small cache for CONFIG_WEBCLIENT_DNSTTL
+ *   seconds.
  *
  * Input Parameters
  *   hostname - The host name to use in the nslookup.
@@ -392,276 +751,664 @@ exit:
 static int wget_gethostip(FAR char *hostname, in_addr_t *ipv4addr)
 {
   FAR struct hostent *he;
+  int ret = OK;
+#if CONFIG_WEBCLIENT_DNSCACHE > 0
+  FAR struct wget_dnsentry_s *entry;
+  FAR struct wget_dnsentry_s *oldest;
+  time_t now = wget_now();
+  int i;
+
+  /* gethostbyname() returns a pointer to static data, so the lookup is
+   * also serialized by the lock.
+   */
+
+  wget_lock();
+
+  oldest = &g_wget_dnscache[0];
+  for (i = 0; i < CONFIG_WEBCLIENT_DNSCACHE; i++)
+    {
+      entry = &g_wget_dnscache[i];
+      if (entry->hostname[0] != '\0' && (int32_t)(entry->expire - now) > 0 &&
+          strcmp(entry->hostname, hostname) == 0)
+        {
+          *ipv4addr = entry->addr;
+          wget_unlock();
+          return OK;
+        }
+
+      if (entry->expire < oldest->expire)
+        {
+          oldest = entry;
+        }
+    }
+#endif
 
   he = gethostbyname(hostname);
   if (he == NULL)
     {
       ndbg("gethostbyname failed: %d\n", h_errno);
-      return -ENOENT;
+      ret = -ENOENT;
     }
   else if (he->h_addrtype != AF_INET)
     {
       ndbg("gethostbyname returned an address of type: %d\n", he->h_addrtype);
-      return -ENOEXEC;
+      ret = -ENOEXEC;
     }
+  else
+    {
+      memcpy(ipv4addr, he->h_addr, sizeof(in_addr_t));
 
-  memcpy(ipv4addr, he->h_addr, sizeof(in_addr_t));
-  return OK;
+#if CONFIG_WEBCLIENT_DNSCACHE > 0
+      /* Replace the oldest entry in the cache */
+
+      strncpy(oldest->hostname, hostname, CONFIG_WEBCLIENT_MAXHOSTNAME - 1);
+      oldest->hostname[CONFIG_WEBCLIENT_MAXHOSTNAME - 1] = '\0';
+      oldest->addr   = *ipv4addr;
+      oldest->expire = now + CONFIG_WEBCLIENT_DNSTTL;
+#endif
+    }
+
+#if CONFIG_WEBCLIENT_DNSCACHE > 0
+  wget_unlock();
+#endif
+  return ret;
 }
 
 /****************************************************************************
- * Name: wget_base
+ * Name: wget_connect
  *
  * Description:
- *   Obtain the requested file from an HTTP server using the GET method.
- *
- *   Note: If the function is passed a host name, it must already be in
- *   the resolver cache in order for the function to connect to the web
- *   server. It is therefore up to the calling module to implement the
- *   resolver calls and the signal handler used for reporting a resolv
- *   query answer.
- *
- * Input Parameters
- *   url      - A pointer to a string containing either the full URL to
- *              the file to get (e.g., http://www.nutt.org/index.html, or
- *              http://192.168.23.1:80/index.html).
- *   buffer   - A user provided buffer to receive the file data (also
- *              used for the outgoing GET request
- *   buflen   - The size of the user provided buffer
- *   callback - As data is obtained from the host, this function is
- *              to dispose of each block of file data as it is received.
- *   mode     - Indicates GET or POST modes
+ *   Get a connection to conn->hostname and conn->port.  An idle connection
+ *   from the pool is used if there is one, unless 'fresh' is true.
+ *   Otherwise, a new connection is opened.
  *
  * Returned Value:
- *   0: if the GET operation completed successfully;
- *  -1: On a failure with errno set appropriately
+ *   Zero (OK) on success; a negated errno value on failure.
  *
  ****************************************************************************/
 
-static int wget_base(FAR const char *url, FAR char *buffer, int buflen,
-                     wget_callback_t callback, FAR void *arg,
-                     FAR const char *posts, uint8_t mode)
+static int wget_connect(FAR struct wget_conn_s *conn, bool fresh)
 {
   struct sockaddr_in server;
-  struct wget_s ws;
   struct timeval tv;
-  bool redirected;
-  char *dest,post_size[8];
-  int sockfd;
-  int len,post_len;
   int ret;
 
-  /* Initialize the state structure */
+  conn->reused = false;
 
-  memset(&ws, 0, sizeof(struct wget_s));
-  ws.buffer = buffer;
-  ws.buflen = buflen;
-  ws.port   = 80;
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+  if (!fresh)
+    {
+      FAR struct wget_conn_s *pooled;
+      time_t now = wget_now();
+      int i;
 
-  /* Parse the hostname (with optional port number) and filename from the URL */
+      wget_lock();
+      for (i = 0; i < CONFIG_WEBCLIENT_NCONNS; i++)
+        {
+          pooled = &g_wget_pool[i];
+          if (!pooled->inuse || pooled->port != conn->port ||
+              strcmp(pooled->hostname, conn->hostname) != 0)
+            {
+              continue;
+            }
 
-  ret = netlib_parsehttpurl(url, &ws.port,
-                            ws.hostname, CONFIG_WEBCLIENT_MAXHOSTNAME,
-                            ws.filename, CONFIG_WEBCLIENT_MAXFILENAME);
-  if (ret != 0)
+          pooled->inuse = false;
+          if (now - pooled->lastuse >= CONFIG_WEBCLIENT_IDLETIME)
+            {
+              /* The server has probably closed this one already */
+
+              close(pooled->sockfd);
+              continue;
+            }
+
+          conn->sockfd = pooled->sockfd;
+          conn->reused = true;
+          break;
+        }
+
+      wget_unlock();
+
+      if (conn->reused)
+        {
+          nvdbg("Re-using connection to %s:%d\n", conn->hostname, conn->port);
+          return OK;
+        }
+    }
+#endif
+
+  /* Create a socket */
+
+  conn->sockfd = socket(AF_INET, SOCK_STREAM, 0);
+  if (conn->sockfd < 0)
     {
-      ndbg("ERROR: Malformed HTTP URL: %s\n", url);
-      set_errno(-ret);
-      return ERROR;
+      /* socket failed.  It will set the errno appropriately */
+
+      ndbg("ERROR: socket failed: %d\n", errno);
+      return -errno;
     }
 
-  nvdbg("hostname='%s' filename='%s'\n", ws.hostname, ws.filename);
+  /* Set send and receive timeout values */
 
-  /* The following sequence may repeat indefinitely if we are redirected */
+  tv.tv_sec  = CONFIG_WEBCLIENT_TIMEOUT;
+  tv.tv_usec = 0;
 
-  do
-    {
-      /* Re-initialize portions of the state structure that could have
-       * been left from the previous time through the loop and should not
-       * persist with the new connection.
-       */
+  (void)setsockopt(conn->sockfd, SOL_SOCKET, SO_RCVTIMEO, (FAR const void *)&tv,
+                   sizeof(struct timeval));
+  (void)setsockopt(conn->sockfd, SOL_SOCKET, SO_SNDTIMEO, (FAR const void *)&tv,
+                   sizeof(struct timeval));
 
-      ws.httpstatus = HTTPSTATUS_NONE;
-      ws.offset     = 0;
-      ws.datend     = 0;
-      ws.ndx        = 0;
+  /* Get the server address from the host name */
 
-      /* Create a socket */
+  memset(&server, 0, sizeof(struct sockaddr_in));
+  server.sin_family = AF_INET;
+  server.sin_port   = htons(conn->port);
+  ret = wget_gethostip(conn->hostname, &server.sin_addr.s_addr);
+  if (ret < 0)
+    {
+      /* Could not resolve host (or malformed IP address) */
 
-      sockfd = socket(AF_INET, SOCK_STREAM, 0);
-      if (sockfd < 0)
-        {
-          /* socket failed.  It will set the errno appropriately */
+      ndbg("ERROR: Failed to resolve hostname\n");
+      close(conn->sockfd);
+      return -EHOSTUNREACH;
+    }
 
-          ndbg("ERROR: socket failed: %d\n", errno);
-          return ERROR;
-        }
+  /* Connect to server.  First we have to set some fields in the
+   * 'server' address structure.  The system will assign me an arbitrary
+   * local port that is not in use.
+   */
 
-      /* Set send and receive timeout values */
+  ret = connect(conn->sockfd, (struct sockaddr *)&server, sizeof(struct sockaddr_in));
+  if (ret < 0)
+    {
+      ret = -errno;
+      ndbg("ERROR: connect failed: %d\n", -ret);
+      close(conn->sockfd);
+      return ret;
+    }
 
-      tv.tv_sec  = CONFIG_WEBCLIENT_TIMEOUT;
-      tv.tv_usec = 0;
+  return OK;
+}
 
-      (void)setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, (FAR const void *)&tv,
-                       sizeof(struct timeval));
-      (void)setsockopt(sockfd, SOL_SOCKET, SO_SNDTIMEO, (FAR const void *)&tv,
-                       sizeof(struct timeval));
+/****************************************************************************
+ * Name: wget_disconnect
+ *
+ * Description:
+ *   Finished with a connection.  If the server will keep it open, return
+ *   it to the pool, replacing the least recently used entry if the pool
+ *   is full.  Otherwise, close it.
+ *
+ ****************************************************************************/
 
-      /* Get the server address from the host name */
+static void wget_disconnect(FAR struct wget_conn_s *conn, bool persist)
+{
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+  if (persist)
+    {
+      FAR struct wget_conn_s *slot = &g_wget_pool[0];
+      int i;
 
-      server.sin_family = AF_INET;
-      server.sin_port   = htons(ws.port);
-      ret = wget_gethostip(ws.hostname, &server.sin_addr.s_addr);
-      if (ret < 0)
+      wget_lock();
+      for (i = 0; i < CONFIG_WEBCLIENT_NCONNS; i++)
         {
-          /* Could not resolve host (or malformed IP address) */
+          if (!g_wget_pool[i].inuse)
+            {
+              slot = &g_wget_pool[i];
+              break;
+            }
 
-          ndbg("ERROR: Failed to resolve hostname\n");
-          ret = -EHOSTUNREACH;
-          goto errout_with_errno;
+          if (g_wget_pool[i].lastuse < slot->lastuse)
+            {
+              slot = &g_wget_pool[i];
+            }
         }
 
-      /* Connect to server.  First we have to set some fields in the
-       * 'server' address structure.  The system will assign me an arbitrary
-       * local port that is not in use.
-       */
-
-      ret = connect(sockfd, (struct sockaddr *)&server, sizeof(struct sockaddr_in));
-      if (ret < 0)
+      if (slot->inuse)
         {
-          ndbg("ERROR: connect failed: %d\n", errno);
-          goto errout;
+          close(slot->sockfd);
         }
 
-      /* Send the GET request */
+      memcpy(slot, conn, sizeof(struct wget_conn_s));
+      slot->inuse   = true;
+      slot->lastuse = wget_now();
+      wget_unlock();
+      return;
+    }
+#endif
+
+  close(conn->sockfd);
+}
 
-      dest = ws.buffer;
-      if (mode == WGET_MODE_POST)
-        {
-          dest = wget_strcpy(dest, g_httppost);
-        }
-      else
+/****************************************************************************
+ * Name: wget_send
+ *
+ * Description:
+ *   Send all of the data in the buffer
+ *
+ ****************************************************************************/
+
+static int wget_send(int sockfd, FAR const char *buffer, int len)
+{
+  int ret;
+
+  while (len > 0)
+    {
+      ret = send(sockfd, buffer, len, 0);
+      if (ret < 0)
         {
-          dest = wget_strcpy(dest, g_httpget);
+          ndbg("ERROR: send failed: %d\n", errno);
+          return -errno;
         }
 
+      buffer += ret;
+      len    -= ret;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: wget_mkrequest
+ *
+ * Description:
+ *   Format one request at 'dest' if it fits in 'avail' bytes.
+ *
+ * Returned Value:
+ *   A pointer to the end of the request or NULL if it does not fit.
+ *
+ ****************************************************************************/
+
+static FAR char *wget_mkrequest(FAR struct wget_s *ws, FAR char *dest,
+                                int avail, FAR const char *filename,
+                                FAR const char *posts)
+{
+  char post_size[12];
+  int post_len = 0;
+  int len;
+
+  /* Make sure that the request fits.  This is a slight over-estimate. */
+
+  len = sizeof(g_httppost) + strlen(filename) + sizeof(g_http11) +
+        sizeof(g_httpcrnl) + sizeof(g_httphost) + strlen(ws->hostname) +
+        sizeof(post_size) + sizeof(g_httpconn) +
+        sizeof(g_httpuseragentfields);
+
+  if (posts != NULL)
+    {
+      post_len = strlen(posts);
+      len += sizeof(g_httpform) + sizeof(g_httpcontsize) +
+             sizeof(post_size) + 2 * sizeof(g_httpcrnl) + post_len;
+    }
+
+  if (len > avail)
+    {
+      return NULL;
+    }
+
+  /* Format the GET or POST request */
+
+  if (posts != NULL)
+    {
+      dest = wget_strcpy(dest, g_httppost);
+    }
+  else
+    {
+      dest = wget_strcpy(dest, g_httpget);
+    }
+
 #ifndef WGET_USE_URLENCODE
-      dest = wget_strcpy(dest, ws.filename);
+  dest = wget_strcpy(dest, filename);
 #else
-    //dest = wget_urlencode_strcpy(dest, ws.filename);
-      dest = wget_strcpy(dest, ws.filename);
+//dest = wget_urlencode_strcpy(dest, filename);
+  dest = wget_strcpy(dest, filename);
 #endif
 
-      *dest++ = ISO_space;
-      dest = wget_strcpy(dest, g_http10);
+  *dest++ = ISO_space;
+  dest = wget_strcpy(dest, g_http11);
+  dest = wget_strcpy(dest, g_httpcrnl);
+  dest = wget_strcpy(dest, g_httphost);
+  dest = wget_strcpy(dest, ws->hostname);
+  if (ws->port != 80)
+    {
+      sprintf(post_size, ":%d", ws->port);
+      dest = wget_strcpy(dest, post_size);
+    }
+
+  dest = wget_strcpy(dest, g_httpcrnl);
+
+  if (posts != NULL)
+    {
+      dest = wget_strcpy(dest, g_httpform);
       dest = wget_strcpy(dest, g_httpcrnl);
-      dest = wget_strcpy(dest, g_httphost);
-      dest = wget_strcpy(dest, ws.hostname);
+      dest = wget_strcpy(dest, g_httpcontsize);
+
+      /* Post content size */
+
+      sprintf(post_size, "%d", post_len);
+      dest = wget_strcpy(dest, post_size);
       dest = wget_strcpy(dest, g_httpcrnl);
+    }
+
+  dest = wget_strcpy(dest, g_httpconn);
+  dest = wget_strcpy(dest, g_httpuseragentfields);
+  if (posts != NULL)
+    {
+      dest = wget_strcpy(dest, posts);
+    }
+
+  return dest;
+}
+
+/****************************************************************************
+ * Name: wget_sendrequests
+ *
+ * Description:
+ *   Format the requests starting with reqs[*next] in the buffer and send
+ *   them together.  Up to WGET_PIPELINE GET requests are sent at once.
+ *   POST requests are not idempotent and are always sent by themselves.
+ *   On return, *next is the index of the first request not sent.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+static int wget_sendrequests(FAR struct wget_s *ws, int sockfd,
+                             FAR struct wget_request_s *reqs, int nreqs,
+                             FAR int *next)
+{
+  char hostname[CONFIG_WEBCLIENT_MAXHOSTNAME];
+  char filename[CONFIG_WEBCLIENT_MAXFILENAME];
+  FAR const char *path;
+  FAR char *dest = ws->buffer;
+  FAR char *end;
+  uint16_t port;
+  int first = *next;
+
+  while (*next < nreqs && *next - first < WGET_PIPELINE)
+    {
+      FAR struct wget_request_s *req = &reqs[*next];
 
-      if (mode == WGET_MODE_POST)
+      if (req->posts != NULL && *next > first)
         {
-          dest = wget_strcpy(dest, g_httpform);
-          dest = wget_strcpy(dest, g_httpcrnl);
-          dest = wget_strcpy(dest, g_httpcontsize);
+          break;
+        }
 
-          /* Post content size */
+      /* A NULL URL means the location in ws->filename */
 
-          post_len = strlen((char *)posts);
-          sprintf(post_size,"%d", post_len);
-          dest = wget_strcpy(dest, post_size);
-          dest = wget_strcpy(dest, g_httpcrnl);
+      path = ws->filename;
+      if (req->url != NULL)
+        {
+          (void)netlib_parsehttpurl(req->url, &port,
+                                    hostname, CONFIG_WEBCLIENT_MAXHOSTNAME,
+                                    filename, CONFIG_WEBCLIENT_MAXFILENAME);
+          path = filename;
         }
 
-      dest = wget_strcpy(dest, g_httpuseragentfields);
-      if (mode == WGET_MODE_POST)
+      end = wget_mkrequest(ws, dest, ws->buflen - (dest - ws->buffer),
+                           path, req->posts);
+      if (end == NULL)
         {
-          dest = wget_strcpy(dest, (char *)posts);
+          if (*next == first)
+            {
+              ndbg("ERROR: Request does not fit in the buffer\n");
+              return -E2BIG;
+            }
+
+          break;
         }
 
-      len = dest - buffer;
+      dest = end;
+      (*next)++;
 
-      ret = send(sockfd, buffer, len, 0);
-      if (ret < 0)
+      if (req->posts != NULL)
         {
-          ndbg("ERROR: send failed: %d\n", errno);
-          goto errout;
+          break;
         }
+    }
 
-      /* Now loop to get the file sent in response to the GET.  This
-       * loop continues until either we read the end of file (nbytes == 0)
-       * or until we detect that we have been redirected.
-       */
+  return wget_send(sockfd, ws->buffer, dest - ws->buffer);
+}
+
+/****************************************************************************
+ * Name: wget_exchange
+ *
+ * Description:
+ *   Send a sequence of requests to the server in ws->hostname and ws->port
+ *   and receive the responses.  The requests are pipelined on one
+ *   connection if the server keeps the connection open.  If the server
+ *   closes the connection before all of the responses have been received,
+ *   the remaining requests are sent again on a new connection.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
 
-      ws.state   = WEBCLIENT_STATE_STATUSLINE;
-      redirected = false;
-      for (;;)
+static int wget_exchange(FAR struct wget_s *ws,
+                         FAR struct wget_request_s *reqs, int nreqs)
+{
+  struct wget_conn_s conn;
+  bool connected = false;
+  bool progress  = false;
+  bool fresh     = false;
+  bool persist   = false;
+  int next = 0;
+  int done = 0;
+  int ret  = OK;
+
+  /* Save the connection key now.  A redirection changes ws->hostname. */
+
+  memset(&conn, 0, sizeof(struct wget_conn_s));
+  strncpy(conn.hostname, ws->hostname, CONFIG_WEBCLIENT_MAXHOSTNAME - 1);
+  conn.port = ws->port;
+
+  while (done < nreqs)
+    {
+      if (!connected)
         {
-          ws.datend = recv(sockfd, ws.buffer, ws.buflen, 0);
-          if (ws.datend < 0)
+          ret = wget_connect(&conn, fresh);
+          if (ret < 0)
             {
-              ndbg("ERROR: recv failed: %d\n", errno);
-              ret = ws.datend;
-              goto errout_with_errno;
-            }
-          else if (ws.datend == 0)
-            {
-              nvdbg("Connection lost\n");
-              close(sockfd);
-              break;
+              goto errout;
             }
 
-          /* Handle initial parsing of the status line */
+          connected = true;
+          progress  = false;
+          next      = done;
+        }
 
-          ws.offset = 0;
-          if (ws.state == WEBCLIENT_STATE_STATUSLINE)
-            {
-              ret = wget_parsestatus(&ws);
-              if (ret < 0)
-                {
-                  goto errout_with_errno;
-                }
-            }
+      /* Send the next group of requests */
+
+      ret = wget_sendrequests(ws, conn.sockfd, reqs, nreqs, &next);
+      if (ret == -E2BIG)
+        {
+          goto errout_with_conn;
+        }
+
+      /* Now loop to get the responses.  This loop continues until all of
+       * the requests sent have been answered or until the connection is
+       * closed.
+       */
 
-          /* Parse the HTTP data */
+      ws->offset = 0;
+      ws->datend = 0;
+      wget_resetresponse(ws);
 
-          if (ws.state == WEBCLIENT_STATE_HEADERS)
+      while (ret == OK && done < next)
+        {
+          if (ws->offset >= ws->datend)
             {
-              ret = wget_parseheaders(&ws);
-              if (ret < 0)
+              ws->offset = 0;
+              ws->datend = recv(conn.sockfd, ws->buffer, ws->buflen, 0);
+              if (ws->datend < 0)
                 {
-                  goto errout_with_errno;
+                  ndbg("ERROR: recv failed: %d\n", errno);
+                  ret = -errno;
+                  ws->datend = 0;
+                  break;
                 }
-            }
+              else if (ws->datend == 0)
+                {
+                  nvdbg("Connection lost\n");
+                  if (ws->state != WEBCLIENT_STATE_CLOSE)
+                    {
+                      ret = -ECONNRESET;
+                      break;
+                    }
 
-          /* Dispose of the data payload */
+                  ws->state = WEBCLIENT_STATE_DONE;
+                }
+            }
 
-          if (ws.state == WEBCLIENT_STATE_DATA)
+          ret = wget_parse(ws, &reqs[done]);
+          if (ret == OK && ws->state == WEBCLIENT_STATE_DONE)
             {
-              if (ws.httpstatus != HTTPSTATUS_MOVED)
-                {
-                  /* Let the client decide what to do with the received file */
+              reqs[done].status = ws->status;
+              persist  = ws->persist;
+              progress = true;
+              done++;
 
-                  callback(&ws.buffer, ws.offset, ws.datend, &buflen, arg);
-                }
-              else
+              if (!persist)
                 {
-                  redirected = true;
-                  close(sockfd);
                   break;
                 }
+
+              wget_resetresponse(ws);
             }
         }
+
+      if (ret < 0)
+        {
+          /* The server may close an idle connection just as we re-use it
+           * or may limit the number of requests per connection.  If no
+           * part of the next response was received, try again on a new
+           * connection.
+           */
+
+          if (ret == -EAGAIN || ret == -ECONNABORTED ||
+              ws->state != WEBCLIENT_STATE_STATUSLINE || ws->ndx > 0 ||
+              (!conn.reused && !progress))
+            {
+              goto errout_with_conn;
+            }
+
+          nvdbg("Retrying on a new connection\n");
+          close(conn.sockfd);
+          connected = false;
+          fresh     = true;
+          ret       = OK;
+        }
+      else if (!persist || ws->offset < ws->datend)
+        {
+          /* The server will close the connection, or sent more than we
+           * asked for.
+           */
+
+          close(conn.sockfd);
+          connected = false;
+          fresh     = true;
+        }
+    }
+
+  if (connected)
+    {
+      wget_disconnect(&conn, persist);
     }
-  while (redirected);
 
   return OK;
 
-errout_with_errno:
-  set_errno(-ret);
+errout_with_conn:
+  close(conn.sockfd);
 errout:
-  close(sockfd);
-  return ERROR;
+  for (; done < nreqs; done++)
+    {
+      reqs[done].status = 0;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: wget_base
+ *
+ * Description:
+ *   Obtain the requested file from an HTTP server using the GET method.
+ *
+ *   Note: If the function is passed a host name, it must already be in
+ *   the resolver cache in order for the function to connect to the web
+ *   server. It is therefore up to the calling module to implement the
+ *   resolver calls and the signal handler used for reporting a resolv
+ *   query answer.
+ *
+ * Input Parameters
+ *   url      - A pointer to a string containing either the full URL to
+ *              the file to get (e.g., http://www.nutt.org/index.html, or
+ *              http://192.168.23.1:80/index.html).
+ *   buffer   - A user provided buffer to receive the file data (also
+ *              used for the outgoing GET request
+ *   buflen   - The size of the user provided buffer
+ *   callback - As data is obtained from the host, this function is
+ *              to dispose of each block of file data as it is received.
+ *   mode     - Indicates GET or POST modes
+ *
+ * Returned Value:
+ *   0: if the GET operation completed successfully;
+ *  -1: On a failure with errno set appropriately
+ *
+ ****************************************************************************/
+
+static int wget_base(FAR const char *url, FAR char *buffer, int buflen,
+                     wget_callback_t callback, FAR void *arg,
+                     FAR const char *posts, uint8_t mode)
+{
+  struct wget_request_s req;
+  struct wget_s ws;
+  int ret;
+
+  /* Initialize the state structure */
+
+  memset(&ws, 0, sizeof(struct wget_s));
+  ws.buffer = buffer;
+  ws.buflen = buflen;
+  ws.port   = 80;
+  ws.follow = true;
+
+  /* Parse the hostname (with optional port number) and filename from the URL */
+
+  ret = netlib_parsehttpurl(url, &ws.port,
+                            ws.hostname, CONFIG_WEBCLIENT_MAXHOSTNAME,
+                            ws.filename, CONFIG_WEBCLIENT_MAXFILENAME);
+  if (ret != 0)
+    {
+      ndbg("ERROR: Malformed HTTP URL: %s\n", url);
+      set_errno(-ret);
+      return ERROR;
+    }
+
+  nvdbg("hostname='%s' filename='%s'\n", ws.hostname, ws.filename);
+
+  /* The request refers to ws.filename so that it follows redirections */
+
+  memset(&req, 0, sizeof(struct wget_request_s));
+  req.posts    = mode == WGET_MODE_POST ? posts : NULL;
+  req.callback = callback;
+  req.arg      = arg;
+
+  /* The following sequence may repeat indefinitely if we are redirected */
+
+  do
+    {
+      ws.moved = false;
+      ret = wget_exchange(&ws, &req, 1);
+      if (ret < 0)
+        {
+          set_errno(-ret);
+          return ERROR;
+        }
+    }
+  while (ws.moved);
+
+  return OK;
 }
 
 /****************************************************************************
@@ -787,3 +1534,92 @@ int wget_post(FAR const char *url, FAR const char *posts, FAR char *buffer,
 {
   return wget_base(url, buffer, buflen, callback, arg, posts, WGET_MODE_POST);
 }
+
+/****************************************************************************
+ * Name: wget_pipeline
+ *
+ * Description:
+ *   Send a sequence of requests to one server and receive the responses.
+ *   See apps/include/netutils/webclient.h.
+ *
+ ****************************************************************************/
+
+int wget_pipeline(FAR struct wget_request_s *reqs, int nreqs,
+                  FAR char *buffer, int buflen)
+{
+  char hostname[CONFIG_WEBCLIENT_MAXHOSTNAME];
+  struct wget_s ws;
+  uint16_t port;
+  int ret;
+  int i;
+
+  /* Initialize the state structure */
+
+  memset(&ws, 0, sizeof(struct wget_s));
+  ws.buffer = buffer;
+  ws.buflen = buflen;
+
+  /* All of the requests must be for the same host and port */
+
+  for (i = 0; i < nreqs; i++)
+    {
+      port = 80;
+      ret  = netlib_parsehttpurl(reqs[i].url, &port,
+                                 hostname, CONFIG_WEBCLIENT_MAXHOSTNAME,
+                                 ws.filename, CONFIG_WEBCLIENT_MAXFILENAME);
+      if (ret != 0)
+        {
+          ndbg("ERROR: Malformed HTTP URL: %s\n", reqs[i].url);
+          set_errno(-ret);
+          return ERROR;
+        }
+
+      if (i == 0)
+        {
+          strcpy(ws.hostname, hostname);
+          ws.port = port;
+        }
+      else if (port != ws.port || strcmp(hostname, ws.hostname) != 0)
+        {
+          ndbg("ERROR: %s is not on %s:%d\n", reqs[i].url, ws.hostname, ws.port);
+          set_errno(EINVAL);
+          return ERROR;
+        }
+    }
+
+  ret = wget_exchange(&ws, reqs, nreqs);
+  if (ret < 0)
+    {
+      set_errno(-ret);
+      return ERROR;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: wget_closeall
+ *
+ * Description:
+ *   Close all idle persistent connections.
+ *
+ ****************************************************************************/
+
+void wget_closeall(void)
+{
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+  int i;
+
+  wget_lock();
+  for (i = 0; i < CONFIG_WEBCLIENT_NCONNS; i++)
+    {
+      if (g_wget_pool[i].inuse)
+        {
+          close(g_wget_pool[i].sockfd);
+          g_wget_pool[i].inuse = false;
+        }
+    }
+
+  wget_unlock();
+#endif
+}
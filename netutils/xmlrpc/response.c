@@ -51,40 +51,421 @@
  * Included Files
  ****************************************************************************/
 
+#include <sys/types.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <stddef.h>
 #include <string.h>
 #include <stdio.h>
+#include <unistd.h>
+#include <errno.h>
 #include <apps/netutils/xmlrpc.h>
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Response states */
+
+#define RESP_IDLE   0  /* Nothing written yet */
+#define RESP_PARAMS 1  /* Writing a normal response */
+#define RESP_FAULT  2  /* Writing a fault response */
+#define RESP_DONE   3  /* Response complete */
+
+/* Bytes of the chunk size line ahead of each chunk */
+
+#define CHUNK_HDRLEN 6
+
+/* Maximum nesting of arrays and structs in a response (one bit per level
+ * in 'members').
+ */
+
+#define MAX_DEPTH 16
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Must fit in XMLRPC_HDRSIZE */
+
+static const char g_httpheader[] =
+  "HTTP/1.1 200 OK\r\n"
+  "Connection: close\r\n"
+  "Content-Type: text/xml\r\n"
+  "Transfer-Encoding: chunked\r\n"
+  "Server: Lightweight XMLRPC\r\n\r\n";
+
+/* Must fit in XMLRPC_HDRSIZE with a Content-Length line */
+
+static const char g_http10header[] =
+  "HTTP/1.0 200 OK\r\n"
+  "Connection: close\r\n"
+  "Content-Type: text/xml\r\n"
+  "Server: Lightweight XMLRPC\r\n";
+
+static const char g_hexdigits[] = "0123456789abcdef";
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
-static int xmlrpc_insertlength(struct xmlrpc_s * xmlcall)
+/****************************************************************************
+ * Name: xmlrpc_flush
+ *
+ * Description:
+ *   Send the buffered chunk, preceded by the HTTP header if that has not
+ *   been sent yet and followed by the last-chunk marker if 'final'.  The
+ *   chunk size line is written into the space reserved ahead of the
+ *   payload so that everything goes out in a single write.
+ *
+ *   An HTTP/1.0 response has no chunk framing.  Its header is written
+ *   into the space reserved ahead of the first payload, with a
+ *   Content-Length if that payload is the whole body.
+ *
+ ****************************************************************************/
+
+static void xmlrpc_flush(FAR struct xmlrpc_writer_s *writer, bool final)
 {
-  int len, digit, xdigit = 1000, i = 0;
-  char *temp;
+  FAR char *buffer = writer->buffer;
+  size_t nbytes = writer->base;
+  size_t len = writer->len;
+  ssize_t nsent;
+  int i;
 
-  temp = strstr(xmlcall->response, "<?xml");
-  len = strlen(temp);
+  if (writer->http10)
+    {
+      nbytes = 0;
+      if (!writer->sent)
+        {
+          char header[XMLRPC_HDRSIZE];
 
-  temp = strstr(xmlcall->response, "xyza");
+          if (final)
+            {
+              nbytes = snprintf(header, sizeof(header),
+                                "%sContent-Length: %u\r\n\r\n",
+                                g_http10header, (unsigned int)len);
+            }
+          else
+            {
+              nbytes = snprintf(header, sizeof(header), "%s\r\n",
+                                g_http10header);
+            }
+
+          memcpy(&buffer[XMLRPC_HDRSIZE - nbytes], header, nbytes);
+        }
 
-  do
+      buffer += writer->base + CHUNK_HDRLEN - nbytes;
+      nbytes += len;
+    }
+  else if (len > 0)
     {
-      digit = (len / xdigit);
-      len -= (digit * xdigit);
-      xdigit /= 10;
+      for (i = 0; i < 4; i++)
+        {
+          buffer[nbytes + i] = g_hexdigits[(len >> (12 - 4 * i)) & 15];
+        }
+
+      buffer[nbytes + 4] = '\r';
+      buffer[nbytes + 5] = '\n';
+      nbytes += CHUNK_HDRLEN + len;
+      buffer[nbytes++] = '\r';
+      buffer[nbytes++] = '\n';
+    }
 
-      if ((digit == 0) && (xdigit > 1))
-        temp[i++] = ' ';
+  if (final && !writer->http10)
+    {
+      memcpy(&buffer[nbytes], "0\r\n\r\n", 5);
+      nbytes += 5;
+    }
+
+  while (nbytes > 0 && writer->errcode == 0)
+    {
+      nsent = write(writer->sock, buffer, nbytes);
+      if (nsent < 0)
+        {
+          if (errno != EINTR)
+            {
+              writer->errcode = errno;
+            }
+        }
       else
-        temp[i++] = (0x30 + digit);
+        {
+          buffer += nsent;
+          nbytes -= nsent;
+        }
+    }
+
+  writer->base = 0;
+  writer->len  = 0;
+  writer->sent = true;
+}
+
+/****************************************************************************
+ * Name: xmlrpc_write
+ *
+ * Description:
+ *   Append data to the response, sending full chunks as they fill.
+ *
+ ****************************************************************************/
+
+static void xmlrpc_write(FAR struct xmlrpc_writer_s *writer,
+                         FAR const char *data, size_t len)
+{
+  size_t n;
+
+  while (len > 0 && writer->errcode == 0)
+    {
+      if (writer->len >= CONFIG_XMLRPC_CHUNKSIZE)
+        {
+          xmlrpc_flush(writer, false);
+        }
+
+      n = CONFIG_XMLRPC_CHUNKSIZE - writer->len;
+      if (n > len)
+        {
+          n = len;
+        }
+
+      memcpy(&writer->buffer[writer->base + CHUNK_HDRLEN + writer->len],
+             data, n);
+      writer->len += n;
+      data        += n;
+      len         -= n;
+    }
+}
+
+static void xmlrpc_puts(FAR struct xmlrpc_writer_s *writer,
+                        FAR const char *str)
+{
+  xmlrpc_write(writer, str, strlen(str));
+}
+
+/****************************************************************************
+ * Name: xmlrpc_putescaped
+ *
+ * Description:
+ *   Append a string, replacing the characters that are special in XML
+ *   text with character references.
+ *
+ ****************************************************************************/
+
+static void xmlrpc_putescaped(FAR struct xmlrpc_writer_s *writer,
+                              FAR const char *str)
+{
+  size_t len;
+
+  for (; ; )
+    {
+      len = strcspn(str, "<>&");
+      xmlrpc_write(writer, str, len);
+
+      str += len;
+      switch (*str++)
+        {
+        case '<':
+          xmlrpc_write(writer, "&lt;", 4);
+          break;
+
+        case '>':
+          xmlrpc_write(writer, "&gt;", 4);
+          break;
+
+        case '&':
+          xmlrpc_write(writer, "&amp;", 5);
+          break;
+
+        default:
+          return;
+        }
+    }
+}
+
+static int xmlrpc_status(FAR struct xmlrpc_writer_s *writer)
+{
+  return writer->errcode == 0 ? XMLRPC_NO_ERROR : XMLRPC_INTERNAL_ERROR;
+}
+
+/****************************************************************************
+ * Name: xmlrpc_begin
+ *
+ * Description:
+ *   Start the response body.  The HTTP header is placed in the buffer
+ *   ahead of the first chunk and sent with it.  The header of an HTTP/1.0
+ *   response depends on the length of the body, so only space is reserved
+ *   for it here.
+ *
+ ****************************************************************************/
+
+static int xmlrpc_begin(FAR struct xmlrpc_writer_s *writer, uint8_t state)
+{
+  if (writer->state != RESP_IDLE)
+    {
+      return XMLRPC_BAD_RESPONSE_ARG;
+    }
+
+  if (writer->http10)
+    {
+      writer->base = XMLRPC_HDRSIZE - CHUNK_HDRLEN;
+    }
+  else
+    {
+      memcpy(writer->buffer, g_httpheader, sizeof(g_httpheader) - 1);
+      writer->base = sizeof(g_httpheader) - 1;
+    }
+
+  writer->len     = 0;
+  writer->depth   = 0;
+  writer->members = 0;
+  writer->state   = state;
+
+  xmlrpc_puts(writer, "<?xml version=\"1.0\"?>\r\n<methodResponse>\r\n");
+  xmlrpc_puts(writer, state == RESP_FAULT ? "<fault>\r\n" :
+                                            "<params><param>\r\n");
+  return xmlrpc_status(writer);
+}
+
+/****************************************************************************
+ * Name: xmlrpc_beginvalue and xmlrpc_endvalue
+ *
+ * Description:
+ *   Open and close a <value>, wrapped in a <member> if it has a name.
+ *
+ ****************************************************************************/
+
+static int xmlrpc_beginvalue(FAR struct xmlrpc_writer_s *writer,
+                             FAR const char *name)
+{
+  if (writer->state != RESP_PARAMS && writer->state != RESP_FAULT)
+    {
+      return XMLRPC_BAD_RESPONSE_ARG;
+    }
+
+  if (name != NULL)
+    {
+      xmlrpc_puts(writer, "<member><name>");
+      xmlrpc_putescaped(writer, name);
+      xmlrpc_puts(writer, "</name>");
+    }
+
+  xmlrpc_puts(writer, "<value>");
+  return XMLRPC_NO_ERROR;
+}
+
+static int xmlrpc_endvalue(FAR struct xmlrpc_writer_s *writer, bool member)
+{
+  xmlrpc_puts(writer, member ? "</value></member>\r\n" : "</value>\r\n");
+  return xmlrpc_status(writer);
+}
+
+/****************************************************************************
+ * Name: xmlrpc_putscalar
+ *
+ * Description:
+ *   Append a complete scalar value.
+ *
+ ****************************************************************************/
+
+static int xmlrpc_putscalar(FAR struct xmlrpc_writer_s *writer,
+                            FAR const char *name, FAR const char *type,
+                            FAR const char *text, bool escape)
+{
+  int ret;
+
+  ret = xmlrpc_beginvalue(writer, name);
+  if (ret != XMLRPC_NO_ERROR)
+    {
+      return ret;
+    }
+
+  xmlrpc_puts(writer, "<");
+  xmlrpc_puts(writer, type);
+  xmlrpc_puts(writer, ">");
+
+  if (escape)
+    {
+      xmlrpc_putescaped(writer, text);
+    }
+  else
+    {
+      xmlrpc_puts(writer, text);
+    }
+
+  xmlrpc_puts(writer, "</");
+  xmlrpc_puts(writer, type);
+  xmlrpc_puts(writer, ">");
+
+  return xmlrpc_endvalue(writer, name != NULL);
+}
+
+/****************************************************************************
+ * Name: xmlrpc_begincontainer and xmlrpc_endcontainer
+ *
+ * Description:
+ *   Open and close an array or a struct.
+ *
+ ****************************************************************************/
+
+static int xmlrpc_begincontainer(FAR struct xmlrpc_writer_s *writer,
+                                 FAR const char *name, FAR const char *open)
+{
+  int ret;
+
+  if (writer->depth >= MAX_DEPTH)
+    {
+      return XMLRPC_BAD_RESPONSE_ARG;
+    }
+
+  ret = xmlrpc_beginvalue(writer, name);
+  if (ret != XMLRPC_NO_ERROR)
+    {
+      return ret;
+    }
+
+  if (name != NULL)
+    {
+      writer->members |= (1 << writer->depth);
+    }
+  else
+    {
+      writer->members &= ~(1 << writer->depth);
+    }
+
+  writer->depth++;
+  xmlrpc_puts(writer, open);
+  return xmlrpc_status(writer);
+}
+
+static int xmlrpc_endcontainer(FAR struct xmlrpc_writer_s *writer,
+                               FAR const char *close)
+{
+  if (writer->depth == 0)
+    {
+      return XMLRPC_BAD_RESPONSE_ARG;
     }
-  while (i < 4);
 
-  return 0;
+  writer->depth--;
+  xmlrpc_puts(writer, close);
+  return xmlrpc_endvalue(writer, (writer->members >> writer->depth) & 1);
+}
+
+/****************************************************************************
+ * Name: xmlrpc_nextarg
+ *
+ * Description:
+ *   Return the next unread parameter of a call or NULL.
+ *
+ ****************************************************************************/
+
+static FAR const struct xmlrpc_value_s *
+  xmlrpc_nextarg(FAR struct xmlrpc_s *xmlcall)
+{
+  FAR struct xmlrpc_parser_s *parser = xmlcall->parser;
+
+  if (parser == NULL || xmlcall->arg >= parser->nvalues)
+    {
+      return NULL;
+    }
+
+  return &parser->values[xmlcall->arg];
 }
 
 /****************************************************************************
@@ -93,15 +474,17 @@ static int xmlrpc_insertlength(struct xmlrpc_s * xmlcall)
 
 int xmlrpc_getinteger(struct xmlrpc_s * xmlcall, int *arg)
 {
+  FAR const struct xmlrpc_value_s *value;
+
   if ((xmlcall == NULL) || (arg == NULL))
     {
       return XMLRPC_INTERNAL_ERROR;
     }
 
-  if ((xmlcall->arg < xmlcall->argsize) &&
-      (xmlcall->args[xmlcall->arg] == 'i'))
+  value = xmlrpc_nextarg(xmlcall);
+  if (xmlrpc_value2int(value, arg) == XMLRPC_NO_ERROR)
     {
-      *arg = xmlcall->arguments[xmlcall->arg++].u.i;
+      xmlcall->arg = value->next;
       return 0;
     }
 
@@ -110,15 +493,17 @@ int xmlrpc_getinteger(struct xmlrpc_s * xmlcall, int *arg)
 
 int xmlrpc_getbool(struct xmlrpc_s * xmlcall, int *arg)
 {
+  FAR const struct xmlrpc_value_s *value;
+
   if ((xmlcall == NULL) || (arg == NULL))
     {
       return XMLRPC_INTERNAL_ERROR;
     }
 
-  if ((xmlcall->arg < xmlcall->argsize) &&
-      (xmlcall->args[xmlcall->arg] == 'b'))
+  value = xmlrpc_nextarg(xmlcall);
+  if (xmlrpc_value2bool(value, arg) == XMLRPC_NO_ERROR)
     {
-      *arg = xmlcall->arguments[xmlcall->arg++].u.i;
+      xmlcall->arg = value->next;
       return 0;
     }
 
@@ -127,15 +512,17 @@ int xmlrpc_getbool(struct xmlrpc_s * xmlcall, int *arg)
 
 int xmlrpc_getdouble(struct xmlrpc_s * xmlcall, double *arg)
 {
+  FAR const struct xmlrpc_value_s *value;
+
   if ((xmlcall == NULL) || (arg == NULL))
     {
       return XMLRPC_INTERNAL_ERROR;
     }
 
-  if ((xmlcall->arg < xmlcall->argsize) &&
-      (xmlcall->args[xmlcall->arg] == 'd'))
+  value = xmlrpc_nextarg(xmlcall);
+  if (xmlrpc_value2double(value, arg) == XMLRPC_NO_ERROR)
     {
-      *arg = xmlcall->arguments[xmlcall->arg++].u.d;
+      xmlcall->arg = value->next;
       return 0;
     }
 
@@ -144,116 +531,266 @@ int xmlrpc_getdouble(struct xmlrpc_s * xmlcall, double *arg)
 
 int xmlrpc_getstring(struct xmlrpc_s* xmlcall, char *arg)
 {
+  FAR const struct xmlrpc_value_s *value;
+  FAR const char *str;
+
   if ((xmlcall == NULL) || (arg == NULL))
     {
       return XMLRPC_INTERNAL_ERROR;
     }
 
-  if ((xmlcall->arg < xmlcall->argsize) &&
-      (xmlcall->args[xmlcall->arg] == 's'))
+  /* The caller's buffer holds up to CONFIG_XMLRPC_STRINGSIZE characters;
+   * use xmlrpc_value2string() to access longer strings in place.
+   */
+
+  value = xmlrpc_nextarg(xmlcall);
+  if (xmlrpc_value2string(value, &str) == XMLRPC_NO_ERROR)
     {
-      strcpy(arg, xmlcall->arguments[xmlcall->arg++].u.string);
+      strncpy(arg, str, CONFIG_XMLRPC_STRINGSIZE);
+      arg[CONFIG_XMLRPC_STRINGSIZE] = '\0';
+      xmlcall->arg = value->next;
       return 0;
     }
 
   return XMLRPC_UNEXPECTED_STRING_ARG;
 }
 
-int xmlrpc_buildresponse(struct xmlrpc_s* xmlcall, char *args, ...)
+/****************************************************************************
+ * Name: xmlrpc_writer_init
+ *
+ * Description:
+ *   Prepare to write a response to 'sock'.
+ *
+ ****************************************************************************/
+
+void xmlrpc_writer_init(FAR struct xmlrpc_writer_s *writer, int sock)
 {
-  va_list argp;
-  int i, ret = 0, index = 0, close = 0;
-  double d;
-  char *s;
-  int isStruct = 0;
+  memset(writer, 0, offsetof(struct xmlrpc_writer_s, buffer));
+  writer->sock = sock;
+}
+
+/****************************************************************************
+ * Name: xmlrpc_beginresponse
+ *
+ * Description:
+ *   Start a normal response.  Exactly one value should follow.
+ *
+ ****************************************************************************/
+
+int xmlrpc_beginresponse(FAR struct xmlrpc_writer_s *writer)
+{
+  return xmlrpc_begin(writer, RESP_PARAMS);
+}
 
-  if ((xmlcall == NULL) || (args == NULL))
+/****************************************************************************
+ * Name: xmlrpc_endresponse
+ *
+ * Description:
+ *   Complete the response and send what remains of it.  Calling this for
+ *   a response that is already complete does nothing.
+ *
+ ****************************************************************************/
+
+int xmlrpc_endresponse(FAR struct xmlrpc_writer_s *writer)
+{
+  if (writer->state == RESP_DONE)
     {
-      return -1;
+      return xmlrpc_status(writer);
+    }
+
+  if (writer->state == RESP_IDLE || writer->depth != 0)
+    {
+      return XMLRPC_BAD_RESPONSE_ARG;
+    }
+
+  xmlrpc_puts(writer, writer->state == RESP_FAULT ? "</fault>\r\n" :
+                                                    "</param></params>\r\n");
+  xmlrpc_puts(writer, "</methodResponse>\r\n");
+  xmlrpc_flush(writer, true);
+
+  writer->state = RESP_DONE;
+  return xmlrpc_status(writer);
+}
+
+/****************************************************************************
+ * Name: xmlrpc_sendfault
+ *
+ * Description:
+ *   Send a fault response.  Any partial response that is still buffered
+ *   is discarded.  If part of the response has already been sent, the
+ *   chunked body is terminated instead and an error is returned.
+ *
+ ****************************************************************************/
+
+int xmlrpc_sendfault(FAR struct xmlrpc_writer_s *writer, int code,
+                     FAR const char *string)
+{
+  if (writer->sent)
+    {
+      if (writer->state != RESP_DONE)
+        {
+          writer->len = 0;
+          xmlrpc_flush(writer, true);
+          writer->state = RESP_DONE;
+        }
+
+      return XMLRPC_INTERNAL_ERROR;
     }
 
-  strcpy(xmlcall->response, "HTTP/1.1 200 OK\n"
-         "Connection: close\n"
-         "Content-length: xyza\n"
-         "Content-Type: text/xml\n"
-         "Server: Lightweight XMLRPC\n\n"
-         "<?xml version=\"1.0\"?>\n" "<methodResponse>\n");
+  writer->state = RESP_IDLE;
+  xmlrpc_begin(writer, RESP_FAULT);
+  xmlrpc_beginstruct(writer, NULL);
+  xmlrpc_putint(writer, "faultCode", code);
+  xmlrpc_putstring(writer, "faultString", string);
+  xmlrpc_endstruct(writer);
+  return xmlrpc_endresponse(writer);
+}
+
+/****************************************************************************
+ * Name: xmlrpc_putint, xmlrpc_putbool, xmlrpc_putdouble and
+ *   xmlrpc_putstring
+ *
+ * Description:
+ *   Append a scalar value.  'name' is the member name when the value is
+ *   part of a struct and NULL otherwise.
+ *
+ ****************************************************************************/
+
+int xmlrpc_putint(FAR struct xmlrpc_writer_s *writer, FAR const char *name,
+                  int value)
+{
+  char text[16];
+
+  snprintf(text, sizeof(text), "%d", value);
+  return xmlrpc_putscalar(writer, name, "int", text, false);
+}
+
+int xmlrpc_putbool(FAR struct xmlrpc_writer_s *writer, FAR const char *name,
+                   int value)
+{
+  return xmlrpc_putscalar(writer, name, "boolean", value ? "1" : "0",
+                          false);
+}
+
+int xmlrpc_putdouble(FAR struct xmlrpc_writer_s *writer,
+                     FAR const char *name, double value)
+{
+  char text[64];
+
+  /* XML-RPC has no exponent notation, but very large values would not
+   * fit in the buffer in fixed notation.
+   */
 
-  if (xmlcall->error)
+  if (value < 1e50 && value > -1e50)
     {
-      strcat(&xmlcall->response[strlen(xmlcall->response)], "  <fault>\n");
+      snprintf(text, sizeof(text), "%f", value);
     }
   else
     {
-      strcat(&xmlcall->response[strlen(xmlcall->response)],
-             "  <params><param>\n");
+      snprintf(text, sizeof(text), "%g", value);
     }
 
+  return xmlrpc_putscalar(writer, name, "double", text, false);
+}
+
+int xmlrpc_putstring(FAR struct xmlrpc_writer_s *writer,
+                     FAR const char *name, FAR const char *value)
+{
+  return xmlrpc_putscalar(writer, name, "string", value, true);
+}
+
+/****************************************************************************
+ * Name: xmlrpc_beginarray, xmlrpc_endarray, xmlrpc_beginstruct and
+ *   xmlrpc_endstruct
+ *
+ * Description:
+ *   Open and close an array or a struct.  Inside a struct, each value is
+ *   given a member name.
+ *
+ ****************************************************************************/
+
+int xmlrpc_beginarray(FAR struct xmlrpc_writer_s *writer,
+                      FAR const char *name)
+{
+  return xmlrpc_begincontainer(writer, name, "<array><data>\r\n");
+}
+
+int xmlrpc_endarray(FAR struct xmlrpc_writer_s *writer)
+{
+  return xmlrpc_endcontainer(writer, "</data></array>");
+}
+
+int xmlrpc_beginstruct(FAR struct xmlrpc_writer_s *writer,
+                       FAR const char *name)
+{
+  return xmlrpc_begincontainer(writer, name, "<struct>\r\n");
+}
+
+int xmlrpc_endstruct(FAR struct xmlrpc_writer_s *writer)
+{
+  return xmlrpc_endcontainer(writer, "</struct>");
+}
+
+int xmlrpc_buildresponse(struct xmlrpc_s* xmlcall, char *args, ...)
+{
+  FAR struct xmlrpc_writer_s *writer;
+  FAR const char *name = NULL;
+  va_list argp;
+  int ret, index = 0;
+  int isStruct = 0;
+
+  if ((xmlcall == NULL) || (args == NULL) || (xmlcall->writer == NULL))
+    {
+      return -1;
+    }
+
+  writer = xmlcall->writer;
+  ret = xmlrpc_beginresponse(writer);
+
   va_start(argp, args);
 
-  while (args[index])
+  while (ret == XMLRPC_NO_ERROR && args[index])
     {
-      if (isStruct)
+      if (isStruct && (args[index] != '{') && (args[index] != '}'))
         {
-          if ((args[index] != '{') && (args[index] != '}'))
-            {
-              sprintf(&xmlcall->response[strlen(xmlcall->response)],
-                      "  <member>\n");
-              sprintf(&xmlcall->response[strlen(xmlcall->response)],
-                      "    <name>%s</name>\n", va_arg(argp, char *));
-              close = 1;
-            }
+          name = va_arg(argp, char *);
+        }
+      else
+        {
+          name = NULL;
         }
 
       switch (args[index])
         {
         case '{':
-          sprintf(&xmlcall->response[strlen(xmlcall->response)],
-                  "  <value><struct>\n");
+          ret = xmlrpc_beginstruct(writer, NULL);
           isStruct = 1;
           break;
 
         case '}':
-          sprintf(&xmlcall->response[strlen(xmlcall->response)],
-                  "  </struct></value>\n");
+          ret = xmlrpc_endstruct(writer);
           isStruct = 0;
           break;
 
         case 'i':
-          i = va_arg(argp, int);
-          sprintf(&xmlcall->response[strlen(xmlcall->response)],
-                  "    <value><int>%d</int></value>\r\n", i);
+          ret = xmlrpc_putint(writer, name, va_arg(argp, int));
           break;
 
         case 'b':
-          i = va_arg(argp, int);
-          sprintf(&xmlcall->response[strlen(xmlcall->response)],
-                  "    <value><boolean>%d</boolean></value>\r\n", i);
+          ret = xmlrpc_putbool(writer, name, va_arg(argp, int));
           break;
 
         case 'd':
-          d = va_arg(argp, double);
-          sprintf(&xmlcall->response[strlen(xmlcall->response)],
-                  "    <value><double>%f</double></value>\r\n", d);
+          ret = xmlrpc_putdouble(writer, name, va_arg(argp, double));
           break;
 
         case 's':
-          s = va_arg(argp, char *);
-          sprintf(&xmlcall->response[strlen(xmlcall->response)],
-                  "    <value><string>%s</string></value>\r\n", s);
+          ret = xmlrpc_putstring(writer, name, va_arg(argp, char *));
           break;
 
         default:
-          return (XMLRPC_BAD_RESPONSE_ARG);
+          ret = XMLRPC_BAD_RESPONSE_ARG;
           break;
-
-        }
-
-      if (close)
-        {
-          sprintf(&xmlcall->response[strlen(xmlcall->response)],
-                  "  </member>\n");
-          close = 0;
         }
 
       index++;
@@ -261,26 +798,9 @@ int xmlrpc_buildresponse(struct xmlrpc_s* xmlcall, char *args, ...)
 
   va_end(argp);
 
-  if (xmlcall->error)
-    {
-      strcat(&xmlcall->response[strlen(xmlcall->response)], "  </fault>\r\n");
-    }
-  else
-    {
-      strcat(&xmlcall->response[strlen(xmlcall->response)],
-             "  </param></params>\r\n");
-    }
-
-  if (ret == 0)
-    {
-      strcat(&xmlcall->response[strlen(xmlcall->response)],
-             "</methodResponse>\r\n");
-
-      xmlrpc_insertlength(xmlcall);
-    }
-  else
+  if (ret == XMLRPC_NO_ERROR)
     {
-      xmlcall->response[0] = 0;
+      ret = xmlrpc_endresponse(writer);
     }
 
   return ret;
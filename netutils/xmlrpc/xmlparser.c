@@ -51,8 +51,12 @@
  * Included Files
  ****************************************************************************/
 
+#include <sys/types.h>
+#include <sys/socket.h>
 #include <ctype.h>
+#include <stddef.h>
 #include <string.h>
+#include <strings.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -62,16 +66,29 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
-#define TAG        0
-#define VALUE      1
-#define DONE       2
+/* Tokenizer states */
+
+#define STATE_TEXT 0  /* Scanning text for the next '<' */
+#define STATE_TAG  1  /* Scanning a tag for its closing '>' */
+#define STATE_STOP 2  /* Parsing complete or failed */
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct xmlrpc_typetag_s
+{
+  FAR const char *name;
+  uint8_t type;
+};
 
 /****************************************************************************
  * Private Data
  ****************************************************************************/
 
 static struct xmlrpc_s g_xmlcall;
-static char g_data[CONFIG_XMLRPC_STRINGSIZE+1];
+static struct xmlrpc_parser_s g_parser;
+static struct xmlrpc_writer_s g_writer;
 static struct xmlrpc_entry_s *g_entries = NULL;
 
 static const char *errorStrings[] =
@@ -83,18 +100,29 @@ static const char *errorStrings[] =
   /* 4 */ "Unexpected Boolean Argument...",
   /* 5 */ "Unexpected Double Argument...",
   /* 6 */ "Unexpected String Argument...",
-  /* 7 */ "Bad Response Argument..."
+  /* 7 */ "Bad Response Argument...",
+  /* 8 */ "Request too large..."
 };
 
 #define MAX_ERROR_CODE  (sizeof(errorStrings)/sizeof(char *))
 
-struct parsebuf_s
+static const struct xmlrpc_typetag_s g_typetags[] =
 {
-  char *buf;
-  int len;
-  int index;
+  { "i4",               XMLRPC_TYPE_INT      },
+  { "int",              XMLRPC_TYPE_INT      },
+  { "boolean",          XMLRPC_TYPE_BOOLEAN  },
+  { "double",           XMLRPC_TYPE_DOUBLE   },
+  { "string",           XMLRPC_TYPE_STRING   },
+  { "dateTime.iso8601", XMLRPC_TYPE_DATETIME },
+  { "base64",           XMLRPC_TYPE_BASE64   },
+  { "array",            XMLRPC_TYPE_ARRAY    },
+  { "struct",           XMLRPC_TYPE_STRUCT   }
 };
 
+#define NTYPETAGS (sizeof(g_typetags) / sizeof(struct xmlrpc_typetag_s))
+
+static const char g_notimplemented[] = "HTTP/1.1 501 Not Implemented\r\n\r\n";
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -120,285 +148,922 @@ static int xmlrpc_call(struct xmlrpc_s * call)
   return ret;
 }
 
-static int xmlrpc_getelement(struct parsebuf_s * pbuf, char *data, int dataSize)
+/****************************************************************************
+ * Name: xmlrpc_tagis
+ *
+ * Description:
+ *   Return true if the tag name of length len is 'name'.
+ *
+ ****************************************************************************/
+
+static bool xmlrpc_tagis(FAR const char *tag, size_t len,
+                         FAR const char *name)
 {
-  int j = 0;
-  int ret = XMLRPC_NO_ERROR;
+  return strncmp(tag, name, len) == 0 && name[len] == '\0';
+}
 
-  while (!isprint(pbuf->buf[pbuf->index]))
-    {
-      pbuf->index++;
-    }
+/****************************************************************************
+ * Name: xmlrpc_typeof
+ *
+ * Description:
+ *   Map a type element name to an XMLRPC_TYPE_* value.  Returns
+ *   XMLRPC_TYPE_NONE if the name is not a type element.
+ *
+ ****************************************************************************/
 
-  if (pbuf->index >= pbuf->len)
+static uint8_t xmlrpc_typeof(FAR const char *tag, size_t len)
+{
+  int i;
+
+  for (i = 0; i < NTYPETAGS; i++)
     {
-      return DONE;
+      if (xmlrpc_tagis(tag, len, g_typetags[i].name))
+        {
+          return g_typetags[i].type;
+        }
     }
 
-  if (pbuf->buf[pbuf->index] == '<')
+  return XMLRPC_TYPE_NONE;
+}
+
+/****************************************************************************
+ * Name: xmlrpc_decode
+ *
+ * Description:
+ *   Replace the XML character references in a string with the characters
+ *   they stand for.  The decoded form is never longer than the encoded
+ *   form so this is done in place.  Returns the decoded length.
+ *
+ ****************************************************************************/
+
+static size_t xmlrpc_decode(FAR char *str, size_t len)
+{
+  FAR char *src = str;
+  FAR char *end = str + len;
+  FAR char *dest;
+  FAR char *semi;
+  unsigned long ch;
+
+  /* Most strings contain no references at all */
+
+  src = memchr(str, '&', len);
+  if (src == NULL)
     {
-      ret = TAG;
+      return len;
     }
-  else
+
+  dest = src;
+  while (src < end)
     {
-      ret = VALUE;
+      if (*src != '&' ||
+          (semi = memchr(src, ';', end - src)) == NULL)
+        {
+          *dest++ = *src++;
+          continue;
+        }
+
+      len = semi - src + 1;
+      if (len == 4 && strncmp(src, "&lt;", 4) == 0)
+        {
+          *dest++ = '<';
+        }
+      else if (len == 4 && strncmp(src, "&gt;", 4) == 0)
+        {
+          *dest++ = '>';
+        }
+      else if (len == 5 && strncmp(src, "&amp;", 5) == 0)
+        {
+          *dest++ = '&';
+        }
+      else if (len == 6 && strncmp(src, "&quot;", 6) == 0)
+        {
+          *dest++ = '"';
+        }
+      else if (len == 6 && strncmp(src, "&apos;", 6) == 0)
+        {
+          *dest++ = '\'';
+        }
+      else if (len > 3 && src[1] == '#')
+        {
+          /* Numeric reference, emitted as UTF-8.  Even the shortest
+           * reference for a code point is at least as long as its UTF-8
+           * encoding.
+           */
+
+          if (src[2] == 'x' || src[2] == 'X')
+            {
+              ch = strtoul(&src[3], NULL, 16);
+            }
+          else
+            {
+              ch = strtoul(&src[2], NULL, 10);
+            }
+
+          if (ch < 0x80)
+            {
+              *dest++ = (char)ch;
+            }
+          else if (ch < 0x800)
+            {
+              *dest++ = (char)(0xc0 | (ch >> 6));
+              *dest++ = (char)(0x80 | (ch & 0x3f));
+            }
+          else if (ch < 0x10000)
+            {
+              *dest++ = (char)(0xe0 | (ch >> 12));
+              *dest++ = (char)(0x80 | ((ch >> 6) & 0x3f));
+              *dest++ = (char)(0x80 | (ch & 0x3f));
+            }
+          else
+            {
+              *dest++ = (char)(0xf0 | ((ch >> 18) & 0x07));
+              *dest++ = (char)(0x80 | ((ch >> 12) & 0x3f));
+              *dest++ = (char)(0x80 | ((ch >> 6) & 0x3f));
+              *dest++ = (char)(0x80 | (ch & 0x3f));
+            }
+        }
+      else
+        {
+          /* Unknown reference, keep it as is */
+
+          memmove(dest, src, len);
+          dest += len;
+        }
+
+      src += len;
     }
 
-  data[j++] = pbuf->buf[pbuf->index++];
+  return dest - str;
+}
+
+/****************************************************************************
+ * Name: xmlrpc_text
+ *
+ * Description:
+ *   Return the text between the end of the previous tag and the offset
+ *   'end' (the '<' of the current tag) as a decoded, NUL terminated slice.
+ *   The '<' has already been consumed by the tokenizer, so it can be
+ *   overwritten by the terminator.
+ *
+ ****************************************************************************/
+
+static void xmlrpc_text(FAR struct xmlrpc_parser_s *parser, size_t end,
+                        FAR struct xmlrpc_slice_s *slice)
+{
+  FAR char *text = &parser->buffer[parser->textstart];
+  size_t len;
+
+  len = xmlrpc_decode(text, end - parser->textstart);
+  text[len] = '\0';
 
-  while (j < dataSize)
+  slice->ptr = text;
+  slice->len = len;
+}
+
+/****************************************************************************
+ * Name: xmlrpc_opentag
+ *
+ * Description:
+ *   Handle an opening tag.
+ *
+ ****************************************************************************/
+
+static int xmlrpc_opentag(FAR struct xmlrpc_parser_s *parser,
+                          FAR const char *tag, size_t len)
+{
+  FAR struct xmlrpc_value_s *value;
+  FAR struct xmlrpc_value_s *parent;
+  uint8_t type;
+
+  if (xmlrpc_tagis(tag, len, "value"))
     {
-      if (pbuf->buf[pbuf->index] == '>')
+      if (parser->nvalues >= CONFIG_XMLRPC_MAXVALUES ||
+          parser->depth >= CONFIG_XMLRPC_MAXDEPTH)
         {
-          data[j++] = pbuf->buf[pbuf->index++];
-          break;
+          return XMLRPC_TOO_LARGE;
         }
-      else if ((pbuf->buf[pbuf->index] == '\n') ||
-               (pbuf->buf[pbuf->index] == '<'))
+
+      value = &parser->values[parser->nvalues];
+      memset(value, 0, sizeof(struct xmlrpc_value_s));
+
+      if (parser->depth > 0)
         {
-          break;
+          /* An array element or a struct member */
+
+          parent = &parser->values[parser->stack[parser->depth - 1]];
+          if (parent->type == XMLRPC_TYPE_STRUCT)
+            {
+              if (parser->member.ptr == NULL)
+                {
+                  return XMLRPC_PARSE_ERROR;
+                }
+
+              value->name = parser->member;
+              parser->member.ptr = NULL;
+              parser->member.len = 0;
+            }
+          else if (parent->type != XMLRPC_TYPE_ARRAY)
+            {
+              return XMLRPC_PARSE_ERROR;
+            }
+
+          parent->count++;
         }
       else
         {
-          data[j++] = pbuf->buf[pbuf->index++];
-          if (j >= dataSize)
-            ret = XMLRPC_PARSE_ERROR;
+          parser->nparams++;
         }
+
+      parser->stack[parser->depth++] = parser->nvalues++;
+      return XMLRPC_NO_ERROR;
     }
 
-  data[j] = 0;
-  return ret;
-}
+  type = xmlrpc_typeof(tag, len);
+  if (type != XMLRPC_TYPE_NONE)
+    {
+      /* A type element must be the only child of a <value> */
 
-static int xmlrpc_parseparam(struct parsebuf_s * pbuf)
-{
-  int type;
+      if (parser->depth == 0)
+        {
+          return XMLRPC_PARSE_ERROR;
+        }
+
+      value = &parser->values[parser->stack[parser->depth - 1]];
+      if (value->type != XMLRPC_TYPE_NONE)
+        {
+          return XMLRPC_PARSE_ERROR;
+        }
 
-  /* Next, we need a <value> tag */
+      value->type = type;
+      return XMLRPC_NO_ERROR;
+    }
+
+  /* Structural elements carry no information of their own */
 
-  type = xmlrpc_getelement(pbuf, g_data, CONFIG_XMLRPC_STRINGSIZE);
-  if (!((type == TAG) && (!strncmp(g_data, "<value>", 7))))
+  if (xmlrpc_tagis(tag, len, "methodCall") ||
+      xmlrpc_tagis(tag, len, "methodName") ||
+      xmlrpc_tagis(tag, len, "params") ||
+      xmlrpc_tagis(tag, len, "param") ||
+      xmlrpc_tagis(tag, len, "data") ||
+      xmlrpc_tagis(tag, len, "member") ||
+      xmlrpc_tagis(tag, len, "name"))
     {
-      return XMLRPC_PARSE_ERROR;
+      return XMLRPC_NO_ERROR;
     }
 
-  /* Now we get a variable tag, the type of the value */
+  return XMLRPC_PARSE_ERROR;
+}
 
-  type = xmlrpc_getelement(pbuf, g_data, CONFIG_XMLRPC_STRINGSIZE);
-  if (type != TAG)
+/****************************************************************************
+ * Name: xmlrpc_closetag
+ *
+ * Description:
+ *   Handle a closing tag.  'end' is the offset of its '<'.
+ *
+ ****************************************************************************/
+
+static int xmlrpc_closetag(FAR struct xmlrpc_parser_s *parser,
+                           FAR const char *tag, size_t len, size_t end)
+{
+  FAR struct xmlrpc_value_s *value;
+  uint8_t type;
+
+  if (xmlrpc_tagis(tag, len, "value"))
     {
-      return XMLRPC_PARSE_ERROR;
+      if (parser->depth == 0)
+        {
+          return XMLRPC_PARSE_ERROR;
+        }
+
+      value = &parser->values[parser->stack[--parser->depth]];
+      if (value->type == XMLRPC_TYPE_NONE)
+        {
+          /* A value without a type element is a string */
+
+          value->type = XMLRPC_TYPE_STRING;
+          xmlrpc_text(parser, end, &value->text);
+        }
+
+      value->next = parser->nvalues;
+      return XMLRPC_NO_ERROR;
+    }
+
+  type = xmlrpc_typeof(tag, len);
+  if (type != XMLRPC_TYPE_NONE)
+    {
+      if (parser->depth == 0)
+        {
+          return XMLRPC_PARSE_ERROR;
+        }
+
+      value = &parser->values[parser->stack[parser->depth - 1]];
+      if (value->type != type)
+        {
+          return XMLRPC_PARSE_ERROR;
+        }
+
+      if (type != XMLRPC_TYPE_ARRAY && type != XMLRPC_TYPE_STRUCT)
+        {
+          xmlrpc_text(parser, end, &value->text);
+        }
+
+      return XMLRPC_NO_ERROR;
     }
 
-  if (!strncmp(g_data, "<i4>", 4))
+  if (xmlrpc_tagis(tag, len, "methodName"))
     {
-      g_xmlcall.args[g_xmlcall.argsize] = 'i';
+      xmlrpc_text(parser, end, &parser->method);
     }
-  else if (!strncmp(g_data, "<int>", 5))
+  else if (xmlrpc_tagis(tag, len, "name"))
     {
-      g_xmlcall.args[g_xmlcall.argsize] = 'i';
+      xmlrpc_text(parser, end, &parser->member);
     }
-  else if (!strncmp(g_data, "<boolean>", 9))
+  else if (xmlrpc_tagis(tag, len, "methodCall"))
     {
-      g_xmlcall.args[g_xmlcall.argsize] = 'b';
+      if (parser->depth != 0 || parser->method.ptr == NULL)
+        {
+          return XMLRPC_PARSE_ERROR;
+        }
+
+      return XMLRPC_PARSE_DONE;
     }
-  else if (!strncmp(g_data, "<double>", 8))
+
+  return XMLRPC_NO_ERROR;
+}
+
+/****************************************************************************
+ * Name: xmlrpc_tag
+ *
+ * Description:
+ *   Handle one complete tag.  'tag' points just past the '<' and 'len'
+ *   excludes the closing '>'.
+ *
+ ****************************************************************************/
+
+static int xmlrpc_tag(FAR struct xmlrpc_parser_s *parser,
+                      FAR const char *tag, size_t len)
+{
+  size_t end = parser->tagstart;
+  size_t namelen;
+  bool closing = false;
+  bool empty = false;
+  int ret;
+
+  /* Skip the XML declaration, processing instructions and comments */
+
+  if (len == 0 || tag[0] == '?' || tag[0] == '!')
     {
-      g_xmlcall.args[g_xmlcall.argsize] = 'd';
+      return XMLRPC_NO_ERROR;
     }
-  else if (!strncmp(g_data, "<string>", 8))
+
+  if (tag[0] == '/')
     {
-      g_xmlcall.args[g_xmlcall.argsize] = 's';
+      closing = true;
+      tag++;
+      len--;
     }
-  else
+  else if (tag[len - 1] == '/')
     {
-      return XMLRPC_PARSE_ERROR;
+      empty = true;
+      len--;
     }
 
-  /* Now, parse the actual value */
+  /* The element name ends at the first blank; attributes are ignored */
+
+  for (namelen = 0; namelen < len && !isspace(tag[namelen]); namelen++);
 
-  type = xmlrpc_getelement(pbuf, g_data, CONFIG_XMLRPC_STRINGSIZE);
-  if (type != VALUE)
+  if (closing)
     {
-      return XMLRPC_PARSE_ERROR;
+      return xmlrpc_closetag(parser, tag, namelen, end);
     }
 
-  switch (g_xmlcall.args[g_xmlcall.argsize])
+  ret = xmlrpc_opentag(parser, tag, namelen);
+  if (ret == XMLRPC_NO_ERROR && empty)
     {
-    case 'i':
-    case 'b':
-      g_xmlcall.arguments[g_xmlcall.argsize].u.i = atoi(g_data);
-      break;
-    case 'd':
-      g_xmlcall.arguments[g_xmlcall.argsize].u.d = atof(g_data);
-      break;
-    case 's':
-      strcpy(g_xmlcall.arguments[g_xmlcall.argsize].u.string, g_data);
-      break;
-    default:
-      return XMLRPC_PARSE_ERROR;
+      /* <element/> is an element with no content */
+
+      parser->textstart = end;
+      ret = xmlrpc_closetag(parser, tag, namelen, end);
     }
 
-  g_xmlcall.argsize++;
+  return ret;
+}
+
+/****************************************************************************
+ * Name: xmlrpc_dispatch
+ *
+ * Description:
+ *   Call the registered function for a parsed request, or send the fault
+ *   response for the parse error 'ret'.
+ *
+ ****************************************************************************/
+
+static int xmlrpc_dispatch(int sock, FAR struct xmlrpc_parser_s *parser,
+                           int ret)
+{
+  int fault;
 
-  /* Now we close out the tag, starting with the type */
+  xmlrpc_writer_init(&g_writer, sock);
+  g_writer.http10 = parser->http10;
 
-  type = xmlrpc_getelement(pbuf, g_data, CONFIG_XMLRPC_STRINGSIZE);
-  if (!((type == TAG) && (!strncmp(g_data, "</", 2))))
+  memset(&g_xmlcall, 0, sizeof(struct xmlrpc_s));
+  g_xmlcall.parser = parser;
+  g_xmlcall.writer = &g_writer;
+  g_xmlcall.name   = parser->method.ptr;
+
+  if (ret == XMLRPC_PARSE_DONE)
     {
-      return XMLRPC_PARSE_ERROR;
+      ret = xmlrpc_call(&g_xmlcall);
+
+      /* The function must have produced a complete response */
+
+      if (ret == XMLRPC_NO_ERROR && xmlrpc_endresponse(&g_writer) < 0)
+        {
+          ret = XMLRPC_BAD_RESPONSE_ARG;
+        }
     }
+  else if (ret == XMLRPC_NO_ERROR)
+    {
+      /* The request ended before </methodCall> */
 
-  /* Next, look for the </value> close */
+      ret = XMLRPC_PARSE_ERROR;
+    }
 
-  type = xmlrpc_getelement(pbuf, g_data, CONFIG_XMLRPC_STRINGSIZE);
-  if (!((type == TAG) && (!strncmp(g_data, "</value>", 8))))
+  if (ret != XMLRPC_NO_ERROR)
     {
-      return XMLRPC_PARSE_ERROR;
+      /* Send fault response */
+
+      g_xmlcall.error = 1;
+
+      fault = -ret;
+      if (fault >= MAX_ERROR_CODE)
+        {
+          fault = 0;
+        }
+
+      xmlrpc_sendfault(&g_writer, fault, errorStrings[fault]);
     }
 
-  /* Finally, close out the </param> tag */
+  return ret;
+}
+
+/****************************************************************************
+ * Name: xmlrpc_findbody
+ *
+ * Description:
+ *   Look for the blank line that ends the HTTP request header, resuming
+ *   the search at *scan.  Returns the offset of the message body or zero
+ *   if the header is not complete yet.
+ *
+ ****************************************************************************/
+
+static size_t xmlrpc_findbody(FAR const char *buf, size_t len,
+                              FAR size_t *scan)
+{
+  size_t i;
 
-  type = xmlrpc_getelement(pbuf, g_data, CONFIG_XMLRPC_STRINGSIZE);
-  if (!((type == TAG) && (!strncmp(g_data, "</param>", 8))))
+  for (i = *scan; i < len; i++)
     {
-      return XMLRPC_PARSE_ERROR;
+      if (buf[i] == '\n' && i > 0 &&
+          (buf[i - 1] == '\n' ||
+           (i > 2 && buf[i - 1] == '\r' && buf[i - 2] == '\n')))
+        {
+          return i + 1;
+        }
     }
 
-  return XMLRPC_NO_ERROR;
+  *scan = len;
+  return 0;
+}
+
+/****************************************************************************
+ * Name: xmlrpc_http10
+ *
+ * Description:
+ *   Return true if the request line in the first 'len' bytes of 'buf' is
+ *   for HTTP/1.0, whose clients do not accept a chunked response.
+ *
+ ****************************************************************************/
+
+static bool xmlrpc_http10(FAR const char *buf, size_t len)
+{
+  FAR const char *end = memchr(buf, '\n', len);
+
+  if (end == NULL)
+    {
+      return false;
+    }
+
+  if (end > buf && end[-1] == '\r')
+    {
+      end--;
+    }
+
+  return end - buf >= 9 && memcmp(end - 9, " HTTP/1.0", 9) == 0;
+}
+
+/****************************************************************************
+ * Name: xmlrpc_contentlength
+ *
+ * Description:
+ *   Return the value of the Content-Length header or -1 if there is none.
+ *   'hdr' must be NUL terminated.
+ *
+ ****************************************************************************/
+
+static long xmlrpc_contentlength(FAR const char *hdr)
+{
+  FAR const char *line;
+
+  for (line = strchr(hdr, '\n'); line != NULL; line = strchr(line, '\n'))
+    {
+      line++;
+      if (strncasecmp(line, "Content-Length:", 15) == 0)
+        {
+          return strtol(line + 15, NULL, 10);
+        }
+    }
+
+  return -1;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: xmlrpc_parser_init
+ *
+ * Description:
+ *   Prepare to parse a request received into 'buffer'.
+ *
+ ****************************************************************************/
+
+void xmlrpc_parser_init(FAR struct xmlrpc_parser_s *parser,
+                        FAR char *buffer, size_t bufsize)
+{
+  memset(parser, 0, offsetof(struct xmlrpc_parser_s, values));
+  parser->buffer  = buffer;
+  parser->bufsize = bufsize;
 }
 
-static int xmlrpc_parseparams(struct parsebuf_s * pbuf)
+/****************************************************************************
+ * Name: xmlrpc_parser_feed
+ *
+ * Description:
+ *   Parse 'nbytes' more bytes that the caller has placed at
+ *   &parser->buffer[parser->nbytes].  Each byte is examined only once, no
+ *   matter how the request is split.
+ *
+ * Returned Value:
+ *   XMLRPC_NO_ERROR if more data is needed, XMLRPC_PARSE_DONE once the
+ *   closing </methodCall> has been parsed, or a negative XMLRPC error.
+ *
+ ****************************************************************************/
+
+int xmlrpc_parser_feed(FAR struct xmlrpc_parser_s *parser, size_t nbytes)
 {
-  int type, ret = XMLRPC_PARSE_ERROR;
+  FAR char *buffer = parser->buffer;
+  FAR char *ptr;
+  int ret;
+
+  if (parser->state == STATE_STOP)
+    {
+      return parser->result;
+    }
 
-  /* First, look for the params tag */
+  parser->nbytes += nbytes;
 
-  type = xmlrpc_getelement(pbuf, g_data, CONFIG_XMLRPC_STRINGSIZE);
-  if ((type == TAG) && (!strncmp(g_data, "<params>", 8)))
+  while (parser->pos < parser->nbytes)
     {
-      while (1)
+      if (parser->state == STATE_TEXT)
         {
-          /* Get next tag */
+          ptr = memchr(&buffer[parser->pos], '<',
+                       parser->nbytes - parser->pos);
+          if (ptr == NULL)
+            {
+              parser->pos = parser->nbytes;
+              break;
+            }
 
-          type = xmlrpc_getelement(pbuf, g_data, CONFIG_XMLRPC_STRINGSIZE);
-          if ((type == TAG) && (!strncmp(g_data, "<param>", 7)))
+          parser->tagstart = ptr - buffer;
+          parser->pos      = parser->tagstart + 1;
+          parser->state    = STATE_TAG;
+        }
+      else
+        {
+          ptr = memchr(&buffer[parser->pos], '>',
+                       parser->nbytes - parser->pos);
+          if (ptr == NULL)
             {
-              ret = xmlrpc_parseparam(pbuf);
+              parser->pos = parser->nbytes;
+              break;
             }
-          else if ((type == TAG) && (!strncmp(g_data, "</params>", 9)))
+
+          parser->pos = ptr - buffer + 1;
+          nbytes = ptr - &buffer[parser->tagstart + 1];
+
+          /* A comment may contain '>'; it only ends at "-->" */
+
+          if (nbytes >= 3 && strncmp(&buffer[parser->tagstart + 1],
+                                     "!--", 3) == 0 &&
+              (nbytes < 5 || ptr[-1] != '-' || ptr[-2] != '-'))
             {
-              return XMLRPC_NO_ERROR;
+              continue;
             }
-          else
+
+          ret = xmlrpc_tag(parser, &buffer[parser->tagstart + 1], nbytes);
+          if (ret != XMLRPC_NO_ERROR)
             {
-              return XMLRPC_PARSE_ERROR;
+              parser->state  = STATE_STOP;
+              parser->result = ret;
+              return ret;
             }
+
+          parser->textstart = parser->pos;
+          parser->state     = STATE_TEXT;
         }
     }
 
-  return ret;
+  if (parser->nbytes >= parser->bufsize)
+    {
+      parser->state  = STATE_STOP;
+      parser->result = XMLRPC_TOO_LARGE;
+      return XMLRPC_TOO_LARGE;
+    }
+
+  return XMLRPC_NO_ERROR;
 }
 
-static int xmlrpc_parsemethod(struct parsebuf_s * pbuf)
+/****************************************************************************
+ * Name: xmlrpc_param
+ *
+ * Description:
+ *   Return the index'th parameter of the request or NULL.
+ *
+ ****************************************************************************/
+
+FAR const struct xmlrpc_value_s *
+  xmlrpc_param(FAR const struct xmlrpc_parser_s *parser, int index)
 {
-  int type, ret = XMLRPC_PARSE_ERROR;
+  int ndx = 0;
 
-  bzero((void *)&g_xmlcall, sizeof(struct xmlrpc_s));
+  if (index < 0 || index >= parser->nparams)
+    {
+      return NULL;
+    }
 
-  /* Look for the methodName tag */
+  while (index-- > 0)
+    {
+      ndx = parser->values[ndx].next;
+    }
 
-  type = xmlrpc_getelement(pbuf, g_data, CONFIG_XMLRPC_STRINGSIZE);
-  if ((type == TAG) && (!strncmp(g_data, "<methodName>", 12)))
+  return &parser->values[ndx];
+}
+
+/****************************************************************************
+ * Name: xmlrpc_element
+ *
+ * Description:
+ *   Return the index'th element of an array (or member of a struct) or
+ *   NULL.
+ *
+ ****************************************************************************/
+
+FAR const struct xmlrpc_value_s *
+  xmlrpc_element(FAR const struct xmlrpc_parser_s *parser,
+                 FAR const struct xmlrpc_value_s *container, int index)
+{
+  int ndx;
+
+  if (container == NULL ||
+      (container->type != XMLRPC_TYPE_ARRAY &&
+       container->type != XMLRPC_TYPE_STRUCT) ||
+      index < 0 || index >= container->count)
     {
-      /* Get the method name for the call */
+      return NULL;
+    }
 
-      type = xmlrpc_getelement(pbuf, g_data, CONFIG_XMLRPC_STRINGSIZE);
-      if (type == VALUE)
-        {
-          /* Save the method name */
+  ndx = container - parser->values + 1;
+  while (index-- > 0)
+    {
+      ndx = parser->values[ndx].next;
+    }
+
+  return &parser->values[ndx];
+}
 
-          strcpy(g_xmlcall.name, g_data);
+/****************************************************************************
+ * Name: xmlrpc_findmember
+ *
+ * Description:
+ *   Return the member of a struct with the given name or NULL.
+ *
+ ****************************************************************************/
 
-          /* Find the closing /methodCall */
+FAR const struct xmlrpc_value_s *
+  xmlrpc_findmember(FAR const struct xmlrpc_parser_s *parser,
+                    FAR const struct xmlrpc_value_s *container,
+                    FAR const char *name)
+{
+  FAR const struct xmlrpc_value_s *member;
+  size_t len = strlen(name);
+  int ndx;
+  int i;
 
-          type = xmlrpc_getelement(pbuf, g_data, CONFIG_XMLRPC_STRINGSIZE);
-          if ((type == TAG) && (!strncmp(g_data, "</methodName>", 13)))
-            {
-              /* Now, it's time to parse the parameters */
+  if (container == NULL || container->type != XMLRPC_TYPE_STRUCT)
+    {
+      return NULL;
+    }
 
-              ret = xmlrpc_parseparams(pbuf);
-            }
+  ndx = container - parser->values + 1;
+  for (i = 0; i < container->count; i++)
+    {
+      member = &parser->values[ndx];
+      if (member->name.len == len &&
+          memcmp(member->name.ptr, name, len) == 0)
+        {
+          return member;
         }
+
+      ndx = member->next;
     }
 
-  return ret;
+  return NULL;
 }
 
-static void xmlrpc_sendfault(int fault)
+/****************************************************************************
+ * Name: xmlrpc_value2int, xmlrpc_value2bool, xmlrpc_value2double and
+ *   xmlrpc_value2string
+ *
+ * Description:
+ *   Convert a scalar value.  Strings are returned as a pointer into the
+ *   request buffer.
+ *
+ ****************************************************************************/
+
+int xmlrpc_value2int(FAR const struct xmlrpc_value_s *value, FAR int *result)
 {
-  fault = -fault;
-  if (fault >= MAX_ERROR_CODE)
+  if (value == NULL || value->type != XMLRPC_TYPE_INT)
     {
-      fault = 0;
+      return XMLRPC_UNEXPECTED_INTEGER_ARG;
     }
 
-  xmlrpc_buildresponse(&g_xmlcall, "{is}",
-                        "faultCode", fault, "faultString", errorStrings[fault]);
+  *result = (int)strtol(value->text.ptr, NULL, 10);
+  return XMLRPC_NO_ERROR;
+}
+
+int xmlrpc_value2bool(FAR const struct xmlrpc_value_s *value,
+                      FAR int *result)
+{
+  if (value == NULL || value->type != XMLRPC_TYPE_BOOLEAN)
+    {
+      return XMLRPC_UNEXPECTED_BOOLEAN_ARG;
+    }
+
+  *result = (int)strtol(value->text.ptr, NULL, 10);
+  return XMLRPC_NO_ERROR;
+}
+
+int xmlrpc_value2double(FAR const struct xmlrpc_value_s *value,
+                        FAR double *result)
+{
+  if (value == NULL || value->type != XMLRPC_TYPE_DOUBLE)
+    {
+      return XMLRPC_UNEXPECTED_DOUBLE_ARG;
+    }
+
+  *result = strtod(value->text.ptr, NULL);
+  return XMLRPC_NO_ERROR;
+}
+
+int xmlrpc_value2string(FAR const struct xmlrpc_value_s *value,
+                        FAR const char **result)
+{
+  if (value == NULL || value->type != XMLRPC_TYPE_STRING)
+    {
+      return XMLRPC_UNEXPECTED_STRING_ARG;
+    }
+
+  *result = value->text.ptr;
+  return XMLRPC_NO_ERROR;
 }
 
 /****************************************************************************
- * Public Functions
+ * Name: xmlrpc_parse
+ *
+ * Description:
+ *   Parse the NUL terminated request body in 'buffer', call the registered
+ *   function and send the response to 'sock'.
+ *
  ****************************************************************************/
 
 int xmlrpc_parse(int sock, char *buffer)
 {
-  struct parsebuf_s pbuf;
-  int type;
-  int ret = XMLRPC_PARSE_ERROR;
+  size_t len = strlen(buffer);
+  int ret;
 
-  pbuf.buf = buffer;
-  pbuf.len = strlen(buffer);
-  pbuf.index = 0;
+  /* The terminator is part of the buffer so a complete body never trips
+   * the buffer-full check.
+   */
 
-  /* Parse the xml header tag */
+  xmlrpc_parser_init(&g_parser, buffer, len + 1);
+  ret = xmlrpc_parser_feed(&g_parser, len);
+  return xmlrpc_dispatch(sock, &g_parser, ret);
+}
 
-  type = xmlrpc_getelement(&pbuf, g_data, CONFIG_XMLRPC_STRINGSIZE);
-  if ((type == TAG) && (!strncmp(g_data, "<?xml", 5)))
-    {
-      type = xmlrpc_getelement(&pbuf, g_data, CONFIG_XMLRPC_STRINGSIZE);
-      if ((type == TAG) && (!strncmp(g_data, "<methodCall>", 12)))
-        {
-          /* Parse the remaining tags within the methodCall tag */
+/****************************************************************************
+ * Name: xmlrpc_serve
+ *
+ * Description:
+ *   Read one HTTP request from 'sock' into 'buffer', parsing the body as
+ *   it arrives, then call the registered function and send the response.
+ *
+ ****************************************************************************/
 
-          xmlrpc_parsemethod(&pbuf);
+int xmlrpc_serve(int sock, FAR char *buffer, size_t bufsize)
+{
+  size_t nbytes = 0;
+  size_t hdrlen = 0;
+  size_t scan = 0;
+  long contentlen;
+  ssize_t n;
+  int ret;
 
-          /* Check for the closing /methodCall */
+  /* Read the request header */
 
-          type = xmlrpc_getelement(&pbuf, g_data, CONFIG_XMLRPC_STRINGSIZE);
-          if ((type == TAG) && (!strncmp(g_data, "</methodCall>", 13)))
-            {
-              /* Successful parse, try to call a user function */
+  while (hdrlen == 0)
+    {
+      if (nbytes >= bufsize)
+        {
+          xmlrpc_parser_init(&g_parser, buffer, 0);
+          g_parser.http10 = xmlrpc_http10(buffer, nbytes);
+          return xmlrpc_dispatch(sock, &g_parser, XMLRPC_TOO_LARGE);
+        }
 
-              ret = xmlrpc_call(&g_xmlcall);
-            }
+      n = recv(sock, &buffer[nbytes], bufsize - nbytes, 0);
+      if (n <= 0)
+        {
+          return XMLRPC_PARSE_ERROR;
         }
+
+      nbytes += n;
+      hdrlen = xmlrpc_findbody(buffer, nbytes, &scan);
     }
 
-  if (ret == 0)
+  if (strncmp(buffer, "POST", 4) != 0)
     {
-      write(sock, g_xmlcall.response, strlen(g_xmlcall.response));
+      write(sock, g_notimplemented, sizeof(g_notimplemented) - 1);
+      return XMLRPC_PARSE_ERROR;
     }
-  else
+
+  /* The header ends with a newline, replace it with a terminator */
+
+  buffer[hdrlen - 1] = '\0';
+  contentlen = xmlrpc_contentlength(buffer);
+
+  /* Parse the body in place as it arrives */
+
+  xmlrpc_parser_init(&g_parser, &buffer[hdrlen], bufsize - hdrlen);
+  g_parser.http10 = xmlrpc_http10(buffer, hdrlen);
+  ret = xmlrpc_parser_feed(&g_parser, nbytes - hdrlen);
+
+  while (ret == XMLRPC_NO_ERROR &&
+         (contentlen < 0 || g_parser.nbytes < contentlen))
     {
-      /* Send fault response */
+      n = recv(sock, &g_parser.buffer[g_parser.nbytes],
+               g_parser.bufsize - g_parser.nbytes, 0);
+      if (n <= 0)
+        {
+          break;
+        }
 
-      g_xmlcall.error = 1;
-      xmlrpc_sendfault(ret);
-      write(sock, g_xmlcall.response, strlen(g_xmlcall.response));
+      ret = xmlrpc_parser_feed(&g_parser, n);
     }
 
-  return ret;
+  /* Consume anything that follows </methodCall> so that closing the
+   * connection does not reset it before the client has the response.
+   */
+
+  if (ret == XMLRPC_PARSE_DONE && contentlen > 0)
+    {
+      char discard[32];
+      long remaining = contentlen - (long)g_parser.nbytes;
+
+      while (remaining > 0)
+        {
+          n = recv(sock, discard, remaining < sizeof(discard) ?
+                   remaining : sizeof(discard), 0);
+          if (n <= 0)
+            {
+              break;
+            }
+
+          remaining -= n;
+        }
+    }
+
+  return xmlrpc_dispatch(sock, &g_parser, ret);
 }
 
 void xmlrpc_register(struct xmlrpc_entry_s *entry)
@@ -773,6 +773,12 @@ int nsh_loginscript(FAR struct nsh_vtbl_s *vtbl);
 #  undef CONFIG_NSH_ARCHINIT
 #endif
 
+/* Tab completion of NSH command names by readline() */
+
+#if !defined(CONFIG_NSH_CLE) && defined(CONFIG_READLINE_TABCOMPLETION)
+#  define NSH_HAVE_EXTMATCH 1
+#endif
+
 /* Basic session and message handling */
 
 struct console_stdio_s;
@@ -783,6 +789,10 @@ int nsh_parse(FAR struct nsh_vtbl_s *vtbl, char *cmdline);
 
 int nsh_command(FAR struct nsh_vtbl_s *vtbl, int argc, char *argv[]);
 
+#ifdef NSH_HAVE_EXTMATCH
+FAR const char *nsh_extmatch_getname(int index);
+#endif
+
 #ifdef CONFIG_NSH_BUILTIN_APPS
 int nsh_builtin(FAR struct nsh_vtbl_s *vtbl, FAR const char *cmd,
                 FAR char **argv, FAR const char *redirfile, int oflags);
@@ -1046,6 +1056,10 @@ void nsh_usbtrace(void);
 #  endif
 #endif
 
+#if defined(CONFIG_NETUTILS_CODECS) && !defined(CONFIG_NSH_DISABLE_SUM)
+      int cmd_sum(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv);
+#endif
+
 #if defined(CONFIG_NETUTILS_CODECS) && defined(CONFIG_CODECS_URLCODE)
 #  ifndef CONFIG_NSH_DISABLE_URLDECODE
       int cmd_urlencode(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv);
@@ -75,6 +75,11 @@
 #include <apps/netutils/md5.h>
 #endif
 
+#ifndef CONFIG_NSH_DISABLE_SUM
+#include <time.h>
+#include <apps/netutils/hash.h>
+#endif
+
 #include "nsh.h"
 #include "nsh_console.h"
 
@@ -92,6 +97,24 @@
 #define CODEC_MODE_BASE64DEC  4
 #define CODEC_MODE_HASH_MD5   5
 
+/* The sum command reads the file in chunks of this many bytes.  Keeping it
+ * a multiple of the hash block size lets every chunk but the last be
+ * hashed straight out of the read buffer.
+ */
+
+#ifndef CONFIG_NSH_SUM_BUFSIZE
+#  define CONFIG_NSH_SUM_BUFSIZE 4096
+#endif
+
+#define SUM_BUFSIZE \
+  ((CONFIG_NSH_SUM_BUFSIZE + HASH_BLOCKSIZE - 1) & ~(HASH_BLOCKSIZE - 1))
+
+#ifdef CONFIG_CLOCK_MONOTONIC
+#  define SUM_CLOCK CLOCK_MONOTONIC
+#else
+#  define SUM_CLOCK CLOCK_REALTIME
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -535,4 +558,164 @@ int cmd_md5(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
 }
 #endif
 
+/****************************************************************************
+ * Name: cmd_sum
+ ****************************************************************************/
+
+#ifndef CONFIG_NSH_DISABLE_SUM
+int cmd_sum(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
+{
+  FAR const struct hash_algorithm_s *alg;
+  struct hash_ctx_s ctx;
+  struct timespec start;
+  struct timespec end;
+  uint8_t digest[HASH_MAX_DIGESTSIZE];
+  char hex[2 * HASH_MAX_DIGESTSIZE + 1];
+  FAR uint8_t *buffer;
+  FAR char *fullpath;
+  bool timing = false;
+  bool badarg = false;
+  uint32_t elapsed;
+  off_t total;
+  ssize_t nbytes;
+  int option;
+  int fd;
+  int ret = ERROR;
+
+  /* Default to SHA-256 or, if that is not configured, to the strongest
+   * algorithm that is.
+   */
+
+  alg = hash_lookup("sha256");
+  if (alg == NULL)
+    {
+      alg = hash_algorithm(0);
+    }
+
+  while ((option = getopt(argc, argv, ":a:t")) != ERROR)
+    {
+      switch (option)
+        {
+          case 'a':
+            alg = hash_lookup(optarg);
+            if (alg == NULL)
+              {
+                nsh_output(vtbl, g_fmtarginvalid, argv[0]);
+                badarg = true;
+              }
+            break;
+
+          case 't':
+            timing = true;
+            break;
+
+          case ':':
+            nsh_output(vtbl, g_fmtargrequired, argv[0]);
+            badarg = true;
+            break;
+
+          case '?':
+          default:
+            nsh_output(vtbl, g_fmtarginvalid, argv[0]);
+            badarg = true;
+            break;
+        }
+    }
+
+  if (badarg)
+    {
+      return ERROR;
+    }
+
+  /* There should be exactly one parameter left on the command-line */
+
+  if (optind >= argc)
+    {
+      nsh_output(vtbl, g_fmtargrequired, argv[0]);
+      return ERROR;
+    }
+  else if (optind < argc - 1)
+    {
+      nsh_output(vtbl, g_fmttoomanyargs, argv[0]);
+      return ERROR;
+    }
+
+  fullpath = nsh_getfullpath(vtbl, argv[optind]);
+  if (fullpath == NULL)
+    {
+      return ERROR;
+    }
+
+  fd = open(fullpath, O_RDONLY);
+  if (fd < 0)
+    {
+      nsh_output(vtbl, g_fmtcmdfailed, argv[0], "open", NSH_ERRNO);
+      goto errout_with_fullpath;
+    }
+
+  buffer = (FAR uint8_t *)malloc(SUM_BUFSIZE);
+  if (buffer == NULL)
+    {
+      nsh_output(vtbl, g_fmtcmdoutofmemory, argv[0]);
+      goto errout_with_fd;
+    }
+
+  (void)clock_gettime(SUM_CLOCK, &start);
+
+  hash_init(&ctx, alg);
+  total = 0;
+
+  while ((nbytes = read(fd, buffer, SUM_BUFSIZE)) != 0)
+    {
+      if (nbytes < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+
+          nsh_output(vtbl, g_fmtcmdfailed, argv[0], "read", NSH_ERRNO);
+          goto errout_with_buffer;
+        }
+
+      hash_update(&ctx, buffer, nbytes);
+      total += nbytes;
+    }
+
+  hash_final(&ctx, digest);
+  (void)clock_gettime(SUM_CLOCK, &end);
+
+  hash_tohex(digest, alg->digestsize, hex);
+  nsh_output(vtbl, "%s  %s\n", hex, argv[optind]);
+
+  if (timing)
+    {
+      elapsed = (uint32_t)(end.tv_sec - start.tv_sec) * 1000 +
+                (end.tv_nsec - start.tv_nsec) / 1000000;
+
+      nsh_output(vtbl, "%s: %lu bytes in %lu msec",
+                 alg->name, (unsigned long)total, (unsigned long)elapsed);
+      if (elapsed > 0)
+        {
+          nsh_output(vtbl, " (%lu KB/s)",
+                     (unsigned long)(total / elapsed * 1000 / 1024));
+        }
+
+      nsh_output(vtbl, "\n");
+    }
+
+  ret = OK;
+
+errout_with_buffer:
+  free(buffer);
+
+errout_with_fd:
+  close(fd);
+
+errout_with_fullpath:
+  nsh_freefullpath(fullpath);
+  return ret;
+}
+#endif
+
 #endif /* CONFIG_NETUTILS_CODECS */
@@ -398,6 +398,10 @@ static const struct cmdmap_s g_cmdmap[] =
 # endif
 #endif
 
+#if defined(CONFIG_NETUTILS_CODECS) && !defined(CONFIG_NSH_DISABLE_SUM)
+  { "sum",      cmd_sum,      2, 5, "[-a <algorithm>] [-t] <file-path>" },
+#endif
+
 #if !defined(CONFIG_NSH_DISABLESCRIPT) && !defined(CONFIG_NSH_DISABLE_TEST)
   { "test",     cmd_test,     3, CONFIG_NSH_MAXARGUMENTS, "<expression>" },
 #endif
@@ -824,3 +828,29 @@ int nsh_command(FAR struct nsh_vtbl_s *vtbl, int argc, char *argv[])
    ret = handler(vtbl, argc, argv);
    return ret;
 }
+
+/****************************************************************************
+ * Name: nsh_extmatch_getname
+ *
+ * Description:
+ *   Return the name of the command with the given index, followed by the
+ *   names of the built-in applications, for readline() Tab completion.
+ *   NULL is returned after the last name.
+ *
+ ****************************************************************************/
+
+#ifdef NSH_HAVE_EXTMATCH
+FAR const char *nsh_extmatch_getname(int index)
+{
+  if (index < (int)NUM_CMDS)
+    {
+      return g_cmdmap[index].cmd;
+    }
+
+#ifdef CONFIG_NSH_BUILTIN_APPS
+  return builtin_getname(index - NUM_CMDS);
+#else
+  return NULL;
+#endif
+}
+#endif
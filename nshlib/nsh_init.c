@@ -44,6 +44,10 @@
 
 #include "nsh.h"
 
+#ifdef NSH_HAVE_EXTMATCH
+#  include <apps/readline.h>
+#endif
+
 /****************************************************************************
  * Definitions
  ****************************************************************************/
@@ -60,6 +64,13 @@
  * Private Data
  ****************************************************************************/
 
+#ifdef NSH_HAVE_EXTMATCH
+static const struct extmatch_vtable_s g_nsh_extmatch =
+{
+  nsh_extmatch_getname
+};
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -90,6 +101,13 @@
 
 void nsh_initialize(void)
 {
+#ifdef NSH_HAVE_EXTMATCH
+  /* Tab completes NSH command names and redraws the NSH prompt */
+
+  (void)readline_prompt(g_nshprompt);
+  (void)readline_extmatch(&g_nsh_extmatch);
+#endif
+
   /* Mount the /etc filesystem */
 
   (void)nsh_romfsetc();
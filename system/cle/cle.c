@@ -53,6 +53,7 @@
 #include <nuttx/ascii.h>
 #include <nuttx/vt100.h>
 
+#include <apps/vtscreen.h>
 #include <apps/cle.h>
 
 /****************************************************************************
@@ -158,13 +159,11 @@ struct cle_s
 {
   uint16_t curpos;          /* Current cursor position */
   uint16_t cursave;         /* Saved cursor position */
-  uint16_t row;             /* This is the row that we are editing in */
-  uint16_t coloffs;         /* Left cursor offset */
   uint16_t linelen;         /* Size of the line buffer */
   uint16_t nchars;          /* Size of data in the line buffer */
   int infd;                 /* Input file descriptor */
-  int outfd;                /* Output file descriptor */
   FAR char *line;           /* Line buffer */
+  struct vtscreen_s screen; /* The display row that we are editing in */
 };
 
 /****************************************************************************
@@ -181,12 +180,8 @@ static void     cle_write(FAR struct cle_s *priv, FAR const char *buffer,
                   uint16_t buflen);
 static void     cle_putch(FAR struct cle_s *priv, char ch);
 static int      cle_getch(FAR struct cle_s *priv);
-static void     cle_cursoron(FAR struct cle_s *priv);
-static void     cle_cursoroff(FAR struct cle_s *priv);
-static void     cle_setcursor(FAR struct cle_s *priv, uint16_t column);
 static int      cle_getcursor(FAR struct cle_s *priv, uint16_t *prow,
                   uint16_t *pcolumn);
-static void     cle_clrtoeol(FAR struct cle_s *priv);
 
 /* Editor function */
 
@@ -203,11 +198,7 @@ static int      cle_editloop(FAR struct cle_s *priv);
 
 /* VT100 escape sequences */
 
-static const char g_cursoron[]     = VT100_CURSORON;
-static const char g_cursoroff[]    = VT100_CURSOROFF;
 static const char g_getcursor[]    = VT100_GETCURSOR;
-static const char g_erasetoeol[]   = VT100_CLEAREOL;
-static const char g_fmtcursorpos[] = VT100_FMT_CURSORPOS;
 
 /****************************************************************************
  * Private Functions
@@ -240,54 +231,15 @@ static int cle_debug(FAR const char *fmt, ...)
  * Name: cle_write
  *
  * Description:
- *   Write a sequence of bytes to the console output device.
+ *   Add a sequence of bytes to the console output.  The output is buffered
+ *   and sent when the display is updated or before waiting for input.
  *
  ****************************************************************************/
 
 static void cle_write(FAR struct cle_s *priv, FAR const char *buffer,
                       uint16_t buflen)
 {
-  ssize_t nwritten;
-  uint16_t  nremaining = buflen;
-
-  //clevdbg("buffer=%p buflen=%d\n", buffer, (int)buflen);
-
-  /* Loop until all bytes have been successfully written (or until a
-   * unrecoverable error is encountered)
-   */
-
-  do
-    {
-      /* Take the next gulp */
-
-      nwritten = write(priv->outfd, buffer, buflen);
-
-      /* Handle write errors.  write() should neve return 0. */
-
-      if (nwritten <= 0)
-        {
-          /* EINTR is not really an error; it simply means that a signal was
-           * received while waiting for write.
-           */
-
-          int errcode = errno;
-          if (nwritten == 0 || errcode != EINTR)
-            {
-              cledbg("ERROR: write to stdout failed: %d\n", errcode);
-              return;
-            }
-        }
-
-      /* Decrement the count of bytes remaining to be sent (to handle the
-       * case of a partial write)
-       */
-
-      else
-        {
-          nremaining -= nwritten;
-        }
-    }
-  while (nremaining > 0);
+  vtscreen_write(&priv->screen, buffer, buflen);
 }
 
 /****************************************************************************
@@ -315,6 +267,16 @@ static int cle_getch(FAR struct cle_s *priv)
 {
   char buffer;
   ssize_t nread;
+  int ret;
+
+  /* Send any buffered output before waiting for input */
+
+  ret = vtscreen_flush(&priv->screen);
+  if (ret < 0)
+    {
+      cledbg("ERROR: write to stdout failed: %d\n", -ret);
+      return -EIO;
+    }
 
   /* Loop until we successfully read a character (or until an unexpected
    * error occurs).
@@ -350,60 +312,6 @@ static int cle_getch(FAR struct cle_s *priv)
   return buffer;
 }
 
-/****************************************************************************
- * Name: cle_cursoron
- *
- * Description:
- *   Turn on the cursor
- *
- ****************************************************************************/
-
-static void cle_cursoron(FAR struct cle_s *priv)
-{
-  /* Send the VT100 CURSORON command */
-
-  cle_write(priv, g_cursoron, sizeof(g_cursoron));
-}
-
-/****************************************************************************
- * Name: cle_cursoroff
- *
- * Description:
- *   Turn off the cursor
- *
- ****************************************************************************/
-
-static void cle_cursoroff(FAR struct cle_s *priv)
-{
-  /* Send the VT100 CURSOROFF command */
-
-  cle_write(priv, g_cursoroff, sizeof(g_cursoroff));
-}
-
-/****************************************************************************
- * Name: cle_setcursor
- *
- * Description:
- *   Move the current cursor position to position (row,col)
- *
- ****************************************************************************/
-
-static void cle_setcursor(FAR struct cle_s *priv, uint16_t column)
-{
-  char buffer[16];
-  int len;
-
-  clevdbg("row=%d column=%d offset=%d\n", priv->row, column, priv->coloffs);
-
-  /* Format the cursor position command.  The origin is (1,1). */
-
-  len = snprintf(buffer, 16, g_fmtcursorpos, priv->row, column + priv->coloffs);
-
-  /* Send the VT100 CURSORPOS command */
-
-  cle_write(priv, buffer, len);
-}
-
 /****************************************************************************
  * Name: cle_getcursor
  *
@@ -538,22 +446,6 @@ static int cle_getcursor(FAR struct cle_s *priv, FAR uint16_t *prow,
   return -ERANGE;
 }
 
-/****************************************************************************
- * Name: cle_clrtoeol
- *
- * Description:
- *   Clear the display from the current cursor position to the end of the
- *   current line.
- *
- ****************************************************************************/
-
-static void cle_clrtoeol(FAR struct cle_s *priv)
-{
-  /* Send the VT100 ERASETOEOL command */
-
-  cle_write(priv, g_erasetoeol, sizeof(g_erasetoeol));
-}
-
 /****************************************************************************
  * Name: cle_opentext
  *
@@ -646,38 +538,42 @@ static void cle_closetext(FAR struct cle_s *priv, uint16_t pos, uint16_t size)
  *
  * Description:
  *   Update the display based on the last operation.  This function is
- *   called at the beginning of the editor loop.
+ *   called at the beginning of the editor loop.  The line is formatted into
+ *   the screen row and only the differences from what is already on the
+ *   display are sent.
  *
  ****************************************************************************/
 
 static void cle_showtext(FAR struct cle_s *priv)
 {
+  FAR char *row = vtscreen_getrow(&priv->screen, 0);
+  uint16_t cursor = 0;
   uint16_t column;
   uint16_t tabcol;
+  uint16_t i;
+  int ret;
 
-  /* Turn off the cursor during the update. */
-
-  cle_cursoroff(priv);
-
-  /* Set the cursor position to the beginning of this row */
+  /* Loop for each character in the line */
 
-  cle_setcursor(priv, 0);
-  cle_clrtoeol(priv);
+  for (column = 0, i = 0; i < priv->nchars; i++)
+    {
+      /* The cursor is displayed at the start of the character at curpos */
 
-  /* Loop for each column */
+      if (i == priv->curpos)
+        {
+          cursor = column;
+        }
 
-  for (column = 0; column < priv->nchars; )
-    {
       /* Perform TAB expansion */
 
-      if (priv->line[column] == '\t')
+      if (priv->line[i] == '\t')
         {
           tabcol = NEXT_TAB(column);
           if (tabcol < priv->linelen)
             {
               for (; column < tabcol; column++)
                 {
-                  cle_putch(priv, ' ');
+                  row[column] = ' ';
                 }
             }
           else
@@ -692,16 +588,28 @@ static void cle_showtext(FAR struct cle_s *priv)
 
       /* Add the normal character to the display */
 
-      else
+      else if (column < priv->linelen)
         {
-          cle_putch(priv, priv->line[column]);
+          row[column] = priv->line[i];
           column++;
         }
     }
 
-  /* Turn the cursor back on */
+  if (priv->curpos >= i)
+    {
+      cursor = column;
+    }
+
+  /* Update the display row and leave the cursor at the current position */
+
+  vtscreen_setrow(&priv->screen, 0, column);
+  vtscreen_setcursor(&priv->screen, 0, cursor);
 
-  cle_cursoron(priv);
+  ret = vtscreen_refresh(&priv->screen);
+  if (ret < 0)
+    {
+      cledbg("ERROR: write to stdout failed: %d\n", -ret);
+    }
 }
 
 /****************************************************************************
@@ -745,7 +653,6 @@ static int cle_editloop(FAR struct cle_s *priv)
       /* Make sure that the display reflects the current state */
 
       cle_showtext(priv);
-      cle_setcursor(priv, priv->curpos);
 
       /* Get the next character from the input */
 
@@ -921,6 +828,7 @@ static int cle_editloop(FAR struct cle_s *priv)
 int cle(FAR char *line, uint16_t linelen, FILE *instream, FILE *outstream)
 {
   FAR struct cle_s priv;
+  uint16_t row;
   uint16_t column;
   int ret;
 
@@ -934,33 +842,48 @@ int cle(FAR char *line, uint16_t linelen, FILE *instream, FILE *outstream)
   /* REVISIT:  Non-standard, non-portable */
 
   priv.infd     = instream->fs_fd;
-  priv.outfd    = outstream->fs_fd;
 
-  /* Get the current cursor position */
+  /* The line is edited in one screen row that is as wide as the line
+   * buffer.
+   */
 
-  ret = cle_getcursor(&priv, &priv.row, &column);
+  ret = vtscreen_initialize(&priv.screen, outstream->fs_fd, 1, linelen, 0);
   if (ret < 0)
     {
       return ret;
     }
 
-  /* Turn the column number into an offset */
+  /* Get the current cursor position */
+
+  ret = cle_getcursor(&priv, &row, &column);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  /* The row and column numbers are one-based */
 
-  if (column < 1)
+  if (row < 1 || column < 1)
     {
-      return -EINVAL;
+      ret = -EINVAL;
+      goto errout;
     }
 
-  priv.coloffs = column - 1;
+  clevdbg("row=%d column=%d\n", row, column);
+
+  /* Editing starts at the current cursor position */
 
-  clevdbg("row=%d column=%d\n", priv.row, column);
+  vtscreen_origin(&priv.screen, row - 1, column - 1);
 
   /* The editor loop */
 
   ret = cle_editloop(&priv);
 
+errout:
+
   /* Make sure that the line is NUL terminated */
 
   line[priv.nchars] = '\0';
+  vtscreen_release(&priv.screen);
   return ret;
 }
@@ -39,10 +39,13 @@
 
 #include <nuttx/config.h>
 
+#include <sys/types.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
+#include <errno.h>
 
-#include <nuttx/streams.h>
 #include <apps/hex2bin.h>
 
 #ifdef CONFIG_SYSTEM_HEX2BIN
@@ -55,10 +58,69 @@
  * Private Types
  ****************************************************************************/
 
+struct fhex2mem_s
+{
+  FAR FILE *instream;           /* HEX input */
+  FAR uint8_t *base;            /* Memory at baseaddr */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static ssize_t fhex2mem_read(FAR void *arg, FAR uint8_t *buffer,
+                             size_t buflen);
+static int fhex2mem_write(FAR void *arg, uint32_t offset,
+                          FAR const uint8_t *data, size_t len);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct hex2bin_ops_s g_fhex2mem_ops =
+{
+  fhex2mem_read,
+  fhex2mem_write,
+  NULL
+};
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: fhex2mem_read
+ *
+ * Description:
+ *   Return the stream a line at a time so that input from a console is
+ *   handled as it is typed.
+ *
+ ****************************************************************************/
+
+static ssize_t fhex2mem_read(FAR void *arg, FAR uint8_t *buffer,
+                             size_t buflen)
+{
+  FAR FILE *instream = ((FAR struct fhex2mem_s *)arg)->instream;
+
+  if (fgets((FAR char *)buffer, buflen, instream) == NULL)
+    {
+      return ferror(instream) ? -EIO : 0;
+    }
+
+  return strlen((FAR char *)buffer);
+}
+
+/****************************************************************************
+ * Name: fhex2mem_write
+ ****************************************************************************/
+
+static int fhex2mem_write(FAR void *arg, uint32_t offset,
+                          FAR const uint8_t *data, size_t len)
+{
+  memcpy(((FAR struct fhex2mem_s *)arg)->base + offset, data, len);
+  return OK;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -90,26 +152,17 @@
 int fhex2mem(FAR FILE *instream, uint32_t baseaddr, uint32_t endpaddr,
              enum hex2bin_swap_e swap)
 {
-  struct lib_stdinstream_s stdinstream;
-  struct lib_memsostream_s memoutstream;
+  struct fhex2mem_s fhex2mem;
 
   /* Check memory addresses */
 
   DEBUGASSERT(instream && endpaddr > baseaddr);
 
-  /* Wrap the file descriptor as raw stream; wrap the memory as a memory
-   * stream.
-   */
-
-  lib_stdinstream(&stdinstream, instream);
-  lib_memsostream(&memoutstream, (FAR char *)baseaddr,
-                  (int)(endpaddr - baseaddr));
-
-  /* And do the deed */
+  fhex2mem.instream = instream;
+  fhex2mem.base     = (FAR uint8_t *)baseaddr;
 
-  return hex2bin(&stdinstream.public, &memoutstream.public,
-                 (uint32_t)baseaddr, (uint32_t)endpaddr,
-                 (enum hex2bin_swap_e)swap);
+  return hex2bin_io(&g_fhex2mem_ops, &fhex2mem, baseaddr, endpaddr, 0, 0,
+                    swap);
 }
 
 #endif /* CONFIG_SYSTEM_HEX2BIN */
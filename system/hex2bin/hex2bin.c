@@ -44,6 +44,8 @@
 
 #include <nuttx/config.h>
 
+#include <sys/types.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -114,10 +116,59 @@
 #define RECORD_EXT_LINADDR     4  /* Extended linear address record */
 #define RECORD_START_LINADDR   5  /* Start linear address record */
 
+/* End of line */
+
+#if defined(CONFIG_EOL_IS_LF) || defined(CONFIG_EOL_IS_BOTH_CRLF)
+#  define IS_EOL(c)            ((c) == '\n')
+#elif defined(CONFIG_EOL_IS_CR)
+#  define IS_EOL(c)            ((c) == '\r')
+#else /* CONFIG_EOL_IS_EITHER_CRLF */
+#  define IS_EOL(c)            ((c) == '\n' || (c) == '\r')
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
 
+/* State of one conversion */
+
+struct hex2bin_s
+{
+  FAR const struct hex2bin_ops_s *ops;
+  FAR void *arg;
+  int rderror;                  /* Error reported by ops->read() */
+  bool eof;                     /* ops->read() returned end of input */
+
+  /* Input buffer */
+
+  FAR uint8_t *inbuf;
+  uint16_t inndx;               /* Next unread byte in inbuf[] */
+  uint16_t inlen;               /* Bytes in inbuf[] */
+
+  /* Output coalescing buffer.  outbuf[] holds data for offsets outoffset
+   * through outoffset + outsize - 1.  outlen is zero if there is nothing
+   * to write; otherwise, without a block size, it is the length of the
+   * contiguous run in outbuf[].
+   */
+
+  FAR uint8_t *outbuf;
+  uint32_t outoffset;
+  uint16_t outsize;
+  uint16_t outlen;
+  uint16_t blocksize;           /* Zero: write runs, not aligned blocks */
+  uint8_t fill;
+  uint32_t written;             /* End of the highest block written */
+};
+
+/* hex2bin() adapts its streams to the block interface */
+
+struct hex2bin_streams_s
+{
+  FAR struct lib_instream_s *instream;
+  FAR struct lib_sostream_s *outstream;
+  uint32_t position;            /* Current offset in the OUT stream */
+};
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -247,65 +298,107 @@ int data2bin(FAR uint8_t* dest, FAR const uint8_t *src, int nsrcbytes)
   return OK;
 }
 
+/****************************************************************************
+ * Name: hex2bin_fill
+ *
+ * Description:
+ *   Refill the input buffer from ops->read().  Returns EOF at the end of
+ *   the input or on a read error.
+ *
+ ****************************************************************************/
+
+static int hex2bin_fill(FAR struct hex2bin_s *priv)
+{
+  ssize_t nread;
+
+  if (priv->eof)
+    {
+      return EOF;
+    }
+
+  nread = priv->ops->read(priv->arg, priv->inbuf,
+                          CONFIG_SYSTEM_HEX2BIN_BUFSIZE);
+  if (nread <= 0)
+    {
+      priv->rderror = (int)nread;
+      priv->eof     = true;
+      return EOF;
+    }
+
+  priv->inndx = 0;
+  priv->inlen = (uint16_t)nread;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: hex2bin_getc
+ *
+ * Description:
+ *   Return the next byte of HEX data.  The buffer position is kept in the
+ *   caller's local variables so that it is not reloaded after every store
+ *   into the line buffer.
+ *
+ ****************************************************************************/
+
+static inline int hex2bin_getc(FAR struct hex2bin_s *priv,
+                               FAR uint16_t *inndx, FAR uint16_t *inlen)
+{
+  if (*inndx >= *inlen)
+    {
+      if (hex2bin_fill(priv) < 0)
+        {
+          *inndx = *inlen = 0;
+          return EOF;
+        }
+
+      *inndx = 0;
+      *inlen = priv->inlen;
+    }
+
+  return priv->inbuf[(*inndx)++];
+}
+
 /****************************************************************************
  * Name: readstream
  ****************************************************************************/
 
-static int readstream(FAR struct lib_instream_s *instream,
-                      FAR uint8_t *line, unsigned int lineno)
+static int readstream(FAR struct hex2bin_s *priv, FAR uint8_t *line,
+                      unsigned int lineno)
 {
+  uint16_t inndx = priv->inndx;
+  uint16_t inlen = priv->inlen;
   int nbytes = 0;
   int ch;
 
   /* Skip until the beginning of line start code is encountered */
 
-  ch = instream->get(instream);
+  ch = hex2bin_getc(priv, &inndx, &inlen);
   while (ch != RECORD_STARTCODE && ch != EOF)
     {
-      ch = instream->get(instream);
+      ch = hex2bin_getc(priv, &inndx, &inlen);
     }
 
   /* Skip over the startcode */
 
   if (ch != EOF)
     {
-      ch = instream->get(instream);
+      ch = hex2bin_getc(priv, &inndx, &inlen);
     }
 
-  /* Then read, verify, and buffer until the end of line is encountered */
+  /* Then read, verify, and buffer until the end of line is encountered.
+   * With CONFIG_EOL_IS_BOTH_CRLF, the CR is skipped as white space.
+   */
 
   while (ch != EOF && nbytes < (MAXRECORD_ASCSIZE-1))
     {
-#if defined(CONFIG_EOL_IS_LF)
-      if (ch == '\n')
+      if (IS_EOL(ch))
         {
-          *line = '\0';
+          *line       = '\0';
+          priv->inndx = inndx;
+          priv->inlen = inlen;
           return nbytes;
         }
 
-#elif defined(CONFIG_EOL_IS_BOTH_CRLF)
-      if (ch == '\r')
-        {
-          continue;
-        }
-      else if (ch == '\n')
-        {
-          *line = '\0';
-          return nbytes;
-        }
-#elif defined(CONFIG_EOL_IS_CR)
-      if (ch == '\r')
-        {
-          *line = '\0';
-          return nbytes;
-        }
-#elif CONFIG_EOL_IS_EITHER_CRLF
-      if (ch == '\n' || ch == '\r')
-        {
-          *line = '\0';
-          return nbytes;
-        }
-#endif
       /* Only hex data goes into the line buffer */
 
       else if (isxdigit(ch))
@@ -322,13 +415,16 @@ static int readstream(FAR struct lib_instream_s *instream,
 
       /* Read the next character from the input stream */
 
-      ch = instream->get(instream);
+      ch = hex2bin_getc(priv, &inndx, &inlen);
     }
 
   /* Some error occurred: Unexpected EOF, line too long, or bad character in
    * stream
    */
 
+  priv->inndx = inndx;
+  priv->inlen = inlen;
+
   hex2bin_debug("Line %u ERROR: Failed to read line. %d characters read\n",
                 lineno, nbytes);
   return EOF;
@@ -366,17 +462,208 @@ static inline void hex2bin_swap32(FAR uint8_t *data, int bytecount)
     }
 }
 
+/****************************************************************************
+ * Name: hex2bin_flush
+ *
+ * Description:
+ *   Write out whatever is held in the coalescing buffer.
+ *
+ ****************************************************************************/
+
+static int hex2bin_flush(FAR struct hex2bin_s *priv)
+{
+  size_t len;
+  int ret;
+
+  if (priv->outlen == 0)
+    {
+      return OK;
+    }
+
+  len = priv->blocksize > 0 ? priv->blocksize : priv->outlen;
+  ret = priv->ops->write(priv->arg, priv->outoffset, priv->outbuf, len);
+  priv->outlen = 0;
+
+  if (priv->outoffset + len > priv->written)
+    {
+      priv->written = priv->outoffset + len;
+    }
+
+  return ret;
+}
+
 /****************************************************************************
  * Name: writedata
+ *
+ * Description:
+ *   Add the data of one record to the coalescing buffer, writing out the
+ *   buffer whenever the data moves past it.
+ *
+ *   A block below the highest one written so far may already hold data.
+ *   Its current contents are read back with ops->readback() and the new
+ *   data is merged into them, so that writing the block again does not
+ *   replace the earlier data with fill bytes.
+ *
  ****************************************************************************/
 
-static inline void writedata(FAR struct lib_sostream_s *outstream,
-                             FAR uint8_t *data, int bytecount)
+static int writedata(FAR struct hex2bin_s *priv, uint32_t offset,
+                     FAR const uint8_t *data, int bytecount)
 {
-  for (; bytecount > 0; bytecount--)
+  uint32_t bufndx;
+  uint32_t nbytes;
+  int ret;
+
+  while (bytecount > 0)
+    {
+      /* Does this data continue what is in the buffer?  With a block size,
+       * any offset inside the current block does; otherwise the data must
+       * follow on directly.
+       */
+
+      if (priv->outlen > 0)
+        {
+          bufndx = offset - priv->outoffset;
+          if (offset < priv->outoffset || bufndx >= priv->outsize ||
+              (priv->blocksize == 0 && bufndx != priv->outlen))
+            {
+              ret = hex2bin_flush(priv);
+              if (ret < 0)
+                {
+                  return ret;
+                }
+            }
+        }
+
+      /* Start a new buffer */
+
+      if (priv->outlen == 0)
+        {
+          if (priv->blocksize > 0)
+            {
+              priv->outoffset = offset - offset % priv->blocksize;
+              if (priv->outoffset >= priv->written)
+                {
+                  memset(priv->outbuf, priv->fill, priv->blocksize);
+                }
+              else if (priv->ops->readback == NULL)
+                {
+                  hex2bin_debug("ERROR: Data for %08lx is out of order\n",
+                                (unsigned long)offset);
+                  return -EINVAL;
+                }
+              else
+                {
+                  ret = priv->ops->readback(priv->arg, priv->outoffset,
+                                            priv->outbuf, priv->blocksize);
+                  if (ret < 0)
+                    {
+                      return ret;
+                    }
+                }
+            }
+          else
+            {
+              priv->outoffset = offset;
+            }
+        }
+
+      /* Copy as much as fits */
+
+      bufndx = offset - priv->outoffset;
+      nbytes = priv->outsize - bufndx;
+      if (nbytes > (uint32_t)bytecount)
+        {
+          nbytes = bytecount;
+        }
+
+      memcpy(&priv->outbuf[bufndx], data, nbytes);
+      if (bufndx + nbytes > priv->outlen)
+        {
+          priv->outlen = bufndx + nbytes;
+        }
+
+      offset    += nbytes;
+      data      += nbytes;
+      bytecount -= nbytes;
+
+      /* Write the buffer as soon as the data reaches its end */
+
+      if (offset - priv->outoffset >= priv->outsize)
+        {
+          ret = hex2bin_flush(priv);
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: hex2bin_streamread and hex2bin_streamwrite
+ *
+ * Description:
+ *   Block callbacks for hex2bin().  The stream read stops at the end of a
+ *   line so that an interactive stream is not asked for data that has not
+ *   been sent yet.
+ *
+ ****************************************************************************/
+
+static ssize_t hex2bin_streamread(FAR void *arg, FAR uint8_t *buffer,
+                                  size_t buflen)
+{
+  FAR struct hex2bin_streams_s *streams = (FAR struct hex2bin_streams_s *)arg;
+  FAR struct lib_instream_s *instream = streams->instream;
+  size_t nread = 0;
+  int ch;
+
+  while (nread < buflen)
+    {
+      ch = instream->get(instream);
+      if (ch == EOF)
+        {
+          break;
+        }
+
+      buffer[nread++] = (uint8_t)ch;
+      if (ch == '\n' || ch == '\r')
+        {
+          break;
+        }
+    }
+
+  return nread;
+}
+
+static int hex2bin_streamwrite(FAR void *arg, uint32_t offset,
+                               FAR const uint8_t *data, size_t len)
+{
+  FAR struct hex2bin_streams_s *streams = (FAR struct hex2bin_streams_s *)arg;
+  FAR struct lib_sostream_s *outstream = streams->outstream;
+  off_t pos;
+
+  /* Seek only if the data does not follow on from the last write */
+
+  if (offset != streams->position)
+    {
+      pos = outstream->seek(outstream, offset, SEEK_SET);
+      if (pos == (off_t)-1)
+        {
+          hex2bin_debug("ERROR: Seek to offset %08lx failed\n",
+                        (unsigned long)offset);
+          return -ESPIPE;
+        }
+    }
+
+  streams->position = offset + len;
+  for (; len > 0; len--)
     {
       outstream->put(outstream, *data++);
     }
+
+  return OK;
 }
 
 /****************************************************************************
@@ -417,6 +704,36 @@ int hex2bin(FAR struct lib_instream_s *instream,
             FAR struct lib_sostream_s *outstream, uint32_t baseaddr,
             uint32_t endpaddr, enum hex2bin_swap_e swap)
 {
+  static const struct hex2bin_ops_s ops =
+  {
+    hex2bin_streamread,
+    hex2bin_streamwrite,
+    NULL
+  };
+
+  struct hex2bin_streams_s streams;
+
+  streams.instream  = instream;
+  streams.outstream = outstream;
+  streams.position  = 0;
+
+  return hex2bin_io(&ops, &streams, baseaddr, endpaddr, 0, 0, swap);
+}
+
+/****************************************************************************
+ * Name: hex2bin_io
+ *
+ * Description:
+ *   Like hex2bin(), but the HEX data is read and the binary is written in
+ *   blocks through the callbacks in 'ops'.  See apps/include/hex2bin.h.
+ *
+ ****************************************************************************/
+
+int hex2bin_io(FAR const struct hex2bin_ops_s *ops, FAR void *arg,
+               uint32_t baseaddr, uint32_t endpaddr, uint16_t blocksize,
+               uint8_t fill, enum hex2bin_swap_e swap)
+{
+  struct hex2bin_s priv;
   FAR uint8_t *alloc;
   FAR uint8_t *line;
   FAR uint8_t *bin;
@@ -424,7 +741,6 @@ int hex2bin(FAR struct lib_instream_s *instream,
   int bytecount;
   uint32_t address;
   uint32_t endaddr;
-  uint32_t expected;
   uint16_t extension;
   uint16_t address16;
   uint8_t checksum;
@@ -432,23 +748,35 @@ int hex2bin(FAR struct lib_instream_s *instream,
   int i;
   int ret = OK;
 
-  /* Allocate buffer memory */
+  /* Allocate buffer memory: the record line and its binary, the input
+   * buffer, and the output buffer of one block or one run.
+   */
+
+  memset(&priv, 0, sizeof(struct hex2bin_s));
+  priv.ops       = ops;
+  priv.arg       = arg;
+  priv.blocksize = blocksize;
+  priv.fill      = fill;
+  priv.outsize   = blocksize > 0 ? blocksize : CONFIG_SYSTEM_HEX2BIN_BUFSIZE;
 
-  alloc = (FAR uint8_t *)malloc(LINE_ALLOC + BIN_ALLOC);
+  alloc = (FAR uint8_t *)malloc(LINE_ALLOC + BIN_ALLOC +
+                                CONFIG_SYSTEM_HEX2BIN_BUFSIZE +
+                                priv.outsize);
   if (alloc == NULL)
     {
       hex2bin_debug("ERROR: Failed to allocate memory\n");
       return -ENOMEM;
     }
 
-  line = alloc;
-  bin  = &alloc[LINE_ALLOC];
+  line        = alloc;
+  bin         = &alloc[LINE_ALLOC];
+  priv.inbuf  = &alloc[LINE_ALLOC + BIN_ALLOC];
+  priv.outbuf = &priv.inbuf[CONFIG_SYSTEM_HEX2BIN_BUFSIZE];
 
   extension = 0;
-  expected = 0;
   lineno = 0;
 
-  while ((nbytes = readstream(instream, line, lineno)) != EOF)
+  while ((nbytes = readstream(&priv, line, lineno)) != EOF)
     {
       /* Increment the line number */
 
@@ -582,36 +910,23 @@ int hex2bin(FAR struct lib_instream_s *instream,
             address = ((uint32_t)extension << 16) | (uint32_t)address16;
             endaddr = address + bytecount;
 
-            if (address < baseaddr || (endpaddr != 0 && endaddr >= endpaddr))
+            if (address < baseaddr || (endpaddr != 0 && endaddr > endpaddr))
               {
                 hex2bin_debug("Line %d ERROR: Extended address %08lx is out of range\n",
                               lineno, (unsigned long)address);
                 goto errout_with_einval;
               }
 
-            /* Seek to the correct position in the OUT stream if we have
-             * made an unexpected jump in the data address.
-             */
+            /* Transfer data to the output */
 
-            if (address != expected)
+            ret = writedata(&priv, address - baseaddr, &bin[DATA_BINNDX],
+                            bytecount);
+            if (ret < 0)
               {
-                off_t pos = outstream->seek(outstream, address - baseaddr, SEEK_SET);
-                if (pos == (off_t)-1)
-                  {
-                    hex2bin_debug("Line %u ERROR: Seek to address %08lu failed\n",
-                                  lineno, (unsigned long)address);
-                    ret = -ESPIPE;
-                    goto errout_with_buffers;
-                  }
+                hex2bin_debug("Line %u ERROR: Write to address %08lx failed: %d\n",
+                              lineno, (unsigned long)address, ret);
+                goto errout_with_buffers;
               }
-
-            /* Transfer data to the OUT stream */
-
-            writedata(outstream, &bin[DATA_BINNDX], bytecount);
-
-            /* This is the next data address that we expect to see */
-
-            expected = address + bytecount;
           }
           break;
 
@@ -623,7 +938,7 @@ int hex2bin(FAR struct lib_instream_s *instream,
 
           if (bytecount == 0)
             {
-              ret = OK;
+              ret = hex2bin_flush(&priv);
               goto exit_with_buffers;
             }
 
@@ -701,6 +1016,13 @@ int hex2bin(FAR struct lib_instream_s *instream,
         }
     }
 
+  if (priv.rderror < 0)
+    {
+      hex2bin_debug("ERROR: Read failed: %d\n", priv.rderror);
+      ret = priv.rderror;
+      goto errout_with_buffers;
+    }
+
   hex2bin_debug("ERROR: No EOF record found\n");
 
 errout_with_einval:
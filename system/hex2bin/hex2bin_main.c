@@ -39,12 +39,13 @@
 
 #include <nuttx/config.h>
 
+#include <sys/types.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <errno.h>
 
-#include <nuttx/streams.h>
 #include <apps/hex2bin.h>
 
 #ifdef CONFIG_SYSTEM_HEX2BIN_BUILTIN
@@ -57,10 +58,80 @@
  * Private Types
  ****************************************************************************/
 
+struct hex2bin_files_s
+{
+  FAR FILE *instream;
+  FAR FILE *outstream;
+  uint32_t position;            /* Current offset in outstream */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static ssize_t hex2bin_fread(FAR void *arg, FAR uint8_t *buffer,
+                             size_t buflen);
+static int hex2bin_fwrite(FAR void *arg, uint32_t offset,
+                          FAR const uint8_t *data, size_t len);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct hex2bin_ops_s g_hex2bin_fileops =
+{
+  hex2bin_fread,
+  hex2bin_fwrite,
+  NULL
+};
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: hex2bin_fread
+ ****************************************************************************/
+
+static ssize_t hex2bin_fread(FAR void *arg, FAR uint8_t *buffer,
+                             size_t buflen)
+{
+  FAR struct hex2bin_files_s *files = (FAR struct hex2bin_files_s *)arg;
+  size_t nread;
+
+  nread = fread(buffer, 1, buflen, files->instream);
+  if (nread == 0 && ferror(files->instream))
+    {
+      return -EIO;
+    }
+
+  return nread;
+}
+
+/****************************************************************************
+ * Name: hex2bin_fwrite
+ ****************************************************************************/
+
+static int hex2bin_fwrite(FAR void *arg, uint32_t offset,
+                          FAR const uint8_t *data, size_t len)
+{
+  FAR struct hex2bin_files_s *files = (FAR struct hex2bin_files_s *)arg;
+
+  if (offset != files->position &&
+      fseek(files->outstream, offset, SEEK_SET) < 0)
+    {
+      return -ESPIPE;
+    }
+
+  if (fwrite(data, 1, len, files->outstream) != len)
+    {
+      return -EIO;
+    }
+
+  files->position = offset + len;
+  return OK;
+}
+
 /****************************************************************************
  * Name: show_usage
  ****************************************************************************/
@@ -123,8 +194,7 @@ int main(int argc, FAR char *argv[])
 int hex2bin_main(int argc, char **argv)
 #endif
 {
-  struct lib_stdinstream_s stdinstream;
-  struct lib_stdsostream_s stdoutstream;
+  struct hex2bin_files_s files;
   FAR const char *hexfile;
   FAR const char *binfile;
   FAR char *endptr;
@@ -245,16 +315,14 @@ int hex2bin_main(int argc, char **argv)
       return -errcode;
     }
 
-  /* Wrap the FILE streams as standard streams */
-
-  lib_stdinstream(&stdinstream, instream);
-  lib_stdsostream(&stdoutstream, outstream);
+  /* And do the deed, reading and writing the files a block at a time */
 
-  /* And do the deed */
+  files.instream  = instream;
+  files.outstream = outstream;
+  files.position  = 0;
 
-  ret = hex2bin(&stdinstream.public, &stdoutstream.public,
-                (uint32_t)baseaddr, (uint32_t)endpaddr,
-                (enum hex2bin_swap_e)swap);
+  ret = hex2bin_io(&g_hex2bin_fileops, &files, (uint32_t)baseaddr,
+                   (uint32_t)endpaddr, 0, 0, (enum hex2bin_swap_e)swap);
   if (ret < 0)
     {
       fprintf(stderr, "ERROR: Failed to convert to binary: %d\n", ret);
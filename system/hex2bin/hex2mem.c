@@ -39,10 +39,14 @@
 
 #include <nuttx/config.h>
 
+#include <sys/types.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
 #include <assert.h>
+#include <errno.h>
 
-#include <nuttx/streams.h>
 #include <apps/hex2bin.h>
 
 #ifdef CONFIG_SYSTEM_HEX2BIN
@@ -55,10 +59,70 @@
  * Private Types
  ****************************************************************************/
 
+struct hex2mem_s
+{
+  int fd;                       /* HEX input */
+  FAR uint8_t *base;            /* Memory at baseaddr */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static ssize_t hex2mem_read(FAR void *arg, FAR uint8_t *buffer,
+                            size_t buflen);
+static int hex2mem_write(FAR void *arg, uint32_t offset,
+                         FAR const uint8_t *data, size_t len);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct hex2bin_ops_s g_hex2mem_ops =
+{
+  hex2mem_read,
+  hex2mem_write,
+  NULL
+};
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: hex2mem_read
+ ****************************************************************************/
+
+static ssize_t hex2mem_read(FAR void *arg, FAR uint8_t *buffer,
+                            size_t buflen)
+{
+  ssize_t nread;
+
+  do
+    {
+      nread = read(((FAR struct hex2mem_s *)arg)->fd, buffer, buflen);
+    }
+  while (nread < 0 && errno == EINTR);
+
+  return nread < 0 ? -errno : nread;
+}
+
+/****************************************************************************
+ * Name: hex2mem_write
+ *
+ * Description:
+ *   hex2bin_io() has already checked that the data lies inside of the
+ *   memory region.
+ *
+ ****************************************************************************/
+
+static int hex2mem_write(FAR void *arg, uint32_t offset,
+                         FAR const uint8_t *data, size_t len)
+{
+  memcpy(((FAR struct hex2mem_s *)arg)->base + offset, data, len);
+  return OK;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -90,26 +154,21 @@
 int hex2mem(int fd, uint32_t baseaddr, uint32_t endpaddr,
             enum hex2bin_swap_e swap)
 {
-  struct lib_rawinstream_s rawinstream;
-  struct lib_memsostream_s memoutstream;
+  struct hex2mem_s hex2mem;
 
   /* Check memory addresses */
 
   DEBUGASSERT(fd >= 0 && endpaddr > baseaddr);
 
-  /* Wrap the file descriptor as raw stream; wrap the memory as a memory
-   * stream.
+  /* Read the file descriptor a buffer at a time and copy the data straight
+   * into memory.
    */
 
-  lib_rawinstream(&rawinstream, fd);
-  lib_memsostream(&memoutstream, (FAR char *)baseaddr,
-                  (int)(endpaddr - baseaddr));
-
-  /* And do the deed */
+  hex2mem.fd   = fd;
+  hex2mem.base = (FAR uint8_t *)baseaddr;
 
-  return hex2bin(&rawinstream.public, &memoutstream.public,
-                 (uint32_t)baseaddr, (uint32_t)endpaddr,
-                 (enum hex2bin_swap_e)swap);
+  return hex2bin_io(&g_hex2mem_ops, &hex2mem, baseaddr, endpaddr, 0, 0,
+                    swap);
 }
 
 #endif /* CONFIG_SYSTEM_HEX2BIN */
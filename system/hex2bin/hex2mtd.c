@@ -0,0 +1,352 @@
+/****************************************************************************
+ * apps/system/hex2bin/hex2mtd.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include <errno.h>
+
+#include <nuttx/fs/ioctl.h>
+#include <nuttx/mtd/mtd.h>
+#include <apps/hex2bin.h>
+
+#if defined(CONFIG_SYSTEM_HEX2BIN) && defined(CONFIG_MTD)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct hex2mtd_s
+{
+  int fd;                       /* HEX input */
+  FAR struct mtd_dev_s *mtd;    /* Device being programmed */
+  FAR uint8_t *erased;          /* One bit per erase block, set once erased */
+  FAR uint8_t *eblock;          /* Erase block buffer for hex2mtd_rewrite() */
+  bool programmed;              /* Block read back was already programmed */
+  struct mtd_geometry_s geo;
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static ssize_t hex2mtd_read(FAR void *arg, FAR uint8_t *buffer,
+                            size_t buflen);
+static int hex2mtd_write(FAR void *arg, uint32_t offset,
+                         FAR const uint8_t *data, size_t len);
+static int hex2mtd_readback(FAR void *arg, uint32_t offset,
+                            FAR uint8_t *data, size_t len);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct hex2bin_ops_s g_hex2mtd_ops =
+{
+  hex2mtd_read,
+  hex2mtd_write,
+  hex2mtd_readback
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: hex2mtd_read
+ ****************************************************************************/
+
+static ssize_t hex2mtd_read(FAR void *arg, FAR uint8_t *buffer,
+                            size_t buflen)
+{
+  ssize_t nread;
+
+  do
+    {
+      nread = read(((FAR struct hex2mtd_s *)arg)->fd, buffer, buflen);
+    }
+  while (nread < 0 && errno == EINTR);
+
+  return nread < 0 ? -errno : nread;
+}
+
+/****************************************************************************
+ * Name: hex2mtd_rewrite
+ *
+ * Description:
+ *   Replace a block that has already been programmed.  FLASH cannot be
+ *   programmed twice without an erase, so the whole erase block is read,
+ *   merged with the new block, erased and programmed again.
+ *
+ ****************************************************************************/
+
+static int hex2mtd_rewrite(FAR struct hex2mtd_s *priv, uint32_t offset,
+                           FAR const uint8_t *data)
+{
+  uint32_t bperase = priv->geo.erasesize / priv->geo.blocksize;
+  off_t eblock = offset / priv->geo.erasesize;
+  off_t startblock = eblock * bperase;
+  FAR const uint8_t *block;
+  ssize_t nblocks;
+  uint32_t i;
+  uint32_t j;
+  int ret;
+
+  if (priv->eblock == NULL)
+    {
+      priv->eblock = (FAR uint8_t *)malloc(priv->geo.erasesize);
+      if (priv->eblock == NULL)
+        {
+          return -ENOMEM;
+        }
+    }
+
+  nblocks = MTD_BREAD(priv->mtd, startblock, bperase, priv->eblock);
+  if (nblocks != (ssize_t)bperase)
+    {
+      hex2bin_debug("ERROR: Read of erase block %lu failed: %ld\n",
+                    (unsigned long)eblock, (long)nblocks);
+      return nblocks < 0 ? (int)nblocks : -EIO;
+    }
+
+  memcpy(&priv->eblock[offset % priv->geo.erasesize], data,
+         priv->geo.blocksize);
+
+  ret = MTD_ERASE(priv->mtd, eblock, 1);
+  if (ret < 0)
+    {
+      hex2bin_debug("ERROR: Erase of block %lu failed: %d\n",
+                    (unsigned long)eblock, ret);
+      return ret;
+    }
+
+  /* Program the blocks again, skipping any that are still erased */
+
+  for (i = 0; i < bperase; i++)
+    {
+      block = &priv->eblock[i * priv->geo.blocksize];
+      for (j = 0; j < priv->geo.blocksize && block[j] == 0xff; j++)
+        {
+        }
+
+      if (j < priv->geo.blocksize)
+        {
+          nblocks = MTD_BWRITE(priv->mtd, startblock + i, 1, block);
+          if (nblocks != 1)
+            {
+              hex2bin_debug("ERROR: Write of block %lu failed: %ld\n",
+                            (unsigned long)(startblock + i),
+                            (long)nblocks);
+              return nblocks < 0 ? (int)nblocks : -EIO;
+            }
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: hex2mtd_write
+ *
+ * Description:
+ *   Program one block.  hex2bin_io() passes whole, aligned blocks of
+ *   geo.blocksize bytes, so the block number is just offset / blocksize.
+ *
+ ****************************************************************************/
+
+static int hex2mtd_write(FAR void *arg, uint32_t offset,
+                         FAR const uint8_t *data, size_t len)
+{
+  FAR struct hex2mtd_s *priv = (FAR struct hex2mtd_s *)arg;
+  off_t eblock = offset / priv->geo.erasesize;
+  ssize_t nblocks;
+  int ret;
+
+  DEBUGASSERT(len == priv->geo.blocksize &&
+              offset % priv->geo.blocksize == 0);
+
+  /* A block that was read back with data in it must be rewritten */
+
+  if (priv->programmed)
+    {
+      priv->programmed = false;
+      return hex2mtd_rewrite(priv, offset, data);
+    }
+
+  /* Erase the erase block the first time anything is written to it */
+
+  if ((priv->erased[eblock >> 3] & (1 << (eblock & 7))) == 0)
+    {
+      ret = MTD_ERASE(priv->mtd, eblock, 1);
+      if (ret < 0)
+        {
+          hex2bin_debug("ERROR: Erase of block %lu failed: %d\n",
+                        (unsigned long)eblock, ret);
+          return ret;
+        }
+
+      priv->erased[eblock >> 3] |= (1 << (eblock & 7));
+    }
+
+  nblocks = MTD_BWRITE(priv->mtd, offset / priv->geo.blocksize, 1, data);
+  if (nblocks != 1)
+    {
+      hex2bin_debug("ERROR: Write at offset %08lx failed: %ld\n",
+                    (unsigned long)offset, (long)nblocks);
+      return nblocks < 0 ? (int)nblocks : -EIO;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: hex2mtd_readback
+ *
+ * Description:
+ *   Return the current contents of a block that hex2bin_io() is about to
+ *   write again.  A block in an erase block that has not been erased yet
+ *   holds nothing of this image and reads back as erased.
+ *
+ ****************************************************************************/
+
+static int hex2mtd_readback(FAR void *arg, uint32_t offset,
+                            FAR uint8_t *data, size_t len)
+{
+  FAR struct hex2mtd_s *priv = (FAR struct hex2mtd_s *)arg;
+  off_t eblock = offset / priv->geo.erasesize;
+  ssize_t nblocks;
+  size_t i;
+
+  priv->programmed = false;
+  if ((priv->erased[eblock >> 3] & (1 << (eblock & 7))) == 0)
+    {
+      memset(data, 0xff, len);
+      return OK;
+    }
+
+  nblocks = MTD_BREAD(priv->mtd, offset / priv->geo.blocksize, 1, data);
+  if (nblocks != 1)
+    {
+      hex2bin_debug("ERROR: Read at offset %08lx failed: %ld\n",
+                    (unsigned long)offset, (long)nblocks);
+      return nblocks < 0 ? (int)nblocks : -EIO;
+    }
+
+  for (i = 0; i < len; i++)
+    {
+      if (data[i] != 0xff)
+        {
+          priv->programmed = true;
+          break;
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name hex2mtd
+ *
+ * Description:
+ *   Read the Intel HEX ASCII data provided on the file descriptor 'fd' and
+ *   program it into an MTD device.  See apps/include/hex2bin.h.
+ *
+ ****************************************************************************/
+
+int hex2mtd(int fd, FAR struct mtd_dev_s *mtd, uint32_t baseaddr,
+            uint32_t endpaddr, enum hex2bin_swap_e swap)
+{
+  struct hex2mtd_s priv;
+  uint32_t devsize;
+  int ret;
+
+  DEBUGASSERT(fd >= 0 && mtd != NULL);
+
+  priv.fd         = fd;
+  priv.mtd        = mtd;
+  priv.eblock     = NULL;
+  priv.programmed = false;
+
+  ret = MTD_IOCTL(mtd, MTDIOC_GEOMETRY,
+                  (unsigned long)((uintptr_t)&priv.geo));
+  if (ret < 0)
+    {
+      hex2bin_debug("ERROR: MTDIOC_GEOMETRY failed: %d\n", ret);
+      return ret;
+    }
+
+  if (priv.geo.blocksize == 0 ||
+      priv.geo.erasesize % priv.geo.blocksize != 0)
+    {
+      return -EINVAL;
+    }
+
+  /* Never write past the end of the device */
+
+  devsize = priv.geo.erasesize * priv.geo.neraseblocks;
+  if (endpaddr == 0 || endpaddr - baseaddr > devsize)
+    {
+      endpaddr = baseaddr + devsize;
+    }
+
+  priv.erased = (FAR uint8_t *)zalloc((priv.geo.neraseblocks + 7) >> 3);
+  if (priv.erased == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  ret = hex2bin_io(&g_hex2mtd_ops, &priv, baseaddr, endpaddr,
+                   priv.geo.blocksize, 0xff, swap);
+
+  free(priv.eblock);
+  free(priv.erased);
+  return ret;
+}
+
+#endif /* CONFIG_SYSTEM_HEX2BIN && CONFIG_MTD */
@@ -0,0 +1,655 @@
+/****************************************************************************
+ * apps/system/hex2bin/host/hex2bin_bench.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <errno.h>
+
+#include <nuttx/streams.h>
+#include <nuttx/fs/ioctl.h>
+#include <nuttx/mtd/mtd.h>
+#include <apps/hex2bin.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define BENCH_IMAGESIZE   (4 * 1024 * 1024)
+#define BENCH_RECSIZE     32
+#define BENCH_CHUNKSIZE   4096
+#define BENCH_BLOCKSIZE   256
+#define BENCH_ERASESIZE   4096
+
+#define BENCH_HEXFILE     "hex2bin_bench.hex"
+#define BENCH_SHUFFLED    "hex2bin_shuffled.hex"
+#define BENCH_BINFILE     "hex2bin_bench.bin"
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct bench_instream_s
+{
+  struct lib_instream_s public;
+  FILE *stream;
+};
+
+struct bench_outstream_s
+{
+  struct lib_sostream_s public;
+  FILE *stream;
+};
+
+struct bench_files_s
+{
+  FILE *instream;
+  FILE *outstream;
+  uint32_t position;
+};
+
+struct bench_mem_s
+{
+  int fd;
+  uint8_t *base;
+};
+
+struct bench_mtd_s
+{
+  struct mtd_dev_s mtd;
+  uint8_t *flash;
+  size_t nerases;
+  size_t nwrites;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static uint8_t *g_image;      /* Expected contents (gaps hold 0xff) */
+static bool *g_present;       /* True for each chunk present in the HEX */
+static size_t g_imagesize = BENCH_IMAGESIZE;
+static size_t g_nrecords;
+static size_t g_hexsize;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static double bench_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void bench_record(FILE *stream, uint16_t address, uint8_t type,
+                         const uint8_t *data, uint8_t len)
+{
+  uint8_t sum;
+  int i;
+
+  sum = len + (address >> 8) + (address & 0xff) + type;
+  fprintf(stream, ":%02X%04X%02X", len, address, type);
+  for (i = 0; i < len; i++)
+    {
+      fprintf(stream, "%02X", data[i]);
+      sum += data[i];
+    }
+
+  fprintf(stream, "%02X\r\n", (uint8_t)(-sum));
+  g_nrecords++;
+}
+
+/* Generate a random image in which roughly one 4KiB chunk in eight is
+ * missing, and write it out as 32-byte Intel HEX data records.
+ */
+
+static int bench_generate(void)
+{
+  uint8_t ela[2];
+  size_t nchunks = g_imagesize / BENCH_CHUNKSIZE;
+  size_t offset;
+  size_t i;
+  FILE *stream;
+
+  g_image   = malloc(g_imagesize);
+  g_present = malloc(nchunks * sizeof(bool));
+  stream    = fopen(BENCH_HEXFILE, "w");
+
+  if (g_image == NULL || g_present == NULL || stream == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  srand(1);
+  for (i = 0; i < nchunks; i++)
+    {
+      /* Always keep the last chunk so that the file outputs have the same
+       * length as the image.
+       */
+
+      g_present[i] = (i == nchunks - 1) || (rand() & 7) != 0;
+    }
+
+  for (offset = 0; offset < g_imagesize; offset++)
+    {
+      g_image[offset] = g_present[offset / BENCH_CHUNKSIZE] ?
+                        (uint8_t)rand() : 0xff;
+    }
+
+  for (offset = 0; offset < g_imagesize; offset += BENCH_RECSIZE)
+    {
+      if (!g_present[offset / BENCH_CHUNKSIZE])
+        {
+          continue;
+        }
+
+      if ((offset & 0xffff) == 0 ||
+          !g_present[(offset - 1) / BENCH_CHUNKSIZE])
+        {
+          ela[0] = offset >> 24;
+          ela[1] = offset >> 16;
+          bench_record(stream, 0, 4, ela, 2);
+        }
+
+      bench_record(stream, offset & 0xffff, 0, &g_image[offset],
+                   BENCH_RECSIZE);
+    }
+
+  bench_record(stream, 0, 1, NULL, 0);
+  g_hexsize = ftell(stream);
+  fclose(stream);
+  return OK;
+}
+
+/* Write the same records out of order:  the chunks from last to first,
+ * and within each chunk the odd records before the even ones.  Every
+ * program block is then written twice.
+ */
+
+static int bench_shuffle(void)
+{
+  size_t nchunks = g_imagesize / BENCH_CHUNKSIZE;
+  size_t nrecords = g_nrecords;
+  size_t chunk;
+  size_t offset;
+  size_t first;
+  uint8_t ela[2];
+  FILE *stream;
+
+  stream = fopen(BENCH_SHUFFLED, "w");
+  if (stream == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  for (chunk = nchunks; chunk-- > 0; )
+    {
+      if (!g_present[chunk])
+        {
+          continue;
+        }
+
+      offset = chunk * BENCH_CHUNKSIZE;
+      ela[0] = offset >> 24;
+      ela[1] = offset >> 16;
+      bench_record(stream, 0, 4, ela, 2);
+
+      for (first = BENCH_RECSIZE; ; first = 0)
+        {
+          for (offset = chunk * BENCH_CHUNKSIZE + first;
+               offset < (chunk + 1) * BENCH_CHUNKSIZE;
+               offset += 2 * BENCH_RECSIZE)
+            {
+              bench_record(stream, offset & 0xffff, 0, &g_image[offset],
+                           BENCH_RECSIZE);
+            }
+
+          if (first == 0)
+            {
+              break;
+            }
+        }
+    }
+
+  bench_record(stream, 0, 1, NULL, 0);
+  fclose(stream);
+  g_nrecords = nrecords;
+  return OK;
+}
+
+/* Compare an output against the image.  Missing chunks are expected to
+ * hold 'gapfill'.
+ */
+
+static bool bench_verify(const char *name, const uint8_t *data,
+                         size_t size, uint8_t gapfill)
+{
+  size_t offset;
+  uint8_t expected;
+
+  if (size != g_imagesize)
+    {
+      fprintf(stderr, "%s: size %lu, expected %lu\n", name,
+              (unsigned long)size, (unsigned long)g_imagesize);
+      return false;
+    }
+
+  for (offset = 0; offset < size; offset++)
+    {
+      expected = g_present[offset / BENCH_CHUNKSIZE] ?
+                 g_image[offset] : gapfill;
+      if (data[offset] != expected)
+        {
+          fprintf(stderr, "%s: mismatch at 0x%08lx\n", name,
+                  (unsigned long)offset);
+          return false;
+        }
+    }
+
+  return true;
+}
+
+static bool bench_verifyfile(const char *name)
+{
+  uint8_t *data;
+  size_t size;
+  bool ret;
+  FILE *stream;
+
+  data   = malloc(g_imagesize + 1);
+  stream = fopen(BENCH_BINFILE, "r");
+  if (data == NULL || stream == NULL)
+    {
+      return false;
+    }
+
+  size = fread(data, 1, g_imagesize + 1, stream);
+  fclose(stream);
+
+  ret = bench_verify(name, data, size, 0);
+  free(data);
+  return ret;
+}
+
+static void bench_report(const char *name, double elapsed, bool ok)
+{
+  printf("%-22s %8.3f s %8.2f MB/s  %s\n", name, elapsed,
+         (double)g_hexsize / elapsed / 1e6, ok ? "OK" : "FAILED");
+}
+
+/* Character stream adapters, as used with the original hex2bin() */
+
+static int bench_getc(struct lib_instream_s *this)
+{
+  struct bench_instream_s *priv = (struct bench_instream_s *)this;
+  int ch = getc(priv->stream);
+
+  if (ch != EOF)
+    {
+      this->nget++;
+    }
+
+  return ch;
+}
+
+static void bench_putc(struct lib_sostream_s *this, int ch)
+{
+  struct bench_outstream_s *priv = (struct bench_outstream_s *)this;
+
+  if (putc(ch, priv->stream) != EOF)
+    {
+      this->nput++;
+    }
+}
+
+static off_t bench_seek(struct lib_sostream_s *this, off_t offset,
+                        int whence)
+{
+  struct bench_outstream_s *priv = (struct bench_outstream_s *)this;
+
+  if (fseek(priv->stream, offset, whence) < 0)
+    {
+      return -errno;
+    }
+
+  return ftell(priv->stream);
+}
+
+/* Block adapters, the same as hex2bin_main.c */
+
+static ssize_t bench_fread(void *arg, uint8_t *buffer, size_t buflen)
+{
+  struct bench_files_s *files = (struct bench_files_s *)arg;
+  size_t nread = fread(buffer, 1, buflen, files->instream);
+
+  return nread == 0 && ferror(files->instream) ? -EIO : (ssize_t)nread;
+}
+
+static int bench_fwrite(void *arg, uint32_t offset, const uint8_t *data,
+                        size_t len)
+{
+  struct bench_files_s *files = (struct bench_files_s *)arg;
+
+  if (offset != files->position &&
+      fseek(files->outstream, offset, SEEK_SET) < 0)
+    {
+      return -errno;
+    }
+
+  if (fwrite(data, 1, len, files->outstream) != len)
+    {
+      return -EIO;
+    }
+
+  files->position = offset + len;
+  return OK;
+}
+
+/* Memory adapters, the same as hex2mem.c */
+
+static ssize_t bench_read(void *arg, uint8_t *buffer, size_t buflen)
+{
+  ssize_t nread = read(((struct bench_mem_s *)arg)->fd, buffer, buflen);
+  return nread < 0 ? -errno : nread;
+}
+
+static int bench_memwrite(void *arg, uint32_t offset, const uint8_t *data,
+                          size_t len)
+{
+  memcpy(((struct bench_mem_s *)arg)->base + offset, data, len);
+  return OK;
+}
+
+/* A RAM MTD device that counts erase and write operations */
+
+static ssize_t bench_bread(struct mtd_dev_s *dev, off_t startblock,
+                           size_t nblocks, uint8_t *buf)
+{
+  struct bench_mtd_s *priv = (struct bench_mtd_s *)dev;
+
+  memcpy(buf, priv->flash + startblock * BENCH_BLOCKSIZE,
+         nblocks * BENCH_BLOCKSIZE);
+  return nblocks;
+}
+
+static int bench_erase(struct mtd_dev_s *dev, off_t startblock,
+                       size_t nblocks)
+{
+  struct bench_mtd_s *priv = (struct bench_mtd_s *)dev;
+
+  memset(priv->flash + startblock * BENCH_ERASESIZE, 0xff,
+         nblocks * BENCH_ERASESIZE);
+  priv->nerases += nblocks;
+  return OK;
+}
+
+static ssize_t bench_bwrite(struct mtd_dev_s *dev, off_t startblock,
+                            size_t nblocks, const uint8_t *buf)
+{
+  struct bench_mtd_s *priv = (struct bench_mtd_s *)dev;
+  uint8_t *dest = priv->flash + startblock * BENCH_BLOCKSIZE;
+  size_t i;
+
+  /* Programming can only clear bits, and like FLASH with ECC, a block may
+   * be programmed only once after it is erased.
+   */
+
+  for (i = 0; i < nblocks * BENCH_BLOCKSIZE; i++)
+    {
+      if (dest[i] != 0xff)
+        {
+          fprintf(stderr, "Block %lu programmed twice\n",
+                  (unsigned long)(startblock + i / BENCH_BLOCKSIZE));
+          return -EIO;
+        }
+    }
+
+  for (i = 0; i < nblocks * BENCH_BLOCKSIZE; i++)
+    {
+      dest[i] &= buf[i];
+    }
+
+  priv->nwrites += nblocks;
+  return nblocks;
+}
+
+static int bench_ioctl(struct mtd_dev_s *dev, int cmd, unsigned long arg)
+{
+  struct mtd_geometry_s *geo = (struct mtd_geometry_s *)((uintptr_t)arg);
+
+  (void)dev;
+
+  if (cmd != MTDIOC_GEOMETRY)
+    {
+      return -ENOTTY;
+    }
+
+  geo->blocksize    = BENCH_BLOCKSIZE;
+  geo->erasesize    = BENCH_ERASESIZE;
+  geo->neraseblocks = g_imagesize / BENCH_ERASESIZE;
+  return OK;
+}
+
+/****************************************************************************
+ * Benchmarks
+ ****************************************************************************/
+
+static bool bench_stream(void)
+{
+  struct bench_instream_s instream;
+  struct bench_outstream_s outstream;
+  double start;
+  double elapsed;
+  int ret;
+
+  instream.public.get   = bench_getc;
+  instream.public.nget  = 0;
+  instream.stream       = fopen(BENCH_HEXFILE, "r");
+  outstream.public.put  = bench_putc;
+  outstream.public.seek = bench_seek;
+  outstream.public.nput = 0;
+  outstream.stream      = fopen(BENCH_BINFILE, "w");
+
+  start = bench_now();
+  ret = hex2bin(&instream.public, &outstream.public, 0, 0,
+                HEX2BIN_NOSWAP);
+  fclose(outstream.stream);
+  elapsed = bench_now() - start;
+  fclose(instream.stream);
+
+  bench_report("hex2bin (streams)", elapsed,
+               ret == OK && bench_verifyfile("streams"));
+  return ret == OK;
+}
+
+static bool bench_file(void)
+{
+  static const struct hex2bin_ops_s ops =
+  {
+    bench_fread,
+    bench_fwrite,
+    NULL
+  };
+
+  struct bench_files_s files;
+  double start;
+  double elapsed;
+  int ret;
+
+  files.instream  = fopen(BENCH_HEXFILE, "r");
+  files.outstream = fopen(BENCH_BINFILE, "w");
+  files.position  = 0;
+
+  start = bench_now();
+  ret = hex2bin_io(&ops, &files, 0, 0, 0, 0, HEX2BIN_NOSWAP);
+  fclose(files.outstream);
+  elapsed = bench_now() - start;
+  fclose(files.instream);
+
+  bench_report("hex2bin_io (file)", elapsed,
+               ret == OK && bench_verifyfile("file"));
+  return ret == OK;
+}
+
+static bool bench_memory(void)
+{
+  static const struct hex2bin_ops_s ops =
+  {
+    bench_read,
+    bench_memwrite,
+    NULL
+  };
+
+  struct bench_mem_s mem;
+  double start;
+  double elapsed;
+  bool ok;
+  int ret;
+
+  mem.fd   = open(BENCH_HEXFILE, O_RDONLY);
+  mem.base = calloc(1, g_imagesize);
+
+  start = bench_now();
+  ret = hex2bin_io(&ops, &mem, 0, g_imagesize, 0, 0, HEX2BIN_NOSWAP);
+  elapsed = bench_now() - start;
+  close(mem.fd);
+
+  ok = ret == OK && bench_verify("memory", mem.base, g_imagesize, 0);
+  bench_report("hex2bin_io (memory)", elapsed, ok);
+  free(mem.base);
+  return ok;
+}
+
+static bool bench_mtd(const char *name, const char *hexfile)
+{
+  struct bench_mtd_s dev;
+  double start;
+  double elapsed;
+  bool ok;
+  int fd;
+  int ret;
+
+  memset(&dev, 0, sizeof(dev));
+  dev.mtd.erase  = bench_erase;
+  dev.mtd.bread  = bench_bread;
+  dev.mtd.bwrite = bench_bwrite;
+  dev.mtd.ioctl  = bench_ioctl;
+  dev.flash      = malloc(g_imagesize);
+
+  /* Start with "dirty" FLASH so that missed erases are detected */
+
+  memset(dev.flash, 0x5a, g_imagesize);
+  fd = open(hexfile, O_RDONLY);
+
+  start = bench_now();
+  ret = hex2mtd(fd, &dev.mtd, 0, 0, HEX2BIN_NOSWAP);
+  elapsed = bench_now() - start;
+  close(fd);
+
+  /* Erase blocks that were never touched keep their old contents */
+
+  ok = ret == OK && bench_verify(name, dev.flash, g_imagesize, 0x5a);
+  bench_report(name, elapsed, ok);
+  printf("  %lu records, %lu block writes, %lu erases\n",
+         (unsigned long)g_nrecords, (unsigned long)dev.nwrites,
+         (unsigned long)dev.nerases);
+
+  free(dev.flash);
+  return ok;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char **argv)
+{
+  bool ok = true;
+  int ret;
+
+  if (argc > 1)
+    {
+      g_imagesize = strtoul(argv[1], NULL, 0) & ~(BENCH_CHUNKSIZE - 1);
+      if (g_imagesize == 0)
+        {
+          fprintf(stderr, "USAGE: %s [<image size>]\n", argv[0]);
+          return EXIT_FAILURE;
+        }
+    }
+
+  ret = bench_generate();
+  if (ret == OK)
+    {
+      ret = bench_shuffle();
+    }
+
+  if (ret < 0)
+    {
+      fprintf(stderr, "Failed to generate %s: %d\n", BENCH_HEXFILE, ret);
+      return EXIT_FAILURE;
+    }
+
+  printf("%lu byte image, %lu byte HEX file, %lu records\n",
+         (unsigned long)g_imagesize, (unsigned long)g_hexsize,
+         (unsigned long)g_nrecords);
+
+  ok &= bench_stream();
+  ok &= bench_file();
+  ok &= bench_memory();
+  ok &= bench_mtd("hex2mtd (RAM MTD)", BENCH_HEXFILE);
+  ok &= bench_mtd("hex2mtd (shuffled)", BENCH_SHUFFLED);
+
+  unlink(BENCH_HEXFILE);
+  unlink(BENCH_SHUFFLED);
+  unlink(BENCH_BINFILE);
+  free(g_image);
+  free(g_present);
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,81 @@
+/****************************************************************************
+ * apps/system/hex2bin/host/nuttx/config.h
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_SYSTEM_HEX2BIN_HOST_NUTTX_CONFIG_H
+#define __APPS_SYSTEM_HEX2BIN_HOST_NUTTX_CONFIG_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+/* Environment stuff */
+
+#define OK 0
+#define ERROR -1
+#define FAR
+#define CODE
+#define DEBUGASSERT assert
+
+#define CONFIG_CPP_HAVE_VARARGS 1
+
+/* Configuration */
+
+#define CONFIG_SYSTEM_HEX2BIN 1
+#define CONFIG_SYSTEM_HEX2BIN_BUFSIZE 512
+#define CONFIG_EOL_IS_EITHER_CRLF 1
+#define CONFIG_MTD 1
+
+/****************************************************************************
+ * Inline Functions
+ ****************************************************************************/
+
+static inline void *zalloc(unsigned long size)
+{
+  void *ret = malloc(size);
+  if (ret)
+    {
+      memset(ret, 0, size);
+    }
+  return ret;
+}
+
+#endif /* __APPS_SYSTEM_HEX2BIN_HOST_NUTTX_CONFIG_H */
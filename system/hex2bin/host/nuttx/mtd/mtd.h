@@ -0,0 +1,80 @@
+/****************************************************************************
+ * apps/system/hex2bin/host/nuttx/mtd/mtd.h
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_SYSTEM_HEX2BIN_HOST_NUTTX_MTD_MTD_H
+#define __APPS_SYSTEM_HEX2BIN_HOST_NUTTX_MTD_MTD_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#include <sys/types.h>
+#include <stdint.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+/* The subset of the MTD interface used by hex2mtd.c */
+
+#define MTD_ERASE(d,s,n)     ((d)->erase  ? (d)->erase(d,s,n)    : (-ENOSYS))
+#define MTD_BREAD(d,s,n,b)   ((d)->bread  ? (d)->bread(d,s,n,b)  : (-ENOSYS))
+#define MTD_BWRITE(d,s,n,b)  ((d)->bwrite ? (d)->bwrite(d,s,n,b) : (-ENOSYS))
+#define MTD_IOCTL(d,c,a)     ((d)->ioctl  ? (d)->ioctl(d,c,a)    : (-ENOTTY))
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+struct mtd_geometry_s
+{
+  uint16_t blocksize;     /* Size of one read/write block */
+  uint16_t erasesize;     /* Size of one erase blocks -- must be a multiple
+                           * of blocksize. */
+  size_t neraseblocks;    /* Number of erase blocks */
+};
+
+struct mtd_dev_s
+{
+  int (*erase)(FAR struct mtd_dev_s *dev, off_t startblock,
+               size_t nblocks);
+  ssize_t (*bread)(FAR struct mtd_dev_s *dev, off_t startblock,
+                   size_t nblocks, FAR uint8_t *buf);
+  ssize_t (*bwrite)(FAR struct mtd_dev_s *dev, off_t startblock,
+                    size_t nblocks, FAR const uint8_t *buf);
+  int (*ioctl)(FAR struct mtd_dev_s *dev, int cmd, unsigned long arg);
+};
+
+#endif /* __APPS_SYSTEM_HEX2BIN_HOST_NUTTX_MTD_MTD_H */
@@ -39,9 +39,14 @@
 
 #include <nuttx/config.h>
 
+#include <sys/stat.h>
+
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
+#include <errno.h>
 #include <debug.h>
 
 #include <apps/inifile.h>
@@ -60,6 +65,19 @@
 #  define CONFIG_SYSTEM_INIFILE_DEBUGLEVEL 0
 #endif
 
+/* Cache sizing.  The entry table starts with room for INIFILE_MIN_ENTRIES
+ * entries and doubles in size as needed.  The hash table always has twice
+ * as many slots as the entry table so that it is never more than half full.
+ */
+
+#define INIFILE_MIN_ENTRIES 32
+#define INIFILE_NO_VARIABLE UINT32_MAX
+
+/* 32-bit FNV-1a hash parameters */
+
+#define INIFILE_FNV_OFFSET  2166136261ul
+#define INIFILE_FNV_PRIME   16777619ul
+
 #ifdef CONFIG_CPP_HAVE_VARARGS
 #  if CONFIG_SYSTEM_INIFILE_DEBUGLEVEL > 0
 #    define inidbg(format, ...) \
@@ -100,12 +118,43 @@ struct inifile_var_s
   FAR char *value;
 };
 
+#ifdef CONFIG_SYSTEM_INIFILE_CACHE
+/* One section or variable in the INI file cache.  Strings are referenced by
+ * their offsets into the cache arena.  Section entries have no variable.
+ */
+
+struct inifile_entry_s
+{
+  uint32_t hash;            /* Hash of the section and variable names */
+  uint32_t section;         /* Arena offset to the section name */
+  uint32_t variable;        /* Arena offset to the variable name */
+  uint32_t value;           /* Arena offset to the value string */
+};
+
+/* The in-memory copy of one INI file */
+
+struct inifile_cache_s
+{
+  FAR char *arena;          /* All section names, variable names and values */
+  FAR struct inifile_entry_s *entries; /* Sections and variables in file order */
+  FAR uint32_t *hashtab;    /* Hashed index into entries[] (index + 1) */
+  uint32_t nentries;        /* Number of entries in use */
+  uint32_t nalloc;          /* Allocated size of entries[] */
+  time_t mtime;             /* Modification time of the file when loaded */
+  off_t size;               /* Size of the file when loaded */
+};
+#endif
+
 /* This structure describes the state of one instance of the INI file parser */
 
 struct inifile_state_s
 {
   FILE *instream;
   int   nextch;
+#ifdef CONFIG_SYSTEM_INIFILE_CACHE
+  FAR char *filename;       /* The INI file path (for reloading) */
+  struct inifile_cache_s cache;
+#endif
   char  line[CONFIG_SYSTEM_INIFILE_MAXLINE+1];
 };
 
@@ -120,6 +169,18 @@ struct inifile_state_s
 static bool inifile_next_line(FAR struct inifile_state_s *priv);
 static int  inifile_read_line(FAR struct inifile_state_s *priv);
 static int  inifile_read_noncomment_line(FAR struct inifile_state_s *priv);
+#ifdef CONFIG_SYSTEM_INIFILE_CACHE
+static uint32_t inifile_hash(FAR const char *section,
+              FAR const char *variable);
+static int  inifile_lookup(FAR struct inifile_cache_s *cache, uint32_t hash,
+              FAR const char *section, FAR const char *variable);
+static bool inifile_rehash(FAR struct inifile_cache_s *cache,
+              uint32_t nalloc);
+static int  inifile_insert(FAR struct inifile_cache_s *cache,
+              uint32_t section, uint32_t variable, uint32_t value);
+static void inifile_release(FAR struct inifile_cache_s *cache);
+static int  inifile_load(FAR struct inifile_state_s *priv);
+#else
 static bool inifile_seek_to_section(FAR struct inifile_state_s *priv,
               FAR const char *section);
 static bool inifile_read_variable(FAR struct inifile_state_s *priv,
@@ -127,6 +188,7 @@ static bool inifile_read_variable(FAR struct inifile_state_s *priv,
 static FAR char *
             inifile_find_section_variable(FAR struct inifile_state_s *priv,
               FAR const char *variable);
+#endif
 static FAR char *
             inifile_find_variable(FAR struct inifile_state_s *priv,
               FAR const char *section, FAR const char *variable);
@@ -250,6 +312,437 @@ static int inifile_read_noncomment_line(FAR struct inifile_state_s *priv)
   return nbytes;
 }
 
+#ifdef CONFIG_SYSTEM_INIFILE_CACHE
+/****************************************************************************
+ * Name:  inifile_hash
+ *
+ * Description:
+ *   Return the case-insensitive hash of a section name and (optionally) a
+ *   variable name.
+ *
+ ****************************************************************************/
+
+static uint32_t inifile_hash(FAR const char *section,
+                             FAR const char *variable)
+{
+  uint32_t hash = INIFILE_FNV_OFFSET;
+
+  for (; *section; section++)
+    {
+      hash ^= (uint8_t)tolower(*section);
+      hash *= INIFILE_FNV_PRIME;
+    }
+
+  if (variable)
+    {
+      /* Separate the section and variable names */
+
+      hash ^= '=';
+      hash *= INIFILE_FNV_PRIME;
+
+      for (; *variable; variable++)
+        {
+          hash ^= (uint8_t)tolower(*variable);
+          hash *= INIFILE_FNV_PRIME;
+        }
+    }
+
+  return hash;
+}
+
+/****************************************************************************
+ * Name:  inifile_lookup
+ *
+ * Description:
+ *   Find the cache entry for the section (variable == NULL) or for the
+ *   variable within the section.  Returns the index of the entry or -1 if
+ *   there is no such entry.
+ *
+ ****************************************************************************/
+
+static int inifile_lookup(FAR struct inifile_cache_s *cache, uint32_t hash,
+                          FAR const char *section, FAR const char *variable)
+{
+  FAR struct inifile_entry_s *entry;
+  uint32_t mask;
+  uint32_t ndx;
+  uint32_t slot;
+
+  if (!cache->hashtab)
+    {
+      return -1;
+    }
+
+  /* Probe linearly from the hashed slot until an empty slot is found */
+
+  mask = (cache->nalloc << 1) - 1;
+  for (slot = hash & mask; (ndx = cache->hashtab[slot]) != 0;
+       slot = (slot + 1) & mask)
+    {
+      entry = &cache->entries[ndx - 1];
+      if (entry->hash == hash &&
+          (variable == NULL) == (entry->variable == INIFILE_NO_VARIABLE) &&
+          strcasecmp(&cache->arena[entry->section], section) == 0 &&
+          (variable == NULL ||
+           strcasecmp(&cache->arena[entry->variable], variable) == 0))
+        {
+          return ndx - 1;
+        }
+    }
+
+  return -1;
+}
+
+/****************************************************************************
+ * Name:  inifile_rehash
+ *
+ * Description:
+ *   Reallocate the entry table to hold 'nalloc' entries and rebuild the
+ *   hash table to match.
+ *
+ ****************************************************************************/
+
+static bool inifile_rehash(FAR struct inifile_cache_s *cache,
+                           uint32_t nalloc)
+{
+  FAR struct inifile_entry_s *entries;
+  FAR uint32_t *hashtab;
+  uint32_t mask;
+  uint32_t slot;
+  uint32_t i;
+
+  entries = (FAR struct inifile_entry_s *)
+    realloc(cache->entries, nalloc * sizeof(struct inifile_entry_s));
+  if (!entries)
+    {
+      return false;
+    }
+
+  cache->entries = entries;
+
+  hashtab = (FAR uint32_t *)zalloc((nalloc << 1) * sizeof(uint32_t));
+  if (!hashtab)
+    {
+      return false;
+    }
+
+  /* Re-enter all of the existing entries into the new hash table */
+
+  mask = (nalloc << 1) - 1;
+  for (i = 0; i < cache->nentries; i++)
+    {
+      for (slot = entries[i].hash & mask; hashtab[slot] != 0;
+           slot = (slot + 1) & mask);
+
+      hashtab[slot] = i + 1;
+    }
+
+  if (cache->hashtab)
+    {
+      free(cache->hashtab);
+    }
+
+  cache->hashtab = hashtab;
+  cache->nalloc  = nalloc;
+  return true;
+}
+
+/****************************************************************************
+ * Name:  inifile_insert
+ *
+ * Description:
+ *   Add a section (variable == INIFILE_NO_VARIABLE) or a variable to the
+ *   cache.  Only the first occurrence of a section or of a variable within
+ *   a section is added; that is the one that the file parser would find.
+ *   Returns 1 if the entry was added, 0 if it is a duplicate, or -ENOMEM.
+ *
+ ****************************************************************************/
+
+static int inifile_insert(FAR struct inifile_cache_s *cache,
+                          uint32_t section, uint32_t variable,
+                          uint32_t value)
+{
+  FAR struct inifile_entry_s *entry;
+  FAR const char *varname;
+  uint32_t hash;
+  uint32_t mask;
+  uint32_t slot;
+
+  /* Ignore duplicates */
+
+  varname = (variable == INIFILE_NO_VARIABLE ? NULL :
+             &cache->arena[variable]);
+  hash    = inifile_hash(&cache->arena[section], varname);
+
+  if (inifile_lookup(cache, hash, &cache->arena[section], varname) >= 0)
+    {
+      return 0;
+    }
+
+  /* Grow the tables if the entry table is full */
+
+  if (cache->nentries >= cache->nalloc)
+    {
+      if (!inifile_rehash(cache, cache->nalloc ?
+                          cache->nalloc << 1 : INIFILE_MIN_ENTRIES))
+        {
+          return -ENOMEM;
+        }
+    }
+
+  /* Add the new entry and enter it into the hash table */
+
+  entry           = &cache->entries[cache->nentries];
+  entry->hash     = hash;
+  entry->section  = section;
+  entry->variable = variable;
+  entry->value    = value;
+
+  mask = (cache->nalloc << 1) - 1;
+  for (slot = hash & mask; cache->hashtab[slot] != 0;
+       slot = (slot + 1) & mask);
+
+  cache->hashtab[slot] = ++cache->nentries;
+  return 1;
+}
+
+/****************************************************************************
+ * Name:  inifile_release
+ *
+ * Description:
+ *   Free all memory held by the cache
+ *
+ ****************************************************************************/
+
+static void inifile_release(FAR struct inifile_cache_s *cache)
+{
+  if (cache->arena)
+    {
+      free(cache->arena);
+    }
+
+  if (cache->entries)
+    {
+      free(cache->entries);
+    }
+
+  if (cache->hashtab)
+    {
+      free(cache->hashtab);
+    }
+
+  memset(cache, 0, sizeof(struct inifile_cache_s));
+}
+
+/****************************************************************************
+ * Name:  inifile_load
+ *
+ * Description:
+ *   Parse the whole INI file into the cache.  The file is parsed with the
+ *   same rules as the file-based lookups:  A section ends at a blank line
+ *   or at the next line beginning with '[', and only the first occurrence
+ *   of a section or of a variable within a section is visible.
+ *
+ ****************************************************************************/
+
+static int inifile_load(FAR struct inifile_state_s *priv)
+{
+  FAR struct inifile_cache_s *cache = &priv->cache;
+  FAR char *sectend;
+  FAR char *ptr;
+  struct stat buf;
+  uint32_t section;
+  size_t arenasize;
+  size_t used;
+  size_t len;
+  bool insection;
+  int nbytes;
+  int ret;
+
+  /* Get the size of the file.  The strings saved in the arena can be no
+   * larger than the file (plus one NUL terminator if the final line is
+   * not terminated).
+   */
+
+  if (stat(priv->filename, &buf) < 0)
+    {
+      ret = -errno;
+      inidbg("ERROR: Could not stat \"%s\": %d\n", priv->filename, ret);
+      return ret;
+    }
+
+  cache->mtime = buf.st_mtime;
+  cache->size  = buf.st_size;
+
+  arenasize    = buf.st_size + 1;
+  cache->arena = (FAR char *)malloc(arenasize);
+  if (!cache->arena)
+    {
+      inidbg("ERROR: Failed to allocate arena\n");
+      return -ENOMEM;
+    }
+
+  priv->instream = fopen(priv->filename, "r");
+  if (!priv->instream)
+    {
+      ret = -errno;
+      inidbg("ERROR: Could not open \"%s\": %d\n", priv->filename, ret);
+      return ret;
+    }
+
+  /* Prime the pump and parse each line of the file */
+
+  priv->nextch = getc(priv->instream);
+  insection    = false;
+  section      = 0;
+  used         = 0;
+  ret          = OK;
+
+  do
+    {
+      nbytes = inifile_read_noncomment_line(priv);
+
+      /* A blank line or a line beginning with '[' ends the current
+       * section.
+       */
+
+      if (nbytes == 0 || priv->line[0] == '[')
+        {
+          insection = false;
+
+          /* It takes at least three bytes of data to be a section header.
+           * The section name extends to the right bracket.
+           */
+
+          if (nbytes >= 3 && priv->line[0] == '[')
+            {
+              sectend = strchr(&priv->line[1], ']');
+              if (sectend)
+                {
+                  *sectend = '\0';
+                }
+
+              len = strlen(&priv->line[1]) + 1;
+              if (used + len > arenasize)
+                {
+                  break;
+                }
+
+              section = used;
+              memcpy(&cache->arena[used], &priv->line[1], len);
+
+              /* Only the first section of this name will be searched */
+
+              ret = inifile_insert(cache, section, INIFILE_NO_VARIABLE, 0);
+              if (ret < 0)
+                {
+                  break;
+                }
+              else if (ret > 0)
+                {
+                  insection = true;
+                  used     += len;
+                }
+            }
+        }
+
+      /* Otherwise, this may be a variable assignment in the current
+       * section.  Search for the '=' delimiter.
+       */
+
+      else if (insection && (ptr = strchr(&priv->line[1], '=')) != NULL)
+        {
+          *ptr = '\0';
+
+          len = nbytes + 1;
+          if (used + len > arenasize)
+            {
+              break;
+            }
+
+          memcpy(&cache->arena[used], priv->line, len);
+
+          ret = inifile_insert(cache, section, used,
+                               used + (ptr - priv->line) + 1);
+          if (ret < 0)
+            {
+              break;
+            }
+          else if (ret > 0)
+            {
+              used += len;
+            }
+        }
+    }
+  while (priv->nextch != EOF);
+
+  (void)fclose(priv->instream);
+  priv->instream = NULL;
+
+  if (ret < 0)
+    {
+      inidbg("ERROR: Failed to cache \"%s\": %d\n", priv->filename, ret);
+      return ret;
+    }
+
+  /* Give back the unused part of the arena.  Entries refer to the arena by
+   * offset so it does not matter if the arena moves.
+   */
+
+  if (used > 0 && used < arenasize)
+    {
+      ptr = (FAR char *)realloc(cache->arena, used);
+      if (ptr)
+        {
+          cache->arena = ptr;
+        }
+    }
+
+  inivdbg("Cached %u entries in %lu bytes\n",
+          (unsigned int)cache->nentries, (unsigned long)used);
+  return OK;
+}
+
+/****************************************************************************
+ * Name:  inifile_find_variable
+ *
+ * Description:
+ *   Obtains the specified string value for the specified variable name
+ *   within the specified section of the INI file.
+ *
+ ****************************************************************************/
+
+static FAR char *inifile_find_variable(FAR struct inifile_state_s *priv,
+                                       FAR const char *section,
+                                       FAR const char *variable)
+{
+  FAR struct inifile_cache_s *cache = &priv->cache;
+  FAR char *ret = NULL;
+  FAR char *value;
+  int ndx;
+
+  inivdbg("section=\"%s\" variable=\"%s\"\n", section, variable);
+
+  ndx = inifile_lookup(cache, inifile_hash(section, variable),
+                       section, variable);
+  if (ndx >= 0)
+    {
+      value = &cache->arena[cache->entries[ndx].value];
+      if (*value)
+        {
+          inivdbg("variable_value=\"%s\"\n", value);
+          ret = value;
+        }
+    }
+
+  /* Return the string that we found. */
+
+  inivdbg("Returning 0x%p\n", ret);
+  return ret;
+}
+
+#else /* CONFIG_SYSTEM_INIFILE_CACHE */
+
 /****************************************************************************
  * Name:  inifile_seek_to_section
  *
@@ -487,6 +980,7 @@ static FAR char *inifile_find_variable(FAR struct inifile_state_s *priv,
   inivdbg("Returning 0x%p\n", ret);
   return ret;
 }
+#endif /* CONFIG_SYSTEM_INIFILE_CACHE */
 
 /****************************************************************************
  * Public Functions
@@ -513,6 +1007,28 @@ INIHANDLE inifile_initialize(FAR const char *inifile_name)
       return (INIHANDLE)NULL;
     }
 
+#ifdef CONFIG_SYSTEM_INIFILE_CACHE
+  /* Read the whole INI file into memory */
+
+  memset(priv, 0, sizeof(struct inifile_state_s));
+  priv->filename = strdup(inifile_name);
+  if (!priv->filename)
+    {
+      inidbg("ERROR: Failed to allocate file name\n");
+      free(priv);
+      return (INIHANDLE)NULL;
+    }
+
+  if (inifile_load(priv) < 0)
+    {
+      inifile_release(&priv->cache);
+      free(priv->filename);
+      free(priv);
+      return (INIHANDLE)NULL;
+    }
+
+  return (INIHANDLE)priv;
+#else
   /* Open the specified INI file for reading */
 
   priv->instream = fopen(inifile_name, "r");
@@ -529,6 +1045,7 @@ INIHANDLE inifile_initialize(FAR const char *inifile_name)
       inidbg("ERROR: Could not open \"%s\"\n", inifile_name);
       return (INIHANDLE)NULL;
     }
+#endif
 }
 
 /****************************************************************************
@@ -545,12 +1062,19 @@ void inifile_uninitialize(INIHANDLE handle)
 
   if (priv)
     {
+#ifdef CONFIG_SYSTEM_INIFILE_CACHE
+      /* Release the in-memory copy of the INI file */
+
+      inifile_release(&priv->cache);
+      free(priv->filename);
+#else
       /* Close the INI file stream */
 
       if (priv->instream)
         {
           fclose(priv->instream);
         }
+#endif
 
       /* Release the state structure */
 
@@ -606,6 +1130,83 @@ FAR char *inifile_read_string(INIHANDLE handle,
   return ret;
 }
 
+#ifdef CONFIG_SYSTEM_INIFILE_CACHE
+/****************************************************************************
+ * Name: inifile_get_string
+ *
+ * Description:
+ *   Obtains the specified string value for the specified variable name
+ *   within the specified section of the INI file.  Unlike
+ *   inifile_read_string(), no copy of the string is made.  The returned
+ *   string belongs to the INI file cache and is valid only until the next
+ *   call to inifile_reload() or inifile_uninitialize().
+ *
+ ****************************************************************************/
+
+FAR const char *inifile_get_string(INIHANDLE handle,
+                                   FAR const char *section,
+                                   FAR const char *variable,
+                                   FAR const char *defvalue)
+{
+  FAR struct inifile_state_s *priv = (FAR struct inifile_state_s *)handle;
+  FAR const char *value;
+
+  value = inifile_find_variable(priv, section, variable);
+  return value ? value : defvalue;
+}
+
+/****************************************************************************
+ * Name: inifile_reload
+ *
+ * Description:
+ *   Re-read the INI file if it has been modified since it was last read.
+ *   Returns 1 if the file was re-read, 0 if the file is unchanged, or a
+ *   negated errno value on failure.  On failure, the previous contents of
+ *   the cache are retained.
+ *
+ ****************************************************************************/
+
+int inifile_reload(INIHANDLE handle)
+{
+  FAR struct inifile_state_s *priv = (FAR struct inifile_state_s *)handle;
+  struct inifile_cache_s oldcache;
+  struct stat buf;
+  int ret;
+
+  if (stat(priv->filename, &buf) < 0)
+    {
+      ret = -errno;
+      inidbg("ERROR: Could not stat \"%s\": %d\n", priv->filename, ret);
+      return ret;
+    }
+
+  /* Has the file changed? */
+
+  if (buf.st_mtime == priv->cache.mtime && buf.st_size == priv->cache.size)
+    {
+      return 0;
+    }
+
+  /* Yes.. load the file into a new cache, keeping the old one in case of
+   * failure.
+   */
+
+  memcpy(&oldcache, &priv->cache, sizeof(struct inifile_cache_s));
+  memset(&priv->cache, 0, sizeof(struct inifile_cache_s));
+
+  ret = inifile_load(priv);
+  if (ret < 0)
+    {
+      inifile_release(&priv->cache);
+      memcpy(&priv->cache, &oldcache, sizeof(struct inifile_cache_s));
+      return ret;
+    }
+
+  inifile_release(&oldcache);
+  return 1;
+}
+
+#endif /* CONFIG_SYSTEM_INIFILE_CACHE */
 /****************************************************************************
  * Name:  inifile_read_integer
  *
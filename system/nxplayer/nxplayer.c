@@ -62,6 +62,8 @@
 #include <nuttx/audio/audio.h>
 #include <apps/nxplayer.h>
 
+#include "nxplayer_readahead.h"
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -493,6 +495,13 @@ static int nxplayer_mediasearch(FAR struct nxplayer_s *pPlayer,
 static int nxplayer_readbuffer(FAR struct nxplayer_s *pPlayer,
                                FAR struct ap_buffer_s* apb)
 {
+#ifdef CONFIG_NXPLAYER_READAHEAD
+  /* Take the data from the read-ahead buffers.  This returns -ENODATA
+   * after the final buffer of the file has been returned.
+   */
+
+  return nxplayer_ra_read(pPlayer->ra, apb);
+#else
   /* Validate the file is still open.  It will be closed automatically when
    * we encounter the end of file (or, perhaps, a read error that we cannot
    * handle.
@@ -551,6 +560,27 @@ static int nxplayer_readbuffer(FAR struct nxplayer_s *pPlayer,
    */
 
   return OK;
+#endif
+}
+
+/****************************************************************************
+ * Name: nxplayer_closefile
+ *
+ *  Stop reading the media file and close it.
+ *
+ ****************************************************************************/
+
+static void nxplayer_closefile(FAR struct nxplayer_s *pPlayer)
+{
+#ifdef CONFIG_NXPLAYER_READAHEAD
+  nxplayer_ra_stop(pPlayer->ra);
+#endif
+
+  if (pPlayer->fileFd != NULL)
+    {
+      fclose(pPlayer->fileFd);
+      pPlayer->fileFd = NULL;
+    }
 }
 
 /****************************************************************************
@@ -707,6 +737,22 @@ static void *nxplayer_playthread(pthread_addr_t pvarg)
         }
     }
 
+#ifdef CONFIG_NXPLAYER_READAHEAD
+  /* Hand the media file over to the read-ahead thread.  This waits for
+   * the read-ahead buffers to fill.
+   */
+
+  ret = nxplayer_ra_start(pPlayer->ra, pPlayer->fileFd);
+  pPlayer->fileFd = NULL;
+
+  if (ret < 0)
+    {
+      auddbg("ERROR: nxplayer_ra_start failed: %d\n", ret);
+      running = false;
+      goto err_out;
+    }
+#endif
+
   /* Fill up the pipeline with enqueued buffers */
 
 #ifdef CONFIG_AUDIO_DRIVER_SPECIFIC_BUFFERS
@@ -759,8 +805,7 @@ static void *nxplayer_playthread(pthread_addr_t pvarg)
                * file so that no further data is read.
                */
 
-              fclose(pPlayer->fileFd);
-              pPlayer->fileFd = NULL;
+              nxplayer_closefile(pPlayer);
 
               /* We are no longer streaming data from the file.  Be we will
                * need to wait for any outstanding buffers to be recovered.  We
@@ -918,8 +963,7 @@ static void *nxplayer_playthread(pthread_addr_t pvarg)
                          * Close the file so that no further data is read.
                          */
 
-                        fclose(pPlayer->fileFd);
-                        pPlayer->fileFd = NULL;
+                        nxplayer_closefile(pPlayer);
 
                         /* Stop streaming and wait for buffers to be
                          * returned and to receive the AUDIO_MSG_COMPLETE
@@ -1031,12 +1075,7 @@ err_out:
 
   /* Close the files */
 
-  if (pPlayer->fileFd != NULL)
-    {
-      fclose(pPlayer->fileFd);            /* Close the file */
-      pPlayer->fileFd = NULL;             /* Clear out the FD */
-    }
-
+  nxplayer_closefile(pPlayer);            /* Close the file */
   close(pPlayer->devFd);                  /* Close the device */
   pPlayer->devFd = -1;                    /* Mark device as closed */
   mq_close(pPlayer->mq);                  /* Close the message queue */
@@ -1836,6 +1875,84 @@ err_out_nodev:
   return ret;
 }
 
+#ifdef CONFIG_NXPLAYER_READAHEAD
+/****************************************************************************
+ * Name: nxplayer_queuefile
+ *
+ *   nxplayer_queuefile() queues a media file to be played immediately
+ *   after the file that is currently playing, with no gap between them.
+ *   The file data is simply appended to the current audio stream, so the
+ *   file must be in the same format as the current file and that format
+ *   must allow files to be concatenated.
+ *
+ * Input:
+ *   pPlayer    Pointer to the initialized MPlayer context
+ *   pFilename  Pointer to the filename to play next
+ *
+ * Returns:
+ *   OK         File is queued
+ *   -ENOENT    The media file was not found
+ *   -EBUSY     Another file is already queued
+ *   -ENODATA   Nothing is playing or the current file is already ending
+ *
+ ****************************************************************************/
+
+int nxplayer_queuefile(FAR struct nxplayer_s *pPlayer,
+                       FAR const char *pFilename)
+{
+#ifdef CONFIG_NXPLAYER_INCLUDE_MEDIADIR
+  char path[128];
+#endif
+  int fd;
+  int ret;
+
+  DEBUGASSERT(pPlayer != NULL);
+  DEBUGASSERT(pFilename != NULL);
+
+  fd = open(pFilename, O_RDONLY);
+#ifdef CONFIG_NXPLAYER_INCLUDE_MEDIADIR
+  if (fd < 0)
+    {
+      /* File not found.  Test if its in the mediadir */
+
+      snprintf(path, sizeof(path), "%s/%s", pPlayer->mediadir, pFilename);
+      fd = open(path, O_RDONLY);
+    }
+#endif
+
+  if (fd < 0)
+    {
+      auddbg("ERROR: Could not open %s\n", pFilename);
+      return -ENOENT;
+    }
+
+  ret = nxplayer_ra_queue(pPlayer->ra, fd);
+  if (ret < 0)
+    {
+      close(fd);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: nxplayer_getstatus
+ *
+ *   nxplayer_getstatus() returns the fill level of the read-ahead buffers
+ *   and the read-ahead statistics of the current or last playback.
+ *
+ ****************************************************************************/
+
+int nxplayer_getstatus(FAR struct nxplayer_s *pPlayer,
+                       FAR struct nxplayer_status_s *status)
+{
+  DEBUGASSERT(pPlayer != NULL && status != NULL);
+
+  nxplayer_ra_status(pPlayer->ra, status);
+  return OK;
+}
+#endif /* CONFIG_NXPLAYER_READAHEAD */
+
 /****************************************************************************
  * Name: nxplayer_setmediadir
  *
@@ -1891,6 +2008,15 @@ FAR struct nxplayer_s *nxplayer_create(void)
   pPlayer->playId = 0;
   pPlayer->crefs = 1;
 
+#ifdef CONFIG_NXPLAYER_READAHEAD
+  pPlayer->ra = nxplayer_ra_create();
+  if (pPlayer->ra == NULL)
+    {
+      free(pPlayer);
+      return NULL;
+    }
+#endif
+
 #ifndef CONFIG_AUDIO_EXCLUDE_TONE
   pPlayer->bass = 50;
   pPlayer->treble = 50;
@@ -1979,6 +2105,9 @@ void nxplayer_release(FAR struct nxplayer_s* pPlayer)
 
   if (refcount == 1)
     {
+#ifdef CONFIG_NXPLAYER_READAHEAD
+      nxplayer_ra_destroy(pPlayer->ra);
+#endif
       free(pPlayer);
     }
 }
@@ -103,6 +103,11 @@ static int nxplayer_cmd_mediadir(FAR struct nxplayer_s *pPlayer, char* parg);
 static int nxplayer_cmd_stop(FAR struct nxplayer_s *pPlayer, char* parg);
 #endif
 
+#ifdef CONFIG_NXPLAYER_READAHEAD
+static int nxplayer_cmd_queue(FAR struct nxplayer_s *pPlayer, char* parg);
+static int nxplayer_cmd_status(FAR struct nxplayer_s *pPlayer, char* parg);
+#endif
+
 #ifndef CONFIG_AUDIO_EXCLUDE_VOLUME
 static int nxplayer_cmd_volume(FAR struct nxplayer_s *pPlayer, char* parg);
 #ifndef CONFIG_AUDIO_EXCLUDE_BALANCE
@@ -144,6 +149,9 @@ static struct mp_cmd_s g_nxplayer_cmds[] =
   { "mediadir", "path",     nxplayer_cmd_mediadir,  NXPLAYER_HELP_TEXT(Change the media directory) },
 #endif
   { "play",     "filename", nxplayer_cmd_play,      NXPLAYER_HELP_TEXT(Play a media file) },
+#ifdef CONFIG_NXPLAYER_READAHEAD
+  { "queue",    "filename", nxplayer_cmd_queue,     NXPLAYER_HELP_TEXT(Play a media file next without a gap) },
+#endif
 #ifndef CONFIG_AUDIO_EXCLUDE_PAUSE_RESUME
   { "pause",    "",         nxplayer_cmd_pause,     NXPLAYER_HELP_TEXT(Pause playback) },
 #endif
@@ -153,6 +161,9 @@ static struct mp_cmd_s g_nxplayer_cmds[] =
 #ifndef CONFIG_AUDIO_EXCLUDE_PAUSE_RESUME
   { "resume",   "",         nxplayer_cmd_resume,    NXPLAYER_HELP_TEXT(Resume playback) },
 #endif
+#ifdef CONFIG_NXPLAYER_READAHEAD
+  { "status",   "",         nxplayer_cmd_status,    NXPLAYER_HELP_TEXT(Show read-ahead status) },
+#endif
 #ifndef CONFIG_AUDIO_EXCLUDE_STOP
   { "stop",     "",         nxplayer_cmd_stop,      NXPLAYER_HELP_TEXT(Stop playback) },
 #endif
@@ -406,6 +417,71 @@ static int nxplayer_cmd_stop(FAR struct nxplayer_s *pPlayer, char* parg)
 }
 #endif
 
+/****************************************************************************
+ * Name: nxplayer_cmd_queue
+ *
+ *   nxplayer_cmd_queue() queues the specified media file to be played
+ *   immediately after the file that is currently playing.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_READAHEAD
+static int nxplayer_cmd_queue(FAR struct nxplayer_s *pPlayer, char* parg)
+{
+  int ret;
+
+  ret = nxplayer_queuefile(pPlayer, parg);
+  switch (-ret)
+    {
+      case OK:
+        break;
+
+      case ENOENT:
+        printf("File %s not found\n", parg);
+        break;
+
+      case EBUSY:
+        printf("A file is already queued\n");
+        break;
+
+      case ENODATA:
+        printf("Nothing is playing\n");
+        break;
+
+      default:
+        printf("Error queueing file: %d\n", -ret);
+        break;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: nxplayer_cmd_status
+ *
+ *   nxplayer_cmd_status() shows the read-ahead buffer fill level and
+ *   statistics.
+ *
+ ****************************************************************************/
+
+static int nxplayer_cmd_status(FAR struct nxplayer_s *pPlayer, char* parg)
+{
+  struct nxplayer_status_s status;
+
+  nxplayer_getstatus(pPlayer, &status);
+
+  printf("Read-ahead:  %s%s\n", status.active ? "active" : "idle",
+         status.queued ? ", next file queued" : "");
+  printf("  Buffers:     %u of %u filled (lowest %u)\n",
+         status.nfilled, status.nbuffers, status.minfilled);
+  printf("  Underruns:   %lu\n", (unsigned long)status.underruns);
+  printf("  Reads:       %lu (slowest %lu usec)\n",
+         (unsigned long)status.nreads, (unsigned long)status.maxlatency);
+
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Name: nxplayer_cmd_pause
  *
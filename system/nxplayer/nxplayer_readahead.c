@@ -0,0 +1,615 @@
+/****************************************************************************
+ * apps/system/nxplayer/nxplayer_readahead.c
+ * A read-ahead thread that keeps a pool of buffers filled with media file
+ * data ahead of the NxPlayer play thread.
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/audio/audio.h>
+#include <apps/nxplayer.h>
+
+#include "nxplayer_readahead.h"
+
+#ifdef CONFIG_NXPLAYER_READAHEAD
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_NXPLAYER_READAHEAD_NBUFFERS
+#  define CONFIG_NXPLAYER_READAHEAD_NBUFFERS 8
+#endif
+
+#ifndef CONFIG_NXPLAYER_READAHEAD_BUFSIZE
+#  define CONFIG_NXPLAYER_READAHEAD_BUFSIZE 4096
+#endif
+
+#ifndef CONFIG_NXPLAYER_READAHEAD_STACKSIZE
+#  define CONFIG_NXPLAYER_READAHEAD_STACKSIZE 1024
+#endif
+
+#define RA_NBUFFERS CONFIG_NXPLAYER_READAHEAD_NBUFFERS
+#define RA_BUFSIZE  CONFIG_NXPLAYER_READAHEAD_BUFSIZE
+
+/* Alignment of the buffer pool.  This is enough for most DMA engines. */
+
+#define RA_ALIGN    32
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The state of the read-ahead logic.  The buffer pool is a ring of
+ * RA_NBUFFERS blocks.  The reader thread fills blocks at 'head' and the
+ * play thread empties them at 'tail'.  The reader thread owns the block at
+ * 'head' while it is not full, so the file is read without holding the
+ * lock.
+ */
+
+struct nxplayer_ra_s
+{
+  pthread_mutex_t lock;       /* Protects all of the following */
+  pthread_cond_t  cond;       /* Signalled when a block changes state */
+  pthread_t       reader;     /* The read-ahead thread */
+  FAR uint8_t    *pool;       /* RA_NBUFFERS blocks of RA_BUFSIZE bytes */
+  size_t          nbytes[RA_NBUFFERS]; /* Bytes of data in each block */
+  size_t          offset;     /* Bytes already taken from the tail block */
+  off_t           pos;        /* File position of the next read */
+  int             fd;         /* The file being read, -1 if none */
+  int             nextfd;     /* The file to be read next, -1 if none */
+  uint16_t        head;       /* The next block to be filled */
+  uint16_t        tail;       /* The next block to be played */
+  uint16_t        nfilled;    /* The number of blocks holding data */
+  uint16_t        minfilled;  /* Lowest value of nfilled while playing */
+  bool            started;    /* True: The reader thread is running */
+  bool            eof;        /* True: All queued files have been read */
+  bool            final;      /* True: The final audio buffer was returned */
+  bool            terminate;  /* True: The reader thread should exit */
+  uint32_t        underruns;  /* Times the play thread waited for data */
+  uint32_t        nreads;     /* Number of file reads */
+  uint32_t        maxlatency; /* Slowest file read in microseconds */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxplayer_ra_gettime
+ ****************************************************************************/
+
+static void nxplayer_ra_gettime(FAR struct timespec *tp)
+{
+#ifdef CONFIG_CLOCK_MONOTONIC
+  (void)clock_gettime(CLOCK_MONOTONIC, tp);
+#else
+  (void)clock_gettime(CLOCK_REALTIME, tp);
+#endif
+}
+
+/****************************************************************************
+ * Name: nxplayer_ra_elapsed
+ *
+ *   Return the time since 'start' in microseconds.
+ *
+ ****************************************************************************/
+
+static uint32_t nxplayer_ra_elapsed(FAR const struct timespec *start)
+{
+  struct timespec now;
+
+  nxplayer_ra_gettime(&now);
+  return (uint32_t)((now.tv_sec - start->tv_sec) * 1000000 +
+                    (now.tv_nsec - start->tv_nsec) / 1000);
+}
+
+/****************************************************************************
+ * Name: nxplayer_ra_thread
+ *
+ *   This is the read-ahead thread.  It reads the media file into each empty
+ *   block of the buffer pool until it is told to terminate.  At the end of
+ *   a file, it continues with the next queued file, if any.
+ *
+ ****************************************************************************/
+
+static FAR void *nxplayer_ra_thread(pthread_addr_t pvarg)
+{
+  FAR struct nxplayer_ra_s *ra = (FAR struct nxplayer_ra_s *)pvarg;
+  FAR uint8_t *block;
+  struct timespec start;
+  uint32_t elapsed;
+  size_t reqsize;
+  size_t nbytes;
+  ssize_t nread;
+  int fd;
+
+  pthread_mutex_lock(&ra->lock);
+  while (!ra->terminate)
+    {
+      /* Wait until there is a file to read and an empty block to read it
+       * into.
+       */
+
+      if (ra->fd < 0 || ra->nfilled >= RA_NBUFFERS)
+        {
+          pthread_cond_wait(&ra->cond, &ra->lock);
+          continue;
+        }
+
+      /* Each read ends on a multiple of RA_BUFSIZE in the file.  So, after
+       * the first read of a file, every read starts on a sector boundary
+       * and covers whole sectors.  Then the file system can transfer the
+       * data directly into the block instead of through its sector cache.
+       */
+
+      block   = &ra->pool[ra->head * RA_BUFSIZE];
+      reqsize = RA_BUFSIZE - (size_t)(ra->pos % RA_BUFSIZE);
+      fd      = ra->fd;
+      pthread_mutex_unlock(&ra->lock);
+
+      nxplayer_ra_gettime(&start);
+      for (nbytes = 0; nbytes < reqsize; )
+        {
+          nread = read(fd, &block[nbytes], reqsize - nbytes);
+          if (nread > 0)
+            {
+              nbytes += nread;
+            }
+          else if (nread == 0)
+            {
+              /* End of file */
+
+              break;
+            }
+          else if (errno != EINTR)
+            {
+              auddbg("ERROR: read failed: %d\n", errno);
+              break;
+            }
+        }
+
+      elapsed = nxplayer_ra_elapsed(&start);
+
+      pthread_mutex_lock(&ra->lock);
+      ra->nreads++;
+      if (elapsed > ra->maxlatency)
+        {
+          ra->maxlatency = elapsed;
+        }
+
+      if (nbytes > 0)
+        {
+          ra->nbytes[ra->head] = nbytes;
+          ra->head = (ra->head + 1) % RA_NBUFFERS;
+          ra->nfilled++;
+          ra->pos += nbytes;
+        }
+
+      /* A short read means the end of the file or a read error.  We are
+       * finished with this file in either case.
+       */
+
+      if (nbytes < reqsize)
+        {
+          audvdbg("Closing file, pos=%ld\n", (long)ra->pos);
+          close(fd);
+
+          /* Continue with the next file without a break in the data */
+
+          ra->fd     = ra->nextfd;
+          ra->nextfd = -1;
+          ra->pos    = 0;
+          ra->eof    = (ra->fd < 0);
+        }
+
+      pthread_cond_broadcast(&ra->cond);
+    }
+
+  pthread_mutex_unlock(&ra->lock);
+  return NULL;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxplayer_ra_create
+ *
+ *   Allocate the read-ahead state.  The buffer pool is not allocated until
+ *   playback starts.
+ *
+ ****************************************************************************/
+
+FAR struct nxplayer_ra_s *nxplayer_ra_create(void)
+{
+  FAR struct nxplayer_ra_s *ra;
+
+  ra = (FAR struct nxplayer_ra_s *)zalloc(sizeof(struct nxplayer_ra_s));
+  if (ra != NULL)
+    {
+      pthread_mutex_init(&ra->lock, NULL);
+      pthread_cond_init(&ra->cond, NULL);
+      ra->fd     = -1;
+      ra->nextfd = -1;
+    }
+
+  return ra;
+}
+
+/****************************************************************************
+ * Name: nxplayer_ra_destroy
+ *
+ *   Stop the read-ahead thread and free the read-ahead state.
+ *
+ ****************************************************************************/
+
+void nxplayer_ra_destroy(FAR struct nxplayer_ra_s *ra)
+{
+  nxplayer_ra_stop(ra);
+  pthread_cond_destroy(&ra->cond);
+  pthread_mutex_destroy(&ra->lock);
+  free(ra);
+}
+
+/****************************************************************************
+ * Name: nxplayer_ra_start
+ *
+ *   Start reading the media file ahead of playback.  The read-ahead logic
+ *   takes the file over from the stream, which is closed in any event.
+ *   Reading continues from the current stream position.  This function
+ *   does not return until the buffer pool is full or the whole file has
+ *   been read, so that playback starts with the full read-ahead.
+ *
+ ****************************************************************************/
+
+int nxplayer_ra_start(FAR struct nxplayer_ra_s *ra, FAR FILE *stream)
+{
+  struct sched_param sparam;
+  pthread_attr_t tattr;
+  off_t pos;
+  int fd;
+  int ret;
+
+  DEBUGASSERT(!ra->started);
+
+  /* Duplicate the file descriptor and close the stream.  The stream may
+   * already have buffered data beyond its current position, so restore the
+   * position after the stream has been closed.
+   */
+
+  pos = ftell(stream);
+  fd  = dup(fileno(stream));
+  fclose(stream);
+
+  if (fd < 0 || pos < 0 || lseek(fd, pos, SEEK_SET) != pos)
+    {
+      ret = -errno;
+      auddbg("ERROR: Failed to take over the media file: %d\n", ret);
+      goto errout_with_fd;
+    }
+
+  ra->pool = (FAR uint8_t *)memalign(RA_ALIGN, RA_NBUFFERS * RA_BUFSIZE);
+  if (ra->pool == NULL)
+    {
+      auddbg("ERROR: Failed to allocate the read-ahead buffers\n");
+      ret = -ENOMEM;
+      goto errout_with_fd;
+    }
+
+  /* Reset the read-ahead state and statistics for this playback */
+
+  ra->offset     = 0;
+  ra->pos        = pos;
+  ra->fd         = fd;
+  ra->nextfd     = -1;
+  ra->head       = 0;
+  ra->tail       = 0;
+  ra->nfilled    = 0;
+  ra->minfilled  = RA_NBUFFERS;
+  ra->eof        = false;
+  ra->final      = false;
+  ra->terminate  = false;
+  ra->underruns  = 0;
+  ra->nreads     = 0;
+  ra->maxlatency = 0;
+
+  /* Start the reader thread just below the priority of the play thread */
+
+  pthread_attr_init(&tattr);
+  sparam.sched_priority = sched_get_priority_max(SCHED_FIFO) - 10;
+  (void)pthread_attr_setschedparam(&tattr, &sparam);
+  (void)pthread_attr_setstacksize(&tattr,
+                                  CONFIG_NXPLAYER_READAHEAD_STACKSIZE);
+
+  ret = pthread_create(&ra->reader, &tattr, nxplayer_ra_thread,
+                       (pthread_addr_t)ra);
+  if (ret != OK)
+    {
+      auddbg("ERROR: Failed to create read-ahead thread: %d\n", ret);
+      ret = -ret;
+      goto errout_with_pool;
+    }
+
+  pthread_setname_np(ra->reader, "readahead");
+  ra->started = true;
+
+  /* Wait for the buffer pool to fill */
+
+  pthread_mutex_lock(&ra->lock);
+  while (ra->nfilled < RA_NBUFFERS && !ra->eof)
+    {
+      pthread_cond_wait(&ra->cond, &ra->lock);
+    }
+
+  pthread_mutex_unlock(&ra->lock);
+  return OK;
+
+errout_with_pool:
+  free(ra->pool);
+  ra->pool = NULL;
+  ra->fd   = -1;
+
+errout_with_fd:
+  if (fd >= 0)
+    {
+      close(fd);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: nxplayer_ra_queue
+ *
+ *   Queue another file to be read when the current file has been read.
+ *   Its data follows the data of the current file with no break.  The
+ *   read-ahead logic takes ownership of the file descriptor on success.
+ *
+ * Returned Value:
+ *   OK on success, -EBUSY if a file is already queued, or -ENODATA if the
+ *   final buffer of the current playback has already been returned.
+ *
+ ****************************************************************************/
+
+int nxplayer_ra_queue(FAR struct nxplayer_ra_s *ra, int fd)
+{
+  int ret = OK;
+
+  pthread_mutex_lock(&ra->lock);
+  if (!ra->started || ra->final || ra->terminate)
+    {
+      ret = -ENODATA;
+    }
+  else if (ra->nextfd >= 0)
+    {
+      ret = -EBUSY;
+    }
+  else if (ra->eof)
+    {
+      /* The reader has finished the current file, but its last block has
+       * not yet been played.  Resume reading with the new file.
+       */
+
+      ra->fd  = fd;
+      ra->pos = 0;
+      ra->eof = false;
+      pthread_cond_broadcast(&ra->cond);
+    }
+  else
+    {
+      ra->nextfd = fd;
+    }
+
+  pthread_mutex_unlock(&ra->lock);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: nxplayer_ra_read
+ *
+ *   Fill the audio buffer from the read-ahead blocks.  If no data has been
+ *   read ahead, this waits for the reader thread (an underrun).  The final
+ *   buffer of the stream is marked with AUDIO_APB_FINAL.
+ *
+ * Returned Value:
+ *   OK if the buffer should be passed to the audio device, or -ENODATA if
+ *   the final buffer has already been returned.
+ *
+ ****************************************************************************/
+
+int nxplayer_ra_read(FAR struct nxplayer_ra_s *ra,
+                     FAR struct ap_buffer_s *apb)
+{
+  FAR uint8_t *dest = (FAR uint8_t *)&apb->samp;
+  FAR const uint8_t *src;
+  size_t avail;
+  size_t ncopy;
+
+  pthread_mutex_lock(&ra->lock);
+  if (!ra->started || ra->final)
+    {
+      pthread_mutex_unlock(&ra->lock);
+      return -ENODATA;
+    }
+
+  apb->nbytes  = 0;
+  apb->curbyte = 0;
+  apb->flags   = 0;
+
+  while (apb->nbytes < apb->nmaxbytes)
+    {
+      if (ra->nfilled == 0)
+        {
+          /* Nothing has been read ahead.  Are we finished? */
+
+          if (ra->eof || ra->terminate)
+            {
+              apb->flags |= AUDIO_APB_FINAL;
+              ra->final   = true;
+              break;
+            }
+
+          /* No.. the file system has fallen behind.  Wait for it. */
+
+          ra->underruns++;
+          while (ra->nfilled == 0 && !ra->eof && !ra->terminate)
+            {
+              pthread_cond_wait(&ra->cond, &ra->lock);
+            }
+
+          continue;
+        }
+
+      /* Copy as much of the tail block as will fit */
+
+      avail = ra->nbytes[ra->tail] - ra->offset;
+      ncopy = apb->nmaxbytes - apb->nbytes;
+      if (ncopy > avail)
+        {
+          ncopy = avail;
+        }
+
+      src = &ra->pool[ra->tail * RA_BUFSIZE + ra->offset];
+      memcpy(&dest[apb->nbytes], src, ncopy);
+      apb->nbytes += ncopy;
+      ra->offset  += ncopy;
+
+      /* Return the block to the reader if it is now empty */
+
+      if (ra->offset >= ra->nbytes[ra->tail])
+        {
+          ra->tail   = (ra->tail + 1) % RA_NBUFFERS;
+          ra->offset = 0;
+          ra->nfilled--;
+          pthread_cond_broadcast(&ra->cond);
+        }
+    }
+
+  /* The pool drains at the end of the stream; that is not a low level */
+
+  if (!ra->eof && ra->nfilled < ra->minfilled)
+    {
+      ra->minfilled = ra->nfilled;
+    }
+
+  pthread_mutex_unlock(&ra->lock);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxplayer_ra_stop
+ *
+ *   Stop the reader thread, close any open files and free the buffer pool.
+ *   The statistics are retained until the next playback starts.
+ *
+ ****************************************************************************/
+
+void nxplayer_ra_stop(FAR struct nxplayer_ra_s *ra)
+{
+  FAR void *value;
+
+  pthread_mutex_lock(&ra->lock);
+  if (!ra->started)
+    {
+      pthread_mutex_unlock(&ra->lock);
+      return;
+    }
+
+  ra->terminate = true;
+  pthread_cond_broadcast(&ra->cond);
+  pthread_mutex_unlock(&ra->lock);
+
+  pthread_join(ra->reader, &value);
+
+  if (ra->fd >= 0)
+    {
+      close(ra->fd);
+      ra->fd = -1;
+    }
+
+  if (ra->nextfd >= 0)
+    {
+      close(ra->nextfd);
+      ra->nextfd = -1;
+    }
+
+  free(ra->pool);
+  ra->pool    = NULL;
+  ra->nfilled = 0;
+  ra->started = false;
+}
+
+/****************************************************************************
+ * Name: nxplayer_ra_status
+ *
+ *   Return the read-ahead fill level and statistics.
+ *
+ ****************************************************************************/
+
+void nxplayer_ra_status(FAR struct nxplayer_ra_s *ra,
+                        FAR struct nxplayer_status_s *status)
+{
+  pthread_mutex_lock(&ra->lock);
+  status->active     = ra->started && !ra->terminate;
+  status->queued     = (ra->nextfd >= 0);
+  status->nbuffers   = RA_NBUFFERS;
+  status->nfilled    = ra->nfilled;
+  status->minfilled  = ra->minfilled;
+  status->underruns  = ra->underruns;
+  status->nreads     = ra->nreads;
+  status->maxlatency = ra->maxlatency;
+  pthread_mutex_unlock(&ra->lock);
+}
+
+#endif /* CONFIG_NXPLAYER_READAHEAD */
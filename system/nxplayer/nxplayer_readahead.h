@@ -0,0 +1,68 @@
+/****************************************************************************
+ * apps/system/nxplayer/nxplayer_readahead.h
+ * Interfaces to the NxPlayer read-ahead logic
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_SYSTEM_NXPLAYER_NXPLAYER_READAHEAD_H
+#define __APPS_SYSTEM_NXPLAYER_NXPLAYER_READAHEAD_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdio.h>
+
+#include <nuttx/audio/audio.h>
+#include <apps/nxplayer.h>
+
+#ifdef CONFIG_NXPLAYER_READAHEAD
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+FAR struct nxplayer_ra_s *nxplayer_ra_create(void);
+void nxplayer_ra_destroy(FAR struct nxplayer_ra_s *ra);
+int  nxplayer_ra_start(FAR struct nxplayer_ra_s *ra, FAR FILE *stream);
+int  nxplayer_ra_queue(FAR struct nxplayer_ra_s *ra, int fd);
+int  nxplayer_ra_read(FAR struct nxplayer_ra_s *ra,
+                      FAR struct ap_buffer_s *apb);
+void nxplayer_ra_stop(FAR struct nxplayer_ra_s *ra);
+void nxplayer_ra_status(FAR struct nxplayer_ra_s *ra,
+                        FAR struct nxplayer_status_s *status);
+
+#endif /* CONFIG_NXPLAYER_READAHEAD */
+#endif /* __APPS_SYSTEM_NXPLAYER_NXPLAYER_READAHEAD_H */
@@ -74,6 +74,36 @@
 #  define CONFIG_EOL_IS_EITHER_CRLF 1
 #endif
 
+/* History, search and tab completion all redraw the line and so depend on
+ * echo to a VT100 terminal.
+ */
+
+#ifndef CONFIG_READLINE_ECHO
+#  undef CONFIG_READLINE_HISTORY
+#  undef CONFIG_READLINE_TABCOMPLETION
+#endif
+
+#ifdef CONFIG_READLINE_HISTORY
+#  ifndef CONFIG_READLINE_HISTORY_SIZE
+#    define CONFIG_READLINE_HISTORY_SIZE 512
+#  endif
+
+#  ifndef CONFIG_READLINE_HISTORY_LINES
+#    define CONFIG_READLINE_HISTORY_LINES 32
+#  endif
+
+#  if CONFIG_NFILE_DESCRIPTORS <= 0
+#    undef CONFIG_READLINE_HISTORY_FILE
+#  endif
+
+#  ifndef CONFIG_READLINE_HISTORY_PATH
+#    define CONFIG_READLINE_HISTORY_PATH "/tmp/.readline_history"
+#  endif
+#else
+#  undef CONFIG_READLINE_HISTORY_SEARCH
+#  undef CONFIG_READLINE_HISTORY_FILE
+#endif
+
 /* Helper macros */
 
 #define RL_GETC(v)      ((v)->rl_getc(v))
@@ -122,4 +152,37 @@ struct rl_common_s
 
 ssize_t readline_common(FAR struct rl_common_s *vtbl, FAR char *buf, int buflen);
 
+/****************************************************************************
+ * Name: readline_hist*
+ *
+ *   The command line history (readline_history.c).  Lines are numbered
+ *   from 0, the newest line.  readline_histget() returns a pointer to the
+ *   NUL terminated text of a line and its length, or NULL if there is no
+ *   such line.  readline_histsearch() returns the number of the newest
+ *   line, at or after 'start', that contains 'query', or -ENOENT.
+ *
+ **************************************************************************/
+
+#ifdef CONFIG_READLINE_HISTORY
+void readline_histadd(FAR const char *line, int len);
+int readline_histcount(void);
+FAR const char *readline_histget(int n, FAR int *len);
+#ifdef CONFIG_READLINE_HISTORY_SEARCH
+int readline_histsearch(FAR const char *query, int qlen, int start);
+#endif
+#endif
+
+/****************************************************************************
+ * Name: readline_tabcomplete
+ *
+ *   Complete the word at the end of the 'nch' characters in 'buf'
+ *   (readline_complete.c).
+ *
+ **************************************************************************/
+
+#ifdef CONFIG_READLINE_TABCOMPLETION
+void readline_tabcomplete(FAR struct rl_common_s *vtbl, FAR char *buf,
+                          FAR int *nch, int buflen);
+#endif
+
 #endif /* __APPS_SYSTEM_READLINE_READLINE_H */
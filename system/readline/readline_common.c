@@ -40,6 +40,7 @@
 #include <nuttx/config.h>
 
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 #include <errno.h>
@@ -75,10 +76,279 @@
 
 static const char g_erasetoeol[] = VT100_CLEAREOL;
 
+#ifdef CONFIG_READLINE_HISTORY_SEARCH
+/* Shown in front of the query during an incremental search */
+
+static const char g_searchprompt[] = "(i-search)`";
+static const char g_failprompt[]   = "(failed i-search)`";
+static const char g_searchsep[]    = "': ";
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: readline_update
+ *
+ * Description:
+ *   Replace the 'oldlen' characters 'olddisp' that were written since the
+ *   prompt with 'newdisp'.  The cursor is assumed to be at the end of the
+ *   old text.  Only the characters after the common beginning of the two
+ *   are sent, which matters on a slow serial console.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_READLINE_HISTORY
+static void readline_update(FAR struct rl_common_s *vtbl,
+                            FAR const char *olddisp, int oldlen,
+                            FAR const char *newdisp, int newlen)
+{
+  char cmd[8];
+  int same;
+  int back;
+  int ndx;
+  int i;
+
+  for (same = 0;
+       same < oldlen && same < newlen && olddisp[same] == newdisp[same];
+       same++);
+
+  /* Move the cursor back to the first difference.  <esc>[<n>D is used
+   * when it is shorter than sending <n> backspaces.
+   */
+
+  back = oldlen - same;
+  if (back > 0)
+    {
+      ndx = sizeof(cmd);
+      cmd[--ndx] = 'D';
+      for (i = back; i > 0; i /= 10)
+        {
+          cmd[--ndx] = '0' + i % 10;
+        }
+
+      cmd[--ndx] = ASCII_LBRACKET;
+      cmd[--ndx] = ASCII_ESC;
+
+      if (back > (int)sizeof(cmd) - ndx)
+        {
+          RL_WRITE(vtbl, &cmd[ndx], sizeof(cmd) - ndx);
+        }
+      else
+        {
+          for (i = 0; i < back; i++)
+            {
+              RL_PUTC(vtbl, ASCII_BS);
+            }
+        }
+    }
+
+  if (newlen > same)
+    {
+      RL_WRITE(vtbl, &newdisp[same], newlen - same);
+    }
+
+  if (newlen < oldlen)
+    {
+      RL_WRITE(vtbl, g_erasetoeol, sizeof(g_erasetoeol));
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: readline_recall
+ *
+ * Description:
+ *   Replace the line with line 'n' of the history.  n == -1 gives an empty
+ *   line.  Returns the number of the line that is shown.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_READLINE_HISTORY
+static int readline_recall(FAR struct rl_common_s *vtbl, FAR char *buf,
+                           FAR int *nch, int buflen, int current, int n)
+{
+  FAR const char *text = "";
+  int len = 0;
+
+  if (n >= 0)
+    {
+      text = readline_histget(n, &len);
+      if (text == NULL)
+        {
+          RL_PUTC(vtbl, ASCII_BEL);
+          return current;
+        }
+    }
+  else
+    {
+      n = -1;
+    }
+
+  if (len > buflen - 2)
+    {
+      len = buflen - 2;
+    }
+
+  readline_update(vtbl, buf, *nch, text, len);
+  memcpy(buf, text, len);
+  *nch = len;
+  return n;
+}
+#endif
+
+/****************************************************************************
+ * Name: readline_search
+ *
+ * Description:
+ *   Incremental search backward through the history (Ctrl-R).  While the
+ *   query is typed, the newest line containing it is shown.  Ctrl-R finds
+ *   the next older line, Ctrl-G abandons the search, and any other control
+ *   character accepts the line that is shown.  That character is then
+ *   returned to be handled as usual (0 if there is nothing to do).
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_READLINE_HISTORY_SEARCH
+static int readline_search(FAR struct rl_common_s *vtbl, FAR char *buf,
+                           FAR int *nch, int buflen)
+{
+  FAR const char *olddisp = buf;
+  FAR const char *prompt;
+  FAR const char *text = NULL;
+  FAR char *query;
+  FAR char *disp[2];
+  bool failed = false;
+  int dispsize;
+  int oldlen = *nch;
+  int textlen = 0;
+  int match = -ENOENT;
+  int qlen = 0;
+  int cur = 0;
+  int len;
+  int ch;
+  int n;
+
+  /* One allocation holds the query and two copies of the line as shown,
+   * the one on the terminal and the one that will replace it.
+   */
+
+  dispsize = 2 * buflen + sizeof(g_failprompt) + sizeof(g_searchsep);
+  query    = (FAR char *)malloc(buflen + 2 * dispsize);
+  if (query == NULL)
+    {
+      RL_PUTC(vtbl, ASCII_BEL);
+      return 0;
+    }
+
+  disp[0] = &query[buflen];
+  disp[1] = &disp[0][dispsize];
+
+  for (;;)
+    {
+      /* Show the query and the line that it matches */
+
+      prompt = failed ? g_failprompt : g_searchprompt;
+      len    = strlen(prompt);
+      memcpy(disp[cur], prompt, len);
+      memcpy(&disp[cur][len], query, qlen);
+      len += qlen;
+      memcpy(&disp[cur][len], g_searchsep, sizeof(g_searchsep) - 1);
+      len += sizeof(g_searchsep) - 1;
+      if (textlen > 0)
+        {
+          memcpy(&disp[cur][len], text, textlen);
+          len += textlen;
+        }
+
+      readline_update(vtbl, olddisp, oldlen, disp[cur], len);
+      olddisp = disp[cur];
+      oldlen  = len;
+      cur    ^= 1;
+
+      /* Then get the next character of the query */
+
+      ch = RL_GETC(vtbl);
+      if (ch == ASCII_DC2)
+        {
+          n = readline_histsearch(query, qlen, match + 1);
+          if (n < 0)
+            {
+              RL_PUTC(vtbl, ASCII_BEL);
+              continue;
+            }
+
+          match = n;
+        }
+      else if (ch == ASCII_BS || ch == ASCII_DEL)
+        {
+          if (qlen > 0)
+            {
+              qlen--;
+            }
+
+          match = readline_histsearch(query, qlen, 0);
+        }
+      else if (isprint(ch) && qlen < buflen - 2)
+        {
+          /* A longer query can only match the current line or an older
+           * one.
+           */
+
+          query[qlen++] = ch;
+          n = readline_histsearch(query, qlen, match < 0 ? 0 : match);
+          if (n < 0)
+            {
+              failed = true;
+              continue;
+            }
+
+          match = n;
+        }
+      else if (isprint(ch))
+        {
+          continue;
+        }
+      else
+        {
+          break;
+        }
+
+      failed  = match < 0 && qlen > 0;
+      text    = NULL;
+      textlen = 0;
+
+      if (match >= 0)
+        {
+          text = readline_histget(match, &textlen);
+          if (textlen > buflen - 2)
+            {
+              textlen = buflen - 2;
+            }
+        }
+    }
+
+  /* Ctrl-G leaves the line as it was before the search.  Anything else
+   * takes the line that was found.
+   */
+
+  if (ch == ASCII_BEL)
+    {
+      ch = 0;
+    }
+  else if (text != NULL)
+    {
+      memcpy(buf, text, textlen);
+      *nch = textlen;
+    }
+
+  readline_update(vtbl, olddisp, oldlen, buf, *nch);
+  free(query);
+  return ch;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -116,6 +386,9 @@ ssize_t readline_common(FAR struct rl_common_s *vtbl, FAR char *buf, int buflen)
 {
   int  escape;
   int  nch;
+#ifdef CONFIG_READLINE_HISTORY
+  int  histndx = -1;  /* The line of history shown, -1 for a new line */
+#endif
 
   /* Sanity checks */
 
@@ -149,6 +422,24 @@ ssize_t readline_common(FAR struct rl_common_s *vtbl, FAR char *buf, int buflen)
 
       int ch = RL_GETC(vtbl);
 
+#ifdef CONFIG_READLINE_HISTORY_SEARCH
+      /* Ctrl-R starts an incremental search of the history.  The character
+       * that ended the search, if any, is handled below.
+       */
+
+      if (ch == ASCII_DC2)
+        {
+          ch      = readline_search(vtbl, buf, &nch, buflen);
+          histndx = -1;
+          escape  = 0;
+
+          if (ch == 0)
+            {
+              continue;
+            }
+        }
+#endif
+
       /* Check for end-of-file or read error */
 
       if (ch == EOF)
@@ -173,14 +464,28 @@ ssize_t readline_common(FAR struct rl_common_s *vtbl, FAR char *buf, int buflen)
 
       else if (escape)
         {
-          /* Yes, is it an <esc>[, 3 byte sequence */
+          /* Yes, is it an <esc>[ or <esc>O, 3 byte sequence */
 
-          if (ch != ASCII_LBRACKET || escape == 2)
+          if ((ch != ASCII_LBRACKET && ch != 'O') || escape == 2)
             {
-              /* We are finished with the escape sequence */
+              /* We are finished with the escape sequence.  The up and down
+               * arrow keys step through the history.
+               */
+
+#ifdef CONFIG_READLINE_HISTORY
+              if (escape == 2 && ch == 'A')
+                {
+                  histndx = readline_recall(vtbl, buf, &nch, buflen,
+                                            histndx, histndx + 1);
+                }
+              else if (escape == 2 && ch == 'B')
+                {
+                  histndx = readline_recall(vtbl, buf, &nch, buflen,
+                                            histndx, histndx - 1);
+                }
+#endif
 
               escape = 0;
-              ch = 'a';
             }
           else
             {
@@ -223,6 +528,26 @@ ssize_t readline_common(FAR struct rl_common_s *vtbl, FAR char *buf, int buflen)
             }
         }
 
+#ifdef CONFIG_READLINE_HISTORY
+      /* Ctrl-P and Ctrl-N also step through the history */
+
+      else if (ch == ASCII_DLE || ch == ASCII_SO)
+        {
+          histndx = readline_recall(vtbl, buf, &nch, buflen, histndx,
+                                    ch == ASCII_DLE ? histndx + 1 :
+                                                      histndx - 1);
+        }
+#endif
+
+#ifdef CONFIG_READLINE_TABCOMPLETION
+      /* Tab completes the command or file name at the end of the line */
+
+      else if (ch == ASCII_TAB)
+        {
+          readline_tabcomplete(vtbl, buf, &nch, buflen);
+        }
+#endif
+
       /* Check for the beginning of a VT100 escape sequence */
 
       else if (ch == ASCII_ESC)
@@ -245,6 +570,15 @@ ssize_t readline_common(FAR struct rl_common_s *vtbl, FAR char *buf, int buflen)
       else if (ch == '\n' || ch == '\r')
 #endif
         {
+#ifdef CONFIG_READLINE_HISTORY
+          /* Save the line (without the newline) in the history */
+
+          if (nch > 0)
+            {
+              readline_histadd(buf, nch);
+            }
+#endif
+
           /* The newline is stored in the buffer along with the null
            * terminator.
            */
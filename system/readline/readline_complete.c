@@ -0,0 +1,366 @@
+/****************************************************************************
+ * apps/system/readline/readline_complete.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <limits.h>
+
+#include <nuttx/ascii.h>
+
+#include <apps/readline.h>
+#include "readline.h"
+
+#ifdef CONFIG_READLINE_TABCOMPLETION
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#if CONFIG_NFILE_DESCRIPTORS > 0
+#  define RL_HAVE_DIRCOMPLETION 1
+#endif
+
+/****************************************************************************
+ * Private Type Declarations
+ ****************************************************************************/
+
+/* The state of one completion */
+
+struct rl_match_s
+{
+  FAR struct rl_common_s *vtbl;  /* Used to list matches */
+  FAR const char *name;          /* The partial name being completed */
+  int namelen;                   /* Length of the partial name */
+  int count;                     /* Number of matching names */
+  int lcp;                       /* Length of the common prefix of matches */
+  bool isdir;                    /* The only match is a directory */
+  bool list;                     /* List the matches on the terminal */
+  char match[NAME_MAX + 2];      /* The first match plus '/' or ' ' */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static FAR const char *g_rl_prompt;
+static FAR const struct extmatch_vtable_s *g_rl_extmatch;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: readline_trymatch
+ *
+ * Description:
+ *   Check one candidate name against the partial name.
+ *
+ ****************************************************************************/
+
+static void readline_trymatch(FAR struct rl_match_s *m,
+                              FAR const char *candidate, bool isdir)
+{
+  int len;
+  int i;
+
+  if (strncmp(candidate, m->name, m->namelen) != 0)
+    {
+      return;
+    }
+
+  len = strlen(candidate);
+
+  if (m->list)
+    {
+      RL_WRITE(m->vtbl, candidate, len);
+      RL_WRITE(m->vtbl, isdir ? "/  " : "  ", isdir ? 3 : 2);
+      return;
+    }
+
+  if (m->count == 0)
+    {
+      if (len > NAME_MAX)
+        {
+          len = NAME_MAX;
+        }
+
+      memcpy(m->match, candidate, len);
+      m->match[len] = '\0';
+      m->lcp        = len;
+      m->isdir      = isdir;
+    }
+  else
+    {
+      for (i = m->namelen; i < m->lcp && m->match[i] == candidate[i]; i++);
+      m->lcp   = i;
+      m->isdir = false;
+    }
+
+  m->count++;
+}
+
+/****************************************************************************
+ * Name: readline_dirmatch
+ *
+ * Description:
+ *   Check the names in directory 'dir' (which is 'dirlen' bytes long and
+ *   may be relative to the current working directory).
+ *
+ ****************************************************************************/
+
+#ifdef RL_HAVE_DIRCOMPLETION
+static void readline_dirmatch(FAR struct rl_match_s *m, FAR const char *dir,
+                              int dirlen)
+{
+  FAR struct dirent *entry;
+  FAR char *path;
+  FAR DIR *dirp;
+  int len = 0;
+
+  path = (FAR char *)malloc(PATH_MAX + dirlen + 2);
+  if (path == NULL)
+    {
+      return;
+    }
+
+  /* NuttX has no relative paths:  Prepend the current working directory */
+
+  if (dirlen == 0 || dir[0] != '/')
+    {
+#ifndef CONFIG_DISABLE_ENVIRON
+      if (getcwd(path, PATH_MAX) != NULL)
+        {
+          len = strlen(path);
+        }
+#endif
+
+      if (len == 0 || path[len - 1] != '/')
+        {
+          path[len++] = '/';
+        }
+    }
+
+  memcpy(&path[len], dir, dirlen);
+  path[len + dirlen] = '\0';
+
+  dirp = opendir(path);
+  if (dirp != NULL)
+    {
+      while ((entry = readdir(dirp)) != NULL)
+        {
+          if (strcmp(entry->d_name, ".") != 0 &&
+              strcmp(entry->d_name, "..") != 0)
+            {
+              readline_trymatch(m, entry->d_name,
+                                DIRENT_ISDIRECTORY(entry->d_type));
+            }
+        }
+
+      closedir(dirp);
+    }
+
+  free(path);
+}
+#endif
+
+/****************************************************************************
+ * Name: readline_scan
+ *
+ * Description:
+ *   Check all of the candidates for the word at the end of buf[].
+ *
+ ****************************************************************************/
+
+static void readline_scan(FAR struct rl_match_s *m, FAR const char *buf,
+                          int wordpos, int nch)
+{
+  FAR const char *name;
+#ifdef RL_HAVE_DIRCOMPLETION
+  int dirlen;
+#endif
+  int i;
+
+  /* The first word on the line may also be a command */
+
+  for (i = 0; i < wordpos && buf[i] == ' '; i++);
+  if (i == wordpos && g_rl_extmatch != NULL)
+    {
+      m->name    = &buf[wordpos];
+      m->namelen = nch - wordpos;
+
+      for (i = 0; (name = g_rl_extmatch->getname(i)) != NULL; i++)
+        {
+          readline_trymatch(m, name, false);
+        }
+    }
+
+  /* Then look in the directory named by the word, up to its last '/' */
+
+#ifdef RL_HAVE_DIRCOMPLETION
+  for (dirlen = nch - wordpos;
+       dirlen > 0 && buf[wordpos + dirlen - 1] != '/';
+       dirlen--);
+
+  m->name    = &buf[wordpos + dirlen];
+  m->namelen = nch - wordpos - dirlen;
+  readline_dirmatch(m, &buf[wordpos], dirlen);
+#endif
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: readline_prompt
+ *
+ *   Set the prompt that is redrawn after a list of possible completions is
+ *   shown.  Returns the previous prompt.
+ *
+ **************************************************************************/
+
+FAR const char *readline_prompt(FAR const char *prompt)
+{
+  FAR const char *ret = g_rl_prompt;
+
+  g_rl_prompt = prompt;
+  return ret;
+}
+
+/****************************************************************************
+ * Name: readline_extmatch
+ *
+ *   Set the source of command names for the completion of the first word
+ *   on the line.  Returns the previous source.
+ *
+ **************************************************************************/
+
+FAR const struct extmatch_vtable_s *
+  readline_extmatch(FAR const struct extmatch_vtable_s *vtbl)
+{
+  FAR const struct extmatch_vtable_s *ret = g_rl_extmatch;
+
+  g_rl_extmatch = vtbl;
+  return ret;
+}
+
+/****************************************************************************
+ * Name: readline_tabcomplete
+ *
+ *   Complete the word at the end of the line.  If the word can be extended,
+ *   only the new characters are sent.  If there are several matches and
+ *   none can be extended, the matches are listed and the prompt and line
+ *   are redrawn.
+ *
+ **************************************************************************/
+
+void readline_tabcomplete(FAR struct rl_common_s *vtbl, FAR char *buf,
+                          FAR int *nch, int buflen)
+{
+  struct rl_match_s m;
+  int wordpos;
+  int len;
+
+  /* Find the beginning of the last word on the line */
+
+  for (wordpos = *nch; wordpos > 0 && buf[wordpos - 1] != ' '; wordpos--);
+
+  memset(&m, 0, sizeof(struct rl_match_s));
+  m.vtbl = vtbl;
+  readline_scan(&m, buf, wordpos, *nch);
+
+  if (m.count == 0)
+    {
+      RL_PUTC(vtbl, ASCII_BEL);
+      return;
+    }
+
+  /* Add the characters that all of the matches have in common.  A unique
+   * match is followed by a space or, for a directory, by a '/'.
+   */
+
+  if (m.lcp > m.namelen || m.count == 1)
+    {
+      len = m.lcp - m.namelen;
+      if (m.count == 1)
+        {
+          m.match[m.lcp] = m.isdir ? '/' : ' ';
+          len++;
+        }
+
+      if (*nch + len + 1 >= buflen)
+        {
+          len = buflen - *nch - 2;
+        }
+
+      if (len > 0)
+        {
+          memcpy(&buf[*nch], &m.match[m.namelen], len);
+          RL_WRITE(vtbl, &buf[*nch], len);
+          *nch += len;
+        }
+
+      return;
+    }
+
+  /* Otherwise, list the matches */
+
+  RL_PUTC(vtbl, '\n');
+  m.list = true;
+  readline_scan(&m, buf, wordpos, *nch);
+  RL_PUTC(vtbl, '\n');
+
+  if (g_rl_prompt != NULL)
+    {
+      RL_WRITE(vtbl, g_rl_prompt, strlen(g_rl_prompt));
+    }
+
+  if (*nch > 0)
+    {
+      RL_WRITE(vtbl, buf, *nch);
+    }
+}
+
+#endif /* CONFIG_READLINE_TABCOMPLETION */
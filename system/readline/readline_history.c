@@ -0,0 +1,521 @@
+/****************************************************************************
+ * apps/system/readline/readline_history.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+#ifdef CONFIG_SCHED_LPWORK
+#  include <nuttx/wqueue.h>
+#endif
+
+#include "readline.h"
+
+#ifdef CONFIG_READLINE_HISTORY
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Chunk size used when the history file is read */
+
+#define HIST_READSIZE 64
+
+/****************************************************************************
+ * Private Type Declarations
+ ****************************************************************************/
+
+/* Describes one line of history.  The text of the line is kept in one
+ * contiguous, NUL-terminated piece of g_hist.text[].  'mask' has bit
+ * (ch & 31) set for every character in the line so that a search can skip
+ * most lines without looking at the text.
+ */
+
+struct rl_histent_s
+{
+  uint16_t offset;               /* Offset of the text in text[] */
+  uint16_t len;                  /* Length of the text (without NUL) */
+  uint32_t mask;                 /* Characters present in the line */
+};
+
+struct rl_history_s
+{
+  uint16_t head;                 /* Index of the oldest entry in ent[] */
+  uint16_t count;                /* Number of entries in ent[] */
+#ifdef CONFIG_READLINE_HISTORY_FILE
+  bool loaded;                   /* The history file has been read */
+  bool flushpend;                /* A flush of the new lines is pending */
+  uint16_t npending;             /* Newest lines not yet in the file */
+#ifdef CONFIG_SCHED_LPWORK
+  struct work_s work;            /* Used to append lines asynchronously */
+#endif
+#endif
+  struct rl_histent_s ent[CONFIG_READLINE_HISTORY_LINES];
+  char text[CONFIG_READLINE_HISTORY_SIZE];
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The history is shared by readline() and std_readline() and by all of the
+ * sessions that use them.
+ */
+
+static struct rl_history_s g_hist;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: readline_histent
+ *
+ * Description:
+ *   Return the n'th newest entry (0 is the newest).
+ *
+ ****************************************************************************/
+
+static inline FAR struct rl_histent_s *readline_histent(int n)
+{
+  return &g_hist.ent[(g_hist.head + g_hist.count - 1 - n) %
+                     CONFIG_READLINE_HISTORY_LINES];
+}
+
+/****************************************************************************
+ * Name: readline_histmask
+ ****************************************************************************/
+
+static uint32_t readline_histmask(FAR const char *text, int len)
+{
+  uint32_t mask = 0;
+
+  for (; len > 0; len--)
+    {
+      mask |= (uint32_t)1 << (*text++ & 31);
+    }
+
+  return mask;
+}
+
+/****************************************************************************
+ * Name: readline_histinsert
+ *
+ * Description:
+ *   Add a line to the history, discarding the oldest lines as needed to
+ *   make room for it.  Returns false if the line was not added.
+ *
+ ****************************************************************************/
+
+static bool readline_histinsert(FAR const char *line, int len)
+{
+  FAR struct rl_histent_s *ent;
+  unsigned int pos;
+  unsigned int need = len + 1;
+
+  if (len <= 0 || need > CONFIG_READLINE_HISTORY_SIZE)
+    {
+      return false;
+    }
+
+  /* Don't save the same line twice in a row */
+
+  if (g_hist.count > 0)
+    {
+      ent = readline_histent(0);
+      if (ent->len == len &&
+          memcmp(&g_hist.text[ent->offset], line, len) == 0)
+        {
+          return false;
+        }
+
+      pos = ent->offset + ent->len + 1;
+    }
+  else
+    {
+      pos = 0;
+    }
+
+  /* Lines are never split.  If the line will not fit at the end of the
+   * buffer, then discard the old lines that are still there and start again
+   * at the beginning.
+   */
+
+  if (pos + need > CONFIG_READLINE_HISTORY_SIZE)
+    {
+      while (g_hist.count > 0 && g_hist.ent[g_hist.head].offset >= pos)
+        {
+          g_hist.head = (g_hist.head + 1) % CONFIG_READLINE_HISTORY_LINES;
+          g_hist.count--;
+        }
+
+      pos = 0;
+    }
+
+  /* Then discard the oldest lines until there is a free entry and the new
+   * text does not overlap the oldest remaining line.
+   */
+
+  while (g_hist.count > 0)
+    {
+      ent = &g_hist.ent[g_hist.head];
+      if (g_hist.count < CONFIG_READLINE_HISTORY_LINES &&
+          (ent->offset < pos || ent->offset >= pos + need))
+        {
+          break;
+        }
+
+      g_hist.head = (g_hist.head + 1) % CONFIG_READLINE_HISTORY_LINES;
+      g_hist.count--;
+    }
+
+  if (g_hist.count == 0)
+    {
+      g_hist.head = 0;
+      pos         = 0;
+    }
+
+  g_hist.count++;
+  ent         = readline_histent(0);
+  ent->offset = pos;
+  ent->len    = len;
+  ent->mask   = readline_histmask(line, len);
+
+  memcpy(&g_hist.text[pos], line, len);
+  g_hist.text[pos + len] = '\0';
+  return true;
+}
+
+/****************************************************************************
+ * Name: readline_histflush
+ *
+ * Description:
+ *   Append the lines that are not yet in the history file to the file.
+ *   This normally runs on the low priority work queue so that the caller
+ *   of readline() does not wait for the file system.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_READLINE_HISTORY_FILE
+static void readline_histflush(FAR void *arg)
+{
+  FAR struct rl_histent_s *ent;
+  FAR const char *text;
+  int len;
+  int fd;
+
+  sched_lock();
+  g_hist.flushpend = false;
+  sched_unlock();
+
+  fd = open(CONFIG_READLINE_HISTORY_PATH, O_WRONLY | O_CREAT | O_APPEND,
+            0666);
+  if (fd < 0)
+    {
+      return;
+    }
+
+  for (; ; )
+    {
+      sched_lock();
+      if (g_hist.npending == 0)
+        {
+          sched_unlock();
+          break;
+        }
+
+      g_hist.npending--;
+      ent  = readline_histent(g_hist.npending);
+      text = &g_hist.text[ent->offset];
+      len  = ent->len;
+      sched_unlock();
+
+      /* The text could only be overwritten here if a whole buffer's worth
+       * of new lines were entered while this one line was being written.
+       */
+
+      (void)write(fd, text, len);
+      (void)write(fd, "\n", 1);
+    }
+
+  close(fd);
+}
+#endif
+
+/****************************************************************************
+ * Name: readline_histload
+ *
+ * Description:
+ *   Restore the history from the history file.  If the file has grown to
+ *   more than twice the size of the history buffer, it is rewritten with
+ *   only the lines that were kept.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_READLINE_HISTORY_FILE
+static void readline_histload(void)
+{
+  FAR char *line;
+  char buffer[HIST_READSIZE];
+  off_t filesize = 0;
+  ssize_t nread;
+  ssize_t i;
+  int len = 0;
+  int fd;
+
+  g_hist.loaded = true;
+
+  fd = open(CONFIG_READLINE_HISTORY_PATH, O_RDONLY);
+  if (fd < 0)
+    {
+      return;
+    }
+
+  line = (FAR char *)malloc(CONFIG_READLINE_HISTORY_SIZE);
+  if (line == NULL)
+    {
+      close(fd);
+      return;
+    }
+
+  while ((nread = read(fd, buffer, HIST_READSIZE)) > 0)
+    {
+      filesize += nread;
+      for (i = 0; i < nread; i++)
+        {
+          if (buffer[i] == '\n')
+            {
+              sched_lock();
+              (void)readline_histinsert(line, len);
+              sched_unlock();
+              len = 0;
+            }
+          else if (len < CONFIG_READLINE_HISTORY_SIZE)
+            {
+              line[len++] = buffer[i];
+            }
+        }
+    }
+
+  free(line);
+  close(fd);
+
+  if (filesize > 2 * CONFIG_READLINE_HISTORY_SIZE)
+    {
+      fd = open(CONFIG_READLINE_HISTORY_PATH, O_WRONLY | O_TRUNC);
+      if (fd >= 0)
+        {
+          close(fd);
+
+          sched_lock();
+          g_hist.npending = g_hist.count;
+          sched_unlock();
+
+          readline_histflush(NULL);
+        }
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: readline_histinit
+ ****************************************************************************/
+
+static inline void readline_histinit(void)
+{
+#ifdef CONFIG_READLINE_HISTORY_FILE
+  if (!g_hist.loaded)
+    {
+      readline_histload();
+    }
+#endif
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: readline_histadd
+ *
+ * Description:
+ *   Add a line (without its newline) to the history.  With
+ *   CONFIG_READLINE_HISTORY_FILE, the line is also appended to the history
+ *   file, on the low priority work queue if there is one.  Otherwise the
+ *   line is written before returning;  it is not queued on the high
+ *   priority work queue, which must not wait for the file system.
+ *
+ ****************************************************************************/
+
+void readline_histadd(FAR const char *line, int len)
+{
+#ifdef CONFIG_READLINE_HISTORY_FILE
+  bool flush = false;
+
+  readline_histinit();
+
+  sched_lock();
+  if (readline_histinsert(line, len))
+    {
+      /* Lines that were discarded before they were written are lost */
+
+      if (++g_hist.npending > g_hist.count)
+        {
+          g_hist.npending = g_hist.count;
+        }
+
+      flush            = !g_hist.flushpend;
+      g_hist.flushpend = true;
+    }
+
+  sched_unlock();
+
+  if (flush)
+    {
+#ifdef CONFIG_SCHED_LPWORK
+      (void)work_queue(LPWORK, &g_hist.work, readline_histflush, NULL, 0);
+#else
+      readline_histflush(NULL);
+#endif
+    }
+#else
+  sched_lock();
+  (void)readline_histinsert(line, len);
+  sched_unlock();
+#endif
+}
+
+/****************************************************************************
+ * Name: readline_histcount
+ *
+ * Description:
+ *   Return the number of lines in the history.
+ *
+ ****************************************************************************/
+
+int readline_histcount(void)
+{
+  readline_histinit();
+  return g_hist.count;
+}
+
+/****************************************************************************
+ * Name: readline_histget
+ *
+ * Description:
+ *   Return the n'th newest line of history (0 is the newest) and its
+ *   length.  The returned text is NUL terminated.
+ *
+ ****************************************************************************/
+
+FAR const char *readline_histget(int n, FAR int *len)
+{
+  FAR struct rl_histent_s *ent;
+
+  readline_histinit();
+  if (n < 0 || n >= g_hist.count)
+    {
+      return NULL;
+    }
+
+  ent  = readline_histent(n);
+  *len = ent->len;
+  return &g_hist.text[ent->offset];
+}
+
+/****************************************************************************
+ * Name: readline_histsearch
+ *
+ * Description:
+ *   Return the index of the newest line, starting with line 'start', that
+ *   contains 'query'.  Returns -ENOENT if there is no such line.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_READLINE_HISTORY_SEARCH
+int readline_histsearch(FAR const char *query, int qlen, int start)
+{
+  FAR struct rl_histent_s *ent;
+  FAR const char *text;
+  uint32_t qmask;
+  int n;
+  int i;
+
+  readline_histinit();
+  if (qlen <= 0)
+    {
+      return -ENOENT;
+    }
+
+  qmask = readline_histmask(query, qlen);
+  for (n = start < 0 ? 0 : start; n < g_hist.count; n++)
+    {
+      /* Skip the line without touching its text if any character of the
+       * query is missing from it.
+       */
+
+      ent = readline_histent(n);
+      if ((ent->mask & qmask) != qmask || ent->len < qlen)
+        {
+          continue;
+        }
+
+      text = &g_hist.text[ent->offset];
+      for (i = 0; i <= ent->len - qlen; i++)
+        {
+          if (text[i] == query[0] && memcmp(&text[i], query, qlen) == 0)
+            {
+              return n;
+            }
+        }
+    }
+
+  return -ENOENT;
+}
+#endif
+
+#endif /* CONFIG_READLINE_HISTORY */
@@ -0,0 +1,257 @@
+/****************************************************************************
+ * apps/system/usbmonitor/host/usbmon_decode.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <apps/usbmonitor.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The USB device trace event is an ID in the upper byte and data in the
+ * lower byte (see TRACE_EVENT() in nuttx/usb/usbdev_trace.h).
+ */
+
+#define EVENT_ID(e)    ((e) >> 8)
+#define EVENT_DATA(e)  ((e) & 0xff)
+#define NIDS           16
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Names of the TRACE_*_ID event classes of nuttx/usb/usbdev_trace.h, in
+ * the same order.
+ */
+
+static const char *g_idname[NIDS] =
+{
+  "INIT",           /* Initialization events */
+  "EP",             /* Endpoint API calls */
+  "DEV",            /* USB device API calls */
+  "CLASS",          /* USB class driver API calls */
+  "CLASSAPI",       /* Other class driver system API calls */
+  "CLASSSTATE",     /* Track class driver state changes */
+  "INTENTRY",       /* Interrupt handler entry */
+  "INTDECODE",      /* Decoded interrupt event */
+  "INTEXIT",        /* Interrupt handler exit */
+  "OUTREQQUEUED",   /* Request queued for OUT endpoint */
+  "INREQQUEUED",    /* Request queued for IN endpoint */
+  "READ",           /* Read (OUT) action */
+  "WRITE",          /* Write (IN) action */
+  "COMPLETE",       /* Request completed */
+  "DEVERROR",       /* USB controller driver error event */
+  "CLSERROR"        /* USB class driver error event */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void show_usage(const char *progname)
+{
+  fprintf(stderr, "USAGE: %s [-s] [<capture>]\n", progname);
+  fprintf(stderr, "  -s  Show only the number of records of each kind\n");
+  fprintf(stderr, "Reads standard input if no capture file is given\n");
+  exit(EXIT_FAILURE);
+}
+
+static uint16_t swap16(uint16_t value, bool swap)
+{
+  return swap ? (uint16_t)((value << 8) | (value >> 8)) : value;
+}
+
+static uint32_t swap32(uint32_t value, bool swap)
+{
+  if (swap)
+    {
+      value = ((value & 0x000000ff) << 24) | ((value & 0x0000ff00) << 8) |
+              ((value & 0x00ff0000) >> 8)  | ((value & 0xff000000) >> 24);
+    }
+
+  return value;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char **argv)
+{
+  struct usbmon_header_s header;
+  struct usbmon_record_s record;
+  unsigned long count[NIDS + 1];
+  unsigned long nrecords = 0;
+  unsigned long nlost = 0;
+  unsigned long long usec;
+  uint8_t skip[256];
+  uint16_t event;
+  uint16_t value;
+  bool summary = false;
+  bool swap;
+  FILE *stream = stdin;
+  int option;
+  int id;
+
+  while ((option = getopt(argc, argv, "sh")) != ERROR)
+    {
+      switch (option)
+        {
+          case 's':
+            summary = true;
+            break;
+
+          case 'h':
+          default:
+            show_usage(argv[0]);
+        }
+    }
+
+  if (optind < argc - 1)
+    {
+      show_usage(argv[0]);
+    }
+  else if (optind == argc - 1)
+    {
+      stream = fopen(argv[optind], "rb");
+      if (stream == NULL)
+        {
+          perror(argv[optind]);
+          return EXIT_FAILURE;
+        }
+    }
+
+  /* Check the header.  Newer versions may have larger records;  only the
+   * part that is known here is used.
+   */
+
+  if (fread(&header, sizeof(header), 1, stream) != 1 ||
+      memcmp(header.magic, USBMON_MAGIC, sizeof(header.magic)) != 0)
+    {
+      fprintf(stderr, "ERROR: Not a USB monitor capture\n");
+      return EXIT_FAILURE;
+    }
+
+  swap = header.byteorder != USBMON_BYTEORDER;
+  header.usecpertick = swap32(header.usecpertick, swap);
+
+  if (swap16(header.byteorder, swap) != USBMON_BYTEORDER ||
+      header.recsize < sizeof(record) ||
+      header.recsize - sizeof(record) > sizeof(skip))
+    {
+      fprintf(stderr, "ERROR: Unsupported capture format\n");
+      return EXIT_FAILURE;
+    }
+
+  if (!summary)
+    {
+      printf("Capture version %u, %s endian, %lu usec per tick\n",
+             header.version,
+             ((const uint8_t *)&header.byteorder)[0] == 0x01 ?
+             "big" : "little", (unsigned long)header.usecpertick);
+    }
+
+  memset(count, 0, sizeof(count));
+  while (fread(&record, sizeof(record), 1, stream) == 1)
+    {
+      if (header.recsize > sizeof(record) &&
+          fread(skip, header.recsize - sizeof(record), 1, stream) != 1)
+        {
+          break;
+        }
+
+      event = swap16(record.event, swap);
+      value = swap16(record.value, swap);
+      usec  = (unsigned long long)swap32(record.time, swap) *
+              header.usecpertick;
+
+      if (event == USBMON_EVENT_DROPPED)
+        {
+          nlost += value;
+          if (!summary)
+            {
+              printf("%6llu.%06llu  *** %u records lost\n",
+                     usec / 1000000, usec % 1000000, value);
+            }
+
+          continue;
+        }
+
+      nrecords++;
+      id = EVENT_ID(event) < NIDS ? EVENT_ID(event) : NIDS;
+      count[id]++;
+
+      if (!summary)
+        {
+          printf("%6llu.%06llu  %-12s %02x  %04x\n",
+                 usec / 1000000, usec % 1000000,
+                 id < NIDS ? g_idname[id] : "UNKNOWN", EVENT_DATA(event),
+                 value);
+        }
+    }
+
+  if (summary)
+    {
+      for (id = 0; id <= NIDS; id++)
+        {
+          if (count[id] > 0)
+            {
+              printf("%-12s %10lu\n", id < NIDS ? g_idname[id] : "UNKNOWN",
+                     count[id]);
+            }
+        }
+    }
+
+  printf("%lu records, %lu lost\n", nrecords, nlost);
+
+  if (stream != stdin)
+    {
+      fclose(stream);
+    }
+
+  return EXIT_SUCCESS;
+}
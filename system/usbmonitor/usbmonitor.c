@@ -43,14 +43,32 @@
 #include <sys/types.h>
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <sched.h>
 #include <syslog.h>
 #include <errno.h>
 
+#ifdef CONFIG_SYSTEM_USBMONITOR_BINARY
+#  include <sys/stat.h>
+#  include <fcntl.h>
+#  include <semaphore.h>
+#  include <pthread.h>
+#  ifdef CONFIG_SYSTEM_USBMONITOR_NET
+#    include <sys/socket.h>
+#    include <netinet/in.h>
+#    include <arpa/inet.h>
+#  endif
+#endif
+
+#include <nuttx/clock.h>
 #include <nuttx/usb/usbdev_trace.h>
 #include <nuttx/usb/usbhost_trace.h>
 
+#include <apps/usbmonitor.h>
+
 #ifdef CONFIG_SYSTEM_USBMONITOR
 
 /****************************************************************************
@@ -73,6 +91,31 @@
 #  define CONFIG_SYSTEM_USBMONITOR_INTERVAL 2
 #endif
 
+#ifndef CONFIG_USBDEV_TRACE
+#  undef CONFIG_SYSTEM_USBMONITOR_BINARY
+#endif
+
+#ifdef CONFIG_SYSTEM_USBMONITOR_BINARY
+#  ifndef CONFIG_SYSTEM_USBMONITOR_RINGSIZE
+#    define CONFIG_SYSTEM_USBMONITOR_RINGSIZE 512
+#  endif
+
+#  if (CONFIG_SYSTEM_USBMONITOR_RINGSIZE & \
+       (CONFIG_SYSTEM_USBMONITOR_RINGSIZE - 1)) != 0
+#    error CONFIG_SYSTEM_USBMONITOR_RINGSIZE must be a power of two
+#  endif
+
+#  ifndef CONFIG_SYSTEM_USBMONITOR_BINARY_INTERVAL
+#    define CONFIG_SYSTEM_USBMONITOR_BINARY_INTERVAL 100
+#  endif
+
+#  if !defined(CONFIG_NET_TCP) || !defined(CONFIG_NET_IPv4)
+#    undef CONFIG_SYSTEM_USBMONITOR_NET
+#  endif
+
+#  define USBMON_RINGMASK (CONFIG_SYSTEM_USBMONITOR_RINGSIZE - 1)
+#endif
+
 /* USB device trace selection */
 
 #ifdef CONFIG_USBDEV_TRACE
@@ -121,11 +164,45 @@
  * Private Types
  ****************************************************************************/
 
+#ifdef CONFIG_SYSTEM_USBMONITOR_BINARY
+/* The capture buffer is a single-producer, single-consumer ring.  The
+ * monitor daemon collects trace records into it and only ever advances
+ * head;  the writer thread sends them on in bulk and only ever advances
+ * tail.  Neither needs a lock.  The indices run freely and are reduced
+ * with USBMON_RINGMASK on use, so head - tail is always the number of
+ * records in the ring.
+ */
+
+struct usbmon_ring_s
+{
+  volatile uint32_t head;     /* Next record to be filled (daemon) */
+  volatile uint32_t tail;     /* Next record to be sent (writer) */
+  struct usbmon_record_s record[CONFIG_SYSTEM_USBMONITOR_RINGSIZE];
+};
+#endif
+
 struct usbmon_state_s
 {
   volatile bool started;
   volatile bool stop;
   pid_t pid;
+
+#ifdef CONFIG_SYSTEM_USBMONITOR_BINARY
+  /* Binary capture */
+
+  FAR char *path;             /* File to capture to (NULL: text mode) */
+#ifdef CONFIG_SYSTEM_USBMONITOR_NET
+  struct sockaddr_in server;  /* Server to capture to (if sin_port != 0) */
+#endif
+  FAR struct usbmon_ring_s *ring; /* Capture buffer */
+  sem_t wakeup;               /* Wakes up the writer thread */
+  volatile bool wrstop;       /* Writer thread should stop when idle */
+  int fd;                     /* Capture file or socket */
+  uint16_t pending;           /* Records lost since the last drop record */
+  uint32_t nrecords;          /* Number of trace records collected */
+  uint32_t ndropped;          /* Number of trace records lost */
+  volatile int wrerror;       /* Error that stopped the writer, if any */
+#endif
 };
 
 /****************************************************************************
@@ -159,21 +236,446 @@ static int usbmonitor_tracecallback(struct usbtrace_s *trace, void *arg)
 }
 #endif
 
+#ifdef CONFIG_SYSTEM_USBMONITOR_BINARY
+/****************************************************************************
+ * Name: usbmonitor_put
+ *
+ * Description:
+ *   Add one record to the capture buffer.  Called only by the daemon.
+ *
+ ****************************************************************************/
+
+static bool usbmonitor_put(FAR struct usbmon_ring_s *ring, uint32_t time,
+                           uint16_t event, uint16_t value)
+{
+  FAR volatile struct usbmon_record_s *record;
+  uint32_t head = ring->head;
+
+  if (head - ring->tail >= CONFIG_SYSTEM_USBMONITOR_RINGSIZE)
+    {
+      return false;
+    }
+
+  /* The record must be complete before the writer can see it.  Both are
+   * volatile accesses, so the compiler keeps them in this order.
+   */
+
+  record        = &ring->record[head & USBMON_RINGMASK];
+  record->time  = time;
+  record->event = event;
+  record->value = value;
+  ring->head    = head + 1;
+  return true;
+}
+
+/****************************************************************************
+ * Name: usbmonitor_capturecallback
+ *
+ * Description:
+ *   usbtrace_enumerate() callback for binary capture.  The record is only
+ *   copied;  nothing is formatted.  If the capture buffer is full, the
+ *   record is counted as lost and a USBMON_EVENT_DROPPED record is added
+ *   once there is room again.
+ *
+ ****************************************************************************/
+
+static int usbmonitor_capturecallback(struct usbtrace_s *trace, void *arg)
+{
+  FAR struct usbmon_ring_s *ring = g_usbmonitor.ring;
+  uint32_t time = *(FAR uint32_t *)arg;
+
+  g_usbmonitor.nrecords++;
+
+  /* Report earlier losses first, as soon as there is room */
+
+  if (g_usbmonitor.pending > 0 &&
+      usbmonitor_put(ring, time, USBMON_EVENT_DROPPED,
+                     g_usbmonitor.pending))
+    {
+      g_usbmonitor.pending = 0;
+    }
+
+  if (g_usbmonitor.pending > 0 ||
+      !usbmonitor_put(ring, time, trace->event, trace->value))
+    {
+      /* Lost.  The count in a drop record stops at 65535;  ndropped keeps
+       * the full count.
+       */
+
+      if (g_usbmonitor.pending < UINT16_MAX)
+        {
+          g_usbmonitor.pending++;
+        }
+
+      g_usbmonitor.ndropped++;
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: usbmonitor_writer
+ *
+ * Description:
+ *   The writer thread.  Sends the records in the capture buffer to the
+ *   capture file or socket, as many at a time as are contiguous in the
+ *   buffer.
+ *
+ ****************************************************************************/
+
+static FAR void *usbmonitor_writer(FAR void *arg)
+{
+  FAR struct usbmon_ring_s *ring = g_usbmonitor.ring;
+  FAR const uint8_t *buffer;
+  uint32_t tail;
+  uint32_t nrecords;
+  size_t nbytes;
+  ssize_t nwritten;
+
+  for (; ; )
+    {
+      tail     = ring->tail;
+      nrecords = ring->head - tail;
+
+      if (nrecords == 0)
+        {
+          /* Stop only once everything has been sent */
+
+          if (g_usbmonitor.wrstop)
+            {
+              break;
+            }
+
+          (void)sem_wait(&g_usbmonitor.wakeup);
+          continue;
+        }
+
+      /* Send up to the end of the buffer; the rest goes next time around */
+
+      if (nrecords > CONFIG_SYSTEM_USBMONITOR_RINGSIZE -
+                     (tail & USBMON_RINGMASK))
+        {
+          nrecords = CONFIG_SYSTEM_USBMONITOR_RINGSIZE -
+                     (tail & USBMON_RINGMASK);
+        }
+
+      buffer = (FAR const uint8_t *)&ring->record[tail & USBMON_RINGMASK];
+      nbytes = nrecords * sizeof(struct usbmon_record_s);
+
+      while (nbytes > 0)
+        {
+          nwritten = write(g_usbmonitor.fd, buffer, nbytes);
+          if (nwritten < 0)
+            {
+              int errcode = errno;
+              if (errcode != EINTR)
+                {
+                  /* Give up.  The daemon will find the ring full and count
+                   * everything after this as lost.
+                   */
+
+                  g_usbmonitor.wrerror = errcode;
+                  return NULL;
+                }
+            }
+          else
+            {
+              buffer += nwritten;
+              nbytes -= nwritten;
+            }
+        }
+
+      ring->tail = tail + nrecords;
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: usbmonitor_openoutput
+ *
+ * Description:
+ *   Open the capture file or connect to the capture server, and send the
+ *   capture header.
+ *
+ ****************************************************************************/
+
+static int usbmonitor_openoutput(void)
+{
+  struct usbmon_header_s header;
+  ssize_t nwritten;
+  int errcode;
+  int fd;
+
+#ifdef CONFIG_SYSTEM_USBMONITOR_NET
+  if (g_usbmonitor.server.sin_port != 0)
+    {
+      fd = socket(AF_INET, SOCK_STREAM, 0);
+      if (fd >= 0 &&
+          connect(fd, (FAR struct sockaddr *)&g_usbmonitor.server,
+                  sizeof(struct sockaddr_in)) < 0)
+        {
+          errcode = errno;
+          (void)close(fd);
+          errno = errcode;
+          fd = ERROR;
+        }
+    }
+  else
+#endif
+    {
+      fd = open(g_usbmonitor.path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    }
+
+  if (fd < 0)
+    {
+      return -errno;
+    }
+
+  memcpy(header.magic, USBMON_MAGIC, sizeof(header.magic));
+  header.byteorder   = USBMON_BYTEORDER;
+  header.version     = USBMON_VERSION;
+  header.recsize     = sizeof(struct usbmon_record_s);
+  header.usecpertick = USEC_PER_TICK;
+
+  nwritten = write(fd, &header, sizeof(header));
+  if (nwritten != sizeof(header))
+    {
+      errcode = nwritten < 0 ? errno : EIO;
+      (void)close(fd);
+      return -errcode;
+    }
+
+  return fd;
+}
+
+/****************************************************************************
+ * Name: usbmonitor_capture
+ *
+ * Description:
+ *   The daemon loop for binary capture.  The trace records are collected
+ *   much more often than in text mode, since collecting them costs little
+ *   and the USB device trace buffer is small.
+ *
+ ****************************************************************************/
+
+static int usbmonitor_capture(void)
+{
+  pthread_t writer;
+  uint32_t time;
+  uint32_t head;
+  int ret;
+
+  g_usbmonitor.ring = (FAR struct usbmon_ring_s *)
+    malloc(sizeof(struct usbmon_ring_s));
+  if (g_usbmonitor.ring == NULL)
+    {
+      syslog(LOG_INFO, USBMON_PREFIX "ERROR: Failed to allocate buffer\n");
+      return -ENOMEM;
+    }
+
+  g_usbmonitor.ring->head = 0;
+  g_usbmonitor.ring->tail = 0;
+  g_usbmonitor.wrstop     = false;
+  g_usbmonitor.wrerror    = 0;
+  g_usbmonitor.pending    = 0;
+  g_usbmonitor.nrecords   = 0;
+  g_usbmonitor.ndropped   = 0;
+
+  ret = usbmonitor_openoutput();
+  if (ret < 0)
+    {
+      syslog(LOG_INFO, USBMON_PREFIX "ERROR: Failed to open output: %d\n",
+             ret);
+      goto errout_with_ring;
+    }
+
+  syslog(LOG_INFO, USBMON_PREFIX "Capturing to %s\n", g_usbmonitor.path);
+
+  g_usbmonitor.fd = ret;
+  (void)sem_init(&g_usbmonitor.wakeup, 0, 0);
+
+  ret = pthread_create(&writer, NULL, usbmonitor_writer, NULL);
+  if (ret != 0)
+    {
+      syslog(LOG_INFO, USBMON_PREFIX
+             "ERROR: Failed to start the writer: %d\n", ret);
+      ret = -ret;
+      goto errout_with_fd;
+    }
+
+  /* Loop until we detect that there is a request to stop.  Wake up the
+   * writer only if something was collected.
+   */
+
+  while (!g_usbmonitor.stop)
+    {
+      usleep(1000L * CONFIG_SYSTEM_USBMONITOR_BINARY_INTERVAL);
+
+      time = clock_systimer();
+      head = g_usbmonitor.ring->head;
+      (void)usbtrace_enumerate(usbmonitor_capturecallback, &time);
+      if (g_usbmonitor.ring->head != head)
+        {
+          (void)sem_post(&g_usbmonitor.wakeup);
+        }
+
+#ifdef CONFIG_USBHOST_TRACE
+      (void)usbhost_trdump();
+#endif
+    }
+
+  /* Report the last losses, if any, and let the writer send what is left */
+
+  while (g_usbmonitor.pending > 0 && g_usbmonitor.wrerror == 0)
+    {
+      if (usbmonitor_put(g_usbmonitor.ring, clock_systimer(),
+                         USBMON_EVENT_DROPPED, g_usbmonitor.pending))
+        {
+          g_usbmonitor.pending = 0;
+        }
+      else
+        {
+          (void)sem_post(&g_usbmonitor.wakeup);
+          usleep(1000L * CONFIG_SYSTEM_USBMONITOR_BINARY_INTERVAL);
+        }
+    }
+
+  g_usbmonitor.wrstop = true;
+  (void)sem_post(&g_usbmonitor.wakeup);
+  (void)pthread_join(writer, NULL);
+
+  syslog(LOG_INFO, USBMON_PREFIX "%lu records, %lu lost\n",
+         (unsigned long)g_usbmonitor.nrecords,
+         (unsigned long)g_usbmonitor.ndropped);
+
+  if (g_usbmonitor.wrerror != 0)
+    {
+      syslog(LOG_INFO, USBMON_PREFIX "ERROR: Write failed: %d\n",
+             g_usbmonitor.wrerror);
+    }
+
+  ret = OK;
+
+errout_with_fd:
+  (void)sem_destroy(&g_usbmonitor.wakeup);
+  (void)close(g_usbmonitor.fd);
+
+errout_with_ring:
+  free(g_usbmonitor.ring);
+  g_usbmonitor.ring = NULL;
+  return ret;
+}
+
+/****************************************************************************
+ * Name: usbmonitor_options
+ *
+ * Description:
+ *   Parse the usbmon_start command line.  Selects binary capture if an
+ *   output is given.
+ *
+ ****************************************************************************/
+
+static int usbmonitor_options(int argc, FAR char **argv)
+{
+#ifdef CONFIG_SYSTEM_USBMONITOR_NET
+  FAR char *port;
+#endif
+  int i;
+
+  g_usbmonitor.path = NULL;
+#ifdef CONFIG_SYSTEM_USBMONITOR_NET
+  memset(&g_usbmonitor.server, 0, sizeof(struct sockaddr_in));
+#endif
+
+  for (i = 1; i < argc; i += 2)
+    {
+      if (i + 1 >= argc || g_usbmonitor.path != NULL)
+        {
+          goto errout;
+        }
+
+      if (strcmp(argv[i], "-f") == 0)
+        {
+          g_usbmonitor.path = strdup(argv[i + 1]);
+        }
+#ifdef CONFIG_SYSTEM_USBMONITOR_NET
+      else if (strcmp(argv[i], "-c") == 0)
+        {
+          /* <ipaddr>:<port>.  The path keeps the address for messages */
+
+          port = strchr(argv[i + 1], ':');
+          if (port == NULL || atoi(port + 1) <= 0)
+            {
+              goto errout;
+            }
+
+          *port = '\0';
+          g_usbmonitor.server.sin_family = AF_INET;
+          g_usbmonitor.server.sin_port   = htons(atoi(port + 1));
+          if (inet_pton(AF_INET, argv[i + 1],
+                        &g_usbmonitor.server.sin_addr) != 1)
+            {
+              goto errout;
+            }
+
+          g_usbmonitor.path = strdup(argv[i + 1]);
+        }
+#endif
+      else
+        {
+          goto errout;
+        }
+
+      if (g_usbmonitor.path == NULL)
+        {
+          return -ENOMEM;
+        }
+    }
+
+  return OK;
+
+errout:
+  free(g_usbmonitor.path);
+  g_usbmonitor.path = NULL;
+
+#ifdef CONFIG_SYSTEM_USBMONITOR_NET
+  syslog(LOG_INFO, USBMON_PREFIX
+         "Usage: usbmon_start [-f <path> | -c <ipaddr>:<port>]\n");
+#else
+  syslog(LOG_INFO, USBMON_PREFIX "Usage: usbmon_start [-f <path>]\n");
+#endif
+  return -EINVAL;
+}
+#endif /* CONFIG_SYSTEM_USBMONITOR_BINARY */
+
 static int usbmonitor_daemon(int argc, char **argv)
 {
   syslog(LOG_INFO, USBMON_PREFIX "Running: %d\n", g_usbmonitor.pid);
 
-  /* Loop until we detect that there is a request to stop. */
+#ifdef CONFIG_SYSTEM_USBMONITOR_BINARY
+  if (g_usbmonitor.path != NULL)
+    {
+      (void)usbmonitor_capture();
 
-  while (!g_usbmonitor.stop)
+      free(g_usbmonitor.path);
+      g_usbmonitor.path = NULL;
+    }
+  else
+#endif
     {
-      sleep(CONFIG_SYSTEM_USBMONITOR_INTERVAL);
+      /* Loop until we detect that there is a request to stop. */
+
+      while (!g_usbmonitor.stop)
+        {
+          sleep(CONFIG_SYSTEM_USBMONITOR_INTERVAL);
 #ifdef CONFIG_USBDEV_TRACE
-      (void)usbtrace_enumerate(usbmonitor_tracecallback, NULL);
+          (void)usbtrace_enumerate(usbmonitor_tracecallback, NULL);
 #endif
 #ifdef CONFIG_USBHOST_TRACE
-      (void)usbhost_trdump();
+          (void)usbhost_trdump();
 #endif
+        }
     }
 
   /* Stopped */
@@ -200,6 +702,15 @@ int usbmonitor_start(int argc, char **argv)
 
       /* No.. start it now */
 
+#ifdef CONFIG_SYSTEM_USBMONITOR_BINARY
+      ret = usbmonitor_options(argc, argv);
+      if (ret < 0)
+        {
+          sched_unlock();
+          return 1;
+        }
+#endif
+
 #ifdef CONFIG_USBDEV_TRACE
       /* First, initialize any USB tracing options that were requested */
 
@@ -220,6 +731,12 @@ int usbmonitor_start(int argc, char **argv)
           syslog(LOG_INFO, USBMON_PREFIX
                  "ERROR: Failed to start the USB monitor: %d\n",
                  errcode);
+
+          g_usbmonitor.started = false;
+#ifdef CONFIG_SYSTEM_USBMONITOR_BINARY
+          free(g_usbmonitor.path);
+          g_usbmonitor.path = NULL;
+#endif
         }
       else
         {
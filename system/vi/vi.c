@@ -57,6 +57,8 @@
 #include <nuttx/ascii.h>
 #include <nuttx/vt100.h>
 
+#include <apps/vtscreen.h>
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -113,10 +115,22 @@
 #define TEXT_GULP_MASK  511  /* Mask for aligning buffer allocation sizes */
 #define ALIGN_GULP(x)   (((x) + TEXT_GULP_MASK) & ~TEXT_GULP_MASK)
 
+#define LINE_GULP_SIZE  64   /* Line index allocations are managed with this unit */
+
 #define TABSIZE         8    /* A TAB is eight characters */
 #define TABMASK         7    /* Mask for TAB alignment */
 #define NEXT_TAB(p)     (((p) + TABSIZE) & ~TABMASK)
 
+/* The text is held in a gap buffer:  The text before the gap lies at the
+ * beginning of the allocation and the text after the gap lies at the end of
+ * the allocation.  These map a text offset to a text buffer index (and
+ * character).
+ */
+
+#define VI_GAPSIZE(vi)   ((vi)->gapend - (vi)->gapstart)
+#define VI_TEXTNDX(vi,p) ((p) < (vi)->gapstart ? (p) : (p) + VI_GAPSIZE(vi))
+#define VI_TEXT(vi,p)    ((vi)->text[VI_TEXTNDX(vi,p)])
+
 /* Parsed command action bits */
 
 #define CMD_READ        (1 << 0) /* Bit 0: Read */
@@ -270,7 +284,6 @@ struct vi_s
   off_t curpos;             /* The current cursor offset into the text buffer */
   off_t textsize;           /* The size of the text buffer */
   off_t winpos;             /* Offset corresponding to the start of the display */
-  off_t prevpos;            /* Previous display position */
   uint16_t hscroll;         /* Horizontal display offset */
   uint16_t value;           /* Numeric value entered prior to a command */
   uint8_t mode;             /* See enum vi_mode_s */
@@ -284,8 +297,14 @@ struct vi_s
 
   FAR char *text;           /* Dynamically allocated text buffer */
   size_t txtalloc;          /* Current allocated size of the text buffer */
+  off_t gapstart;           /* Buffer index of the beginning of the gap */
+  off_t gapend;             /* Buffer index of the first byte after the gap */
+  FAR off_t *lines;         /* Cached offsets to the beginning of each line */
+  size_t nlines;            /* Number of valid entries in lines[] */
+  size_t linealloc;         /* Current allocated size of lines[] */
   FAR char *yank;           /* Dynamically allocated yank buffer */
   size_t yankalloc;         /* Current allocated size of the yank buffer */
+  struct vtscreen_s screen; /* What is shown on the display */
 
   char filename[MAX_STRING];     /* Holds the currently selected filename */
   char findstr[MAX_STRING];      /* Holds the current search string */
@@ -308,9 +327,9 @@ static void     vi_blinkon(FAR struct vi_s *vi);
 static void     vi_boldon(FAR struct vi_s *vi);
 static void     vi_reverseon(FAR struct vi_s *vi);
 static void     vi_attriboff(FAR struct vi_s *vi);
+#if 0 /* Not used */
 static void     vi_cursoron(FAR struct vi_s *vi);
 static void     vi_cursoroff(FAR struct vi_s *vi);
-#if 0 /* Not used */
 static void     vi_cursorhome(FAR struct vi_s *vi);
 #endif
 static void     vi_setcursor(FAR struct vi_s *vi, uint16_t row,
@@ -326,6 +345,9 @@ static void     vi_error(FAR struct vi_s *vi, FAR const char *fmt, ...);
 
 /* Line positioning */
 
+static int      vi_addline(FAR struct vi_s *vi);
+static ssize_t  vi_lineindex(FAR struct vi_s *vi, off_t pos);
+static void     vi_lineinval(FAR struct vi_s *vi, off_t pos);
 static off_t    vi_linebegin(FAR struct vi_s *vi, off_t pos);
 static off_t    vi_prevline(FAR struct vi_s *vi, off_t pos);
 static off_t    vi_lineend(FAR struct vi_s *vi, off_t pos);
@@ -333,6 +355,10 @@ static off_t    vi_nextline(FAR struct vi_s *vi, off_t pos);
 
 /* Text buffer management */
 
+static FAR char *vi_textrun(FAR struct vi_s *vi, off_t pos, size_t size,
+                            FAR size_t *runsize);
+static void     vi_movegap(FAR struct vi_s *vi, off_t pos);
+static bool     vi_resizetext(FAR struct vi_s *vi, size_t allocsize);
 static bool     vi_extendtext(FAR struct vi_s *vi, off_t pos,
                   size_t increment);
 static void     vi_shrinkpos(off_t delpos, size_t delsize, FAR off_t *pos);
@@ -411,17 +437,15 @@ static void     vi_showusage(FAR struct vi_s *vi, FAR const char *progname,
 
 /* VT100 escape sequences */
 
+#if 0 /* Not used */
 static const char g_cursoron[]      = VT100_CURSORON;
 static const char g_cursoroff[]     = VT100_CURSOROFF;
-#if 0 /* Not used */
 static const char g_cursorhome[]    = VT100_CURSORHOME;
 #endif
 static const char g_erasetoeol[]    = VT100_CLEAREOL;
 #if 0 /* Not used */
 static const char g_clrscreen[]     = VT100_CLEARSCREEN;
 #endif
-static const char g_index[]         = VT100_INDEX;
-static const char g_revindex[]      = VT100_REVINDEX;
 static const char g_attriboff[]     = VT100_MODESOFF;
 static const char g_boldon[]        = VT100_BOLD;
 static const char g_reverseon[]     = VT100_REVERSE;
@@ -432,8 +456,6 @@ static const char g_reverseoff[]    = VT100_REVERSEOFF;
 static const char g_blinkoff[]      = VT100_BLINKOFF;
 #endif
 
-static const char g_fmtcursorpos[]  = VT100_FMT_CURSORPOS;
-
 /* Error format strings */
 
 static const char g_fmtallocfail[]  = "Failed to allocate memory";
@@ -484,55 +506,38 @@ static int vi_debug(FAR const char *fmt, ...)
  * Name: vi_write
  *
  * Description:
- *   Write a sequence of bytes to the console device (stdout, fd = 1).
+ *   Add a sequence of bytes to the console output (stdout, fd = 1).  The
+ *   output is buffered and sent when the display is updated or before
+ *   waiting for input.
  *
  ****************************************************************************/
 
 static void vi_write(FAR struct vi_s *vi, FAR const char *buffer,
                      size_t buflen)
 {
-  ssize_t nwritten;
-  size_t  nremaining = buflen;
-
   //vivdbg("buffer=%p buflen=%d\n", buffer, (int)buflen);
 
-  /* Loop until all bytes have been successfully written (or until a
-   * unrecoverable error is encountered)
-   */
-
-  do
-    {
-      /* Take the next gulp */
-
-      nwritten = write(1, buffer, buflen);
-
-      /* Handle write errors.  write() should neve return 0. */
-
-      if (nwritten <= 0)
-        {
-          /* EINTR is not really an error; it simply means that a signal was
-           * received while waiting for write.
-           */
+  vtscreen_write(&vi->screen, buffer, buflen);
+}
 
-          int errcode = errno;
-          if (nwritten == 0 || errcode != EINTR)
-            {
-              fprintf(stderr, "ERROR: write to stdout failed: %d\n",
-                      errcode);
-              exit(EXIT_FAILURE);
-            }
-        }
+/****************************************************************************
+ * Name: vi_flush
+ *
+ * Description:
+ *   Send the buffered console output.
+ *
+ ****************************************************************************/
 
-      /* Decrement the count of bytes remaining to be sent (to handle the
-       * case of a partial write)
-       */
+static void vi_flush(FAR struct vi_s *vi)
+{
+  int ret;
 
-      else
-        {
-          nremaining -= nwritten;
-        }
+  ret = vtscreen_flush(&vi->screen);
+  if (ret < 0)
+    {
+      fprintf(stderr, "ERROR: write to stdout failed: %d\n", -ret);
+      exit(EXIT_FAILURE);
     }
-  while (nremaining > 0);
 }
 
 /****************************************************************************
@@ -561,6 +566,10 @@ static char vi_getch(FAR struct vi_s *vi)
   char buffer;
   ssize_t nread;
 
+  /* Send any buffered output before waiting for input */
+
+  vi_flush(vi);
+
   /* Loop until we successfully read a character (or until an unexpected
    * error occurs).
    */
@@ -666,6 +675,7 @@ static void vi_attriboff(FAR struct vi_s *vi)
  *
  ****************************************************************************/
 
+#if 0 /* Not used */
 static void vi_cursoron(FAR struct vi_s *vi)
 {
   /* Send the VT100 CURSORON command */
@@ -687,6 +697,7 @@ static void vi_cursoroff(FAR struct vi_s *vi)
 
   vi_write(vi, g_cursoroff, sizeof(g_cursoroff));
 }
+#endif
 
 /****************************************************************************
  * Name: vi_cursorhome
@@ -715,18 +726,11 @@ static void vi_cursorhome(FAR struct vi_s *vi)
 
 static void vi_setcursor(FAR struct vi_s *vi, uint16_t row, uint16_t column)
 {
-  char buffer[16];
-  int len;
-
   vivdbg("row=%d column=%d\n", row, column);
 
-  /* Format the cursor position command.  The origin is (1,1). */
-
-  len = snprintf(buffer, 16, g_fmtcursorpos, row + 1, column + 1);
+  /* Send the shortest cursor movement from the current position */
 
-  /* Send the VT100 CURSORPOS command */
-
-  vi_write(vi, buffer, len);
+  vtscreen_moveto(&vi->screen, row, column);
 }
 
 /****************************************************************************
@@ -762,50 +766,6 @@ static void vi_clrscreen(FAR struct vi_s *vi)
 }
 #endif
 
-/****************************************************************************
- * Name: vi_scrollup
- *
- * Description:
- *   Scroll the display up 'nlines' by sending the VT100 INDEX command.
- *
- ****************************************************************************/
-
-static void vi_scrollup(FAR struct vi_s *vi, uint16_t nlines)
-{
-  vivdbg("nlines=%d\n", nlines);
-
-  /* Scroll for the specified number of lines */
-
-  for (; nlines; nlines--)
-    {
-      /* Send the VT100 INDEX command */
-
-      vi_write(vi, g_index, sizeof(g_index));
-    }
-}
-
-/****************************************************************************
- * Name: vi_scrolldown
- *
- * Description:
- *   Scroll the display down 'nlines' by sending the VT100 REVINDEX command.
- *
- ****************************************************************************/
-
-static void vi_scrolldown(FAR struct vi_s *vi, uint16_t nlines)
-{
-  vivdbg("nlines=%d\n", nlines);
-
-  /* Scroll for the specified number of lines */
-
-  for (; nlines; nlines--)
-    {
-      /* Send the VT100 REVINDEX command */
-
-      vi_write(vi, g_revindex, sizeof(g_revindex));
-    }
-}
-
 /****************************************************************************
  * Name: vi_error
  *
@@ -857,6 +817,7 @@ static void vi_error(FAR struct vi_s *vi, FAR const char *fmt, ...)
    */
 
   vi->error = true;
+  vtscreen_invalidate(&vi->screen, vi->display.row - 1, 1);
   VI_BEL(vi);
 }
 
@@ -864,6 +825,137 @@ static void vi_error(FAR struct vi_s *vi, FAR const char *fmt, ...)
  * Line positioning
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: vi_addline
+ *
+ * Description:
+ *   Extend the line index by one line.  The line index is built lazily:
+ *   It holds the offsets to the beginning of every line up to and including
+ *   the line beginning at lines[nlines-1], but nothing is known about the
+ *   text beyond that.
+ *
+ * Returned Value:
+ *   One if a line was added, zero if the index already reaches the last
+ *   line of the text, or -ENOMEM if the index could not be reallocated.
+ *
+ ****************************************************************************/
+
+static int vi_addline(FAR struct vi_s *vi)
+{
+  FAR off_t *alloc;
+  off_t pos;
+
+  /* Find the beginning of the line that follows the last line in the
+   * index.  The first line always begins at offset zero.
+   */
+
+  pos = 0;
+  if (vi->nlines > 0)
+    {
+      pos = vi_lineend(vi, vi->lines[vi->nlines - 1]);
+      if (pos >= vi->textsize)
+        {
+          return 0;
+        }
+
+      pos++;
+    }
+
+  /* Reallocate the index if it is full */
+
+  if (vi->nlines >= vi->linealloc)
+    {
+      alloc = (FAR off_t *)realloc(vi->lines,
+                                   (vi->linealloc + LINE_GULP_SIZE) *
+                                   sizeof(off_t));
+      if (!alloc)
+        {
+          return -ENOMEM;
+        }
+
+      vi->lines      = alloc;
+      vi->linealloc += LINE_GULP_SIZE;
+    }
+
+  vi->lines[vi->nlines++] = pos;
+  return 1;
+}
+
+/****************************************************************************
+ * Name: vi_lineindex
+ *
+ * Description:
+ *   Return the index of the line containing 'pos' in the line index,
+ *   extending the index as necessary.  A negative value is returned if the
+ *   index could not be extended.
+ *
+ ****************************************************************************/
+
+static ssize_t vi_lineindex(FAR struct vi_s *vi, off_t pos)
+{
+  size_t first;
+  size_t last;
+  size_t mid;
+  int ret;
+
+  /* Extend the index until it holds a line that begins beyond 'pos' or
+   * until it holds the final line of the text.
+   */
+
+  while (vi->nlines == 0 || vi->lines[vi->nlines - 1] <= pos)
+    {
+      ret = vi_addline(vi);
+      if (ret < 0)
+        {
+          return ret;
+        }
+      else if (ret == 0)
+        {
+          break;
+        }
+    }
+
+  /* Then perform a binary search for the last line that begins at or
+   * before 'pos'.  lines[0] is always zero.
+   */
+
+  first = 0;
+  last  = vi->nlines - 1;
+
+  while (first < last)
+    {
+      mid = (first + last + 1) >> 1;
+      if (vi->lines[mid] <= pos)
+        {
+          first = mid;
+        }
+      else
+        {
+          last = mid - 1;
+        }
+    }
+
+  return (ssize_t)first;
+}
+
+/****************************************************************************
+ * Name: vi_lineinval
+ *
+ * Description:
+ *   The text has been modified at 'pos'.  Discard all line index entries
+ *   beyond that position.  Lines beginning at or before 'pos' are not
+ *   affected by the modification.
+ *
+ ****************************************************************************/
+
+static void vi_lineinval(FAR struct vi_s *vi, off_t pos)
+{
+  while (vi->nlines > 0 && vi->lines[vi->nlines - 1] > pos)
+    {
+      vi->nlines--;
+    }
+}
+
 /****************************************************************************
  * Name: vi_linebegin
  *
@@ -874,13 +966,25 @@ static void vi_error(FAR struct vi_s *vi, FAR const char *fmt, ...)
 
 static off_t vi_linebegin(FAR struct vi_s *vi, off_t pos)
 {
-  /* Search backward to find the previous newline character (or, possibly,
-   * the beginning of the text buffer).
-   */
+  ssize_t ndx;
+
+  /* Look up the beginning of the line in the line index */
 
-  while (pos && vi->text[pos - 1] != '\n')
+  ndx = vi_lineindex(vi, pos);
+  if (ndx >= 0)
+    {
+      pos = vi->lines[ndx];
+    }
+  else
     {
-      pos--;
+      /* Search backward to find the previous newline character (or,
+       * possibly, the beginning of the text buffer).
+       */
+
+      while (pos && VI_TEXT(vi, pos - 1) != '\n')
+        {
+          pos--;
+        }
     }
 
   vivdbg("Return pos=%ld\n", (long)pos);
@@ -924,13 +1028,26 @@ static off_t vi_prevline(FAR struct vi_s *vi, off_t pos)
 
 static off_t vi_lineend(FAR struct vi_s *vi, off_t pos)
 {
+  FAR char *run;
+  FAR char *nl;
+  size_t runsize;
+
   /* Search forward to find the next newline character. (or, possibly,
-   * the end of the text buffer).
+   * the end of the text buffer).  The text is searched in (at most) two
+   * contiguous runs:  Before and after the gap.
    */
 
-  while (pos < vi->textsize && vi->text[pos] != '\n')
+  while (pos < vi->textsize)
     {
-      pos++;
+      run = vi_textrun(vi, pos, vi->textsize - pos, &runsize);
+      nl  = (FAR char *)memchr(run, '\n', runsize);
+      if (nl)
+        {
+          pos += nl - run;
+          break;
+        }
+
+      pos += runsize;
     }
 
   vivdbg("Return pos=%ld\n", (long)pos);
@@ -968,6 +1085,115 @@ static off_t vi_nextline(FAR struct vi_s *vi, off_t pos)
  * Text buffer management
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: vi_textrun
+ *
+ * Description:
+ *   Return a pointer to the contiguous run of text beginning at 'pos'.  The
+ *   run ends at the gap or after 'size' bytes, whichever comes first.  The
+ *   size of the run is returned in 'runsize'.
+ *
+ ****************************************************************************/
+
+static FAR char *vi_textrun(FAR struct vi_s *vi, off_t pos, size_t size,
+                            FAR size_t *runsize)
+{
+  if (pos < vi->gapstart && pos + size > vi->gapstart)
+    {
+      size = vi->gapstart - pos;
+    }
+
+  *runsize = size;
+  return &vi->text[VI_TEXTNDX(vi, pos)];
+}
+
+/****************************************************************************
+ * Name: vi_movegap
+ *
+ * Description:
+ *   Move the gap so that it begins at the text offset 'pos'.  Only the text
+ *   between the old and new gap positions is moved.
+ *
+ ****************************************************************************/
+
+static void vi_movegap(FAR struct vi_s *vi, off_t pos)
+{
+  off_t gapsize = VI_GAPSIZE(vi);
+
+  if (pos < vi->gapstart)
+    {
+      /* Move the text between 'pos' and the gap to the end of the gap */
+
+      memmove(&vi->text[pos + gapsize], &vi->text[pos],
+              vi->gapstart - pos);
+    }
+  else if (pos > vi->gapstart)
+    {
+      /* Move the text between the gap and 'pos' to the start of the gap */
+
+      memmove(&vi->text[vi->gapstart], &vi->text[vi->gapend],
+              pos - vi->gapstart);
+    }
+
+  vi->gapstart = pos;
+  vi->gapend   = pos + gapsize;
+}
+
+/****************************************************************************
+ * Name: vi_resizetext
+ *
+ * Description:
+ *   Reallocate the text buffer to 'allocsize' bytes.  The gap grows or
+ *   shrinks to absorb the change in size.
+ *
+ ****************************************************************************/
+
+static bool vi_resizetext(FAR struct vi_s *vi, size_t allocsize)
+{
+  FAR char *alloc;
+  size_t tailsize;
+
+  vivdbg("allocsize=%ld\n", (long)allocsize);
+
+  /* When shrinking, move the text after the gap down before it is lost */
+
+  tailsize = vi->txtalloc - vi->gapend;
+  if (allocsize < vi->txtalloc)
+    {
+      memmove(&vi->text[allocsize - tailsize], &vi->text[vi->gapend],
+              tailsize);
+
+      vi->gapend   = allocsize - tailsize;
+      vi->txtalloc = allocsize;
+    }
+
+  alloc = realloc(vi->text, allocsize);
+  if (!alloc)
+    {
+      /* Reallocation failed.  When shrinking, the old buffer is still
+       * valid and just larger than it needs to be.
+       */
+
+      return false;
+    }
+
+  /* When growing, move the text after the gap up to the end of the new
+   * allocation.
+   */
+
+  if (allocsize > vi->txtalloc)
+    {
+      memmove(&alloc[allocsize - tailsize], &alloc[vi->gapend], tailsize);
+      vi->gapend = allocsize - tailsize;
+    }
+
+  /* Save the new buffer information */
+
+  vi->text     = alloc;
+  vi->txtalloc = allocsize;
+  return true;
+}
+
 /****************************************************************************
  * Name: vi_extendtext
  *
@@ -975,52 +1201,50 @@ static off_t vi_nextline(FAR struct vi_s *vi, off_t pos)
  *   Reallocate the in-memory file memory by (at least) 'increment' and make
  *   space for new text of size 'increment' at the specified cursor position.
  *
+ *   The gap is moved to the cursor position so the new text lies in the
+ *   contiguous region beginning at vi->text + pos.
+ *
  ****************************************************************************/
 
 static bool vi_extendtext(FAR struct vi_s *vi, off_t pos, size_t increment)
 {
-  FAR char *alloc;
-  int i;
-
   vivdbg("pos=%ld increment=%ld\n", (long)pos, (long)increment);
 
   /* Check if we need to reallocate */
 
-  if (!vi->text || vi->textsize + increment > vi->txtalloc)
+  if ((size_t)VI_GAPSIZE(vi) < increment)
     {
       /* Allocate in chunksize so that we do not have to reallocate so
-       * often.
+       * often.  Leave room in the gap for subsequent insertions.
        */
 
-      size_t allocsize = ALIGN_GULP(vi->textsize + increment);
-      alloc = realloc(vi->text, allocsize);
-      if (!alloc)
+      size_t allocsize =
+        ALIGN_GULP(vi->textsize + increment + TEXT_GULP_SIZE);
+
+      if (!vi_resizetext(vi, allocsize))
         {
           /* Reallocation failed */
 
           vi_error(vi, g_fmtallocfail);
           return false;
         }
-
-      /* Save the new buffer information */
-
-      vi->text    = alloc;
-      vi->txtalloc = allocsize;
     }
 
-  /* Move text to make space for new text of size 'increment' at the current
-   * cursor position
+  /* Move the gap to the cursor position and take the space for the new
+   * text from the beginning of the gap.
    */
 
-  for (i = vi->textsize - 1; i >= pos; i--)
-    {
-      vi->text[i + increment] = vi->text[i];
-    }
+  vi_movegap(vi, pos);
+  vi->gapstart += increment;
 
   /* Adjust end of file position */
 
   vi->textsize += increment;
   vi->modified  = true;
+
+  /* Line index entries beyond the insertion point are no longer valid */
+
+  vi_lineinval(vi, pos);
   return true;
 }
 
@@ -1067,51 +1291,52 @@ static void vi_shrinkpos(off_t delpos, size_t delsize, FAR off_t *pos)
  * Name: vi_shrinktext
  *
  * Description:
- *   Delete a region in the text buffer by copying the end of the text buffer
- *   over the deleted region and adjusting the size of the region.  The text
- *   region may be reallocated in order to recover the unused memory.
+ *   Delete a region in the text buffer by moving the gap to the deleted
+ *   region and extending the gap over it.  The text region may be
+ *   reallocated in order to recover the unused memory.
  *
  ****************************************************************************/
 
 static void vi_shrinktext(FAR struct vi_s *vi, off_t pos, size_t size)
 {
-  FAR char *alloc;
   size_t allocsize;
-  int i;
 
   vivdbg("pos=%ld size=%ld\n", (long)pos, (long)size);
 
-  /* Close up the gap to remove 'size' characters at 'pos' */
+  /* Don't delete beyond the end of the text */
 
-  for (i = pos + size; i < vi->textsize; i++)
+  if (pos + size > vi->textsize)
     {
-      vi->text[i - size] = vi->text[i];
+      size = vi->textsize - pos;
     }
 
+  /* Move the gap to 'pos' and extend it to cover the 'size' characters
+   * to be deleted.
+   */
+
+  vi_movegap(vi, pos);
+  vi->gapend += size;
+
   /* Adjust sizes and positions */
 
   vi->textsize -= size;
   vi->modified  = true;
   vi_shrinkpos(pos, size, &vi->curpos);
   vi_shrinkpos(pos, size, &vi->winpos);
-  vi_shrinkpos(pos, size, &vi->prevpos);
+  vi_lineinval(vi, pos);
 
-  /* Reallocate the buffer to free up memory no longer in use */
+  /* Reallocate the buffer to free up memory no longer in use.  A gulp of
+   * slack is kept so that alternating insertions and deletions do not
+   * reallocate every time.
+   */
 
-  allocsize = ALIGN_GULP(vi->textsize);
-  if (allocsize < vi->txtalloc)
+  allocsize = ALIGN_GULP(vi->textsize + TEXT_GULP_SIZE);
+  if (allocsize + TEXT_GULP_SIZE < vi->txtalloc)
     {
-      alloc = realloc(vi->text, allocsize);
-      if (!alloc)
+      if (!vi_resizetext(vi, allocsize))
         {
           vi_error(vi, g_fmtallocfail);
-          return;
         }
-
-      /* Save the new buffer information */
-
-      vi->text    = alloc;
-      vi->txtalloc = allocsize;
     }
 }
 
@@ -1207,6 +1432,7 @@ static bool vi_savetext(FAR struct vi_s *vi, FAR const char *filename,
 {
   FILE *stream;
   size_t nwritten;
+  size_t runsize;
 
   vivdbg("filename=\"%s\" pos=%ld size=%ld\n",
          filename, (long)pos, (long)size);
@@ -1224,14 +1450,26 @@ static bool vi_savetext(FAR struct vi_s *vi, FAR const char *filename,
    * through pos + size -1.
    */
 
-  nwritten = fwrite(vi->text + pos, 1, size, stream);
-  if (nwritten < size)
+  while (size > 0)
     {
-      /* Report the error (or partial write).  EINTR is not handled. */
+      /* Write the next contiguous run of text (the region may be split by
+       * the gap).
+       */
 
-      vi_error(vi, g_fmtcmdfail, "fwrite", errno);
-      (void)fclose(stream);
-      return false;
+      FAR char *run = vi_textrun(vi, pos, size, &runsize);
+
+      nwritten = fwrite(run, 1, runsize, stream);
+      if (nwritten < runsize)
+        {
+          /* Report the error (or partial write).  EINTR is not handled. */
+
+          vi_error(vi, g_fmtcmdfail, "fwrite", errno);
+          (void)fclose(stream);
+          return false;
+        }
+
+      pos  += runsize;
+      size -= runsize;
     }
 
   (void)fclose(stream);
@@ -1346,6 +1584,7 @@ static void vi_setsubmode(FAR struct vi_s *vi, uint8_t mode, char prompt,
   /* Clear to the end of the line */
 
   vi_clrtoeol(vi);
+  vtscreen_invalidate(&vi->screen, vi->cursor.row, 1);
 
   /* Update the cursor position */
 
@@ -1413,7 +1652,7 @@ static void vi_windowpos(FAR struct vi_s *vi, off_t start, off_t end,
     {
       /* Is there a newline terminator at this position? */
 
-      if (vi->text[pos] == '\n')
+      if (VI_TEXT(vi, pos) == '\n')
         {
           /* Yes... break out of the loop return the cursor column */
 
@@ -1422,7 +1661,7 @@ static void vi_windowpos(FAR struct vi_s *vi, off_t start, off_t end,
 
       /* No... Is there a TAB at this position? */
 
-      else if (vi->text[pos] == '\t')
+      else if (VI_TEXT(vi, pos) == '\t')
         {
           /* Yes.. expand the TAB */
 
@@ -1454,7 +1693,9 @@ static void vi_windowpos(FAR struct vi_s *vi, off_t start, off_t end,
  * Name: vi_scrollcheck
  *
  * Description:
- *   Check if any operations will require that we scroll the display.
+ *   Check if any operations will require that we scroll the display.  The
+ *   display itself is scrolled by vtscreen_refresh() when it finds that
+ *   rows of text have moved up or down.
  *
  ****************************************************************************/
 
@@ -1464,7 +1705,6 @@ static void vi_scrollcheck(FAR struct vi_s *vi)
   off_t pos;
   uint16_t tmp;
   int column;
-  int nlines;
 
   /* Get the text buffer offset to the beginning of the current line */
 
@@ -1534,60 +1774,6 @@ static void vi_scrollcheck(FAR struct vi_s *vi)
 
   vi->cursor.column = column;
 
-  /* Check if new window position is below the previous position.
-   * In this case, we will need to scroll up until the new window
-   * position is at the top of the display.
-   */
-
-  if (vi->winpos > vi->prevpos)
-    {
-      /* We will need to scroll up.  Count how many lines we
-       * need to scroll.
-       */
-
-      for (nlines = 0, pos = vi->prevpos;
-           pos != vi->winpos && nlines < vi->display.row;
-           nlines++)
-        {
-          pos = vi_nextline(vi, pos);
-        }
-
-      /* Then scroll up that number of lines */
-
-      if (nlines < vi->display.row)
-        {
-          vi_scrollup(vi, nlines);
-        }
-    }
-
-  /* Check if new window position is above the previous position.
-   * In this case, we will need to scroll down until the new window
-   * position is at the top of the display.
-   */
-
-  else if (vi->winpos < vi->prevpos)
-    {
-
-      for (nlines = 0, pos = vi->prevpos;
-           pos != vi->winpos && nlines < vi->display.row;
-           nlines++)
-        {
-          pos = vi_prevline(vi, pos);
-        }
-
-      /* Then scroll down that number of lines */
-
-      if (nlines < vi->display.row)
-        {
-          vi_scrolldown(vi, nlines);
-        }
-    }
-
-  /* Save the previous top-of-display position for next time around.
-   * This can be modified asynchronously by text deletion operations.
-   */
-
-  vi->prevpos = vi->winpos;
   vivdbg("winpos=%ld hscroll=%d\n",
          (long)vi->winpos, (long)vi->hscroll);
 }
@@ -1600,16 +1786,22 @@ static void vi_scrollcheck(FAR struct vi_s *vi)
  *   called at the beginning of the processing loop in Command and Insert
  *   modes (and also in the continuous replace mode).
  *
+ *   Each row is formatted into the screen model and only the differences
+ *   from what is already on the display are sent.
+ *
  ****************************************************************************/
 
 static void vi_showtext(FAR struct vi_s *vi)
 {
+  FAR char *line;
   off_t pos;
   uint16_t row;
   uint16_t endrow;
   uint16_t column;
   uint16_t endcol;
   uint16_t tabcol;
+  char ch;
+  int ret;
 
   /* Check if any of the preceding operations will cause the display to
    * scroll.
@@ -1627,21 +1819,16 @@ static void vi_showtext(FAR struct vi_s *vi)
       endrow--;
     }
 
-  /* Make sure that all character attributes are disabled; Turn off the
-   * cursor during the update.
+  /* Format each line, handling horizontal scrolling and tab expansion.  If
+   * there is not enough text to fill the display, the remaining lines
+   * (except for any possible error line at the bottom of the display) are
+   * empty.
    */
 
-  vi_attriboff(vi);
-  vi_cursoroff(vi);
-
-  /* Write each line to the display, handling horizontal scrolling and
-   * tab expansion.
-   */
-
-  for (pos = vi->winpos, row = 0;
-       pos < vi->textsize && row < endrow;
-       row++)
+  for (pos = vi->winpos, row = 0; row < endrow; row++)
     {
+      line = vtscreen_getrow(&vi->screen, row);
+
       /* Get the last column on this row.  Avoid writing into the last byte
        * on the screen which may trigger a scroll.
        */
@@ -1652,88 +1839,81 @@ static void vi_showtext(FAR struct vi_s *vi)
          endcol--;
         }
 
-      /* Get the position into this line corresponding to display column 0,
-       * accounting for horizontal scrolling and tab expansion.  Add that to
-       * the line start offset to get the first offset to consider for
-       * display.
-       */
-
-      vi_windowpos(vi, pos, pos + vi->hscroll, NULL, &pos);
-
-      /* Set the cursor position to the beginning of this row and clear to
-       * the end of the line.
-       */
-
-      vi_setcursor(vi, row, 0);
-      vi_clrtoeol(vi);
-
-      /* Loop for each column */
-
-      for (column = 0; pos < vi->textsize && column < endcol; pos++)
+      column = 0;
+      if (pos < vi->textsize)
         {
-          /* Break out of the loop if we encounter the newline before the
-           * last column is encountered.
+          /* Get the position into this line corresponding to display
+           * column 0, accounting for horizontal scrolling and tab
+           * expansion.  Add that to the line start offset to get the first
+           * offset to consider for display.
            */
 
-          if (vi->text[pos] == '\n')
-            {
-              break;
-            }
+          vi_windowpos(vi, pos, pos + vi->hscroll, NULL, &pos);
 
-          /* Perform TAB expansion */
+          /* Loop for each column */
 
-          else if (vi->text[pos] == '\t')
+          for (; pos < vi->textsize && column < endcol; pos++)
             {
-              tabcol = NEXT_TAB(column);
-              if (tabcol < endcol)
+              /* Break out of the loop if we encounter the newline before
+               * the last column is encountered.
+               */
+
+              ch = VI_TEXT(vi, pos);
+              if (ch == '\n')
                 {
-                  for (; column < tabcol; column++)
+                  break;
+                }
+
+              /* Perform TAB expansion */
+
+              else if (ch == '\t')
+                {
+                  tabcol = NEXT_TAB(column);
+                  if (tabcol < endcol)
                     {
-                      vi_putch(vi, ' ');
+                      for (; column < tabcol; column++)
+                        {
+                          line[column] = ' ';
+                        }
                     }
+                  else
+                   {
+                     /* Break out of the loop... there is nothing left on
+                      * the line but whitespace.
+                      */
+
+                     break;
+                   }
                 }
-              else
-               {
-                 /* Break out of the loop... there is nothing left on the
-                  * line but whitespace.
-                  */
 
-                 break;
-               }
+              /* Add the normal character to the line */
+
+              else
+                {
+                  line[column] = ch;
+                  column++;
+                }
             }
 
-          /* Add the normal character to the display */
+          /* Skip to the beginning of the next line */
 
-          else
-            {
-              vi_putch(vi, vi->text[pos]);
-              column++;
-            }
+          pos = vi_nextline(vi, pos);
         }
 
-      /* Skip to the beginning of the next line */
+      /* Then set the text of the display row */
 
-      pos = vi_nextline(vi, pos);
+      vtscreen_setrow(&vi->screen, row, column);
     }
 
-  /* If there was not enough text to fill the display, clear the
-   * remaining lines (except for any possible error line at the
-   * bottom of the display).
-   */
+  /* Update the display and leave the cursor at the cursor position */
 
-  for (; row < endrow; row++)
+  vtscreen_setcursor(&vi->screen, vi->cursor.row, vi->cursor.column);
+  ret = vtscreen_refresh(&vi->screen);
+  if (ret < 0)
     {
-      /* Set the cursor position to the beginning of the row and clear to
-       * the end of the line.
-       */
-
-      vi_setcursor(vi, row, 0);
-      vi_clrtoeol(vi);
+      fprintf(stderr, "ERROR: write to stdout failed: %d\n", -ret);
+      exit(EXIT_FAILURE);
     }
-
-  /* Turn the cursor back on */
-
-  vi_cursoron(vi);
 }
 
 /****************************************************************************
@@ -1844,7 +2024,7 @@ static off_t vi_cursorleft(FAR struct vi_s *vi, off_t curpos, int ncolumns)
    */
 
   for (remaining = (ncolumns < 1 ? 1 : ncolumns);
-       curpos > 0 && remaining > 0 && vi->text[curpos - 1] != '\n';
+       curpos > 0 && remaining > 0 && VI_TEXT(vi, curpos - 1) != '\n';
        curpos--, remaining--);
 
   return curpos;
@@ -1871,7 +2051,7 @@ static off_t vi_cursorright(FAR struct vi_s *vi, off_t curpos, int ncolumns)
    */
 
   for (remaining = (ncolumns < 1 ? 1 : ncolumns);
-       curpos < vi->textsize && remaining > 0 && vi->text[curpos] != '\n';
+       curpos < vi->textsize && remaining > 0 && VI_TEXT(vi, curpos) != '\n';
        curpos++, remaining--);
 
   return curpos;
@@ -2011,6 +2191,9 @@ static void vi_delline(FAR struct vi_s *vi)
 
 static void vi_yank(FAR struct vi_s *vi)
 {
+  FAR char *run;
+  size_t runsize;
+  size_t offset;
   off_t start;
   off_t end;
 
@@ -2028,9 +2211,16 @@ static void vi_yank(FAR struct vi_s *vi)
       free(vi->yank);
     }
 
-  /* Allocate a yank buffer biggest enough to hold the lines */
+  /* Allocate a yank buffer biggest enough to hold the lines (and the
+   * newline terminating the final line, if there is one).
+   */
 
   vi->yankalloc = end - start + 1;
+  if (vi->yankalloc > (size_t)(vi->textsize - start))
+    {
+      vi->yankalloc = vi->textsize - start;
+    }
+
   vi->yank     = (FAR char *)malloc(vi->yankalloc);
 
   if (!vi->yank)
@@ -2040,9 +2230,15 @@ static void vi_yank(FAR struct vi_s *vi)
       return;
     }
 
-  /* Copy the block from the text buffer to the yank buffer */
+  /* Copy the block from the text buffer to the yank buffer.  The block may
+   * be split by the gap.
+   */
 
-  memcpy(vi->yank, &vi->text[start], vi->yankalloc);
+  for (offset = 0; offset < vi->yankalloc; offset += runsize)
+    {
+      run = vi_textrun(vi, start + offset, vi->yankalloc - offset, &runsize);
+      memcpy(&vi->yank[offset], run, runsize);
+    }
 
   /* Remove the yanked text from the text buffer */
 
@@ -2165,7 +2361,6 @@ static void vi_cmd_mode(FAR struct vi_s *vi)
       /* Make sure that the display reflects the current state */
 
       vi_showtext(vi);
-      vi_setcursor(vi, vi->cursor.row, vi->cursor.column);
 
       /* Get the next character from the input */
 
@@ -2940,6 +3135,7 @@ static bool vi_findstring(FAR struct vi_s *vi)
 {
   off_t pos;
   int len;
+  int i;
 
   vivdbg("findstr: \"%s\"\n", vi->findstr);
 
@@ -2961,7 +3157,8 @@ static bool vi_findstring(FAR struct vi_s *vi)
     {
       /* Check for the matching sub-string */
 
-      if (strncmp(vi->text + pos, vi->scratch, len) == 0)
+      for (i = 0; i < len && VI_TEXT(vi, pos + i) == vi->scratch[i]; i++);
+      if (i == len)
         {
           /* Found it... save the cursor position and
            * return success.
@@ -3135,9 +3332,11 @@ static void vi_replacech(FAR struct vi_s *vi, char ch)
 {
   vivdbg("curpos=%ld ch=%c[%02x]\n", vi->curpos, isprint(ch) ? ch : '.', ch);
 
-  /* Is there a newline at the current cursor position? */
+  /* Is there a newline (or the end of the text) at the current cursor
+   * position?
+   */
 
-  if (vi->text[vi->curpos] == '\n')
+  if (vi->curpos >= vi->textsize || VI_TEXT(vi, vi->curpos) == '\n')
     {
       /* Yes, then insert the new character before the newline */
 
@@ -3145,9 +3344,17 @@ static void vi_replacech(FAR struct vi_s *vi, char ch)
     }
   else
     {
-      /* No, just replace the character and increment the cursor position */
+      /* No, just replace the character and increment the cursor position.
+       * Replacing a character with a newline adds a line.
+       */
 
-      vi->text[vi->curpos++] = ch;
+      if (ch == '\n')
+        {
+          vi_lineinval(vi, vi->curpos);
+        }
+
+      VI_TEXT(vi, vi->curpos) = ch;
+      vi->curpos++;
     }
 }
 
@@ -3317,7 +3524,6 @@ static void vi_insert_mode(FAR struct vi_s *vi)
       /* Make sure that the display reflects the current state */
 
       vi_showtext(vi);
-      vi_setcursor(vi, vi->cursor.row, vi->cursor.column);
 
       /* Get the next character from the input */
 
@@ -3436,7 +3642,6 @@ static void vi_replace_mode(FAR struct vi_s *vi)
       /* Make sure that the display reflects the current state */
 
       vi_showtext(vi);
-      vi_setcursor(vi, vi->cursor.row, vi->cursor.column);
 
       /* Get the next character from the input */
 
@@ -3545,6 +3750,13 @@ static void vi_release(FAR struct vi_s *vi)
           free(vi->text);
         }
 
+      if (vi->lines)
+        {
+          free(vi->lines);
+        }
+
+      vtscreen_release(&vi->screen);
+
       if (vi->yank)
         {
           free(vi->yank);
@@ -3710,6 +3922,18 @@ int vi_main(int argc, char **argv)
       vi_showusage(vi, argv[0], EXIT_FAILURE);
     }
 
+  /* Set up the model of the display.  The display occupies the whole
+   * terminal.  Its initial contents are unknown.
+   */
+
+  if (vtscreen_initialize(&vi->screen, 1, vi->display.row,
+                          vi->display.column, VTSCREEN_FULLSCREEN) < 0)
+    {
+      fprintf(stderr, "ERROR: %s\n", g_fmtallocfail);
+      vi_release(vi);
+      return EXIT_FAILURE;
+    }
+
   /* The editor loop */
 
   for (;;)
@@ -0,0 +1,891 @@
+/****************************************************************************
+ * apps/system/vtscreen/host/vtscreen_bench.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <apps/vtscreen.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The emulated terminal */
+
+#define TERM_ROWS       24
+#define TERM_COLS       80
+#define TERM_FD         100  /* vtscreen writes to this (pseudo) descriptor */
+
+/* The text being edited */
+
+#define BENCH_NLINES    200
+#define BENCH_MAXLINES  400
+#define BENCH_NRANDOM   20000
+
+/* Editor keys */
+
+enum bench_key_e
+{
+  KEY_LEFT = 256,           /* Move left one character */
+  KEY_RIGHT,                /* Move right one character */
+  KEY_UP,                   /* Move up one line */
+  KEY_DOWN,                 /* Move down one line */
+  KEY_HOME,                 /* Move to the beginning of the line */
+  KEY_END,                  /* Move to the end of the line */
+  KEY_BACKSPACE,            /* Delete the character before the cursor */
+  KEY_DELETE,               /* Delete the character at the cursor */
+  KEY_DELLINE,              /* Delete the current line */
+  KEY_OPENLINE,             /* Insert an empty line above the cursor */
+  KEY_PAGEDOWN,             /* Move down one screen */
+  KEY_NKEYS
+};
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* A VT102 terminal emulator */
+
+struct bench_term_s
+{
+  char text[TERM_ROWS][TERM_COLS]; /* The characters on the display */
+  int row;                  /* Cursor row */
+  int column;               /* Cursor column */
+  bool wrap;                /* A character was written in the last column */
+  int state;                /* 0=normal, 1=after ESC, 2=in control sequence */
+  int param[2];             /* Control sequence parameters */
+  int nparam;               /* Number of control sequence parameters */
+  unsigned long nbytes;     /* Number of bytes received */
+  unsigned long nwrites;    /* Number of write() calls */
+  unsigned long nvt102;     /* Number of VT102 sequences received */
+};
+
+/* A minimal editor that shows text on the screen */
+
+struct bench_editor_s
+{
+  struct vtscreen_s screen; /* The screen that shows the text */
+  uint16_t nrows;           /* Height of the screen */
+  uint16_t ncols;           /* Width of the screen */
+  uint16_t orgrow;          /* Display position of the screen */
+  uint16_t orgcol;
+  bool fullscreen;          /* The screen is the whole display */
+  bool redraw;              /* Forget the display before each update */
+  int nlines;               /* Number of lines of text */
+  int top;                  /* First line shown on the screen */
+  int line;                 /* Cursor line */
+  int column;               /* Cursor column */
+  unsigned long nkeys;      /* Number of keys handled */
+  char text[BENCH_MAXLINES][TERM_COLS];
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct bench_term_s g_term;
+static unsigned long g_nerrors;
+
+static const char g_words[][8] =
+{
+  "int", "char", "ret", "if", "(", ")", "{", "}", "=", "==", "return",
+  "for", "i", "<", "++", ";", "buffer", "len", "priv", "->", "NULL",
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: term_*
+ *
+ * Description:
+ *   The VT102 terminal emulator
+ *
+ ****************************************************************************/
+
+static void term_scrollup(FAR struct bench_term_s *term, int top, int n)
+{
+  int row;
+
+  for (row = top; row < TERM_ROWS; row++)
+    {
+      if (row + n < TERM_ROWS)
+        {
+          memcpy(term->text[row], term->text[row + n], TERM_COLS);
+        }
+      else
+        {
+          memset(term->text[row], ' ', TERM_COLS);
+        }
+    }
+}
+
+static void term_scrolldown(FAR struct bench_term_s *term, int top, int n)
+{
+  int row;
+
+  for (row = TERM_ROWS - 1; row >= top; row--)
+    {
+      if (row - n >= top)
+        {
+          memcpy(term->text[row], term->text[row - n], TERM_COLS);
+        }
+      else
+        {
+          memset(term->text[row], ' ', TERM_COLS);
+        }
+    }
+}
+
+static void term_reset(FAR struct bench_term_s *term)
+{
+  memset(term, 0, sizeof(struct bench_term_s));
+  memset(term->text, ' ', sizeof(term->text));
+}
+
+static void term_csi(FAR struct bench_term_s *term, char final)
+{
+  FAR char *text = term->text[term->row];
+  int n = term->param[0] > 0 ? term->param[0] : 1;
+
+  term->wrap = false;
+  switch (final)
+    {
+      case 'A':
+        term->row = term->row - n < 0 ? 0 : term->row - n;
+        break;
+
+      case 'B':
+        term->row = term->row + n >= TERM_ROWS ? TERM_ROWS - 1 :
+                    term->row + n;
+        break;
+
+      case 'C':
+        term->column = term->column + n >= TERM_COLS ? TERM_COLS - 1 :
+                       term->column + n;
+        break;
+
+      case 'D':
+        term->column = term->column - n < 0 ? 0 : term->column - n;
+        break;
+
+      case 'H':
+        term->row    = (term->param[0] > 0 ? term->param[0] : 1) - 1;
+        term->column = (term->nparam > 1 && term->param[1] > 0 ?
+                        term->param[1] : 1) - 1;
+        if (term->row >= TERM_ROWS || term->column >= TERM_COLS)
+          {
+            printf("  ERROR: cursor position out of range\n");
+            g_nerrors++;
+            term->row    = 0;
+            term->column = 0;
+          }
+        break;
+
+      case 'K':
+        memset(&text[term->column], ' ', TERM_COLS - term->column);
+        break;
+
+      case '@':
+        n = n > TERM_COLS - term->column ? TERM_COLS - term->column : n;
+        memmove(&text[term->column + n], &text[term->column],
+                TERM_COLS - term->column - n);
+        memset(&text[term->column], ' ', n);
+        term->nvt102++;
+        break;
+
+      case 'P':
+        n = n > TERM_COLS - term->column ? TERM_COLS - term->column : n;
+        memmove(&text[term->column], &text[term->column + n],
+                TERM_COLS - term->column - n);
+        memset(&text[TERM_COLS - n], ' ', n);
+        term->nvt102++;
+        break;
+
+      case 'L':
+        term_scrolldown(term, term->row, n);
+        term->column = 0;
+        term->nvt102++;
+        break;
+
+      case 'M':
+        term_scrollup(term, term->row, n);
+        term->column = 0;
+        term->nvt102++;
+        break;
+
+      case 'h':
+      case 'l':
+      case 'm':
+        break;
+
+      default:
+        printf("  ERROR: unexpected sequence <esc>[%c\n", final);
+        g_nerrors++;
+        break;
+    }
+}
+
+static void term_putc(FAR struct bench_term_s *term, char ch)
+{
+  term->nbytes++;
+
+  if (term->state == 1)
+    {
+      term->state = 0;
+      if (ch == '[')
+        {
+          term->state  = 2;
+          term->nparam = 0;
+          term->param[0] = 0;
+          term->param[1] = 0;
+        }
+      else if (ch == 'D')
+        {
+          if (term->row == TERM_ROWS - 1)
+            {
+              term_scrollup(term, 0, 1);
+            }
+          else
+            {
+              term->row++;
+            }
+        }
+      else if (ch == 'M')
+        {
+          if (term->row == 0)
+            {
+              term_scrolldown(term, 0, 1);
+            }
+          else
+            {
+              term->row--;
+            }
+        }
+      else
+        {
+          printf("  ERROR: unexpected sequence <esc>%c\n", ch);
+          g_nerrors++;
+        }
+
+      term->wrap = false;
+    }
+  else if (term->state == 2)
+    {
+      if (ch >= '0' && ch <= '9')
+        {
+          if (term->nparam == 0)
+            {
+              term->nparam = 1;
+            }
+
+          term->param[term->nparam - 1] =
+            10 * term->param[term->nparam - 1] + ch - '0';
+        }
+      else if (ch == ';')
+        {
+          term->nparam = 2;
+        }
+      else if (ch != '?')
+        {
+          term_csi(term, ch);
+          term->state = 0;
+        }
+    }
+  else if (ch == '\033')
+    {
+      term->state = 1;
+    }
+  else if (ch == '\b')
+    {
+      term->column -= term->column > 0 ? 1 : 0;
+      term->wrap    = false;
+    }
+  else if (ch == '\r')
+    {
+      term->column = 0;
+      term->wrap   = false;
+    }
+  else if (ch == '\n')
+    {
+      if (term->row == TERM_ROWS - 1)
+        {
+          term_scrollup(term, 0, 1);
+        }
+      else
+        {
+          term->row++;
+        }
+
+      term->wrap = false;
+    }
+  else if (ch >= ' ' && ch < 0x7f)
+    {
+      if (term->wrap)
+        {
+          term->column = 0;
+          term->wrap   = false;
+          if (term->row == TERM_ROWS - 1)
+            {
+              term_scrollup(term, 0, 1);
+            }
+          else
+            {
+              term->row++;
+            }
+        }
+
+      term->text[term->row][term->column] = ch;
+      if (term->column == TERM_COLS - 1)
+        {
+          term->wrap = true;
+        }
+      else
+        {
+          term->column++;
+        }
+    }
+  else if (ch != '\a')
+    {
+      printf("  ERROR: unexpected control character 0x%02x\n", ch);
+      g_nerrors++;
+    }
+}
+
+/****************************************************************************
+ * Name: vtsbench_write
+ *
+ * Description:
+ *   vtscreen.c is compiled with write() renamed to vtsbench_write() so that
+ *   its output goes to the terminal emulator.
+ *
+ ****************************************************************************/
+
+ssize_t vtsbench_write(int fd, FAR const void *buffer, size_t buflen)
+{
+  FAR const char *ptr = (FAR const char *)buffer;
+  size_t i;
+
+  if (fd != TERM_FD)
+    {
+      errno = EBADF;
+      return -1;
+    }
+
+  g_term.nwrites++;
+  for (i = 0; i < buflen; i++)
+    {
+      term_putc(&g_term, ptr[i]);
+    }
+
+  return buflen;
+}
+
+/****************************************************************************
+ * Name: editor_*
+ *
+ * Description:
+ *   A minimal editor that shows its text with vtscreen.
+ *
+ ****************************************************************************/
+
+static void editor_line(FAR char *text, int maxlen)
+{
+  int len = 0;
+  int indent = 2 * (rand() % 4);
+  int nwords = rand() % 10;
+  int wlen;
+  int i;
+
+  for (i = 0; i < indent; i++)
+    {
+      text[len++] = ' ';
+    }
+
+  for (i = 0; i < nwords; i++)
+    {
+      FAR const char *word = g_words[rand() % (sizeof(g_words) / 8)];
+      wlen = strlen(word);
+      if (len + wlen + 1 >= maxlen)
+        {
+          break;
+        }
+
+      memcpy(&text[len], word, wlen);
+      len += wlen;
+      text[len++] = ' ';
+    }
+
+  text[len] = '\0';
+}
+
+static int editor_init(FAR struct bench_editor_s *ed, uint16_t orgrow,
+                       uint16_t orgcol, uint16_t nrows, bool redraw)
+{
+  int ret;
+  int i;
+
+  memset(ed, 0, sizeof(struct bench_editor_s));
+  ed->nrows      = nrows;
+  ed->ncols      = TERM_COLS - orgcol;
+  ed->orgrow     = orgrow;
+  ed->orgcol     = orgcol;
+  ed->fullscreen = orgrow + nrows == TERM_ROWS;
+  ed->redraw     = redraw;
+
+  ret = vtscreen_initialize(&ed->screen, TERM_FD, ed->nrows, ed->ncols,
+                            ed->fullscreen ? VTSCREEN_FULLSCREEN : 0);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  /* A one line editor begins with an empty line at the cursor position.
+   * A full screen editor begins with some text.
+   */
+
+  term_reset(&g_term);
+  if (nrows == 1)
+    {
+      memcpy(&g_term.text[orgrow][0], "nsh> ", orgcol);
+      g_term.row    = orgrow;
+      g_term.column = orgcol;
+      vtscreen_origin(&ed->screen, orgrow, orgcol);
+      ed->nlines = 1;
+    }
+  else
+    {
+      srand(1);
+      for (i = 0; i < BENCH_NLINES; i++)
+        {
+          editor_line(ed->text[i], ed->ncols - 1);
+        }
+
+      ed->nlines = BENCH_NLINES;
+    }
+
+  return OK;
+}
+
+static void editor_show(FAR struct bench_editor_s *ed)
+{
+  FAR char *row;
+  uint16_t maxlen;
+  int len;
+  int ret;
+  int i;
+
+  /* Keep the cursor line on the screen */
+
+  if (ed->line < ed->top)
+    {
+      ed->top = ed->line;
+    }
+  else if (ed->line >= ed->top + ed->nrows)
+    {
+      ed->top = ed->line - ed->nrows + 1;
+    }
+
+  /* Format the rows.  Never write into the last column of the display. */
+
+  for (i = 0; i < ed->nrows; i++)
+    {
+      row    = vtscreen_getrow(&ed->screen, i);
+      maxlen = ed->ncols - 1;
+      len    = 0;
+
+      if (ed->top + i < ed->nlines)
+        {
+          len = strlen(ed->text[ed->top + i]);
+          len = len > maxlen ? maxlen : len;
+          memcpy(row, ed->text[ed->top + i], len);
+        }
+
+      vtscreen_setrow(&ed->screen, i, len);
+    }
+
+  if (ed->redraw)
+    {
+      vtscreen_invalidate(&ed->screen, 0, ed->nrows);
+    }
+
+  vtscreen_setcursor(&ed->screen, ed->line - ed->top, ed->column);
+  ret = vtscreen_refresh(&ed->screen);
+  if (ret < 0)
+    {
+      printf("  ERROR: vtscreen_refresh failed: %d\n", ret);
+      g_nerrors++;
+    }
+}
+
+static void editor_check(FAR struct bench_editor_s *ed, int key)
+{
+  FAR const char *text;
+  int len;
+  int row;
+  int col;
+
+  /* The prompt of the one line editor must not be touched */
+
+  if (ed->nrows == 1 &&
+      memcmp(g_term.text[ed->orgrow], "nsh> ", ed->orgcol) != 0)
+    {
+      printf("  ERROR: key %d: prompt overwritten\n", key);
+      g_nerrors++;
+    }
+
+  for (row = 0; row < ed->nrows; row++)
+    {
+      text = ed->top + row < ed->nlines ? ed->text[ed->top + row] : "";
+      len  = strlen(text);
+      len  = len > ed->ncols - 1 ? ed->ncols - 1 : len;
+
+      for (col = 0; col < ed->ncols; col++)
+        {
+          if (g_term.text[ed->orgrow + row][ed->orgcol + col] !=
+              (col < len ? text[col] : ' '))
+            {
+              printf("  ERROR: key %d: row %d column %d differs\n",
+                     key, row, col);
+              printf("    want: '%.*s'\n", len, text);
+              printf("    have: '%.*s'\n", ed->ncols,
+                     &g_term.text[ed->orgrow + row][ed->orgcol]);
+              g_nerrors++;
+              return;
+            }
+        }
+    }
+
+  if (g_term.row != ed->orgrow + ed->line - ed->top ||
+      g_term.column != ed->orgcol + ed->column)
+    {
+      printf("  ERROR: key %d: cursor at (%d,%d), expected (%d,%d)\n", key,
+             g_term.row, g_term.column, ed->orgrow + ed->line - ed->top,
+             ed->orgcol + ed->column);
+      g_nerrors++;
+    }
+}
+
+static void editor_key(FAR struct bench_editor_s *ed, int key)
+{
+  FAR char *text = ed->text[ed->line];
+  int len = strlen(text);
+
+  ed->nkeys++;
+  switch (key)
+    {
+      case KEY_LEFT:
+        ed->column -= ed->column > 0 ? 1 : 0;
+        break;
+
+      case KEY_RIGHT:
+        ed->column += ed->column < len ? 1 : 0;
+        break;
+
+      case KEY_UP:
+      case KEY_DOWN:
+      case KEY_PAGEDOWN:
+        if (key == KEY_UP)
+          {
+            ed->line -= ed->line > 0 ? 1 : 0;
+          }
+        else
+          {
+            ed->line += key == KEY_DOWN ? 1 : ed->nrows;
+            ed->line  = ed->line < ed->nlines ? ed->line : ed->nlines - 1;
+          }
+
+        len = strlen(ed->text[ed->line]);
+        ed->column = ed->column < len ? ed->column : len;
+        break;
+
+      case KEY_HOME:
+        ed->column = 0;
+        break;
+
+      case KEY_END:
+        ed->column = len;
+        break;
+
+      case KEY_BACKSPACE:
+        if (ed->column > 0)
+          {
+            ed->column--;
+            memmove(&text[ed->column], &text[ed->column + 1],
+                    len - ed->column);
+          }
+        break;
+
+      case KEY_DELETE:
+        if (ed->column < len)
+          {
+            memmove(&text[ed->column], &text[ed->column + 1],
+                    len - ed->column);
+          }
+        break;
+
+      case KEY_DELLINE:
+        if (ed->nlines > 1)
+          {
+            memmove(ed->text[ed->line], ed->text[ed->line + 1],
+                    (ed->nlines - ed->line - 1) * TERM_COLS);
+            ed->nlines--;
+            ed->line   = ed->line < ed->nlines ? ed->line : ed->nlines - 1;
+            ed->column = 0;
+          }
+        break;
+
+      case KEY_OPENLINE:
+        if (ed->nlines < BENCH_MAXLINES)
+          {
+            memmove(ed->text[ed->line + 1], ed->text[ed->line],
+                    (ed->nlines - ed->line) * TERM_COLS);
+            ed->text[ed->line][0] = '\0';
+            ed->nlines++;
+            ed->column = 0;
+          }
+        break;
+
+      default:
+        if (len < ed->ncols - 2)
+          {
+            memmove(&text[ed->column + 1], &text[ed->column],
+                    len - ed->column + 1);
+            text[ed->column++] = key;
+          }
+        break;
+    }
+
+  editor_show(ed);
+  editor_check(ed, key);
+}
+
+static void editor_type(FAR struct bench_editor_s *ed, FAR const char *str)
+{
+  while (*str)
+    {
+      editor_key(ed, *str++);
+    }
+}
+
+static void editor_repeat(FAR struct bench_editor_s *ed, int key, int count)
+{
+  while (count-- > 0)
+    {
+      editor_key(ed, key);
+    }
+}
+
+/****************************************************************************
+ * Name: bench_*
+ *
+ * Description:
+ *   The benchmark scenarios.  Each is run twice:  once updating only the
+ *   differences and once redrawing the whole screen on every key.
+ *
+ ****************************************************************************/
+
+static void bench_lineedit(FAR struct bench_editor_s *ed)
+{
+  editor_type(ed, "mount -t vfat /dev/mmcsd0 /mnt");
+}
+
+static void bench_linefix(FAR struct bench_editor_s *ed)
+{
+  /* Only the corrections are counted */
+
+  editor_type(ed, "mount -t vfat /dev/mmcsd0 /mnt");
+  g_term.nbytes  = 0;
+  g_term.nwrites = 0;
+  ed->nkeys      = 0;
+
+  editor_repeat(ed, KEY_LEFT, 17);
+  editor_repeat(ed, KEY_BACKSPACE, 4);
+  editor_type(ed, "msdos");
+  editor_key(ed, KEY_HOME);
+  editor_key(ed, KEY_END);
+}
+
+static void bench_cursor(FAR struct bench_editor_s *ed)
+{
+  editor_repeat(ed, KEY_DOWN, 10);
+  editor_repeat(ed, KEY_RIGHT, 10);
+  editor_repeat(ed, KEY_UP, 5);
+}
+
+static void bench_insert(FAR struct bench_editor_s *ed)
+{
+  editor_repeat(ed, KEY_DOWN, 8);
+  editor_type(ed, "ret = vtscreen_refresh(&ed->screen);");
+}
+
+static void bench_delline(FAR struct bench_editor_s *ed)
+{
+  editor_repeat(ed, KEY_DOWN, 5);
+  editor_repeat(ed, KEY_DELLINE, 10);
+}
+
+static void bench_openline(FAR struct bench_editor_s *ed)
+{
+  editor_repeat(ed, KEY_DOWN, 5);
+  editor_repeat(ed, KEY_OPENLINE, 5);
+}
+
+static void bench_scroll(FAR struct bench_editor_s *ed)
+{
+  editor_repeat(ed, KEY_DOWN, TERM_ROWS + 40);
+  editor_repeat(ed, KEY_UP, 40);
+}
+
+static void bench_random(FAR struct bench_editor_s *ed)
+{
+  int key;
+  int i;
+
+  srand(2);
+  for (i = 0; i < BENCH_NRANDOM; i++)
+    {
+      key = rand() % 20;
+      if (key < 11)
+        {
+          key += KEY_LEFT;
+        }
+      else
+        {
+          key = 'a' + rand() % 26;
+        }
+
+      editor_key(ed, key);
+    }
+}
+
+static void bench_run(FAR const char *name, int nrows,
+                      CODE void (*scenario)(FAR struct bench_editor_s *ed))
+{
+  static struct bench_editor_s ed;
+  unsigned long nbytes[2];
+  unsigned long nwrites[2];
+  unsigned long nkeys = 1;
+  unsigned long nvt102 = 0;
+  int pass;
+
+  for (pass = 0; pass < 2; pass++)
+    {
+      if (nrows == 1)
+        {
+          editor_init(&ed, TERM_ROWS - 1, 5, 1, pass == 1);
+        }
+      else
+        {
+          editor_init(&ed, 0, 0, nrows, pass == 1);
+        }
+
+      /* Draw the initial display;  it does not count */
+
+      editor_show(&ed);
+      editor_check(&ed, 0);
+      g_term.nbytes  = 0;
+      g_term.nwrites = 0;
+      ed.nkeys       = 0;
+
+      scenario(&ed);
+
+      nbytes[pass]  = g_term.nbytes;
+      nwrites[pass] = g_term.nwrites;
+      nkeys         = ed.nkeys;
+      if (pass == 0)
+        {
+          nvt102 = g_term.nvt102;
+        }
+
+      vtscreen_release(&ed.screen);
+    }
+
+  printf("%-24s %6lu keys %7.1f bytes/key %5.2f writes/key "
+         "(redraw %7.1f bytes/key)\n", name, nkeys,
+         (double)nbytes[0] / nkeys, (double)nwrites[0] / nkeys,
+         (double)nbytes[1] / nkeys);
+
+#ifndef CONFIG_SYSTEM_VTSCREEN_VT102
+  if (nvt102 > 0)
+    {
+      printf("  ERROR: %lu VT102 sequences sent\n", nvt102);
+      g_nerrors++;
+    }
+#else
+  (void)nvt102;
+#endif
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(void)
+{
+  printf("%dx%d terminal, %s sequences\n", TERM_ROWS, TERM_COLS,
+#ifdef CONFIG_SYSTEM_VTSCREEN_VT102
+         "VT102"
+#else
+         "VT100"
+#endif
+         );
+
+  bench_run("line: type command", 1, bench_lineedit);
+  bench_run("line: fix command", 1, bench_linefix);
+  bench_run("screen: move cursor", TERM_ROWS, bench_cursor);
+  bench_run("screen: type text", TERM_ROWS, bench_insert);
+  bench_run("screen: delete lines", TERM_ROWS, bench_delline);
+  bench_run("screen: open lines", TERM_ROWS, bench_openline);
+  bench_run("screen: scroll", TERM_ROWS, bench_scroll);
+  bench_run("screen: random keys", TERM_ROWS, bench_random);
+  bench_run("region: random keys", TERM_ROWS - 4, bench_random);
+
+  printf("%lu errors\n", g_nerrors);
+  return g_nerrors > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,1124 @@
+/****************************************************************************
+ * apps/system/vtscreen/vtscreen.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+
+#include <nuttx/ascii.h>
+#include <nuttx/vt100.h>
+
+#include <apps/vtscreen.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_SYSTEM_VTSCREEN_BUFSIZE
+#  define CONFIG_SYSTEM_VTSCREEN_BUFSIZE 256
+#endif
+
+/* Row flags */
+
+#define ROW_SET         (1 << 0) /* Text set since the last refresh */
+#define ROW_RAW         (1 << 1) /* Wanted text is not all printable */
+#define ROW_OLDRAW      (1 << 2) /* Displayed text is not all printable */
+
+/* The estimated cost in bytes of redrawing a row, not counting its text */
+
+#define ROW_OVERHEAD    4
+
+/* Access to the text of a row */
+
+#define ROW_TEXT(s,r)   (&(s)->text[(size_t)(r) * (s)->ncols])
+#define ROW_SHADOW(s,r) (&(s)->shadow[(size_t)(r) * (s)->ncols])
+
+/* Ways to move the cursor horizontally */
+
+#define HMOVE_NONE      0 /* Already in the right column */
+#define HMOVE_BS        1 /* Backspace characters */
+#define HMOVE_LEFT      2 /* <esc>[nD */
+#define HMOVE_CR        3 /* Carriage return, then <esc>[nC */
+#define HMOVE_RIGHT     4 /* <esc>[nC */
+#define HMOVE_TEXT      5 /* Write the characters already on the display */
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* VT100 escape sequences */
+
+static const char g_cursoron[]     = VT100_CURSORON;
+static const char g_cursoroff[]    = VT100_CURSOROFF;
+static const char g_erasetoeol[]   = VT100_CLEAREOL;
+#ifndef CONFIG_SYSTEM_VTSCREEN_VT102
+static const char g_index[]        = VT100_INDEX;
+static const char g_revindex[]     = VT100_REVINDEX;
+#endif
+static const char g_fmtcursorpos[] = VT100_FMT_CURSORPOS;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: vtscreen_send
+ *
+ * Description:
+ *   Write the content of the output buffer to the display.  A write error
+ *   is latched and reported by the next vtscreen_flush().  Nothing is known
+ *   about the display after an error.
+ *
+ ****************************************************************************/
+
+static void vtscreen_send(FAR struct vtscreen_s *screen)
+{
+  FAR const char *buffer = screen->outbuf;
+  size_t nremaining = screen->nout;
+  ssize_t nwritten;
+
+  screen->nout = 0;
+  while (nremaining > 0)
+    {
+      nwritten = write(screen->fd, buffer, nremaining);
+      if (nwritten <= 0)
+        {
+          /* EINTR is not really an error; it simply means that a signal was
+           * received while waiting for write.
+           */
+
+          int errcode = errno;
+          if (nwritten == 0 || errcode != EINTR)
+            {
+              screen->errcode = nwritten == 0 ? -EIO : -errcode;
+              screen->currow  = VTSCREEN_UNKNOWN;
+              vtscreen_invalidate(screen, 0, screen->nrows);
+              return;
+            }
+        }
+      else
+        {
+          /* Advance past the bytes written (in case of a partial write) */
+
+          buffer     += nwritten;
+          nremaining -= nwritten;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: vtscreen_out
+ *
+ * Description:
+ *   Add bytes to the output buffer, sending the buffer when it is full.
+ *
+ ****************************************************************************/
+
+static void vtscreen_out(FAR struct vtscreen_s *screen,
+                         FAR const char *buffer, size_t buflen)
+{
+  size_t nbytes;
+
+  while (buflen > 0)
+    {
+      if (screen->nout >= CONFIG_SYSTEM_VTSCREEN_BUFSIZE)
+        {
+          vtscreen_send(screen);
+        }
+
+      nbytes = CONFIG_SYSTEM_VTSCREEN_BUFSIZE - screen->nout;
+      if (nbytes > buflen)
+        {
+          nbytes = buflen;
+        }
+
+      memcpy(&screen->outbuf[screen->nout], buffer, nbytes);
+      screen->nout += nbytes;
+      buffer       += nbytes;
+      buflen       -= nbytes;
+    }
+}
+
+/****************************************************************************
+ * Name: vtscreen_numlen
+ *
+ * Description:
+ *   Return the number of decimal digits in 'value'.
+ *
+ ****************************************************************************/
+
+static int vtscreen_numlen(unsigned int value)
+{
+  int len;
+
+  for (len = 1; value >= 10; len++)
+    {
+      value /= 10;
+    }
+
+  return len;
+}
+
+/****************************************************************************
+ * Name: vtscreen_csilen and vtscreen_csi
+ *
+ * Description:
+ *   Get the length of, or add to the output buffer, the control sequence
+ *   <esc>[<count><final>.  The count is left out if it is one.
+ *
+ ****************************************************************************/
+
+static int vtscreen_csilen(unsigned int count)
+{
+  return count == 1 ? 3 : 3 + vtscreen_numlen(count);
+}
+
+static void vtscreen_csi(FAR struct vtscreen_s *screen, unsigned int count,
+                         char final)
+{
+  char buffer[16];
+  int len;
+
+  if (count == 1)
+    {
+      len = snprintf(buffer, 16, "\033[%c", final);
+    }
+  else
+    {
+      len = snprintf(buffer, 16, "\033[%u%c", count, final);
+    }
+
+  vtscreen_out(screen, buffer, len);
+}
+
+/****************************************************************************
+ * Name: vtscreen_text
+ *
+ * Description:
+ *   Write 'len' characters of text at the cursor position.  After a
+ *   character has been written into the last column, the terminal may
+ *   wrap on the next character;  the cursor position is then treated as
+ *   unknown.
+ *
+ ****************************************************************************/
+
+static void vtscreen_text(FAR struct vtscreen_s *screen,
+                          FAR const char *text, uint16_t len)
+{
+  vtscreen_out(screen, text, len);
+
+  if (screen->currow != VTSCREEN_UNKNOWN)
+    {
+      screen->curcol += len;
+      if (screen->curcol >= screen->ncols)
+        {
+          screen->currow = VTSCREEN_UNKNOWN;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: vtscreen_cursor
+ *
+ * Description:
+ *   Find the cheapest way to move the display cursor to (row, column): An
+ *   absolute CURSORPOS or a relative move made of an optional up/down
+ *   sequence followed by backspaces, a carriage return, a left/right
+ *   sequence or a re-write of characters that are already on the display.
+ *   If 'emit' is true, that is added to the output buffer.
+ *
+ * Returned Value:
+ *   The number of bytes needed to move the cursor.
+ *
+ ****************************************************************************/
+
+static int vtscreen_cursor(FAR struct vtscreen_s *screen, uint16_t row,
+                           uint16_t column, bool emit)
+{
+  FAR struct vtscreen_row_s *rowp;
+  char buffer[24];
+  unsigned int dispcol;
+  unsigned int count;
+  int abscost;
+  int relcost;
+  int cost;
+  int hmove;
+  int len;
+
+  if (screen->currow == row && screen->curcol == column)
+    {
+      return 0;
+    }
+
+  /* The cost of an absolute move.  The origin is (1,1). */
+
+  dispcol = screen->orgcol + column;
+  abscost = 4 + vtscreen_numlen(screen->orgrow + row + 1) +
+            vtscreen_numlen(dispcol + 1);
+  relcost = abscost;
+  hmove   = HMOVE_NONE;
+
+  if (screen->currow != VTSCREEN_UNKNOWN)
+    {
+      /* The cost of the vertical part of a relative move */
+
+      relcost = 0;
+      if (row != screen->currow)
+        {
+          count   = row > screen->currow ? row - screen->currow :
+                                           screen->currow - row;
+          relcost = vtscreen_csilen(count);
+        }
+
+      /* Then pick the cheapest horizontal move */
+
+      if (column < screen->curcol)
+        {
+          count = screen->curcol - column;
+
+          hmove = HMOVE_BS;
+          cost  = count;
+
+          if (vtscreen_csilen(count) < cost)
+            {
+              hmove = HMOVE_LEFT;
+              cost  = vtscreen_csilen(count);
+            }
+
+          len = 1 + (dispcol > 0 ? vtscreen_csilen(dispcol) : 0);
+          if (len < cost)
+            {
+              hmove = HMOVE_CR;
+              cost  = len;
+            }
+
+          relcost += cost;
+        }
+      else if (column > screen->curcol)
+        {
+          count = column - screen->curcol;
+
+          hmove = HMOVE_RIGHT;
+          cost  = vtscreen_csilen(count);
+
+          /* The characters that are already on the display can be written
+           * again if their content is known.
+           */
+
+          rowp = &screen->rows[row];
+          if ((int)count < cost && rowp->oldlen != VTSCREEN_UNKNOWN &&
+              (rowp->flags & ROW_OLDRAW) == 0)
+            {
+              hmove = HMOVE_TEXT;
+              cost  = count;
+            }
+
+          relcost += cost;
+        }
+    }
+
+  if (emit)
+    {
+      if (relcost < abscost)
+        {
+          if (row < screen->currow)
+            {
+              vtscreen_csi(screen, screen->currow - row, 'A');
+            }
+          else if (row > screen->currow)
+            {
+              vtscreen_csi(screen, row - screen->currow, 'B');
+            }
+
+          switch (hmove)
+            {
+              case HMOVE_BS:
+                for (count = screen->curcol - column; count > 0; count--)
+                  {
+                    buffer[0] = ASCII_BS;
+                    vtscreen_out(screen, buffer, 1);
+                  }
+                break;
+
+              case HMOVE_LEFT:
+                vtscreen_csi(screen, screen->curcol - column, 'D');
+                break;
+
+              case HMOVE_CR:
+                buffer[0] = ASCII_CR;
+                vtscreen_out(screen, buffer, 1);
+                if (dispcol > 0)
+                  {
+                    vtscreen_csi(screen, dispcol, 'C');
+                  }
+                break;
+
+              case HMOVE_RIGHT:
+                vtscreen_csi(screen, column - screen->curcol, 'C');
+                break;
+
+              case HMOVE_TEXT:
+                {
+                  FAR const char *shadow = ROW_SHADOW(screen, row);
+                  uint16_t oldlen = screen->rows[row].oldlen;
+
+                  for (count = screen->curcol; count < column; count++)
+                    {
+                      buffer[0] = count < oldlen ? shadow[count] : ' ';
+                      vtscreen_out(screen, buffer, 1);
+                    }
+                }
+                break;
+
+              default:
+                break;
+            }
+        }
+      else
+        {
+          len = snprintf(buffer, 24, g_fmtcursorpos,
+                         screen->orgrow + row + 1, dispcol + 1);
+          vtscreen_out(screen, buffer, len);
+        }
+
+      screen->currow = row;
+      screen->curcol = column;
+    }
+
+  return relcost < abscost ? relcost : abscost;
+}
+
+/****************************************************************************
+ * Name: vtscreen_same
+ *
+ * Description:
+ *   Return true if the text wanted on 'row' is what is shown on display
+ *   row 'oldrow'.
+ *
+ ****************************************************************************/
+
+static bool vtscreen_same(FAR struct vtscreen_s *screen, uint16_t row,
+                          uint16_t oldrow)
+{
+  FAR struct vtscreen_row_s *rowp = &screen->rows[row];
+  FAR struct vtscreen_row_s *oldp = &screen->rows[oldrow];
+  bool raw = (rowp->flags & ROW_RAW) != 0;
+  bool oldraw = (oldp->flags & ROW_OLDRAW) != 0;
+
+  return oldp->oldlen == rowp->len && raw == oldraw &&
+         memcmp(ROW_TEXT(screen, row), ROW_SHADOW(screen, oldrow),
+                rowp->len) == 0;
+}
+
+/****************************************************************************
+ * Name: vtscreen_shift
+ *
+ * Description:
+ *   Check if rows of text have moved up or down (as when text is scrolled
+ *   or when lines are inserted or deleted).  If shifting the rows on the
+ *   display is cheaper than redrawing them, shift the display rows and the
+ *   saved display contents.  Rows are only shifted when the screen
+ *   extends to the bottom of the display and every row that would move has
+ *   been set for this refresh.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_SYSTEM_VTSCREEN_VT102)
+#  define SHIFT_POSSIBLE(s,t) true
+#else
+#  define SHIFT_POSSIBLE(s,t) ((t) == 0 && (s)->orgrow == 0)
+#endif
+
+static int vtscreen_shiftcost(FAR struct vtscreen_s *screen, uint16_t top,
+                              int nlines)
+{
+#ifdef CONFIG_SYSTEM_VTSCREEN_VT102
+  /* <esc>[nM deletes and <esc>[nL inserts lines at the cursor row */
+
+  return vtscreen_cursor(screen, top, 0, false) +
+         vtscreen_csilen(nlines < 0 ? -nlines : nlines);
+#else
+  /* INDEX on the bottom row scrolls up; REVINDEX on the top row scrolls
+   * down.  SHIFT_POSSIBLE() has already checked that top is zero.
+   */
+
+  (void)top;
+  if (nlines > 0)
+    {
+      return vtscreen_cursor(screen, screen->nrows - 1, 0, false) +
+             nlines * (int)sizeof(g_index);
+    }
+  else
+    {
+      return vtscreen_cursor(screen, 0, 0, false) -
+             nlines * (int)sizeof(g_revindex);
+    }
+#endif
+}
+
+static int vtscreen_rowcost(FAR struct vtscreen_s *screen, uint16_t row,
+                            int oldrow)
+{
+  FAR struct vtscreen_row_s *rowp = &screen->rows[row];
+  bool same;
+
+  /* Rows shifted onto the screen (oldrow out of range) are blank */
+
+  if (oldrow < 0 || oldrow >= screen->nrows)
+    {
+      same = rowp->len == 0 && (rowp->flags & ROW_RAW) == 0;
+    }
+  else
+    {
+      same = vtscreen_same(screen, row, oldrow);
+    }
+
+  return same ? 0 : rowp->len + ROW_OVERHEAD;
+}
+
+static void vtscreen_shift(FAR struct vtscreen_s *screen)
+{
+  FAR struct vtscreen_row_s *rows = screen->rows;
+  uint16_t nrows = screen->nrows;
+  uint16_t top;
+  uint16_t row;
+  int bestcost;
+  int bestshift;
+  int nlines;
+  int shift;
+  int cost;
+
+  if ((screen->flags & VTSCREEN_FULLSCREEN) == 0)
+    {
+      return;
+    }
+
+  /* Find the first row that changes */
+
+  for (top = 0; top < nrows; top++)
+    {
+      if ((rows[top].flags & ROW_SET) != 0 &&
+          !vtscreen_same(screen, top, top))
+        {
+          break;
+        }
+    }
+
+  if (top + 1 >= nrows || !SHIFT_POSSIBLE(screen, top))
+    {
+      return;
+    }
+
+  /* All of the rows that would move must be redrawn in this refresh */
+
+  for (row = top; row < nrows; row++)
+    {
+      if ((rows[row].flags & ROW_SET) == 0)
+        {
+          return;
+        }
+    }
+
+  /* The cost of updating the rows in place */
+
+  for (bestcost = 0, row = top; row < nrows; row++)
+    {
+      bestcost += vtscreen_rowcost(screen, row, row);
+    }
+
+  /* Compare with the cost of shifting by each possible number of lines.
+   * shift > 0 moves rows up (display row r then shows old row r + shift),
+   * shift < 0 moves rows down.
+   */
+
+  bestshift = 0;
+  for (nlines = 1; nlines < nrows - top; nlines++)
+    {
+      for (shift = nlines; shift >= -nlines; shift -= 2 * nlines)
+        {
+          cost = vtscreen_shiftcost(screen, top, shift);
+          for (row = top; row < nrows && cost < bestcost; row++)
+            {
+              cost += vtscreen_rowcost(screen, row,
+                                       row + shift < top ? -1 : row + shift);
+            }
+
+          if (cost < bestcost)
+            {
+              bestcost  = cost;
+              bestshift = shift;
+            }
+        }
+    }
+
+  if (bestshift == 0)
+    {
+      return;
+    }
+
+  /* Shift the display */
+
+  nlines = bestshift > 0 ? bestshift : -bestshift;
+
+#ifdef CONFIG_SYSTEM_VTSCREEN_VT102
+  vtscreen_cursor(screen, top, 0, true);
+  vtscreen_csi(screen, nlines, bestshift > 0 ? 'M' : 'L');
+#else
+  vtscreen_cursor(screen, bestshift > 0 ? nrows - 1 : 0, 0, true);
+  for (shift = 0; shift < nlines; shift++)
+    {
+      if (bestshift > 0)
+        {
+          vtscreen_out(screen, g_index, sizeof(g_index));
+        }
+      else
+        {
+          vtscreen_out(screen, g_revindex, sizeof(g_revindex));
+        }
+    }
+#endif
+
+  /* Then shift the saved display contents the same way.  The rows shifted
+   * onto the display are blank.
+   */
+
+  if (bestshift > 0)
+    {
+      for (row = top; row < nrows; row++)
+        {
+          if (row + nlines < nrows)
+            {
+              rows[row].oldlen = rows[row + nlines].oldlen;
+              rows[row].flags  = (rows[row].flags & ~ROW_OLDRAW) |
+                                 (rows[row + nlines].flags & ROW_OLDRAW);
+              memcpy(ROW_SHADOW(screen, row),
+                     ROW_SHADOW(screen, row + nlines), screen->ncols);
+            }
+          else
+            {
+              rows[row].oldlen = 0;
+              rows[row].flags &= ~ROW_OLDRAW;
+            }
+        }
+    }
+  else
+    {
+      for (row = nrows; row-- > top; )
+        {
+          if (row >= top + nlines)
+            {
+              rows[row].oldlen = rows[row - nlines].oldlen;
+              rows[row].flags  = (rows[row].flags & ~ROW_OLDRAW) |
+                                 (rows[row - nlines].flags & ROW_OLDRAW);
+              memcpy(ROW_SHADOW(screen, row),
+                     ROW_SHADOW(screen, row - nlines), screen->ncols);
+            }
+          else
+            {
+              rows[row].oldlen = 0;
+              rows[row].flags &= ~ROW_OLDRAW;
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: vtscreen_updaterow
+ *
+ * Description:
+ *   Bring one display row up to date.  The part of the row before the
+ *   first difference and the part after the last difference are kept.
+ *   If the length of the text changes, the text in between is replaced
+ *   either by re-writing the rest of the row, or by inserting or deleting
+ *   characters, whichever is shorter.
+ *
+ ****************************************************************************/
+
+static void vtscreen_updaterow(FAR struct vtscreen_s *screen, uint16_t row)
+{
+  FAR struct vtscreen_row_s *rowp = &screen->rows[row];
+  FAR const char *text = ROW_TEXT(screen, row);
+  FAR char *shadow = ROW_SHADOW(screen, row);
+  uint16_t len = rowp->len;
+  uint16_t oldlen = rowp->oldlen;
+  uint16_t prefix;
+  uint16_t suffix;
+  uint16_t nnew;
+#ifdef CONFIG_SYSTEM_VTSCREEN_VT102
+  uint16_t count;
+#endif
+
+  if (vtscreen_same(screen, row, row))
+    {
+      return;
+    }
+
+  if (oldlen == VTSCREEN_UNKNOWN ||
+      (rowp->flags & (ROW_RAW | ROW_OLDRAW)) != 0)
+    {
+      /* The contents of the row are unknown (or do not map one character
+       * to one column).  Rewrite the whole row.
+       */
+
+      vtscreen_cursor(screen, row, 0, true);
+      vtscreen_text(screen, text, len);
+      if (len < screen->ncols)
+        {
+          vtscreen_out(screen, g_erasetoeol, sizeof(g_erasetoeol));
+        }
+
+      if ((rowp->flags & ROW_RAW) != 0)
+        {
+          screen->currow = VTSCREEN_UNKNOWN;
+        }
+    }
+  else
+    {
+      /* Find the parts at the beginning and at the end that have not
+       * changed.
+       */
+
+      for (prefix = 0;
+           prefix < len && prefix < oldlen && text[prefix] == shadow[prefix];
+           prefix++);
+
+      for (suffix = 0;
+           suffix < len - prefix && suffix < oldlen - prefix &&
+           text[len - 1 - suffix] == shadow[oldlen - 1 - suffix];
+           suffix++);
+
+      nnew = len - prefix - suffix;
+
+      if (len == oldlen)
+        {
+          /* Only the characters in between need to be written */
+
+          vtscreen_cursor(screen, row, prefix, true);
+          vtscreen_text(screen, &text[prefix], nnew);
+        }
+      else
+        {
+#ifdef CONFIG_SYSTEM_VTSCREEN_VT102
+          /* Either way, the cursor goes to the first difference */
+
+          count = len > oldlen ? len - oldlen : oldlen - len;
+          if (nnew + vtscreen_csilen(count) <
+              len - prefix + (len < oldlen ? (int)sizeof(g_erasetoeol) : 0))
+            {
+              vtscreen_cursor(screen, row, prefix, true);
+              if (len > oldlen)
+                {
+                  /* <esc>[n@ opens a gap for the new characters */
+
+                  vtscreen_csi(screen, count, '@');
+                  vtscreen_text(screen, &text[prefix], nnew);
+                }
+              else
+                {
+                  /* <esc>[nP closes up after the new characters */
+
+                  vtscreen_text(screen, &text[prefix], nnew);
+                  vtscreen_csi(screen, count, 'P');
+                }
+            }
+          else
+#endif
+            {
+              vtscreen_cursor(screen, row, prefix, true);
+              vtscreen_text(screen, &text[prefix], len - prefix);
+              if (len < oldlen)
+                {
+                  vtscreen_out(screen, g_erasetoeol, sizeof(g_erasetoeol));
+                }
+            }
+        }
+    }
+
+  /* Remember what is now on the display */
+
+  memcpy(shadow, text, len);
+  rowp->oldlen = len;
+  rowp->flags  = (rowp->flags & ~ROW_OLDRAW) |
+                 ((rowp->flags & ROW_RAW) != 0 ? ROW_OLDRAW : 0);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: vtscreen_initialize
+ *
+ * Description:
+ *   Set up a screen of 'nrows' x 'ncols' characters that is written to
+ *   'fd'.
+ *
+ ****************************************************************************/
+
+int vtscreen_initialize(FAR struct vtscreen_s *screen, int fd,
+                        uint16_t nrows, uint16_t ncols, uint8_t flags)
+{
+  size_t gridsize = (size_t)nrows * ncols;
+  FAR void *alloc;
+
+  memset(screen, 0, sizeof(struct vtscreen_s));
+
+  /* Allocate the row states, the wanted and displayed text of each row,
+   * and the output buffer in one chunk.
+   */
+
+  alloc = malloc(nrows * sizeof(struct vtscreen_row_s) + 2 * gridsize +
+                 CONFIG_SYSTEM_VTSCREEN_BUFSIZE);
+  if (!alloc)
+    {
+      return -ENOMEM;
+    }
+
+  screen->rows   = (FAR struct vtscreen_row_s *)alloc;
+  screen->text   = (FAR char *)&screen->rows[nrows];
+  screen->shadow = &screen->text[gridsize];
+  screen->outbuf = &screen->shadow[gridsize];
+
+  screen->fd     = fd;
+  screen->nrows  = nrows;
+  screen->ncols  = ncols;
+  screen->flags  = flags;
+  screen->currow = VTSCREEN_UNKNOWN;
+  screen->row    = VTSCREEN_UNKNOWN;
+
+  /* Nothing is wanted on any row and the display contents are unknown */
+
+  memset(screen->rows, 0, nrows * sizeof(struct vtscreen_row_s));
+  vtscreen_invalidate(screen, 0, nrows);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: vtscreen_release
+ *
+ * Description:
+ *   Send any buffered output and free the screen buffers.
+ *
+ ****************************************************************************/
+
+void vtscreen_release(FAR struct vtscreen_s *screen)
+{
+  if (screen->rows)
+    {
+      (void)vtscreen_flush(screen);
+      free(screen->rows);
+      screen->rows = NULL;
+    }
+}
+
+/****************************************************************************
+ * Name: vtscreen_origin
+ *
+ * Description:
+ *   Place screen row 0, column 0 at the zero-based display position
+ *   (row, column) where the display cursor is.
+ *
+ ****************************************************************************/
+
+void vtscreen_origin(FAR struct vtscreen_s *screen, uint16_t row,
+                     uint16_t column)
+{
+  screen->orgrow = row;
+  screen->orgcol = column;
+  screen->currow = 0;
+  screen->curcol = 0;
+}
+
+/****************************************************************************
+ * Name: vtscreen_getrow
+ *
+ * Description:
+ *   Return the buffer that holds the text wanted on 'row'.
+ *
+ ****************************************************************************/
+
+FAR char *vtscreen_getrow(FAR struct vtscreen_s *screen, uint16_t row)
+{
+  return ROW_TEXT(screen, row);
+}
+
+/****************************************************************************
+ * Name: vtscreen_setrow
+ *
+ * Description:
+ *   Commit the first 'len' characters of the row buffer as the text wanted
+ *   on 'row'.
+ *
+ ****************************************************************************/
+
+void vtscreen_setrow(FAR struct vtscreen_s *screen, uint16_t row,
+                     uint16_t len)
+{
+  FAR struct vtscreen_row_s *rowp = &screen->rows[row];
+  FAR const char *text = ROW_TEXT(screen, row);
+  uint16_t column;
+
+  /* Trailing blanks look the same as the cleared end of the row */
+
+  if (len > screen->ncols)
+    {
+      len = screen->ncols;
+    }
+
+  while (len > 0 && text[len - 1] == ' ')
+    {
+      len--;
+    }
+
+  /* Non-printable characters do not occupy exactly one display column */
+
+  for (column = 0; column < len && isprint((uint8_t)text[column]); column++);
+
+  rowp->len    = len;
+  rowp->flags &= ~ROW_RAW;
+  rowp->flags |= ROW_SET | (column < len ? ROW_RAW : 0);
+}
+
+/****************************************************************************
+ * Name: vtscreen_setcursor
+ *
+ * Description:
+ *   Select the position where the cursor is left after the next refresh.
+ *
+ ****************************************************************************/
+
+void vtscreen_setcursor(FAR struct vtscreen_s *screen, uint16_t row,
+                        uint16_t column)
+{
+  screen->row    = row;
+  screen->column = column;
+}
+
+/****************************************************************************
+ * Name: vtscreen_refresh
+ *
+ * Description:
+ *   Bring the display up to date with the rows that have been set and send
+ *   the result with one write().
+ *
+ ****************************************************************************/
+
+int vtscreen_refresh(FAR struct vtscreen_s *screen)
+{
+  FAR struct vtscreen_row_s *rows = screen->rows;
+  uint16_t nchanged;
+  uint16_t row;
+
+  /* Hide the cursor while more than one row is updated */
+
+  for (nchanged = 0, row = 0; row < screen->nrows; row++)
+    {
+      if ((rows[row].flags & ROW_SET) != 0 &&
+          !vtscreen_same(screen, row, row))
+        {
+          nchanged++;
+        }
+    }
+
+  if (nchanged > 1)
+    {
+      vtscreen_out(screen, g_cursoroff, sizeof(g_cursoroff));
+    }
+
+  /* Shift rows that have moved, then fix up whatever is still different */
+
+  if (nchanged > 0)
+    {
+      vtscreen_shift(screen);
+
+      for (row = 0; row < screen->nrows; row++)
+        {
+          if ((rows[row].flags & ROW_SET) != 0)
+            {
+              vtscreen_updaterow(screen, row);
+              rows[row].flags &= ~ROW_SET;
+            }
+        }
+    }
+
+  if (screen->row != VTSCREEN_UNKNOWN)
+    {
+      vtscreen_cursor(screen, screen->row, screen->column, true);
+    }
+
+  if (nchanged > 1)
+    {
+      vtscreen_out(screen, g_cursoron, sizeof(g_cursoron));
+    }
+
+  return vtscreen_flush(screen);
+}
+
+/****************************************************************************
+ * Name: vtscreen_moveto
+ *
+ * Description:
+ *   Add the shortest sequence that moves the display cursor to the screen
+ *   position (row, column) to the output buffer.
+ *
+ ****************************************************************************/
+
+void vtscreen_moveto(FAR struct vtscreen_s *screen, uint16_t row,
+                     uint16_t column)
+{
+  vtscreen_cursor(screen, row, column, true);
+}
+
+/****************************************************************************
+ * Name: vtscreen_write
+ *
+ * Description:
+ *   Add raw output to the output buffer and follow its effect on the
+ *   cursor position.
+ *
+ ****************************************************************************/
+
+void vtscreen_write(FAR struct vtscreen_s *screen, FAR const char *buffer,
+                    size_t buflen)
+{
+  size_t i;
+  char ch;
+
+  vtscreen_out(screen, buffer, buflen);
+
+  for (i = 0; i < buflen; i++)
+    {
+      ch = buffer[i];
+      if (ch == ASCII_BEL)
+        {
+          continue;
+        }
+      else if (ch == ASCII_ESC)
+        {
+          /* Character attributes, cursor on/off and erase-to-end-of-line
+           * do not move the cursor.  Anything else might.
+           */
+
+          if (i + 1 < buflen && buffer[i + 1] == '[')
+            {
+              for (i += 2;
+                   i < buflen && (isdigit((uint8_t)buffer[i]) ||
+                                  buffer[i] == ';' || buffer[i] == '?');
+                   i++);
+
+              ch = i < buflen ? buffer[i] : '\0';
+              if (ch == 'm' || ch == 'h' || ch == 'l')
+                {
+                  continue;
+                }
+              else if (ch == 'K')
+                {
+                  if (screen->currow != VTSCREEN_UNKNOWN)
+                    {
+                      vtscreen_invalidate(screen, screen->currow, 1);
+                    }
+
+                  continue;
+                }
+            }
+
+          screen->currow = VTSCREEN_UNKNOWN;
+        }
+      else if (isprint((uint8_t)ch) && screen->currow != VTSCREEN_UNKNOWN)
+        {
+          vtscreen_invalidate(screen, screen->currow, 1);
+          if (++screen->curcol >= screen->ncols)
+            {
+              screen->currow = VTSCREEN_UNKNOWN;
+            }
+        }
+      else
+        {
+          screen->currow = VTSCREEN_UNKNOWN;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: vtscreen_invalidate
+ *
+ * Description:
+ *   Forget the display contents of 'nrows' rows beginning at 'row'.
+ *
+ ****************************************************************************/
+
+void vtscreen_invalidate(FAR struct vtscreen_s *screen, uint16_t row,
+                         uint16_t nrows)
+{
+  for (; nrows > 0 && row < screen->nrows; row++, nrows--)
+    {
+      screen->rows[row].oldlen = VTSCREEN_UNKNOWN;
+      screen->rows[row].flags &= ~ROW_OLDRAW;
+    }
+}
+
+/****************************************************************************
+ * Name: vtscreen_flush
+ *
+ * Description:
+ *   Send the contents of the output buffer to the display.
+ *
+ ****************************************************************************/
+
+int vtscreen_flush(FAR struct vtscreen_s *screen)
+{
+  int ret;
+
+  if (screen->nout > 0)
+    {
+      vtscreen_send(screen);
+    }
+
+  ret = screen->errcode;
+  screen->errcode = OK;
+  return ret;
+}